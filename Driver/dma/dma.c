@@ -4,13 +4,23 @@
  */
 
 #include "internal/dma_private.h"
+#include "internal/dma_reg.h"
 #include <string.h>
 
 // --- Static Data ---
-static struct dma_handle_t s_handle_pool;
-static bool s_is_handle_in_use = {false};
+static struct dma_handle_t s_handle_pool[DMA_MAX_HANDLES];
+static bool s_is_handle_in_use[DMA_MAX_HANDLES] = {false};
 
 // --- Private Helper Functions ---
+static uint32_t data_size_bytes(dma_data_size_t size) {
+    return 1UL << size;
+}
+
+static uint32_t burst_beats(dma_burst_t burst) {
+    static const uint8_t beats[] = {1, 4, 8, 16};
+    return beats[burst];
+}
+
 static struct dma_handle_t* allocate_handle(void) {
     for (int i = 0; i < DMA_MAX_HANDLES; ++i) {
         if (!s_is_handle_in_use[i]) {
@@ -32,11 +42,48 @@ static void release_handle(dma_handle_t handle) {
 
 // --- Public API Function Implementations ---
 
+bool dma_is_config_valid(const dma_config_t* config) {
+    if (config == NULL || config->channel > 7 ||
+        config->direction > DMA_DIRECTION_MEMORY_TO_MEMORY ||
+        config->peripheral_data_size > DMA_DATA_SIZE_32_BIT ||
+        config->memory_data_size > DMA_DATA_SIZE_32_BIT ||
+        config->fifo_threshold > DMA_FIFO_THRESHOLD_FULL ||
+        config->memory_burst > DMA_BURST_INCR16 ||
+        config->peripheral_burst > DMA_BURST_INCR16) {
+        return false;
+    }
+
+    bool m2m = (config->direction == DMA_DIRECTION_MEMORY_TO_MEMORY);
+    if (m2m && (config->circular_mode || config->double_buffer_mode)) {
+        return false;
+    }
+
+    // The hardware always uses the FIFO for memory-to-memory transfers
+    if (!config->fifo_mode && !m2m) {
+        return config->memory_burst == DMA_BURST_SINGLE &&
+               config->peripheral_burst == DMA_BURST_SINGLE &&
+               config->memory_data_size == config->peripheral_data_size;
+    }
+
+    // A memory burst starts once the FIFO reaches the threshold, so the
+    // threshold must hold a whole number of bursts (RM0090 FIFO threshold table)
+    uint32_t fifo_level = ((uint32_t)config->fifo_threshold + 1) * 4;
+    uint32_t memory_burst_bytes = burst_beats(config->memory_burst) * data_size_bytes(config->memory_data_size);
+    if (config->memory_burst != DMA_BURST_SINGLE && (fifo_level % memory_burst_bytes) != 0) {
+        return false;
+    }
+
+    // A peripheral burst must fit in the 16-byte FIFO
+    uint32_t peripheral_burst_bytes = burst_beats(config->peripheral_burst) * data_size_bytes(config->peripheral_data_size);
+    return peripheral_burst_bytes <= 16;
+}
+
 dma_handle_t dma_init(uint8_t dma_num, uint8_t stream_num, const dma_config_t* config) {
-    if (config == NULL |
+    if (config == NULL || (dma_num!= 1 && dma_num!= 2) || stream_num > 7) {
+        return NULL;
+    }
 
-| (dma_num!= 1 && dma_num!= 2) |
-| stream_num > 7) {
+    if (!dma_is_config_valid(config)) {
         return NULL;
     }
 
@@ -57,9 +104,7 @@ dma_handle_t dma_init(uint8_t dma_num, uint8_t stream_num, const dma_config_t* c
     dma_controller_reg_map_t* controller = (dma_controller_reg_map_t*)handle->port_controller_instance;
     *(void**)&handle->port_stream_instance = &controller->S[stream_num];
 
-    if (handle->port_api == NULL |
-
-| handle->port_controller_instance == NULL) {
+    if (handle->port_api == NULL || handle->port_controller_instance == NULL) {
         release_handle(handle);
         return NULL;
     }
@@ -78,12 +123,47 @@ void dma_deinit(dma_handle_t* p_handle) {
     }
 }
 
+int dma_reconfigure(dma_handle_t handle, const dma_config_t* config) {
+    if (handle == NULL || !dma_is_config_valid(config)) {
+        return -1;
+    }
+
+    memcpy((void*)&handle->config, config, sizeof(dma_config_t));
+    handle->port_api->configure_stream(handle);
+    return 0;
+}
+
 void dma_start_transfer(dma_handle_t handle, const void* source_address, void* destination_address, uint16_t data_count) {
     if (handle) {
         handle->port_api->start_transfer(handle, source_address, destination_address, data_count);
     }
 }
 
+void dma_start_double_buffer(dma_handle_t handle, volatile void* peripheral_address,
+                             void* buffer0, void* buffer1, uint16_t data_count) {
+    if (handle && handle->config.double_buffer_mode && buffer0 && buffer1) {
+        handle->port_api->start_double_buffer(handle, peripheral_address, buffer0, buffer1, data_count);
+    }
+}
+
+uint8_t dma_get_current_buffer(dma_handle_t handle) {
+    if (handle && handle->config.double_buffer_mode) {
+        return handle->port_api->get_current_buffer(handle);
+    }
+    return 0;
+}
+
+int dma_set_idle_buffer(dma_handle_t handle, void* buffer) {
+    if (handle == NULL || buffer == NULL || !handle->config.double_buffer_mode) {
+        return -1;
+    }
+    return handle->port_api->set_idle_buffer(handle, buffer);
+}
+
+uint16_t dma_get_remaining_count(dma_handle_t handle) {
+    return handle ? handle->port_api->get_remaining_count(handle) : 0;
+}
+
 void dma_stop_transfer(dma_handle_t handle) {
     if (handle) {
         handle->port_api->stop_transfer(handle);
@@ -108,3 +188,11 @@ void dma_clear_interrupt_flag(dma_handle_t handle, dma_interrupt_t interrupt) {
         handle->port_api->clear_interrupt_flag(handle, interrupt);
     }
 }
+
+bool dma_is_any_stream_active(void) {
+    const dma_port_interface_t* port_api = dma_port_get_api();
+    if (port_api == NULL) {
+        return false;
+    }
+    return port_api->is_any_stream_enabled();
+}
@@ -46,11 +46,28 @@ typedef enum {
     DMA_DATA_SIZE_32_BIT,
 } dma_data_size_t;
 
+/** @brief FIFO level at which the memory side is accessed, in quarters of the 16-byte FIFO. */
+typedef enum {
+    DMA_FIFO_THRESHOLD_1_4 = 0,
+    DMA_FIFO_THRESHOLD_1_2,
+    DMA_FIFO_THRESHOLD_3_4,
+    DMA_FIFO_THRESHOLD_FULL,
+} dma_fifo_threshold_t;
+
+/** @brief Number of beats in one AHB burst. */
+typedef enum {
+    DMA_BURST_SINGLE = 0,
+    DMA_BURST_INCR4,
+    DMA_BURST_INCR8,
+    DMA_BURST_INCR16,
+} dma_burst_t;
+
 /** @brief DMA interrupt types. */
 typedef enum {
     DMA_INTERRUPT_TRANSFER_COMPLETE,
     DMA_INTERRUPT_HALF_TRANSFER,
     DMA_INTERRUPT_TRANSFER_ERROR,
+    DMA_INTERRUPT_FIFO_ERROR,         // FIFO overrun/underrun, FIFO mode only
 } dma_interrupt_t;
 
 /**
@@ -65,10 +82,29 @@ typedef struct {
     bool peripheral_increment;
     bool memory_increment;
     bool circular_mode;
+    bool double_buffer_mode;          // Ping-pong between two memory buffers (not memory-to-memory)
+    bool fifo_mode;                   // Use the FIFO instead of direct mode (always on for memory-to-memory)
+    dma_fifo_threshold_t fifo_threshold;
+    dma_burst_t memory_burst;         // FIFO mode only; a burst must not cross a 1 KB address boundary
+    dma_burst_t peripheral_burst;     // FIFO mode only
 } dma_config_t;
 
 /* --- Public API Functions --- */
 
+/**
+ * @brief Checks a configuration against the hardware's legal combinations.
+ * @details Direct mode allows only single transfers with equal data sizes and
+ *          is unavailable memory-to-memory, as are circular and double-buffer
+ *          mode. In FIFO mode a memory burst must fit the threshold level
+ *          exactly (e.g. INCR4 of words needs a full FIFO) and a peripheral
+ *          burst must fit in the FIFO.
+ *
+ * @param[in] config Pointer to the configuration to check.
+ *
+ * @return true if the configuration is legal, false otherwise.
+ */
+bool dma_is_config_valid(const dma_config_t* config);
+
 /**
  * @brief Initializes and configures a DMA stream.
  *
@@ -87,6 +123,19 @@ dma_handle_t dma_init(uint8_t dma_num, uint8_t stream_num, const dma_config_t* c
  */
 void dma_deinit(dma_handle_t* p_handle);
 
+/**
+ * @brief Replaces the configuration of an initialized stream.
+ * @details Stops the stream and reprograms it, e.g. to change the data size
+ *          between transfers. Interrupt enables are cleared and must be
+ *          enabled again.
+ *
+ * @param[in] handle The handle to the DMA stream.
+ * @param[in] config Pointer to the new configuration.
+ *
+ * @return 0 on success, -1 on an invalid handle or configuration.
+ */
+int dma_reconfigure(dma_handle_t handle, const dma_config_t* config);
+
 /**
  * @brief Starts a DMA transfer.
  *
@@ -97,6 +146,56 @@ void dma_deinit(dma_handle_t* p_handle);
  */
 void dma_start_transfer(dma_handle_t handle, const void* source_address, void* destination_address, uint16_t data_count);
 
+/**
+ * @brief Starts a double-buffered (ping-pong) transfer.
+ * @details The stream alternates between `buffer0` and `buffer1`, each
+ *          `data_count` items long, raising the transfer-complete interrupt
+ *          at every switch. While the hardware uses one buffer the CPU owns
+ *          the other, and may replace it with dma_set_idle_buffer().
+ *          The stream must have been initialized with `double_buffer_mode`.
+ *
+ * @param[in] handle The handle to the DMA stream.
+ * @param[in] peripheral_address The peripheral data register.
+ * @param[in] buffer0 The memory buffer used first.
+ * @param[in] buffer1 The memory buffer used second.
+ * @param[in] data_count The number of data items in each buffer.
+ */
+void dma_start_double_buffer(dma_handle_t handle, volatile void* peripheral_address,
+                             void* buffer0, void* buffer1, uint16_t data_count);
+
+/**
+ * @brief Gets the buffer the hardware is currently transferring.
+ * @param[in] handle The handle to the DMA stream.
+ * @return 0 for buffer0, 1 for buffer1.
+ */
+uint8_t dma_get_current_buffer(dma_handle_t handle);
+
+/**
+ * @brief Replaces the buffer the hardware is not currently using.
+ * @details The hardware rejects (and disables the stream on) a write to the
+ *          address of the buffer in use, so the swap is refused when the
+ *          stream is within DMA_DBM_SWAP_GUARD items of switching buffers.
+ *          Calling from the transfer-complete interrupt always succeeds.
+ *
+ * @param[in] handle The handle to the DMA stream.
+ * @param[in] buffer The new idle buffer, `data_count` items long.
+ *
+ * @return 0 on success, -1 if the stream is not double-buffered, or -2 if the
+ *         buffer switch is imminent (retry after the next transfer complete).
+ */
+int dma_set_idle_buffer(dma_handle_t handle, void* buffer);
+
+/**
+ * @brief Gets the number of data items the stream has left to transfer.
+ * @details In circular mode the count restarts from `data_count` at each
+ *          wrap, so `data_count - remaining` is the position of the next item
+ *          the hardware will write, e.g. the head of a circular RX buffer.
+ *
+ * @param[in] handle The handle to the DMA stream.
+ * @return The remaining item count (NDTR), or 0 for an invalid handle.
+ */
+uint16_t dma_get_remaining_count(dma_handle_t handle);
+
 /**
  * @brief Stops the currently active DMA transfer.
  * @param[in] handle The handle to the DMA stream.
@@ -125,4 +224,13 @@ bool dma_is_interrupt_flag_set(dma_handle_t handle, dma_interrupt_t interrupt);
  */
 void dma_clear_interrupt_flag(dma_handle_t handle, dma_interrupt_t interrupt);
 
+/**
+ * @brief Checks whether any stream of any DMA controller is currently enabled.
+ * @details The check reads the hardware directly, so it also covers streams
+ *          started outside this driver (e.g. by a vendor HAL). Used by the
+ *          low-power scheduler to avoid deep sleep while data is moving.
+ * @return true if at least one stream is enabled, false otherwise.
+ */
+bool dma_is_any_stream_active(void);
+
 #endif // DMA_H
@@ -11,4 +11,11 @@
  */
 #define DMA_MAX_HANDLES 8
 
+/**
+ * @brief Minimum items left in the current buffer for dma_set_idle_buffer().
+ * @details Leaves time for the address write to land before the hardware
+ *          switches buffers. A few items is ample for peripheral-paced streams.
+ */
+#define DMA_DBM_SWAP_GUARD 4
+
 #endif // DMA_CONFIG_H
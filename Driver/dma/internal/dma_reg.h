@@ -59,5 +59,20 @@ typedef struct {
 #define DMA_SxCR_PSIZE_Msk      (3UL << DMA_SxCR_PSIZE_Pos)
 #define DMA_SxCR_MSIZE_Pos      (13U)
 #define DMA_SxCR_MSIZE_Msk      (3UL << DMA_SxCR_MSIZE_Pos)
+#define DMA_SxCR_DBM_Pos        (18U)
+#define DMA_SxCR_DBM_Msk        (1UL << DMA_SxCR_DBM_Pos)
+#define DMA_SxCR_CT_Pos         (19U)
+#define DMA_SxCR_CT_Msk         (1UL << DMA_SxCR_CT_Pos)
+#define DMA_SxCR_PBURST_Pos     (21U)
+#define DMA_SxCR_PBURST_Msk     (3UL << DMA_SxCR_PBURST_Pos)
+#define DMA_SxCR_MBURST_Pos     (23U)
+#define DMA_SxCR_MBURST_Msk     (3UL << DMA_SxCR_MBURST_Pos)
+
+#define DMA_SxFCR_FTH_Pos       (0U)
+#define DMA_SxFCR_FTH_Msk       (3UL << DMA_SxFCR_FTH_Pos)
+#define DMA_SxFCR_DMDIS_Pos     (2U)
+#define DMA_SxFCR_DMDIS_Msk     (1UL << DMA_SxFCR_DMDIS_Pos)
+#define DMA_SxFCR_FEIE_Pos      (7U)
+#define DMA_SxFCR_FEIE_Msk      (1UL << DMA_SxFCR_FEIE_Pos)
 
 #endif // DMA_REG_H
@@ -13,9 +13,14 @@ typedef struct {
     void (*configure_stream)(struct dma_handle_t* handle);
     void (*start_transfer)(struct dma_handle_t* handle, const void* src, void* dest, uint16_t count);
     void (*stop_transfer)(struct dma_handle_t* handle);
+    void (*start_double_buffer)(struct dma_handle_t* handle, volatile void* periph, void* buffer0, void* buffer1, uint16_t count);
+    uint8_t (*get_current_buffer)(struct dma_handle_t* handle);
+    int (*set_idle_buffer)(struct dma_handle_t* handle, void* buffer);
+    uint16_t (*get_remaining_count)(struct dma_handle_t* handle);
     void (*enable_interrupt)(struct dma_handle_t* handle, dma_interrupt_t interrupt);
     bool (*is_interrupt_flag_set)(struct dma_handle_t* handle, dma_interrupt_t interrupt);
     void (*clear_interrupt_flag)(struct dma_handle_t* handle, dma_interrupt_t interrupt);
+    bool (*is_any_stream_enabled)(void);
 } dma_port_interface_t;
 
 /* --- Functions to be provided by the concrete port implementation --- */
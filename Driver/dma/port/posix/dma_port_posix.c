@@ -0,0 +1,335 @@
+/**
+ * @file      dma_port_posix.c
+ * @brief     Host (POSIX) porting layer for the DMA driver.
+ *
+ * @details   A worker thread plays the two DMA controllers, so code that
+ *            hands copies to a memory-to-memory stream (e.g. dma_mem.c)
+ *            runs asynchronously in host tests, as on target. The worker
+ *            moves the data of one stream at a time at memcpy speed, then
+ *            sets the transfer-complete flag and raises the stream's
+ *            interrupt through vPortGenerateSimulatedInterrupt(), with the
+ *            target IRQ numbers.
+ *
+ *            Peripheral streams move one item per dma_port_posix_request()
+ *            from the peripheral fake, in direct mode, with the half/full
+ *            transfer flags, circular reload and double-buffer switching of
+ *            the hardware. The interrupt is raised on the requesting thread.
+ */
+
+#include "internal/dma_private.h"
+#include "internal/dma_reg.h"
+#include "dma_port_posix.h"
+#include "FreeRTOS.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define POSIX_DMA_CONTROLLERS   2
+#define POSIX_DMA_STREAMS       8
+
+/**
+ * @brief Emulated state of one stream.
+ */
+typedef struct {
+    bool enabled;
+    bool moving;                // The worker is copying for this stream
+    uintptr_t periph;           // The source for memory-to-memory
+    uintptr_t memory[2];        // M0AR/M1AR; memory[0] is the memory-to-memory destination
+    uint8_t target;             // CT: the memory buffer in use
+    uint16_t count;             // Items of the peripheral data size, per buffer
+    uint16_t remaining;         // NDTR
+    bool irq_enabled[4];        // By dma_interrupt_t
+    bool flag[4];
+    const dma_config_t* p_config;
+} posix_stream_state_t;
+
+// --- Static Data ---
+
+// Backs the register map dma.c takes the stream addresses from; never accessed
+static uint32_t s_controller_regs[POSIX_DMA_CONTROLLERS][4 + POSIX_DMA_STREAMS * 6];
+
+static posix_stream_state_t s_streams[POSIX_DMA_CONTROLLERS][POSIX_DMA_STREAMS];
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_work = PTHREAD_COND_INITIALIZER;    // A stream was enabled
+static pthread_cond_t s_idle = PTHREAD_COND_INITIALIZER;    // A copy finished
+static pthread_once_t s_worker_once = PTHREAD_ONCE_INIT;
+
+// Stream interrupt numbers, RM0090 vector table
+static const uint8_t s_irq_numbers[POSIX_DMA_CONTROLLERS][POSIX_DMA_STREAMS] = {
+    {11, 12, 13, 14, 15, 16, 17, 47},
+    {56, 57, 58, 59, 60, 68, 69, 70},
+};
+
+// --- Private Helper Functions ---
+
+static posix_stream_state_t* stream_of(struct dma_handle_t* handle) {
+    return &s_streams[handle->dma_num - 1][handle->stream_num];
+}
+
+/** @brief Does the memory-to-memory transfer; the source is the peripheral port. */
+static void move_data(const posix_stream_state_t* p_stream) {
+    size_t width = (size_t)1 << p_stream->p_config->peripheral_data_size;
+    size_t bytes = (size_t)p_stream->count * width;
+    uint8_t* dest = (uint8_t*)p_stream->memory[0];
+    const uint8_t* src = (const uint8_t*)p_stream->periph;
+
+    if (p_stream->p_config->peripheral_increment) {
+        memcpy(dest, src, bytes);
+    } else {
+        for (size_t offset = 0; offset < bytes; offset += width) {
+            memcpy(dest + offset, src, width);
+        }
+    }
+}
+
+/** @brief Finds an enabled memory-to-memory stream, highest priority first. */
+static posix_stream_state_t* next_request(uint32_t* p_irq) {
+    posix_stream_state_t* p_best = NULL;
+    for (int c = 0; c < POSIX_DMA_CONTROLLERS; ++c) {
+        for (int s = 0; s < POSIX_DMA_STREAMS; ++s) {
+            posix_stream_state_t* p_stream = &s_streams[c][s];
+            if (!p_stream->enabled || p_stream->p_config->direction != DMA_DIRECTION_MEMORY_TO_MEMORY) {
+                continue;
+            }
+            if (p_best == NULL || p_stream->p_config->priority > p_best->p_config->priority) {
+                p_best = p_stream;
+                *p_irq = s_irq_numbers[c][s];
+            }
+        }
+    }
+    return p_best;
+}
+
+static void* worker(void* p_arg) {
+    (void)p_arg;
+    pthread_mutex_lock(&s_lock);
+    for (;;) {
+        uint32_t irq = 0;
+        posix_stream_state_t* p_stream = next_request(&irq);
+        if (p_stream == NULL) {
+            pthread_cond_wait(&s_work, &s_lock);
+            continue;
+        }
+
+        p_stream->moving = true;
+        pthread_mutex_unlock(&s_lock);
+        move_data(p_stream);
+        pthread_mutex_lock(&s_lock);
+        p_stream->moving = false;
+        p_stream->enabled = false;
+        p_stream->flag[DMA_INTERRUPT_TRANSFER_COMPLETE] = true;
+        bool raise = p_stream->irq_enabled[DMA_INTERRUPT_TRANSFER_COMPLETE];
+        pthread_cond_broadcast(&s_idle);
+
+        // The handler takes the lock through the port API
+        if (raise) {
+            pthread_mutex_unlock(&s_lock);
+            vPortGenerateSimulatedInterrupt(irq);
+            pthread_mutex_lock(&s_lock);
+        }
+    }
+    return NULL;
+}
+
+static void start_worker(void) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, worker, NULL);
+    pthread_detach(thread);
+}
+
+/** @brief Disables the stream and waits out a copy in progress, as EN does. */
+static void disable_stream(posix_stream_state_t* p_stream) {
+    p_stream->enabled = false;
+    while (p_stream->moving) {
+        pthread_cond_wait(&s_idle, &s_lock);
+    }
+}
+
+// --- Port Implementation ---
+
+static void posix_enable_clock(uint8_t dma_num) {
+    (void)dma_num;
+    pthread_once(&s_worker_once, start_worker);
+}
+
+static void posix_configure_stream(struct dma_handle_t* handle) {
+    posix_stream_state_t* p_stream = stream_of(handle);
+    pthread_mutex_lock(&s_lock);
+    disable_stream(p_stream);
+    p_stream->p_config = &handle->config;
+    memset(p_stream->irq_enabled, 0, sizeof(p_stream->irq_enabled));
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void posix_start_transfer(struct dma_handle_t* handle, const void* src, void* dest, uint16_t count) {
+    posix_stream_state_t* p_stream = stream_of(handle);
+    pthread_mutex_lock(&s_lock);
+    disable_stream(p_stream);
+    if (handle->config.direction == DMA_DIRECTION_MEMORY_TO_PERIPHERAL) {
+        p_stream->periph = (uintptr_t)dest;
+        p_stream->memory[0] = (uintptr_t)src;
+    } else {
+        p_stream->periph = (uintptr_t)src;
+        p_stream->memory[0] = (uintptr_t)dest;
+    }
+    p_stream->target = 0;
+    p_stream->count = count;
+    p_stream->remaining = count;
+    memset(p_stream->flag, 0, sizeof(p_stream->flag));
+    p_stream->enabled = true;
+    pthread_cond_signal(&s_work);
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void posix_stop_transfer(struct dma_handle_t* handle) {
+    pthread_mutex_lock(&s_lock);
+    disable_stream(stream_of(handle));
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void posix_start_double_buffer(struct dma_handle_t* handle, volatile void* periph, void* buffer0, void* buffer1, uint16_t count) {
+    posix_stream_state_t* p_stream = stream_of(handle);
+    pthread_mutex_lock(&s_lock);
+    disable_stream(p_stream);
+    p_stream->periph = (uintptr_t)periph;
+    p_stream->memory[0] = (uintptr_t)buffer0;
+    p_stream->memory[1] = (uintptr_t)buffer1;
+    p_stream->target = 0;
+    p_stream->count = count;
+    p_stream->remaining = count;
+    memset(p_stream->flag, 0, sizeof(p_stream->flag));
+    p_stream->enabled = true;
+    pthread_mutex_unlock(&s_lock);
+}
+
+static uint8_t posix_get_current_buffer(struct dma_handle_t* handle) {
+    pthread_mutex_lock(&s_lock);
+    uint8_t target = stream_of(handle)->target;
+    pthread_mutex_unlock(&s_lock);
+    return target;
+}
+
+static int posix_set_idle_buffer(struct dma_handle_t* handle, void* buffer) {
+    // Requests are atomic here, so the switch can never race the write
+    posix_stream_state_t* p_stream = stream_of(handle);
+    pthread_mutex_lock(&s_lock);
+    p_stream->memory[!p_stream->target] = (uintptr_t)buffer;
+    pthread_mutex_unlock(&s_lock);
+    return 0;
+}
+
+static uint16_t posix_get_remaining_count(struct dma_handle_t* handle) {
+    posix_stream_state_t* p_stream = stream_of(handle);
+    pthread_mutex_lock(&s_lock);
+    uint16_t count = p_stream->enabled ? p_stream->remaining : 0;
+    pthread_mutex_unlock(&s_lock);
+    return count;
+}
+
+static void posix_enable_interrupt(struct dma_handle_t* handle, dma_interrupt_t interrupt) {
+    pthread_mutex_lock(&s_lock);
+    stream_of(handle)->irq_enabled[interrupt] = true;
+    pthread_mutex_unlock(&s_lock);
+}
+
+static bool posix_is_interrupt_flag_set(struct dma_handle_t* handle, dma_interrupt_t interrupt) {
+    pthread_mutex_lock(&s_lock);
+    bool set = stream_of(handle)->flag[interrupt];
+    pthread_mutex_unlock(&s_lock);
+    return set;
+}
+
+static void posix_clear_interrupt_flag(struct dma_handle_t* handle, dma_interrupt_t interrupt) {
+    pthread_mutex_lock(&s_lock);
+    stream_of(handle)->flag[interrupt] = false;
+    pthread_mutex_unlock(&s_lock);
+}
+
+static bool posix_is_any_stream_enabled(void) {
+    bool enabled = false;
+    pthread_mutex_lock(&s_lock);
+    for (int c = 0; c < POSIX_DMA_CONTROLLERS; ++c) {
+        for (int s = 0; s < POSIX_DMA_STREAMS; ++s) {
+            enabled = enabled || s_streams[c][s].enabled;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return enabled;
+}
+
+// --- The concrete port interface for POSIX hosts ---
+static const dma_port_interface_t posix_port_api = {
+   .enable_clock = posix_enable_clock,
+   .configure_stream = posix_configure_stream,
+   .start_transfer = posix_start_transfer,
+   .stop_transfer = posix_stop_transfer,
+   .start_double_buffer = posix_start_double_buffer,
+   .get_current_buffer = posix_get_current_buffer,
+   .set_idle_buffer = posix_set_idle_buffer,
+   .get_remaining_count = posix_get_remaining_count,
+   .enable_interrupt = posix_enable_interrupt,
+   .is_interrupt_flag_set = posix_is_interrupt_flag_set,
+   .clear_interrupt_flag = posix_clear_interrupt_flag,
+   .is_any_stream_enabled = posix_is_any_stream_enabled,
+};
+
+// --- Public functions provided by the port ---
+
+bool dma_port_posix_request(uint8_t dma_num, uint8_t stream) {
+    if (dma_num < 1 || dma_num > POSIX_DMA_CONTROLLERS || stream >= POSIX_DMA_STREAMS) {
+        return false;
+    }
+    posix_stream_state_t* p_stream = &s_streams[dma_num - 1][stream];
+
+    pthread_mutex_lock(&s_lock);
+    if (!p_stream->enabled || p_stream->p_config->direction == DMA_DIRECTION_MEMORY_TO_MEMORY) {
+        pthread_mutex_unlock(&s_lock);
+        return false;
+    }
+
+    const dma_config_t* config = p_stream->p_config;
+    size_t width = (size_t)1 << config->peripheral_data_size;
+    size_t index = config->memory_increment ? (size_t)(p_stream->count - p_stream->remaining) : 0;
+    void* memory = (uint8_t*)p_stream->memory[p_stream->target] + index * width;
+    if (config->direction == DMA_DIRECTION_PERIPHERAL_TO_MEMORY) {
+        memcpy(memory, (const void*)p_stream->periph, width);
+    } else {
+        memcpy((void*)p_stream->periph, memory, width);
+    }
+
+    bool raise = false;
+    p_stream->remaining--;
+    if (p_stream->remaining == p_stream->count / 2) {
+        p_stream->flag[DMA_INTERRUPT_HALF_TRANSFER] = true;
+        raise = p_stream->irq_enabled[DMA_INTERRUPT_HALF_TRANSFER];
+    }
+    if (p_stream->remaining == 0) {
+        p_stream->flag[DMA_INTERRUPT_TRANSFER_COMPLETE] = true;
+        raise = raise || p_stream->irq_enabled[DMA_INTERRUPT_TRANSFER_COMPLETE];
+        if (config->double_buffer_mode) {
+            p_stream->target ^= 1;
+            p_stream->remaining = p_stream->count;
+        } else if (config->circular_mode) {
+            p_stream->remaining = p_stream->count;
+        } else {
+            p_stream->enabled = false;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    if (raise) {
+        vPortGenerateSimulatedInterrupt(s_irq_numbers[dma_num - 1][stream]);
+    }
+    return true;
+}
+
+const dma_port_interface_t* dma_port_get_api(void) {
+    return &posix_port_api;
+}
+
+void* dma_port_get_base_addr(uint8_t dma_num) {
+    if (dma_num == 1 || dma_num == 2) {
+        return s_controller_regs[dma_num - 1];
+    }
+    return NULL;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file      dma_port_posix.h
+ * @brief     Host-only entry of the POSIX DMA port for peripheral fakes.
+ */
+
+#ifndef DMA_PORT_POSIX_H
+#define DMA_PORT_POSIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Raises the DMA request of a peripheral stream, moving one item.
+ * @details Called by a peripheral fake after it fills its data register
+ *          (peripheral-to-memory) or before it reads it (memory-to-peripheral).
+ *          A completed buffer raises the stream interrupt before returning.
+ *
+ * @param[in] dma_num The DMA controller number (1 or 2).
+ * @param[in] stream The stream number (0-7).
+ *
+ * @return false if the stream is not enabled for a peripheral, as the
+ *         hardware would drop the request.
+ */
+bool dma_port_posix_request(uint8_t dma_num, uint8_t stream);
+
+#endif // DMA_PORT_POSIX_H
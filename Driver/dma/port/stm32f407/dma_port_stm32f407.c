@@ -5,6 +5,7 @@
 
 #include "internal/dma_private.h"
 #include "internal/dma_reg.h"
+#include "rcc.h"
 
 // Placeholder base addresses
 #define AHB1PERIPH_BASE       0x40020000UL
@@ -14,16 +15,36 @@
 // --- Private Helper Functions for STM32F4 ---
 
 // Offsets for interrupt flags within the LISR/HISR registers
-static const uint8_t flag_offsets = {0, 6, 16, 22};
+static const uint8_t flag_offsets[4] = {0, 6, 16, 22};
 #define DMA_FLAG_TCIF (1 << 5)
 #define DMA_FLAG_HTIF (1 << 4)
 #define DMA_FLAG_TEIF (1 << 3)
+#define DMA_FLAG_FEIF (1 << 0)
+
+static uint32_t irq_lock(void) {
+    uint32_t primask = 0;
+#if defined(__arm__)
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+#endif
+    return primask;     // Host builds (register-fake tests) have no interrupts to mask
+}
+
+static void irq_unlock(uint32_t primask) {
+#if defined(__arm__)
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+#else
+    (void)primask;
+#endif
+}
 
 // --- Port Implementation ---
 
 static void stm32f4_enable_clock(uint8_t dma_num) {
-    // Placeholder: A real implementation would use the RCC driver.
-    // e.g., if (dma_num == 1) rcc_enable_peripheral_clock(PERIPH_ID_DMA1);
+    switch (dma_num) {
+        case 1: rcc_enable_peripheral_clock(PERIPH_ID_DMA1); break;
+        case 2: rcc_enable_peripheral_clock(PERIPH_ID_DMA2); break;
+        default: break;
+    }
 }
 
 static void stm32f4_configure_stream(struct dma_handle_t* handle) {
@@ -43,7 +64,18 @@ static void stm32f4_configure_stream(struct dma_handle_t* handle) {
     if (config->peripheral_increment) { cr |= DMA_SxCR_PINC_Msk; }
     if (config->memory_increment) { cr |= DMA_SxCR_MINC_Msk; }
     if (config->circular_mode) { cr |= DMA_SxCR_CIRC_Msk; }
+    // Double-buffer mode implies circular mode; the hardware forces CIRC anyway
+    if (config->double_buffer_mode) { cr |= DMA_SxCR_DBM_Msk | DMA_SxCR_CIRC_Msk; }
+    cr |= (config->memory_burst << DMA_SxCR_MBURST_Pos);
+    cr |= (config->peripheral_burst << DMA_SxCR_PBURST_Pos);
 
+    // Memory-to-memory always runs through the FIFO; make that explicit
+    uint32_t fcr = 0;
+    if (config->fifo_mode || config->direction == DMA_DIRECTION_MEMORY_TO_MEMORY) {
+        fcr = DMA_SxFCR_DMDIS_Msk | (config->fifo_threshold << DMA_SxFCR_FTH_Pos);
+    }
+
+    stream_regs->FCR = fcr;
     stream_regs->CR = cr;
 }
 
@@ -57,21 +89,77 @@ static void stm32f4_start_transfer(struct dma_handle_t* handle, const void* src,
     stream_regs->NDTR = count;
 
     if (handle->config.direction == DMA_DIRECTION_MEMORY_TO_PERIPHERAL) {
-        stream_regs->PAR = (uint32_t)dest;
-        stream_regs->M0AR = (uint32_t)src;
+        stream_regs->PAR = (uint32_t)(uintptr_t)dest;
+        stream_regs->M0AR = (uint32_t)(uintptr_t)src;
     } else {
-        stream_regs->PAR = (uint32_t)src;
-        stream_regs->M0AR = (uint32_t)dest;
+        stream_regs->PAR = (uint32_t)(uintptr_t)src;
+        stream_regs->M0AR = (uint32_t)(uintptr_t)dest;
     }
 
     // Clear all flags for this stream before starting
     dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_TRANSFER_COMPLETE);
     dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_HALF_TRANSFER);
     dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_TRANSFER_ERROR);
+    dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_FIFO_ERROR);
 
     stream_regs->CR |= DMA_SxCR_EN_Msk;
 }
 
+static void stm32f4_start_double_buffer(struct dma_handle_t* handle, volatile void* periph, void* buffer0, void* buffer1, uint16_t count) {
+    dma_stream_reg_map_t* stream_regs = (dma_stream_reg_map_t*)handle->port_stream_instance;
+
+    stream_regs->CR &= ~DMA_SxCR_EN_Msk;
+    while (stream_regs->CR & DMA_SxCR_EN_Msk);
+
+    stream_regs->NDTR = count;
+    stream_regs->PAR = (uint32_t)(uintptr_t)periph;
+    stream_regs->M0AR = (uint32_t)(uintptr_t)buffer0;
+    stream_regs->M1AR = (uint32_t)(uintptr_t)buffer1;
+    stream_regs->CR &= ~DMA_SxCR_CT_Msk; // Start with buffer0
+
+    dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_HALF_TRANSFER);
+    dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_TRANSFER_ERROR);
+    dma_port_get_api()->clear_interrupt_flag(handle, DMA_INTERRUPT_FIFO_ERROR);
+
+    stream_regs->CR |= DMA_SxCR_EN_Msk;
+}
+
+static uint8_t stm32f4_get_current_buffer(struct dma_handle_t* handle) {
+    dma_stream_reg_map_t* stream_regs = (dma_stream_reg_map_t*)handle->port_stream_instance;
+    return (stream_regs->CR & DMA_SxCR_CT_Msk) ? 1 : 0;
+}
+
+static int stm32f4_set_idle_buffer(struct dma_handle_t* handle, void* buffer) {
+    dma_stream_reg_map_t* stream_regs = (dma_stream_reg_map_t*)handle->port_stream_instance;
+
+    // CT and NDTR must be read together with the address write, so keep
+    // interrupts (and with them other bus masters' ISRs) out of the window
+    uint32_t primask = irq_lock();
+
+    // The DMA runs on regardless: NDTR first, so that a switch between the
+    // two reads shows as a low count. Once NDTR is at or above the guard the
+    // switch is that many items away, and CT holds for the read and the write.
+    int ret = 0;
+    uint32_t ndtr = stream_regs->NDTR;
+    uint32_t cr = stream_regs->CR;
+    if ((cr & DMA_SxCR_EN_Msk) && ndtr < DMA_DBM_SWAP_GUARD) {
+        ret = -2; // Switch imminent; the write could hit the buffer in use
+    } else if (cr & DMA_SxCR_CT_Msk) {
+        stream_regs->M0AR = (uint32_t)(uintptr_t)buffer;
+    } else {
+        stream_regs->M1AR = (uint32_t)(uintptr_t)buffer;
+    }
+
+    irq_unlock(primask);
+    return ret;
+}
+
+static uint16_t stm32f4_get_remaining_count(struct dma_handle_t* handle) {
+    dma_stream_reg_map_t* stream_regs = (dma_stream_reg_map_t*)handle->port_stream_instance;
+    return (uint16_t)stream_regs->NDTR;
+}
+
 static void stm32f4_stop_transfer(struct dma_handle_t* handle) {
     dma_stream_reg_map_t* stream_regs = (dma_stream_reg_map_t*)handle->port_stream_instance;
     stream_regs->CR &= ~DMA_SxCR_EN_Msk;
@@ -83,6 +171,7 @@ static void stm32f4_enable_interrupt(struct dma_handle_t* handle, dma_interrupt_
         case DMA_INTERRUPT_TRANSFER_COMPLETE: stream_regs->CR |= DMA_SxCR_TCIE_Msk; break;
         case DMA_INTERRUPT_HALF_TRANSFER:     stream_regs->CR |= DMA_SxCR_HTIE_Msk; break;
         case DMA_INTERRUPT_TRANSFER_ERROR:    stream_regs->CR |= DMA_SxCR_TEIE_Msk; break;
+        case DMA_INTERRUPT_FIFO_ERROR:        stream_regs->FCR |= DMA_SxFCR_FEIE_Msk; break;
     }
 }
 
@@ -95,6 +184,7 @@ static bool stm32f4_is_interrupt_flag_set(struct dma_handle_t* handle, dma_inter
         case DMA_INTERRUPT_TRANSFER_COMPLETE: flag = DMA_FLAG_TCIF; break;
         case DMA_INTERRUPT_HALF_TRANSFER:     flag = DMA_FLAG_HTIF; break;
         case DMA_INTERRUPT_TRANSFER_ERROR:    flag = DMA_FLAG_TEIF; break;
+        case DMA_INTERRUPT_FIFO_ERROR:        flag = DMA_FLAG_FEIF; break;
     }
 
     uint32_t offset = flag_offsets[stream % 4];
@@ -114,6 +204,7 @@ static void stm32f4_clear_interrupt_flag(struct dma_handle_t* handle, dma_interr
         case DMA_INTERRUPT_TRANSFER_COMPLETE: flag = DMA_FLAG_TCIF; break;
         case DMA_INTERRUPT_HALF_TRANSFER:     flag = DMA_FLAG_HTIF; break;
         case DMA_INTERRUPT_TRANSFER_ERROR:    flag = DMA_FLAG_TEIF; break;
+        case DMA_INTERRUPT_FIFO_ERROR:        flag = DMA_FLAG_FEIF; break;
     }
 
     uint32_t offset = flag_offsets[stream % 4];
@@ -124,15 +215,34 @@ static void stm32f4_clear_interrupt_flag(struct dma_handle_t* handle, dma_interr
     }
 }
 
+static bool stm32f4_is_any_stream_enabled(void) {
+    static const uintptr_t controllers[2] = {DMA1_BASE, DMA2_BASE};
+
+    for (int c = 0; c < 2; ++c) {
+        dma_controller_reg_map_t* dma_regs = (dma_controller_reg_map_t*)controllers[c];
+        for (int stream = 0; stream < 8; ++stream) {
+            if (dma_regs->S[stream].CR & DMA_SxCR_EN_Msk) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 // --- The concrete port interface for STM32F4 ---
 static const dma_port_interface_t stm32f4_port_api = {
    .enable_clock = stm32f4_enable_clock,
    .configure_stream = stm32f4_configure_stream,
    .start_transfer = stm32f4_start_transfer,
    .stop_transfer = stm32f4_stop_transfer,
+   .start_double_buffer = stm32f4_start_double_buffer,
+   .get_current_buffer = stm32f4_get_current_buffer,
+   .set_idle_buffer = stm32f4_set_idle_buffer,
+   .get_remaining_count = stm32f4_get_remaining_count,
    .enable_interrupt = stm32f4_enable_interrupt,
    .is_interrupt_flag_set = stm32f4_is_interrupt_flag_set,
    .clear_interrupt_flag = stm32f4_clear_interrupt_flag,
+   .is_any_stream_enabled = stm32f4_is_any_stream_enabled,
 };
 
 // --- Public functions provided by the port ---
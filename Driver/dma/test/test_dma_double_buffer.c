@@ -0,0 +1,174 @@
+/**
+ * @file      test_dma_double_buffer.c
+ * @brief     Host test of dma_set_idle_buffer() on the STM32F407 port.
+ *
+ * @details   The port runs against the register fake (reg_fake.h), with
+ *            DMA2 Stream1 trapped. The hook plays the stream: it checks
+ *            each address write against the buffer in use, and it switches
+ *            buffers (NDTR reloaded, CT toggled) where the test tells it.
+ *
+ *            - Forced switch: the stream is one item from the end and
+ *              switches exactly at the port's first, second or third
+ *              register access. A switch between the NDTR and CT reads must
+ *              not let the write through to the buffer now in use.
+ *            - Free running: the stream moves one item per register access,
+ *              from every starting count, with either buffer in use.
+ */
+
+#include "dma.h"
+#include "dma_config.h"
+#include "internal/dma_reg.h"
+#include "rcc.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+
+#define DMA2_BASE           0x40026400UL
+#define STREAM              1
+#define ITEMS               64
+
+// --- Static Data ---
+static volatile dma_stream_reg_map_t* s_stream;
+
+// What the hook does to the stream
+static int s_access;                    // Register accesses so far
+static int s_switch_at;                 // Access that switches buffers, 0 for never
+static bool s_free_running;             // One item per access
+static int s_writes_to_active;          // Address writes to the buffer in use
+static int s_switches;
+
+// --- Private Helper Functions ---
+
+void rcc_enable_peripheral_clock(peripheral_id_t id) {
+    (void)id;
+}
+
+static void switch_buffer(void) {
+    s_stream->NDTR = ITEMS;
+    s_stream->CR ^= DMA_SxCR_CT_Msk;
+    s_switches++;
+}
+
+static void on_access(uintptr_t address, bool is_write) {
+    s_access++;
+    if (s_switch_at == s_access) {
+        switch_buffer();
+    }
+    if (s_free_running) {
+        if (--s_stream->NDTR == 0) {
+            switch_buffer();
+        }
+    }
+
+    // The hardware rejects an address write to the buffer it is transferring
+    bool ct = (s_stream->CR & DMA_SxCR_CT_Msk) != 0;
+    if (is_write && ((address == (uintptr_t)&s_stream->M0AR && !ct) ||
+                     (address == (uintptr_t)&s_stream->M1AR && ct))) {
+        s_writes_to_active++;
+    }
+}
+
+/** @brief Calls dma_set_idle_buffer() with the stream trapped. */
+static int set_idle_trapped(dma_handle_t dma, void* buffer) {
+    s_access = 0;
+    s_writes_to_active = 0;
+    s_switches = 0;
+    TEST_CHECK(reg_fake_trap((uintptr_t)s_stream, sizeof(dma_stream_reg_map_t), on_access));
+    int ret = dma_set_idle_buffer(dma, buffer);
+    reg_fake_untrap();
+    return ret;
+}
+
+static void test_forced_switch(dma_handle_t dma, int16_t* p_new) {
+    for (int at = 1; at <= 3; ++at) {
+        for (int ct = 0; ct <= 1; ++ct) {
+            s_stream->NDTR = 1;
+            s_stream->CR = (s_stream->CR & ~DMA_SxCR_CT_Msk) | (ct ? DMA_SxCR_CT_Msk : 0);
+            s_stream->M0AR = 0;
+            s_stream->M1AR = 0;
+            s_switch_at = at;
+            s_free_running = false;
+
+            int ret = set_idle_trapped(dma, p_new);
+            TEST_CHECK(s_switches <= 1);        // None if the port reads less often
+            TEST_CHECK(s_writes_to_active == 0);
+            if (at == 1) {
+                // Switched before anything was read: a full count, so the
+                // write goes through, to the buffer just left
+                TEST_CHECK(ret == 0);
+                TEST_CHECK((ct ? s_stream->M1AR : s_stream->M0AR) == (uint32_t)(uintptr_t)p_new);
+            } else {
+                TEST_CHECK(ret == -2);
+                TEST_CHECK(s_stream->M0AR == 0 && s_stream->M1AR == 0);
+            }
+        }
+    }
+    s_switch_at = 0;
+}
+
+static void test_free_running(dma_handle_t dma, int16_t* p_new) {
+    int accepted = 0;
+    int refused = 0;
+    for (uint32_t count = 1; count <= ITEMS; ++count) {
+        for (int ct = 0; ct <= 1; ++ct) {
+            s_stream->NDTR = count;
+            s_stream->CR = (s_stream->CR & ~DMA_SxCR_CT_Msk) | (ct ? DMA_SxCR_CT_Msk : 0);
+            s_free_running = true;
+
+            int ret = set_idle_trapped(dma, p_new);
+            s_free_running = false;
+            TEST_CHECK(ret == 0 || ret == -2);
+            TEST_CHECK(s_writes_to_active == 0);
+            if (ret == 0) {
+                accepted++;
+            } else {
+                refused++;
+                TEST_CHECK(count <= DMA_DBM_SWAP_GUARD);
+            }
+        }
+    }
+    // Everything clear of the guard goes through
+    TEST_CHECK(accepted >= 2 * (ITEMS - DMA_DBM_SWAP_GUARD));
+    TEST_CHECK(refused > 0);
+}
+
+int main(void) {
+    if (!reg_fake_map(DMA2_BASE, 0x400)) {
+        fprintf(stderr, "cannot map the DMA2 registers on this host\n");
+        return 1;
+    }
+    int16_t* p_periph = reg_fake_sram(sizeof(int16_t));
+    int16_t* p_buffer0 = reg_fake_sram(ITEMS * sizeof(int16_t));
+    int16_t* p_buffer1 = reg_fake_sram(ITEMS * sizeof(int16_t));
+    int16_t* p_new = reg_fake_sram(ITEMS * sizeof(int16_t));
+    TEST_CHECK(p_periph != NULL && p_buffer0 != NULL && p_buffer1 != NULL && p_new != NULL);
+
+    const dma_config_t config = {
+        .channel = 3,
+        .direction = DMA_DIRECTION_PERIPHERAL_TO_MEMORY,
+        .priority = DMA_PRIORITY_HIGH,
+        .peripheral_data_size = DMA_DATA_SIZE_16_BIT,
+        .memory_data_size = DMA_DATA_SIZE_16_BIT,
+        .memory_increment = true,
+        .double_buffer_mode = true,
+    };
+    dma_handle_t dma = dma_init(2, STREAM, &config);
+    TEST_CHECK(dma != NULL);
+    if (dma == NULL) {
+        return TEST_EXIT();
+    }
+    s_stream = &((volatile dma_controller_reg_map_t*)DMA2_BASE)->S[0] + STREAM;
+
+    dma_start_double_buffer(dma, p_periph, p_buffer0, p_buffer1, ITEMS);
+    TEST_CHECK(s_stream->CR & DMA_SxCR_DBM_Msk);
+    TEST_CHECK(s_stream->CR & DMA_SxCR_EN_Msk);
+    TEST_CHECK(s_stream->M0AR == (uint32_t)(uintptr_t)p_buffer0);
+    TEST_CHECK(s_stream->M1AR == (uint32_t)(uintptr_t)p_buffer1);
+
+    test_forced_switch(dma, p_new);
+    test_free_running(dma, p_new);
+
+    dma_deinit(&dma);
+    return TEST_EXIT();
+}
@@ -3,15 +3,15 @@
  * @brief     Hardware-agnostic implementation of the EXTI driver.
  */
 
-#include "internal/exti_private.h"
+#include "internal/exit_private.h"
 #include <string.h>
 
 // --- Static Data ---
-static struct exti_handle_t s_handle_pool;
-static bool s_is_handle_in_use = {false};
+static struct exti_handle_t s_handle_pool[EXTI_MAX_HANDLES];
+static bool s_is_handle_in_use[EXTI_MAX_HANDLES] = {false};
 
 // Map of line numbers (0-15) to their active handles.
-static exti_handle_t s_line_to_handle_map[3] = {NULL};
+static exti_handle_t s_line_to_handle_map[16] = {NULL};
 
 // --- Private Helper Functions ---
 static exti_handle_t allocate_handle(void) {
@@ -50,9 +50,7 @@ static void exti_generic_handler(uint8_t line_num) {
 // --- Public API Function Implementations ---
 
 exti_handle_t exti_init(uint8_t port_num, uint8_t pin_num, const exti_config_t* config) {
-    if (config == NULL |
-
-| pin_num > 15) {
+    if (config == NULL || pin_num > 15) {
         return NULL;
     }
 
@@ -6,9 +6,9 @@
 #ifndef EXTI_PRIVATE_H
 #define EXTI_PRIVATE_H
 
-#include "exti.h"
-#include "exti_config.h"
-#include "port/exti_port.h"
+#include "exit.h"
+#include "exit_config.h"
+#include "port/exit_port.h"
 
 /**
  * @brief The complete driver handle structure.
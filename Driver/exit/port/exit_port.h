@@ -6,7 +6,7 @@
 #ifndef EXTI_PORT_H
 #define EXTI_PORT_H
 
-#include "exti.h"
+#include "exit.h"
 
 typedef void (*exti_generic_handler_t)(uint8_t line_num);
 
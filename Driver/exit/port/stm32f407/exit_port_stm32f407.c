@@ -3,8 +3,8 @@
  * @brief     Concrete porting layer implementation for the STM32F4xx series.
  */
 
-#include "internal/exti_private.h"
-#include "internal/exti_reg.h"
+#include "internal/exit_private.h"
+#include "internal/exit_reg.h"
 
 // Placeholder base addresses
 #define APB2PERIPH_BASE       0x40010000UL
@@ -34,16 +34,12 @@ static void stm32f4_configure_interrupt(uint8_t port_num, uint8_t pin_num, exti_
     SYSCFG->EXTICR[reg_index] |= (port_num << shift);
 
     // 2. Configure trigger type
-    if (trigger == EXTI_TRIGGER_RISING |
-
-| trigger == EXTI_TRIGGER_BOTH) {
+    if (trigger == EXTI_TRIGGER_RISING || trigger == EXTI_TRIGGER_BOTH) {
         EXTI->RTSR |= (1 << pin_num);
     } else {
         EXTI->RTSR &= ~(1 << pin_num);
     }
-    if (trigger == EXTI_TRIGGER_FALLING |
-
-| trigger == EXTI_TRIGGER_BOTH) {
+    if (trigger == EXTI_TRIGGER_FALLING || trigger == EXTI_TRIGGER_BOTH) {
         EXTI->FTSR |= (1 << pin_num);
     } else {
         EXTI->FTSR &= ~(1 << pin_num);
@@ -4,6 +4,7 @@
  */
 
 #include "internal/flash_private.h"
+#include "rcc.h"
 #include <string.h>
 
 // --- Static Data ---
@@ -11,6 +12,23 @@
 static struct flash_handle_t s_handle;
 static bool s_is_handle_initialized = false;
 
+// --- Private Helper Functions ---
+
+/**
+ * @brief Keeps the wait states valid across a system clock change.
+ * @details Raised before the clock goes up, lowered after it went down;
+ *          the POST_CHANGE call also undoes a raise if the change failed.
+ */
+static void flash_clock_listener(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change, void* p_context) {
+    struct flash_handle_t* handle = (struct flash_handle_t*)p_context;
+    if (!s_is_handle_initialized) {
+        return;
+    }
+    if (phase == RCC_CLOCK_POST_CHANGE || p_change->to.ahb_hz > p_change->from.ahb_hz) {
+        (void)handle->port_api->set_wait_states(handle, p_change->to.ahb_hz);
+    }
+}
+
 // --- Public API Function Implementations ---
 
 flash_handle_t flash_init(void) {
@@ -25,6 +43,10 @@ flash_handle_t flash_init(void) {
         return NULL;
     }
 
+    if (rcc_register_clock_listener(flash_clock_listener, &s_handle) != 0) {
+        return NULL;
+    }
+
     s_is_handle_initialized = true;
     return &s_handle;
 }
@@ -32,6 +54,7 @@ flash_handle_t flash_init(void) {
 void flash_deinit(flash_handle_t* p_handle) {
     if (p_handle!= NULL && *p_handle!= NULL) {
         // Nothing to de-initialize, just invalidate the handle
+        rcc_unregister_clock_listener(flash_clock_listener, &s_handle);
         s_is_handle_initialized = false;
         *p_handle = NULL;
     }
@@ -44,6 +67,20 @@ int flash_set_wait_states(flash_handle_t handle, uint32_t system_clock_hz) {
     return -1;
 }
 
+int flash_set_accelerator(flash_handle_t handle, uint32_t features) {
+    if (handle && s_is_handle_initialized && (features & ~FLASH_ACCEL_ALL) == 0) {
+        return handle->port_api->set_accelerator(handle, features);
+    }
+    return -1;
+}
+
+uint32_t flash_get_accelerator(flash_handle_t handle) {
+    if (handle && s_is_handle_initialized) {
+        return handle->port_api->get_accelerator(handle);
+    }
+    return 0;
+}
+
 int flash_erase_sector(flash_handle_t handle, uint8_t sector_index) {
     if (handle && s_is_handle_initialized) {
         return handle->port_api->erase_sector(handle, sector_index);
@@ -51,6 +88,20 @@ int flash_erase_sector(flash_handle_t handle, uint8_t sector_index) {
     return -1;
 }
 
+int flash_erase_sector_start(flash_handle_t handle, uint8_t sector_index) {
+    if (handle && s_is_handle_initialized) {
+        return handle->port_api->erase_start(handle, sector_index);
+    }
+    return -1;
+}
+
+int flash_poll(flash_handle_t handle) {
+    if (handle && s_is_handle_initialized) {
+        return handle->port_api->poll(handle);
+    }
+    return -1;
+}
+
 int flash_program(flash_handle_t handle, uint32_t address, const uint8_t* p_data, size_t len) {
     if (handle && s_is_handle_initialized && p_data!= NULL) {
         return handle->port_api->program(handle, address, p_data, len);
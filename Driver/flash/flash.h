@@ -11,7 +11,7 @@
 #ifndef FLASH_H
 #define FLASH_H
 
-#include <stdint.hh>
+#include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -22,11 +22,22 @@
  */
 typedef struct flash_handle_t* flash_handle_t;
 
+/** @brief Returned by flash_poll() while an operation is in progress. */
+#define FLASH_BUSY 1
+
+/** @brief ART accelerator features, for flash_set_accelerator(). */
+#define FLASH_ACCEL_PREFETCH    (1U << 0)
+#define FLASH_ACCEL_ICACHE      (1U << 1)
+#define FLASH_ACCEL_DCACHE      (1U << 2)
+#define FLASH_ACCEL_ALL         (FLASH_ACCEL_PREFETCH | FLASH_ACCEL_ICACHE | FLASH_ACCEL_DCACHE)
+
 /* --- Public API Functions --- */
 
 /**
  * @brief Initializes the FLASH controller interface.
  * @details This function should be called once to get a handle to the controller.
+ *          The first call registers a clock listener with the RCC driver that
+ *          keeps the wait states matched to rcc_set_sysclk().
  *
  * @return A handle to the FLASH controller, or NULL on failure.
  */
@@ -43,7 +54,9 @@ void flash_deinit(flash_handle_t* p_handle);
  * @brief Sets the FLASH memory wait states (latency).
  * @details This is a critical function that must be called to match the FLASH
  *          access time to the system clock frequency. It should be called
- *          before increasing the system clock speed.
+ *          before increasing the system clock speed. Changes made with
+ *          rcc_set_sysclk() are followed automatically once flash_init()
+ *          has run.
  *
  * @param[in] handle The handle to the FLASH controller.
  * @param[in] system_clock_hz The target system clock frequency in Hz.
@@ -52,9 +65,35 @@ void flash_deinit(flash_handle_t* p_handle);
  */
 int flash_set_wait_states(flash_handle_t handle, uint32_t system_clock_hz);
 
+/**
+ * @brief Enables the ART accelerator features given, and disables the others.
+ * @details A cache being enabled is reset first, so it never serves lines
+ *          from before it was switched off. With prefetch and both caches on,
+ *          code in loops runs from FLASH close to zero wait states even at
+ *          5 wait states (168 MHz).
+ *
+ * @param[in] handle The handle to the FLASH controller.
+ * @param[in] features FLASH_ACCEL_* flags.
+ *
+ * @return 0 on success, or a negative error code.
+ */
+int flash_set_accelerator(flash_handle_t handle, uint32_t features);
+
+/**
+ * @brief Gets the ART accelerator features currently enabled.
+ * @return FLASH_ACCEL_* flags, or 0 if the handle is invalid.
+ */
+uint32_t flash_get_accelerator(flash_handle_t handle);
+
 /**
  * @brief Erases a single sector of the FLASH memory.
- * @warning This is a blocking operation that can take a significant amount of time.
+ * @details Waits for the erase from SRAM. A 16 KB sector takes a few hundred
+ *          milliseconds and a 128 KB sector one to two seconds.
+ * @warning This is a blocking operation. The STM32F407 has a single bank:
+ *          until the erase completes, any instruction, constant or vector
+ *          fetched from FLASH stalls the CPU, so no task or interrupt that
+ *          runs from FLASH makes progress. Audio DMA keeps cycling over
+ *          buffers that nothing refills; do not erase while audio streams.
  *
  * @param[in] handle The handle to the FLASH controller.
  * @param[in] sector_index The index of the sector to erase (e.g., 0, 1, 2...).
@@ -63,8 +102,39 @@ int flash_set_wait_states(flash_handle_t handle, uint32_t system_clock_hz);
  */
 int flash_erase_sector(flash_handle_t handle, uint8_t sector_index);
 
+/**
+ * @brief Starts a sector erase; flash_poll() finishes it.
+ * @details The two halves of flash_erase_sector(), for a caller that waits in
+ *          its own SRAM loop. Call flash_poll() until it stops returning
+ *          FLASH_BUSY; the erase is finished (and the FLASH locked again)
+ *          only then. This is not a background erase: the caller returns
+ *          from here into FLASH code and stalls at once, and so does every
+ *          task and interrupt that runs from FLASH.
+ * @warning Same restrictions as flash_erase_sector(): do not erase while
+ *          audio streams.
+ *
+ * @param[in] handle The handle to the FLASH controller.
+ * @param[in] sector_index The index of the sector to erase.
+ *
+ * @return 0 if the erase started, or a negative error code.
+ */
+int flash_erase_sector_start(flash_handle_t handle, uint8_t sector_index);
+
+/**
+ * @brief Checks on an operation started with flash_erase_sector_start().
+ *
+ * @param[in] handle The handle to the FLASH controller.
+ *
+ * @return FLASH_BUSY while it runs, 0 once it succeeded, or a negative error
+ *         code if it failed.
+ */
+int flash_poll(flash_handle_t handle);
+
 /**
  * @brief Programs a block of data into FLASH memory.
+ * @details Writes at the widest parallelism the supply allows (see
+ *          flash_config.h): x32 at 2.7-3.6 V, so aligned data takes one
+ *          write per word; unaligned head and tail bytes go one at a time.
  * @warning This is a blocking operation. The target memory area must be
  *          erased before programming.
  *
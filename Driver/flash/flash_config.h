@@ -1,16 +1,24 @@
 /**
- * @file      uart_config.h
- * @brief     Compile-time configuration for the UART driver.
+ * @file      flash_config.h
+ * @brief     Compile-time configuration for the FLASH driver.
  */
 
-#ifndef UART_CONFIG_H
-#define UART_CONFIG_H
+#ifndef FLASH_CONFIG_H
+#define FLASH_CONFIG_H
 
 /**
- * @brief Defines the maximum number of UART instances the driver can manage.
- * @details This sets the size of the static handle pool. Adjust based on
- *          the number of UART peripherals you intend to use simultaneously.
+ * @brief Supply voltage range of the board, which limits the program and
+ *        erase parallelism (RM0090, "Program/erase parallelism").
+ * @details 1: 1.8-2.1 V, x8.  2: 2.1-2.7 V, x16.  3: 2.7-3.6 V, x32.
+ *          The Discovery board runs at 3.0 V.
  */
-#define UART_MAX_INSTANCES 3
+#define FLASH_VOLTAGE_RANGE 3
 
-#endif // UART_CONFIG_H
+/**
+ * @brief Set to 1 when an external 8-9 V supply is applied to VPP, which
+ *        allows x64 parallelism. Never set it without VPP: the operation
+ *        fails with a parallelism error.
+ */
+#define FLASH_VPP_ENABLE 0
+
+#endif // FLASH_CONFIG_H
@@ -7,6 +7,7 @@
 #define FLASH_PRIVATE_H
 
 #include "flash.h"
+#include "flash_config.h"
 #include "port/flash_port.h"
 
 /**
@@ -30,11 +30,33 @@ typedef struct {
 /* --- Register Bit Field Definitions --- */
 #define FLASH_ACR_LATENCY_Pos   (0U)
 #define FLASH_ACR_LATENCY_Msk   (0xFUL << FLASH_ACR_LATENCY_Pos)
+#define FLASH_ACR_PRFTEN_Pos    (8U)
+#define FLASH_ACR_PRFTEN_Msk    (1UL << FLASH_ACR_PRFTEN_Pos)
+#define FLASH_ACR_ICEN_Pos      (9U)
+#define FLASH_ACR_ICEN_Msk      (1UL << FLASH_ACR_ICEN_Pos)
+#define FLASH_ACR_DCEN_Pos      (10U)
+#define FLASH_ACR_DCEN_Msk      (1UL << FLASH_ACR_DCEN_Pos)
+#define FLASH_ACR_ICRST_Pos     (11U)
+#define FLASH_ACR_ICRST_Msk     (1UL << FLASH_ACR_ICRST_Pos)
+#define FLASH_ACR_DCRST_Pos     (12U)
+#define FLASH_ACR_DCRST_Msk     (1UL << FLASH_ACR_DCRST_Pos)
 
 #define FLASH_SR_BSY_Pos        (16U)
 #define FLASH_SR_BSY_Msk        (1UL << FLASH_SR_BSY_Pos)
 #define FLASH_SR_EOP_Pos        (0U)
 #define FLASH_SR_EOP_Msk        (1UL << FLASH_SR_EOP_Pos)
+#define FLASH_SR_OPERR_Pos      (1U)
+#define FLASH_SR_OPERR_Msk      (1UL << FLASH_SR_OPERR_Pos)
+#define FLASH_SR_WRPERR_Pos     (4U)
+#define FLASH_SR_WRPERR_Msk     (1UL << FLASH_SR_WRPERR_Pos)
+#define FLASH_SR_PGAERR_Pos     (5U)
+#define FLASH_SR_PGAERR_Msk     (1UL << FLASH_SR_PGAERR_Pos)
+#define FLASH_SR_PGPERR_Pos     (6U)
+#define FLASH_SR_PGPERR_Msk     (1UL << FLASH_SR_PGPERR_Pos)
+#define FLASH_SR_PGSERR_Pos     (7U)
+#define FLASH_SR_PGSERR_Msk     (1UL << FLASH_SR_PGSERR_Pos)
+#define FLASH_SR_ERR_Msk        (FLASH_SR_OPERR_Msk | FLASH_SR_WRPERR_Msk | FLASH_SR_PGAERR_Msk | \
+                                 FLASH_SR_PGPERR_Msk | FLASH_SR_PGSERR_Msk)
 
 #define FLASH_CR_LOCK_Pos       (31U)
 #define FLASH_CR_LOCK_Msk       (1UL << FLASH_CR_LOCK_Pos)
@@ -42,6 +64,10 @@ typedef struct {
 #define FLASH_CR_STRT_Msk       (1UL << FLASH_CR_STRT_Pos)
 #define FLASH_CR_PSIZE_Pos      (8U)
 #define FLASH_CR_PSIZE_Msk      (3UL << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_PSIZE_X8       (0UL << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_PSIZE_X16      (1UL << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_PSIZE_X32      (2UL << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_PSIZE_X64      (3UL << FLASH_CR_PSIZE_Pos)
 #define FLASH_CR_SNB_Pos        (3U)
 #define FLASH_CR_SNB_Msk        (0x1FUL << FLASH_CR_SNB_Pos)
 #define FLASH_CR_MER_Pos        (2U)
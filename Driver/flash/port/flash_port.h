@@ -10,7 +10,11 @@ struct flash_handle_t;
 
 typedef struct {
     int (*set_wait_states)(struct flash_handle_t* handle, uint32_t system_clock_hz);
+    int (*set_accelerator)(struct flash_handle_t* handle, uint32_t features);
+    uint32_t (*get_accelerator)(struct flash_handle_t* handle);
     int (*erase_sector)(struct flash_handle_t* handle, uint8_t sector_index);
+    int (*erase_start)(struct flash_handle_t* handle, uint8_t sector_index);
+    int (*poll)(struct flash_handle_t* handle);
     int (*program)(struct flash_handle_t* handle, uint32_t address, const uint8_t* data, size_t len);
 } flash_port_interface_t;
 
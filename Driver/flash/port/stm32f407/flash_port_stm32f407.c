@@ -9,23 +9,101 @@
 // Placeholder base address
 #define FLASH_R_BASE          0x40023C00UL
 
+// Sectors 0-11 of the 1 MB part, all in one bank
+#define FLASH_SECTOR_COUNT    12
+
+// Program/erase parallelism allowed by the supply, see flash_config.h
+#if (FLASH_VPP_ENABLE == 1)
+#define FLASH_PSIZE           FLASH_CR_PSIZE_X64
+#define FLASH_UNIT_BYTES      8U
+#elif (FLASH_VOLTAGE_RANGE >= 3)
+#define FLASH_PSIZE           FLASH_CR_PSIZE_X32
+#define FLASH_UNIT_BYTES      4U
+#elif (FLASH_VOLTAGE_RANGE == 2)
+#define FLASH_PSIZE           FLASH_CR_PSIZE_X16
+#define FLASH_UNIT_BYTES      2U
+#else
+#define FLASH_PSIZE           FLASH_CR_PSIZE_X8
+#define FLASH_UNIT_BYTES      1U
+#endif
+
+// The F407 has a single bank: while it is busy, every fetch from it stalls.
+// Everything from unlock to lock runs from SRAM, so the wait loops spin on
+// the status register instead of on stalled instruction fetches. Code that
+// returns to FLASH during an erase still stalls until it ends.
+#define FLASH_RAMFUNC         __attribute__((section(".RamFunc"), noinline))
+
 // --- Private Helper Functions for STM32F4 ---
 
-static void stm32f4_wait_for_last_operation(flash_reg_map_t* flash_regs) {
+/** @brief Waits for the current operation; returns its error flags. */
+static FLASH_RAMFUNC uint32_t stm32f4_wait_for_last_operation(flash_reg_map_t* flash_regs) {
     while (flash_regs->SR & FLASH_SR_BSY_Msk);
+    return flash_regs->SR & FLASH_SR_ERR_Msk;
 }
 
-static void stm32f4_unlock(flash_reg_map_t* flash_regs) {
+static FLASH_RAMFUNC void stm32f4_unlock(flash_reg_map_t* flash_regs) {
     if (flash_regs->CR & FLASH_CR_LOCK_Msk) {
         flash_regs->KEYR = FLASH_KEYR_KEY1;
         flash_regs->KEYR = FLASH_KEYR_KEY2;
     }
 }
 
-static void stm32f4_lock(flash_reg_map_t* flash_regs) {
+static FLASH_RAMFUNC void stm32f4_lock(flash_reg_map_t* flash_regs) {
     flash_regs->CR |= FLASH_CR_LOCK_Msk;
 }
 
+// The ART caches may still hold lines of an erased sector; they can only be
+// reset while disabled.
+static FLASH_RAMFUNC void stm32f4_flush_caches(flash_reg_map_t* flash_regs) {
+    uint32_t enabled = flash_regs->ACR & (FLASH_ACR_ICEN_Msk | FLASH_ACR_DCEN_Msk);
+    flash_regs->ACR &= ~(FLASH_ACR_ICEN_Msk | FLASH_ACR_DCEN_Msk);
+    flash_regs->ACR |= FLASH_ACR_ICRST_Msk | FLASH_ACR_DCRST_Msk;
+    flash_regs->ACR &= ~(FLASH_ACR_ICRST_Msk | FLASH_ACR_DCRST_Msk);
+    flash_regs->ACR |= enabled;
+}
+
+/**
+ * @brief Programs `count` units of `unit` bytes (1, 2, 4 or 8) at an aligned address.
+ * @return The error flags of the first failed write, or 0.
+ */
+static FLASH_RAMFUNC uint32_t stm32f4_program_units(flash_reg_map_t* flash_regs, uint32_t address,
+                                                    const uint8_t* data, size_t count, uint32_t psize,
+                                                    uint32_t unit) {
+    flash_regs->CR = (flash_regs->CR & ~FLASH_CR_PSIZE_Msk) | psize;
+
+    for (size_t i = 0; i < count; ++i) {
+        // Assembled bytewise: the source may be unaligned, or in flash itself
+        uint32_t word = data[0];
+        if (unit >= 2) {
+            word |= (uint32_t)data[1] << 8;
+        }
+        if (unit >= 4) {
+            word |= ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+        }
+
+        if (unit == 1) {
+            *(volatile uint8_t*)address = (uint8_t)word;
+        } else if (unit == 2) {
+            *(volatile uint16_t*)address = (uint16_t)word;
+        } else {
+            *(volatile uint32_t*)address = word;
+            if (unit == 8) {
+                // A double word is two word writes back to back
+                *(volatile uint32_t*)(address + 4) = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+                                                     ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+            }
+        }
+
+        uint32_t errors = stm32f4_wait_for_last_operation(flash_regs);
+        if (errors) {
+            return errors;
+        }
+        address += unit;
+        data += unit;
+    }
+    return 0;
+}
+
 // --- Port Implementation ---
 
 static int stm32f4_set_wait_states(struct flash_handle_t* handle, uint32_t system_clock_hz) {
@@ -42,68 +120,138 @@ static int stm32f4_set_wait_states(struct flash_handle_t* handle, uint32_t syste
     else if (system_clock_hz <= 180000000) { ws = 5; }
     else { return -1; /* Unsupported frequency */ }
 
-    flash_regs->ACR &= ~FLASH_ACR_LATENCY_Msk;
-    flash_regs->ACR |= (ws << FLASH_ACR_LATENCY_Pos);
+    // One write: clearing first would run at zero wait states in between,
+    // which is fatal at full speed. The new latency applies once it reads back.
+    flash_regs->ACR = (flash_regs->ACR & ~FLASH_ACR_LATENCY_Msk) | (ws << FLASH_ACR_LATENCY_Pos);
+    while (((flash_regs->ACR & FLASH_ACR_LATENCY_Msk) >> FLASH_ACR_LATENCY_Pos) != ws);
 
     return 0;
 }
 
-static int stm32f4_erase_sector(struct flash_handle_t* handle, uint8_t sector_index) {
+static int stm32f4_set_accelerator(struct flash_handle_t* handle, uint32_t features) {
+    flash_reg_map_t* flash_regs = (flash_reg_map_t*)handle->port_hw_instance;
+
+    // Caches are reset while disabled, then enabled clean (RM0090, "ART Accelerator")
+    uint32_t acr = flash_regs->ACR & ~(FLASH_ACR_PRFTEN_Msk | FLASH_ACR_ICEN_Msk | FLASH_ACR_DCEN_Msk);
+    flash_regs->ACR = acr;
+    flash_regs->ACR = acr | FLASH_ACR_ICRST_Msk | FLASH_ACR_DCRST_Msk;
+    flash_regs->ACR = acr;
+
+    if (features & FLASH_ACCEL_PREFETCH) { acr |= FLASH_ACR_PRFTEN_Msk; }
+    if (features & FLASH_ACCEL_ICACHE) { acr |= FLASH_ACR_ICEN_Msk; }
+    if (features & FLASH_ACCEL_DCACHE) { acr |= FLASH_ACR_DCEN_Msk; }
+    flash_regs->ACR = acr;
+
+    return 0;
+}
+
+static uint32_t stm32f4_get_accelerator(struct flash_handle_t* handle) {
+    flash_reg_map_t* flash_regs = (flash_reg_map_t*)handle->port_hw_instance;
+    uint32_t acr = flash_regs->ACR;
+
+    return ((acr & FLASH_ACR_PRFTEN_Msk) ? FLASH_ACCEL_PREFETCH : 0) |
+           ((acr & FLASH_ACR_ICEN_Msk) ? FLASH_ACCEL_ICACHE : 0) |
+           ((acr & FLASH_ACR_DCEN_Msk) ? FLASH_ACCEL_DCACHE : 0);
+}
+
+static FLASH_RAMFUNC int stm32f4_erase_start(struct flash_handle_t* handle, uint8_t sector_index) {
     flash_reg_map_t* flash_regs = (flash_reg_map_t*)handle->port_hw_instance;
 
+    if (sector_index >= FLASH_SECTOR_COUNT) {
+        return -1;
+    }
+
     stm32f4_wait_for_last_operation(flash_regs);
     stm32f4_unlock(flash_regs);
 
     // Clear status flags
-    flash_regs->SR = 0xFFFFFFFF;
+    flash_regs->SR = FLASH_SR_ERR_Msk | FLASH_SR_EOP_Msk;
 
-    // Set sector erase and sector number
+    // Sector erase at the widest parallelism the supply allows
     flash_regs->CR &= ~(FLASH_CR_PSIZE_Msk | FLASH_CR_SNB_Msk);
-    flash_regs->CR |= FLASH_CR_SER_Msk | (sector_index << FLASH_CR_SNB_Pos);
+    flash_regs->CR |= FLASH_CR_SER_Msk | FLASH_PSIZE | ((uint32_t)sector_index << FLASH_CR_SNB_Pos);
 
-    // Start erase
+    // Start erase; the caller must wait for it from SRAM, see flash_poll()
     flash_regs->CR |= FLASH_CR_STRT_Msk;
 
-    stm32f4_wait_for_last_operation(flash_regs);
+    return 0;
+}
 
-    // Clear SER bit
-    flash_regs->CR &= ~FLASH_CR_SER_Msk;
+static FLASH_RAMFUNC int stm32f4_poll(struct flash_handle_t* handle) {
+    flash_reg_map_t* flash_regs = (flash_reg_map_t*)handle->port_hw_instance;
+
+    if (flash_regs->SR & FLASH_SR_BSY_Msk) {
+        return FLASH_BUSY;
+    }
 
+    // Finish the operation: leave erase mode, lock, and drop stale cache lines
+    uint32_t errors = flash_regs->SR & FLASH_SR_ERR_Msk;
+    flash_regs->SR = errors;
+    if (flash_regs->CR & FLASH_CR_SER_Msk) {
+        flash_regs->CR &= ~(FLASH_CR_SER_Msk | FLASH_CR_SNB_Msk);
+        stm32f4_flush_caches(flash_regs);
+    }
     stm32f4_lock(flash_regs);
 
-    return 0;
+    return errors ? -1 : 0;
+}
+
+static FLASH_RAMFUNC int stm32f4_erase_sector(struct flash_handle_t* handle, uint8_t sector_index) {
+    if (stm32f4_erase_start(handle, sector_index) != 0) {
+        return -1;
+    }
+
+    int ret;
+    while ((ret = stm32f4_poll(handle)) == FLASH_BUSY);
+    return ret;
 }
 
-static int stm32f4_program(struct flash_handle_t* handle, uint32_t address, const uint8_t* data, size_t len) {
+static FLASH_RAMFUNC int stm32f4_program(struct flash_handle_t* handle, uint32_t address, const uint8_t* data,
+                                         size_t len) {
     flash_reg_map_t* flash_regs = (flash_reg_map_t*)handle->port_hw_instance;
 
     stm32f4_wait_for_last_operation(flash_regs);
     stm32f4_unlock(flash_regs);
 
     // Clear status flags
-    flash_regs->SR = 0xFFFFFFFF;
-
-    // Set program size to byte and enable programming
-    flash_regs->CR &= ~FLASH_CR_PSIZE_Msk; // PSIZE = x8
+    flash_regs->SR = FLASH_SR_ERR_Msk | FLASH_SR_EOP_Msk;
     flash_regs->CR |= FLASH_CR_PG_Msk;
 
-    for (size_t i = 0; i < len; ++i) {
-        *(volatile uint8_t*)(address + i) = data[i];
-        stm32f4_wait_for_last_operation(flash_regs);
+    // Bytes up to the first aligned unit, whole units, then the remaining bytes
+    size_t head = (FLASH_UNIT_BYTES - (address % FLASH_UNIT_BYTES)) % FLASH_UNIT_BYTES;
+    if (head > len) {
+        head = len;
+    }
+    size_t units = (len - head) / FLASH_UNIT_BYTES;
+    size_t tail = len - head - units * FLASH_UNIT_BYTES;
+
+    uint32_t errors = stm32f4_program_units(flash_regs, address, data, head, FLASH_CR_PSIZE_X8, 1);
+    if (!errors) {
+        errors = stm32f4_program_units(flash_regs, address + head, data + head, units, FLASH_PSIZE,
+                                       FLASH_UNIT_BYTES);
+    }
+    if (!errors) {
+        size_t done = head + units * FLASH_UNIT_BYTES;
+        errors = stm32f4_program_units(flash_regs, address + done, data + done, tail, FLASH_CR_PSIZE_X8, 1);
     }
 
     // Disable programming
     flash_regs->CR &= ~FLASH_CR_PG_Msk;
+    flash_regs->SR = errors;
 
     stm32f4_lock(flash_regs);
 
-    return 0;
+    return errors ? -1 : 0;
 }
 
 // --- The concrete port interface for STM32F4 ---
 static const flash_port_interface_t stm32f4_port_api = {
  .set_wait_states = stm32f4_set_wait_states,
+ .set_accelerator = stm32f4_set_accelerator,
+ .get_accelerator = stm32f4_get_accelerator,
  .erase_sector = stm32f4_erase_sector,
+ .erase_start = stm32f4_erase_start,
+ .poll = stm32f4_poll,
  .program = stm32f4_program,
 };
 
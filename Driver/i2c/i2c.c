@@ -4,11 +4,12 @@
  */
 
 #include "internal/i2c_private.h"
+#include "rcc.h"
 #include <string.h>
 
 // --- Static Data ---
-static struct i2c_handle_t s_handle_pool;
-static bool s_is_handle_in_use = {false};
+static struct i2c_handle_t s_handle_pool[I2C_MAX_INSTANCES];
+static bool s_is_handle_in_use[I2C_MAX_INSTANCES] = {false};
 
 // --- Private Helper Functions ---
 static struct i2c_handle_t* allocate_handle(void) {
@@ -31,6 +32,89 @@ static void release_handle(i2c_handle_t handle) {
     }
 }
 
+/**
+ * @brief Opens the read DMA stream if the port maps one to this instance.
+ * @details Reads always go from the data register into an incrementing
+ *          buffer, so the stream is configured once here.
+ */
+static void init_dma(struct i2c_handle_t* handle) {
+    i2c_dma_map_t map;
+    if (!handle->port_api->get_dma_map(handle, &map)) {
+        return;
+    }
+
+    const dma_config_t config = {
+        .channel = map.channel,
+        .direction = DMA_DIRECTION_PERIPHERAL_TO_MEMORY,
+        .priority = DMA_PRIORITY_MEDIUM,
+        .peripheral_data_size = DMA_DATA_SIZE_8_BIT,
+        .memory_data_size = DMA_DATA_SIZE_8_BIT,
+        .memory_increment = true,
+    };
+    handle->context.dma_channel = map.channel;
+    handle->context.dma_rx = dma_init(map.dma_num, map.rx_stream, &config);
+    if (handle->context.dma_rx != NULL) {
+        dma_enable_interrupt(handle->context.dma_rx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+        dma_enable_interrupt(handle->context.dma_rx, DMA_INTERRUPT_TRANSFER_ERROR);
+    }
+}
+
+/**
+ * @brief Removes the running transaction and starts the next one.
+ * @return The transaction removed, whose callback is still to run, or NULL.
+ */
+static i2c_transaction_t* advance_queue(struct i2c_handle_t* handle) {
+    i2c_context_t* ctx = &handle->context;
+    i2c_transaction_t* p_txn = ctx->p_head;
+    if (p_txn == NULL) {
+        return NULL;
+    }
+    dma_stop_transfer(ctx->dma_rx);
+
+    // Bus idle: apply a timing change deferred by the clock listener
+    if (ctx->is_timing_stale) {
+        ctx->is_timing_stale = false;
+        handle->port_api->configure_core(handle);
+    }
+
+    ctx->p_head = p_txn->p_next;
+    if (ctx->p_head == NULL) {
+        ctx->p_tail = NULL;
+    } else {
+        handle->port_api->start_transaction(handle);
+    }
+    return p_txn;
+}
+
+void i2c_complete_transaction(struct i2c_handle_t* handle, int status) {
+    // Start the next transaction before the callback, which may queue another
+    i2c_transaction_t* p_txn = advance_queue(handle);
+    if (p_txn != NULL && p_txn->callback) {
+        p_txn->callback(p_txn->p_context, status);
+    }
+}
+
+/**
+ * @brief Recomputes the bus timing for the new APB1 clock.
+ * @details Reconfiguring disables the peripheral, so with a transaction on
+ *          the bus it is deferred to i2c_complete_transaction().
+ */
+static void i2c_clock_listener(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change, void* p_context) {
+    struct i2c_handle_t* handle = (struct i2c_handle_t*)p_context;
+    if (phase != RCC_CLOCK_POST_CHANGE || !handle->context.is_initialized) {
+        return;
+    }
+
+    uint32_t state = handle->port_api->irq_lock();
+    memcpy((void*)&handle->config.peripheral_clock_hz, &p_change->to.apb1_hz, sizeof(uint32_t));
+    if (handle->context.p_head == NULL) {
+        handle->port_api->configure_core(handle);
+    } else {
+        handle->context.is_timing_stale = true;
+    }
+    handle->port_api->irq_unlock(state);
+}
+
 // --- Public API Function Implementations ---
 
 i2c_handle_t i2c_init(uint8_t instance_num, const i2c_config_t* config) {
@@ -47,19 +131,27 @@ i2c_handle_t i2c_init(uint8_t instance_num, const i2c_config_t* config) {
     *(const i2c_port_interface_t**)&handle->port_api = i2c_port_get_api();
     *(void**)&handle->port_hw_instance = i2c_port_get_base_addr(instance_num);
 
-    if (handle->port_api == NULL |
-
-| handle->port_hw_instance == NULL) {
+    if (handle->port_api == NULL || handle->port_hw_instance == NULL) {
         release_handle(handle);
         return NULL;
     }
 
     memcpy((void*)&handle->config, config, sizeof(i2c_config_t));
+    if (rcc_register_clock_listener(i2c_clock_listener, handle) != 0) {
+        release_handle(handle);
+        return NULL;
+    }
 
     handle->port_api->enable_clock(instance_num);
     handle->port_api->init_pins(instance_num);
     handle->port_api->configure_core(handle);
 
+    // Without interrupts the instance still supports blocking transfers
+    handle->context.is_async = handle->port_api->enable_irqs(handle);
+    if (handle->context.is_async) {
+        init_dma(handle);
+    }
+
     handle->context.is_initialized = true;
     return handle;
 }
@@ -67,25 +159,99 @@ i2c_handle_t i2c_init(uint8_t instance_num, const i2c_config_t* config) {
 void i2c_deinit(i2c_handle_t* p_handle) {
     if (p_handle!= NULL && *p_handle!= NULL) {
         // Add peripheral disable logic here if needed
+        rcc_unregister_clock_listener(i2c_clock_listener, *p_handle);
+        (*p_handle)->context.is_initialized = false;
+        dma_deinit(&(*p_handle)->context.dma_rx);
         release_handle(*p_handle);
         *p_handle = NULL;
     }
 }
 
 int i2c_master_write_blocking(i2c_handle_t handle, uint8_t slave_addr, const uint8_t* p_data, size_t len) {
-    if (handle == NULL |
-
-| p_data == NULL ||!handle->context.is_initialized) {
+    if (handle == NULL || p_data == NULL ||!handle->context.is_initialized) {
         return -1; // Invalid arguments
     }
+    if (handle->context.p_head != NULL) {
+        return -1; // An asynchronous transaction holds the bus
+    }
     return handle->port_api->master_write(handle, slave_addr, p_data, len);
 }
 
 int i2c_master_read_blocking(i2c_handle_t handle, uint8_t slave_addr, uint8_t* p_data, size_t len) {
-    if (handle == NULL |
-
-| p_data == NULL ||!handle->context.is_initialized) {
+    if (handle == NULL || p_data == NULL ||!handle->context.is_initialized) {
         return -1; // Invalid arguments
     }
+    if (handle->context.p_head != NULL) {
+        return -1; // An asynchronous transaction holds the bus
+    }
     return handle->port_api->master_read(handle, slave_addr, p_data, len);
 }
+
+int i2c_transfer_async(i2c_handle_t handle, i2c_transaction_t* p_txn) {
+    if (handle == NULL || !handle->context.is_initialized || !handle->context.is_async || p_txn == NULL ||
+        (p_txn->write_len == 0 && p_txn->read_len == 0) || p_txn->read_len > 0xFFFF ||
+        (p_txn->write_len != 0 && p_txn->p_write == NULL) || (p_txn->read_len != 0 && p_txn->p_read == NULL)) {
+        return I2C_ERROR_ARGUMENT;
+    }
+
+    p_txn->p_next = NULL;
+
+    uint32_t state = handle->port_api->irq_lock();
+    if (handle->context.p_head == NULL) {
+        handle->context.p_head = p_txn;
+        handle->context.p_tail = p_txn;
+        handle->port_api->start_transaction(handle);
+    } else {
+        handle->context.p_tail->p_next = p_txn;
+        handle->context.p_tail = p_txn;
+    }
+    handle->port_api->irq_unlock(state);
+
+    return I2C_OK;
+}
+
+bool i2c_abort(i2c_handle_t handle, i2c_transaction_t* p_txn) {
+    if (handle == NULL || !handle->context.is_async || p_txn == NULL) {
+        return false;
+    }
+    i2c_context_t* ctx = &handle->context;
+
+    uint32_t state = handle->port_api->irq_lock();
+    if (ctx->p_head == p_txn) {
+        // The slave may be holding the bus in the middle of a byte. Clocking
+        // it out takes up to a millisecond, so it runs outside the lock; the
+        // interrupt handlers leave the transaction alone meanwhile.
+        ctx->is_recovering = true;
+        handle->port_api->irq_unlock(state);
+        handle->port_api->recover_bus(handle);
+
+        state = handle->port_api->irq_lock();
+        ctx->is_recovering = false;
+        (void)advance_queue(handle);
+        handle->port_api->irq_unlock(state);
+    } else {
+        i2c_transaction_t* p_prev = ctx->p_head;
+        while (p_prev != NULL && p_prev->p_next != p_txn) {
+            p_prev = p_prev->p_next;
+        }
+        if (p_prev == NULL) {
+            handle->port_api->irq_unlock(state);
+            return false;
+        }
+        p_prev->p_next = p_txn->p_next;
+        if (ctx->p_tail == p_txn) {
+            ctx->p_tail = p_prev;
+        }
+        handle->port_api->irq_unlock(state);
+    }
+
+    // Task context, like the caller
+    if (p_txn->callback) {
+        p_txn->callback(p_txn->p_context, I2C_ERROR_TIMEOUT);
+    }
+    return true;
+}
+
+bool i2c_is_busy(i2c_handle_t handle) {
+    return handle != NULL && handle->context.p_head != NULL;
+}
@@ -49,10 +49,56 @@ typedef struct {
     uint32_t  AnalogNoiseFilter;  // Enable/Disable
 } i2c_config_t;
 
+/** @brief Status codes of I2C transfers. */
+typedef enum {
+    I2C_OK = 0,
+    I2C_ERROR_ARGUMENT = -1,        //!< Invalid arguments or no asynchronous support
+    I2C_ERROR_NACK = -2,            //!< Address or data byte not acknowledged
+    I2C_ERROR_BUS = -3,             //!< Misplaced START/STOP on the bus
+    I2C_ERROR_ARBITRATION = -4,     //!< Arbitration lost to another master
+    I2C_ERROR_TIMEOUT = -5,         //!< Aborted with i2c_abort(), e.g. a slave holding SCL low
+    I2C_ERROR_DMA = -6,             //!< DMA transfer error
+} i2c_status_t;
+
+/**
+ * @brief Completion callback for an asynchronous transaction.
+ * @details Called from interrupt context, or, with I2C_ERROR_TIMEOUT, from
+ *          the task calling i2c_abort(). A callback that signals a task must
+ *          use the FreeRTOS API matching the context it runs in
+ *          (xPortIsInsideInterrupt()).
+ *
+ * @param[in] p_context The context stored in the transaction.
+ * @param[in] status I2C_OK, or a negative i2c_status_t.
+ */
+typedef void (*i2c_callback_t)(void* p_context, int status);
+
+/**
+ * @brief One asynchronous transaction, owned by the caller.
+ * @details The write phase runs first; if there is also a read phase it
+ *          follows after a repeated START, without releasing the bus. A
+ *          register read is a one-byte write of the register address and a
+ *          read of the data. Either phase may be empty, not both. The
+ *          structure and its buffers must stay valid until the callback runs.
+ */
+typedef struct i2c_transaction_t {
+    uint8_t slave_addr;                 //!< 7-bit slave address
+    const uint8_t* p_write;             //!< Bytes written first, e.g. a register address
+    size_t write_len;
+    uint8_t* p_read;                    //!< Bytes read after the repeated START
+    size_t read_len;                    //!< At most 65535
+    i2c_callback_t callback;            //!< Completion callback; may be NULL
+    void* p_context;                    //!< Passed to the callback
+    struct i2c_transaction_t* p_next;   //!< Used by the driver
+} i2c_transaction_t;
+
 /* --- Public API Functions --- */
 
 /**
  * @brief Initializes an I2C peripheral instance in master mode.
+ * @details The instance follows rcc_set_sysclk(): CR2 FREQ, CCR and TRISE are
+ *          recomputed from the new APB1 clock, which replaces
+ *          `peripheral_clock_hz`. A transaction running at the change ends
+ *          with the old timing; the new one applies from the next.
  *
  * @param[in] instance_num The hardware instance number (e.g., 1 for I2C1).
  * @param[in] config Pointer to the user-provided configuration structure.
@@ -92,4 +138,46 @@ int i2c_master_write_blocking(i2c_handle_t handle, uint8_t slave_addr, const uin
  */
 int i2c_master_read_blocking(i2c_handle_t handle, uint8_t slave_addr, uint8_t* p_data, size_t len);
 
+/**
+ * @brief Queues a transaction that runs on interrupts and DMA.
+ *
+ * @details Returns immediately. Transactions on one handle run in submission
+ *          order. Bytes are written from the event interrupt; reads of two or
+ *          more bytes run on DMA, so the CPU is involved only at the START,
+ *          the address phases and the end. After a NACK the driver sends STOP;
+ *          after a bus error or lost arbitration it resets the peripheral, and
+ *          the next transaction starts on a clean bus.
+ *
+ * @param[in] handle The handle to the I2C instance.
+ * @param[in,out] p_txn The transaction to queue.
+ *
+ * @return I2C_OK, or I2C_ERROR_ARGUMENT if the transaction is invalid or the
+ *         instance has no asynchronous support.
+ */
+int i2c_transfer_async(i2c_handle_t handle, i2c_transaction_t* p_txn);
+
+/**
+ * @brief Removes a transaction that has not completed.
+ *
+ * @details A running transaction is stopped and the bus recovered: the
+ *          peripheral is reset and SCL is clocked until a slave stuck in the
+ *          middle of a byte releases SDA. That takes up to a millisecond
+ *          and runs with interrupts enabled. A queued one is just unlinked.
+ *          Its callback runs in the calling task with I2C_ERROR_TIMEOUT
+ *          before this returns. Task context only.
+ *
+ * @param[in] handle The handle to the I2C instance.
+ * @param[in] p_txn The transaction to abort.
+ *
+ * @return true if the transaction was removed, false if it had already completed.
+ */
+bool i2c_abort(i2c_handle_t handle, i2c_transaction_t* p_txn);
+
+/**
+ * @brief Checks whether any asynchronous transaction is queued or running.
+ * @param[in] handle The handle to the I2C instance.
+ * @return true if the bus is busy, false otherwise.
+ */
+bool i2c_is_busy(i2c_handle_t handle);
+
 #endif // I2C_H
@@ -11,4 +11,29 @@
  */
 #define I2C_MAX_INSTANCES 2
 
+/**
+ * @brief NVIC priority of the event, error and DMA interrupts of
+ *        i2c_transfer_async().
+ * @note  Must not be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY if
+ *        completion callbacks use the FreeRTOS FromISR API.
+ */
+#define I2C_IRQ_PRIORITY 6
+
+/**
+ * @brief SCL and SDA of each instance, which bus recovery drives as GPIO.
+ * @details Ports are numbered as in gpio_init() (0 = GPIOA). The defaults are
+ *          the STM32F4-Discovery wiring: I2C1 on PB6/PB9 (CS43L22), I2C2 on
+ *          PB10/PB11.
+ */
+#ifndef I2C1_GPIO_PORT
+#define I2C1_GPIO_PORT 1
+#define I2C1_SCL_PIN 6
+#define I2C1_SDA_PIN 9
+#endif
+#ifndef I2C2_GPIO_PORT
+#define I2C2_GPIO_PORT 1
+#define I2C2_SCL_PIN 10
+#define I2C2_SDA_PIN 11
+#endif
+
 #endif // I2C_CONFIG_H
@@ -9,12 +9,22 @@
 #include "i2c.h"
 #include "i2c_config.h"
 #include "port/i2c_port.h"
+#include "dma.h"
 
 /**
  * @brief Internal runtime state for an I2C instance.
  */
 typedef struct {
     bool is_initialized;
+    bool is_async;                      // Event/error interrupts set up
+    dma_handle_t dma_rx;                // NULL when reads have no DMA stream
+    uint8_t dma_channel;
+    i2c_transaction_t* volatile p_head; // Running transaction
+    i2c_transaction_t* p_tail;
+    size_t index;                       // Bytes done in the current phase, used by the port
+    bool is_reading;                    // Current phase, used by the port
+    bool is_timing_stale;               // APB1 changed during a transaction
+    volatile bool is_recovering;        // i2c_abort() is clearing the bus; the handlers stand back
 } i2c_context_t;
 
 /**
@@ -27,4 +37,14 @@ struct i2c_handle_t {
     void* port_hw_instance;
 };
 
+/**
+ * @brief Ends the running transaction and starts the next one.
+ * @note  Called by the port from its interrupt handlers, after the bus has
+ *        been released (STOP sent or peripheral reset).
+ *
+ * @param[in] handle The instance.
+ * @param[in] status I2C_OK or a negative i2c_status_t.
+ */
+void i2c_complete_transaction(struct i2c_handle_t* handle, int status);
+
 #endif // I2C_PRIVATE_H
@@ -309,6 +309,19 @@ enum i2c_cr2_freq_values  {
  */
 #define I2C_FLTR_ANOFF		(1<<4)
 
-
+/* --- Field positions and masks used by the port --- */
+#define I2C_CR1_PE_Msk          I2C_CR1_PE
+#define I2C_CR1_START_Msk       I2C_CR1_START
+#define I2C_CR1_STOP_Msk        I2C_CR1_STOP
+#define I2C_CR1_ACK_Msk         I2C_CR1_ACK
+#define I2C_CR2_FREQ_Pos        (0U)
+#define I2C_CR2_FREQ_Msk        (0x3FUL << I2C_CR2_FREQ_Pos)
+#define I2C_CCR_FS_Msk          I2C_CCR_FS
+#define I2C_CCR_CCR_Msk         (0xFFFUL)
+#define I2C_SR1_SB_Msk          I2C_SR1_SB
+#define I2C_SR1_ADDR_Msk        I2C_SR1_ADDR
+#define I2C_SR1_BTF_Msk         I2C_SR1_BTF
+#define I2C_SR1_TxE_Msk         I2C_SR1_TxE
+#define I2C_SR1_RxNE_Msk        I2C_SR1_RxNE
 
 #endif // I2C_REG_H
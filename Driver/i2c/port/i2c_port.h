@@ -8,6 +8,15 @@
 
 struct i2c_handle_t;
 
+/**
+ * @brief DMA stream serving the reads of one I2C instance.
+ */
+typedef struct {
+    uint8_t dma_num;
+    uint8_t rx_stream;
+    uint8_t channel;
+} i2c_dma_map_t;
+
 /**
  * @brief A structure of function pointers that defines the hardware-dependent
  *        operations required by the I2C driver.
@@ -18,6 +27,13 @@ typedef struct {
     void (*configure_core)(struct i2c_handle_t* handle);
     int (*master_write)(struct i2c_handle_t* handle, uint8_t addr, const uint8_t* data, size_t len);
     int (*master_read)(struct i2c_handle_t* handle, uint8_t addr, uint8_t* data, size_t len);
+    bool (*get_dma_map)(struct i2c_handle_t* handle, i2c_dma_map_t* p_map);
+    volatile void* (*get_data_register)(struct i2c_handle_t* handle);
+    bool (*enable_irqs)(struct i2c_handle_t* handle);
+    void (*start_transaction)(struct i2c_handle_t* handle);
+    void (*recover_bus)(struct i2c_handle_t* handle);
+    uint32_t (*irq_lock)(void);                 // Masks the I2C interrupts; returns the state to restore
+    void (*irq_unlock)(uint32_t state);
 } i2c_port_interface_t;
 
 /* --- Functions to be provided by the concrete port implementation --- */
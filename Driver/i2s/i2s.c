@@ -0,0 +1,427 @@
+/**
+ * @file      i2s.c
+ * @brief     Hardware-agnostic implementation of the I2S driver.
+ */
+
+#include "internal/i2s_private.h"
+#include "internal/i2s_clock_table.h"
+#include "rcc.h"
+#include <string.h>
+
+// Linear prescaler 2 * I2SDIV + ODD, with I2SDIV in 2..255
+#define I2S_PRESCALER_MIN   4U
+#define I2S_PRESCALER_MAX   511U
+
+#define CLOCK_TABLE_SIZE    (sizeof(s_clock_table) / sizeof(s_clock_table[0]))
+
+/** @brief A row of the precomputed clock table. */
+typedef struct {
+    uint32_t rate_hz;
+    uint32_t actual_mhz;
+    uint16_t factor;
+    uint16_t plli2sn;
+    uint8_t plli2sr;
+    uint8_t i2sdiv;
+    bool odd;
+} i2s_clock_entry_t;
+
+// Every row must be a valid setting (DS8626: PLLI2S VCO 100..432 MHz, I2SxCLK
+// at most 192 MHz) whose error by the reference manual formula matches its
+// error column and stays within the limit i2s_init() enforces
+#define CHECK_CLOCK_ROW(rate, factor, n, r, div, odd, ppm) \
+    _Static_assert((n) >= 50 && (n) <= 432 && (r) >= 2 && (r) <= 7, "PLLI2S factor out of range"); \
+    _Static_assert(I2S_CLOCK_TABLE_INPUT_HZ * (n) >= 100000000ULL && \
+                   I2S_CLOCK_TABLE_INPUT_HZ * (n) <= 432000000ULL && \
+                   I2S_CLOCK_TABLE_INPUT_HZ * (n) / (r) <= 192000000ULL, "PLLI2S frequency out of range"); \
+    _Static_assert((div) >= 2 && (div) <= 255 && (odd) <= 1, "I2S prescaler out of range"); \
+    _Static_assert(I2S_CLOCK_ERROR_PPM(rate, factor, n, r, div, odd) == (ppm), "clock table error column"); \
+    _Static_assert((ppm) <= I2S_MAX_RATE_ERROR_PPM && (ppm) >= -I2S_MAX_RATE_ERROR_PPM, "clock table error too large");
+I2S_CLOCK_TABLE(CHECK_CLOCK_ROW)
+#undef CHECK_CLOCK_ROW
+
+// --- Static Data ---
+static struct i2s_handle_t s_handle_pool[I2S_MAX_INSTANCES];
+static bool s_is_handle_in_use[I2S_MAX_INSTANCES] = {false};
+
+// PLLI2S factors programmed by this driver, kept while any instance uses them
+static uint16_t s_plli2sn = 0;
+static uint8_t s_plli2sr = 0;
+
+#define CLOCK_ENTRY(rate, factor, n, r, div, odd, ppm) \
+    {(rate), (uint32_t)I2S_CLOCK_ACTUAL_MHZ(factor, n, r, div, odd), (factor), (n), (r), (div), (odd)},
+static const i2s_clock_entry_t s_clock_table[] = {
+    I2S_CLOCK_TABLE(CLOCK_ENTRY)
+};
+#undef CLOCK_ENTRY
+
+// --- Private Helper Functions ---
+static struct i2s_handle_t* allocate_handle(void) {
+    for (int i = 0; i < I2S_MAX_INSTANCES; ++i) {
+        if (!s_is_handle_in_use[i]) {
+            s_is_handle_in_use[i] = true;
+            memset(&s_handle_pool[i], 0, sizeof(struct i2s_handle_t));
+            return &s_handle_pool[i];
+        }
+    }
+    return NULL;
+}
+
+static void release_handle(i2s_handle_t handle) {
+    for (int i = 0; i < I2S_MAX_INSTANCES; ++i) {
+        if (handle == &s_handle_pool[i]) {
+            s_is_handle_in_use[i] = false;
+            return;
+        }
+    }
+}
+
+static bool is_pll_in_use(void) {
+    for (int i = 0; i < I2S_MAX_INSTANCES; ++i) {
+        if (s_is_handle_in_use[i] && s_handle_pool[i].context.is_initialized) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_config_valid(const I2S_Init_t* config) {
+    return config != NULL &&
+           (config->Mode == I2S_MODE_MASTER_TX || config->Mode == I2S_MODE_MASTER_RX) &&
+           config->Standard <= I2S_STANDARD_PCM_LONG &&
+           config->DataLength <= I2S_DATA_LENGTH_32B &&
+           config->ChannelLength <= I2S_CHANNEL_LENGTH_32B &&
+           config->ClockPolarity <= I2S_CPOL_HIGH &&
+           config->MCLKOutput <= I2S_MCLK_OUTPUT_ENABLE &&
+           config->AudioFrequency != 0;
+}
+
+/**
+ * @brief Gets the I2SxCLK cycles per frame before the linear prescaler.
+ * @details Fs = I2SxCLK / (factor * (2 * I2SDIV + ODD)), where the factor is
+ *          256 with MCLK output, else the bits per frame (2 channel slots).
+ */
+static uint32_t frame_clock_factor(const I2S_Init_t* config) {
+    if (config->MCLKOutput == I2S_MCLK_OUTPUT_ENABLE) {
+        return 256;
+    }
+    bool wide = (config->ChannelLength == I2S_CHANNEL_LENGTH_32B) ||
+                (config->DataLength != I2S_DATA_LENGTH_16B);
+    return wide ? 64 : 32;
+}
+
+/**
+ * @brief Picks the prescaler giving the rate closest to the request.
+ * @details The I2SxCLK is vco_hz / plli2sr; keeping the division in the
+ *          formula avoids truncating it to whole hertz first.
+ * @return The achieved rate in millihertz, or 0 if no prescaler is in range.
+ */
+static uint32_t fit_prescaler(uint64_t vco_hz, uint32_t plli2sr, uint32_t rate_hz, uint32_t factor,
+                              uint32_t* p_prescaler) {
+    uint64_t step = (uint64_t)rate_hz * factor * plli2sr;
+    uint64_t prescaler = (vco_hz + step / 2) / step;
+    if (prescaler < I2S_PRESCALER_MIN || prescaler > I2S_PRESCALER_MAX) {
+        return 0;
+    }
+    *p_prescaler = (uint32_t)prescaler;
+    return (uint32_t)((vco_hz * 1000) / ((uint64_t)plli2sr * factor * prescaler));
+}
+
+static uint32_t rate_distance(uint32_t actual_mhz, uint32_t rate_hz) {
+    uint64_t target_mhz = (uint64_t)rate_hz * 1000;
+    return (uint32_t)((actual_mhz > target_mhz) ? actual_mhz - target_mhz : target_mhz - actual_mhz);
+}
+
+/**
+ * @brief Looks the request up in the precomputed table.
+ * @return true if the table covers the PLL input, rate and factor.
+ */
+static bool lookup_clock(uint32_t input_hz, uint32_t rate_hz, uint32_t factor,
+                         i2s_clock_info_t* p_info, uint32_t* p_prescaler) {
+    if (input_hz != I2S_CLOCK_TABLE_INPUT_HZ) {
+        return false;
+    }
+    for (size_t i = 0; i < CLOCK_TABLE_SIZE; ++i) {
+        const i2s_clock_entry_t* entry = &s_clock_table[i];
+        if (entry->rate_hz == rate_hz && entry->factor == factor) {
+            p_info->plli2sn = entry->plli2sn;
+            p_info->plli2sr = entry->plli2sr;
+            p_info->i2sclk_hz = (uint32_t)((I2S_CLOCK_TABLE_INPUT_HZ * entry->plli2sn) / entry->plli2sr);
+            p_info->actual_mhz = entry->actual_mhz;
+            *p_prescaler = 2U * entry->i2sdiv + entry->odd;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Searches every valid PLLI2S setting for the lowest rate error.
+ * @details Fallback for PLL inputs and rates the table does not cover.
+ * @return true if some setting fits the prescaler range.
+ */
+static bool search_clock(uint32_t input_hz, uint32_t rate_hz, uint32_t factor,
+                         i2s_clock_info_t* p_info, uint32_t* p_prescaler) {
+    uint32_t best_distance = UINT32_MAX;
+    *p_prescaler = 0;
+    for (uint32_t r = I2S_PLLI2SR_SEARCH_MIN; r <= I2S_PLLI2SR_SEARCH_MAX && best_distance != 0; ++r) {
+        for (uint32_t n = I2S_PLLI2SN_SEARCH_MIN; n <= I2S_PLLI2SN_SEARCH_MAX && best_distance != 0; ++n) {
+            if (!rcc_is_plli2s_valid(n, r)) {
+                continue;
+            }
+            uint64_t vco_hz = (uint64_t)input_hz * n;
+            uint32_t prescaler;
+            uint32_t actual = fit_prescaler(vco_hz, r, rate_hz, factor, &prescaler);
+            if (actual != 0 && rate_distance(actual, rate_hz) < best_distance) {
+                best_distance = rate_distance(actual, rate_hz);
+                *p_prescaler = prescaler;
+                p_info->plli2sn = (uint16_t)n;
+                p_info->plli2sr = (uint8_t)r;
+                p_info->i2sclk_hz = (uint32_t)(vco_hz / r);
+                p_info->actual_mhz = actual;
+            }
+        }
+    }
+    return *p_prescaler != 0;
+}
+
+/**
+ * @brief Chooses the PLLI2S factors and prescaler, and starts the PLLI2S.
+ * @details Takes the precomputed setting for the standard rates, else
+ *          searches every valid PLLI2S setting. If another instance already
+ *          runs from the PLLI2S, only the prescaler is chosen for the
+ *          existing I2SxCLK.
+ */
+static bool setup_clock(struct i2s_handle_t* handle) {
+    const I2S_Init_t* config = &handle->config;
+    i2s_clock_info_t* p_info = &handle->context.clock;
+    uint32_t factor = frame_clock_factor(config);
+    uint32_t rate = config->AudioFrequency;
+    uint32_t prescaler = 0;
+
+    if (is_pll_in_use()) {
+        uint32_t actual = fit_prescaler((uint64_t)rcc_get_pll_input_frequency() * s_plli2sn, s_plli2sr,
+                                        rate, factor, &prescaler);
+        if (actual == 0) {
+            return false;
+        }
+        p_info->plli2sn = s_plli2sn;
+        p_info->plli2sr = s_plli2sr;
+        p_info->i2sclk_hz = rcc_get_plli2s_frequency();
+        p_info->actual_mhz = actual;
+    } else {
+        uint32_t input_hz = rcc_get_pll_input_frequency();
+        if (!lookup_clock(input_hz, rate, factor, p_info, &prescaler) &&
+            !search_clock(input_hz, rate, factor, p_info, &prescaler)) {
+            return false;
+        }
+        if (!rcc_configure_plli2s(p_info->plli2sn, p_info->plli2sr)) {
+            return false;
+        }
+        s_plli2sn = p_info->plli2sn;
+        s_plli2sr = p_info->plli2sr;
+    }
+
+    int64_t error = ((int64_t)p_info->actual_mhz - (int64_t)rate * 1000) * 1000000 / ((int64_t)rate * 1000);
+    p_info->requested_hz = rate;
+    p_info->error_ppm = (int32_t)error;
+    p_info->i2sdiv = (uint8_t)(prescaler / 2);
+    p_info->odd = (prescaler & 1) != 0;
+    return error <= I2S_MAX_RATE_ERROR_PPM && error >= -I2S_MAX_RATE_ERROR_PPM;
+}
+
+/**
+ * @brief Sets up and starts the double-buffered DMA stream of one direction.
+ * @param[in] ext true if the I2Sxext partner carries this direction.
+ * @return The DMA handle, or NULL if no stream is available.
+ */
+static dma_handle_t open_stream(struct i2s_handle_t* handle, bool ext, bool is_rx) {
+    i2s_dma_route_t route;
+    if (!handle->port_api->get_dma_route(handle, ext, &route)) {
+        return NULL;
+    }
+
+    const dma_config_t config = {
+        .channel = route.channel,
+        .direction = is_rx ? DMA_DIRECTION_PERIPHERAL_TO_MEMORY : DMA_DIRECTION_MEMORY_TO_PERIPHERAL,
+        .priority = DMA_PRIORITY_VERY_HIGH,
+        .peripheral_data_size = DMA_DATA_SIZE_16_BIT,
+        .memory_data_size = DMA_DATA_SIZE_16_BIT,
+        .memory_increment = true,
+        .double_buffer_mode = true,
+    };
+    dma_handle_t dma = dma_init(route.dma_num, route.stream, &config);
+    if (dma == NULL) {
+        return NULL;
+    }
+
+    uint16_t block = handle->context.stream.block_samples;
+    int16_t* p_buffer = is_rx ? handle->context.stream.p_rx_buffer : handle->context.stream.p_tx_buffer;
+    dma_enable_interrupt(dma, DMA_INTERRUPT_TRANSFER_ERROR);
+    // No requests flow until the port enables them, so the stream waits
+    dma_start_double_buffer(dma, handle->port_api->get_data_register(handle, ext),
+                            p_buffer, p_buffer + block, block);
+    handle->port_api->enable_dma_irq(handle, ext, true);
+    return dma;
+}
+
+static void close_streams(struct i2s_handle_t* handle) {
+    // The partner carries the direction the instance itself does not
+    bool main_rx = (handle->config.Mode == I2S_MODE_MASTER_RX);
+    if (handle->context.dma_rx) {
+        handle->port_api->enable_dma_irq(handle, !main_rx, false);
+        dma_deinit(&handle->context.dma_rx);
+    }
+    if (handle->context.dma_tx) {
+        handle->port_api->enable_dma_irq(handle, main_rx, false);
+        dma_deinit(&handle->context.dma_tx);
+    }
+}
+
+static void count_dma_error(struct i2s_handle_t* handle, dma_handle_t dma) {
+    if (dma && dma_is_interrupt_flag_set(dma, DMA_INTERRUPT_TRANSFER_ERROR)) {
+        dma_clear_interrupt_flag(dma, DMA_INTERRUPT_TRANSFER_ERROR);
+        handle->context.dma_errors++;
+    }
+}
+
+// --- Driver-internal Functions ---
+
+void i2s_dma_irq_handler(struct i2s_handle_t* handle) {
+    i2s_context_t* ctx = &handle->context;
+    count_dma_error(handle, ctx->dma_rx);
+    count_dma_error(handle, ctx->dma_tx);
+
+    // Capture paces the callback when present; in full duplex both
+    // directions switch blocks on the same frame
+    dma_handle_t pace = ctx->dma_rx ? ctx->dma_rx : ctx->dma_tx;
+    if (pace == NULL || !dma_is_interrupt_flag_set(pace, DMA_INTERRUPT_TRANSFER_COMPLETE)) {
+        return;
+    }
+    dma_clear_interrupt_flag(pace, DMA_INTERRUPT_TRANSFER_COMPLETE);
+
+    // Each stream has just switched buffers: the other block is complete (RX)
+    // or played out (TX)
+    uint16_t block = ctx->stream.block_samples;
+    const int16_t* p_rx_block = NULL;
+    int16_t* p_tx_block = NULL;
+    if (ctx->dma_rx) {
+        p_rx_block = ctx->stream.p_rx_buffer + (dma_get_current_buffer(ctx->dma_rx) ? 0 : block);
+    }
+    if (ctx->dma_tx) {
+        p_tx_block = ctx->stream.p_tx_buffer + (dma_get_current_buffer(ctx->dma_tx) ? 0 : block);
+    }
+
+    ctx->blocks++;
+    if (ctx->stream.callback) {
+        ctx->stream.callback(ctx->stream.p_context, p_rx_block, p_tx_block);
+    }
+}
+
+// --- Public API Function Implementations ---
+
+i2s_handle_t i2s_init(uint8_t instance_num, const I2S_Init_t* config) {
+    if (!is_config_valid(config)) {
+        return NULL;
+    }
+
+    struct i2s_handle_t* handle = allocate_handle();
+    if (handle == NULL) {
+        return NULL;
+    }
+
+    handle->port_api = i2s_port_get_api_for_instance(instance_num);
+    handle->port_hw_instance = i2s_port_get_base_addr_for_instance(instance_num);
+    handle->port_ext_instance = i2s_port_get_ext_addr_for_instance(instance_num);
+
+    if (handle->port_api == NULL || handle->port_hw_instance == NULL || handle->port_ext_instance == NULL) {
+        release_handle(handle);
+        return NULL;
+    }
+
+    memcpy((void*)&handle->config, config, sizeof(I2S_Init_t));
+
+    if (!setup_clock(handle)) {
+        release_handle(handle);
+        return NULL;
+    }
+
+    handle->port_api->enable_clock(handle);
+    handle->port_api->init_pins(handle);
+    handle->port_api->configure(handle, handle->context.clock.i2sdiv, handle->context.clock.odd);
+
+    handle->context.is_initialized = true;
+    return handle;
+}
+
+void i2s_deinit(i2s_handle_t* p_handle) {
+    if (p_handle == NULL || *p_handle == NULL) {
+        return;
+    }
+    i2s_handle_t handle = *p_handle;
+
+    i2s_stop_stream(handle);
+    handle->context.is_initialized = false;
+    release_handle(handle);
+    *p_handle = NULL;
+}
+
+int i2s_start_stream(i2s_handle_t handle, const i2s_stream_config_t* stream) {
+    if (handle == NULL || !handle->context.is_initialized || handle->context.is_streaming ||
+        stream == NULL || (stream->p_rx_buffer == NULL && stream->p_tx_buffer == NULL) ||
+        stream->block_samples == 0 || (stream->block_samples & 1)) {
+        return -1;
+    }
+
+    bool main_rx = (handle->config.Mode == I2S_MODE_MASTER_RX);
+    bool full_duplex = (stream->p_rx_buffer != NULL) && (stream->p_tx_buffer != NULL);
+    // Without the partner only the instance's own direction is available
+    if (!full_duplex && ((stream->p_rx_buffer != NULL) != main_rx)) {
+        return -1;
+    }
+
+    i2s_context_t* ctx = &handle->context;
+    ctx->stream = *stream;
+    ctx->blocks = 0;
+    ctx->dma_errors = 0;
+    if (stream->p_tx_buffer) {
+        memset(stream->p_tx_buffer, 0, 2 * (size_t)stream->block_samples * sizeof(int16_t));
+    }
+
+    if (stream->p_rx_buffer) {
+        ctx->dma_rx = open_stream(handle, !main_rx, true);
+    }
+    if (stream->p_tx_buffer) {
+        ctx->dma_tx = open_stream(handle, main_rx, false);
+    }
+    if ((stream->p_rx_buffer && ctx->dma_rx == NULL) || (stream->p_tx_buffer && ctx->dma_tx == NULL)) {
+        close_streams(handle);
+        return -1;
+    }
+
+    dma_enable_interrupt(ctx->dma_rx ? ctx->dma_rx : ctx->dma_tx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    ctx->is_streaming = true;
+    handle->port_api->start(handle, full_duplex);
+    return 0;
+}
+
+void i2s_stop_stream(i2s_handle_t handle) {
+    if (handle == NULL || !handle->context.is_streaming) {
+        return;
+    }
+    handle->port_api->stop(handle);
+    close_streams(handle);
+    handle->context.is_streaming = false;
+}
+
+void i2s_get_clock_info(i2s_handle_t handle, i2s_clock_info_t* p_info) {
+    if (handle && p_info) {
+        *p_info = handle->context.clock;
+    }
+}
+
+void i2s_get_stats(i2s_handle_t handle, i2s_stats_t* p_stats) {
+    if (handle && p_stats) {
+        p_stats->blocks = handle->context.blocks;
+        p_stats->dma_errors = handle->context.dma_errors;
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * @file      i2s.h
+ * @brief     Public API for the portable I2S streaming driver.
+ *
+ * @details   Runs an SPI/I2S instance as an I2S master configured from an
+ *            I2S_Init_t (see spi.h). The bit clock is derived from the PLLI2S,
+ *            which the driver programs through the RCC driver for the closest
+ *            achievable sample rate; the remaining rate error is reported.
+ *
+ *            Audio is streamed by DMA in blocks. Each direction runs a
+ *            double-buffered DMA stream over two blocks, and a block callback
+ *            is called from the DMA interrupt each time a block completes,
+ *            with the block just captured and the block to fill for playback.
+ *            A stream is full-duplex when both directions are given: the
+ *            instance then pairs with its I2Sxext partner, which runs as a
+ *            slave on the same bit and word clocks, so capture and playback
+ *            stay sample-locked indefinitely.
+ */
+
+#ifndef I2S_H
+#define I2S_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "spi.h"
+
+/* --- I2S_Init_t Field Values --- */
+
+/** @brief Mode: direction of the instance itself. The I2Sxext partner runs the other way. */
+#define I2S_MODE_MASTER_TX          2
+#define I2S_MODE_MASTER_RX          3
+
+/** @brief Standard: frame format. */
+#define I2S_STANDARD_PHILIPS        0
+#define I2S_STANDARD_MSB            1
+#define I2S_STANDARD_LSB            2
+#define I2S_STANDARD_PCM_SHORT      3
+#define I2S_STANDARD_PCM_LONG       4
+
+/** @brief DataLength: bits per sample. */
+#define I2S_DATA_LENGTH_16B         0
+#define I2S_DATA_LENGTH_24B         1
+#define I2S_DATA_LENGTH_32B         2
+
+/** @brief ChannelLength: bits per channel slot. Forced to 32 for 24/32-bit data. */
+#define I2S_CHANNEL_LENGTH_16B      0
+#define I2S_CHANNEL_LENGTH_32B      1
+
+/** @brief ClockPolarity: idle level of the bit clock. */
+#define I2S_CPOL_LOW                0
+#define I2S_CPOL_HIGH               1
+
+/** @brief MCLKOutput: master clock output at 256 x Fs. */
+#define I2S_MCLK_OUTPUT_DISABLE     0
+#define I2S_MCLK_OUTPUT_ENABLE      1
+
+/* --- Opaque Handle Definition --- */
+
+/**
+ * @brief Opaque handle representing an I2S instance.
+ */
+typedef struct i2s_handle_t* i2s_handle_t;
+
+/* --- Public Types --- */
+
+/**
+ * @brief Block callback, called from the DMA interrupt once per block.
+ *
+ * @param[in] p_context The context given in the stream configuration.
+ * @param[in] p_rx_block The block just captured, or NULL without capture.
+ * @param[out] p_tx_block The block to fill for playback, or NULL without
+ *                        playback. It is played out starting one block later.
+ */
+typedef void (*i2s_block_callback_t)(void* p_context, const int16_t* p_rx_block, int16_t* p_tx_block);
+
+/**
+ * @brief Configuration of a stream.
+ * @note  Buffers hold two blocks back to back and must be in DMA-reachable
+ *        SRAM (not CCM). A block holds `block_samples` 16-bit DMA items:
+ *        interleaved left/right, with a 24/32-bit sample taking two items.
+ */
+typedef struct {
+    int16_t* p_rx_buffer;           // 2 x block_samples, or NULL for playback only
+    int16_t* p_tx_buffer;           // 2 x block_samples, or NULL for capture only
+    uint16_t block_samples;         // DMA items per block, even
+    i2s_block_callback_t callback;
+    void* p_context;
+} i2s_stream_config_t;
+
+/**
+ * @brief The clock configuration chosen for the requested sample rate.
+ */
+typedef struct {
+    uint32_t requested_hz;
+    uint32_t actual_mhz;            // Achieved sample rate in millihertz
+    int32_t error_ppm;              // (actual - requested) / requested
+    uint32_t i2sclk_hz;             // PLLI2S output
+    uint16_t plli2sn;
+    uint8_t plli2sr;
+    uint8_t i2sdiv;
+    bool odd;
+} i2s_clock_info_t;
+
+/**
+ * @brief Accumulated stream statistics.
+ */
+typedef struct {
+    uint32_t blocks;                // Block callbacks since the stream started
+    uint32_t dma_errors;            // DMA transfer errors on either direction
+} i2s_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Initializes an I2S instance in master mode and sets up its clock.
+ *
+ * @details Chooses the PLLI2S factors and the I2S prescaler for the rate
+ *          closest to `AudioFrequency`: from a compile-time table for the
+ *          standard rates at a 1 MHz PLL input, else by searching them all.
+ *          The PLLI2S is shared by all I2S instances: while another instance
+ *          is initialized its output is kept and only the prescaler is chosen.
+ *
+ * @param[in] instance_num The hardware instance number (2 for I2S2, 3 for I2S3).
+ * @param[in] config Pointer to the I2S configuration.
+ *
+ * @return A handle to the initialized instance, or NULL if the configuration
+ *         is invalid or the rate error exceeds I2S_MAX_RATE_ERROR_PPM.
+ */
+i2s_handle_t i2s_init(uint8_t instance_num, const I2S_Init_t* config);
+
+/**
+ * @brief De-initializes an I2S instance, stopping its stream.
+ *
+ * @param[in,out] p_handle Pointer to the handle to de-initialize.
+ *                         The handle will be set to NULL on success.
+ */
+void i2s_deinit(i2s_handle_t* p_handle);
+
+/**
+ * @brief Starts streaming.
+ *
+ * @details The TX blocks are cleared before the start, so playback begins
+ *          with two blocks of silence. In full duplex the I2Sxext slave is
+ *          enabled before the master starts the clocks, so both directions
+ *          begin on the same frame and complete their blocks together.
+ *
+ * @param[in] handle The handle to the I2S instance.
+ * @param[in] stream The stream configuration; copied.
+ *
+ * @return 0 on success, -1 if the stream is invalid, already running or its
+ *         DMA streams are unavailable.
+ */
+int i2s_start_stream(i2s_handle_t handle, const i2s_stream_config_t* stream);
+
+/**
+ * @brief Stops streaming and releases the DMA streams.
+ * @param[in] handle The handle to the I2S instance.
+ */
+void i2s_stop_stream(i2s_handle_t handle);
+
+/**
+ * @brief Gets the clock configuration and the achieved rate.
+ * @param[in] handle The handle to the I2S instance.
+ * @param[out] p_info Destination structure.
+ */
+void i2s_get_clock_info(i2s_handle_t handle, i2s_clock_info_t* p_info);
+
+/**
+ * @brief Copies the accumulated statistics.
+ * @param[in] handle The handle to the I2S instance.
+ * @param[out] p_stats Destination structure.
+ */
+void i2s_get_stats(i2s_handle_t handle, i2s_stats_t* p_stats);
+
+#endif // I2S_H
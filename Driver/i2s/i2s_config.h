@@ -0,0 +1,36 @@
+/**
+ * @file      i2s_config.h
+ * @brief     Compile-time configuration for the I2S driver.
+ */
+
+#ifndef I2S_CONFIG_H
+#define I2S_CONFIG_H
+
+/**
+ * @brief Defines the maximum number of I2S instances the driver can manage.
+ */
+#define I2S_MAX_INSTANCES 2
+
+/**
+ * @brief NVIC priority of the stream DMA interrupts, which run the block callback.
+ * @note  Must not be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY if
+ *        the callback uses the FreeRTOS FromISR API.
+ */
+#define I2S_DMA_IRQ_PRIORITY 5
+
+/**
+ * @brief Largest sample rate error i2s_init() accepts, in ppm.
+ */
+#define I2S_MAX_RATE_ERROR_PPM 1000
+
+/**
+ * @brief PLLI2S factor ranges searched for the sample rate.
+ * @details Combinations outside the hardware limits are skipped with
+ *          rcc_is_plli2s_valid().
+ */
+#define I2S_PLLI2SN_SEARCH_MIN 50
+#define I2S_PLLI2SN_SEARCH_MAX 432
+#define I2S_PLLI2SR_SEARCH_MIN 2
+#define I2S_PLLI2SR_SEARCH_MAX 7
+
+#endif // I2S_CONFIG_H
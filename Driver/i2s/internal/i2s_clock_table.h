@@ -0,0 +1,74 @@
+/**
+ * @file      i2s_clock_table.h
+ * @brief     Precomputed PLLI2S and prescaler settings for the standard sample rates.
+ *
+ * @details   One row per sample rate and frame clock factor (256 with MCLK
+ *            output, 32 or 64 bits per frame without), for a 1 MHz PLL input
+ *            (8 MHz HSE, PLLM = 8). Each row is the lowest-error setting of an
+ *            exhaustive search over PLLI2SN, PLLI2SR, I2SDIV and ODD, with the
+ *            error in ppm as the last column. The reference manual formula
+ *
+ *                Fs = PLL input * PLLI2SN / PLLI2SR / (factor * (2 * I2SDIV + ODD))
+ *
+ *            is evaluated at compile time in i2s.c and checked against the
+ *            hardware limits and the error column of every row.
+ *
+ *            192 kHz with MCLK output is missing: MCLK would be 49.152 MHz,
+ *            and no setting comes within I2S_MAX_RATE_ERROR_PPM.
+ */
+
+#ifndef I2S_CLOCK_TABLE_H
+#define I2S_CLOCK_TABLE_H
+
+#include <stdint.h>
+
+/** @brief PLL input frequency the table was computed for. */
+#define I2S_CLOCK_TABLE_INPUT_HZ    1000000ULL
+
+/**
+ * @brief X(rate_hz, factor, plli2sn, plli2sr, i2sdiv, odd, error_ppm)
+ */
+#define I2S_CLOCK_TABLE(X) \
+    X(  8000, 256, 256, 5,  12, 1,     0) \
+    X( 11025, 256, 429, 4,  19, 0,   -11) \
+    X( 16000, 256, 213, 2,  13, 0,    37) \
+    X( 22050, 256, 429, 4,   9, 1,   -11) \
+    X( 32000, 256, 213, 2,   6, 1,    37) \
+    X( 44100, 256, 271, 2,   6, 0,   183) \
+    X( 48000, 256, 172, 2,   3, 1,  -186) \
+    X( 88200, 256, 271, 2,   3, 0,   183) \
+    X( 96000, 256, 344, 2,   3, 1,  -186) \
+    X(176400, 256, 361, 2,   2, 0,  -739) \
+    X(  8000,  32, 128, 2, 125, 0,     0) \
+    X( 11025,  32, 290, 2, 205, 1,    -5) \
+    X( 16000,  32, 128, 2,  62, 1,     0) \
+    X( 22050,  32, 290, 3,  68, 1,    -5) \
+    X( 32000,  32, 256, 2,  62, 1,     0) \
+    X( 44100,  32, 302, 2,  53, 1,    10) \
+    X( 48000,  32, 384, 2,  62, 1,     0) \
+    X( 88200,  32, 429, 4,  19, 0,   -11) \
+    X( 96000,  32, 384, 5,  12, 1,     0) \
+    X(176400,  32, 429, 4,   9, 1,   -11) \
+    X(192000,  32, 424, 3,  11, 1,   150) \
+    X(  8000,  64, 128, 2,  62, 1,     0) \
+    X( 11025,  64, 290, 3,  68, 1,    -5) \
+    X( 16000,  64, 256, 2,  62, 1,     0) \
+    X( 22050,  64, 302, 2,  53, 1,    10) \
+    X( 32000,  64, 256, 5,  12, 1,     0) \
+    X( 44100,  64, 429, 4,  19, 0,   -11) \
+    X( 48000,  64, 384, 5,  12, 1,     0) \
+    X( 88200,  64, 429, 4,   9, 1,   -11) \
+    X( 96000,  64, 424, 3,  11, 1,   150) \
+    X(176400,  64, 271, 6,   2, 0,   183) \
+    X(192000,  64, 172, 2,   3, 1,  -186)
+
+/** @brief Achieved sample rate of a row in millihertz, from the reference manual formula. */
+#define I2S_CLOCK_ACTUAL_MHZ(factor, n, r, div, odd) \
+    ((I2S_CLOCK_TABLE_INPUT_HZ * 1000ULL * (n)) / ((uint64_t)(r) * (factor) * (2 * (div) + (odd))))
+
+/** @brief Error of a row in ppm, rounded toward zero like the runtime search. */
+#define I2S_CLOCK_ERROR_PPM(rate, factor, n, r, div, odd) \
+    (((int64_t)I2S_CLOCK_ACTUAL_MHZ(factor, n, r, div, odd) - (int64_t)(rate) * 1000) * 1000000 / \
+     ((int64_t)(rate) * 1000))
+
+#endif // I2S_CLOCK_TABLE_H
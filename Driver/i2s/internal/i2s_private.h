@@ -0,0 +1,46 @@
+/**
+ * @file      i2s_private.h
+ * @brief     Private internal definitions for the I2S driver.
+ * @note      This file should NOT be included by application code.
+ */
+
+#ifndef I2S_PRIVATE_H
+#define I2S_PRIVATE_H
+
+#include "i2s.h"
+#include "i2s_config.h"
+#include "port/i2s_port.h"
+#include "dma.h"
+
+/**
+ * @brief Internal runtime state for an I2S instance.
+ */
+typedef struct {
+    bool is_initialized;
+    bool is_streaming;
+    dma_handle_t dma_rx;                // NULL without capture
+    dma_handle_t dma_tx;                // NULL without playback
+    i2s_stream_config_t stream;
+    i2s_clock_info_t clock;
+    volatile uint32_t blocks;
+    volatile uint32_t dma_errors;
+} i2s_context_t;
+
+/**
+ * @brief The complete driver handle structure.
+ */
+struct i2s_handle_t {
+    const I2S_Init_t config;
+    i2s_context_t context;
+    const i2s_port_interface_t* port_api;
+    void* port_hw_instance;
+    void* port_ext_instance;            // The I2Sxext partner
+};
+
+/**
+ * @brief Services the DMA interrupts of a running stream.
+ * @note  Called by the port from the RX and TX stream interrupt handlers.
+ */
+void i2s_dma_irq_handler(struct i2s_handle_t* handle);
+
+#endif // I2S_PRIVATE_H
@@ -0,0 +1,43 @@
+/**
+ * @file      i2s_port.h
+ * @brief     Defines the abstract porting interface for the I2S driver.
+ */
+
+#ifndef I2S_PORT_H
+#define I2S_PORT_H
+
+struct i2s_handle_t;
+
+/**
+ * @brief DMA stream serving one direction of an I2S instance or its partner.
+ */
+typedef struct {
+    uint8_t dma_num;
+    uint8_t stream;
+    uint8_t channel;
+} i2s_dma_route_t;
+
+/**
+ * @brief A structure of function pointers that defines the hardware-dependent
+ *        operations required by the I2S driver.
+ * @note  `ext` selects the I2Sxext partner, which always runs in the opposite
+ *        direction of the instance as a slave.
+ */
+typedef struct {
+    void (*enable_clock)(struct i2s_handle_t* handle);
+    void (*init_pins)(struct i2s_handle_t* handle);
+    void (*configure)(struct i2s_handle_t* handle, uint8_t i2sdiv, bool odd);
+    bool (*get_dma_route)(struct i2s_handle_t* handle, bool ext, i2s_dma_route_t* p_route);
+    volatile void* (*get_data_register)(struct i2s_handle_t* handle, bool ext);
+    void (*enable_dma_irq)(struct i2s_handle_t* handle, bool ext, bool enable);
+    void (*start)(struct i2s_handle_t* handle, bool full_duplex);
+    void (*stop)(struct i2s_handle_t* handle);
+} i2s_port_interface_t;
+
+/* --- Functions to be provided by the concrete port implementation --- */
+
+const i2s_port_interface_t* i2s_port_get_api_for_instance(uint8_t instance_num);
+void* i2s_port_get_base_addr_for_instance(uint8_t instance_num);
+void* i2s_port_get_ext_addr_for_instance(uint8_t instance_num);
+
+#endif // I2S_PORT_H
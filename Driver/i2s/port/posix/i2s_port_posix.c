@@ -0,0 +1,469 @@
+/**
+ * @file      i2s_port_posix.c
+ * @brief     Host (POSIX) porting layer for the I2S driver, backed by WAV files.
+ *
+ * @details   A clock thread plays the codecs. It runs the frames of every
+ *            streaming instance in the order of a simulated timeline, at
+ *            the achieved sample rate of each (i2s_get_clock_info()) offset
+ *            by the instance's clock error in ppm, and as fast as the host
+ *            allows. Each frame raises the DMA requests of the running
+ *            directions through the POSIX DMA port, with the same DMA1
+ *            routes as the STM32F407 port: playback first, as the
+ *            transmitter loads a slot before it is clocked out, then
+ *            capture of the same slot. The block interrupt so runs on the
+ *            clock thread, where the TX stream has already switched blocks
+ *            as on target. Capture comes from a WAV file and playback goes
+ *            to one (i2s_port_posix.h). Without attached files the clocks
+ *            do not run.
+ *
+ *            Only 16-bit data is modelled: one DMA item per channel slot.
+ */
+
+#include "internal/i2s_private.h"
+#include "i2s_port_posix.h"
+#include "dma_port_posix.h"
+#include "FreeRTOS.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define I2S_DMA_NUM           1
+#define POSIX_I2S_INSTANCES   2       // I2S2 and I2S3
+#define WAV_HEADER_BYTES      44
+
+/**
+ * @brief A DMA1 stream, its request channel and its interrupt number.
+ */
+typedef struct {
+    uint8_t stream;
+    uint8_t channel;
+    uint8_t irqn;
+} posix_dma_route_t;
+
+/**
+ * @brief DMA1 requests of an instance and its I2Sxext partner (RM0090, Table 42).
+ */
+typedef struct {
+    posix_dma_route_t main_rx;
+    posix_dma_route_t main_tx;
+    posix_dma_route_t ext_rx;
+    posix_dma_route_t ext_tx;
+} posix_i2s_routes_t;
+
+/**
+ * @brief Emulated state of an instance and its partner.
+ * @note  `main_dr` comes first: the handle's hardware instance points to it.
+ */
+typedef struct {
+    volatile uint16_t main_dr;
+    volatile uint16_t ext_dr;
+    struct i2s_handle_t* handle;
+    FILE* p_capture;
+    FILE* p_playback;
+    uint32_t capture_frames;        // Left in the capture file
+    uint32_t max_frames;
+    int32_t clock_ppm;
+    bool full_duplex;
+    bool pending;                   // Attached and not started: holds all clocks
+    bool clock_running;
+    uint32_t frames;                // Clocked since the start
+    double period_ns;
+    double next_frame_ns;           // On the simulated timeline
+} posix_i2s_state_t;
+
+static const posix_i2s_routes_t s_routes[POSIX_I2S_INSTANCES] = {
+    {   // I2S2
+        .main_rx = {.stream = 3, .channel = 0, .irqn = 14},
+        .main_tx = {.stream = 4, .channel = 0, .irqn = 15},
+        .ext_rx  = {.stream = 3, .channel = 3, .irqn = 14},
+        .ext_tx  = {.stream = 4, .channel = 2, .irqn = 15},
+    },
+    {   // I2S3
+        .main_rx = {.stream = 2, .channel = 0, .irqn = 13},
+        .main_tx = {.stream = 7, .channel = 0, .irqn = 47},
+        .ext_rx  = {.stream = 2, .channel = 2, .irqn = 13},
+        .ext_tx  = {.stream = 5, .channel = 2, .irqn = 16},
+    },
+};
+
+static posix_i2s_state_t s_states[POSIX_I2S_INSTANCES];
+
+// The clock thread, shared by the instances
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_changed = PTHREAD_COND_INITIALIZER;  // A clock started or stopped
+static pthread_once_t s_thread_once = PTHREAD_ONCE_INIT;
+static posix_i2s_state_t* s_active = NULL;      // Instance whose frame is being clocked
+static volatile double s_now_ns = 0;
+
+// Handle served by each DMA1 stream interrupt
+static struct i2s_handle_t* s_stream_owner[8] = {NULL};
+
+// --- Private Helper Functions ---
+
+static posix_i2s_state_t* state_of_instance(uint8_t instance_num) {
+    return (instance_num == 2 || instance_num == 3) ? &s_states[instance_num - 2] : NULL;
+}
+
+static posix_i2s_state_t* state_of(struct i2s_handle_t* handle) {
+    return (posix_i2s_state_t*)handle->port_hw_instance;
+}
+
+static bool is_main_rx(struct i2s_handle_t* handle) {
+    return handle->config.Mode == I2S_MODE_MASTER_RX;
+}
+
+static const posix_dma_route_t* find_route(struct i2s_handle_t* handle, bool ext) {
+    const posix_i2s_routes_t* routes = &s_routes[state_of(handle) - s_states];
+    // The partner always runs in the opposite direction
+    bool is_rx = is_main_rx(handle) != ext;
+    if (ext) {
+        return is_rx ? &routes->ext_rx : &routes->ext_tx;
+    }
+    return is_rx ? &routes->main_rx : &routes->main_tx;
+}
+
+static uint32_t read_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void write_le32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Checks the format and leaves the file at the first sample.
+ * @return The number of frames, or 0 if the file is not 16-bit stereo PCM.
+ */
+static uint32_t open_wav_data(FILE* p_file) {
+    uint8_t riff[12];
+    if (fread(riff, sizeof(riff), 1, p_file) != 1 ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        return 0;
+    }
+
+    bool format_ok = false;
+    uint8_t chunk[8];
+    while (fread(chunk, sizeof(chunk), 1, p_file) == 1) {
+        uint32_t size = read_le32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t fmt[16];
+            if (fread(fmt, sizeof(fmt), 1, p_file) != 1) {
+                return 0;
+            }
+            // PCM, two channels, 16 bits
+            format_ok = fmt[0] == 1 && fmt[1] == 0 && fmt[2] == 2 && fmt[3] == 0 &&
+                        fmt[14] == 16 && fmt[15] == 0;
+            size -= sizeof(fmt);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            return format_ok ? size / 4 : 0;
+        }
+        if (fseek(p_file, (long)(size + (size & 1)), SEEK_CUR) != 0) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/** @brief Writes the header of a 16-bit stereo file with `frames` frames. */
+static void write_wav_header(FILE* p_file, uint32_t rate_hz, uint32_t frames) {
+    uint8_t header[WAV_HEADER_BYTES];
+    memcpy(header, "RIFF", 4);
+    write_le32(header + 4, 36 + frames * 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    write_le32(header + 16, 16);
+    write_le32(header + 20, 1 | (2UL << 16));          // PCM, two channels
+    write_le32(header + 24, rate_hz);
+    write_le32(header + 28, rate_hz * 4);
+    write_le32(header + 32, 4 | (16UL << 16));         // Block align, bits
+    memcpy(header + 36, "data", 4);
+    write_le32(header + 40, frames * 4);
+    fseek(p_file, 0, SEEK_SET);
+    fwrite(header, sizeof(header), 1, p_file);
+}
+
+static void close_files(posix_i2s_state_t* p_state, uint32_t rate_hz) {
+    if (p_state->p_capture) {
+        fclose(p_state->p_capture);
+        p_state->p_capture = NULL;
+    }
+    if (p_state->p_playback) {
+        write_wav_header(p_state->p_playback, rate_hz, p_state->frames);
+        fclose(p_state->p_playback);
+        p_state->p_playback = NULL;
+    }
+}
+
+/**
+ * @brief Clocks one frame of an instance.
+ * @return false at the end of the capture file.
+ */
+static bool clock_frame(posix_i2s_state_t* p_state) {
+    struct i2s_handle_t* handle = p_state->handle;
+    bool main_rx = is_main_rx(handle);
+    bool has_rx = main_rx || p_state->full_duplex;
+    bool has_tx = !main_rx || p_state->full_duplex;
+    const posix_dma_route_t* rx_route = find_route(handle, !main_rx);
+    const posix_dma_route_t* tx_route = find_route(handle, main_rx);
+    volatile uint16_t* rx_dr = main_rx ? &p_state->main_dr : &p_state->ext_dr;
+    volatile uint16_t* tx_dr = main_rx ? &p_state->ext_dr : &p_state->main_dr;
+
+    int16_t in[2] = {0, 0};
+    if (p_state->p_capture) {
+        if (p_state->capture_frames == 0 || fread(in, sizeof(in), 1, p_state->p_capture) != 1) {
+            return false;
+        }
+        p_state->capture_frames--;
+    }
+
+    int16_t out[2] = {0, 0};
+    for (int slot = 0; slot < 2; ++slot) {
+        if (has_tx) {
+            dma_port_posix_request(I2S_DMA_NUM, tx_route->stream);
+            out[slot] = (int16_t)*tx_dr;
+        }
+        if (has_rx) {
+            *rx_dr = (uint16_t)in[slot];
+            dma_port_posix_request(I2S_DMA_NUM, rx_route->stream);
+        }
+    }
+    if (has_tx && p_state->p_playback) {
+        fwrite(out, sizeof(out), 1, p_state->p_playback);
+    }
+    return true;
+}
+
+/**
+ * @brief The running instance with the earliest next frame, or NULL.
+ * @details Nothing runs while an attached instance has still to start, so
+ *          streams started one after the other begin on the same frame, as
+ *          on target, where they start microseconds apart.
+ */
+static posix_i2s_state_t* next_due(void) {
+    posix_i2s_state_t* p_next = NULL;
+    for (int i = 0; i < POSIX_I2S_INSTANCES; ++i) {
+        if (s_states[i].pending) {
+            return NULL;
+        }
+    }
+    for (int i = 0; i < POSIX_I2S_INSTANCES; ++i) {
+        posix_i2s_state_t* p_state = &s_states[i];
+        if (p_state->clock_running && (p_next == NULL || p_state->next_frame_ns < p_next->next_frame_ns)) {
+            p_next = p_state;
+        }
+    }
+    return p_next;
+}
+
+static void* clock_thread(void* p_arg) {
+    (void)p_arg;
+    pthread_mutex_lock(&s_lock);
+    for (;;) {
+        posix_i2s_state_t* p_state = next_due();
+        if (p_state == NULL) {
+            pthread_cond_wait(&s_changed, &s_lock);
+            continue;
+        }
+
+        s_now_ns = p_state->next_frame_ns;
+        s_active = p_state;
+        pthread_mutex_unlock(&s_lock);
+        bool more = clock_frame(p_state);
+        pthread_mutex_lock(&s_lock);
+        s_active = NULL;
+
+        if (more) {
+            p_state->frames++;
+            p_state->next_frame_ns += p_state->period_ns;
+        }
+        if (!more || (p_state->max_frames != 0 && p_state->frames >= p_state->max_frames)) {
+            p_state->clock_running = false;
+        }
+        pthread_cond_broadcast(&s_changed);
+    }
+    return NULL;
+}
+
+static void start_clock_thread(void) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, clock_thread, NULL);
+    pthread_detach(thread);
+}
+
+static void dispatch(uint8_t stream) {
+    if (s_stream_owner[stream]) {
+        i2s_dma_irq_handler(s_stream_owner[stream]);
+    }
+}
+
+// --- Interrupt Handlers, installed with vPortSetInterruptHandler() ---
+
+static void dma1_stream2_irq(void) { dispatch(2); }
+static void dma1_stream3_irq(void) { dispatch(3); }
+static void dma1_stream4_irq(void) { dispatch(4); }
+static void dma1_stream5_irq(void) { dispatch(5); }
+static void dma1_stream7_irq(void) { dispatch(7); }
+
+static void (*const s_stream_handlers[8])(void) = {
+    [2] = dma1_stream2_irq,
+    [3] = dma1_stream3_irq,
+    [4] = dma1_stream4_irq,
+    [5] = dma1_stream5_irq,
+    [7] = dma1_stream7_irq,
+};
+
+// --- Port Implementation ---
+
+static void posix_enable_clock(struct i2s_handle_t* handle) {
+    (void)handle;
+}
+
+static void posix_init_pins(struct i2s_handle_t* handle) {
+    (void)handle;
+}
+
+static void posix_configure(struct i2s_handle_t* handle, uint8_t i2sdiv, bool odd) {
+    (void)i2sdiv;
+    (void)odd;
+    state_of(handle)->handle = handle;
+}
+
+static bool posix_get_dma_route(struct i2s_handle_t* handle, bool ext, i2s_dma_route_t* p_route) {
+    const posix_dma_route_t* route = find_route(handle, ext);
+    p_route->dma_num = I2S_DMA_NUM;
+    p_route->stream = route->stream;
+    p_route->channel = route->channel;
+    return true;
+}
+
+static volatile void* posix_get_data_register(struct i2s_handle_t* handle, bool ext) {
+    posix_i2s_state_t* p_state = state_of(handle);
+    return ext ? &p_state->ext_dr : &p_state->main_dr;
+}
+
+static void posix_enable_dma_irq(struct i2s_handle_t* handle, bool ext, bool enable) {
+    const posix_dma_route_t* route = find_route(handle, ext);
+    s_stream_owner[route->stream] = enable ? handle : NULL;
+    vPortSetInterruptHandler(route->irqn, enable ? s_stream_handlers[route->stream] : NULL);
+}
+
+static void posix_start(struct i2s_handle_t* handle, bool full_duplex) {
+    posix_i2s_state_t* p_state = state_of(handle);
+    if (p_state->p_capture == NULL && p_state->max_frames == 0) {
+        return;
+    }
+    if (p_state->p_playback) {
+        write_wav_header(p_state->p_playback, handle->config.AudioFrequency, 0);
+    }
+
+    pthread_once(&s_thread_once, start_clock_thread);
+    pthread_mutex_lock(&s_lock);
+    p_state->full_duplex = full_duplex;
+    p_state->frames = 0;
+    p_state->period_ns = 1e12 / ((double)handle->context.clock.actual_mhz * (1.0 + p_state->clock_ppm * 1e-6));
+    p_state->next_frame_ns = s_now_ns + p_state->period_ns;
+    p_state->clock_running = true;
+    p_state->pending = false;
+    pthread_cond_broadcast(&s_changed);
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void posix_stop(struct i2s_handle_t* handle) {
+    posix_i2s_state_t* p_state = state_of(handle);
+    pthread_mutex_lock(&s_lock);
+    p_state->clock_running = false;
+    p_state->pending = false;
+    pthread_cond_broadcast(&s_changed);
+    while (s_active == p_state) {
+        pthread_cond_wait(&s_changed, &s_lock);
+    }
+    pthread_mutex_unlock(&s_lock);
+    close_files(p_state, handle->config.AudioFrequency);
+    p_state->max_frames = 0;
+}
+
+// --- The concrete port interface for POSIX hosts ---
+static const i2s_port_interface_t posix_port_api = {
+  .enable_clock = posix_enable_clock,
+  .init_pins = posix_init_pins,
+  .configure = posix_configure,
+  .get_dma_route = posix_get_dma_route,
+  .get_data_register = posix_get_data_register,
+  .enable_dma_irq = posix_enable_dma_irq,
+  .start = posix_start,
+  .stop = posix_stop,
+};
+
+// --- Public functions provided by the port ---
+const i2s_port_interface_t* i2s_port_get_api_for_instance(uint8_t instance_num) {
+    return state_of_instance(instance_num) ? &posix_port_api : NULL;
+}
+
+void* i2s_port_get_base_addr_for_instance(uint8_t instance_num) {
+    return state_of_instance(instance_num);
+}
+
+void* i2s_port_get_ext_addr_for_instance(uint8_t instance_num) {
+    posix_i2s_state_t* p_state = state_of_instance(instance_num);
+    return p_state ? (void*)&p_state->ext_dr : NULL;
+}
+
+bool i2s_port_posix_attach_wav(uint8_t instance_num, const char* p_capture_path,
+                               const char* p_playback_path, uint32_t max_frames) {
+    posix_i2s_state_t* p_state = state_of_instance(instance_num);
+    if (p_state == NULL || p_state->clock_running || (p_capture_path == NULL && max_frames == 0)) {
+        return false;
+    }
+
+    close_files(p_state, 0);
+    if (p_capture_path) {
+        p_state->p_capture = fopen(p_capture_path, "rb");
+        p_state->capture_frames = p_state->p_capture ? open_wav_data(p_state->p_capture) : 0;
+        if (p_state->capture_frames == 0) {
+            close_files(p_state, 0);
+            return false;
+        }
+    }
+    if (p_playback_path) {
+        p_state->p_playback = fopen(p_playback_path, "w+b");
+        if (p_state->p_playback == NULL) {
+            close_files(p_state, 0);
+            return false;
+        }
+    }
+    p_state->max_frames = max_frames;
+    pthread_mutex_lock(&s_lock);
+    p_state->pending = true;
+    pthread_mutex_unlock(&s_lock);
+    return true;
+}
+
+bool i2s_port_posix_set_clock_ppm(uint8_t instance_num, int32_t ppm) {
+    posix_i2s_state_t* p_state = state_of_instance(instance_num);
+    if (p_state == NULL || p_state->clock_running || ppm <= -1000000) {
+        return false;
+    }
+    p_state->clock_ppm = ppm;
+    return true;
+}
+
+uint32_t i2s_port_posix_wait(uint8_t instance_num) {
+    posix_i2s_state_t* p_state = state_of_instance(instance_num);
+    if (p_state == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&s_lock);
+    while (p_state->clock_running) {
+        pthread_cond_wait(&s_changed, &s_lock);
+    }
+    uint32_t frames = p_state->frames;
+    pthread_mutex_unlock(&s_lock);
+    return frames;
+}
+
+uint64_t i2s_port_posix_time_ns(void) {
+    return (uint64_t)s_now_ns;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file      i2s_port_posix.h
+ * @brief     Host-only entry of the POSIX I2S port: WAV files as the codec.
+ */
+
+#ifndef I2S_PORT_POSIX_H
+#define I2S_PORT_POSIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Attaches WAV files to an instance, before i2s_start_stream().
+ *
+ * @details Capture reads the frames of `p_capture_path`; playback writes
+ *          every frame the stream plays to `p_playback_path`. Both are
+ *          16-bit stereo PCM. The clocks stop at the end of the capture
+ *          file or after `max_frames`, whichever comes first;
+ *          i2s_stop_stream() closes the files. No clock runs while an
+ *          attached instance has not started, so instances attached
+ *          together begin on the same frame.
+ *
+ * @param[in] instance_num The instance number (2 or 3).
+ * @param[in] p_capture_path Read for capture, or NULL to capture silence.
+ * @param[in] p_playback_path Written with playback, or NULL to drop it.
+ * @param[in] max_frames Frames to run; 0 for the whole capture file.
+ *
+ * @return false if a file cannot be opened or is not 16-bit stereo PCM,
+ *         or if nothing bounds the run.
+ */
+bool i2s_port_posix_attach_wav(uint8_t instance_num, const char* p_capture_path,
+                               const char* p_playback_path, uint32_t max_frames);
+
+/**
+ * @brief Sets the clock error of an instance, before i2s_start_stream().
+ * @details Its frames then come at the achieved sample rate times
+ *          (1 + ppm / 1e6), like a codec whose crystal is off.
+ * @return false for an unknown instance or while its clocks run.
+ */
+bool i2s_port_posix_set_clock_ppm(uint8_t instance_num, int32_t ppm);
+
+/**
+ * @brief Waits until the clocks of a started stream have stopped.
+ * @return The number of frames clocked.
+ */
+uint32_t i2s_port_posix_wait(uint8_t instance_num);
+
+/**
+ * @brief Gets the time on the simulated timeline of the clocks.
+ * @details Starts at 0 and stands at the frame being clocked, so the block
+ *          callbacks can timestamp with it.
+ */
+uint64_t i2s_port_posix_time_ns(void);
+
+#endif // I2S_PORT_POSIX_H
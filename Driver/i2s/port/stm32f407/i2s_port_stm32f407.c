@@ -0,0 +1,256 @@
+/**
+ * @file      i2s_port_stm32f407.c
+ * @brief     Concrete porting layer implementation for the STM32F4xx series.
+ */
+
+#include "internal/i2s_private.h"
+#include "internal/spi_reg.h"
+#include "rcc.h"
+
+// Placeholder base addresses. The I2S instances share the SPI register map.
+#define PERIPH_BASE           0x40000000UL
+#define APB1PERIPH_BASE       PERIPH_BASE
+#define I2S2EXT_BASE          (APB1PERIPH_BASE + 0x3400UL)
+#define SPI2_BASE             (APB1PERIPH_BASE + 0x3800UL)
+#define SPI3_BASE             (APB1PERIPH_BASE + 0x3C00UL)
+#define I2S3EXT_BASE          (APB1PERIPH_BASE + 0x4000UL)
+
+#define I2S_DMA_NUM           1
+
+#define NVIC_ISER(n)          (((volatile uint32_t*)0xE000E100UL)[n])
+#define NVIC_ICER(n)          (((volatile uint32_t*)0xE000E180UL)[n])
+#define NVIC_IPR(n)           (((volatile uint8_t*)0xE000E400UL)[n])
+#define NVIC_PRIO_BITS        4
+
+/**
+ * @brief A DMA1 stream, its request channel and its interrupt number.
+ */
+typedef struct {
+    uint8_t stream;
+    uint8_t channel;
+    uint8_t irqn;
+} stm32f4_dma_route_t;
+
+/**
+ * @brief DMA1 requests of an instance and its I2Sxext partner (RM0090, Table 42).
+ */
+typedef struct {
+    stm32f4_dma_route_t main_rx;
+    stm32f4_dma_route_t main_tx;
+    stm32f4_dma_route_t ext_rx;
+    stm32f4_dma_route_t ext_tx;
+} stm32f4_i2s_routes_t;
+
+static const stm32f4_i2s_routes_t s_i2s2_routes = {
+    .main_rx = {.stream = 3, .channel = 0, .irqn = 14},
+    .main_tx = {.stream = 4, .channel = 0, .irqn = 15},
+    .ext_rx  = {.stream = 3, .channel = 3, .irqn = 14},
+    .ext_tx  = {.stream = 4, .channel = 2, .irqn = 15},
+};
+
+// SPI3_TX on Stream7 rather than Stream5, which I2S3ext_TX needs. SPI3_RX on
+// Stream2, free whenever I2S3 receives, as Stream0 carries I2C1_RX (i2c port).
+static const stm32f4_i2s_routes_t s_i2s3_routes = {
+    .main_rx = {.stream = 2, .channel = 0, .irqn = 13},
+    .main_tx = {.stream = 7, .channel = 0, .irqn = 47},
+    .ext_rx  = {.stream = 2, .channel = 2, .irqn = 13},
+    .ext_tx  = {.stream = 5, .channel = 2, .irqn = 16},
+};
+
+// Handle served by each DMA1 stream interrupt
+static struct i2s_handle_t* s_stream_owner[8] = {NULL};
+
+// --- Private function implementations for STM32F4 ---
+
+static bool is_main_rx(struct i2s_handle_t* handle) {
+    return handle->config.Mode == I2S_MODE_MASTER_RX;
+}
+
+static const stm32f4_dma_route_t* find_route(struct i2s_handle_t* handle, bool ext) {
+    const stm32f4_i2s_routes_t* routes = NULL;
+    if (handle->port_hw_instance == (void*)SPI2_BASE) {
+        routes = &s_i2s2_routes;
+    } else if (handle->port_hw_instance == (void*)SPI3_BASE) {
+        routes = &s_i2s3_routes;
+    } else {
+        return NULL;
+    }
+    // The partner always runs in the opposite direction
+    bool is_rx = is_main_rx(handle) != ext;
+    if (ext) {
+        return is_rx ? &routes->ext_rx : &routes->ext_tx;
+    }
+    return is_rx ? &routes->main_rx : &routes->main_tx;
+}
+
+static spi_reg_map_t* get_regs(struct i2s_handle_t* handle, bool ext) {
+    return (spi_reg_map_t*)(ext ? handle->port_ext_instance : handle->port_hw_instance);
+}
+
+static void stm32f4_enable_clock(struct i2s_handle_t* handle) {
+    // The I2Sxext partner is clocked with its SPI instance
+    if (handle->port_hw_instance == (void*)SPI2_BASE) {
+        rcc_enable_peripheral_clock(PERIPH_ID_SPI2);
+    } else if (handle->port_hw_instance == (void*)SPI3_BASE) {
+        rcc_enable_peripheral_clock(PERIPH_ID_SPI3);
+    }
+}
+
+static void stm32f4_init_pins(struct i2s_handle_t* handle) {
+    // Placeholder: A real implementation would use a GPIO driver to
+    // configure WS, CK, SD, ext_SD and MCK pins for their alternate function.
+}
+
+static void stm32f4_configure(struct i2s_handle_t* handle, uint8_t i2sdiv, bool odd) {
+    const I2S_Init_t* config = &handle->config;
+    uint32_t cfgr = SPI_I2SCFGR_I2SMOD;
+
+    if (config->Standard == I2S_STANDARD_PCM_LONG) {
+        cfgr |= (SPI_I2SCFGR_I2SSTD_PCM << SPI_I2SCFGR_I2SSTD_LSB) | SPI_I2SCFGR_PCMSYNC;
+    } else {
+        cfgr |= (config->Standard << SPI_I2SCFGR_I2SSTD_LSB);
+    }
+    cfgr |= (config->DataLength << SPI_I2SCFGR_DATLEN_LSB);
+    if (config->ChannelLength == I2S_CHANNEL_LENGTH_32B) {
+        cfgr |= SPI_I2SCFGR_CHLEN;
+    }
+    if (config->ClockPolarity == I2S_CPOL_HIGH) {
+        cfgr |= SPI_I2SCFGR_CKPOL;
+    }
+
+    spi_reg_map_t* regs = get_regs(handle, false);
+    spi_reg_map_t* ext_regs = get_regs(handle, true);
+
+    regs->I2SCFGR = 0; // I2SE off while reconfiguring
+    regs->I2SPR = i2sdiv | (odd ? SPI_I2SPR_ODD : 0) |
+                  ((config->MCLKOutput == I2S_MCLK_OUTPUT_ENABLE) ? SPI_I2SPR_MCKOE : 0);
+    regs->I2SCFGR = cfgr | (config->Mode << SPI_I2SCFGR_I2SCFG_LSB);
+
+    // The partner is a slave in the other direction with the same frame format
+    uint32_t ext_mode = is_main_rx(handle) ? SPI_I2SCFGR_I2SCFG_SLAVE_TRANSMIT : SPI_I2SCFGR_I2SCFG_SLAVE_RECEIVE;
+    ext_regs->I2SCFGR = 0;
+    ext_regs->I2SCFGR = cfgr | (ext_mode << SPI_I2SCFGR_I2SCFG_LSB);
+}
+
+static bool stm32f4_get_dma_route(struct i2s_handle_t* handle, bool ext, i2s_dma_route_t* p_route) {
+    const stm32f4_dma_route_t* route = find_route(handle, ext);
+    if (route == NULL) {
+        return false;
+    }
+    p_route->dma_num = I2S_DMA_NUM;
+    p_route->stream = route->stream;
+    p_route->channel = route->channel;
+    return true;
+}
+
+static volatile void* stm32f4_get_data_register(struct i2s_handle_t* handle, bool ext) {
+    return &get_regs(handle, ext)->DR;
+}
+
+static void stm32f4_enable_dma_irq(struct i2s_handle_t* handle, bool ext, bool enable) {
+    const stm32f4_dma_route_t* route = find_route(handle, ext);
+    if (route == NULL) {
+        return;
+    }
+    if (enable) {
+        s_stream_owner[route->stream] = handle;
+        NVIC_IPR(route->irqn) = (uint8_t)(I2S_DMA_IRQ_PRIORITY << (8 - NVIC_PRIO_BITS));
+        NVIC_ISER(route->irqn / 32) = (1UL << (route->irqn % 32));
+    } else {
+        NVIC_ICER(route->irqn / 32) = (1UL << (route->irqn % 32));
+        s_stream_owner[route->stream] = NULL;
+    }
+}
+
+static void stm32f4_start(struct i2s_handle_t* handle, bool full_duplex) {
+    spi_reg_map_t* regs = get_regs(handle, false);
+    spi_reg_map_t* ext_regs = get_regs(handle, true);
+    bool main_rx = is_main_rx(handle);
+
+    // The slave must be enabled before the master starts the clocks, so both
+    // directions begin on the same frame
+    if (full_duplex) {
+        ext_regs->CR2 |= main_rx ? SPI_CR2_TXDMAEN : SPI_CR2_RXDMAEN;
+        ext_regs->I2SCFGR |= SPI_I2SCFGR_I2SE;
+    }
+    regs->CR2 |= main_rx ? SPI_CR2_RXDMAEN : SPI_CR2_TXDMAEN;
+    regs->I2SCFGR |= SPI_I2SCFGR_I2SE;
+}
+
+static void stm32f4_stop(struct i2s_handle_t* handle) {
+    spi_reg_map_t* regs = get_regs(handle, false);
+    spi_reg_map_t* ext_regs = get_regs(handle, true);
+
+    // Stop the clocks first; the frame in progress is cut short
+    regs->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+    ext_regs->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+    regs->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    ext_regs->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    (void)regs->DR; // Drop a stale frame
+    (void)ext_regs->DR;
+}
+
+static void dispatch(uint8_t stream) {
+    if (s_stream_owner[stream]) {
+        i2s_dma_irq_handler(s_stream_owner[stream]);
+    }
+}
+
+// --- Interrupt Handlers ---
+
+void DMA1_Stream2_IRQHandler(void) {
+    dispatch(2);
+}
+
+void DMA1_Stream3_IRQHandler(void) {
+    dispatch(3);
+}
+
+void DMA1_Stream4_IRQHandler(void) {
+    dispatch(4);
+}
+
+void DMA1_Stream5_IRQHandler(void) {
+    dispatch(5);
+}
+
+void DMA1_Stream7_IRQHandler(void) {
+    dispatch(7);
+}
+
+// --- The concrete port interface for STM32F4 ---
+static const i2s_port_interface_t stm32f4_port_api = {
+  .enable_clock = stm32f4_enable_clock,
+  .init_pins = stm32f4_init_pins,
+  .configure = stm32f4_configure,
+  .get_dma_route = stm32f4_get_dma_route,
+  .get_data_register = stm32f4_get_data_register,
+  .enable_dma_irq = stm32f4_enable_dma_irq,
+  .start = stm32f4_start,
+  .stop = stm32f4_stop,
+};
+
+// --- Public functions provided by the port ---
+const i2s_port_interface_t* i2s_port_get_api_for_instance(uint8_t instance_num) {
+    switch (instance_num) {
+        case 2: // Fallthrough
+        case 3: return &stm32f4_port_api;
+        default: return NULL;
+    }
+}
+
+void* i2s_port_get_base_addr_for_instance(uint8_t instance_num) {
+    switch (instance_num) {
+        case 2: return (void*)SPI2_BASE;
+        case 3: return (void*)SPI3_BASE;
+        default: return NULL;
+    }
+}
+
+void* i2s_port_get_ext_addr_for_instance(uint8_t instance_num) {
+    switch (instance_num) {
+        case 2: return (void*)I2S2EXT_BASE;
+        case 3: return (void*)I2S3EXT_BASE;
+        default: return NULL;
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file      test_i2s_clock_table.c
+ * @brief     Host test of the precomputed I2S clock table against a fresh search.
+ *
+ * @details   Re-runs the exhaustive search over PLLI2SN, PLLI2SR, I2SDIV and
+ *            ODD for every standard sample rate and frame clock factor,
+ *            with the reference manual formula and the datasheet limits
+ *            restated here rather than taken from i2s.c:
+ *
+ *                Fs = PLL input * PLLI2SN / PLLI2SR / (factor * (2 * I2SDIV + ODD))
+ *
+ *            - Every row is a valid setting whose error column is its error
+ *              by the formula, and no setting comes closer to its rate.
+ *            - Every rate and factor whose best setting is within
+ *              I2S_MAX_RATE_ERROR_PPM has exactly one row, so a removed or
+ *              duplicated row fails; the others have none.
+ */
+
+#include "internal/i2s_clock_table.h"
+#include "i2s_config.h"
+#include "unit_test.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+// DS8626: PLLI2S VCO output 100..432 MHz, I2SxCLK at most 192 MHz
+#define VCO_MIN_HZ          100000000ULL
+#define VCO_MAX_HZ          432000000ULL
+#define I2SCLK_MAX_HZ       192000000ULL
+
+typedef struct {
+    uint32_t rate_hz;
+    uint32_t factor;
+    uint32_t plli2sn;
+    uint32_t plli2sr;
+    uint32_t i2sdiv;
+    uint32_t odd;
+    int32_t error_ppm;
+} row_t;
+
+// --- Test Data ---
+static const uint32_t s_rates[] = {8000, 11025, 16000, 22050, 32000, 44100, 48000, 88200, 96000, 176400, 192000};
+static const uint32_t s_factors[] = {256, 32, 64};
+
+#define TABLE_ROW(rate, factor, n, r, div, odd, ppm) {(rate), (factor), (n), (r), (div), (odd), (ppm)},
+static const row_t s_table[] = {
+    I2S_CLOCK_TABLE(TABLE_ROW)
+};
+#undef TABLE_ROW
+
+#define TABLE_ROWS          (sizeof(s_table) / sizeof(s_table[0]))
+
+// --- Helpers ---
+
+static bool is_valid(uint32_t n, uint32_t r, uint32_t div, uint32_t odd) {
+    uint64_t vco_hz = I2S_CLOCK_TABLE_INPUT_HZ * n;
+    return n >= 50 && n <= 432 && r >= 2 && r <= 7 && vco_hz >= VCO_MIN_HZ && vco_hz <= VCO_MAX_HZ &&
+           vco_hz / r <= I2SCLK_MAX_HZ && div >= 2 && div <= 255 && odd <= 1;
+}
+
+/** @brief Error of a setting in ppm, unrounded. */
+static double error_ppm(uint32_t rate, uint32_t factor, uint32_t n, uint32_t r, uint32_t div, uint32_t odd) {
+    double actual_hz = (double)I2S_CLOCK_TABLE_INPUT_HZ * n / r / ((double)factor * (2 * div + odd));
+    return (actual_hz - rate) / rate * 1e6;
+}
+
+/** @brief Smallest error magnitude over every valid setting. */
+static double best_error_ppm(uint32_t rate, uint32_t factor) {
+    double best = INFINITY;
+    for (uint32_t r = 2; r <= 7; ++r) {
+        for (uint32_t n = 50; n <= 432; ++n) {
+            for (uint32_t div = 2; div <= 255; ++div) {
+                for (uint32_t odd = 0; odd <= 1; ++odd) {
+                    if (is_valid(n, r, div, odd)) {
+                        best = fmin(best, fabs(error_ppm(rate, factor, n, r, div, odd)));
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+// --- Tests ---
+
+static void test_rows(void) {
+    for (size_t i = 0; i < TABLE_ROWS; ++i) {
+        const row_t* p = &s_table[i];
+        TEST_CHECK(is_valid(p->plli2sn, p->plli2sr, p->i2sdiv, p->odd));
+
+        // The column is rounded toward zero
+        double error = error_ppm(p->rate_hz, p->factor, p->plli2sn, p->plli2sr, p->i2sdiv, p->odd);
+        TEST_CHECK(p->error_ppm == (int32_t)trunc(error));
+    }
+}
+
+static void test_search(void) {
+    int covered = 0;
+    for (size_t f = 0; f < sizeof(s_factors) / sizeof(s_factors[0]); ++f) {
+        for (size_t k = 0; k < sizeof(s_rates) / sizeof(s_rates[0]); ++k) {
+            uint32_t rate = s_rates[k];
+            uint32_t factor = s_factors[f];
+            double best = best_error_ppm(rate, factor);
+
+            int rows = 0;
+            for (size_t i = 0; i < TABLE_ROWS; ++i) {
+                const row_t* p = &s_table[i];
+                if (p->rate_hz == rate && p->factor == factor) {
+                    rows++;
+                    double error = error_ppm(rate, factor, p->plli2sn, p->plli2sr, p->i2sdiv, p->odd);
+                    TEST_CHECK(fabs(error) <= best + 1e-6);
+                }
+            }
+            bool is_reachable = best <= I2S_MAX_RATE_ERROR_PPM;
+            TEST_CHECK(rows == (is_reachable ? 1 : 0));
+            covered += rows;
+            printf("%6lu Hz x %3lu: best %8.2f ppm%s\n", (unsigned long)rate, (unsigned long)factor, best,
+                   is_reachable ? "" : ", out of range, no row");
+        }
+    }
+    TEST_CHECK(covered == (int)TABLE_ROWS);
+}
+
+int main(void) {
+    test_rows();
+    test_search();
+    return TEST_EXIT();
+}
@@ -0,0 +1,217 @@
+/**
+ * @file      test_i2s_wav.c
+ * @brief     Host test of full-duplex I2S streaming through the WAV-backed port.
+ *
+ * @details   The driver runs unchanged on the POSIX I2S and DMA ports. A WAV
+ *            file is captured, the block callback copies each captured block
+ *            to the playback block, and the played WAV must be the captured
+ *            one, sample for sample, two blocks late: the callback fills the
+ *            TX block that has just played out, which goes out after the one
+ *            playing now. Both instances run, one as master receiver and one
+ *            as master transmitter, so the main and I2Sxext routes of each
+ *            direction are covered.
+ */
+
+#include "i2s.h"
+#include "i2s_port_posix.h"
+#include "rcc.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE_HZ             48000
+#define CAPTURE_FRAMES      48000
+#define BLOCK_SAMPLES       256     // DMA items: 128 stereo frames
+#define BLOCK_FRAMES        (BLOCK_SAMPLES / 2)
+#define CAPTURE_PATH        "i2s_capture.wav"
+#define PLAYBACK_PATH       "i2s_playback.wav"
+
+// --- Test Data ---
+static int16_t s_rx_buffer[2 * BLOCK_SAMPLES];
+static int16_t s_tx_buffer[2 * BLOCK_SAMPLES];
+static int16_t s_capture[CAPTURE_FRAMES][2];
+static int16_t s_playback[CAPTURE_FRAMES][2];
+
+static uint32_t s_callbacks = 0;
+static uint32_t s_missing_block = 0;
+
+// --- Stubs for the RCC driver: a 1 MHz PLL input, as on the board ---
+
+static uint32_t s_plli2s_hz = 0;
+
+void rcc_enable_peripheral_clock(peripheral_id_t id) {
+    (void)id;
+}
+
+bool rcc_is_plli2s_valid(uint32_t plli2sn, uint32_t plli2sr) {
+    uint64_t vco_hz = 1000000ULL * plli2sn;
+    return plli2sn >= 50 && plli2sn <= 432 && plli2sr >= 2 && plli2sr <= 7 &&
+           vco_hz >= 100000000ULL && vco_hz <= 432000000ULL && vco_hz / plli2sr <= 192000000ULL;
+}
+
+bool rcc_configure_plli2s(uint32_t plli2sn, uint32_t plli2sr) {
+    if (!rcc_is_plli2s_valid(plli2sn, plli2sr)) {
+        return false;
+    }
+    s_plli2s_hz = 1000000UL * plli2sn / plli2sr;
+    return true;
+}
+
+uint32_t rcc_get_pll_input_frequency(void) {
+    return 1000000UL;
+}
+
+uint32_t rcc_get_plli2s_frequency(void) {
+    return s_plli2s_hz;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+static void put_le32(FILE* p_file, uint32_t value) {
+    uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    fwrite(bytes, sizeof(bytes), 1, p_file);
+}
+
+/** @brief Writes the capture file, with a LIST chunk the reader must skip. */
+static bool write_capture(void) {
+    uint32_t rng = 1;
+    for (uint32_t i = 0; i < CAPTURE_FRAMES; ++i) {
+        rng = rng * 1664525UL + 1013904223UL;
+        s_capture[i][0] = (int16_t)(rng >> 16);
+        s_capture[i][1] = (int16_t)(i * 3 - 20000);
+    }
+
+    FILE* p_file = fopen(CAPTURE_PATH, "wb");
+    if (p_file == NULL) {
+        return false;
+    }
+    fwrite("RIFF", 4, 1, p_file);
+    put_le32(p_file, 4 + (8 + 16) + (8 + 4) + (8 + CAPTURE_FRAMES * 4));
+    fwrite("WAVEfmt ", 8, 1, p_file);
+    put_le32(p_file, 16);
+    put_le32(p_file, 1 | (2UL << 16));
+    put_le32(p_file, RATE_HZ);
+    put_le32(p_file, RATE_HZ * 4);
+    put_le32(p_file, 4 | (16UL << 16));
+    fwrite("LIST", 4, 1, p_file);
+    put_le32(p_file, 4);
+    fwrite("INFO", 4, 1, p_file);
+    fwrite("data", 4, 1, p_file);
+    put_le32(p_file, CAPTURE_FRAMES * 4);
+    fwrite(s_capture, sizeof(s_capture), 1, p_file);
+    fclose(p_file);
+    return true;
+}
+
+/** @brief Reads the playback file back. @return Its frame count. */
+static uint32_t read_playback(uint32_t* p_rate_hz) {
+    FILE* p_file = fopen(PLAYBACK_PATH, "rb");
+    if (p_file == NULL) {
+        return 0;
+    }
+    uint8_t header[44];
+    uint32_t frames = 0;
+    if (fread(header, sizeof(header), 1, p_file) == 1 && memcmp(header + 36, "data", 4) == 0) {
+        *p_rate_hz = header[24] | (header[25] << 8) | ((uint32_t)header[26] << 16);
+        frames = (header[40] | (header[41] << 8) | ((uint32_t)header[42] << 16)) / 4;
+        if (frames > CAPTURE_FRAMES || fread(s_playback, 4, frames, p_file) != frames) {
+            frames = 0;
+        }
+    }
+    fclose(p_file);
+    return frames;
+}
+
+/** @brief Loops capture back to playback; runs in the simulated DMA interrupt. */
+static void loopback(void* p_context, const int16_t* p_rx_block, int16_t* p_tx_block) {
+    (void)p_context;
+    if (p_rx_block == NULL || p_tx_block == NULL) {
+        s_missing_block++;
+        return;
+    }
+    memcpy(p_tx_block, p_rx_block, BLOCK_SAMPLES * sizeof(int16_t));
+    s_callbacks++;
+}
+
+// --- Tests ---
+
+static void test_round_trip(uint8_t instance_num, uint32_t mode) {
+    const I2S_Init_t config = {
+        .Mode = mode,
+        .Standard = I2S_STANDARD_PHILIPS,
+        .DataLength = I2S_DATA_LENGTH_16B,
+        .ChannelLength = I2S_CHANNEL_LENGTH_16B,
+        .ClockPolarity = I2S_CPOL_LOW,
+        .AudioFrequency = RATE_HZ,
+        .MCLKOutput = I2S_MCLK_OUTPUT_ENABLE,
+    };
+    i2s_handle_t handle = i2s_init(instance_num, &config);
+    TEST_CHECK(handle != NULL);
+    if (handle == NULL) {
+        return;
+    }
+
+    const i2s_stream_config_t stream = {
+        .p_rx_buffer = s_rx_buffer,
+        .p_tx_buffer = s_tx_buffer,
+        .block_samples = BLOCK_SAMPLES,
+        .callback = loopback,
+    };
+    s_callbacks = 0;
+    s_missing_block = 0;
+    memset(s_playback, 0x55, sizeof(s_playback));
+
+    TEST_CHECK(i2s_port_posix_attach_wav(instance_num, CAPTURE_PATH, PLAYBACK_PATH, 0));
+    TEST_CHECK(i2s_start_stream(handle, &stream) == 0);
+    TEST_CHECK(i2s_port_posix_wait(instance_num) == CAPTURE_FRAMES);
+    i2s_stop_stream(handle);
+
+    i2s_stats_t stats;
+    i2s_get_stats(handle, &stats);
+    TEST_CHECK(stats.blocks == CAPTURE_FRAMES / BLOCK_FRAMES);
+    TEST_CHECK(stats.dma_errors == 0);
+    TEST_CHECK(s_callbacks == CAPTURE_FRAMES / BLOCK_FRAMES);
+    TEST_CHECK(s_missing_block == 0);
+
+    uint32_t rate_hz = 0;
+    TEST_CHECK(read_playback(&rate_hz) == CAPTURE_FRAMES);
+    TEST_CHECK(rate_hz == RATE_HZ);
+
+    uint32_t wrong = 0;
+    uint32_t delay = 2 * BLOCK_FRAMES;
+    for (uint32_t i = 0; i < CAPTURE_FRAMES; ++i) {
+        for (int ch = 0; ch < 2; ++ch) {
+            int16_t expected = (i < delay) ? 0 : s_capture[i - delay][ch];
+            wrong += (s_playback[i][ch] != expected);
+        }
+    }
+    TEST_CHECK(wrong == 0);
+    printf("I2S%u %s: %u frames, %u blocks, round trip %u frames\n", (unsigned)instance_num,
+           (mode == I2S_MODE_MASTER_RX) ? "master RX" : "master TX",
+           (unsigned)CAPTURE_FRAMES, (unsigned)stats.blocks, (unsigned)delay);
+
+    i2s_deinit(&handle);
+    TEST_CHECK(handle == NULL);
+}
+
+static void test_rejects_bad_files(void) {
+    TEST_CHECK(!i2s_port_posix_attach_wav(2, "missing.wav", NULL, 0));
+    TEST_CHECK(!i2s_port_posix_attach_wav(2, NULL, PLAYBACK_PATH, 0));
+    TEST_CHECK(!i2s_port_posix_attach_wav(2, PLAYBACK_PATH "x", NULL, 0));
+}
+
+int main(void) {
+    TEST_CHECK(write_capture());
+    test_round_trip(2, I2S_MODE_MASTER_RX);
+    test_round_trip(3, I2S_MODE_MASTER_TX);
+    test_rejects_bad_files();
+    remove(CAPTURE_PATH);
+    remove(PLAYBACK_PATH);
+    return TEST_EXIT();
+}
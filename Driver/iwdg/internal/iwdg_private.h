@@ -8,7 +8,7 @@
 #define UART_PRIVATE_H
 
 #include "uart.h"
-#include "uart_config.h"
+#include "iwdg_config.h"
 #include "port/uart_port.h"
 
 /**
@@ -0,0 +1,48 @@
+/**
+ * @file      lis3dsh_private.h
+ * @brief     Private internal definitions for the LIS3DSH accelerometer driver.
+ * @note      This file should NOT be included by application code.
+ */
+
+#ifndef LIS3DSH_PRIVATE_H
+#define LIS3DSH_PRIVATE_H
+
+#include "lis3dsh.h"
+#include "lis3dsh_config.h"
+#include "internal/lis3dsh_reg.h"
+#include "gpio.h"
+#include "exit.h"
+
+#include <stdatomic.h>
+
+#define LIS3DSH_SAMPLE_BYTES        6
+#define LIS3DSH_DRAIN_BYTES         (1 + LIS3DSH_MAX_WATERMARK * LIS3DSH_SAMPLE_BYTES)
+
+/**
+ * @brief Internal runtime state for a LIS3DSH device.
+ */
+typedef struct {
+    volatile bool is_initialized;
+    gpio_handle_t cs;
+    gpio_handle_t int1;
+    exti_handle_t exti;
+    size_t samples_per_drain;
+    atomic_flag is_draining;            // Set while the drain transaction is queued or running
+    atomic_bool is_pending;             // INT1 rose while a drain was running
+    spi_transaction_t txn;
+    uint8_t tx[LIS3DSH_DRAIN_BYTES];    // Address byte, then don't-care bytes
+    uint8_t rx[LIS3DSH_DRAIN_BYTES];
+    lis3dsh_sample_t samples[2][LIS3DSH_MAX_WATERMARK];
+    uint8_t block;                      // Half of samples[] the next drain is parsed into
+    volatile lis3dsh_stats_t stats;
+} lis3dsh_context_t;
+
+/**
+ * @brief The complete driver handle structure.
+ */
+struct lis3dsh_handle_t {
+    const lis3dsh_config_t config;
+    lis3dsh_context_t context;
+};
+
+#endif // LIS3DSH_PRIVATE_H
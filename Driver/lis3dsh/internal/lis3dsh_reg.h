@@ -0,0 +1,91 @@
+/**
+ * @file      lis3dsh_reg.h
+ * @brief     Register definitions for the LIS3DSH accelerometer.
+ */
+#ifndef LIS3DSH_REG_H
+#define LIS3DSH_REG_H
+
+#include <stdint.h>
+
+/* --- SPI framing --------------------------------------------------------- */
+
+/* Bit 7 of the address byte selects a read; bits 6:0 are the register. */
+#define LIS3DSH_SPI_READ            (1 << 7)
+
+/* --- Register addresses -------------------------------------------------- */
+
+#define LIS3DSH_REG_WHO_AM_I        0x0F
+#define LIS3DSH_REG_CTRL_REG4       0x20
+#define LIS3DSH_REG_CTRL_REG3       0x23
+#define LIS3DSH_REG_CTRL_REG5       0x24
+#define LIS3DSH_REG_CTRL_REG6       0x25
+#define LIS3DSH_REG_STATUS          0x27
+#define LIS3DSH_REG_OUT_X_L         0x28    /* OUT_X_L .. OUT_Z_H: 0x28 .. 0x2D */
+#define LIS3DSH_REG_FIFO_CTRL       0x2E
+#define LIS3DSH_REG_FIFO_SRC        0x2F
+
+#define LIS3DSH_WHO_AM_I_VALUE      0x3F
+
+/* --- CTRL_REG4 values ---------------------------------------------------- */
+
+/* ODR[7:4]: Output data rate, 0 = power down */
+#define LIS3DSH_CTRL_REG4_ODR_SHIFT     4
+#define LIS3DSH_CTRL_REG4_ODR_MASK      (0xF << 4)
+/* BDU: Block data update */
+#define LIS3DSH_CTRL_REG4_BDU           (1 << 3)
+#define LIS3DSH_CTRL_REG4_ZEN           (1 << 2)
+#define LIS3DSH_CTRL_REG4_YEN           (1 << 1)
+#define LIS3DSH_CTRL_REG4_XEN           (1 << 0)
+
+/* --- CTRL_REG3 values ---------------------------------------------------- */
+
+/* DR_EN: Data-ready signal on INT1 */
+#define LIS3DSH_CTRL_REG3_DR_EN         (1 << 7)
+/* IEA: Interrupt polarity, 1 = active high */
+#define LIS3DSH_CTRL_REG3_IEA           (1 << 6)
+/* IEL: Interrupt latching, 0 = latched, 1 = pulsed */
+#define LIS3DSH_CTRL_REG3_IEL           (1 << 5)
+#define LIS3DSH_CTRL_REG3_INT2_EN       (1 << 4)
+#define LIS3DSH_CTRL_REG3_INT1_EN       (1 << 3)
+/* STRT: Soft reset */
+#define LIS3DSH_CTRL_REG3_STRT          (1 << 0)
+
+/* --- CTRL_REG5 values ---------------------------------------------------- */
+
+/* BW[7:6]: Anti-aliasing filter bandwidth, 0 = 800 Hz */
+#define LIS3DSH_CTRL_REG5_BW_SHIFT      6
+/* FSCALE[5:3]: Full scale */
+#define LIS3DSH_CTRL_REG5_FSCALE_SHIFT  3
+
+/* --- CTRL_REG6 values ---------------------------------------------------- */
+
+#define LIS3DSH_CTRL_REG6_BOOT          (1 << 7)
+#define LIS3DSH_CTRL_REG6_FIFO_EN       (1 << 6)
+/* WTM_EN: Stop FIFO filling at the watermark level (FIFO mode only) */
+#define LIS3DSH_CTRL_REG6_WTM_EN        (1 << 5)
+/* ADD_INC: Address auto-increment on multi-byte access. With the FIFO
+ * enabled, reads past OUT_Z_H wrap to OUT_X_L and pop the next sample. */
+#define LIS3DSH_CTRL_REG6_ADD_INC       (1 << 4)
+#define LIS3DSH_CTRL_REG6_P1_EMPTY      (1 << 3)
+#define LIS3DSH_CTRL_REG6_P1_WTM        (1 << 2)
+#define LIS3DSH_CTRL_REG6_P1_OVERRUN    (1 << 1)
+#define LIS3DSH_CTRL_REG6_P2_BOOT       (1 << 0)
+
+/* --- FIFO_CTRL values ---------------------------------------------------- */
+
+/* FMODE[7:5]: FIFO mode */
+#define LIS3DSH_FIFO_CTRL_FMODE_SHIFT   5
+#define LIS3DSH_FIFO_MODE_BYPASS        0x0
+#define LIS3DSH_FIFO_MODE_FIFO          0x1
+#define LIS3DSH_FIFO_MODE_STREAM        0x2
+/* WTMP[4:0]: Watermark level in samples */
+#define LIS3DSH_FIFO_CTRL_WTMP_MASK     0x1F
+
+/* --- FIFO_SRC values ----------------------------------------------------- */
+
+#define LIS3DSH_FIFO_SRC_WTM            (1 << 7)
+#define LIS3DSH_FIFO_SRC_OVRN           (1 << 6)
+#define LIS3DSH_FIFO_SRC_EMPTY          (1 << 5)
+#define LIS3DSH_FIFO_SRC_FSS_MASK       0x1F
+
+#endif // LIS3DSH_REG_H
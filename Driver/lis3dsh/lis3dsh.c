@@ -0,0 +1,290 @@
+/**
+ * @file      lis3dsh.c
+ * @brief     Implementation of the LIS3DSH accelerometer driver.
+ */
+
+#include "internal/lis3dsh_private.h"
+#include <string.h>
+
+// --- Static Data ---
+static struct lis3dsh_handle_t s_handle_pool[LIS3DSH_MAX_INSTANCES];
+static bool s_is_handle_in_use[LIS3DSH_MAX_INSTANCES] = {false};
+// Device whose chip select the SPI driver drives; the callback has no context
+static struct lis3dsh_handle_t* s_selected;
+
+static const float s_rate_hz[] = {0.0f, 3.125f, 6.25f, 12.5f, 25.0f, 50.0f, 100.0f, 400.0f, 800.0f, 1600.0f};
+static const float s_g_per_count[] = {0.00006f, 0.00012f, 0.00018f, 0.00024f, 0.00073f};
+
+// --- Private Helper Functions ---
+static struct lis3dsh_handle_t* allocate_handle(void) {
+    for (int i = 0; i < LIS3DSH_MAX_INSTANCES; ++i) {
+        if (!s_is_handle_in_use[i]) {
+            s_is_handle_in_use[i] = true;
+            return &s_handle_pool[i];
+        }
+    }
+    return NULL;
+}
+
+static void release_handle(lis3dsh_handle_t handle) {
+    for (int i = 0; i < LIS3DSH_MAX_INSTANCES; ++i) {
+        if (handle == &s_handle_pool[i]) {
+            s_is_handle_in_use[i] = false;
+            memset(handle, 0, sizeof(struct lis3dsh_handle_t));
+            return;
+        }
+    }
+}
+
+/** @brief Chip select of asynchronous transactions; active low. */
+static void select_device(bool active) {
+    if (active) {
+        gpio_clear(s_selected->context.cs);
+    } else {
+        gpio_set(s_selected->context.cs);
+    }
+}
+
+static int write_reg(lis3dsh_handle_t handle, uint8_t reg, uint8_t value) {
+    uint8_t frame[2] = {reg, value};
+    gpio_clear(handle->context.cs);
+    int status = spi_transfer_blocking(handle->config.spi, frame, NULL, sizeof(frame));
+    gpio_set(handle->context.cs);
+    return status;
+}
+
+static int read_reg(lis3dsh_handle_t handle, uint8_t reg, uint8_t* p_value) {
+    uint8_t tx[2] = {LIS3DSH_SPI_READ | reg, 0};
+    uint8_t rx[2] = {0};
+    gpio_clear(handle->context.cs);
+    int status = spi_transfer_blocking(handle->config.spi, tx, rx, sizeof(tx));
+    gpio_set(handle->context.cs);
+    *p_value = rx[1];
+    return status;
+}
+
+/** @brief Queues the drain transaction unless one is already running. */
+static void start_drain(lis3dsh_handle_t handle) {
+    lis3dsh_context_t* ctx = &handle->context;
+
+    if (atomic_flag_test_and_set(&ctx->is_draining)) {
+        atomic_store(&ctx->is_pending, true);
+        return;
+    }
+    ctx->txn.p_next = NULL;
+    if (spi_transfer_async(handle->config.spi, &ctx->txn) != 0) {
+        ctx->stats.errors++;
+        atomic_flag_clear(&ctx->is_draining);
+    }
+}
+
+/** @brief EXTI callback of INT1: the FIFO reached the watermark, or a sample is ready. */
+static void on_int1(uint8_t line_num, void* user_data) {
+    (void)line_num;
+    start_drain((lis3dsh_handle_t)user_data);
+}
+
+/** @brief SPI completion of a drain, in interrupt context. */
+static void on_drain_complete(void* p_context, int status) {
+    lis3dsh_handle_t handle = (lis3dsh_handle_t)p_context;
+    lis3dsh_context_t* ctx = &handle->context;
+
+    if (status == 0) {
+        lis3dsh_sample_t* p_samples = ctx->samples[ctx->block];
+        const uint8_t* p_raw = &ctx->rx[1];
+        for (size_t i = 0; i < ctx->samples_per_drain; ++i, p_raw += LIS3DSH_SAMPLE_BYTES) {
+            p_samples[i].x = (int16_t)((uint16_t)p_raw[0] | ((uint16_t)p_raw[1] << 8));
+            p_samples[i].y = (int16_t)((uint16_t)p_raw[2] | ((uint16_t)p_raw[3] << 8));
+            p_samples[i].z = (int16_t)((uint16_t)p_raw[4] | ((uint16_t)p_raw[5] << 8));
+        }
+        ctx->block ^= 1;
+        ctx->stats.drains++;
+        ctx->stats.samples += (uint32_t)ctx->samples_per_drain;
+        if (handle->config.callback) {
+            handle->config.callback(handle->config.p_context, p_samples, ctx->samples_per_drain);
+        }
+    } else {
+        ctx->stats.errors++;
+    }
+
+    // INT1 is a level while the FIFO holds a watermark of samples. If it is
+    // still high, no new edge will come, so drain again straight away. An
+    // edge that lands between the check and the release is recorded as
+    // pending by start_drain() and picked up by the second check.
+    // Nothing restarts once lis3dsh_deinit() has begun.
+    for (;;) {
+        bool again = atomic_exchange(&ctx->is_pending, false) || gpio_read(ctx->int1);
+        if (again && ctx->is_initialized) {
+            ctx->stats.back_to_back++;
+            ctx->txn.p_next = NULL;
+            if (spi_transfer_async(handle->config.spi, &ctx->txn) == 0) {
+                return;
+            }
+            ctx->stats.errors++;
+        }
+        atomic_flag_clear(&ctx->is_draining);
+        if (!atomic_load(&ctx->is_pending) || atomic_flag_test_and_set(&ctx->is_draining)) {
+            return;
+        }
+    }
+}
+
+static int configure_device(lis3dsh_handle_t handle) {
+    const lis3dsh_config_t* config = &handle->config;
+    bool use_fifo = (config->watermark != 0);
+    uint8_t reg4 = (uint8_t)((config->odr << LIS3DSH_CTRL_REG4_ODR_SHIFT) |
+                             LIS3DSH_CTRL_REG4_XEN | LIS3DSH_CTRL_REG4_YEN | LIS3DSH_CTRL_REG4_ZEN);
+    uint8_t reg6 = LIS3DSH_CTRL_REG6_ADD_INC;
+    uint8_t reg3 = LIS3DSH_CTRL_REG3_IEA | LIS3DSH_CTRL_REG3_INT1_EN;
+    uint8_t fifo_ctrl = LIS3DSH_FIFO_MODE_BYPASS << LIS3DSH_FIFO_CTRL_FMODE_SHIFT;
+
+    if (use_fifo) {
+        reg6 |= LIS3DSH_CTRL_REG6_FIFO_EN | LIS3DSH_CTRL_REG6_P1_WTM;
+        fifo_ctrl = (uint8_t)((LIS3DSH_FIFO_MODE_STREAM << LIS3DSH_FIFO_CTRL_FMODE_SHIFT) |
+                              (config->watermark & LIS3DSH_FIFO_CTRL_WTMP_MASK));
+    } else {
+        // One sample per read: keep its low and high bytes from the same conversion
+        reg4 |= LIS3DSH_CTRL_REG4_BDU;
+        reg3 |= LIS3DSH_CTRL_REG3_DR_EN;
+    }
+
+    // Power down and empty the FIFO (bypass mode) before changing anything
+    int status = write_reg(handle, LIS3DSH_REG_CTRL_REG4, 0);
+    status |= write_reg(handle, LIS3DSH_REG_FIFO_CTRL, LIS3DSH_FIFO_MODE_BYPASS << LIS3DSH_FIFO_CTRL_FMODE_SHIFT);
+    status |= write_reg(handle, LIS3DSH_REG_CTRL_REG5, (uint8_t)(config->scale << LIS3DSH_CTRL_REG5_FSCALE_SHIFT));
+    status |= write_reg(handle, LIS3DSH_REG_CTRL_REG6, reg6);
+    status |= write_reg(handle, LIS3DSH_REG_FIFO_CTRL, fifo_ctrl);
+    status |= write_reg(handle, LIS3DSH_REG_CTRL_REG3, reg3);
+    if (status != 0) {
+        return -1;
+    }
+    // Sampling starts with the data rate, once INT1 is routed
+    return write_reg(handle, LIS3DSH_REG_CTRL_REG4, reg4);
+}
+
+// --- Public API Function Implementations ---
+
+lis3dsh_handle_t lis3dsh_init(const lis3dsh_config_t* config) {
+    if (config == NULL || config->spi == NULL || config->watermark > LIS3DSH_MAX_WATERMARK ||
+        config->odr < LIS3DSH_ODR_3_125_HZ || config->odr > LIS3DSH_ODR_1600_HZ ||
+        config->scale > LIS3DSH_SCALE_16G || config->cs_pin > 15 || config->int1_pin > 15) {
+        return NULL;
+    }
+
+    struct lis3dsh_handle_t* handle = allocate_handle();
+    if (handle == NULL) {
+        return NULL;
+    }
+
+    // Use C tricks to write to const members during initialization
+    memcpy((void*)&handle->config, config, sizeof(lis3dsh_config_t));
+    lis3dsh_context_t* ctx = &handle->context;
+
+    const gpio_config_t cs_config = {
+        .mode = GPIO_MODE_OUTPUT,
+        .pull = GPIO_PULL_NONE,
+        .output_type = GPIO_OUTPUT_TYPE_PUSH_PULL,
+        .speed = GPIO_SPEED_HIGH,
+    };
+    const gpio_config_t int_config = {
+        .mode = GPIO_MODE_INPUT,
+        .pull = GPIO_PULL_NONE,
+    };
+    ctx->cs = gpio_init(config->cs_port, (uint16_t)(1U << config->cs_pin), &cs_config);
+    ctx->int1 = gpio_init(config->int1_port, (uint16_t)(1U << config->int1_pin), &int_config);
+    if (ctx->cs == NULL || ctx->int1 == NULL) {
+        lis3dsh_deinit(&handle);
+        return NULL;
+    }
+    gpio_set(ctx->cs);
+
+    uint8_t who_am_i = 0;
+    if (read_reg(handle, LIS3DSH_REG_WHO_AM_I, &who_am_i) != 0 || who_am_i != LIS3DSH_WHO_AM_I_VALUE) {
+        lis3dsh_deinit(&handle);
+        return NULL;
+    }
+
+    // One transaction per drain: the read address, then 6 bytes per sample;
+    // the address wraps from OUT_Z_H to OUT_X_L and pops the next FIFO entry
+    ctx->samples_per_drain = (config->watermark != 0) ? config->watermark : 1;
+    memset(ctx->tx, 0, sizeof(ctx->tx));
+    ctx->tx[0] = LIS3DSH_SPI_READ | LIS3DSH_REG_OUT_X_L;
+    ctx->txn = (spi_transaction_t){
+        .p_tx_data = ctx->tx,
+        .p_rx_data = ctx->rx,
+        .len = 1 + ctx->samples_per_drain * LIS3DSH_SAMPLE_BYTES,
+        .select = select_device,
+        .callback = on_drain_complete,
+        .p_context = handle,
+    };
+    atomic_flag_clear(&ctx->is_draining);
+    atomic_init(&ctx->is_pending, false);
+    s_selected = handle;
+
+    const exti_config_t exti_config = {
+        .trigger = EXTI_TRIGGER_RISING,
+        .callback = on_int1,
+        .user_data = handle,
+    };
+    ctx->exti = exti_init(config->int1_port, config->int1_pin, &exti_config);
+    if (ctx->exti == NULL || configure_device(handle) != 0) {
+        lis3dsh_deinit(&handle);
+        return NULL;
+    }
+    ctx->is_initialized = true;
+
+    // INT1 may have risen before the EXTI line was armed
+    if (gpio_read(ctx->int1)) {
+        start_drain(handle);
+    }
+    return handle;
+}
+
+void lis3dsh_deinit(lis3dsh_handle_t* p_handle) {
+    if (p_handle == NULL || *p_handle == NULL) {
+        return;
+    }
+    lis3dsh_handle_t handle = *p_handle;
+    lis3dsh_context_t* ctx = &handle->context;
+
+    if (ctx->exti) {
+        exti_deinit(&ctx->exti);
+    }
+    if (ctx->is_initialized) {
+        // No new drain can start; wait for the running one to release the flag
+        ctx->is_initialized = false;
+        while (atomic_flag_test_and_set(&ctx->is_draining)) {
+        }
+        (void)write_reg(handle, LIS3DSH_REG_CTRL_REG3, 0);
+        (void)write_reg(handle, LIS3DSH_REG_CTRL_REG4, 0);
+    }
+    if (ctx->cs) {
+        gpio_deinit(&ctx->cs);
+    }
+    if (ctx->int1) {
+        gpio_deinit(&ctx->int1);
+    }
+    if (s_selected == handle) {
+        s_selected = NULL;
+    }
+    release_handle(handle);
+    *p_handle = NULL;
+}
+
+float lis3dsh_get_g_per_count(lis3dsh_handle_t handle) {
+    return handle ? s_g_per_count[handle->config.scale] : 0.0f;
+}
+
+float lis3dsh_get_rate_hz(lis3dsh_handle_t handle) {
+    return handle ? s_rate_hz[handle->config.odr] : 0.0f;
+}
+
+void lis3dsh_get_stats(lis3dsh_handle_t handle, lis3dsh_stats_t* p_stats) {
+    if (handle == NULL || p_stats == NULL) {
+        return;
+    }
+    p_stats->drains = handle->context.stats.drains;
+    p_stats->samples = handle->context.stats.samples;
+    p_stats->back_to_back = handle->context.stats.back_to_back;
+    p_stats->errors = handle->context.stats.errors;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file      lis3dsh.h
+ * @brief     Public API for the LIS3DSH 3-axis accelerometer driver.
+ *
+ * @details   The device sits on an SPI bus shared through the SPI driver's
+ *            transaction queue. Samples are collected in the device's
+ *            32-sample FIFO in stream mode; when the FIFO reaches the
+ *            watermark, INT1 fires through the EXTI driver and the driver
+ *            drains `watermark` samples in a single asynchronous SPI
+ *            transaction (one address byte followed by 6 bytes per sample,
+ *            the address wrapping from OUT_Z_H back to OUT_X_L). At 1600 Hz
+ *            with a watermark of 16 that is 100 transactions per second and
+ *            no CPU involvement between them.
+ *
+ *            With a watermark of 0 the FIFO is bypassed and every data-ready
+ *            pulse reads one sample.
+ */
+
+#ifndef LIS3DSH_H
+#define LIS3DSH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "spi.h"
+
+/* --- Opaque Handle Definition --- */
+
+/**
+ * @brief Opaque handle representing a LIS3DSH device.
+ */
+typedef struct lis3dsh_handle_t* lis3dsh_handle_t;
+
+/* --- Public Configuration Types --- */
+
+/** @brief Output data rate (CTRL_REG4 ODR field). */
+typedef enum {
+    LIS3DSH_ODR_3_125_HZ = 1,
+    LIS3DSH_ODR_6_25_HZ,
+    LIS3DSH_ODR_12_5_HZ,
+    LIS3DSH_ODR_25_HZ,
+    LIS3DSH_ODR_50_HZ,
+    LIS3DSH_ODR_100_HZ,
+    LIS3DSH_ODR_400_HZ,
+    LIS3DSH_ODR_800_HZ,
+    LIS3DSH_ODR_1600_HZ,
+} lis3dsh_odr_t;
+
+/** @brief Full-scale range (CTRL_REG5 FSCALE field). */
+typedef enum {
+    LIS3DSH_SCALE_2G = 0,
+    LIS3DSH_SCALE_4G,
+    LIS3DSH_SCALE_6G,
+    LIS3DSH_SCALE_8G,
+    LIS3DSH_SCALE_16G,
+} lis3dsh_scale_t;
+
+/** @brief One raw sample in counts; see lis3dsh_get_g_per_count(). */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} lis3dsh_sample_t;
+
+/**
+ * @brief Called with each block of samples drained from the FIFO.
+ * @details Called from interrupt context. The samples stay valid until the
+ *          second block after this one arrives, i.e. for at least one full
+ *          watermark period.
+ *
+ * @param[in] p_context The context given in the configuration.
+ * @param[in] p_samples The samples, oldest first.
+ * @param[in] count Number of samples: the watermark, or 1 without the FIFO.
+ */
+typedef void (*lis3dsh_callback_t)(void* p_context, const lis3dsh_sample_t* p_samples, size_t count);
+
+/**
+ * @brief Configuration structure for LIS3DSH initialization.
+ */
+typedef struct {
+    spi_handle_t spi;               // Bus with DMA support: mode 3, 8-bit frames, at most 10 MHz
+    uint8_t cs_port;                // Chip select GPIO port (e.g., 4 for GPIOE)
+    uint8_t cs_pin;
+    uint8_t int1_port;              // INT1 GPIO port; its EXTI line must be free
+    uint8_t int1_pin;
+    lis3dsh_odr_t odr;
+    lis3dsh_scale_t scale;
+    uint8_t watermark;              // Samples per FIFO drain, 1 to LIS3DSH_MAX_WATERMARK; 0 bypasses the FIFO
+    lis3dsh_callback_t callback;
+    void* p_context;
+} lis3dsh_config_t;
+
+/**
+ * @brief Transfer counters.
+ */
+typedef struct {
+    uint32_t drains;                // SPI transactions completed
+    uint32_t samples;
+    uint32_t back_to_back;          // Drains started as soon as the previous one ended, INT1 still high
+    uint32_t errors;                // Transactions that failed or could not be queued
+} lis3dsh_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Identifies and configures the device and starts sampling.
+ *
+ * @details Uses blocking SPI transfers to check WHO_AM_I and write the
+ *          configuration, so it must be called while no asynchronous
+ *          transaction is queued on the bus. The callback starts running
+ *          once the first block is drained.
+ *
+ * @param[in] config Pointer to the configuration structure.
+ *
+ * @return A handle to the device, or NULL if the arguments are invalid, the
+ *         device does not answer, or a GPIO or EXTI line is unavailable.
+ */
+lis3dsh_handle_t lis3dsh_init(const lis3dsh_config_t* config);
+
+/**
+ * @brief Stops sampling and powers the device down.
+ * @details Waits for a drain in progress to finish. Task context only.
+ *
+ * @param[in,out] p_handle Pointer to the handle to de-initialize.
+ */
+void lis3dsh_deinit(lis3dsh_handle_t* p_handle);
+
+/**
+ * @brief Returns the sensitivity of the configured full-scale range.
+ * @param[in] handle The device handle.
+ * @return Acceleration in g of one count.
+ */
+float lis3dsh_get_g_per_count(lis3dsh_handle_t handle);
+
+/**
+ * @brief Returns the output data rate in Hz.
+ * @param[in] handle The device handle.
+ */
+float lis3dsh_get_rate_hz(lis3dsh_handle_t handle);
+
+/**
+ * @brief Copies the transfer counters.
+ * @param[in] handle The device handle.
+ * @param[out] p_stats Destination.
+ */
+void lis3dsh_get_stats(lis3dsh_handle_t handle, lis3dsh_stats_t* p_stats);
+
+#endif // LIS3DSH_H
@@ -0,0 +1,23 @@
+/**
+ * @file      lis3dsh_config.h
+ * @brief     Compile-time configuration for the LIS3DSH accelerometer driver.
+ */
+
+#ifndef LIS3DSH_CONFIG_H
+#define LIS3DSH_CONFIG_H
+
+/**
+ * @brief Defines the maximum number of LIS3DSH devices the driver can manage.
+ * @note  The SPI chip select callback carries no context, so one device is
+ *        supported.
+ */
+#define LIS3DSH_MAX_INSTANCES 1
+
+/**
+ * @brief Largest FIFO watermark, in samples. The hardware FIFO holds 32
+ *        samples; draining before it is full leaves room for the interrupt
+ *        and transfer latency in stream mode.
+ */
+#define LIS3DSH_MAX_WATERMARK 31
+
+#endif // LIS3DSH_CONFIG_H
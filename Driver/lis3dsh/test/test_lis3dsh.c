@@ -0,0 +1,696 @@
+/**
+ * @file      test_lis3dsh.c
+ * @brief     Host test of the LIS3DSH driver against a fake sensor replaying motion.
+ *
+ * @details   The driver runs on fakes of the GPIO, EXTI and SPI drivers.
+ *            The fake sensor decodes register writes, and at the data rate
+ *            it pushes the next sample of a motion recording (a tilted,
+ *            tapped board with sensor noise) into a 32-entry stream FIFO. It
+ *            raises INT1 at the watermark, or on data-ready when the FIFO is
+ *            bypassed, and serves burst reads with the OUT_Z_H to OUT_X_L
+ *            wrap. Time is simulated: SPI frames take 8 bit times at
+ *            5.25 MHz, and another client can hold the shared bus.
+ *
+ *            - Configuration: the register writes and their order, WHO_AM_I
+ *              rejection, and the power-down on deinit.
+ *            - Quiet bus: every sample arrives once and in order, one drain
+ *              per watermark, no back-to-back drains.
+ *            - Shared bus: drains queued behind long transactions find
+ *              INT1 still high, or see it rise again while they run; no
+ *              sample is lost as long as the FIFO does not overrun.
+ *            - Overrun: a bus held past the FIFO depth loses samples, and
+ *              exactly those the FIFO overwrote; the stream then resumes.
+ *            - Bypass: one sample per data-ready interrupt.
+ */
+
+#include "lis3dsh.h"
+#include "internal/lis3dsh_reg.h"
+#include "gpio.h"
+#include "exit.h"
+#include "unit_test.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CS_PORT             4       // PE3, as on the Discovery board
+#define CS_PIN              3
+#define INT1_PORT           4       // PE0
+#define INT1_PIN            0
+
+#define FIFO_DEPTH          32
+#define BYTE_NS             1524ULL // 8 bits at 5.25 MHz (APB2 / 16)
+#define NEVER               UINT64_MAX
+
+#define TRACE_LEN           4096    // Samples in the recording, replayed in a loop
+#define TRACE_RATE_HZ       1600.0f
+#define COUNTS_PER_G        16384.0f
+#define SEARCH_WINDOW       (4 * FIFO_DEPTH)
+
+// --- Test Data ---
+
+static lis3dsh_sample_t s_trace[TRACE_LEN];
+
+// Sample period of each ODR code, in ns
+static const uint64_t s_period_ns[] = {
+    0, 320000000, 160000000, 80000000, 40000000, 20000000, 10000000, 2500000, 1250000, 625000,
+};
+
+// --- Stubs for the GPIO, EXTI and SPI drivers ---
+
+struct gpio_handle_t {
+    bool in_use;
+    uint8_t port;
+    uint16_t pin_mask;
+    bool level;
+};
+
+struct exti_handle_t {
+    bool in_use;
+    uint8_t line;
+    exti_config_t config;
+};
+
+struct spi_handle_t {
+    int unused;
+};
+
+static struct gpio_handle_t s_pins[4];
+static struct exti_handle_t s_exti;
+static struct spi_handle_t s_spi;
+
+static uint64_t s_now;                  // Simulated time, in ns
+
+// Fake sensor
+static struct {
+    uint8_t reg[0x80];
+    uint8_t who_am_i;
+    lis3dsh_sample_t fifo[FIFO_DEPTH];
+    uint32_t head;
+    uint32_t count;
+    lis3dsh_sample_t out;               // Output registers when the FIFO is bypassed
+    bool data_ready;
+    bool int1;
+    bool paused;                        // Stops sampling, to let the bus settle
+    uint64_t next_sample;
+    uint32_t produced;
+    uint32_t overruns;                  // Samples overwritten before they were read
+    uint32_t underruns;                 // Reads of an empty FIFO
+    uint32_t edges;
+    uint32_t edges_while_draining;
+    uint32_t bad_frames;                // Transfers without chip select, or on a busy bus
+    uint8_t writes[32][2];
+    int n_writes;
+} s_sensor;
+
+// Fake SPI bus: transactions run one at a time, in submission order
+static struct {
+    spi_transaction_t* p_head;
+    spi_transaction_t* p_tail;
+    uint64_t end;
+    bool is_completing;
+    bool is_draining;                   // The transaction running is the sensor's
+} s_bus;
+
+// Another client of the bus, holding it for `len` bytes every `period` ns
+static struct {
+    spi_transaction_t txn;
+    uint64_t period;
+    uint64_t next;
+    bool is_queued;
+    uint32_t done;
+} s_hog;
+
+// What the driver delivered
+static struct {
+    uint32_t blocks;
+    uint32_t samples;
+    uint32_t next;                      // Trace index of the next expected sample
+    uint32_t lost;
+    uint32_t mismatches;
+    uint32_t bad_blocks;                // Wrong count, or the buffer of the previous block
+    size_t block_len;
+    const lis3dsh_sample_t* p_last;
+} s_rx;
+
+static bool fifo_active(void) {
+    return (s_sensor.reg[LIS3DSH_REG_CTRL_REG6] & LIS3DSH_CTRL_REG6_FIFO_EN) &&
+           (s_sensor.reg[LIS3DSH_REG_FIFO_CTRL] >> LIS3DSH_FIFO_CTRL_FMODE_SHIFT) == LIS3DSH_FIFO_MODE_STREAM;
+}
+
+static void update_int1(void) {
+    uint8_t reg3 = s_sensor.reg[LIS3DSH_REG_CTRL_REG3];
+    bool asserted = false;
+    if (fifo_active()) {
+        uint32_t wtm = s_sensor.reg[LIS3DSH_REG_FIFO_CTRL] & LIS3DSH_FIFO_CTRL_WTMP_MASK;
+        asserted = (s_sensor.reg[LIS3DSH_REG_CTRL_REG6] & LIS3DSH_CTRL_REG6_P1_WTM) && s_sensor.count >= wtm;
+    } else {
+        asserted = (reg3 & LIS3DSH_CTRL_REG3_DR_EN) && s_sensor.data_ready;
+    }
+    bool level = false;
+    if (reg3 & LIS3DSH_CTRL_REG3_INT1_EN) {
+        level = (reg3 & LIS3DSH_CTRL_REG3_IEA) ? asserted : !asserted;
+    }
+
+    bool rose = level && !s_sensor.int1;
+    s_sensor.int1 = level;
+    if (rose && s_exti.in_use) {
+        s_sensor.edges++;
+        if (s_bus.is_draining) {
+            s_sensor.edges_while_draining++;
+        }
+        s_exti.config.callback(s_exti.line, s_exti.config.user_data);
+    }
+}
+
+static void sensor_sample(void) {
+    lis3dsh_sample_t sample = s_trace[s_sensor.produced++ % TRACE_LEN];
+    if (fifo_active()) {
+        if (s_sensor.count == FIFO_DEPTH) {
+            s_sensor.head = (s_sensor.head + 1) % FIFO_DEPTH;
+            s_sensor.count--;
+            s_sensor.overruns++;
+        }
+        s_sensor.fifo[(s_sensor.head + s_sensor.count) % FIFO_DEPTH] = sample;
+        s_sensor.count++;
+    } else {
+        if (s_sensor.data_ready) {
+            s_sensor.overruns++;
+        }
+        s_sensor.out = sample;
+        s_sensor.data_ready = true;
+    }
+    s_sensor.next_sample += s_period_ns[s_sensor.reg[LIS3DSH_REG_CTRL_REG4] >> LIS3DSH_CTRL_REG4_ODR_SHIFT];
+    update_int1();
+}
+
+static uint8_t sensor_read(uint8_t addr) {
+    if (addr == LIS3DSH_REG_WHO_AM_I) {
+        return s_sensor.who_am_i;
+    }
+    if (addr < LIS3DSH_REG_OUT_X_L || addr > LIS3DSH_REG_OUT_X_L + 5) {
+        return s_sensor.reg[addr];
+    }
+
+    const lis3dsh_sample_t* p_sample = &s_sensor.out;
+    if (fifo_active()) {
+        if (s_sensor.count == 0) {
+            s_sensor.underruns++;
+        }
+        p_sample = &s_sensor.fifo[s_sensor.head];
+    }
+    int16_t axes[3] = {p_sample->x, p_sample->y, p_sample->z};
+    int offset = addr - LIS3DSH_REG_OUT_X_L;
+    uint16_t value = (uint16_t)axes[offset / 2];
+    if (addr == LIS3DSH_REG_OUT_X_L + 5) {
+        // Reading OUT_Z_H releases the sample
+        if (fifo_active() && s_sensor.count > 0) {
+            s_sensor.head = (s_sensor.head + 1) % FIFO_DEPTH;
+            s_sensor.count--;
+        }
+        s_sensor.data_ready = false;
+    }
+    return (offset & 1) ? (uint8_t)(value >> 8) : (uint8_t)value;
+}
+
+static void sensor_write(uint8_t addr, uint8_t value) {
+    if (s_sensor.n_writes < (int)(sizeof(s_sensor.writes) / sizeof(s_sensor.writes[0]))) {
+        s_sensor.writes[s_sensor.n_writes][0] = addr;
+        s_sensor.writes[s_sensor.n_writes][1] = value;
+        s_sensor.n_writes++;
+    }
+    uint8_t old = s_sensor.reg[addr];
+    s_sensor.reg[addr] = value;
+    if (addr == LIS3DSH_REG_FIFO_CTRL && (value >> LIS3DSH_FIFO_CTRL_FMODE_SHIFT) == LIS3DSH_FIFO_MODE_BYPASS) {
+        s_sensor.head = 0;
+        s_sensor.count = 0;
+    }
+    if (addr == LIS3DSH_REG_CTRL_REG4) {
+        uint8_t odr = value >> LIS3DSH_CTRL_REG4_ODR_SHIFT;
+        if (odr == 0) {
+            s_sensor.next_sample = NEVER;
+        } else if ((old >> LIS3DSH_CTRL_REG4_ODR_SHIFT) == 0) {
+            s_sensor.next_sample = s_now + s_period_ns[odr];
+        }
+    }
+    update_int1();
+}
+
+/** @brief One chip-select frame: the address byte, then data bytes. */
+static void sensor_frame(const uint8_t* p_tx, uint8_t* p_rx, size_t len) {
+    bool is_read = (p_tx[0] & LIS3DSH_SPI_READ) != 0;
+    uint8_t addr = p_tx[0] & 0x7F;
+    bool add_inc = (s_sensor.reg[LIS3DSH_REG_CTRL_REG6] & LIS3DSH_CTRL_REG6_ADD_INC) != 0;
+
+    if (p_rx) {
+        p_rx[0] = 0xFF;
+    }
+    for (size_t i = 1; i < len; ++i) {
+        if (is_read) {
+            uint8_t value = sensor_read(addr);
+            if (p_rx) {
+                p_rx[i] = value;
+            }
+        } else {
+            sensor_write(addr, p_tx[i]);
+        }
+        if (add_inc) {
+            addr = (addr == LIS3DSH_REG_OUT_X_L + 5) ? LIS3DSH_REG_OUT_X_L : (uint8_t)((addr + 1) & 0x7F);
+        }
+    }
+    if (is_read) {
+        update_int1();
+    }
+}
+
+static bool cs_selected(void) {
+    for (size_t i = 0; i < sizeof(s_pins) / sizeof(s_pins[0]); ++i) {
+        if (s_pins[i].in_use && s_pins[i].port == CS_PORT && s_pins[i].pin_mask == (1U << CS_PIN)) {
+            return !s_pins[i].level;
+        }
+    }
+    return false;
+}
+
+gpio_handle_t gpio_init(uint8_t port_num, uint16_t pin_mask, const gpio_config_t* config) {
+    (void)config;
+    for (size_t i = 0; i < sizeof(s_pins) / sizeof(s_pins[0]); ++i) {
+        if (!s_pins[i].in_use) {
+            s_pins[i] = (struct gpio_handle_t){.in_use = true, .port = port_num, .pin_mask = pin_mask};
+            return &s_pins[i];
+        }
+    }
+    return NULL;
+}
+
+void gpio_deinit(gpio_handle_t* p_handle) {
+    (*p_handle)->in_use = false;
+    *p_handle = NULL;
+}
+
+void gpio_set(gpio_handle_t handle) {
+    handle->level = true;
+}
+
+void gpio_clear(gpio_handle_t handle) {
+    handle->level = false;
+}
+
+bool gpio_read(gpio_handle_t handle) {
+    if (handle->port == INT1_PORT && handle->pin_mask == (1U << INT1_PIN)) {
+        return s_sensor.int1;
+    }
+    return handle->level;
+}
+
+exti_handle_t exti_init(uint8_t port_num, uint8_t pin_num, const exti_config_t* config) {
+    (void)port_num;
+    if (s_exti.in_use) {
+        return NULL;
+    }
+    s_exti = (struct exti_handle_t){.in_use = true, .line = pin_num, .config = *config};
+    return &s_exti;
+}
+
+void exti_deinit(exti_handle_t* p_handle) {
+    (*p_handle)->in_use = false;
+    *p_handle = NULL;
+}
+
+int spi_transfer_blocking(spi_handle_t handle, const uint8_t* p_tx_data, uint8_t* p_rx_data, size_t len) {
+    if (handle != &s_spi || !cs_selected() || s_bus.p_head != NULL) {
+        s_sensor.bad_frames++;
+        return -1;
+    }
+    sensor_frame(p_tx_data, p_rx_data, len);
+    return 0;
+}
+
+static void bus_start_head(void) {
+    spi_transaction_t* p_txn = s_bus.p_head;
+    if (p_txn->select) {
+        p_txn->select(true);
+    }
+    // The sensor answers if its chip select is low; the FIFO entries are
+    // popped as the burst starts, and INT1 follows straight away
+    s_bus.is_draining = cs_selected();
+    if (s_bus.is_draining) {
+        sensor_frame(p_txn->p_tx_data, p_txn->p_rx_data, p_txn->len);
+    }
+    s_bus.end = s_now + p_txn->len * BYTE_NS;
+}
+
+static void bus_complete_head(void) {
+    spi_transaction_t* p_txn = s_bus.p_head;
+    s_bus.p_head = p_txn->p_next;
+    if (s_bus.p_head == NULL) {
+        s_bus.p_tail = NULL;
+    }
+    if (p_txn->select) {
+        p_txn->select(false);
+    }
+    s_bus.is_draining = false;
+    s_bus.is_completing = true;
+    if (p_txn->callback) {
+        p_txn->callback(p_txn->p_context, 0);
+    }
+    s_bus.is_completing = false;
+    if (s_bus.p_head) {
+        bus_start_head();
+    }
+}
+
+int spi_transfer_async(spi_handle_t handle, spi_transaction_t* p_txn) {
+    if (handle != &s_spi) {
+        return -1;
+    }
+    p_txn->p_next = NULL;
+    bool was_idle = (s_bus.p_head == NULL);
+    if (was_idle) {
+        s_bus.p_head = p_txn;
+    } else {
+        s_bus.p_tail->p_next = p_txn;
+    }
+    s_bus.p_tail = p_txn;
+    if (was_idle && !s_bus.is_completing) {
+        bus_start_head();
+    }
+    return 0;
+}
+
+// --- Helpers ---
+
+/** @brief Records a board tilting about two axes, a few taps, and sensor noise. */
+static void record_motion(void) {
+    uint32_t seed = 12345;
+    for (int i = 0; i < TRACE_LEN; ++i) {
+        float t = (float)i / TRACE_RATE_HZ;
+        float roll = 0.6f * sinf(2.0f * (float)M_PI * 0.5f * t);
+        float pitch = 0.4f * sinf(2.0f * (float)M_PI * 0.3f * t + 1.0f);
+        float tap = 0.0f;
+        int since_tap = i % 700;
+        if (since_tap < 40) {
+            tap = 1.5f * expf(-(float)since_tap / 8.0f);
+        }
+        float axes[3] = {
+            sinf(roll),
+            sinf(pitch),
+            cosf(roll) * cosf(pitch) + tap,
+        };
+        int16_t counts[3];
+        for (int a = 0; a < 3; ++a) {
+            seed = seed * 1664525U + 1013904223U;
+            float noise = (float)((int32_t)(seed >> 24) - 128) / 4.0f;
+            counts[a] = (int16_t)lrintf(fmaxf(-32768.0f, fminf(32767.0f, axes[a] * COUNTS_PER_G + noise)));
+        }
+        s_trace[i] = (lis3dsh_sample_t){counts[0], counts[1], counts[2]};
+    }
+}
+
+static bool same_sample(const lis3dsh_sample_t* p_a, const lis3dsh_sample_t* p_b) {
+    return p_a->x == p_b->x && p_a->y == p_b->y && p_a->z == p_b->z;
+}
+
+/** @brief Driver callback: finds each sample in the recording, counting the ones skipped. */
+static void on_samples(void* p_context, const lis3dsh_sample_t* p_samples, size_t count) {
+    (void)p_context;
+    s_rx.blocks++;
+    if (count != s_rx.block_len || p_samples == s_rx.p_last) {
+        s_rx.bad_blocks++;
+    }
+    s_rx.p_last = p_samples;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t skip = 0;
+        while (skip < SEARCH_WINDOW && !same_sample(&p_samples[i], &s_trace[(s_rx.next + skip) % TRACE_LEN])) {
+            skip++;
+        }
+        if (skip == SEARCH_WINDOW) {
+            s_rx.mismatches++;
+            s_rx.next++;
+        } else {
+            s_rx.lost += skip;
+            s_rx.next += skip + 1;
+        }
+        s_rx.samples++;
+    }
+}
+
+static void hog_done(void* p_context, int status) {
+    (void)p_context;
+    (void)status;
+    s_hog.is_queued = false;
+    s_hog.done++;
+}
+
+/** @brief Runs the sensor, the bus and the other client until `end`. */
+static void run_until(uint64_t end) {
+    for (;;) {
+        uint64_t bus_end = s_bus.p_head ? s_bus.end : NEVER;
+        uint64_t sample = s_sensor.paused ? NEVER : s_sensor.next_sample;
+        uint64_t hog = s_hog.period ? s_hog.next : NEVER;
+        uint64_t next = bus_end;
+        next = (sample < next) ? sample : next;
+        next = (hog < next) ? hog : next;
+        if (next > end || next == NEVER) {
+            if (end != NEVER) {
+                s_now = end;
+            }
+            return;
+        }
+        s_now = next;
+        if (next == bus_end) {
+            bus_complete_head();
+        } else if (next == sample) {
+            sensor_sample();
+        } else {
+            s_hog.next += s_hog.period;
+            if (!s_hog.is_queued) {
+                s_hog.is_queued = true;
+                spi_transfer_async(&s_spi, &s_hog.txn);
+            }
+        }
+    }
+}
+
+static void reset(size_t block_len) {
+    memset(&s_sensor, 0, sizeof(s_sensor));
+    memset(&s_bus, 0, sizeof(s_bus));
+    memset(&s_hog, 0, sizeof(s_hog));
+    memset(&s_rx, 0, sizeof(s_rx));
+    s_sensor.who_am_i = LIS3DSH_WHO_AM_I_VALUE;
+    s_sensor.next_sample = NEVER;
+    s_rx.block_len = block_len;
+    s_now = 0;
+}
+
+static lis3dsh_handle_t start(lis3dsh_odr_t odr, uint8_t watermark) {
+    reset(watermark ? watermark : 1);
+    const lis3dsh_config_t config = {
+        .spi = &s_spi,
+        .cs_port = CS_PORT,
+        .cs_pin = CS_PIN,
+        .int1_port = INT1_PORT,
+        .int1_pin = INT1_PIN,
+        .odr = odr,
+        .scale = LIS3DSH_SCALE_2G,
+        .watermark = watermark,
+        .callback = on_samples,
+    };
+    return lis3dsh_init(&config);
+}
+
+/** @brief Stops sampling, lets the bus settle, and checks what was delivered. */
+static void settle(lis3dsh_handle_t accel, lis3dsh_stats_t* p_stats) {
+    s_sensor.paused = true;
+    s_hog.period = 0;
+    run_until(NEVER);
+
+    lis3dsh_get_stats(accel, p_stats);
+    TEST_CHECK(p_stats->drains == s_rx.blocks);
+    TEST_CHECK(p_stats->samples == s_rx.samples);
+    TEST_CHECK(p_stats->errors == 0);
+    TEST_CHECK(s_rx.bad_blocks == 0);
+    TEST_CHECK(s_rx.mismatches == 0);
+    // Every sample that did not arrive was overwritten in the sensor, and
+    // what is left in the FIFO is below the watermark
+    TEST_CHECK(s_rx.lost == s_sensor.overruns);
+    TEST_CHECK(s_rx.next + s_sensor.count == s_sensor.produced);
+    TEST_CHECK(s_sensor.count < s_rx.block_len || s_rx.block_len == 1);
+    // A drain starts on each edge, except one that finds a drain running,
+    // and as soon as the previous one ends if INT1 rose or stayed high
+    TEST_CHECK(p_stats->drains == s_sensor.edges - s_sensor.edges_while_draining + p_stats->back_to_back);
+    TEST_CHECK(s_sensor.bad_frames == 0);
+    TEST_CHECK(s_sensor.underruns == 0);
+}
+
+/** @brief Deinitialises the driver and checks the device is powered down. */
+static void stop(lis3dsh_handle_t* p_accel) {
+    s_sensor.n_writes = 0;
+    lis3dsh_deinit(p_accel);
+    TEST_CHECK(*p_accel == NULL);
+    TEST_CHECK(s_sensor.n_writes == 2);
+    TEST_CHECK(s_sensor.writes[0][0] == LIS3DSH_REG_CTRL_REG3 && s_sensor.writes[0][1] == 0);
+    TEST_CHECK(s_sensor.writes[1][0] == LIS3DSH_REG_CTRL_REG4 && s_sensor.writes[1][1] == 0);
+    TEST_CHECK(s_sensor.next_sample == NEVER);
+    TEST_CHECK(!s_exti.in_use);
+    for (size_t i = 0; i < sizeof(s_pins) / sizeof(s_pins[0]); ++i) {
+        TEST_CHECK(!s_pins[i].in_use);
+    }
+    TEST_CHECK(s_sensor.bad_frames == 0);
+}
+
+// --- Tests ---
+
+static void test_configuration(void) {
+    lis3dsh_handle_t accel = start(LIS3DSH_ODR_1600_HZ, 16);
+    TEST_CHECK(accel != NULL);
+    if (accel == NULL) {
+        return;
+    }
+    // Powered down and bypassed first, the data rate last
+    static const uint8_t expected[][2] = {
+        {LIS3DSH_REG_CTRL_REG4, 0},
+        {LIS3DSH_REG_FIFO_CTRL, LIS3DSH_FIFO_MODE_BYPASS << LIS3DSH_FIFO_CTRL_FMODE_SHIFT},
+        {LIS3DSH_REG_CTRL_REG5, LIS3DSH_SCALE_2G << LIS3DSH_CTRL_REG5_FSCALE_SHIFT},
+        {LIS3DSH_REG_CTRL_REG6, LIS3DSH_CTRL_REG6_ADD_INC | LIS3DSH_CTRL_REG6_FIFO_EN | LIS3DSH_CTRL_REG6_P1_WTM},
+        {LIS3DSH_REG_FIFO_CTRL, (LIS3DSH_FIFO_MODE_STREAM << LIS3DSH_FIFO_CTRL_FMODE_SHIFT) | 16},
+        {LIS3DSH_REG_CTRL_REG3, LIS3DSH_CTRL_REG3_IEA | LIS3DSH_CTRL_REG3_INT1_EN},
+        {LIS3DSH_REG_CTRL_REG4, (LIS3DSH_ODR_1600_HZ << LIS3DSH_CTRL_REG4_ODR_SHIFT) |
+                                LIS3DSH_CTRL_REG4_XEN | LIS3DSH_CTRL_REG4_YEN | LIS3DSH_CTRL_REG4_ZEN},
+    };
+    TEST_CHECK(s_sensor.n_writes == (int)(sizeof(expected) / sizeof(expected[0])));
+    TEST_CHECK(memcmp(s_sensor.writes, expected, sizeof(expected)) == 0);
+    TEST_CHECK(!cs_selected());
+    TEST_CHECK(s_exti.in_use && s_exti.line == INT1_PIN && s_exti.config.trigger == EXTI_TRIGGER_RISING);
+    TEST_CHECK(lis3dsh_get_rate_hz(accel) == 1600.0f);
+    TEST_CHECK(lis3dsh_get_g_per_count(accel) == 0.00006f);
+    lis3dsh_stats_t stats;
+    settle(accel, &stats);
+    stop(&accel);
+
+    // A device that is not a LIS3DSH (the LIS302DL of older boards) is refused
+    reset(16);
+    s_sensor.who_am_i = 0x3B;
+    const lis3dsh_config_t config = {
+        .spi = &s_spi, .cs_port = CS_PORT, .cs_pin = CS_PIN, .int1_port = INT1_PORT, .int1_pin = INT1_PIN,
+        .odr = LIS3DSH_ODR_100_HZ, .scale = LIS3DSH_SCALE_2G, .watermark = 16, .callback = on_samples,
+    };
+    TEST_CHECK(lis3dsh_init(&config) == NULL);
+    TEST_CHECK(s_sensor.n_writes == 0);
+    TEST_CHECK(!s_exti.in_use && !s_pins[0].in_use && !s_pins[1].in_use);
+
+    // The handle was released: the next init gets it
+    s_sensor.who_am_i = LIS3DSH_WHO_AM_I_VALUE;
+    accel = lis3dsh_init(&config);
+    TEST_CHECK(accel != NULL);
+    if (accel) {
+        settle(accel, &stats);
+        stop(&accel);
+    }
+}
+
+static void test_quiet_bus(void) {
+    lis3dsh_handle_t accel = start(LIS3DSH_ODR_1600_HZ, 16);
+    TEST_CHECK(accel != NULL);
+    if (accel == NULL) {
+        return;
+    }
+    run_until(2000000000ULL);
+
+    lis3dsh_stats_t stats;
+    settle(accel, &stats);
+    TEST_CHECK(s_sensor.produced == 3200);
+    TEST_CHECK(s_rx.samples == s_sensor.produced);
+    TEST_CHECK(s_sensor.overruns == 0);
+    // One edge, one drain per watermark
+    TEST_CHECK(stats.drains == s_sensor.edges);
+    TEST_CHECK(stats.drains == s_sensor.produced / 16);
+    TEST_CHECK(stats.back_to_back == 0);
+    stop(&accel);
+}
+
+static void test_shared_bus(void) {
+    lis3dsh_handle_t accel = start(LIS3DSH_ODR_1600_HZ, 8);
+    TEST_CHECK(accel != NULL);
+    if (accel == NULL) {
+        return;
+    }
+    // 9 ms transactions every 23 ms: a drain waits for up to 15 more
+    // samples, more than a watermark but still within the FIFO
+    static uint8_t hog_data[9000000ULL / BYTE_NS];
+    s_hog.txn = (spi_transaction_t){.p_tx_data = hog_data, .len = sizeof(hog_data), .callback = hog_done};
+    s_hog.period = 23000000ULL;
+    s_hog.next = 1000000ULL;
+    run_until(4000000000ULL);
+    uint32_t hogs = s_hog.done;
+
+    lis3dsh_stats_t stats;
+    settle(accel, &stats);
+    TEST_CHECK(hogs > 150);
+    TEST_CHECK(s_sensor.overruns == 0);
+    TEST_CHECK(stats.back_to_back > 0);
+    TEST_CHECK(s_sensor.edges_while_draining > 0);
+    stop(&accel);
+}
+
+static void test_overrun(void) {
+    lis3dsh_handle_t accel = start(LIS3DSH_ODR_1600_HZ, 16);
+    TEST_CHECK(accel != NULL);
+    if (accel == NULL) {
+        return;
+    }
+    // 30 ms holds the bus for 48 samples: past the FIFO depth
+    static uint8_t hog_data[30000000ULL / BYTE_NS];
+    s_hog.txn = (spi_transaction_t){.p_tx_data = hog_data, .len = sizeof(hog_data), .callback = hog_done};
+    s_hog.period = 100000000ULL;
+    s_hog.next = 5000000ULL;
+    run_until(1000000000ULL);
+    TEST_CHECK(s_sensor.overruns > 0);
+
+    // The stream resumes once the bus is free: 800 samples in 500 ms,
+    // give or take the block in flight at either end
+    s_hog.period = 0;
+    run_until(s_now + 40000000ULL);
+    uint32_t overruns = s_sensor.overruns;
+    uint32_t samples = s_rx.samples;
+    run_until(s_now + 500000000ULL);
+    TEST_CHECK(s_sensor.overruns == overruns);
+    TEST_CHECK(s_rx.samples - samples >= 800 - 16 && s_rx.samples - samples <= 800 + 16);
+
+    lis3dsh_stats_t stats;
+    settle(accel, &stats);
+    stop(&accel);
+}
+
+static void test_bypass(void) {
+    lis3dsh_handle_t accel = start(LIS3DSH_ODR_400_HZ, 0);
+    TEST_CHECK(accel != NULL);
+    if (accel == NULL) {
+        return;
+    }
+    TEST_CHECK(s_sensor.reg[LIS3DSH_REG_CTRL_REG4] & LIS3DSH_CTRL_REG4_BDU);
+    TEST_CHECK(s_sensor.reg[LIS3DSH_REG_CTRL_REG3] & LIS3DSH_CTRL_REG3_DR_EN);
+    TEST_CHECK(!(s_sensor.reg[LIS3DSH_REG_CTRL_REG6] & LIS3DSH_CTRL_REG6_FIFO_EN));
+    TEST_CHECK((s_sensor.reg[LIS3DSH_REG_FIFO_CTRL] >> LIS3DSH_FIFO_CTRL_FMODE_SHIFT) == LIS3DSH_FIFO_MODE_BYPASS);
+    run_until(1000000000ULL);
+
+    lis3dsh_stats_t stats;
+    settle(accel, &stats);
+    TEST_CHECK(s_sensor.produced == 400);
+    TEST_CHECK(s_rx.samples == 400);
+    TEST_CHECK(stats.drains == 400 && stats.back_to_back == 0);
+    TEST_CHECK(s_sensor.overruns == 0);
+    stop(&accel);
+}
+
+int main(void) {
+    record_motion();
+
+    test_configuration();
+    test_quiet_bus();
+    test_shared_bus();
+    test_overrun();
+    test_bypass();
+
+    return TEST_EXIT();
+}
@@ -7,17 +7,24 @@
 #define RCC_PRIVATE_H
 
 #include "rcc.h"
+#include "rcc_config.h"
 #include "port/rcc_port.h"
 
+/** @brief A registered clock change listener. */
+typedef struct {
+    rcc_clock_listener_t listener;   // NULL when the slot is free
+    void* p_context;
+} rcc_listener_entry_t;
+
 /**
  * @brief Internal state for the RCC driver.
- * @details Stores the calculated bus frequencies after initialization.
+ * @details Stores the bus frequencies after initialization, or as read
+ *          from the hardware on first use.
  */
 typedef struct {
     bool is_initialized;
-    uint32_t ahb_frequency;
-    uint32_t apb1_frequency;
-    uint32_t apb2_frequency;
+    rcc_clocks_t clocks;
+    rcc_listener_entry_t listeners[RCC_MAX_CLOCK_LISTENERS];
 } rcc_context_t;
 
 #endif // RCC_PRIVATE_H
@@ -46,6 +46,9 @@ typedef struct {
          uint32_t RESERVED5[1];
     __IO uint32_t BDCR;       /*!< Offset: 0x70, Backup Domain control register */
     __IO uint32_t CSR;        /*!< Offset: 0x74, Clock control and status register */
+         uint32_t RESERVED6[2];
+    __IO uint32_t SSCGR;      /*!< Offset: 0x80, Spread spectrum clock generation register */
+    __IO uint32_t PLLI2SCFGR; /*!< Offset: 0x84, PLLI2S configuration register */
 } rcc_reg_map_t;
 
 /* --- Register Bit Field Definitions --- */
@@ -62,10 +65,38 @@ typedef struct {
 #define RCC_CR_PLLON_Msk        (1UL << RCC_CR_PLLON_Pos)
 #define RCC_CR_PLLRDY_Pos       (25U)
 #define RCC_CR_PLLRDY_Msk       (1UL << RCC_CR_PLLRDY_Pos)
+#define RCC_CR_PLLI2SON_Pos     (26U)
+#define RCC_CR_PLLI2SON_Msk     (1UL << RCC_CR_PLLI2SON_Pos)
+#define RCC_CR_PLLI2SRDY_Pos    (27U)
+#define RCC_CR_PLLI2SRDY_Msk    (1UL << RCC_CR_PLLI2SRDY_Pos)
+
+#define RCC_PLLCFGR_PLLM_Pos    (0U)
+#define RCC_PLLCFGR_PLLM_Msk    (0x3FUL << RCC_PLLCFGR_PLLM_Pos)
+#define RCC_PLLCFGR_PLLN_Pos    (6U)
+#define RCC_PLLCFGR_PLLN_Msk    (0x1FFUL << RCC_PLLCFGR_PLLN_Pos)
+#define RCC_PLLCFGR_PLLP_Pos    (16U)
+#define RCC_PLLCFGR_PLLP_Msk    (3UL << RCC_PLLCFGR_PLLP_Pos)
+#define RCC_PLLCFGR_PLLSRC_Pos  (22U)
+#define RCC_PLLCFGR_PLLSRC_Msk  (1UL << RCC_PLLCFGR_PLLSRC_Pos)
+#define RCC_PLLCFGR_PLLQ_Pos    (24U)
+#define RCC_PLLCFGR_PLLQ_Msk    (0xFUL << RCC_PLLCFGR_PLLQ_Pos)
 
 #define RCC_CFGR_SW_Pos         (0U)
 #define RCC_CFGR_SW_Msk         (3UL << RCC_CFGR_SW_Pos)
 #define RCC_CFGR_SWS_Pos        (2U)
 #define RCC_CFGR_SWS_Msk        (3UL << RCC_CFGR_SWS_Pos)
+#define RCC_CFGR_HPRE_Pos       (4U)
+#define RCC_CFGR_HPRE_Msk       (0xFUL << RCC_CFGR_HPRE_Pos)
+#define RCC_CFGR_PPRE1_Pos      (10U)
+#define RCC_CFGR_PPRE1_Msk      (7UL << RCC_CFGR_PPRE1_Pos)
+#define RCC_CFGR_PPRE2_Pos      (13U)
+#define RCC_CFGR_PPRE2_Msk      (7UL << RCC_CFGR_PPRE2_Pos)
+#define RCC_CFGR_I2SSRC_Pos     (23U)
+#define RCC_CFGR_I2SSRC_Msk     (1UL << RCC_CFGR_I2SSRC_Pos)
+
+#define RCC_PLLI2SCFGR_PLLI2SN_Pos  (6U)
+#define RCC_PLLI2SCFGR_PLLI2SN_Msk  (0x1FFUL << RCC_PLLI2SCFGR_PLLI2SN_Pos)
+#define RCC_PLLI2SCFGR_PLLI2SR_Pos  (28U)
+#define RCC_PLLI2SCFGR_PLLI2SR_Msk  (7UL << RCC_PLLI2SCFGR_PLLI2SR_Pos)
 
 #endif // RCC_REG_H
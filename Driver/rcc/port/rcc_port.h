@@ -8,13 +8,6 @@
 
 #include "rcc.h"
 
-/** @brief Structure to hold calculated bus frequencies. */
-typedef struct {
-    uint32_t ahb_frequency;
-    uint32_t apb1_frequency;
-    uint32_t apb2_frequency;
-} rcc_bus_frequencies_t;
-
 /* --- Functions to be provided by the concrete port implementation --- */
 
 /**
@@ -27,7 +20,39 @@ typedef struct {
  *
  * @return true on success, false on failure.
  */
-bool rcc_port_system_init(rcc_clock_source_t clk_source, uint32_t external_crystal_hz, rcc_sysclk_freq_t sysclk_freq, rcc_bus_frequencies_t* out_frequencies);
+bool rcc_port_system_init(rcc_clock_source_t clk_source, uint32_t external_crystal_hz, rcc_sysclk_freq_t sysclk_freq, rcc_clocks_t* out_frequencies);
+
+/**
+ * @brief Platform-specific function to reprogram the main PLL and bus dividers.
+ * @details Called with the flash wait states already valid for both the old
+ *          and the new frequency.
+ *
+ * @param[in] sysclk_freq The target system clock frequency.
+ * @param[out] out_frequencies The resulting frequencies.
+ *
+ * @return true on success, false if the frequency is not supported or the
+ *         PLL did not lock (the previous configuration is then restored).
+ */
+bool rcc_port_set_sysclk(rcc_sysclk_freq_t sysclk_freq, rcc_clocks_t* out_frequencies);
+
+/**
+ * @brief Platform-specific function to compute the frequencies a change to
+ *        `sysclk_freq` would give, without touching the hardware.
+ * @return true if the frequency is supported.
+ */
+bool rcc_port_plan_sysclk(rcc_sysclk_freq_t sysclk_freq, rcc_clocks_t* out_frequencies);
+
+/** @brief Platform-specific function to read the current frequencies from the hardware. */
+void rcc_port_read_clocks(rcc_clocks_t* out_frequencies);
+
+/** @brief Platform-specific function to mask all maskable interrupts; returns the previous state. */
+uint32_t rcc_port_irq_lock(void);
+
+/** @brief Platform-specific function to restore the state saved by rcc_port_irq_lock(). */
+void rcc_port_irq_unlock(uint32_t state);
+
+/** @brief Platform-specific function to restart the oscillator and main PLL after STOP mode. */
+void rcc_port_restore_clocks(void);
 
 /**
  * @brief Platform-specific function to enable a peripheral's clock.
@@ -41,4 +66,21 @@ void rcc_port_enable_peripheral_clock(peripheral_id_t id);
  */
 void rcc_port_disable_peripheral_clock(peripheral_id_t id);
 
+/**
+ * @brief Platform-specific function to program and start the PLLI2S.
+ * @param[in] plli2sn The VCO multiplication factor.
+ * @param[in] plli2sr The output division factor.
+ * @return true once the PLL has locked, false if the factors are out of range.
+ */
+bool rcc_port_configure_plli2s(uint32_t plli2sn, uint32_t plli2sr);
+
+/** @brief Platform-specific function to check PLLI2S factors against the hardware limits. */
+bool rcc_port_is_plli2s_valid(uint32_t plli2sn, uint32_t plli2sr);
+
+/** @brief Platform-specific function to read the PLL input frequency after PLLM. */
+uint32_t rcc_port_get_pll_input_frequency(void);
+
+/** @brief Platform-specific function to read the PLLI2S output frequency, 0 if it is off. */
+uint32_t rcc_port_get_plli2s_frequency(void);
+
 #endif // RCC_PORT_H
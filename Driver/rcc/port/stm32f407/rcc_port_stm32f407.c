@@ -4,6 +4,7 @@
  */
 #include "internal/rcc_private.h"
 #include "internal/rcc_reg.h"
+#include <stddef.h>
 
 /* --- Base Addresses & Register Pointers --- */
 #define PERIPH_BASE           (0x40000000UL)
@@ -11,113 +12,419 @@
 #define RCC_BASE              (AHB1PERIPH_BASE + 0x3800UL)
 #define RCC                   ((rcc_reg_map_t *)RCC_BASE)
 
-// Flash ACR for setting latency
+// Flash ACR for setting latency and the ART accelerator
 #define FLASH_R_BASE          (AHB1PERIPH_BASE + 0x3C00UL)
 #define FLASH_ACR             (*((__IO uint32_t *)FLASH_R_BASE))
+#define FLASH_ACR_LATENCY_Msk (0xFUL << 0)
+#define FLASH_ACR_PRFTEN      (1UL << 8)
+#define FLASH_ACR_ICEN        (1UL << 9)
+#define FLASH_ACR_DCEN        (1UL << 10)
+#define FLASH_ACR_ICRST       (1UL << 11)
+#define FLASH_ACR_DCRST       (1UL << 12)
 
-// Stores configured clock frequencies
-static rcc_sysclk_config_t s_clk_config = {0};
+// One flash wait state per 30 MHz of HCLK at 2.7-3.6 V (RM0090 Table 10)
+#define FLASH_HZ_PER_WAIT_STATE 30000000UL
+
+// PLL input oscillators. The STM32F4-Discovery fits an 8 MHz crystal.
+#define HSI_HZ                16000000UL
+#ifndef RCC_HSE_HZ
+#define RCC_HSE_HZ            8000000UL
+#endif
+
+// Main PLL and bus limits (DS8626): VCO output 100..432 MHz, the 48 MHz
+// domain (USB OTG FS, SDIO, RNG) from PLLQ 2..15
+#define SYSCLK_MAX_HZ         168000000UL
+#define APB1_MAX_HZ           42000000UL
+#define APB2_MAX_HZ           84000000UL
+#define PLL_VCO_MIN_HZ        100000000UL
+#define PLL_VCO_MAX_HZ        432000000UL
+#define PLLN_MIN              50U
+#define PLLN_MAX              432U
+#define PLLQ_MIN              2U
+#define PLLQ_MAX              15U
+#define PLL48_HZ              48000000UL
+#define PLL_LOCK_TIMEOUT      100000UL
+
+// SW/SWS values
+#define SYSCLK_SOURCE_HSI     0U
+#define SYSCLK_SOURCE_HSE     1U
+#define SYSCLK_SOURCE_PLL     2U
+
+// PLLI2S limits (DS8626): VCO output 100..432 MHz, I2SxCLK at most 192 MHz
+#define PLLI2SN_MIN           50U
+#define PLLI2SN_MAX           432U
+#define PLLI2SR_MIN           2U
+#define PLLI2SR_MAX           7U
+#define PLLI2S_VCO_MIN_HZ     100000000UL
+#define PLLI2S_VCO_MAX_HZ     432000000UL
+#define PLLI2S_OUT_MAX_HZ     192000000UL
+#define PLLI2S_LOCK_TIMEOUT   100000UL
+
+/** @brief PLL factors and bus dividers for one system clock frequency. */
+typedef struct {
+    uint32_t plln;
+    uint32_t pllp;            // 2, 4, 6 or 8
+    uint32_t pllq;
+    uint32_t ppre1;           // APB1 divider: 1, 2, 4, 8 or 16
+    uint32_t ppre2;           // APB2 divider
+    rcc_clocks_t clocks;
+} sysclk_plan_t;
 
 /* --- Private Port Functions --- */
 
-static int stm32f4_sysclk_init(const rcc_sysclk_config_t* config) {
-    // 1. Enable HSE and wait for it to be ready
-    RCC->CR |= RCC_CR_HSEON_Msk;
-    while (!(RCC->CR & RCC_CR_HSERDY_Msk));
-
-    // 2. Configure AHB, APB1, APB2 prescalers
-    // AHB Prescaler = 1 (Max 168MHz)
-    RCC->CFGR &= ~RCC_CFGR_HPRE_Msk;
-    // APB1 Prescaler = 4 (Max 42MHz)
-    RCC->CFGR |= (0b101 << RCC_CFGR_PPRE1_Pos);
-    // APB2 Prescaler = 2 (Max 84MHz)
-    RCC->CFGR |= (0b100 << RCC_CFGR_PPRE2_Pos);
-
-    // 3. Configure the main PLL
-    // Source must be HSE, desired PLL VCO output is SYSCLK * PLLP
-    // PLL VCO input frequency should be between 1 and 2 MHz. We aim for 1 MHz.
-    uint32_t pllm = config->hse_hz / 1000000;
-    uint32_t pllp_val = 2; // Fixed PLLP = 2 for max SYSCLK
-    uint32_t plln = (config->sysclk_hz * pllp_val) / (config->hse_hz / pllm);
-
-    // PLLP bits are encoded: 00=/2, 01=/4, 10=/6, 11=/8
-    uint32_t pllp_bits = (pllp_val / 2) - 1;
+/** @brief Encodes an APB divider as CFGR PPREx bits: 0xx = /1, 100 = /2 ... 111 = /16. */
+static uint32_t ppre_bits(uint32_t divider) {
+    uint32_t bits = 0;
+    while (divider > 1) {
+        divider >>= 1;
+        bits = (bits == 0) ? 4 : bits + 1;
+    }
+    return bits;
+}
+
+static uint32_t ppre_divider(uint32_t bits) {
+    return (bits < 4) ? 1 : (1UL << (bits - 3));
+}
+
+static uint32_t hpre_divider(uint32_t bits) {
+    static const uint32_t dividers[8] = {2, 4, 8, 16, 64, 128, 256, 512};
+    return (bits < 8) ? 1 : dividers[bits - 8];
+}
+
+/** @brief Smallest power-of-two APB divider that keeps the bus within `max_hz`. */
+static uint32_t apb_divider(uint32_t ahb_hz, uint32_t max_hz) {
+    uint32_t divider = 1;
+    while (divider < 16 && ahb_hz / divider > max_hz) {
+        divider <<= 1;
+    }
+    return divider;
+}
+
+static void fill_bus_clocks(rcc_clocks_t* clocks, uint32_t sysclk_hz, uint32_t hpre, uint32_t ppre1, uint32_t ppre2) {
+    clocks->sysclk_hz = sysclk_hz;
+    clocks->ahb_hz = sysclk_hz / hpre;
+    clocks->apb1_hz = clocks->ahb_hz / ppre1;
+    clocks->apb2_hz = clocks->ahb_hz / ppre2;
+    // A divided APB clocks its timers at twice the bus rate
+    clocks->apb1_timer_hz = (ppre1 == 1) ? clocks->apb1_hz : clocks->apb1_hz * 2;
+    clocks->apb2_timer_hz = (ppre2 == 1) ? clocks->apb2_hz : clocks->apb2_hz * 2;
+}
+
+/**
+ * @brief Finds PLL factors for a system clock from a given VCO input.
+ * @details Prefers the smallest PLLP whose VCO frequency also gives exactly
+ *          48 MHz on PLLQ, so USB and SDIO keep working at every frequency.
+ */
+static bool plan_sysclk(uint32_t pll_input_hz, rcc_sysclk_freq_t sysclk_freq, sysclk_plan_t* plan) {
+    uint32_t sysclk_hz = rcc_sysclk_freq_to_hz(sysclk_freq);
+    if (sysclk_hz == 0 || sysclk_hz > SYSCLK_MAX_HZ || pll_input_hz == 0) {
+        return false;
+    }
+
+    bool found = false;
+    for (uint32_t pllp = 2; pllp <= 8; pllp += 2) {
+        uint32_t vco_hz = sysclk_hz * pllp;
+        uint32_t plln = vco_hz / pll_input_hz;
+        if (vco_hz < PLL_VCO_MIN_HZ || vco_hz > PLL_VCO_MAX_HZ || vco_hz % pll_input_hz != 0 ||
+            plln < PLLN_MIN || plln > PLLN_MAX) {
+            continue;
+        }
+        // Round PLLQ up: the 48 MHz domain must never run fast
+        uint32_t pllq = (vco_hz + PLL48_HZ - 1) / PLL48_HZ;
+        if (pllq < PLLQ_MIN || pllq > PLLQ_MAX) {
+            continue;
+        }
+        if (!found || vco_hz % PLL48_HZ == 0) {
+            plan->plln = plln;
+            plan->pllp = pllp;
+            plan->pllq = pllq;
+            found = true;
+        }
+        if (vco_hz % PLL48_HZ == 0) {
+            break;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    plan->ppre1 = apb_divider(sysclk_hz, APB1_MAX_HZ);
+    plan->ppre2 = apb_divider(sysclk_hz, APB2_MAX_HZ);
+    fill_bus_clocks(&plan->clocks, sysclk_hz, 1, plan->ppre1, plan->ppre2);
+    return true;
+}
+
+static void select_sysclk_source(uint32_t source) {
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW_Msk) | (source << RCC_CFGR_SW_Pos);
+    while (((RCC->CFGR & RCC_CFGR_SWS_Msk) >> RCC_CFGR_SWS_Pos) != source);
+}
+
+static bool wait_pll_lock(void) {
+    for (uint32_t i = 0; i < PLL_LOCK_TIMEOUT; ++i) {
+        if (RCC->CR & RCC_CR_PLLRDY_Msk) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Reprograms the main PLL and bus dividers and switches to the PLL.
+ * @details The core runs from the PLL's own oscillator meanwhile. Only the
+ *          main PLL stops; the PLLI2S shares nothing but PLLM and the
+ *          oscillator, which are both kept.
+ */
+static bool apply_plan(const sysclk_plan_t* plan, uint32_t pllm, bool use_hse) {
+    uint32_t old_pllcfgr = RCC->PLLCFGR;
+    uint32_t old_cfgr = RCC->CFGR;
+
+    select_sysclk_source(use_hse ? SYSCLK_SOURCE_HSE : SYSCLK_SOURCE_HSI);
+    RCC->CR &= ~RCC_CR_PLLON_Msk;
+    while (RCC->CR & RCC_CR_PLLRDY_Msk);
 
     RCC->PLLCFGR = (pllm << RCC_PLLCFGR_PLLM_Pos) |
-                   (plln << RCC_PLLCFGR_PLLN_Pos) |
-                   (pllp_bits << RCC_PLLCFGR_PLLP_Pos) |
-                   RCC_PLLCFGR_PLLSRC_Msk; // Source HSE
+                   (plan->plln << RCC_PLLCFGR_PLLN_Pos) |
+                   (((plan->pllp / 2) - 1) << RCC_PLLCFGR_PLLP_Pos) | // 00=/2, 01=/4, 10=/6, 11=/8
+                   (plan->pllq << RCC_PLLCFGR_PLLQ_Pos) |
+                   (use_hse ? RCC_PLLCFGR_PLLSRC_Msk : 0);
+    RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE_Msk | RCC_CFGR_PPRE1_Msk | RCC_CFGR_PPRE2_Msk)) |
+                (ppre_bits(plan->ppre1) << RCC_CFGR_PPRE1_Pos) |
+                (ppre_bits(plan->ppre2) << RCC_CFGR_PPRE2_Pos);
 
-    // 4. Enable the PLL and wait for it to be ready
     RCC->CR |= RCC_CR_PLLON_Msk;
-    while (!(RCC->CR & RCC_CR_PLLRDY_Msk));
+    bool locked = wait_pll_lock();
+    if (!locked) {
+        // Bring the previous configuration back
+        RCC->CR &= ~RCC_CR_PLLON_Msk;
+        while (RCC->CR & RCC_CR_PLLRDY_Msk);
+        RCC->PLLCFGR = old_pllcfgr;
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE_Msk | RCC_CFGR_PPRE1_Msk | RCC_CFGR_PPRE2_Msk)) |
+                    (old_cfgr & (RCC_CFGR_HPRE_Msk | RCC_CFGR_PPRE1_Msk | RCC_CFGR_PPRE2_Msk));
+        RCC->CR |= RCC_CR_PLLON_Msk;
+        if (!wait_pll_lock()) {
+            return false; // Left running on the oscillator
+        }
+    }
+    select_sysclk_source(SYSCLK_SOURCE_PLL);
+    return locked;
+}
+
+bool rcc_port_system_init(rcc_clock_source_t clk_source, uint32_t external_crystal_hz, rcc_sysclk_freq_t sysclk_freq, rcc_clocks_t* out_frequencies) {
+    bool use_hse = (clk_source == RCC_CLOCK_SOURCE_EXTERNAL);
+    uint32_t source_hz = use_hse ? external_crystal_hz : HSI_HZ;
 
-    // 5. Configure Flash latency before switching to a higher clock
-    // For VCORE=1.2V (default), up to 168MHz needs 5 wait states
-    FLASH_ACR |= 5;
+    // 1. Start the oscillator and wait for it to be ready
+    if (use_hse) {
+        RCC->CR |= RCC_CR_HSEON_Msk;
+        while (!(RCC->CR & RCC_CR_HSERDY_Msk));
+    } else {
+        RCC->CR |= RCC_CR_HSION_Msk;
+        while (!(RCC->CR & RCC_CR_HSIRDY_Msk));
+    }
+
+    // 2. PLL VCO input frequency should be between 1 and 2 MHz. We aim for 1 MHz.
+    uint32_t pllm = source_hz / 1000000;
+    sysclk_plan_t plan;
+    if (pllm < 2 || pllm > 63 || !plan_sysclk(source_hz / pllm, sysclk_freq, &plan)) {
+        return false;
+    }
+
+    // 3. Configure Flash latency before switching to a higher clock. The ART
+    // accelerator hides it: its caches are reset while off, then prefetch
+    // and both caches are enabled.
+    uint32_t wait_states = (plan.clocks.ahb_hz - 1) / FLASH_HZ_PER_WAIT_STATE;
+    FLASH_ACR = (FLASH_ACR & ~FLASH_ACR_LATENCY_Msk) | wait_states;
+    FLASH_ACR &= ~(FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+    FLASH_ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH_ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+    FLASH_ACR |= FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+
+    // 4. Program the PLL and bus dividers, then select the PLL
+    if (!apply_plan(&plan, pllm, use_hse)) {
+        return false;
+    }
+    *out_frequencies = plan.clocks;
+    return true;
+}
+
+bool rcc_port_plan_sysclk(rcc_sysclk_freq_t sysclk_freq, rcc_clocks_t* out_frequencies) {
+    sysclk_plan_t plan;
+    if (!plan_sysclk(rcc_port_get_pll_input_frequency(), sysclk_freq, &plan)) {
+        return false;
+    }
+    *out_frequencies = plan.clocks;
+    return true;
+}
+
+bool rcc_port_set_sysclk(rcc_sysclk_freq_t sysclk_freq, rcc_clocks_t* out_frequencies) {
+    sysclk_plan_t plan;
+    uint32_t pllcfgr = RCC->PLLCFGR;
+    if (!plan_sysclk(rcc_port_get_pll_input_frequency(), sysclk_freq, &plan)) {
+        return false;
+    }
+
+    uint32_t pllm = (pllcfgr & RCC_PLLCFGR_PLLM_Msk) >> RCC_PLLCFGR_PLLM_Pos;
+    bool is_applied = apply_plan(&plan, pllm, (pllcfgr & RCC_PLLCFGR_PLLSRC_Msk) != 0);
+    rcc_port_read_clocks(out_frequencies);
+    return is_applied;
+}
+
+void rcc_port_read_clocks(rcc_clocks_t* out_frequencies) {
+    uint32_t cfgr = RCC->CFGR;
+    uint32_t pllcfgr = RCC->PLLCFGR;
+    uint32_t sysclk_hz;
+
+    switch ((cfgr & RCC_CFGR_SWS_Msk) >> RCC_CFGR_SWS_Pos) {
+        case SYSCLK_SOURCE_HSE:
+            sysclk_hz = RCC_HSE_HZ;
+            break;
+        case SYSCLK_SOURCE_PLL: {
+            uint32_t plln = (pllcfgr & RCC_PLLCFGR_PLLN_Msk) >> RCC_PLLCFGR_PLLN_Pos;
+            uint32_t pllp = ((((pllcfgr & RCC_PLLCFGR_PLLP_Msk) >> RCC_PLLCFGR_PLLP_Pos) + 1) * 2);
+            sysclk_hz = (uint32_t)(((uint64_t)rcc_port_get_pll_input_frequency() * plln) / pllp);
+            break;
+        }
+        default:
+            sysclk_hz = HSI_HZ;
+            break;
+    }
+
+    fill_bus_clocks(out_frequencies, sysclk_hz,
+                    hpre_divider((cfgr & RCC_CFGR_HPRE_Msk) >> RCC_CFGR_HPRE_Pos),
+                    ppre_divider((cfgr & RCC_CFGR_PPRE1_Msk) >> RCC_CFGR_PPRE1_Pos),
+                    ppre_divider((cfgr & RCC_CFGR_PPRE2_Msk) >> RCC_CFGR_PPRE2_Pos));
+}
 
-    // 6. Select the PLL as the system clock source
-    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW_Msk) | (0b10 << RCC_CFGR_SW_Pos);
-    while (((RCC->CFGR & RCC_CFGR_SWS_Msk) >> RCC_CFGR_SWS_Pos) != 0b10);
+uint32_t rcc_port_irq_lock(void) {
+    uint32_t primask = 0;
+#if defined(__arm__)
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+#endif
+    return primask;     // Host builds (register-fake tests) have no interrupts to mask
+}
+
+void rcc_port_irq_unlock(uint32_t state) {
+#if defined(__arm__)
+    __asm volatile ("msr primask, %0" :: "r" (state) : "memory");
+#else
+    (void)state;
+#endif
+}
 
-    // Store configuration for later use
-    s_clk_config = *config;
-    return 0;
+void rcc_port_restore_clocks(void) {
+    // STOP keeps PLLCFGR and the bus dividers, and the flash latency
+    if (RCC->PLLCFGR & RCC_PLLCFGR_PLLSRC_Msk) {
+        RCC->CR |= RCC_CR_HSEON_Msk;
+        while (!(RCC->CR & RCC_CR_HSERDY_Msk));
+    }
+    RCC->CR |= RCC_CR_PLLON_Msk;
+    while (!(RCC->CR & RCC_CR_PLLRDY_Msk));
+    select_sysclk_source(SYSCLK_SOURCE_PLL);
 }
 
-static void stm32f4_periph_clock_enable(rcc_periph_t periph) {
-    switch (periph) {
+/**
+ * @brief Maps a peripheral to its clock enable register and bit.
+ * @return The bit mask, or 0 if the peripheral is unknown.
+ */
+static uint32_t periph_enable_bit(peripheral_id_t id, __IO uint32_t** pp_reg) {
+    switch (id) {
         // AHB1
-        case RCC_PERIPH_GPIOA: RCC->AHB1ENR |= (1 << 0); break;
-        case RCC_PERIPH_GPIOB: RCC->AHB1ENR |= (1 << 1); break;
-        case RCC_PERIPH_GPIOC: RCC->AHB1ENR |= (1 << 2); break;
-        case RCC_PERIPH_GPIOD: RCC->AHB1ENR |= (1 << 3); break;
+        case PERIPH_ID_GPIOA:  *pp_reg = &RCC->AHB1ENR; return 1UL << 0;
+        case PERIPH_ID_GPIOB:  *pp_reg = &RCC->AHB1ENR; return 1UL << 1;
+        case PERIPH_ID_GPIOC:  *pp_reg = &RCC->AHB1ENR; return 1UL << 2;
+        case PERIPH_ID_CRC:    *pp_reg = &RCC->AHB1ENR; return 1UL << 12;
+        case PERIPH_ID_DMA1:   *pp_reg = &RCC->AHB1ENR; return 1UL << 21;
+        case PERIPH_ID_DMA2:   *pp_reg = &RCC->AHB1ENR; return 1UL << 22;
         // APB1
-        case RCC_PERIPH_TIM2:   RCC->APB1ENR |= (1 << 0); break;
-        case RCC_PERIPH_TIM3:   RCC->APB1ENR |= (1 << 1); break;
-        case RCC_PERIPH_TIM4:   RCC->APB1ENR |= (1 << 2); break;
-        case RCC_PERIPH_TIM5:   RCC->APB1ENR |= (1 << 3); break;
-        case RCC_PERIPH_SPI2:   RCC->APB1ENR |= (1 << 14); break;
-        case RCC_PERIPH_SPI3:   RCC->APB1ENR |= (1 << 15); break;
-        case RCC_PERIPH_USART2: RCC->APB1ENR |= (1 << 17); break;
-        case RCC_PERIPH_I2C1:   RCC->APB1ENR |= (1 << 21); break;
-        case RCC_PERIPH_I2C2:   RCC->APB1ENR |= (1 << 22); break;
-        case RCC_PERIPH_I2C3:   RCC->APB1ENR |= (1 << 23); break;
+        case PERIPH_ID_TIM2:   *pp_reg = &RCC->APB1ENR; return 1UL << 0;
+        case PERIPH_ID_TIM3:   *pp_reg = &RCC->APB1ENR; return 1UL << 1;
+        case PERIPH_ID_TIM4:   *pp_reg = &RCC->APB1ENR; return 1UL << 2;
+        case PERIPH_ID_TIM5:   *pp_reg = &RCC->APB1ENR; return 1UL << 3;
+        case PERIPH_ID_WWDG:   *pp_reg = &RCC->APB1ENR; return 1UL << 11;
+        case PERIPH_ID_SPI2:   *pp_reg = &RCC->APB1ENR; return 1UL << 14;
+        case PERIPH_ID_SPI3:   *pp_reg = &RCC->APB1ENR; return 1UL << 15;
+        case PERIPH_ID_USART2: *pp_reg = &RCC->APB1ENR; return 1UL << 17;
+        case PERIPH_ID_I2C1:   *pp_reg = &RCC->APB1ENR; return 1UL << 21;
+        case PERIPH_ID_I2C2:   *pp_reg = &RCC->APB1ENR; return 1UL << 22;
+        case PERIPH_ID_I2C3:   *pp_reg = &RCC->APB1ENR; return 1UL << 23;
+        case PERIPH_ID_PWR:    *pp_reg = &RCC->APB1ENR; return 1UL << 28;
         // APB2
-        case RCC_PERIPH_SPI1:   RCC->APB2ENR |= (1 << 12); break;
-        case RCC_PERIPH_USART1: RCC->APB2ENR |= (1 << 4); break;
-        case RCC_PERIPH_USART6: RCC->APB2ENR |= (1 << 5); break;
+        case PERIPH_ID_TIM1:   *pp_reg = &RCC->APB2ENR; return 1UL << 0;
+        case PERIPH_ID_TIM8:   *pp_reg = &RCC->APB2ENR; return 1UL << 1;
+        case PERIPH_ID_USART1: *pp_reg = &RCC->APB2ENR; return 1UL << 4;
+        case PERIPH_ID_USART6: *pp_reg = &RCC->APB2ENR; return 1UL << 5;
+        case PERIPH_ID_ADC1:   *pp_reg = &RCC->APB2ENR; return 1UL << 8;
+        case PERIPH_ID_SDIO:   *pp_reg = &RCC->APB2ENR; return 1UL << 11;
+        case PERIPH_ID_SPI1:   *pp_reg = &RCC->APB2ENR; return 1UL << 12;
+        case PERIPH_ID_SYSCFG: *pp_reg = &RCC->APB2ENR; return 1UL << 14;
+        default: return 0;
     }
 }
 
-static void stm32f4_periph_clock_disable(rcc_periph_t periph) {
-    // Similar to enable, but with &= ~
+void rcc_port_enable_peripheral_clock(peripheral_id_t id) {
+    __IO uint32_t* p_reg = NULL;
+    uint32_t bit = periph_enable_bit(id, &p_reg);
+    if (bit != 0) {
+        *p_reg |= bit;
+    }
 }
 
-static uint32_t stm32f4_get_ahb_clk_freq(void) {
-    // For this simple driver, we assume AHB prescaler is 1
-    return s_clk_config.sysclk_hz;
+void rcc_port_disable_peripheral_clock(peripheral_id_t id) {
+    __IO uint32_t* p_reg = NULL;
+    uint32_t bit = periph_enable_bit(id, &p_reg);
+    if (bit != 0) {
+        *p_reg &= ~bit;
+    }
 }
 
-static uint32_t stm32f4_get_apb1_clk_freq(void) {
-    // For this simple driver, we assume APB1 prescaler is 4
-    return s_clk_config.sysclk_hz / 4;
+// --- PLLI2S ---
+
+uint32_t rcc_port_get_pll_input_frequency(void) {
+    uint32_t pllcfgr = RCC->PLLCFGR;
+    uint32_t pllm = (pllcfgr & RCC_PLLCFGR_PLLM_Msk) >> RCC_PLLCFGR_PLLM_Pos;
+    uint32_t source_hz = (pllcfgr & RCC_PLLCFGR_PLLSRC_Msk) ? RCC_HSE_HZ : HSI_HZ;
+    return (pllm >= 2) ? source_hz / pllm : 0; // PLLM 0 and 1 are invalid
 }
 
-static uint32_t stm32f4_get_apb2_clk_freq(void) {
-    // For this simple driver, we assume APB2 prescaler is 2
-    return s_clk_config.sysclk_hz / 2;
+uint32_t rcc_port_get_plli2s_frequency(void) {
+    if (!(RCC->CR & RCC_CR_PLLI2SRDY_Msk)) {
+        return 0;
+    }
+    uint32_t cfgr = RCC->PLLI2SCFGR;
+    uint32_t plli2sn = (cfgr & RCC_PLLI2SCFGR_PLLI2SN_Msk) >> RCC_PLLI2SCFGR_PLLI2SN_Pos;
+    uint32_t plli2sr = (cfgr & RCC_PLLI2SCFGR_PLLI2SR_Msk) >> RCC_PLLI2SCFGR_PLLI2SR_Pos;
+    if (plli2sr < PLLI2SR_MIN) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)rcc_port_get_pll_input_frequency() * plli2sn) / plli2sr);
 }
 
-static const rcc_port_interface_t stm32f4_port_api = {
-    .sysclk_init = stm32f4_sysclk_init,
-    .periph_clock_enable = stm32f4_periph_clock_enable,
-    .periph_clock_disable = stm32f4_periph_clock_disable,
-    .get_ahb_clk_freq = stm32f4_get_ahb_clk_freq,
-    .get_apb1_clk_freq = stm32f4_get_apb1_clk_freq,
-    .get_apb2_clk_freq = stm32f4_get_apb2_clk_freq,
-};
+bool rcc_port_is_plli2s_valid(uint32_t plli2sn, uint32_t plli2sr) {
+    uint64_t vco_hz = (uint64_t)rcc_port_get_pll_input_frequency() * plli2sn;
+    return plli2sn >= PLLI2SN_MIN && plli2sn <= PLLI2SN_MAX &&
+           plli2sr >= PLLI2SR_MIN && plli2sr <= PLLI2SR_MAX &&
+           vco_hz >= PLLI2S_VCO_MIN_HZ && vco_hz <= PLLI2S_VCO_MAX_HZ &&
+           vco_hz / plli2sr <= PLLI2S_OUT_MAX_HZ;
+}
 
-const rcc_port_interface_t* rcc_port_get_api(void) {
-    return &stm32f4_port_api;
+bool rcc_port_configure_plli2s(uint32_t plli2sn, uint32_t plli2sr) {
+    if (!rcc_port_is_plli2s_valid(plli2sn, plli2sr)) {
+        return false;
+    }
+
+    // The factors may only be written while the PLL is off
+    RCC->CR &= ~RCC_CR_PLLI2SON_Msk;
+    while (RCC->CR & RCC_CR_PLLI2SRDY_Msk);
+
+    RCC->PLLI2SCFGR = (plli2sn << RCC_PLLI2SCFGR_PLLI2SN_Pos) |
+                      (plli2sr << RCC_PLLI2SCFGR_PLLI2SR_Pos);
+    RCC->CFGR &= ~RCC_CFGR_I2SSRC_Msk; // I2S clocked by the PLLI2S, not I2S_CKIN
+
+    RCC->CR |= RCC_CR_PLLI2SON_Msk;
+    for (uint32_t i = 0; i < PLLI2S_LOCK_TIMEOUT; ++i) {
+        if (RCC->CR & RCC_CR_PLLI2SRDY_Msk) {
+            return true;
+        }
+    }
+    return false;
 }
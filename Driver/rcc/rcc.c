@@ -4,20 +4,39 @@
  */
 
 #include "internal/rcc_private.h"
+#include <stddef.h>
 
 // --- Static Data ---
 static rcc_context_t s_rcc_context = {.is_initialized = false };
 
+// --- Private Helper Functions ---
+
+/** @brief Returns the clock tree, reading it from the hardware if no init ran. */
+static const rcc_clocks_t* current_clocks(void) {
+    if (!s_rcc_context.is_initialized) {
+        rcc_port_read_clocks(&s_rcc_context.clocks);
+        s_rcc_context.is_initialized = true;
+    }
+    return &s_rcc_context.clocks;
+}
+
+static void notify_listeners(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change) {
+    for (int i = 0; i < RCC_MAX_CLOCK_LISTENERS; ++i) {
+        rcc_listener_entry_t* entry = &s_rcc_context.listeners[i];
+        if (entry->listener != NULL) {
+            entry->listener(phase, p_change, entry->p_context);
+        }
+    }
+}
+
 // --- Public API Function Implementations ---
 
 bool rcc_system_init(rcc_clock_source_t clk_source, uint32_t external_crystal_hz, rcc_sysclk_freq_t sysclk_freq) {
-    rcc_bus_frequencies_t freqs;
+    rcc_clocks_t freqs;
     bool success = rcc_port_system_init(clk_source, external_crystal_hz, sysclk_freq, &freqs);
 
     if (success) {
-        s_rcc_context.ahb_frequency = freqs.ahb_frequency;
-        s_rcc_context.apb1_frequency = freqs.apb1_frequency;
-        s_rcc_context.apb2_frequency = freqs.apb2_frequency;
+        s_rcc_context.clocks = freqs;
         s_rcc_context.is_initialized = true;
     }
 
@@ -33,13 +52,123 @@ void rcc_disable_peripheral_clock(peripheral_id_t id) {
 }
 
 uint32_t rcc_get_ahb_frequency(void) {
-    return s_rcc_context.is_initialized? s_rcc_context.ahb_frequency : 0;
+    return current_clocks()->ahb_hz;
 }
 
 uint32_t rcc_get_apb1_frequency(void) {
-    return s_rcc_context.is_initialized? s_rcc_context.apb1_frequency : 0;
+    return current_clocks()->apb1_hz;
 }
 
 uint32_t rcc_get_apb2_frequency(void) {
-    return s_rcc_context.is_initialized? s_rcc_context.apb2_frequency : 0;
+    return current_clocks()->apb2_hz;
+}
+
+uint32_t rcc_get_sysclk_frequency(void) {
+    return current_clocks()->sysclk_hz;
+}
+
+uint32_t rcc_get_apb1_timer_frequency(void) {
+    return current_clocks()->apb1_timer_hz;
+}
+
+uint32_t rcc_get_apb2_timer_frequency(void) {
+    return current_clocks()->apb2_timer_hz;
+}
+
+void rcc_get_clocks(rcc_clocks_t* p_clocks) {
+    if (p_clocks != NULL) {
+        *p_clocks = *current_clocks();
+    }
+}
+
+uint32_t rcc_sysclk_freq_to_hz(rcc_sysclk_freq_t sysclk_freq) {
+    switch (sysclk_freq) {
+        case RCC_SYSCLK_FREQ_84_MHZ:  return 84000000UL;
+        case RCC_SYSCLK_FREQ_96_MHZ:  return 96000000UL;
+        case RCC_SYSCLK_FREQ_120_MHZ: return 120000000UL;
+        case RCC_SYSCLK_FREQ_168_MHZ: return 168000000UL;
+        case RCC_SYSCLK_FREQ_180_MHZ: return 180000000UL;
+        default: return 0;
+    }
+}
+
+int rcc_register_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    if (listener == NULL) {
+        return -1;
+    }
+
+    rcc_listener_entry_t* free_entry = NULL;
+    for (int i = 0; i < RCC_MAX_CLOCK_LISTENERS; ++i) {
+        rcc_listener_entry_t* entry = &s_rcc_context.listeners[i];
+        if (entry->listener == listener && entry->p_context == p_context) {
+            return 0;
+        }
+        if (entry->listener == NULL && free_entry == NULL) {
+            free_entry = entry;
+        }
+    }
+    if (free_entry == NULL) {
+        return -1;
+    }
+    free_entry->p_context = p_context;
+    free_entry->listener = listener;
+    return 0;
+}
+
+void rcc_unregister_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    for (int i = 0; i < RCC_MAX_CLOCK_LISTENERS; ++i) {
+        rcc_listener_entry_t* entry = &s_rcc_context.listeners[i];
+        if (entry->listener == listener && entry->p_context == p_context) {
+            entry->listener = NULL;
+            entry->p_context = NULL;
+        }
+    }
+}
+
+bool rcc_set_sysclk(rcc_sysclk_freq_t sysclk_freq) {
+    rcc_clock_change_t change;
+    change.from = *current_clocks();
+    if (!rcc_port_plan_sysclk(sysclk_freq, &change.to)) {
+        return false;
+    }
+    if (change.to.sysclk_hz == change.from.sysclk_hz) {
+        return true;
+    }
+
+    // Masked from PRE_CHANGE to POST_CHANGE: no interrupt hands work to a
+    // task while the core runs from the oscillator, and no peripheral is
+    // used between the switch and its listener's update
+    uint32_t state = rcc_port_irq_lock();
+    notify_listeners(RCC_CLOCK_PRE_CHANGE, &change);
+    bool is_changed = rcc_port_set_sysclk(sysclk_freq, &s_rcc_context.clocks);
+    if (is_changed) {
+        change.to = s_rcc_context.clocks;
+    } else {
+        // Back at `from`: let the listeners undo what PRE_CHANGE did
+        change.to = change.from;
+        s_rcc_context.clocks = change.from;
+    }
+    notify_listeners(RCC_CLOCK_POST_CHANGE, &change);
+    rcc_port_irq_unlock(state);
+    return is_changed;
+}
+
+void rcc_restore_clocks(void) {
+    rcc_port_restore_clocks();
+}
+
+bool rcc_configure_plli2s(uint32_t plli2sn, uint32_t plli2sr) {
+    return rcc_port_configure_plli2s(plli2sn, plli2sr);
+}
+
+bool rcc_is_plli2s_valid(uint32_t plli2sn, uint32_t plli2sr) {
+    return rcc_port_is_plli2s_valid(plli2sn, plli2sr);
+}
+
+uint32_t rcc_get_pll_input_frequency(void) {
+    return rcc_port_get_pll_input_frequency();
+}
+
+uint32_t rcc_get_plli2s_frequency(void) {
+    return rcc_port_get_plli2s_frequency();
 }
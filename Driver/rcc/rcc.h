@@ -26,6 +26,7 @@ typedef enum {
 typedef enum {
     RCC_SYSCLK_FREQ_84_MHZ,
     RCC_SYSCLK_FREQ_96_MHZ,
+    RCC_SYSCLK_FREQ_120_MHZ,
     RCC_SYSCLK_FREQ_168_MHZ,
     RCC_SYSCLK_FREQ_180_MHZ,
 } rcc_sysclk_freq_t;
@@ -56,6 +57,36 @@ typedef enum {
     PERIPH_ID_SYSCFG,
 } peripheral_id_t;
 
+/** @brief Frequencies of the clock tree, in Hz. */
+typedef struct {
+    uint32_t sysclk_hz;
+    uint32_t ahb_hz;            // HCLK, the core and DMA clock
+    uint32_t apb1_hz;           // PCLK1
+    uint32_t apb2_hz;           // PCLK2
+    uint32_t apb1_timer_hz;     // TIM2-5: PCLK1, or twice PCLK1 when APB1 is divided
+    uint32_t apb2_timer_hz;     // TIM1/8: PCLK2, or twice PCLK2 when APB2 is divided
+} rcc_clocks_t;
+
+/** @brief When a clock listener is called during rcc_set_sysclk(). */
+typedef enum {
+    RCC_CLOCK_PRE_CHANGE,       // Still running at `from`
+    RCC_CLOCK_POST_CHANGE,      // Already running at `to`
+} rcc_clock_phase_t;
+
+/** @brief The clock tree before and after a frequency change. */
+typedef struct {
+    rcc_clocks_t from;
+    rcc_clocks_t to;
+} rcc_clock_change_t;
+
+/**
+ * @brief Called around every system clock change.
+ * @details Called from the task that calls rcc_set_sysclk(), with interrupts
+ *          masked, so it must not block. A driver recomputes its dividers
+ *          from `p_change->to` in the POST_CHANGE call; flash wait states
+ *          must grow in PRE_CHANGE and shrink in POST_CHANGE.
+ */
+typedef void (*rcc_clock_listener_t)(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change, void* p_context);
 
 /* --- Public API Functions --- */
 
@@ -96,4 +127,99 @@ uint32_t rcc_get_apb1_frequency(void);
 /** @brief Gets the configured APB2 bus frequency (PCLK2). */
 uint32_t rcc_get_apb2_frequency(void);
 
+/** @brief Gets the configured system clock frequency (SYSCLK). */
+uint32_t rcc_get_sysclk_frequency(void);
+
+/** @brief Gets the input clock of the timers on APB1 (TIM2-5). */
+uint32_t rcc_get_apb1_timer_frequency(void);
+
+/** @brief Gets the input clock of the timers on APB2 (TIM1/8). */
+uint32_t rcc_get_apb2_timer_frequency(void);
+
+/**
+ * @brief Gets every frequency of the clock tree.
+ * @details If rcc_system_init() was not called (the clocks were set up by
+ *          startup code), the frequencies are read from the hardware once.
+ */
+void rcc_get_clocks(rcc_clocks_t* p_clocks);
+
+/** @brief Converts a standard frequency to Hz. */
+uint32_t rcc_sysclk_freq_to_hz(rcc_sysclk_freq_t sysclk_freq);
+
+/* --- Runtime Frequency Scaling --- */
+
+/**
+ * @brief Registers a function called around every system clock change.
+ * @details Registering the same function and context again does nothing.
+ *
+ * @param[in] listener The function.
+ * @param[in] p_context Passed back to the function, e.g. a driver handle.
+ *
+ * @return 0 on success, -1 if the table (RCC_MAX_CLOCK_LISTENERS) is full.
+ */
+int rcc_register_clock_listener(rcc_clock_listener_t listener, void* p_context);
+
+/** @brief Removes a function registered with rcc_register_clock_listener(). */
+void rcc_unregister_clock_listener(rcc_clock_listener_t listener, void* p_context);
+
+/**
+ * @brief Changes the system clock at runtime.
+ *
+ * @details The main PLL is reprogrammed while the core runs from its input
+ *          oscillator; PLLM is kept, so the PLLI2S and the audio clocks run
+ *          on undisturbed. The AHB is undivided, APB1 and APB2 get the
+ *          smallest dividers that keep them within 42 and 84 MHz. Listeners
+ *          are called with PRE_CHANGE before and POST_CHANGE after; the core
+ *          runs at the oscillator rate for the PLL lock time in between.
+ *          All maskable interrupts stay masked from the first listener call
+ *          to the last, typically a few hundred microseconds: no ISR wakes a
+ *          task at the oscillator rate. DMA transfers carry on meanwhile.
+ *
+ * @warning Nothing in this driver touches the flash wait states: a listener
+ *          must (the FLASH driver registers one in flash_init()).
+ *
+ * @param[in] sysclk_freq The new system clock frequency.
+ *
+ * @return true on success or if already running at that frequency, false
+ *         if the frequency is not supported or the PLL did not lock (the
+ *         previous frequency is then restored).
+ */
+bool rcc_set_sysclk(rcc_sysclk_freq_t sysclk_freq);
+
+/**
+ * @brief Restarts the oscillator and the main PLL after STOP mode.
+ * @details STOP leaves the core on the HSI with the PLL off but keeps the
+ *          PLL factors and bus dividers, so this restores whatever frequency
+ *          rcc_set_sysclk() last selected. Listeners are not called.
+ */
+void rcc_restore_clocks(void);
+
+/**
+ * @brief Configures and starts the PLLI2S, the clock source of the I2S peripherals.
+ *
+ * @details The PLLI2S shares the input divider (PLLM) of the main PLL:
+ *          I2SxCLK = rcc_get_pll_input_frequency() * plli2sn / plli2sr.
+ *          The PLL is stopped while it is reprogrammed, so every running I2S
+ *          instance loses its clock meanwhile.
+ *
+ * @param[in] plli2sn The VCO multiplication factor.
+ * @param[in] plli2sr The output division factor.
+ *
+ * @return true on success, false if a factor or the resulting VCO frequency
+ *         is out of range, or the PLL did not lock.
+ */
+bool rcc_configure_plli2s(uint32_t plli2sn, uint32_t plli2sr);
+
+/**
+ * @brief Checks PLLI2S factors against the hardware limits for the current PLL input.
+ * @return true if rcc_configure_plli2s() would accept the factors.
+ */
+bool rcc_is_plli2s_valid(uint32_t plli2sn, uint32_t plli2sr);
+
+/** @brief Gets the PLL input frequency after the PLLM divider (the VCO input), read from the hardware. */
+uint32_t rcc_get_pll_input_frequency(void);
+
+/** @brief Gets the PLLI2S output frequency (I2SxCLK), or 0 if the PLLI2S is not running. */
+uint32_t rcc_get_plli2s_frequency(void);
+
 #endif // RCC_H
@@ -1,16 +1,17 @@
 /**
- * @file      uart_config.h
- * @brief     Compile-time configuration for the UART driver.
+ * @file      rcc_config.h
+ * @brief     Compile-time configuration for the RCC driver.
  */
 
-#ifndef UART_CONFIG_H
-#define UART_CONFIG_H
+#ifndef RCC_CONFIG_H
+#define RCC_CONFIG_H
 
 /**
- * @brief Defines the maximum number of UART instances the driver can manage.
- * @details This sets the size of the static handle pool. Adjust based on
- *          the number of UART peripherals you intend to use simultaneously.
+ * @brief Maximum number of clock change listeners.
+ * @details One per driver instance that derives a divider from a bus clock
+ *          (each UART, I2C and timer handle, the FLASH driver) plus the
+ *          application's own.
  */
-#define UART_MAX_INSTANCES 3
+#define RCC_MAX_CLOCK_LISTENERS 12
 
-#endif // UART_CONFIG_H
+#endif // RCC_CONFIG_H
@@ -0,0 +1,247 @@
+/**
+ * @file      test_rcc_clocks.c
+ * @brief     Host test of runtime system clock changes on the STM32F407 ports.
+ *
+ * @details   The RCC, FLASH, UART, I2C and timer drivers run unchanged on
+ *            their STM32F407 ports against a register fake. A trap on the
+ *            RCC page plays the clock hardware: each ready flag follows its
+ *            enable bit and SWS follows SW. When SWS switches to the PLL, the
+ *            trap also checks that the flash latency is already enough for
+ *            the new SYSCLK.
+ *
+ *            The clock is stepped through 168, 84, 120, 168, 120 and 84 MHz.
+ *            At each step, what the drivers programmed is compared with
+ *            values worked out by hand from RM0090 and the DS8626 limits:
+ *            - PLL factors and bus prescalers;
+ *            - flash wait states;
+ *            - USART1/2 BRR at 115200 baud;
+ *            - I2C1 FREQ/CCR/TRISE at 100 kHz;
+ *            - TIM5 PSC for a 1 MHz tick, keeping its count.
+ *            A frequency beyond the limits is refused with nothing changed,
+ *            and timer_deinit() gives back its listener slot.
+ */
+
+#include "rcc.h"
+#include "internal/rcc_reg.h"
+#include "rcc_config.h"
+#include "flash.h"
+#include "i2c.h"
+#include "timer.h"
+#include "uart.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+
+#define HSE_HZ                  8000000UL
+#define BAUD_RATE               115200UL
+
+// Register windows (RM0090, Table 1)
+#define APB1_WINDOW             0x40000000UL    // TIM2..5, USART2, I2C1
+#define APB2_WINDOW             0x40010000UL    // USART1
+#define AHB1_WINDOW             0x40020000UL    // GPIO, RCC, FLASH
+#define DMA_WINDOW              0x40026000UL
+#define NVIC_WINDOW             0xE000E000UL
+
+#define RCC_REGS                ((rcc_reg_map_t*)0x40023800UL)
+#define FLASH_ACR               (*(volatile uint32_t*)0x40023C00UL)
+#define TIM5_CNT                (*(volatile uint32_t*)0x40000C24UL)
+#define TIM5_PSC                (*(volatile uint32_t*)0x40000C28UL)
+#define TIM5_CR1                (*(volatile uint32_t*)0x40000C00UL)
+#define USART1_BRR              (*(volatile uint32_t*)0x40011008UL)
+#define USART2_BRR              (*(volatile uint32_t*)0x40004408UL)
+#define I2C1_CR2                (*(volatile uint32_t*)0x40005404UL)
+#define I2C1_CCR                (*(volatile uint32_t*)0x4000541CUL)
+#define I2C1_TRISE              (*(volatile uint32_t*)0x40005420UL)
+
+#define SW_PLL                  2U
+
+/**
+ * @brief One row of the expected configuration, worked out by hand.
+ */
+typedef struct {
+    rcc_sysclk_freq_t freq;
+    uint32_t mhz;
+    uint32_t plln, pllp, pllq;
+    uint32_t ppre1_bits, ppre2_bits;    // CFGR encoding: 0 = /1, 4 = /2, 5 = /4
+    uint32_t apb1_mhz, apb2_mhz;
+    uint32_t wait_states;               // One per 30 MHz of HCLK
+    uint32_t usart1_brr, usart2_brr;    // APB clock / 115200, rounded
+    uint32_t i2c_ccr, i2c_trise;        // APB1 / 200 kHz, APB1 in MHz + 1
+    uint32_t tim_psc;                   // APB1 timer clock / 1 MHz - 1
+} clock_row_t;
+
+static const clock_row_t s_rows[] = {
+    {RCC_SYSCLK_FREQ_168_MHZ, 168, 336, 2, 7, 5, 4, 42, 84, 5, 729, 365, 210, 43, 83},
+    {RCC_SYSCLK_FREQ_84_MHZ,   84, 336, 4, 7, 4, 0, 42, 84, 2, 729, 365, 210, 43, 83},
+    {RCC_SYSCLK_FREQ_120_MHZ, 120, 240, 2, 5, 5, 4, 30, 60, 3, 521, 260, 150, 31, 59},
+    {RCC_SYSCLK_FREQ_168_MHZ, 168, 336, 2, 7, 5, 4, 42, 84, 5, 729, 365, 210, 43, 83},
+    {RCC_SYSCLK_FREQ_120_MHZ, 120, 240, 2, 5, 5, 4, 30, 60, 3, 521, 260, 150, 31, 59},
+    {RCC_SYSCLK_FREQ_84_MHZ,   84, 336, 4, 7, 4, 0, 42, 84, 2, 729, 365, 210, 43, 83},
+};
+
+// --- Test Data ---
+static uint32_t s_pll_switches = 0;
+static uint32_t s_latency_too_low = 0;
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+static uint32_t field(uint32_t value, uint32_t mask, uint32_t pos) {
+    return (value & mask) >> pos;
+}
+
+/** @brief The clock hardware: runs before every access to the RCC page. */
+static void rcc_hook(uintptr_t address, bool is_write) {
+    (void)address;
+    (void)is_write;
+    rcc_reg_map_t* rcc = RCC_REGS;
+    uint32_t cr = rcc->CR;
+    uint32_t ready = 0;
+    ready |= (cr & RCC_CR_HSION_Msk) ? RCC_CR_HSIRDY_Msk : 0;
+    ready |= (cr & RCC_CR_HSEON_Msk) ? RCC_CR_HSERDY_Msk : 0;
+    ready |= (cr & RCC_CR_PLLON_Msk) ? RCC_CR_PLLRDY_Msk : 0;
+    ready |= (cr & RCC_CR_PLLI2SON_Msk) ? RCC_CR_PLLI2SRDY_Msk : 0;
+    rcc->CR = (cr & ~(RCC_CR_HSIRDY_Msk | RCC_CR_HSERDY_Msk | RCC_CR_PLLRDY_Msk | RCC_CR_PLLI2SRDY_Msk)) | ready;
+
+    uint32_t cfgr = rcc->CFGR;
+    uint32_t sw = field(cfgr, RCC_CFGR_SW_Msk, RCC_CFGR_SW_Pos);
+    if (sw != field(cfgr, RCC_CFGR_SWS_Msk, RCC_CFGR_SWS_Pos)) {
+        if (sw == SW_PLL) {
+            uint32_t pllcfgr = rcc->PLLCFGR;
+            uint32_t input_hz = HSE_HZ / field(pllcfgr, RCC_PLLCFGR_PLLM_Msk, RCC_PLLCFGR_PLLM_Pos);
+            uint32_t plln = field(pllcfgr, RCC_PLLCFGR_PLLN_Msk, RCC_PLLCFGR_PLLN_Pos);
+            uint32_t pllp = (field(pllcfgr, RCC_PLLCFGR_PLLP_Msk, RCC_PLLCFGR_PLLP_Pos) + 1) * 2;
+            uint32_t sysclk_hz = input_hz * plln / pllp;
+            s_pll_switches++;
+            s_latency_too_low += ((FLASH_ACR & 0xF) < (sysclk_hz - 1) / 30000000UL);
+        }
+        rcc->CFGR = (cfgr & ~RCC_CFGR_SWS_Msk) | (sw << RCC_CFGR_SWS_Pos);
+    }
+}
+
+static int dummy_listener_count = 0;
+
+static void dummy_listener(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change, void* p_context) {
+    (void)phase;
+    (void)p_change;
+    (void)p_context;
+    dummy_listener_count++;
+}
+
+/** @brief Counts the free listener slots, leaving them free. */
+static int free_listener_slots(void) {
+    static int s_contexts[RCC_MAX_CLOCK_LISTENERS];
+    int count = 0;
+    while (count < RCC_MAX_CLOCK_LISTENERS && rcc_register_clock_listener(dummy_listener, &s_contexts[count]) == 0) {
+        count++;
+    }
+    for (int i = 0; i < count; ++i) {
+        rcc_unregister_clock_listener(dummy_listener, &s_contexts[i]);
+    }
+    return count;
+}
+
+static void check_row(const clock_row_t* p_row) {
+    uint32_t pllcfgr = RCC_REGS->PLLCFGR;
+    uint32_t cfgr = RCC_REGS->CFGR;
+    TEST_CHECK(field(pllcfgr, RCC_PLLCFGR_PLLM_Msk, RCC_PLLCFGR_PLLM_Pos) == HSE_HZ / 1000000UL);
+    TEST_CHECK(field(pllcfgr, RCC_PLLCFGR_PLLN_Msk, RCC_PLLCFGR_PLLN_Pos) == p_row->plln);
+    TEST_CHECK(field(pllcfgr, RCC_PLLCFGR_PLLP_Msk, RCC_PLLCFGR_PLLP_Pos) == p_row->pllp / 2 - 1);
+    TEST_CHECK(field(pllcfgr, RCC_PLLCFGR_PLLQ_Msk, RCC_PLLCFGR_PLLQ_Pos) == p_row->pllq);
+    TEST_CHECK(pllcfgr & RCC_PLLCFGR_PLLSRC_Msk);
+    TEST_CHECK(field(cfgr, RCC_CFGR_SWS_Msk, RCC_CFGR_SWS_Pos) == SW_PLL);
+    TEST_CHECK(field(cfgr, RCC_CFGR_PPRE1_Msk, RCC_CFGR_PPRE1_Pos) == p_row->ppre1_bits);
+    TEST_CHECK(field(cfgr, RCC_CFGR_PPRE2_Msk, RCC_CFGR_PPRE2_Pos) == p_row->ppre2_bits);
+    // PLLQ keeps the 48 MHz domain exact
+    TEST_CHECK(p_row->mhz * p_row->pllp == 48 * p_row->pllq);
+
+    rcc_clocks_t clocks;
+    rcc_get_clocks(&clocks);
+    TEST_CHECK(clocks.sysclk_hz == p_row->mhz * 1000000UL);
+    TEST_CHECK(clocks.apb1_hz == p_row->apb1_mhz * 1000000UL);
+    TEST_CHECK(clocks.apb2_hz == p_row->apb2_mhz * 1000000UL);
+    TEST_CHECK(clocks.apb1_timer_hz == 2 * clocks.apb1_hz);
+
+    TEST_CHECK((FLASH_ACR & 0xF) == p_row->wait_states);
+    TEST_CHECK(USART1_BRR == p_row->usart1_brr);
+    TEST_CHECK(USART2_BRR == p_row->usart2_brr);
+    TEST_CHECK((I2C1_CR2 & 0x3F) == p_row->apb1_mhz);
+    TEST_CHECK((I2C1_CCR & 0xFFF) == p_row->i2c_ccr);
+    TEST_CHECK(I2C1_TRISE == p_row->i2c_trise);
+    TEST_CHECK(TIM5_PSC == p_row->tim_psc);
+
+    printf("%3u MHz: N%u P%u Q%u  APB1 %u APB2 %u MHz  %u WS  BRR %u/%u  I2C CCR %u TRISE %u  TIM5 PSC %u\n",
+           (unsigned)p_row->mhz, (unsigned)p_row->plln, (unsigned)p_row->pllp, (unsigned)p_row->pllq,
+           (unsigned)p_row->apb1_mhz, (unsigned)p_row->apb2_mhz, (unsigned)(FLASH_ACR & 0xF),
+           (unsigned)USART1_BRR, (unsigned)USART2_BRR, (unsigned)(I2C1_CCR & 0xFFF),
+           (unsigned)I2C1_TRISE, (unsigned)TIM5_PSC);
+}
+
+// --- Tests ---
+
+int main(void) {
+    TEST_CHECK(reg_fake_map(APB1_WINDOW, 0x8000));
+    TEST_CHECK(reg_fake_map(APB2_WINDOW, 0x5000));
+    TEST_CHECK(reg_fake_map(AHB1_WINDOW, 0x4000));
+    TEST_CHECK(reg_fake_map(DMA_WINDOW, 0x1000));
+    TEST_CHECK(reg_fake_map(NVIC_WINDOW, 0x1000));
+    RCC_REGS->CR = RCC_CR_HSION_Msk | RCC_CR_HSIRDY_Msk;    // Reset state
+    TEST_CHECK(reg_fake_trap(0x40023000UL, 0x1000, rcc_hook));
+
+    TEST_CHECK(rcc_system_init(RCC_CLOCK_SOURCE_EXTERNAL, HSE_HZ, RCC_SYSCLK_FREQ_168_MHZ));
+
+    int free_slots = free_listener_slots();
+    flash_handle_t flash = flash_init();
+    const uart_config_t uart_config = {.baud_rate = BAUD_RATE, .word_length = 8};
+    uart_handle_t usart1 = uart_init(1, &uart_config);
+    uart_handle_t usart2 = uart_init(2, &uart_config);
+    const i2c_config_t i2c_config = {.speed = i2c_speed_sm_100k, .peripheral_clock_hz = rcc_get_apb1_frequency()};
+    i2c_handle_t i2c1 = i2c_init(1, &i2c_config);
+    const timer_config_t timer_config = {.prescaler = timer_get_input_clock_hz(5) / 1000000UL - 1, .period = 0xFFFFFFFFUL};
+    timer_handle_t tim5 = timer_init(5, &timer_config);
+    TEST_CHECK(flash != NULL && usart1 != NULL && usart2 != NULL && i2c1 != NULL && tim5 != NULL);
+    TEST_CHECK(free_listener_slots() == free_slots - 5);
+    timer_start(tim5);
+    check_row(&s_rows[0]);
+
+    for (size_t i = 1; i < sizeof(s_rows) / sizeof(s_rows[0]); ++i) {
+        TIM5_CNT = 1000 * (uint32_t)i;
+        TEST_CHECK(rcc_set_sysclk(s_rows[i].freq));
+        TEST_CHECK(TIM5_CNT == 1000 * (uint32_t)i);
+        TEST_CHECK((TIM5_CR1 & 0x4) == 0);                 // URS released
+        check_row(&s_rows[i]);
+    }
+    TEST_CHECK(s_latency_too_low == 0);
+    TEST_CHECK(s_pll_switches >= sizeof(s_rows) / sizeof(s_rows[0]));
+
+    // Beyond SYSCLK_MAX_HZ: refused before any listener runs
+    uint32_t switches = s_pll_switches;
+    dummy_listener_count = 0;
+    TEST_CHECK(rcc_register_clock_listener(dummy_listener, &dummy_listener_count) == 0);
+    TEST_CHECK(!rcc_set_sysclk(RCC_SYSCLK_FREQ_180_MHZ));
+    TEST_CHECK(dummy_listener_count == 0 && s_pll_switches == switches);
+    rcc_unregister_clock_listener(dummy_listener, &dummy_listener_count);
+    check_row(&s_rows[sizeof(s_rows) / sizeof(s_rows[0]) - 1]);
+
+    // A released timer leaves its listener slot free and its PSC alone
+    timer_deinit(&tim5);
+    TEST_CHECK(tim5 == NULL);
+    TEST_CHECK(free_listener_slots() == free_slots - 4);
+    TIM5_PSC = 0xABC;
+    TEST_CHECK(rcc_set_sysclk(RCC_SYSCLK_FREQ_168_MHZ));
+    TEST_CHECK(TIM5_PSC == 0xABC);
+
+    uart_deinit(&usart1);
+    uart_deinit(&usart2);
+    i2c_deinit(&i2c1);
+    flash_deinit(&flash);
+    TEST_CHECK(free_listener_slots() == free_slots);
+
+    reg_fake_untrap();
+    return TEST_EXIT();
+}
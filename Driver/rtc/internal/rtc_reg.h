@@ -27,6 +27,7 @@ typedef struct {
     __IO uint32_t ALRMAR;
     __IO uint32_t ALRMBR;
     __O  uint32_t WPR;
+    __I  uint32_t SSR;
 } rtc_reg_map_t;
 
 /* --- Register Bit Field Definitions --- */
@@ -39,9 +40,20 @@ typedef struct {
 #define RTC_ISR_INITF_Msk   (1UL << RTC_ISR_INITF_Pos)
 #define RTC_ISR_RSF_Pos     (5U)
 #define RTC_ISR_RSF_Msk     (1UL << RTC_ISR_RSF_Pos)
+#define RTC_ISR_WUTWF_Pos   (2U)
+#define RTC_ISR_WUTWF_Msk   (1UL << RTC_ISR_WUTWF_Pos)
+#define RTC_ISR_WUTF_Pos    (10U)
+#define RTC_ISR_WUTF_Msk    (1UL << RTC_ISR_WUTF_Pos)
 
 #define RTC_CR_BYPSHAD_Pos  (5U)
 #define RTC_CR_BYPSHAD_Msk  (1UL << RTC_CR_BYPSHAD_Pos)
+#define RTC_CR_WUCKSEL_Pos  (0U)
+#define RTC_CR_WUCKSEL_Msk  (0x7UL << RTC_CR_WUCKSEL_Pos)
+#define RTC_CR_WUCKSEL_DIV2 (0x3UL << RTC_CR_WUCKSEL_Pos)
+#define RTC_CR_WUTE_Pos     (10U)
+#define RTC_CR_WUTE_Msk     (1UL << RTC_CR_WUTE_Pos)
+#define RTC_CR_WUTIE_Pos    (14U)
+#define RTC_CR_WUTIE_Msk    (1UL << RTC_CR_WUTIE_Pos)
 
 #define RTC_PRER_PREDIV_A_Pos (16U)
 #define RTC_PRER_PREDIV_A_Msk (0x7FUL << RTC_PRER_PREDIV_A_Pos)
@@ -17,6 +17,12 @@ typedef struct {
     int (*get_time)(struct rtc_handle_t* handle, rtc_time_t* time);
     int (*set_date)(struct rtc_handle_t* handle, const rtc_date_t* date);
     int (*get_date)(struct rtc_handle_t* handle, rtc_date_t* date);
+    int (*start_wakeup_timer)(struct rtc_handle_t* handle, uint32_t ticks);
+    void (*stop_wakeup_timer)(struct rtc_handle_t* handle);
+    bool (*clear_wakeup_flag)(struct rtc_handle_t* handle);
+    uint32_t (*get_subsecond_ticks)(struct rtc_handle_t* handle);
+    uint32_t (*get_subsecond_hz)(struct rtc_handle_t* handle);
+    uint32_t (*get_wakeup_clock_hz)(void);
 } rtc_port_interface_t;
 
 /* --- Functions to be provided by the concrete port implementation --- */
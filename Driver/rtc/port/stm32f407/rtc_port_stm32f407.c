@@ -5,10 +5,37 @@
 
 #include "internal/rtc_private.h"
 #include "internal/rtc_reg.h"
+#include "rcc.h"
+#include "pwr.h"
 
 // Placeholder base address
 #define RTC_BASE              0x40002800UL
 
+// RTC clock source: the internal LSI oscillator, since the LSE crystal is not
+// fitted on every board. LSI is only accurate to a few percent; callers that
+// need precise intervals should calibrate against a core timer.
+#define RTC_CLOCK_HZ          32000UL
+
+#define RCC_BASE              0x40023800UL
+#define RCC_BDCR              (*(volatile uint32_t*)(RCC_BASE + 0x70UL))
+#define RCC_CSR               (*(volatile uint32_t*)(RCC_BASE + 0x74UL))
+#define RCC_BDCR_RTCSEL_Msk   (3UL << 8)
+#define RCC_BDCR_RTCSEL_LSI   (2UL << 8)
+#define RCC_BDCR_RTCEN        (1UL << 15)
+#define RCC_CSR_LSION         (1UL << 0)
+#define RCC_CSR_LSIRDY        (1UL << 1)
+
+// The wakeup timer is connected to EXTI line 22 (RTC_WKUP_IRQn = 3)
+#define EXTI_BASE             0x40013C00UL
+#define EXTI_IMR              (*(volatile uint32_t*)(EXTI_BASE + 0x00UL))
+#define EXTI_RTSR             (*(volatile uint32_t*)(EXTI_BASE + 0x08UL))
+#define EXTI_PR               (*(volatile uint32_t*)(EXTI_BASE + 0x14UL))
+#define EXTI_LINE_RTC_WAKEUP  (1UL << 22)
+#define NVIC_ISER0            (*(volatile uint32_t*)0xE000E100UL)
+#define RTC_WKUP_IRQ_BIT      (1UL << 3)
+
+static volatile bool s_wakeup_fired = false;
+
 // --- Private Helper Functions for STM32F4 ---
 
 static uint8_t bcd_to_dec(uint8_t bcd) {
@@ -44,8 +71,17 @@ static void wait_for_sync(rtc_reg_map_t* rtc_regs) {
 // --- Port Implementation ---
 
 static void stm32f4_enable_clock(void) {
-    // Placeholder: A real implementation would use the RCC and PWR drivers
-    // to enable the APB1 clock, PWR clock, and disable backup domain protection.
+    rcc_enable_peripheral_clock(PERIPH_ID_PWR);
+    pwr_disable_backup_domain_write_protect(pwr_init());
+
+    RCC_CSR |= RCC_CSR_LSION;
+    while (!(RCC_CSR & RCC_CSR_LSIRDY));
+
+    // RTCSEL can only be written once per backup domain reset
+    if ((RCC_BDCR & RCC_BDCR_RTCSEL_Msk) == 0) {
+        RCC_BDCR |= RCC_BDCR_RTCSEL_LSI;
+    }
+    RCC_BDCR |= RCC_BDCR_RTCEN;
 }
 
 static int stm32f4_configure_prescalers(struct rtc_handle_t* handle, const rtc_config_t* config) {
@@ -111,6 +147,89 @@ static int stm32f4_get_date(struct rtc_handle_t* handle, rtc_date_t* date) {
     return 0;
 }
 
+static int stm32f4_start_wakeup_timer(struct rtc_handle_t* handle, uint32_t ticks) {
+    rtc_reg_map_t* rtc_regs = (rtc_reg_map_t*)handle->port_hw_instance;
+
+    rtc_regs->WPR = RTC_WPR_KEY1;
+    rtc_regs->WPR = RTC_WPR_KEY2;
+    rtc_regs->CR &= ~(RTC_CR_WUTE_Msk | RTC_CR_WUTIE_Msk);
+    for (volatile int i = 0; !(rtc_regs->ISR & RTC_ISR_WUTWF_Msk); ++i) {
+        if (i >= 10000) {
+            rtc_regs->WPR = 0xFF;
+            return -1; // Timeout
+        }
+    }
+
+    rtc_regs->WUTR = ticks - 1;
+    rtc_regs->CR = (rtc_regs->CR & ~RTC_CR_WUCKSEL_Msk) | RTC_CR_WUCKSEL_DIV2;
+    rtc_regs->ISR &= ~RTC_ISR_WUTF_Msk;
+    EXTI_PR = EXTI_LINE_RTC_WAKEUP;
+    rtc_regs->CR |= RTC_CR_WUTIE_Msk | RTC_CR_WUTE_Msk;
+    rtc_regs->WPR = 0xFF; // Re-lock
+
+    EXTI_IMR |= EXTI_LINE_RTC_WAKEUP;
+    EXTI_RTSR |= EXTI_LINE_RTC_WAKEUP;
+    NVIC_ISER0 = RTC_WKUP_IRQ_BIT;
+    return 0;
+}
+
+static void stm32f4_stop_wakeup_timer(struct rtc_handle_t* handle) {
+    rtc_reg_map_t* rtc_regs = (rtc_reg_map_t*)handle->port_hw_instance;
+
+    rtc_regs->WPR = RTC_WPR_KEY1;
+    rtc_regs->WPR = RTC_WPR_KEY2;
+    rtc_regs->CR &= ~(RTC_CR_WUTE_Msk | RTC_CR_WUTIE_Msk);
+    rtc_regs->WPR = 0xFF;
+}
+
+static bool stm32f4_clear_wakeup_flag(struct rtc_handle_t* handle) {
+    rtc_reg_map_t* rtc_regs = (rtc_reg_map_t*)handle->port_hw_instance;
+    bool fired = s_wakeup_fired || (rtc_regs->ISR & RTC_ISR_WUTF_Msk);
+
+    rtc_regs->ISR &= ~RTC_ISR_WUTF_Msk;
+    EXTI_PR = EXTI_LINE_RTC_WAKEUP;
+    s_wakeup_fired = false;
+    return fired;
+}
+
+static uint32_t stm32f4_get_subsecond_ticks(struct rtc_handle_t* handle) {
+    rtc_reg_map_t* rtc_regs = (rtc_reg_map_t*)handle->port_hw_instance;
+    uint32_t sync_div = ((rtc_regs->PRER & RTC_PRER_PREDIV_S_Msk) >> RTC_PRER_PREDIV_S_Pos) + 1;
+
+    // Shadow registers are stale after STOP mode until the next sync
+    wait_for_sync(rtc_regs);
+    // Reading SSR freezes TR and DR until DR is read
+    uint32_t ssr = rtc_regs->SSR;
+    uint32_t tr = rtc_regs->TR;
+    (void)rtc_regs->DR;
+
+    uint32_t seconds = bcd_to_dec((tr >> 0) & 0x7F) +
+                       bcd_to_dec((tr >> 8) & 0x7F) * 60UL +
+                       bcd_to_dec((tr >> 16) & 0x3F) * 3600UL;
+    return seconds * sync_div + (sync_div - 1 - ssr);
+}
+
+static uint32_t stm32f4_get_subsecond_hz(struct rtc_handle_t* handle) {
+    rtc_reg_map_t* rtc_regs = (rtc_reg_map_t*)handle->port_hw_instance;
+    uint32_t async_div = ((rtc_regs->PRER & RTC_PRER_PREDIV_A_Msk) >> RTC_PRER_PREDIV_A_Pos) + 1;
+    return RTC_CLOCK_HZ / async_div;
+}
+
+static uint32_t stm32f4_get_wakeup_clock_hz(void) {
+    return RTC_CLOCK_HZ / 2; // WUCKSEL = RTCCLK/2
+}
+
+// --- Interrupt Handler ---
+
+void RTC_WKUP_IRQHandler(void) {
+    rtc_reg_map_t* rtc_regs = (rtc_reg_map_t*)RTC_BASE;
+    if (rtc_regs->ISR & RTC_ISR_WUTF_Msk) {
+        rtc_regs->ISR &= ~RTC_ISR_WUTF_Msk;
+        s_wakeup_fired = true;
+    }
+    EXTI_PR = EXTI_LINE_RTC_WAKEUP;
+}
+
 // --- The concrete port interface for STM32F4 ---
 static const rtc_port_interface_t stm32f4_port_api = {
 .enable_clock = stm32f4_enable_clock,
@@ -119,6 +238,12 @@ static const rtc_port_interface_t stm32f4_port_api = {
 .get_time = stm32f4_get_time,
 .set_date = stm32f4_set_date,
 .get_date = stm32f4_get_date,
+.start_wakeup_timer = stm32f4_start_wakeup_timer,
+.stop_wakeup_timer = stm32f4_stop_wakeup_timer,
+.clear_wakeup_flag = stm32f4_clear_wakeup_flag,
+.get_subsecond_ticks = stm32f4_get_subsecond_ticks,
+.get_subsecond_hz = stm32f4_get_subsecond_hz,
+.get_wakeup_clock_hz = stm32f4_get_wakeup_clock_hz,
 };
 
 // --- Public functions provided by the port ---
@@ -71,3 +71,44 @@ int rtc_get_date(rtc_handle_t handle, rtc_date_t* date) {
     }
     return -1;
 }
+
+int rtc_start_wakeup_timer(rtc_handle_t handle, uint32_t ticks) {
+    if (handle && s_is_handle_initialized && ticks >= 1 && ticks <= 0x10000UL) {
+        return handle->port_api->start_wakeup_timer(handle, ticks);
+    }
+    return -1;
+}
+
+void rtc_stop_wakeup_timer(rtc_handle_t handle) {
+    if (handle && s_is_handle_initialized) {
+        handle->port_api->stop_wakeup_timer(handle);
+    }
+}
+
+bool rtc_clear_wakeup_flag(rtc_handle_t handle) {
+    if (handle && s_is_handle_initialized) {
+        return handle->port_api->clear_wakeup_flag(handle);
+    }
+    return false;
+}
+
+uint32_t rtc_get_subsecond_ticks(rtc_handle_t handle) {
+    if (handle && s_is_handle_initialized) {
+        return handle->port_api->get_subsecond_ticks(handle);
+    }
+    return 0;
+}
+
+uint32_t rtc_get_subsecond_hz(rtc_handle_t handle) {
+    if (handle && s_is_handle_initialized) {
+        return handle->port_api->get_subsecond_hz(handle);
+    }
+    return 0;
+}
+
+uint32_t rtc_get_wakeup_clock_hz(rtc_handle_t handle) {
+    if (handle && s_is_handle_initialized) {
+        return handle->port_api->get_wakeup_clock_hz();
+    }
+    return 0;
+}
@@ -108,4 +108,54 @@ int rtc_set_date(rtc_handle_t handle, const rtc_date_t* date);
  */
 int rtc_get_date(rtc_handle_t handle, rtc_date_t* date);
 
+/**
+ * @brief Starts the periodic wakeup timer.
+ * @details The wakeup event is routed to its EXTI line, so it also brings the
+ *          MCU out of STOP mode. The interrupt handler acknowledges the event.
+ *
+ * @param[in] handle The handle to the RTC instance.
+ * @param[in] ticks Wakeup period in wakeup clock ticks (1 to 65536),
+ *                  see rtc_get_wakeup_clock_hz().
+ *
+ * @return 0 on success, or a negative error code on failure.
+ */
+int rtc_start_wakeup_timer(rtc_handle_t handle, uint32_t ticks);
+
+/**
+ * @brief Stops the wakeup timer and disables its interrupt.
+ * @param[in] handle The handle to the RTC instance.
+ */
+void rtc_stop_wakeup_timer(rtc_handle_t handle);
+
+/**
+ * @brief Checks and clears the wakeup timer event.
+ * @param[in] handle The handle to the RTC instance.
+ * @return true if the wakeup timer expired since the last call, false otherwise.
+ */
+bool rtc_clear_wakeup_flag(rtc_handle_t handle);
+
+/**
+ * @brief Gets the time of day in sub-second resolution.
+ * @details Counts at rtc_get_subsecond_hz() and wraps at midnight. Intended
+ *          for measuring short intervals across low-power modes where the
+ *          core timers are stopped.
+ *
+ * @param[in] handle The handle to the RTC instance.
+ *
+ * @return Sub-second ticks since midnight, or 0 if the handle is invalid.
+ */
+uint32_t rtc_get_subsecond_ticks(rtc_handle_t handle);
+
+/**
+ * @brief Gets the nominal rate of rtc_get_subsecond_ticks() in Hz.
+ * @param[in] handle The handle to the RTC instance.
+ */
+uint32_t rtc_get_subsecond_hz(rtc_handle_t handle);
+
+/**
+ * @brief Gets the nominal rate of the wakeup timer clock in Hz.
+ * @param[in] handle The handle to the RTC instance.
+ */
+uint32_t rtc_get_wakeup_clock_hz(rtc_handle_t handle);
+
 #endif // RTC_H
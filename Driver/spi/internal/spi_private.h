@@ -10,12 +10,18 @@
 #include "spi.h"
 #include "spi_config.h"
 #include "port/spi_port.h"
+#include "dma.h"
 
 /**
  * @brief Internal runtime state for an SPI instance.
  */
 typedef struct {
     bool is_initialized;
+    dma_handle_t dma_rx;                // NULL when the instance has no DMA mapping
+    dma_handle_t dma_tx;
+    uint8_t dma_channel;
+    spi_transaction_t* volatile p_head; // Running transaction
+    spi_transaction_t* p_tail;
 } spi_context_t;
 
 /**
@@ -28,4 +34,10 @@ struct spi_handle_t {
     void* port_hw_instance;
 };
 
+/**
+ * @brief Services the DMA interrupts of an asynchronous transfer.
+ * @note  Called by the port from the RX and TX stream interrupt handlers.
+ */
+void spi_dma_irq_handler(struct spi_handle_t* handle);
+
 #endif // SPI_PRIVATE_H
@@ -49,6 +49,9 @@ typedef struct {
 /* CRCNEXT: Transmit CRC next */
 #define SPI_CR1_CRCNEXT			(1 << 12)
 
+/* DFF: Data frame format */
+#define SPI_CR1_DFF			(1 << 11)
+
 /* RXONLY: Receive only */
 #define SPI_CR1_RXONLY			(1 << 10)
 
@@ -261,4 +264,17 @@ typedef struct {
 /* 0 and 1 are forbidden values */
 
 
+/* --- Field positions and masks used by the port --- */
+#define SPI_CR1_CPHA_Pos        (0U)
+#define SPI_CR1_CPOL_Pos        (1U)
+#define SPI_CR1_MSTR_Msk        SPI_CR1_MSTR
+#define SPI_CR1_BR_Pos          (3U)
+#define SPI_CR1_SPE_Msk         SPI_CR1_SPE
+#define SPI_CR1_LSBFIRST_Msk    SPI_CR1_LSBFIRST
+#define SPI_CR1_SSI_Msk         SPI_CR1_SSI
+#define SPI_CR1_SSM_Msk         SPI_CR1_SSM
+#define SPI_CR2_SSOE_Msk        SPI_CR2_SSOE
+#define SPI_SR_RXNE_Msk         SPI_SR_RXNE
+#define SPI_SR_TXE_Msk          SPI_SR_TXE
+
 #endif // SPI_REG_H
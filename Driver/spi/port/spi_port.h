@@ -8,6 +8,16 @@
 
 struct spi_handle_t;
 
+/**
+ * @brief DMA streams serving one SPI instance.
+ */
+typedef struct {
+    uint8_t dma_num;
+    uint8_t rx_stream;
+    uint8_t tx_stream;
+    uint8_t channel;
+} spi_dma_map_t;
+
 /**
  * @brief A structure of function pointers that defines the hardware-dependent
  *        operations required by the SPI driver.
@@ -19,6 +29,12 @@ typedef struct {
     uint8_t (*transfer_byte)(struct spi_handle_t* handle, uint8_t tx_byte);
     void (*enable)(struct spi_handle_t* handle);
     void (*disable)(struct spi_handle_t* handle);
+    bool (*get_dma_map)(struct spi_handle_t* handle, spi_dma_map_t* p_map);
+    volatile void* (*get_data_register)(struct spi_handle_t* handle);
+    void (*enable_dma_requests)(struct spi_handle_t* handle, bool enable);
+    void (*enable_dma_irq)(struct spi_handle_t* handle);
+    uint32_t (*irq_lock)(void);
+    void (*irq_unlock)(uint32_t state);
 } spi_port_interface_t;
 
 /* --- Functions to be provided by the concrete port implementation --- */
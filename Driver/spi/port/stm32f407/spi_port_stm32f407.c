@@ -5,6 +5,7 @@
 
 #include "internal/spi_private.h"
 #include "internal/spi_reg.h"
+#include "rcc.h"
 
 // Placeholder base addresses
 #define PERIPH_BASE           0x40000000UL
@@ -13,6 +14,21 @@
 #define SPI1_BASE             (APB2PERIPH_BASE + 0x3000UL)
 #define SPI2_BASE             (APB1PERIPH_BASE + 0x3800UL)
 
+// SPI1 RX on DMA2 Stream2 and TX on DMA2 Stream3, both channel 3. SPI2's
+// streams (DMA1 Stream3/4) carry the I2S2 audio input, so SPI2 stays blocking.
+#define SPI1_DMA_NUM          2
+#define SPI1_DMA_RX_STREAM    2
+#define SPI1_DMA_TX_STREAM    3
+#define SPI1_DMA_CHANNEL      3
+#define SPI1_DMA_RX_IRQN      58
+#define SPI1_DMA_TX_IRQN      59
+
+#define NVIC_ISER(n)          (((volatile uint32_t*)0xE000E100UL)[n])
+#define NVIC_IPR(n)           (((volatile uint8_t*)0xE000E400UL)[n])
+#define NVIC_PRIO_BITS        4
+
+static struct spi_handle_t* s_spi1_async_handle = NULL;
+
 // --- Private function implementations for STM32F4 ---
 
 static void stm32f4_enable(struct spi_handle_t* handle) {
@@ -58,8 +74,10 @@ static void stm32f4_configure_core(struct spi_handle_t* handle) {
         cr1 |= SPI_CR1_LSBFIRST_Msk;
     }
 
-    // Set 8-bit data frame format (default)
-    cr1 &= ~SPI_CR1_DFF_Msk;
+    // Data frame format, 8-bit unless configured otherwise
+    if (config->data_size == SPI_DATA_SIZE_16_BIT) {
+        cr1 |= SPI_CR1_DFF;
+    }
 
     // Apply configuration
     spi_regs->CR1 = cr1;
@@ -70,15 +88,88 @@ static void stm32f4_configure_core(struct spi_handle_t* handle) {
 }
 
 static void stm32f4_enable_clock(struct spi_handle_t* handle) {
-    // Placeholder: A real implementation would use the RCC driver.
-    // e.g., rcc_periph_clock_enable(RCC_SPI1);
+    if (handle->port_hw_instance == (void*)SPI1_BASE) {
+        rcc_enable_peripheral_clock(PERIPH_ID_SPI1);
+    } else if (handle->port_hw_instance == (void*)SPI2_BASE) {
+        rcc_enable_peripheral_clock(PERIPH_ID_SPI2);
+    }
 }
 
 static void stm32f4_init_pins(struct spi_handle_t* handle) {
+    (void)handle;
     // Placeholder: A real implementation would use a GPIO driver to
     // configure SCK, MISO, MOSI pins for their alternate function.
 }
 
+static bool stm32f4_get_dma_map(struct spi_handle_t* handle, spi_dma_map_t* p_map) {
+    if (handle->port_hw_instance != (void*)SPI1_BASE) {
+        return false;
+    }
+    p_map->dma_num = SPI1_DMA_NUM;
+    p_map->rx_stream = SPI1_DMA_RX_STREAM;
+    p_map->tx_stream = SPI1_DMA_TX_STREAM;
+    p_map->channel = SPI1_DMA_CHANNEL;
+    return true;
+}
+
+static volatile void* stm32f4_get_data_register(struct spi_handle_t* handle) {
+    spi_reg_map_t* spi_regs = (spi_reg_map_t*)handle->port_hw_instance;
+    return &spi_regs->DR;
+}
+
+static void stm32f4_enable_dma_requests(struct spi_handle_t* handle, bool enable) {
+    spi_reg_map_t* spi_regs = (spi_reg_map_t*)handle->port_hw_instance;
+    if (enable) {
+        // RX first, so the first received frame always has a request pending
+        spi_regs->CR2 |= SPI_CR2_RXDMAEN;
+        spi_regs->CR2 |= SPI_CR2_TXDMAEN;
+    } else {
+        spi_regs->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+        (void)spi_regs->DR; // Drop a stale frame left by an aborted transfer
+    }
+}
+
+static void stm32f4_enable_dma_irq(struct spi_handle_t* handle) {
+    if (handle->port_hw_instance != (void*)SPI1_BASE) {
+        return;
+    }
+    s_spi1_async_handle = handle;
+    NVIC_IPR(SPI1_DMA_RX_IRQN) = (uint8_t)(SPI_DMA_IRQ_PRIORITY << (8 - NVIC_PRIO_BITS));
+    NVIC_IPR(SPI1_DMA_TX_IRQN) = (uint8_t)(SPI_DMA_IRQ_PRIORITY << (8 - NVIC_PRIO_BITS));
+    NVIC_ISER(SPI1_DMA_RX_IRQN / 32) = (1UL << (SPI1_DMA_RX_IRQN % 32));
+    NVIC_ISER(SPI1_DMA_TX_IRQN / 32) = (1UL << (SPI1_DMA_TX_IRQN % 32));
+}
+
+static uint32_t stm32f4_irq_lock(void) {
+    uint32_t primask = 0;
+#if defined(__arm__)
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+#endif
+    return primask;     // Host builds (register-fake tests) have no interrupts to mask
+}
+
+static void stm32f4_irq_unlock(uint32_t state) {
+#if defined(__arm__)
+    __asm volatile ("msr primask, %0" :: "r" (state) : "memory");
+#else
+    (void)state;
+#endif
+}
+
+// --- Interrupt Handlers ---
+
+void DMA2_Stream2_IRQHandler(void) {
+    if (s_spi1_async_handle) {
+        spi_dma_irq_handler(s_spi1_async_handle);
+    }
+}
+
+void DMA2_Stream3_IRQHandler(void) {
+    if (s_spi1_async_handle) {
+        spi_dma_irq_handler(s_spi1_async_handle);
+    }
+}
+
 // --- The concrete port interface for STM32F4 ---
 static const spi_port_interface_t stm32f4_port_api = {
   .enable_clock = stm32f4_enable_clock,
@@ -87,6 +178,12 @@ static const spi_port_interface_t stm32f4_port_api = {
   .transfer_byte = stm32f4_transfer_byte,
   .enable = stm32f4_enable,
   .disable = stm32f4_disable,
+  .get_dma_map = stm32f4_get_dma_map,
+  .get_data_register = stm32f4_get_data_register,
+  .enable_dma_requests = stm32f4_enable_dma_requests,
+  .enable_dma_irq = stm32f4_enable_dma_irq,
+  .irq_lock = stm32f4_irq_lock,
+  .irq_unlock = stm32f4_irq_unlock,
 };
 
 // --- Public functions provided by the port ---
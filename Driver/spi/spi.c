@@ -7,8 +7,12 @@
 #include <string.h>
 
 // --- Static Data ---
-static struct spi_handle_t s_handle_pool;
-static bool s_is_handle_in_use = {false};
+static struct spi_handle_t s_handle_pool[SPI_MAX_INSTANCES];
+static bool s_is_handle_in_use[SPI_MAX_INSTANCES] = {false};
+
+// Sent when a transaction has no TX data, and sink for discarded RX data
+static const uint16_t s_dummy_tx = 0xFFFF;
+static uint16_t s_dummy_rx;
 
 // --- Private Helper Functions ---
 static struct spi_handle_t* allocate_handle(void) {
@@ -31,6 +35,107 @@ static void release_handle(spi_handle_t handle) {
     }
 }
 
+static void configure_dma(struct spi_handle_t* handle, dma_handle_t dma, dma_direction_t direction, bool memory_increment) {
+    dma_data_size_t size = (handle->config.data_size == SPI_DATA_SIZE_16_BIT) ? DMA_DATA_SIZE_16_BIT : DMA_DATA_SIZE_8_BIT;
+    const dma_config_t config = {
+        .channel = handle->context.dma_channel,
+        .direction = direction,
+        .priority = DMA_PRIORITY_MEDIUM,
+        .peripheral_data_size = size,
+        .memory_data_size = size,
+        .memory_increment = memory_increment,
+    };
+    dma_reconfigure(dma, &config);
+    dma_enable_interrupt(dma, DMA_INTERRUPT_TRANSFER_ERROR);
+}
+
+/**
+ * @brief Sets up the RX and TX streams if the port maps DMA to this instance.
+ * @return true if asynchronous transfers are available.
+ */
+static bool init_dma(struct spi_handle_t* handle) {
+    spi_dma_map_t map;
+    if (!handle->port_api->get_dma_map(handle, &map)) {
+        return false;
+    }
+
+    const dma_config_t config = {
+        .channel = map.channel,
+        .direction = DMA_DIRECTION_PERIPHERAL_TO_MEMORY,
+    };
+    handle->context.dma_channel = map.channel;
+    handle->context.dma_rx = dma_init(map.dma_num, map.rx_stream, &config);
+    handle->context.dma_tx = dma_init(map.dma_num, map.tx_stream, &config);
+    if (handle->context.dma_rx == NULL || handle->context.dma_tx == NULL) {
+        dma_deinit(&handle->context.dma_rx);
+        dma_deinit(&handle->context.dma_tx);
+        return false;
+    }
+
+    handle->port_api->enable_dma_irq(handle);
+    return true;
+}
+
+/**
+ * @brief Starts the transaction at the head of the queue.
+ * @note  Runs in the DMA interrupt or with interrupts locked.
+ */
+static void start_transaction(struct spi_handle_t* handle) {
+    spi_transaction_t* p_txn = handle->context.p_head;
+    volatile void* data_register = handle->port_api->get_data_register(handle);
+
+    if (p_txn->select) {
+        p_txn->select(true);
+    }
+
+    configure_dma(handle, handle->context.dma_rx, DMA_DIRECTION_PERIPHERAL_TO_MEMORY, p_txn->p_rx_data != NULL);
+    configure_dma(handle, handle->context.dma_tx, DMA_DIRECTION_MEMORY_TO_PERIPHERAL, p_txn->p_tx_data != NULL);
+    // Completion is taken from RX, which receives the last frame after TX sent it
+    dma_enable_interrupt(handle->context.dma_rx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+
+    dma_start_transfer(handle->context.dma_rx, (const void*)data_register,
+                       p_txn->p_rx_data ? p_txn->p_rx_data : &s_dummy_rx, (uint16_t)p_txn->len);
+    dma_start_transfer(handle->context.dma_tx, p_txn->p_tx_data ? p_txn->p_tx_data : &s_dummy_tx,
+                       (void*)data_register, (uint16_t)p_txn->len);
+    handle->port_api->enable_dma_requests(handle, true);
+}
+
+void spi_dma_irq_handler(struct spi_handle_t* handle) {
+    spi_context_t* ctx = &handle->context;
+    bool error = dma_is_interrupt_flag_set(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_ERROR) ||
+                 dma_is_interrupt_flag_set(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_ERROR);
+    bool done = dma_is_interrupt_flag_set(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+
+    dma_clear_interrupt_flag(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_ERROR);
+    dma_clear_interrupt_flag(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_ERROR);
+    dma_clear_interrupt_flag(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    dma_clear_interrupt_flag(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+
+    spi_transaction_t* p_txn = ctx->p_head;
+    if (p_txn == NULL || !(error || done)) {
+        return;
+    }
+
+    handle->port_api->enable_dma_requests(handle, false);
+    dma_stop_transfer(ctx->dma_rx);
+    dma_stop_transfer(ctx->dma_tx);
+    if (p_txn->select) {
+        p_txn->select(false);
+    }
+
+    // Start the next transaction before the callback, which may queue another
+    ctx->p_head = p_txn->p_next;
+    if (ctx->p_head == NULL) {
+        ctx->p_tail = NULL;
+    } else {
+        start_transaction(handle);
+    }
+
+    if (p_txn->callback) {
+        p_txn->callback(p_txn->p_context, error ? -1 : 0);
+    }
+}
+
 // --- Public API Function Implementations ---
 
 spi_handle_t spi_init(uint8_t instance_num, const spi_config_t* config) {
@@ -46,9 +151,7 @@ spi_handle_t spi_init(uint8_t instance_num, const spi_config_t* config) {
     handle->port_api = spi_port_get_api_for_instance(instance_num);
     handle->port_hw_instance = spi_port_get_base_addr_for_instance(instance_num);
 
-    if (handle->port_api == NULL |
-
-| handle->port_hw_instance == NULL) {
+    if (handle->port_api == NULL || handle->port_hw_instance == NULL) {
         release_handle(handle);
         return NULL;
     }
@@ -60,19 +163,22 @@ spi_handle_t spi_init(uint8_t instance_num, const spi_config_t* config) {
     handle->port_api->configure_core(handle);
     handle->port_api->enable(handle);
 
+    // Without DMA streams the instance still supports blocking transfers
+    init_dma(handle);
+
     handle->context.is_initialized = true;
     return handle;
 }
 
 void spi_deinit(spi_handle_t* p_handle) {
-    if (p_handle == NULL |
-
-| *p_handle == NULL) {
+    if (p_handle == NULL || *p_handle == NULL) {
         return;
     }
     spi_handle_t handle = *p_handle;
     if (handle->context.is_initialized) {
         handle->port_api->disable(handle);
+        dma_deinit(&handle->context.dma_rx);
+        dma_deinit(&handle->context.dma_tx);
         // Add disable_clock if implemented
     }
     release_handle(handle);
@@ -83,6 +189,10 @@ int spi_transfer_blocking(spi_handle_t handle, const uint8_t* p_tx_data, uint8_t
     if (handle == NULL ||!handle->context.is_initialized) {
         return -1; // Invalid arguments
     }
+    // Byte frames only, and never in the middle of an asynchronous transaction
+    if (handle->config.data_size != SPI_DATA_SIZE_8_BIT || handle->context.p_head != NULL) {
+        return -1;
+    }
 
     const uint8_t DUMMY_BYTE = 0xFF;
 
@@ -95,3 +205,33 @@ int spi_transfer_blocking(spi_handle_t handle, const uint8_t* p_tx_data, uint8_t
     }
     return 0;
 }
+
+int spi_transfer_async(spi_handle_t handle, spi_transaction_t* p_txn) {
+    if (handle == NULL || !handle->context.is_initialized || handle->context.dma_rx == NULL ||
+        p_txn == NULL || p_txn->len == 0 || p_txn->len > 0xFFFF) {
+        return -1;
+    }
+    if (handle->config.data_size == SPI_DATA_SIZE_16_BIT &&
+        ((((uintptr_t)p_txn->p_tx_data) | ((uintptr_t)p_txn->p_rx_data)) & 1) != 0) {
+        return -1;
+    }
+
+    p_txn->p_next = NULL;
+
+    uint32_t state = handle->port_api->irq_lock();
+    if (handle->context.p_head == NULL) {
+        handle->context.p_head = p_txn;
+        handle->context.p_tail = p_txn;
+        start_transaction(handle);
+    } else {
+        handle->context.p_tail->p_next = p_txn;
+        handle->context.p_tail = p_txn;
+    }
+    handle->port_api->irq_unlock(state);
+
+    return 0;
+}
+
+bool spi_is_busy(spi_handle_t handle) {
+    return handle != NULL && handle->context.p_head != NULL;
+}
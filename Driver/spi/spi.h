@@ -54,9 +54,48 @@ typedef enum {
     SPI_BIT_ORDER_LSB_FIRST = 1, //!< Least significant bit transmitted first.
 } spi_bit_order_t;
 
+/** @brief Data frame size. */
+typedef enum {
+    SPI_DATA_SIZE_8_BIT = 0,
+    SPI_DATA_SIZE_16_BIT = 1,
+} spi_data_size_t;
+
 /**
  * @brief Configuration structure for SPI initialization (Master Mode).
  */
+typedef struct {
+    spi_baud_rate_t baud_rate_prescaler;
+    spi_clock_polarity_t clock_polarity;
+    spi_clock_phase_t clock_phase;
+    spi_bit_order_t bit_order;
+    spi_data_size_t data_size;        // Frame size; async transfers count frames
+} spi_config_t;
+
+/**
+ * @brief Completion callback for an asynchronous transaction.
+ * @details Called from interrupt context.
+ *
+ * @param[in] p_context The context stored in the transaction.
+ * @param[in] status 0 on success, or a negative error code on a DMA error.
+ */
+typedef void (*spi_callback_t)(void* p_context, int status);
+
+/**
+ * @brief One asynchronous transaction, owned by the caller.
+ * @details The structure and its buffers must stay valid until the callback
+ *          runs. Transactions on one handle run in submission order, so
+ *          several clients can share the bus, each with its own chip select.
+ */
+typedef struct spi_transaction_t {
+    const void* p_tx_data;            //!< Data to send, or NULL to send all-ones dummy frames
+    void* p_rx_data;                  //!< Received data, or NULL to discard it
+    size_t len;                       //!< Number of frames (bytes, or half-words for 16-bit frames)
+    void (*select)(bool active);      //!< Chip select, called around the transaction; may be NULL
+    spi_callback_t callback;          //!< Completion callback; may be NULL
+    void* p_context;                  //!< Passed to the callback
+    struct spi_transaction_t* p_next; //!< Used by the driver
+} spi_transaction_t;
+
 /* A potential Init structure for SPI mode */
 typedef struct {
     uint32_t  Mode;             // Master or Slave (MSTR bit)
@@ -71,7 +110,7 @@ typedef struct {
     uint32_t  CRCPolynomial;    // Value for SPI_CRCPR
 } SPI_Init_t;
 
-/* A potential Init structure for I2S mode */
+/* Init structure for I2S mode, used by the I2S driver (i2s.h) */
 typedef struct {
     uint32_t  Mode;           // Master/Slave, Tx/Rx (I2SCFG bits)
     uint32_t  Standard;       // Philips, MSB-justified, etc. (I2SSTD bits)
@@ -120,4 +159,28 @@ void spi_deinit(spi_handle_t* p_handle);
  */
 int spi_transfer_blocking(spi_handle_t handle, const uint8_t* p_tx_data, uint8_t* p_rx_data, size_t len);
 
+/**
+ * @brief Queues a full-duplex transaction that runs on DMA.
+ *
+ * @details Returns immediately. The transaction starts when all earlier ones
+ *          on the same handle have finished; `select` is called with true
+ *          before the first frame and with false after the last one, then the
+ *          callback runs. 16-bit frame buffers must be half-word aligned.
+ *          The CPU is only involved at the start and end of each transaction.
+ *
+ * @param[in] handle The handle to the SPI instance.
+ * @param[in,out] p_txn The transaction to queue.
+ *
+ * @return 0 on success, or -1 if the arguments are invalid or the instance
+ *         has no DMA streams for asynchronous transfers.
+ */
+int spi_transfer_async(spi_handle_t handle, spi_transaction_t* p_txn);
+
+/**
+ * @brief Checks whether any asynchronous transaction is queued or running.
+ * @param[in] handle The handle to the SPI instance.
+ * @return true if the bus is busy, false otherwise.
+ */
+bool spi_is_busy(spi_handle_t handle);
+
 #endif // SPI_H
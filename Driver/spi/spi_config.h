@@ -11,4 +11,11 @@
  */
 #define SPI_MAX_INSTANCES 2
 
+/**
+ * @brief NVIC priority of the DMA interrupts used by spi_transfer_async().
+ * @note  Must not be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY if
+ *        completion callbacks use the FreeRTOS FromISR API.
+ */
+#define SPI_DMA_IRQ_PRIORITY 6
+
 #endif // SPI_CONFIG_H
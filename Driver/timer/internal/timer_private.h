@@ -15,6 +15,8 @@
  */
 typedef struct {
     bool is_initialized;
+    uint8_t instance_num;
+    uint32_t tick_hz;           // Counter rate at init, kept across clock changes by the port
 } timer_context_t;
 
 /**
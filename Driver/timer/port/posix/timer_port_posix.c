@@ -0,0 +1,138 @@
+/**
+ * @file      timer_port_posix.c
+ * @brief     Host (POSIX) porting layer for the Timer driver.
+ *
+ * @details   Emulates free-running up-counters on top of CLOCK_MONOTONIC so
+ *            code that timestamps with the Timer driver (e.g. the FreeRTOS
+ *            run-time statistics clock) behaves the same in host simulations.
+ *            The emulated input clock is 1 GHz, so a prescaler computed from
+ *            timer_get_input_clock_hz() yields the same tick rate as on target.
+ */
+
+#include "internal/timer_private.h"
+#include <time.h>
+
+#define POSIX_TIMER_INSTANCES   5
+#define POSIX_TIMER_CLOCK_HZ    1000000000UL
+
+/**
+ * @brief Emulated register state of one timer instance.
+ */
+typedef struct {
+    bool running;
+    uint64_t start_ns;      // Monotonic time at which counting (re)started
+    uint32_t count_at_start;
+    bool update_irq_enabled;
+    bool update_flag;
+} posix_timer_state_t;
+
+static posix_timer_state_t s_timers[POSIX_TIMER_INSTANCES];
+
+// --- Private Helper Functions ---
+
+static uint64_t posix_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t posix_compute_counter(struct timer_handle_t* handle) {
+    posix_timer_state_t* state = (posix_timer_state_t*)handle->port_hw_instance;
+    if (!state->running) {
+        return state->count_at_start;
+    }
+
+    uint64_t ticks = (posix_now_ns() - state->start_ns) / ((uint64_t)handle->config.prescaler + 1);
+    uint64_t modulo = (uint64_t)handle->config.period + 1;
+    uint64_t count = (uint64_t)state->count_at_start + ticks;
+
+    if (count >= modulo) {
+        state->update_flag = true;
+    }
+    return (uint32_t)(count % modulo);
+}
+
+// --- Port Implementation ---
+
+static void posix_enable_clock(uint8_t instance_num) {
+    (void)instance_num;
+}
+
+static void posix_disable_clock(struct timer_handle_t* handle) {
+    (void)handle;
+}
+
+static void posix_configure_core(struct timer_handle_t* handle) {
+    posix_timer_state_t* state = (posix_timer_state_t*)handle->port_hw_instance;
+    state->running = false;
+    state->count_at_start = 0;
+    state->update_flag = false;
+}
+
+static void posix_start(struct timer_handle_t* handle) {
+    posix_timer_state_t* state = (posix_timer_state_t*)handle->port_hw_instance;
+    if (!state->running) {
+        state->start_ns = posix_now_ns();
+        state->running = true;
+    }
+}
+
+static void posix_stop(struct timer_handle_t* handle) {
+    posix_timer_state_t* state = (posix_timer_state_t*)handle->port_hw_instance;
+    state->count_at_start = posix_compute_counter(handle);
+    state->running = false;
+}
+
+static uint32_t posix_get_counter(struct timer_handle_t* handle) {
+    return posix_compute_counter(handle);
+}
+
+static void posix_enable_update_irq(struct timer_handle_t* handle) {
+    ((posix_timer_state_t*)handle->port_hw_instance)->update_irq_enabled = true;
+}
+
+static void posix_disable_update_irq(struct timer_handle_t* handle) {
+    ((posix_timer_state_t*)handle->port_hw_instance)->update_irq_enabled = false;
+}
+
+static bool posix_is_update_irq_flag_set(struct timer_handle_t* handle) {
+    (void)posix_compute_counter(handle);
+    return ((posix_timer_state_t*)handle->port_hw_instance)->update_flag;
+}
+
+static void posix_clear_update_irq_flag(struct timer_handle_t* handle) {
+    ((posix_timer_state_t*)handle->port_hw_instance)->update_flag = false;
+}
+
+// --- The concrete port interface for POSIX hosts ---
+static const timer_port_interface_t posix_port_api = {
+   .enable_clock = posix_enable_clock,
+   .disable_clock = posix_disable_clock,
+   .configure_core = posix_configure_core,
+   .start = posix_start,
+   .stop = posix_stop,
+   .get_counter = posix_get_counter,
+   .enable_update_irq = posix_enable_update_irq,
+   .disable_update_irq = posix_disable_update_irq,
+   .is_update_irq_flag_set = posix_is_update_irq_flag_set,
+   .clear_update_irq_flag = posix_clear_update_irq_flag,
+};
+
+// --- Public functions provided by the port ---
+const timer_port_interface_t* timer_port_get_api(void) {
+    return &posix_port_api;
+}
+
+void* timer_port_get_base_addr(uint8_t instance_num) {
+    if (instance_num == 0 || instance_num > POSIX_TIMER_INSTANCES) {
+        return NULL;
+    }
+    return &s_timers[instance_num - 1];
+}
+
+uint32_t timer_port_get_clock_freq(uint8_t instance_num) {
+    if (instance_num == 0 || instance_num > POSIX_TIMER_INSTANCES) {
+        return 0;
+    }
+    return POSIX_TIMER_CLOCK_HZ;
+}
@@ -5,6 +5,8 @@
 
 #include "internal/timer_private.h"
 #include "internal/timer_reg.h"
+#include "rcc.h"
+#include <string.h>
 
 // Placeholder base addresses
 #define APB1PERIPH_BASE       0x40000000UL
@@ -18,8 +20,45 @@
 // --- Private function implementations for STM32F4 ---
 
 static void stm32f4_enable_clock(uint8_t instance_num) {
-    // Placeholder: A real implementation would use the RCC driver.
-    // e.g., rcc_enable_peripheral_clock(PERIPH_ID_TIM2);
+    switch (instance_num) {
+        case 1: rcc_enable_peripheral_clock(PERIPH_ID_TIM1); break;
+        case 2: rcc_enable_peripheral_clock(PERIPH_ID_TIM2); break;
+        case 3: rcc_enable_peripheral_clock(PERIPH_ID_TIM3); break;
+        case 4: rcc_enable_peripheral_clock(PERIPH_ID_TIM4); break;
+        case 5: rcc_enable_peripheral_clock(PERIPH_ID_TIM5); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief Keeps the counter rate of a timer across a system clock change.
+ * @details PSC is recomputed from the new input clock for the rate at init
+ *          and loaded with an update event. The update would clear the
+ *          counter, so the count is carried over and URS keeps the event
+ *          from raising an interrupt.
+ */
+static void timer_clock_listener(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change, void* p_context) {
+    struct timer_handle_t* handle = (struct timer_handle_t*)p_context;
+    if (phase != RCC_CLOCK_POST_CHANGE || !handle->context.is_initialized || handle->context.tick_hz == 0) {
+        return;
+    }
+    timer_reg_map_t* timer_regs = (timer_reg_map_t*)handle->port_hw_instance;
+    uint32_t input_hz = (handle->context.instance_num == 1) ? p_change->to.apb2_timer_hz : p_change->to.apb1_timer_hz;
+    uint32_t prescaler = (input_hz / handle->context.tick_hz) - 1;
+    memcpy((void*)&handle->config.prescaler, &prescaler, sizeof(prescaler));
+
+    timer_regs->PSC = prescaler;
+    timer_regs->CR1 |= TIM_CR1_URS;
+    uint32_t count = timer_regs->CNT;
+    timer_regs->EGR = TIM_EGR_UG;
+    timer_regs->CNT = count;
+    timer_regs->CR1 &= ~TIM_CR1_URS;
+}
+
+static void stm32f4_disable_clock(struct timer_handle_t* handle) {
+    // The handle goes back to the pool: drop the listener configure_core() registered
+    rcc_unregister_clock_listener(timer_clock_listener, handle);
+    // Placeholder for RCC clock disable
 }
 
 static void stm32f4_configure_core(struct timer_handle_t* handle) {
@@ -27,17 +66,23 @@ static void stm32f4_configure_core(struct timer_handle_t* handle) {
     const timer_config_t* config = &handle->config;
 
     // Set basic up-counting, edge-aligned mode with auto-reload preload enabled
-    timer_regs->CR1 = TIM_CR1_ARPE_Msk;
+    timer_regs->CR1 = TIM_CR1_ARPE;
     timer_regs->PSC = config->prescaler;
     timer_regs->ARR = config->period;
+
+    // PSC is buffered: force an update event so the new rate applies immediately
+    timer_regs->EGR = TIM_EGR_UG;
+    timer_regs->SR &= ~TIM_SR_UIF;
+
+    (void)rcc_register_clock_listener(timer_clock_listener, handle);
 }
 
 static void stm32f4_start(struct timer_handle_t* handle) {
-    ((timer_reg_map_t*)handle->port_hw_instance)->CR1 |= TIM_CR1_CEN_Msk;
+    ((timer_reg_map_t*)handle->port_hw_instance)->CR1 |= TIM_CR1_CEN;
 }
 
 static void stm32f4_stop(struct timer_handle_t* handle) {
-    ((timer_reg_map_t*)handle->port_hw_instance)->CR1 &= ~TIM_CR1_CEN_Msk;
+    ((timer_reg_map_t*)handle->port_hw_instance)->CR1 &= ~TIM_CR1_CEN;
 }
 
 static uint32_t stm32f4_get_counter(struct timer_handle_t* handle) {
@@ -45,24 +90,25 @@ static uint32_t stm32f4_get_counter(struct timer_handle_t* handle) {
 }
 
 static void stm32f4_enable_update_irq(struct timer_handle_t* handle) {
-    ((timer_reg_map_t*)handle->port_hw_instance)->DIER |= TIM_DIER_UIE_Msk;
+    ((timer_reg_map_t*)handle->port_hw_instance)->DIER |= TIM_DIER_UIE;
 }
 
 static void stm32f4_disable_update_irq(struct timer_handle_t* handle) {
-    ((timer_reg_map_t*)handle->port_hw_instance)->DIER &= ~TIM_DIER_UIE_Msk;
+    ((timer_reg_map_t*)handle->port_hw_instance)->DIER &= ~TIM_DIER_UIE;
 }
 
 static bool stm32f4_is_update_irq_flag_set(struct timer_handle_t* handle) {
-    return (((timer_reg_map_t*)handle->port_hw_instance)->SR & TIM_SR_UIF_Msk)!= 0;
+    return (((timer_reg_map_t*)handle->port_hw_instance)->SR & TIM_SR_UIF)!= 0;
 }
 
 static void stm32f4_clear_update_irq_flag(struct timer_handle_t* handle) {
-    ((timer_reg_map_t*)handle->port_hw_instance)->SR &= ~TIM_SR_UIF_Msk;
+    ((timer_reg_map_t*)handle->port_hw_instance)->SR &= ~TIM_SR_UIF;
 }
 
 // --- The concrete port interface for STM32F4 ---
 static const timer_port_interface_t stm32f4_port_api = {
    .enable_clock = stm32f4_enable_clock,
+   .disable_clock = stm32f4_disable_clock,
    .configure_core = stm32f4_configure_core,
    .start = stm32f4_start,
    .stop = stm32f4_stop,
@@ -89,3 +135,15 @@ void* timer_port_get_base_addr(uint8_t instance_num) {
         default: return NULL;
     }
 }
+
+uint32_t timer_port_get_clock_freq(uint8_t instance_num) {
+    // CK_INT is twice the bus clock whenever the APB is divided
+    switch (instance_num) {
+        case 1: return rcc_get_apb2_timer_frequency();
+        case 2: // Fallthrough
+        case 3: // Fallthrough
+        case 4: // Fallthrough
+        case 5: return rcc_get_apb1_timer_frequency();
+        default: return 0;
+    }
+}
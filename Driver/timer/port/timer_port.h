@@ -10,6 +10,7 @@ struct timer_handle_t;
 
 typedef struct {
     void (*enable_clock)(uint8_t instance_num);
+    void (*disable_clock)(struct timer_handle_t* handle);
     void (*configure_core)(struct timer_handle_t* handle);
     void (*start)(struct timer_handle_t* handle);
     void (*stop)(struct timer_handle_t* handle);
@@ -24,5 +25,6 @@ typedef struct {
 
 const timer_port_interface_t* timer_port_get_api(void);
 void* timer_port_get_base_addr(uint8_t instance_num);
+uint32_t timer_port_get_clock_freq(uint8_t instance_num);
 
 #endif // TIMER_PORT_H
@@ -0,0 +1,89 @@
+/**
+ * @file      test_timer_posix.c
+ * @brief     Host test of the Timer driver on its POSIX port.
+ *
+ * @details   Runs a timer the way runtime_stats.c runs TIM5: a prescaler
+ *            derived from timer_get_input_clock_hz() for a 1 MHz count, and
+ *            checks the count against CLOCK_MONOTONIC, that a stopped timer
+ *            holds its count, and that a short period raises the update flag.
+ */
+
+#include "timer.h"
+#include "unit_test.h"
+
+#include <time.h>
+
+#define TICK_HZ             1000000UL
+#define SLEEP_US            20000UL
+
+static void sleep_us(unsigned long us) {
+    struct timespec ts = {.tv_sec = (time_t)(us / 1000000UL), .tv_nsec = (long)((us % 1000000UL) * 1000UL)};
+    nanosleep(&ts, NULL);
+}
+
+static void test_free_running(void) {
+    uint32_t input_hz = timer_get_input_clock_hz(5);
+    TEST_CHECK(input_hz >= TICK_HZ);
+
+    timer_config_t config = {.prescaler = (input_hz / TICK_HZ) - 1, .period = 0xFFFFFFFFUL};
+    timer_handle_t timer = timer_init(5, &config);
+    TEST_CHECK(timer != NULL);
+    if (timer == NULL) {
+        return;
+    }
+
+    TEST_CHECK(timer_get_counter(timer) == 0);      // Not started yet
+    timer_start(timer);
+    uint32_t start = timer_get_counter(timer);
+    sleep_us(SLEEP_US);
+    uint32_t elapsed = timer_get_counter(timer) - start;
+    // At least the sleep; the upper bound leaves room for a loaded host
+    TEST_CHECK(elapsed >= SLEEP_US);
+    TEST_CHECK(elapsed < SLEEP_US * 20);
+
+    timer_stop(timer);
+    uint32_t held = timer_get_counter(timer);
+    sleep_us(SLEEP_US / 4);
+    TEST_CHECK(timer_get_counter(timer) == held);
+
+    timer_start(timer);
+    sleep_us(SLEEP_US / 4);
+    TEST_CHECK(timer_get_counter(timer) > held);    // Counts on from where it stopped
+
+    timer_deinit(&timer);
+    TEST_CHECK(timer == NULL);
+}
+
+static void test_update_flag(void) {
+    uint32_t input_hz = timer_get_input_clock_hz(2);
+    timer_config_t config = {.prescaler = (input_hz / TICK_HZ) - 1, .period = 999};   // 1 ms
+    timer_handle_t timer = timer_init(2, &config);
+    TEST_CHECK(timer != NULL);
+    if (timer == NULL) {
+        return;
+    }
+
+    timer_start(timer);
+    TEST_CHECK(!timer_is_update_interrupt_flag_set(timer));
+    sleep_us(5000);
+    TEST_CHECK(timer_is_update_interrupt_flag_set(timer));
+    TEST_CHECK(timer_get_counter(timer) <= config.period);
+    timer_clear_update_interrupt_flag(timer);
+    TEST_CHECK(!timer_is_update_interrupt_flag_set(timer) || timer_get_counter(timer) < config.period);
+
+    timer_deinit(&timer);
+}
+
+static void test_invalid_instance(void) {
+    timer_config_t config = {.prescaler = 0, .period = 0xFFFFFFFFUL};
+    TEST_CHECK(timer_get_input_clock_hz(0) == 0);
+    TEST_CHECK(timer_init(0, &config) == NULL);
+    TEST_CHECK(timer_init(5, NULL) == NULL);
+}
+
+int main(void) {
+    test_free_running();
+    test_update_flag();
+    test_invalid_instance();
+    return TEST_EXIT();
+}
@@ -7,8 +7,8 @@
 #include <string.h>
 
 // --- Static Data ---
-static struct timer_handle_t s_handle_pool;
-static bool s_is_handle_in_use = {false};
+static struct timer_handle_t s_handle_pool[TIMER_MAX_INSTANCES];
+static bool s_is_handle_in_use[TIMER_MAX_INSTANCES] = {false};
 
 // --- Private Helper Functions ---
 static struct timer_handle_t* allocate_handle(void) {
@@ -46,14 +46,14 @@ timer_handle_t timer_init(uint8_t instance_num, const timer_config_t* config) {
     *(const timer_port_interface_t**)&handle->port_api = timer_port_get_api();
     *(void**)&handle->port_hw_instance = timer_port_get_base_addr(instance_num);
 
-    if (handle->port_api == NULL |
-
-| handle->port_hw_instance == NULL) {
+    if (handle->port_api == NULL || handle->port_hw_instance == NULL) {
         release_handle(handle);
         return NULL;
     }
 
     memcpy((void*)&handle->config, config, sizeof(timer_config_t));
+    handle->context.instance_num = instance_num;
+    handle->context.tick_hz = timer_port_get_clock_freq(instance_num) / (config->prescaler + 1);
 
     handle->port_api->enable_clock(instance_num);
     handle->port_api->configure_core(handle);
@@ -65,7 +65,8 @@ timer_handle_t timer_init(uint8_t instance_num, const timer_config_t* config) {
 void timer_deinit(timer_handle_t* p_handle) {
     if (p_handle!= NULL && *p_handle!= NULL) {
         timer_stop(*p_handle);
-        // Add disable_clock if implemented
+        (*p_handle)->context.is_initialized = false;
+        (*p_handle)->port_api->disable_clock(*p_handle);
         release_handle(*p_handle);
         *p_handle = NULL;
     }
@@ -90,6 +91,10 @@ uint32_t timer_get_counter(timer_handle_t handle) {
     return 0;
 }
 
+uint32_t timer_get_input_clock_hz(uint8_t instance_num) {
+    return timer_port_get_clock_freq(instance_num);
+}
+
 void timer_enable_update_interrupt(timer_handle_t handle) {
     if (handle && handle->context.is_initialized) {
         handle->port_api->enable_update_irq(handle);
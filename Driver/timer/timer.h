@@ -58,10 +58,24 @@ typedef struct {
     uint32_t ICFilter;        // 0-15 (TIMx_CCMRx: ICxF)
 } TIM_IC_Init_t;
 
+/**
+ * @brief Runtime configuration passed to timer_init().
+ * @details The counter runs at (input_clock / (prescaler + 1)) and wraps
+ *          after reaching `period`. Use timer_get_input_clock_hz() to derive
+ *          the prescaler for a desired tick rate.
+ */
+typedef struct {
+    uint32_t prescaler;       // Sets TIMx_PSC
+    uint32_t period;          // Sets TIMx_ARR (0xFFFFFFFF for a free-running 32-bit counter)
+} timer_config_t;
+
 /* --- Public API Functions --- */
 
 /**
  * @brief Initializes and configures a general-purpose timer.
+ * @details The counter rate set here is kept across rcc_set_sysclk(): the
+ *          STM32 port recomputes the prescaler for the new input clock and
+ *          carries the count over.
  *
  * @param[in] instance_num The hardware instance number (e.g., 2 for TIM2).
  * @param[in] config Pointer to the configuration structure for the timer.
@@ -96,6 +110,15 @@ void timer_stop(timer_handle_t handle);
  */
 uint32_t timer_get_counter(timer_handle_t handle);
 
+/**
+ * @brief Gets the counter input clock (CK_INT) of a timer instance.
+ * @details On the STM32F4 the APB timer clocks run at twice the bus clock
+ *          whenever the bus prescaler is not 1.
+ * @param[in] instance_num The hardware instance number (e.g., 5 for TIM5).
+ * @return The timer input clock in Hz, or 0 for an invalid instance.
+ */
+uint32_t timer_get_input_clock_hz(uint8_t instance_num);
+
 /**
  * @brief Enables the update interrupt for the timer.
  * @details The update interrupt is typically generated on counter overflow.
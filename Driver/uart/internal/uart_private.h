@@ -10,13 +10,29 @@
 #include "uart.h"
 #include "uart_config.h"
 #include "port/uart_port.h"
+#include "dma.h"
 
 /**
  * @brief Internal runtime state for a UART instance.
+ * @note  The ring counters run freely and wrap at 2^32; the ring sizes are
+ *        powers of two, so `counter & (size - 1)` is always the index.
  */
 typedef struct {
     bool is_initialized;
-    // Add other runtime state here (e.g., buffer pointers, error flags)
+    bool is_async;
+    dma_handle_t dma_rx;
+    dma_handle_t dma_tx;
+    uint8_t dma_channel;
+    uart_async_config_t async;
+    // RX ring: the DMA produces, uart_read_async() consumes
+    volatile uint32_t rx_written;       // Bytes the DMA has written, published by the interrupts
+    uint32_t rx_read;                   // Bytes consumed by the reader
+    uint32_t rx_last_pos;               // DMA position at the last publish, used by the interrupts
+    // TX ring: the writer task produces, the DMA consumes
+    volatile uint32_t tx_head;          // Bytes committed, written by the writer only
+    volatile uint32_t tx_tail;          // Bytes sent, written by the interrupt only
+    volatile uint32_t tx_chunk;         // Bytes of the running DMA transfer, 0 when idle
+    volatile uart_stats_t stats;
 } uart_context_t;
 
 /**
@@ -31,4 +47,16 @@ struct uart_handle_t {
     void* port_hw_instance;               // Pointer to peripheral registers (e.g., USART1)
 };
 
+/**
+ * @brief Services the USART interrupt of the asynchronous mode (idle line, errors).
+ * @note  Called by the port from the USART interrupt handler.
+ */
+void uart_irq_handler(struct uart_handle_t* handle);
+
+/**
+ * @brief Services the DMA interrupts of the asynchronous mode.
+ * @note  Called by the port from the RX and TX stream interrupt handlers.
+ */
+void uart_dma_irq_handler(struct uart_handle_t* handle);
+
 #endif // UART_PRIVATE_H
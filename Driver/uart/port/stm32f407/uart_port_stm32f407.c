@@ -5,6 +5,7 @@
 
 #include "internal/uart_private.h"
 #include "internal/uart_reg.h"
+#include "rcc.h"
 
 // These would typically be in a separate, higher-level MCU header
 #define PERIPH_BASE           0x40000000UL
@@ -14,8 +15,39 @@
 #define USART2_BASE           (APB1PERIPH_BASE + 0x4400UL)
 #define USART6_BASE           (APB2PERIPH_BASE + 0x1400UL)
 
+// USART1 RX on DMA2 Stream5 and TX on DMA2 Stream7, both channel 4. The
+// alternatives (DMA2 Stream2 RX, USART2/6 streams) collide with SPI1 and
+// the I2S audio streams, so only USART1 runs asynchronously.
+#define USART1_DMA_NUM        2
+#define USART1_DMA_RX_STREAM  5
+#define USART1_DMA_TX_STREAM  7
+#define USART1_DMA_CHANNEL    4
+#define USART1_IRQN           37
+#define USART1_DMA_RX_IRQN    68
+#define USART1_DMA_TX_IRQN    70
+
+#define NVIC_ISER(n)          (((volatile uint32_t*)0xE000E100UL)[n])
+#define NVIC_IPR(n)           (((volatile uint8_t*)0xE000E400UL)[n])
+#define NVIC_PRIO_BITS        4
+
+static struct uart_handle_t* s_usart1_async_handle = NULL;
+
 // --- Private function implementations for STM32F4 ---
 
+static uint8_t instance_of(const struct uart_handle_t* handle) {
+    if (handle->port_hw_instance == (void*)USART1_BASE) {
+        return 1;
+    } else if (handle->port_hw_instance == (void*)USART6_BASE) {
+        return 6;
+    }
+    return 2;
+}
+
+static uint32_t compute_brr(const struct uart_handle_t* handle, uint32_t baud_rate) {
+    uint32_t clock_freq = uart_port_get_clock_freq(instance_of(handle));
+    return (clock_freq + (baud_rate / 2)) / baud_rate;
+}
+
 static void stm32f4_enable(struct uart_handle_t* handle) {
     uart_reg_map_t* uart_regs = (uart_reg_map_t*)handle->port_hw_instance;
     uart_regs->CR1 |= USART_CR1_UE_Msk;
@@ -74,8 +106,7 @@ static void stm32f4_configure_core(struct uart_handle_t* handle) {
     }
 
     // Baud Rate
-    uint32_t clock_freq = uart_port_get_clock_freq(1); // Assuming instance 1 for now
-    uart_regs->BRR = (clock_freq + (config->baud_rate / 2)) / config->baud_rate;
+    uart_regs->BRR = compute_brr(handle, config->baud_rate);
 
     // Apply configuration
     uart_regs->CR1 = cr1 | USART_CR1_TE_Msk | USART_CR1_RE_Msk;
@@ -83,13 +114,31 @@ static void stm32f4_configure_core(struct uart_handle_t* handle) {
     uart_regs->CR3 = cr3;
 }
 
+static void stm32f4_set_baud_rate(struct uart_handle_t* handle, uint32_t baud_rate);
+
+/**
+ * @brief Recomputes BRR for the new bus clock after a system clock change.
+ * @note  Bytes on the wire while the PLL relocks are lost.
+ */
+static void uart_clock_listener(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change, void* p_context) {
+    struct uart_handle_t* handle = (struct uart_handle_t*)p_context;
+    (void)p_change;
+    if (phase == RCC_CLOCK_POST_CHANGE && handle->context.is_initialized) {
+        stm32f4_set_baud_rate(handle, handle->config.baud_rate);
+    }
+}
+
 static void stm32f4_enable_clock(struct uart_handle_t* handle) {
-    // NOTE: This is a placeholder. A real implementation would use the RCC
-    // peripheral driver to enable the clock for the specific USART instance.
-    // For example: rcc_periph_clock_enable(RCC_USART1);
+    switch (instance_of(handle)) {
+        case 1: rcc_enable_peripheral_clock(PERIPH_ID_USART1); break;
+        case 6: rcc_enable_peripheral_clock(PERIPH_ID_USART6); break;
+        default: rcc_enable_peripheral_clock(PERIPH_ID_USART2); break;
+    }
+    (void)rcc_register_clock_listener(uart_clock_listener, handle);
 }
 
 static void stm32f4_disable_clock(struct uart_handle_t* handle) {
+    rcc_unregister_clock_listener(uart_clock_listener, handle);
     // Placeholder for RCC clock disable
 }
 
@@ -98,6 +147,114 @@ static void stm32f4_init_pins(struct uart_handle_t* handle) {
     // driver to configure the TX and RX pins for their alternate function.
 }
 
+static void stm32f4_set_baud_rate(struct uart_handle_t* handle, uint32_t baud_rate) {
+    uart_reg_map_t* uart_regs = (uart_reg_map_t*)handle->port_hw_instance;
+    // BRR may only change with the USART disabled; the DMA streams keep running
+    uart_regs->CR1 &= ~USART_CR1_UE_Msk;
+    uart_regs->BRR = compute_brr(handle, baud_rate);
+    uart_regs->CR1 |= USART_CR1_UE_Msk;
+}
+
+static void stm32f4_wait_tx_complete(struct uart_handle_t* handle) {
+    uart_reg_map_t* uart_regs = (uart_reg_map_t*)handle->port_hw_instance;
+    while (!(uart_regs->SR & USART_SR_TC_Msk));
+}
+
+static bool stm32f4_get_dma_map(struct uart_handle_t* handle, uart_dma_map_t* p_map) {
+    if (handle->port_hw_instance != (void*)USART1_BASE) {
+        return false;
+    }
+    p_map->dma_num = USART1_DMA_NUM;
+    p_map->rx_stream = USART1_DMA_RX_STREAM;
+    p_map->tx_stream = USART1_DMA_TX_STREAM;
+    p_map->channel = USART1_DMA_CHANNEL;
+    return true;
+}
+
+static volatile void* stm32f4_get_data_register(struct uart_handle_t* handle) {
+    uart_reg_map_t* uart_regs = (uart_reg_map_t*)handle->port_hw_instance;
+    return &uart_regs->DR;
+}
+
+static void stm32f4_enable_dma_requests(struct uart_handle_t* handle) {
+    uart_reg_map_t* uart_regs = (uart_reg_map_t*)handle->port_hw_instance;
+    (void)uart_regs->SR;
+    (void)uart_regs->DR; // Drop a byte received before the RX stream was ready
+    uart_regs->CR3 |= USART_CR3_DMAR_Msk | USART_CR3_DMAT_Msk;
+}
+
+static void stm32f4_enable_irqs(struct uart_handle_t* handle) {
+    if (handle->port_hw_instance != (void*)USART1_BASE) {
+        return;
+    }
+    uart_reg_map_t* uart_regs = (uart_reg_map_t*)handle->port_hw_instance;
+    s_usart1_async_handle = handle;
+    NVIC_IPR(USART1_IRQN) = (uint8_t)(UART_IRQ_PRIORITY << (8 - NVIC_PRIO_BITS));
+    NVIC_IPR(USART1_DMA_RX_IRQN) = (uint8_t)(UART_IRQ_PRIORITY << (8 - NVIC_PRIO_BITS));
+    NVIC_IPR(USART1_DMA_TX_IRQN) = (uint8_t)(UART_IRQ_PRIORITY << (8 - NVIC_PRIO_BITS));
+    NVIC_ISER(USART1_IRQN / 32) = (1UL << (USART1_IRQN % 32));
+    NVIC_ISER(USART1_DMA_RX_IRQN / 32) = (1UL << (USART1_DMA_RX_IRQN % 32));
+    NVIC_ISER(USART1_DMA_TX_IRQN / 32) = (1UL << (USART1_DMA_TX_IRQN % 32));
+
+    // Idle line, and with DMAR set, EIE covers overrun, noise and framing errors
+    uart_regs->CR1 |= USART_CR1_IDLEIE_Msk;
+    uart_regs->CR3 |= USART_CR3_EIE_Msk;
+}
+
+static uint32_t stm32f4_take_line_events(struct uart_handle_t* handle) {
+    uart_reg_map_t* uart_regs = (uart_reg_map_t*)handle->port_hw_instance;
+    uint32_t sr = uart_regs->SR;
+    uint32_t events = 0;
+
+    if (sr & (USART_SR_IDLE_Msk | USART_SR_ORE_Msk | USART_SR_NE_Msk | USART_SR_FE_Msk)) {
+        // Reading SR then DR clears these flags; the DMA has already taken the data
+        (void)uart_regs->DR;
+        if (sr & USART_SR_IDLE_Msk) {
+            events |= UART_LINE_IDLE;
+        }
+        if (sr & (USART_SR_ORE_Msk | USART_SR_NE_Msk | USART_SR_FE_Msk)) {
+            events |= UART_LINE_ERROR;
+        }
+    }
+    return events;
+}
+
+static uint32_t stm32f4_irq_lock(void) {
+    uint32_t primask = 0;
+#if defined(__arm__)
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+#endif
+    return primask;     // Host builds (register-fake tests) have no interrupts to mask
+}
+
+static void stm32f4_irq_unlock(uint32_t state) {
+#if defined(__arm__)
+    __asm volatile ("msr primask, %0" :: "r" (state) : "memory");
+#else
+    (void)state;
+#endif
+}
+
+// --- Interrupt Handlers ---
+
+void USART1_IRQHandler(void) {
+    if (s_usart1_async_handle) {
+        uart_irq_handler(s_usart1_async_handle);
+    }
+}
+
+void DMA2_Stream5_IRQHandler(void) {
+    if (s_usart1_async_handle) {
+        uart_dma_irq_handler(s_usart1_async_handle);
+    }
+}
+
+void DMA2_Stream7_IRQHandler(void) {
+    if (s_usart1_async_handle) {
+        uart_dma_irq_handler(s_usart1_async_handle);
+    }
+}
+
 // --- The concrete port interface for STM32F4 ---
 static const uart_port_interface_t stm32f4_port_api = {
    .enable_clock = stm32f4_enable_clock,
@@ -108,6 +265,15 @@ static const uart_port_interface_t stm32f4_port_api = {
    .read_byte_blocking = stm32f4_read_byte_blocking,
    .enable = stm32f4_enable,
    .disable = stm32f4_disable,
+   .set_baud_rate = stm32f4_set_baud_rate,
+   .wait_tx_complete = stm32f4_wait_tx_complete,
+   .get_dma_map = stm32f4_get_dma_map,
+   .get_data_register = stm32f4_get_data_register,
+   .enable_dma_requests = stm32f4_enable_dma_requests,
+   .enable_irqs = stm32f4_enable_irqs,
+   .take_line_events = stm32f4_take_line_events,
+   .irq_lock = stm32f4_irq_lock,
+   .irq_unlock = stm32f4_irq_unlock,
 };
 
 // --- Public functions provided by the port ---
@@ -131,14 +297,10 @@ void* uart_port_get_base_addr_for_instance(uint8_t instance_num) {
 }
 
 uint32_t uart_port_get_clock_freq(uint8_t instance_num) {
-    // NOTE: Placeholder. A real implementation would query the RCC driver
-    // to get the actual peripheral clock frequency.
-    // Assuming APB2 clock is 84MHz for USART1/6 and APB1 is 42MHz for USART2
-    if (instance_num == 1 |
-
-| instance_num == 6) {
-        return 84000000;
+    // USART1/6 are on APB2, USART2 on APB1
+    if (instance_num == 1 || instance_num == 6) {
+        return rcc_get_apb2_frequency();
     } else {
-        return 42000000;
+        return rcc_get_apb1_frequency();
     }
 }
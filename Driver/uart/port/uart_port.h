@@ -9,6 +9,20 @@
 // Forward declare the handle struct to avoid circular dependencies.
 struct uart_handle_t;
 
+/**
+ * @brief DMA streams serving one UART instance.
+ */
+typedef struct {
+    uint8_t dma_num;
+    uint8_t rx_stream;
+    uint8_t tx_stream;
+    uint8_t channel;
+} uart_dma_map_t;
+
+/** @brief Line events returned by take_line_events(). */
+#define UART_LINE_IDLE      (1U << 0)   // The line went idle after a frame
+#define UART_LINE_ERROR     (1U << 1)   // Framing, noise or overrun error
+
 /**
  * @brief A structure of function pointers that defines the hardware-dependent
  *        operations required by the UART driver.
@@ -22,6 +36,15 @@ typedef struct {
     uint8_t (*read_byte_blocking)(struct uart_handle_t* handle);
     void (*enable)(struct uart_handle_t* handle);
     void (*disable)(struct uart_handle_t* handle);
+    void (*set_baud_rate)(struct uart_handle_t* handle, uint32_t baud_rate);
+    void (*wait_tx_complete)(struct uart_handle_t* handle);
+    bool (*get_dma_map)(struct uart_handle_t* handle, uart_dma_map_t* p_map);
+    volatile void* (*get_data_register)(struct uart_handle_t* handle);
+    void (*enable_dma_requests)(struct uart_handle_t* handle);
+    void (*enable_irqs)(struct uart_handle_t* handle);
+    uint32_t (*take_line_events)(struct uart_handle_t* handle); // Reads and clears UART_LINE_* flags
+    uint32_t (*irq_lock)(void);
+    void (*irq_unlock)(uint32_t state);
 } uart_port_interface_t;
 
 /* --- Functions to be provided by the concrete port implementation --- */
@@ -86,6 +86,13 @@ void uart_deinit(uart_handle_t* p_handle) {
 
     uart_handle_t handle = *p_handle;
     if (handle->context.is_initialized) {
+        if (handle->context.is_async) {
+            dma_stop_transfer(handle->context.dma_rx);
+            dma_stop_transfer(handle->context.dma_tx);
+            dma_deinit(&handle->context.dma_rx);
+            dma_deinit(&handle->context.dma_tx);
+            handle->context.is_async = false;
+        }
         handle->port_api->disable(handle);
         handle->port_api->disable_clock(handle);
         handle->context.is_initialized = false;
@@ -96,8 +103,9 @@ void uart_deinit(uart_handle_t* p_handle) {
 }
 
 int uart_write_blocking(uart_handle_t handle, const uint8_t* p_data, size_t len) {
-    if (handle == NULL || p_data == NULL ||!handle->context.is_initialized) {
-        return -1; // Invalid arguments
+    if (handle == NULL || p_data == NULL ||!handle->context.is_initialized ||
+        handle->context.is_async) {
+        return -1; // Invalid arguments, or the DMA owns the data register
     }
 
     for (size_t i = 0; i < len; ++i) {
@@ -108,8 +116,9 @@ int uart_write_blocking(uart_handle_t handle, const uint8_t* p_data, size_t len)
 }
 
 int uart_read_blocking(uart_handle_t handle, uint8_t* p_data, size_t len) {
-    if (handle == NULL || p_data == NULL ||!handle->context.is_initialized) {
-        return -1; // Invalid arguments
+    if (handle == NULL || p_data == NULL ||!handle->context.is_initialized ||
+        handle->context.is_async) {
+        return -1; // Invalid arguments, or the DMA owns the data register
     }
 
     for (size_t i = 0; i < len; ++i) {
@@ -118,3 +127,299 @@ int uart_read_blocking(uart_handle_t handle, uint8_t* p_data, size_t len) {
 
     return 0;
 }
+
+// --- Asynchronous Mode ---
+
+static bool is_power_of_two(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+/**
+ * @brief Publishes the bytes the RX DMA has written since the last call.
+ * @note  Runs in the USART and DMA interrupts, which share one priority.
+ */
+static void rx_publish(struct uart_handle_t* handle) {
+    uart_context_t* ctx = &handle->context;
+    uint32_t size = (uint32_t)ctx->async.rx_size;
+
+    // NDTR counts down from size and reloads at the wrap
+    uint32_t pos = size - dma_get_remaining_count(ctx->dma_rx);
+    uint32_t received = (pos - ctx->rx_last_pos) & (size - 1);
+    if (received == 0) {
+        return;
+    }
+    ctx->rx_last_pos = pos & (size - 1);
+    ctx->rx_written += received;
+    ctx->stats.rx_bytes += received;
+    ctx->stats.rx_events++;
+    if (ctx->async.callback) {
+        ctx->async.callback(ctx->async.p_context, UART_EVENT_RX_DATA);
+    }
+}
+
+/**
+ * @brief Sends the next contiguous run of the TX ring, if any.
+ * @note  Runs in the DMA interrupt or with interrupts locked, and only
+ *        while no TX transfer is running.
+ */
+static void tx_start_chunk(struct uart_handle_t* handle) {
+    uart_context_t* ctx = &handle->context;
+    uint32_t size = (uint32_t)ctx->async.tx_size;
+    uint32_t tail = ctx->tx_tail;
+    uint32_t pending = ctx->tx_head - tail;
+
+    if (pending == 0) {
+        ctx->tx_chunk = 0;
+        return;
+    }
+    uint32_t index = tail & (size - 1);
+    uint32_t chunk = size - index;
+    if (chunk > pending) {
+        chunk = pending;
+    }
+    if (chunk > 0xFFFF) {
+        chunk = 0xFFFF;
+    }
+    ctx->tx_chunk = chunk;
+    dma_start_transfer(ctx->dma_tx, &ctx->async.p_tx_buffer[index],
+                       (void*)handle->port_api->get_data_register(handle), (uint16_t)chunk);
+}
+
+void uart_irq_handler(struct uart_handle_t* handle) {
+    uint32_t events = handle->port_api->take_line_events(handle);
+    if (events & UART_LINE_ERROR) {
+        handle->context.stats.errors++;
+    }
+    if (events & UART_LINE_IDLE) {
+        rx_publish(handle);
+    }
+}
+
+void uart_dma_irq_handler(struct uart_handle_t* handle) {
+    uart_context_t* ctx = &handle->context;
+
+    // RX: half and full ring, and errors; the stream keeps running
+    bool rx_error = dma_is_interrupt_flag_set(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_ERROR);
+    if (dma_is_interrupt_flag_set(ctx->dma_rx, DMA_INTERRUPT_HALF_TRANSFER) ||
+        dma_is_interrupt_flag_set(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_COMPLETE) || rx_error) {
+        dma_clear_interrupt_flag(ctx->dma_rx, DMA_INTERRUPT_HALF_TRANSFER);
+        dma_clear_interrupt_flag(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+        dma_clear_interrupt_flag(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_ERROR);
+        if (rx_error) {
+            ctx->stats.errors++;
+        }
+        rx_publish(handle);
+    }
+
+    // TX: one chunk finished (or failed, in which case its bytes are dropped)
+    bool tx_error = dma_is_interrupt_flag_set(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_ERROR);
+    if (dma_is_interrupt_flag_set(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_COMPLETE) || tx_error) {
+        dma_clear_interrupt_flag(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+        dma_clear_interrupt_flag(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_ERROR);
+        if (ctx->tx_chunk == 0) {
+            return;
+        }
+        if (tx_error) {
+            ctx->stats.errors++;
+        } else {
+            ctx->stats.tx_bytes += ctx->tx_chunk;
+        }
+        ctx->stats.tx_chunks++;
+        ctx->tx_tail += ctx->tx_chunk;
+        tx_start_chunk(handle);
+        if (ctx->async.callback) {
+            ctx->async.callback(ctx->async.p_context, UART_EVENT_TX_DONE);
+        }
+    }
+}
+
+int uart_start_async(uart_handle_t handle, const uart_async_config_t* config) {
+    if (handle == NULL || !handle->context.is_initialized || handle->context.is_async || config == NULL ||
+        config->p_rx_buffer == NULL || config->p_tx_buffer == NULL ||
+        !is_power_of_two(config->rx_size) || !is_power_of_two(config->tx_size) || config->rx_size > 0x10000) {
+        return -1;
+    }
+
+    uart_dma_map_t map;
+    if (!handle->port_api->get_dma_map(handle, &map)) {
+        return -1;
+    }
+    uart_context_t* ctx = &handle->context;
+    const dma_config_t rx_config = {
+        .channel = map.channel,
+        .direction = DMA_DIRECTION_PERIPHERAL_TO_MEMORY,
+        .priority = DMA_PRIORITY_LOW,
+        .memory_increment = true,
+        .circular_mode = true,
+    };
+    const dma_config_t tx_config = {
+        .channel = map.channel,
+        .direction = DMA_DIRECTION_MEMORY_TO_PERIPHERAL,
+        .priority = DMA_PRIORITY_LOW,
+        .memory_increment = true,
+    };
+    ctx->dma_rx = dma_init(map.dma_num, map.rx_stream, &rx_config);
+    ctx->dma_tx = dma_init(map.dma_num, map.tx_stream, &tx_config);
+    if (ctx->dma_rx == NULL || ctx->dma_tx == NULL) {
+        dma_deinit(&ctx->dma_rx);
+        dma_deinit(&ctx->dma_tx);
+        return -1;
+    }
+
+    ctx->dma_channel = map.channel;
+    ctx->async = *config;
+    ctx->rx_written = 0;
+    ctx->rx_read = 0;
+    ctx->rx_last_pos = 0;
+    ctx->tx_head = 0;
+    ctx->tx_tail = 0;
+    ctx->tx_chunk = 0;
+    ctx->stats = (uart_stats_t){0};
+
+    dma_enable_interrupt(ctx->dma_rx, DMA_INTERRUPT_HALF_TRANSFER);
+    dma_enable_interrupt(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    dma_enable_interrupt(ctx->dma_rx, DMA_INTERRUPT_TRANSFER_ERROR);
+    dma_enable_interrupt(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    dma_enable_interrupt(ctx->dma_tx, DMA_INTERRUPT_TRANSFER_ERROR);
+
+    volatile void* data_register = handle->port_api->get_data_register(handle);
+    dma_start_transfer(ctx->dma_rx, (const void*)data_register, ctx->async.p_rx_buffer, (uint16_t)config->rx_size);
+    ctx->is_async = true;
+    handle->port_api->enable_irqs(handle);
+    handle->port_api->enable_dma_requests(handle);
+    return 0;
+}
+
+size_t uart_tx_reserve(uart_handle_t handle, uint8_t** pp_space) {
+    if (handle == NULL || !handle->context.is_async || pp_space == NULL) {
+        return 0;
+    }
+    uart_context_t* ctx = &handle->context;
+    uint32_t size = (uint32_t)ctx->async.tx_size;
+    uint32_t head = ctx->tx_head;
+    uint32_t free_bytes = size - (head - ctx->tx_tail);
+    uint32_t index = head & (size - 1);
+    uint32_t contiguous = size - index;
+
+    *pp_space = &ctx->async.p_tx_buffer[index];
+    return (contiguous < free_bytes) ? contiguous : free_bytes;
+}
+
+void uart_tx_commit(uart_handle_t handle, size_t len) {
+    if (handle == NULL || !handle->context.is_async || len == 0) {
+        return;
+    }
+    uart_context_t* ctx = &handle->context;
+
+    // Publish the bytes, then start the stream if the interrupt side is idle
+    ctx->tx_head += (uint32_t)len;
+    if (ctx->tx_chunk == 0) {
+        uint32_t state = handle->port_api->irq_lock();
+        if (ctx->tx_chunk == 0) {
+            tx_start_chunk(handle);
+        }
+        handle->port_api->irq_unlock(state);
+    }
+}
+
+size_t uart_write_async(uart_handle_t handle, const void* p_data, size_t len) {
+    const uint8_t* p_bytes = (const uint8_t*)p_data;
+    size_t queued = 0;
+
+    if (p_data == NULL) {
+        return 0;
+    }
+    // At most two runs: up to the end of the ring, then from its start
+    while (queued < len) {
+        uint8_t* p_space;
+        size_t space = uart_tx_reserve(handle, &p_space);
+        if (space == 0) {
+            break;
+        }
+        size_t n = (len - queued < space) ? len - queued : space;
+        memcpy(p_space, &p_bytes[queued], n);
+        uart_tx_commit(handle, n);
+        queued += n;
+    }
+    return queued;
+}
+
+size_t uart_tx_pending(uart_handle_t handle) {
+    if (handle == NULL || !handle->context.is_async) {
+        return 0;
+    }
+    return handle->context.tx_head - handle->context.tx_tail;
+}
+
+size_t uart_rx_available(uart_handle_t handle) {
+    if (handle == NULL || !handle->context.is_async) {
+        return 0;
+    }
+    uint32_t available = handle->context.rx_written - handle->context.rx_read;
+    return (available < handle->context.async.rx_size) ? available : handle->context.async.rx_size;
+}
+
+size_t uart_read_async(uart_handle_t handle, void* p_data, size_t len) {
+    if (handle == NULL || !handle->context.is_async || p_data == NULL) {
+        return 0;
+    }
+    uart_context_t* ctx = &handle->context;
+    uint32_t size = (uint32_t)ctx->async.rx_size;
+    uint32_t written = ctx->rx_written;
+    uint32_t available = written - ctx->rx_read;
+
+    // Lapped by the DMA: the oldest bytes are gone, and the half the DMA is
+    // filling now will be overwritten next, so resume half a ring back
+    if (available > size) {
+        uint32_t skip = available - size / 2;
+        ctx->stats.rx_dropped += skip;
+        ctx->rx_read += skip;
+        available -= skip;
+    }
+
+    uint8_t* p_bytes = (uint8_t*)p_data;
+    size_t copied = 0;
+    while (copied < len && available != 0) {
+        uint32_t index = ctx->rx_read & (size - 1);
+        uint32_t run = size - index;
+        if (run > available) {
+            run = available;
+        }
+        if (run > len - copied) {
+            run = (uint32_t)(len - copied);
+        }
+        memcpy(&p_bytes[copied], &ctx->async.p_rx_buffer[index], run);
+        copied += run;
+        ctx->rx_read += run;
+        available -= run;
+    }
+    return copied;
+}
+
+int uart_set_baud_rate(uart_handle_t handle, uint32_t baud_rate) {
+    if (handle == NULL || !handle->context.is_initialized || baud_rate == 0 || uart_tx_pending(handle) != 0) {
+        return -1;
+    }
+    handle->port_api->wait_tx_complete(handle);
+    handle->port_api->set_baud_rate(handle, baud_rate);
+    // Keep the configuration as the record of the current rate
+    memcpy((void*)&handle->config.baud_rate, &baud_rate, sizeof(baud_rate));
+    return 0;
+}
+
+uint32_t uart_get_baud_rate(uart_handle_t handle) {
+    return (handle == NULL) ? 0 : handle->config.baud_rate;
+}
+
+void uart_get_stats(uart_handle_t handle, uart_stats_t* p_stats) {
+    if (handle == NULL || p_stats == NULL) {
+        return;
+    }
+    const volatile uart_stats_t* p_src = &handle->context.stats;
+    p_stats->rx_bytes = p_src->rx_bytes;
+    p_stats->rx_dropped = p_src->rx_dropped;
+    p_stats->rx_events = p_src->rx_events;
+    p_stats->tx_bytes = p_src->tx_bytes;
+    p_stats->tx_chunks = p_src->tx_chunks;
+    p_stats->errors = p_src->errors;
+}
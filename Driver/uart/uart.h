@@ -64,6 +64,47 @@ typedef struct {
     uart_flow_control_t flow_control; //!< Hardware flow control setting.
 } uart_config_t;
 
+/** @brief Events reported to the asynchronous-mode callback. */
+typedef enum {
+    UART_EVENT_RX_DATA = (1 << 0),  //!< New bytes are in the RX ring (half/full ring or idle line).
+    UART_EVENT_TX_DONE = (1 << 1),  //!< A DMA chunk was sent; the TX ring has more space.
+} uart_event_t;
+
+/**
+ * @brief Callback for asynchronous-mode events.
+ * @details Called from interrupt context.
+ *
+ * @param[in] p_context The context given in the asynchronous configuration.
+ * @param[in] events One or more uart_event_t flags.
+ */
+typedef void (*uart_event_callback_t)(void* p_context, uint32_t events);
+
+/**
+ * @brief Buffers and callback of the DMA-driven asynchronous mode.
+ * @details Both buffers are owned by the caller and must stay valid until
+ *          uart_deinit(). Their sizes must be powers of two.
+ */
+typedef struct {
+    uint8_t* p_rx_buffer;             //!< Circular DMA receive ring.
+    size_t rx_size;                   //!< At most 65536 bytes.
+    uint8_t* p_tx_buffer;             //!< Transmit ring drained by DMA.
+    size_t tx_size;
+    uart_event_callback_t callback;   //!< May be NULL.
+    void* p_context;                  //!< Passed to the callback.
+} uart_async_config_t;
+
+/**
+ * @brief Counters of the asynchronous mode.
+ */
+typedef struct {
+    uint32_t rx_bytes;                //!< Bytes received by DMA.
+    uint32_t rx_dropped;              //!< Bytes overwritten before they were read.
+    uint32_t rx_events;               //!< Half, full and idle-line interrupts with new data.
+    uint32_t tx_bytes;                //!< Bytes sent by DMA.
+    uint32_t tx_chunks;               //!< DMA transfers (one interrupt each).
+    uint32_t errors;                  //!< DMA transfer errors and framing, noise or overrun errors.
+} uart_stats_t;
+
 /* --- Public API Functions --- */
 
 /**
@@ -124,4 +165,109 @@ int uart_write_blocking(uart_handle_t handle, const uint8_t* p_data, size_t len)
  */
 int uart_read_blocking(uart_handle_t handle, uint8_t* p_data, size_t len);
 
+/**
+ * @brief Switches an instance to DMA-driven asynchronous mode.
+ *
+ * @details Reception runs continuously into the circular RX ring; the
+ *          half-transfer and transfer-complete interrupts and the USART
+ *          idle-line interrupt publish new bytes, so a short message is seen
+ *          as soon as the line goes quiet rather than when a buffer fills.
+ *
+ *          Transmission goes through a single-producer/single-consumer ring:
+ *          one writer task appends, and DMA drains the ring in contiguous
+ *          chunks. The indices are written by one side each, so the writer
+ *          never waits for the interrupt; only starting an idle DMA stream
+ *          briefly locks interrupts. With several writer tasks, the caller
+ *          serialises them.
+ *
+ *          The blocking calls are refused from then on.
+ *
+ * @param[in] handle The handle to the UART instance.
+ * @param[in] config Buffers and callback; copied.
+ *
+ * @return 0 on success, or -1 if the arguments are invalid or the instance
+ *         has no DMA streams.
+ */
+int uart_start_async(uart_handle_t handle, const uart_async_config_t* config);
+
+/**
+ * @brief Queues bytes for transmission without waiting.
+ * @param[in] handle The handle to a UART instance in asynchronous mode.
+ * @param[in] p_data Bytes to send.
+ * @param[in] len Number of bytes.
+ * @return Number of bytes queued; less than `len` when the TX ring is full.
+ */
+size_t uart_write_async(uart_handle_t handle, const void* p_data, size_t len);
+
+/**
+ * @brief Reserves contiguous space in the TX ring to be filled in place.
+ * @details Lets an encoder write straight into the ring with no staging
+ *          buffer. The space is sent once uart_tx_commit() is called.
+ *
+ * @param[in] handle The handle to a UART instance in asynchronous mode.
+ * @param[out] pp_space Start of the free space.
+ *
+ * @return Number of contiguous free bytes at *pp_space (0 if full). More
+ *         may be free at the start of the ring once these are committed.
+ */
+size_t uart_tx_reserve(uart_handle_t handle, uint8_t** pp_space);
+
+/**
+ * @brief Queues bytes written into space from uart_tx_reserve().
+ * @param[in] handle The handle to a UART instance in asynchronous mode.
+ * @param[in] len Bytes written, at most the reserved length.
+ */
+void uart_tx_commit(uart_handle_t handle, size_t len);
+
+/**
+ * @brief Gets the number of bytes queued or being sent.
+ * @param[in] handle The handle to a UART instance in asynchronous mode.
+ */
+size_t uart_tx_pending(uart_handle_t handle);
+
+/**
+ * @brief Copies received bytes out of the RX ring without waiting.
+ * @details One reader only. If the ring overflowed since the last call, the
+ *          oldest bytes are skipped and counted in uart_stats_t::rx_dropped.
+ *
+ * @param[in] handle The handle to a UART instance in asynchronous mode.
+ * @param[out] p_data Destination.
+ * @param[in] len Size of the destination.
+ *
+ * @return Number of bytes copied; 0 if none have arrived.
+ */
+size_t uart_read_async(uart_handle_t handle, void* p_data, size_t len);
+
+/**
+ * @brief Gets the number of received bytes waiting to be read.
+ * @param[in] handle The handle to a UART instance in asynchronous mode.
+ */
+size_t uart_rx_available(uart_handle_t handle);
+
+/**
+ * @brief Changes the baud rate.
+ * @details Waits for the transmitter to finish the byte in progress; refused
+ *          while the TX ring still holds data. Reception continues.
+ *
+ * @param[in] handle The handle to the UART instance.
+ * @param[in] baud_rate The new baud rate in Hz.
+ *
+ * @return 0 on success, or -1 if the arguments are invalid or TX is busy.
+ */
+int uart_set_baud_rate(uart_handle_t handle, uint32_t baud_rate);
+
+/**
+ * @brief Gets the current baud rate.
+ * @param[in] handle The handle to the UART instance.
+ * @return The baud rate in Hz, or 0 if the handle is invalid.
+ */
+uint32_t uart_get_baud_rate(uart_handle_t handle);
+
+/**
+ * @brief Copies the asynchronous-mode counters.
+ * @param[in] handle The handle to the UART instance.
+ * @param[out] p_stats Destination.
+ */
+void uart_get_stats(uart_handle_t handle, uart_stats_t* p_stats);
+
 #endif // UART_H
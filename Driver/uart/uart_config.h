@@ -0,0 +1,26 @@
+/**
+ * @file      uart_config.h
+ * @brief     Compile-time configuration for the UART driver.
+ */
+
+#ifndef UART_CONFIG_H
+#define UART_CONFIG_H
+
+/**
+ * @brief Defines the maximum number of UART instances the driver can manage.
+ * @details This sets the size of the static handle pool. Adjust based on
+ *          the number of UART peripherals you intend to use simultaneously.
+ */
+#define UART_MAX_INSTANCES 3
+
+/**
+ * @brief NVIC priority of the USART and DMA interrupts of the asynchronous
+ *        mode. All of them share one priority, so they never preempt each
+ *        other while updating the RX ring position.
+ * @note  Must not be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY if
+ *        event callbacks use the FreeRTOS FromISR API. Below the audio
+ *        interrupts, so console traffic never delays them.
+ */
+#define UART_IRQ_PRIORITY 7
+
+#endif // UART_CONFIG_H
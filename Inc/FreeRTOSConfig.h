@@ -44,6 +44,10 @@
 #if defined(__ICCARM__) || defined(__GNUC__) || defined(__CC_ARM)
 	#include <stdint.h>
 	extern uint32_t SystemCoreClock;
+	extern void runtime_stats_timer_init(void);
+	extern uint32_t runtime_stats_get_counter(void);
+	extern void low_power_pre_sleep(uint32_t* p_expected_idle_ticks);
+	extern void low_power_post_sleep(uint32_t expected_idle_ticks);
 #endif
 
 #define configUSE_PREEMPTION			1
@@ -52,7 +56,7 @@
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 5 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 130 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 75 * 1024 ) )
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 16 * 1024 ) )
 #define configMAX_TASK_NAME_LEN			( 10 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
@@ -64,10 +68,37 @@
 #define configUSE_MALLOC_FAILED_HOOK	0
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
-#define configGENERATE_RUN_TIME_STATS	0
+/* Index 0 carries the audio pipeline's notifications; index 1 is reserved for
+DMA memory service completions (dma_mem.h), index 2 for SPI transfers
+(spi_bus.h), index 3 for I2C transactions (i2c_bus.h) and index 4 for UART
+ring space and data (uart_bus.h), so none of them collide. */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES	5
+#define configSUPPORT_STATIC_ALLOCATION	1
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+#define configGENERATE_RUN_TIME_STATS	1
+#define configUSE_STATS_FORMATTING_FUNCTIONS	0
+
+/* Run-time stats clock: free-running 32-bit TIM5 at 1 MHz, see runtime_stats.c.
+At 1 MHz the 32-bit kernel counters wrap after ~71 minutes. */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	runtime_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()			runtime_stats_get_counter()
 
 #define configCPU_CLOCK_HZ   (SystemCoreClock)
 
+/* Tickless idle: the tick is suppressed while all tasks are blocked. The hooks
+in low_power.c choose WFI sleep while any DMA stream is active and STOP mode
+(timed by the RTC wakeup timer) otherwise. */
+#define configUSE_TICKLESS_IDLE					1
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP	2
+#define configPRE_SLEEP_PROCESSING( x )			low_power_pre_sleep( &( x ) )
+#define configPOST_SLEEP_PROCESSING( x )		low_power_post_sleep( x )
+
+/* Command interpreter (FreeRTOS_CLI.c): the console formats each part of a
+command's output into the shared output buffer. */
+#define configCOMMAND_INT_MAX_OUTPUT_SIZE		600
+#define configCOMMAND_INT_MAX_COMMANDS			32
+#define configCOMMAND_INT_MAX_PARAMETERS		8
+
 /* Software timer definitions. */
 #define configUSE_TIMERS				1
 #define configTIMER_TASK_PRIORITY		( 2 )
@@ -83,6 +114,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -119,5 +151,9 @@ standard names. */
 #define xPortPendSVHandler PendSV_Handler
 #define xPortSysTickHandler SysTick_Handler
 
+/* Kernel trace hooks (traceTASK_SWITCHED_IN, traceQUEUE_SEND, ...) recording
+into the RAM ring buffer of Middleware/Trace. */
+#include "trace_recorder.h"
+
 #endif /* FREERTOS_CONFIG_H */
 
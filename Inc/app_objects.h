@@ -0,0 +1,152 @@
+/**
+ * @file      app_objects.h
+ * @brief     Compile-time table of every kernel object the application creates.
+ *
+ * @details   Tasks, stream buffers, queues and mutexes are declared once in the
+ *            X-macro tables below. app_objects.c expands them into statically
+ *            allocated stacks, control blocks and storage areas, checks them
+ *            with static asserts, and creates the objects at boot with the
+ *            xxxCreateStatic() API, so no object depends on the FreeRTOS heap.
+ *
+ *            Each entry also declares its handle, named after the entry:
+ *            `<name>TaskHandle`, `<name>StreamHandle`, `<name>QueueHandle` and
+ *            `<name>MutexHandle`.
+ */
+
+#ifndef APP_OBJECTS_H
+#define APP_OBJECTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+
+#include "audio_config.h"
+
+/* --- Object Tables --- */
+
+/**
+ * @brief Tasks: X(name, entry function, kernel name, stack depth in words, priority)
+ */
+#define APP_TASK_TABLE(X) \
+    APP_AUDIO_IO_TASKS(X) \
+    X(dsp,         dspTask,         "dsp",      APP_DSP_STACK_DEPTH, configMAX_PRIORITIES - 2) \
+    X(sensor,      sensorTask,      "sensor",   256,  tskIDLE_PRIORITY + 1)     \
+    X(ui,          uiTask,          "ui",       configMINIMAL_STACK_SIZE, tskIDLE_PRIORITY) \
+    X(console,     vTaskConsole,    "console",  512,  tskIDLE_PRIORITY)
+
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 1)
+
+/* dspTask is woken by the I2S callbacks and works in the DMA buffers in place */
+#define APP_DSP_STACK_DEPTH     256
+#define APP_AUDIO_IO_TASKS(X)
+#define APP_STREAM_TABLE(X)
+
+#else
+
+/* dspTask holds one input and one output block on its stack */
+#define APP_DSP_STACK_DEPTH     1024
+#define APP_AUDIO_IO_TASKS(X) \
+    X(audioInput,  audioInputTask,  "audioIn",  256,  configMAX_PRIORITIES - 1) \
+    X(audioOutput, audioOutputTask, "audioOut", 256,  configMAX_PRIORITIES - 1)
+
+/* With the ASRC the output buffer holds its fill target plus jitter either side */
+#if (AUDIO_ASRC_ENABLE == 1)
+#define APP_PROCESSED_AUDIO_BLOCKS  3
+#else
+#define APP_PROCESSED_AUDIO_BLOCKS  2
+#endif
+
+/**
+ * @brief Stream buffers: X(name, trace name, size in bytes, trigger level in bytes)
+ * @note  Sized in audio blocks plus the one byte a stream buffer keeps free.
+ */
+#define APP_STREAM_TABLE(X) \
+    X(rawAudio,       "rawAudio",  AUDIO_BLOCK_BYTES * 2 + 1, AUDIO_BLOCK_BYTES) \
+    X(processedAudio, "procAudio", AUDIO_BLOCK_BYTES * APP_PROCESSED_AUDIO_BLOCKS + 1, AUDIO_BLOCK_BYTES)
+
+#endif // AUDIO_PIPELINE_DIRECT_NOTIFY
+
+/**
+ * @brief Queues: X(name, trace name, length, item size in bytes)
+ */
+#define APP_QUEUE_TABLE(X)
+
+/**
+ * @brief Mutexes: X(name, trace name)
+ */
+#define APP_MUTEX_TABLE(X) \
+    X(dspParams, "paramsMtx")                \
+    X(uartTx,    "uartTxMtx")
+
+/** @brief Upper bound for the RAM used by all objects in the tables, in bytes. */
+#ifndef APP_OBJECTS_RAM_BUDGET
+#define APP_OBJECTS_RAM_BUDGET      (24 * 1024)
+#endif
+
+/* --- Generated Declarations --- */
+
+#define APP_DECLARE_TASK(name, fn, label, depth, prio) \
+    void fn(void* argument);                           \
+    extern TaskHandle_t name##TaskHandle;
+#define APP_DECLARE_STREAM(name, label, size, trigger) \
+    extern StreamBufferHandle_t name##StreamHandle;
+#define APP_DECLARE_QUEUE(name, label, length, item_size) \
+    extern QueueHandle_t name##QueueHandle;
+#define APP_DECLARE_MUTEX(name, label) \
+    extern SemaphoreHandle_t name##MutexHandle;
+
+APP_TASK_TABLE(APP_DECLARE_TASK)
+APP_STREAM_TABLE(APP_DECLARE_STREAM)
+APP_QUEUE_TABLE(APP_DECLARE_QUEUE)
+APP_MUTEX_TABLE(APP_DECLARE_MUTEX)
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Marks the start of the boot sequence for the boot-time report.
+ * @details Call first thing in main(). Starts the DWT cycle counter.
+ */
+void app_objects_boot_begin(void);
+
+/**
+ * @brief Creates every object in the tables from its static storage.
+ * @details Mutexes, queues and stream buffers are created before the tasks,
+ *          so a task may use any object as soon as it runs.
+ *
+ * @return true on success, false if any object could not be created.
+ */
+bool app_objects_create(void);
+
+/**
+ * @brief Marks the end of the boot sequence, just before vTaskStartScheduler().
+ */
+void app_objects_boot_end(void);
+
+/**
+ * @brief Returns the time from app_objects_boot_begin() to app_objects_boot_end().
+ * @return Boot time in microseconds, or 0 if boot has not completed.
+ */
+uint32_t app_objects_get_boot_time_us(void);
+
+/**
+ * @brief Returns the RAM statically reserved for all objects in the tables.
+ */
+size_t app_objects_get_static_ram(void);
+
+/**
+ * @brief Formats a per-object RAM usage, heap and boot-time report.
+ *
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] len Size of the destination buffer in bytes.
+ *
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t app_objects_format(char* p_buffer, size_t len);
+
+#endif // APP_OBJECTS_H
@@ -0,0 +1,96 @@
+/**
+ * @file      audio_config.h
+ * @brief     Audio stream format and buffer sizing shared by the pipeline.
+ */
+
+#ifndef AUDIO_CONFIG_H
+#define AUDIO_CONFIG_H
+
+#include <stdint.h>
+
+// --- Audio Buffer Configuration ---
+#define AUDIO_SAMPLING_RATE   48000
+#define AUDIO_CHANNELS        2    // Interleaved stereo
+#define AUDIO_BLOCK_SAMPLES   256  // Number of int16_t samples in one processing block
+#define AUDIO_BLOCK_FRAMES    (AUDIO_BLOCK_SAMPLES / AUDIO_CHANNELS)
+#define AUDIO_BLOCK_BYTES     (AUDIO_BLOCK_SAMPLES * sizeof(int16_t))
+#define AUDIO_FRAME_BYTES     (AUDIO_CHANNELS * sizeof(int16_t))
+#define DMA_BUFFER_SIZE       (AUDIO_BLOCK_SAMPLES * 2) // Double buffer size
+
+// --- Pipeline Topology ---
+// 1: the I2S RX callback notifies dspTask directly with the ready half-buffer
+//    index, and dspTask writes into the half of the TX buffer the DMA is not
+//    reading. One context switch per block; no I/O tasks or stream buffers.
+// 0: RX callback -> audioInputTask -> stream buffer -> dspTask -> stream
+//    buffer -> audioOutputTask, driven by the TX callbacks.
+#ifndef AUDIO_PIPELINE_DIRECT_NOTIFY
+#define AUDIO_PIPELINE_DIRECT_NOTIFY    1
+#endif
+
+// --- I2S Topology (audio_io.h) ---
+// 1: capture and playback on I2S3 + I2S3ext, one clock, locked block phases.
+// 0: capture on I2S2, playback on I2S3, separate clocks with drift measured.
+#ifndef AUDIO_IO_FULL_DUPLEX
+#define AUDIO_IO_FULL_DUPLEX            1
+#endif
+
+// --- Clock-Domain Crossing (asrc.h) ---
+// 1: dspTask resamples each processed block before handing it to
+//    audioOutputTask, steering the ratio so the output stream buffer holds
+//    AUDIO_ASRC_TARGET_FRAMES. Absorbs the drift between separate capture
+//    and playback clocks (AUDIO_IO_FULL_DUPLEX = 0) without slips.
+#ifndef AUDIO_ASRC_ENABLE
+#define AUDIO_ASRC_ENABLE               0
+#endif
+
+#if (AUDIO_ASRC_ENABLE == 1) && (AUDIO_PIPELINE_DIRECT_NOTIFY == 1)
+#error "AUDIO_ASRC_ENABLE needs the stream-buffer pipeline (AUDIO_PIPELINE_DIRECT_NOTIFY = 0)"
+#endif
+
+// Output stream buffer fill, sampled before each send, that the controller holds
+#ifndef AUDIO_ASRC_TARGET_FRAMES
+#define AUDIO_ASRC_TARGET_FRAMES        (AUDIO_BLOCK_FRAMES * 3 / 2)
+#endif
+
+// PI gains in ppm per frame of fill error, and the correction limit
+#ifndef AUDIO_ASRC_KP_PPM
+#define AUDIO_ASRC_KP_PPM               10.0f
+#endif
+#ifndef AUDIO_ASRC_KI_PPM
+#define AUDIO_ASRC_KI_PPM               0.01f
+#endif
+#ifndef AUDIO_ASRC_MAX_PPM
+#define AUDIO_ASRC_MAX_PPM              1000.0f
+#endif
+
+// --- DSP Code Placement ---
+// 1: the effect kernels run from SRAM (.RamFunc, copied at startup with
+//    .data) instead of from flash behind the ART accelerator. With the ART
+//    caches on, flash loops run near zero wait states and SRAM code shares
+//    the S-bus with the delay line, so measure before switching ("art" and
+//    "show dsp" on the console).
+#ifndef AUDIO_DSP_IN_RAM
+#define AUDIO_DSP_IN_RAM                0
+#endif
+
+#if (AUDIO_DSP_IN_RAM == 1)
+#define AUDIO_DSP_FUNC                  __attribute__((section(".RamFunc"), noinline))
+#else
+#define AUDIO_DSP_FUNC
+#endif
+
+// --- DSP State Variables ---
+// The delay line holds interleaved frames, so its length per channel is
+// DELAY_BUFFER_FRAMES. It lives in SRAM next to the trace ring, the FreeRTOS
+// heap and the kernel objects, which bounds it to DELAY_BUFFER_RAM_BUDGET.
+#ifndef DELAY_BUFFER_FRAMES
+#define DELAY_BUFFER_FRAMES 8192    // ~170 ms per channel at 48 kHz
+#endif
+#define DELAY_BUFFER_SIZE   (DELAY_BUFFER_FRAMES * AUDIO_CHANNELS) // int16_t samples
+
+/** @brief Upper bound for the delay line, in bytes. */
+#ifndef DELAY_BUFFER_RAM_BUDGET
+#define DELAY_BUFFER_RAM_BUDGET (32 * 1024)
+#endif
+
+#endif // AUDIO_CONFIG_H
@@ -0,0 +1,98 @@
+/**
+ * @file      audio_io.h
+ * @brief     I2S capture and playback streams of the audio pipeline.
+ *
+ * @details   Owns the I2S instances and reports each completed RX half-buffer
+ *            and each freed TX half-buffer to the pipeline. Two topologies:
+ *
+ *            - Full duplex (AUDIO_IO_FULL_DUPLEX = 1): capture and playback
+ *              share I2S3 and its I2S3ext partner, so both run from one bit
+ *              clock. Every block completes in both directions on the same
+ *              frame: RX half n is reported together with TX half n, and the
+ *              distance between input and output can never change.
+ *            - Split (AUDIO_IO_FULL_DUPLEX = 0): capture on I2S2, playback on
+ *              I2S3, each with its own prescaler. Every block is timestamped
+ *              and the drift between the two streams is measured.
+ *
+ *            In the split topology both instances still divide down the one
+ *            PLLI2S, so on this board they cannot drift apart: the measured
+ *            drift equals the fixed difference between their achieved rates
+ *            (expected_drift_ppm, 0 at 48 kHz), and anything else means lost
+ *            blocks. The CPU clock the timestamps use comes from the same
+ *            crystal, so it is no independent reference either. A real drift
+ *            only shows with a codec on its own crystal, which the host
+ *            simulator models (i2s_port_posix_set_clock_ppm()).
+ */
+
+#ifndef AUDIO_IO_H
+#define AUDIO_IO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "audio_config.h"
+
+/* --- Public Types --- */
+
+/**
+ * @brief Half-buffer event, called from the I2S DMA interrupt.
+ * @param[in] half 0 for the first half of the DMA buffer, 1 for the second.
+ */
+typedef void (*audio_io_half_fn)(uint32_t half);
+
+/**
+ * @brief Stream counters and drift measurement.
+ */
+typedef struct {
+    bool full_duplex;
+    uint32_t rx_blocks;         // RX half-buffers completed
+    uint32_t tx_blocks;         // TX half-buffers freed
+    int32_t block_offset;       // Change in rx_blocks - tx_blocks since the first TX block; steady without drift
+    int32_t drift_ppm;          // RX rate relative to TX from block timestamps; 0 in full duplex
+    int32_t expected_drift_ppm; // RX relative to TX from the configured rates; 0 in full duplex
+    uint32_t rate_error_ppm;    // Largest |I2S rate error| from the clock configuration
+    uint32_t out_rate_mhz;      // Achieved sample rates in millihertz
+    uint32_t in_rate_mhz;
+    uint32_t dma_errors;
+} audio_io_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Configures the I2S instances and starts both streams.
+ * @details The TX buffer is cleared first, so playback starts with silence.
+ *          Call from a task once the callbacks' targets exist.
+ *
+ * @param[in] p_rx_buffer RX DMA buffer of DMA_BUFFER_SIZE samples.
+ * @param[in] p_tx_buffer TX DMA buffer of DMA_BUFFER_SIZE samples.
+ * @param[in] on_rx_ready Called when an RX half has been filled.
+ * @param[in] on_tx_free Called when a TX half has been played out and may be rewritten.
+ *
+ * @return true on success, false if an I2S instance could not be started.
+ */
+bool audio_io_start(int16_t* p_rx_buffer, int16_t* p_tx_buffer,
+                    audio_io_half_fn on_rx_ready, audio_io_half_fn on_tx_free);
+
+/**
+ * @brief Tells whether audio_io_start() has started the streams.
+ * @details Once started they run until reset; flash must not be erased
+ *          from then on (see presets.h).
+ */
+bool audio_io_is_streaming(void);
+
+/**
+ * @brief Copies the stream counters and computes the drift.
+ * @param[out] p_stats Destination structure.
+ */
+void audio_io_get_stats(audio_io_stats_t* p_stats);
+
+/**
+ * @brief Formats the stream counters and drift as a text report.
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] len Size of the destination buffer in bytes.
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t audio_io_format(char* p_buffer, size_t len);
+
+#endif // AUDIO_IO_H
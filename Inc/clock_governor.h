@@ -0,0 +1,85 @@
+/**
+ * @file      clock_governor.h
+ * @brief     CPU clock scaling driven by the measured DSP load.
+ *
+ * @details   Every CLOCK_GOVERNOR_PERIOD_MS the governor takes the longest
+ *            DSP block of the period from dsp_profile, as a fraction of the
+ *            block period at the current clock. Above the up threshold it
+ *            returns to 168 MHz at once; when the load scaled to the next
+ *            lower clock stays below the down threshold it steps down one
+ *            level (168, 120, 84 MHz). The gap between the thresholds keeps
+ *            it from oscillating.
+ *
+ *            The change itself is rcc_set_sysclk(): the drivers follow it
+ *            through their clock listeners (flash wait states, UART baud
+ *            rate, I2C timing, timer prescalers) and the governor's own
+ *            listener updates SystemCoreClock and reloads SysTick. The audio
+ *            clock comes from the PLLI2S and is not affected.
+ *
+ * @note      After a sudden rise in load (e.g. a heavier effect selected at
+ *            84 MHz) blocks may overrun until the next evaluation raises the
+ *            clock, at most one period later.
+ */
+
+#ifndef CLOCK_GOVERNOR_H
+#define CLOCK_GOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Interval between load evaluations. */
+#ifndef CLOCK_GOVERNOR_PERIOD_MS
+#define CLOCK_GOVERNOR_PERIOD_MS        250
+#endif
+
+/** @brief Peak DSP load, in tenths of a percent, above which the clock returns to its maximum. */
+#ifndef CLOCK_GOVERNOR_UP_PERMILLE
+#define CLOCK_GOVERNOR_UP_PERMILLE      750
+#endif
+
+/** @brief Peak DSP load the next lower clock must stay below, in tenths of a percent. */
+#ifndef CLOCK_GOVERNOR_DOWN_PERMILLE
+#define CLOCK_GOVERNOR_DOWN_PERMILLE    500
+#endif
+
+_Static_assert(CLOCK_GOVERNOR_DOWN_PERMILLE < CLOCK_GOVERNOR_UP_PERMILLE, "hysteresis between the thresholds");
+
+/* --- Public Types --- */
+
+/** @brief Who chooses the CPU clock. */
+typedef enum {
+    CLOCK_GOVERNOR_AUTO,            //!< The governor, from the DSP load
+    CLOCK_GOVERNOR_FIXED_84_MHZ,
+    CLOCK_GOVERNOR_FIXED_120_MHZ,
+    CLOCK_GOVERNOR_FIXED_168_MHZ,
+} clock_governor_mode_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Registers the clock listener and starts the evaluation timer in AUTO mode.
+ * @details Call after dsp_profile_init() and before the scheduler starts.
+ *
+ * @return true on success.
+ */
+bool clock_governor_init(void);
+
+/**
+ * @brief Selects automatic scaling or a fixed clock.
+ * @details Applied by the next evaluation, within CLOCK_GOVERNOR_PERIOD_MS.
+ */
+void clock_governor_set_mode(clock_governor_mode_t mode);
+
+/** @brief Gets the mode set with clock_governor_set_mode(). */
+clock_governor_mode_t clock_governor_get_mode(void);
+
+/**
+ * @brief Formats the clock tree, the load and the time spent at each clock as text.
+ * @return Number of characters written, excluding the terminator.
+ */
+size_t clock_governor_format(char* p_buffer, size_t len);
+
+#endif // CLOCK_GOVERNOR_H
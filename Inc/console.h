@@ -0,0 +1,90 @@
+/**
+ * @file      console.h
+ * @brief     Command shell on the UART bus, with audio and profiling commands.
+ *
+ * @details   Runs the FreeRTOS CLI shell (Middleware/Shell) on the DMA rings
+ *            of uart_bus: lines are assembled from whatever the RX ring holds
+ *            when the line goes idle, and every part of a command's output is
+ *            queued on the TX ring while the next part is prepared. Reports
+ *            longer than one CLI output buffer are formatted once and
+ *            streamed in pieces through the CLI continuation mechanism.
+ *
+ *            Commands added to the shell's "stats" and "heapstats":
+ *
+ *              effect [name|number]      list the effects, or select one
+ *              param [p1 p2 | auto]      show, hold or release the parameters
+ *              blocksize                 audio block size and latency
+ *              xruns                     audio overrun/underrun count
+ *              show <report>             tasks, objects, audio, power,
+ *                                        motion, telemetry, presets, dsp,
+ *                                        clock or events
+ *              telemetry <on|off>        binary telemetry on the same UART
+ *              preset [save|load <n>]    list, save or load the flash presets
+ *              art [<feature> <on|off>]  flash accelerator, for "show dsp"
+ *              clock [auto|<MHz>]        CPU clock governor, or a fixed clock
+ *              event <name> <ms> [value] schedule a control event, applied
+ *                                        on its exact audio sample
+ *
+ *            The console task runs at tskIDLE_PRIORITY and never waits on a
+ *            lock the audio path waits on for longer than a struct copy: the
+ *            parameter mutex is held only to copy two floats (with priority
+ *            inheritance), and the audio path only ever try-locks the UART.
+ *            Typing or streaming a report should therefore leave the "xruns"
+ *            count unchanged; compare it before and after a long report.
+ *            The exception is "preset save": programming flash stalls every
+ *            fetch from it, see presets.h.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Largest report the "show" command can stream, in bytes. */
+#ifndef CONSOLE_REPORT_BYTES
+#define CONSOLE_REPORT_BYTES        2048
+#endif
+
+/* --- Public Types --- */
+
+/**
+ * @brief Access to the audio application's state, provided by the application.
+ * @details All functions are called from the console task.
+ */
+typedef struct {
+    const char* const* p_effect_names;          // Indexed by effect number
+    uint32_t effect_count;
+    uint32_t (*get_effect)(void);
+    void (*set_effect)(uint32_t effect);
+    /** Copies the current targets; returns true if held by the console. */
+    bool (*get_params)(float* p_param1, float* p_param2);
+    /** Holds the parameters at fixed values, overriding the motion control. */
+    void (*hold_params)(float param1, float param2);
+    /** Hands the parameters back to the motion control. */
+    void (*release_params)(void);
+    uint32_t (*get_xruns)(void);
+    const char* const* p_event_names;           // Indexed by event number
+    uint32_t event_count;
+    /** Schedules an event `delay_ms` after now; returns false if the queue is full. */
+    bool (*schedule_event)(uint32_t event, float value, uint32_t delay_ms);
+} console_audio_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Binds the shell to uart_bus and registers the commands.
+ * @details Call once after uart_bus_start() and before the scheduler starts.
+ *          The console task itself is created from the object table.
+ *
+ * @param[in] p_audio Application accessors; must stay valid.
+ *
+ * @return true on success, false if the UART bus is not running or a
+ *         command could not be registered.
+ */
+bool console_init(const console_audio_t* p_audio);
+
+#endif // CONSOLE_H
@@ -0,0 +1,148 @@
+/**
+ * @file      dma_mem.h
+ * @brief     Asynchronous memcpy/memset service on a DMA2 memory-to-memory stream.
+ *
+ * @details   Tasks queue copy and fill operations and keep computing while
+ *            DMA2 moves the data. Operations run strictly in submission
+ *            order, one at a time, driven entirely from the stream interrupt.
+ *            Several operations may be submitted as one chain that completes
+ *            with a single callback. Each operation is split into segments
+ *            using the widest data size and the longest burst its alignment
+ *            allows, so word-aligned buffers move at full bus width.
+ *
+ *            Completion is reported through an optional callback run in
+ *            interrupt context; dma_mem_notify_task() is a ready-made callback
+ *            that wakes a task on notification index DMA_MEM_NOTIFY_INDEX.
+ *
+ * @note      The DMA cannot reach the CCM RAM; operations touching it are
+ *            rejected. The CPU must not access the destination until the
+ *            operation completes.
+ */
+
+#ifndef DMA_MEM_H
+#define DMA_MEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief DMA2 stream used by the service. Must not be in use elsewhere. */
+#ifndef DMA_MEM_STREAM
+#define DMA_MEM_STREAM              1
+#endif
+
+/** @brief NVIC interrupt number and handler of DMA_MEM_STREAM. */
+#ifndef DMA_MEM_IRQN
+#define DMA_MEM_IRQN                57
+#define DMA_MEM_IRQ_HANDLER         DMA2_Stream1_IRQHandler
+#endif
+
+/** @brief Stream interrupt priority. Must not be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY. */
+#ifndef DMA_MEM_IRQ_PRIORITY
+#define DMA_MEM_IRQ_PRIORITY        6
+#endif
+
+/** @brief Maximum number of queued operations, counting each operation of a chain. */
+#ifndef DMA_MEM_QUEUE_LENGTH
+#define DMA_MEM_QUEUE_LENGTH        16
+#endif
+
+/** @brief Task notification index given by dma_mem_notify_task(). */
+#ifndef DMA_MEM_NOTIFY_INDEX
+#define DMA_MEM_NOTIFY_INDEX        1
+#endif
+
+/* --- Public Types --- */
+
+/** @brief Kind of memory operation. */
+typedef enum {
+    DMA_MEM_OP_COPY = 0,    //!< memcpy(dst, src, bytes); the regions must not overlap
+    DMA_MEM_OP_SET,         //!< memset(dst, value, bytes)
+} dma_mem_op_kind_t;
+
+/**
+ * @brief One memory operation.
+ */
+typedef struct {
+    dma_mem_op_kind_t kind;
+    void* dst;
+    const void* src;        //!< DMA_MEM_OP_COPY only
+    uint8_t value;          //!< DMA_MEM_OP_SET only
+    size_t bytes;
+} dma_mem_op_t;
+
+/**
+ * @brief Completion callback, called from the DMA interrupt.
+ * @param[in] p_context The context given at submission.
+ * @param[in] success false if a transfer error aborted the chain.
+ */
+typedef void (*dma_mem_callback_t)(void* p_context, bool success);
+
+/**
+ * @brief Accumulated service statistics.
+ */
+typedef struct {
+    uint32_t completed;     //!< Chains completed successfully
+    uint32_t errors;        //!< Chains aborted by a transfer error
+    uint32_t rejected;      //!< Submissions refused (queue full or bad operation)
+    uint32_t bytes;         //!< Bytes moved
+    uint32_t queue_peak;    //!< Highest number of queued operations
+} dma_mem_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Initializes the DMA stream and its interrupt.
+ * @return true on success, false if the stream could not be initialized.
+ */
+bool dma_mem_init(void);
+
+/**
+ * @brief Queues a chain of operations that complete with a single callback.
+ * @details The operations run back to back in array order, after everything
+ *          submitted earlier. The array is copied, so it may live on the
+ *          stack. Task context only.
+ *
+ * @param[in] p_ops The operations.
+ * @param[in] count Number of operations in the chain.
+ * @param[in] callback Called once after the last operation, or NULL.
+ * @param[in] p_context Passed to the callback.
+ *
+ * @return A nonzero ticket for dma_mem_is_done(), or 0 if the chain was
+ *         rejected (queue full, empty operation or CCM address).
+ */
+uint32_t dma_mem_submit(const dma_mem_op_t* p_ops, size_t count, dma_mem_callback_t callback, void* p_context);
+
+/** @brief Queues a single copy. See dma_mem_submit(). */
+uint32_t dma_mem_copy(void* dst, const void* src, size_t bytes, dma_mem_callback_t callback, void* p_context);
+
+/** @brief Queues a single fill. See dma_mem_submit(). */
+uint32_t dma_mem_set(void* dst, uint8_t value, size_t bytes, dma_mem_callback_t callback, void* p_context);
+
+/**
+ * @brief Checks whether the chain with the given ticket has finished.
+ * @details Chains finish in submission order, so this also means every
+ *          earlier chain has finished.
+ */
+bool dma_mem_is_done(uint32_t ticket);
+
+/**
+ * @brief Callback that gives a notification to the task passed as context.
+ * @details Pair with ulTaskNotifyTakeIndexed(DMA_MEM_NOTIFY_INDEX, ...):
+ *          @code
+ *          dma_mem_copy(dst, src, n, dma_mem_notify_task, xTaskGetCurrentTaskHandle());
+ *          ... other work ...
+ *          ulTaskNotifyTakeIndexed(DMA_MEM_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+ *          @endcode
+ */
+void dma_mem_notify_task(void* p_context, bool success);
+
+/**
+ * @brief Copies the accumulated statistics.
+ * @param[out] p_stats Destination structure.
+ */
+void dma_mem_get_stats(dma_mem_stats_t* p_stats);
+
+#endif // DMA_MEM_H
@@ -0,0 +1,72 @@
+/**
+ * @file      dsp_profile.h
+ * @brief     DSP cycles per block under each flash accelerator setting.
+ *
+ * @details   dspTask brackets every block with dsp_profile_block_begin() and
+ *            dsp_profile_block_end(); the DWT cycles are summed per effect.
+ *            The ART accelerator (prefetch, instruction cache, data cache)
+ *            can be switched at runtime, which restarts the counts, so the
+ *            report compares cycles/block for each setting on live audio.
+ *            Where the kernels run, flash or SRAM, is the build option
+ *            AUDIO_DSP_IN_RAM (audio_config.h) and is shown in the report.
+ */
+
+#ifndef DSP_PROFILE_H
+#define DSP_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Effects tracked; numbers at or above it are not counted. */
+#ifndef DSP_PROFILE_MAX_EFFECTS
+#define DSP_PROFILE_MAX_EFFECTS     8
+#endif
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Prepares the profile and enables the whole ART accelerator.
+ *
+ * @param[in] p_effect_names Names for the report, indexed by effect; must stay valid.
+ * @param[in] effect_count Number of names.
+ *
+ * @return true on success, false if the flash controller is unavailable.
+ */
+bool dsp_profile_init(const char* const* p_effect_names, uint32_t effect_count);
+
+/** @brief Marks the start of a block (dspTask). */
+void dsp_profile_block_begin(void);
+
+/** @brief Marks the end of a block run with `effect` (dspTask). */
+void dsp_profile_block_end(uint32_t effect);
+
+/**
+ * @brief Switches the ART accelerator and restarts the counts.
+ * @param[in] features FLASH_ACCEL_* flags (flash.h).
+ * @return true on success.
+ */
+bool dsp_profile_set_accelerator(uint32_t features);
+
+/** @brief Gets the enabled FLASH_ACCEL_* flags. */
+uint32_t dsp_profile_get_accelerator(void);
+
+/** @brief Restarts the counts, e.g. after the CPU clock changed. */
+void dsp_profile_reset(void);
+
+/**
+ * @brief Gets the longest block since the previous call, relative to the
+ *        block period at the current CPU clock.
+ * @return Load in tenths of a percent; 0 if no block ran.
+ */
+uint32_t dsp_profile_take_peak_load(void);
+
+/**
+ * @brief Formats the cycles per block of each effect as text.
+ * @return Number of characters written, excluding the terminator.
+ */
+size_t dsp_profile_format(char* p_buffer, size_t len);
+
+#endif // DSP_PROFILE_H
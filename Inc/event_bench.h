@@ -0,0 +1,57 @@
+/**
+ * @file      event_bench.h
+ * @brief     Control event scheduler benchmark: timing accuracy and cost on target.
+ *
+ * @details   Streams EVENT_BENCH_EVENTS events through a heap of
+ *            EVENT_BENCH_CAPACITY, the way the producers and dspTask use
+ *            event_sched: before each simulated block the heap is topped up
+ *            with events at random frames up to EVENT_BENCH_HORIZON_BLOCKS
+ *            ahead, many sharing a frame, then the block is split at the due
+ *            events as dsp_process_block() does. Every event must come out on
+ *            its own frame, in frame order and in posting order within a
+ *            frame. The timeline starts just before the 32-bit position wraps.
+ *
+ *            Insertions and each block's removals are timed with the DWT
+ *            counter, including the critical sections event_sched takes; the
+ *            effect itself is not run, so the block cost is the scheduler's
+ *            overhead alone.
+ */
+
+#ifndef EVENT_BENCH_H
+#define EVENT_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Events streamed through the heap. */
+#ifndef EVENT_BENCH_EVENTS
+#define EVENT_BENCH_EVENTS          8192
+#endif
+
+/** @brief Heap size, kept full; 16 bytes per event. */
+#ifndef EVENT_BENCH_CAPACITY
+#define EVENT_BENCH_CAPACITY        256
+#endif
+
+/** @brief Blocks ahead of the current one that new events are spread over. */
+#ifndef EVENT_BENCH_HORIZON_BLOCKS
+#define EVENT_BENCH_HORIZON_BLOCKS  16
+#endif
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Runs the benchmark and formats the results.
+ * @details Independent of the live scheduler. The scheduler is suspended
+ *          only around each timed section. Call from a task, never from an ISR.
+ *
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] len Size of the destination buffer in bytes.
+ *
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t event_bench_run(char* p_buffer, size_t len);
+
+#endif // EVENT_BENCH_H
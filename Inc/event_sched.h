@@ -0,0 +1,164 @@
+/**
+ * @file      event_sched.h
+ * @brief     Sample-accurate control events for the DSP task.
+ *
+ * @details   Events (LFO resets, parameter changes, automation) are keyed by
+ *            the absolute position of the audio sample they apply at, and
+ *            kept in a preallocated min-heap (ctrl_event_heap_t) until
+ *            dspTask reaches that sample. dspTask splits each block at the
+ *            due events, so an event takes effect on its exact frame instead
+ *            of the next block boundary or RTOS tick.
+ *
+ *            Wall-clock time is mapped to sample positions with a free-running
+ *            32-bit timer (EVENT_SCHED_TIMER_INSTANCE). Every RX block interrupt
+ *            stamps the timer, which anchors the first sample of the block
+ *            being captured; a timestamp converts to the sample captured at
+ *            that instant. Two events stamped 1 ms apart therefore land 48
+ *            frames apart at 48 kHz, however late dspTask runs. That sample
+ *            is still ahead of dspTask, so an event posted for "now" or later
+ *            is on time; one for a sample already processed applies at the
+ *            start of the next block and is counted as late.
+ *
+ *            Positions count frames (one sample per channel) from the start
+ *            of the stream and wrap after 2^32 frames; see ctrl_event_heap_t.
+ *            With AUDIO_PIPELINE_DIRECT_NOTIFY = 1 dspTask always runs the
+ *            block captured last, and each block takes its position from
+ *            the anchor, so blocks it misses move the position on too. In
+ *            the stream-buffer pipeline dspTask runs the queued blocks in
+ *            order, and the position advances by one block per block
+ *            processed. A block audioInputTask cannot queue, because the
+ *            stream buffer is full, is never counted: from then on every
+ *            event applies one block after its sample, without being counted
+ *            as late. Playback then runs a block short too, which
+ *            audioOutputTask records as an xrun.
+ *
+ * @note      The heap is shared between the producers and dspTask under a
+ *            critical section of one O(log n) insert or removal.
+ */
+
+#ifndef EVENT_SCHED_H
+#define EVENT_SCHED_H
+
+#include "ctrl.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Largest number of pending events. */
+#ifndef EVENT_SCHED_MAX_EVENTS
+#define EVENT_SCHED_MAX_EVENTS          64
+#endif
+
+/** @brief 32-bit timer used as the time base (TIM2; TIM5 is the run-time stats clock). */
+#ifndef EVENT_SCHED_TIMER_INSTANCE
+#define EVENT_SCHED_TIMER_INSTANCE      2
+#endif
+
+/**
+ * @brief Time base tick rate.
+ * @details Divides the APB1 timer clock at every CPU clock level (84 MHz at
+ *          84 and 168 MHz, 60 MHz at 120 MHz), so the rate is exact across
+ *          rcc_set_sysclk(); 250 ticks per frame at 48 kHz.
+ */
+#ifndef EVENT_SCHED_TIMER_HZ
+#define EVENT_SCHED_TIMER_HZ            12000000UL
+#endif
+
+/* --- Public Types --- */
+
+/**
+ * @brief Scheduler counters.
+ */
+typedef struct {
+    uint32_t pending;
+    uint32_t pending_peak;
+    uint32_t posted;
+    uint32_t dropped;               // Posts refused because the heap was full
+    uint32_t applied;
+    uint32_t late;                  // Applied after their sample
+    uint32_t late_frames_max;
+    uint32_t blocks;
+    uint32_t block_cycles_max;      // Scheduler cycles per block, dspTask side
+    uint32_t block_cycles_avg;
+} event_sched_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Starts the time base timer and empties the heap.
+ * @details Call once before the audio streams start.
+ * @return true on success.
+ */
+bool event_sched_init(void);
+
+/** @brief Gets the time base counter, for timestamping an event where it happens. */
+uint32_t event_sched_now(void);
+
+/**
+ * @brief Converts a time base timestamp to the sample position captured at that time.
+ * @details Valid within about 2^31 ticks (three minutes) of the last block.
+ *          May be called from any context.
+ */
+uint32_t event_sched_ticks_to_sample(uint32_t ticks);
+
+/**
+ * @brief Schedules an event a number of frames after the sample being captured now.
+ * @details Call from a task.
+ * @return false if the heap is full.
+ */
+bool event_sched_post(uint16_t id, float value, uint32_t delay_frames);
+
+/**
+ * @brief Schedules an event at an absolute sample position (task context).
+ * @return false if the heap is full.
+ */
+bool event_sched_post_at(uint16_t id, float value, uint32_t sample);
+
+/** @brief ISR version of event_sched_post_at(). */
+bool event_sched_post_at_from_isr(uint16_t id, float value, uint32_t sample);
+
+/**
+ * @brief Anchors the time base to the stream; call from the RX block interrupt.
+ * @details Must run before dspTask is told about the block.
+ */
+void event_sched_mark_block_from_isr(void);
+
+/**
+ * @brief Starts a block in dspTask, fixing the sample position of its first frame.
+ */
+void event_sched_block_begin(void);
+
+/**
+ * @brief Removes the next event due at or before a frame of the current block.
+ * @param[in] frame Frame within the block, 0..AUDIO_BLOCK_FRAMES - 1.
+ * @param[out] p_event The event to apply.
+ * @return false once no more events are due.
+ */
+bool event_sched_take(uint32_t frame, ctrl_event_t* p_event);
+
+/**
+ * @brief Gets the frame of the current block the next event is due at.
+ * @details Call after event_sched_take() has returned false for `frame`.
+ *          An event posted meanwhile for an earlier frame gives `frame`.
+ * @param[in] frame Frame reached within the block.
+ * @return The frame, from `frame` up to AUDIO_BLOCK_FRAMES if no event
+ *         falls in the rest of the block.
+ */
+uint32_t event_sched_next_frame(uint32_t frame);
+
+/** @brief Ends the block and moves the position on by AUDIO_BLOCK_FRAMES. */
+void event_sched_block_end(void);
+
+/** @brief Copies the counters. */
+void event_sched_get_stats(event_sched_stats_t* p_stats);
+
+/**
+ * @brief Formats the counters as text.
+ * @return Number of characters written, excluding the terminator.
+ */
+size_t event_sched_format(char* p_buffer, size_t len);
+
+#endif // EVENT_SCHED_H
@@ -0,0 +1,103 @@
+/**
+ * @file      i2c_bus.h
+ * @brief     FreeRTOS blocking wrapper and benchmark for asynchronous I2C transactions.
+ *
+ * @details   i2c_bus_transfer() queues a write-then-read transaction with
+ *            i2c_transfer_async() and blocks the calling task (not the CPU) on
+ *            a task notification until it completes. A register read is one
+ *            transaction: the register address, a repeated START and the data,
+ *            so no other master or client can slip in between.
+ *
+ *            Unlike SPI, a slave can stall an I2C transfer indefinitely by
+ *            holding SCL low, so every wait has a timeout; on expiry the
+ *            transaction is aborted and the bus recovered before returning.
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "i2c.h"
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Task notification index used to wait for completion. */
+#ifndef I2C_BUS_NOTIFY_INDEX
+#define I2C_BUS_NOTIFY_INDEX        3
+#endif
+
+/** @brief Longest wait for one transaction before it is aborted. */
+#ifndef I2C_BUS_TIMEOUT_MS
+#define I2C_BUS_TIMEOUT_MS          20
+#endif
+
+/** @brief Largest payload of i2c_bus_write_reg(). */
+#ifndef I2C_BUS_MAX_WRITE
+#define I2C_BUS_MAX_WRITE           16
+#endif
+
+/** @brief Register reads timed per benchmark method; the mean is reported. */
+#ifndef I2C_BUS_BENCH_RUNS
+#define I2C_BUS_BENCH_RUNS          16
+#endif
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Runs one write-then-read transaction and waits for it to complete.
+ *
+ * @param[in] handle I2C instance with asynchronous support.
+ * @param[in] slave_addr 7-bit slave address.
+ * @param[in] p_write Bytes to write first, or NULL.
+ * @param[in] write_len Number of bytes to write.
+ * @param[out] p_read Bytes read after a repeated START, or NULL.
+ * @param[in] read_len Number of bytes to read.
+ *
+ * @return I2C_OK, or a negative i2c_status_t (I2C_ERROR_TIMEOUT if aborted).
+ */
+int i2c_bus_transfer(i2c_handle_t handle, uint8_t slave_addr, const uint8_t* p_write, size_t write_len,
+                     uint8_t* p_read, size_t read_len);
+
+/**
+ * @brief Reads consecutive registers in one transaction.
+ * @details Devices that need a flag for address auto-increment (e.g. bit 7
+ *          of the register address) expect it already set in `reg`.
+ *
+ * @return I2C_OK, or a negative i2c_status_t.
+ */
+int i2c_bus_read_reg(i2c_handle_t handle, uint8_t slave_addr, uint8_t reg, uint8_t* p_data, size_t len);
+
+/**
+ * @brief Writes consecutive registers in one transaction.
+ * @param[in] len Number of data bytes, at most I2C_BUS_MAX_WRITE.
+ * @return I2C_OK, or a negative i2c_status_t.
+ */
+int i2c_bus_write_reg(i2c_handle_t handle, uint8_t slave_addr, uint8_t reg, const uint8_t* p_data, size_t len);
+
+/**
+ * @brief Compares register reads with the blocking calls and asynchronously.
+ *
+ * @details Reads `len` bytes from register `reg` of a present slave
+ *          I2C_BUS_BENCH_RUNS times each way: a blocking write of the register
+ *          address followed by a blocking read (two transfers with a STOP in
+ *          between), then one asynchronous transaction. Reports the mean
+ *          latency and the CPU cycles each method consumed; the CPU cost of the
+ *          asynchronous transaction is measured as the cycles a calibrated spin
+ *          loop lost while it ran. Task context only.
+ *
+ * @param[in] handle I2C instance with asynchronous support.
+ * @param[in] slave_addr 7-bit address of a slave on the bus.
+ * @param[in] reg Register to read.
+ * @param[in] len Bytes per read, 1 to 32.
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] buffer_len Size of the destination buffer in bytes.
+ *
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t i2c_bus_benchmark(i2c_handle_t handle, uint8_t slave_addr, uint8_t reg, size_t len,
+                         char* p_buffer, size_t buffer_len);
+
+#endif // I2C_BUS_H
@@ -0,0 +1,146 @@
+/**
+ * @file      low_power.h
+ * @brief     Audio-aware low-power policy for the FreeRTOS tickless idle.
+ *
+ * @details   With configUSE_TICKLESS_IDLE the kernel suppresses the tick while
+ *            all tasks are blocked and calls the pre/post sleep hooks below.
+ *            Each idle period ends in one of two states:
+ *
+ *            - SLEEP: WFI with the core clock stopped and all peripherals
+ *              running. Used whenever any DMA stream is enabled (the I2S audio
+ *              path is entirely DMA driven), when STOP is locked, or when the
+ *              idle period is too short to pay for the clock restart.
+ *            - STOP:  Driver/pwr STOP mode with all high-speed clocks off. The
+ *              RTC wakeup timer (LSI) ends the period on time and the RTC
+ *              sub-second counter measures how long the core was stopped, so
+ *              the kernel tick count is corrected on wakeup.
+ *
+ *            Time spent running, sleeping and stopped is accounted using the
+ *            run-time stats clock and the RTC, and reported together with the
+ *            wakeup rate and an estimated supply current.
+ */
+
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Set to 0 to never use STOP mode (WFI sleep only). */
+#ifndef LOW_POWER_STOP_ENABLE
+#define LOW_POWER_STOP_ENABLE           1
+#endif
+
+/** @brief Shortest expected idle time, in ticks, for which STOP is used. */
+#ifndef LOW_POWER_STOP_MIN_IDLE_TICKS
+#define LOW_POWER_STOP_MIN_IDLE_TICKS   10
+#endif
+
+/** @brief Time reserved for restarting HSE and the PLL after STOP, in microseconds. */
+#ifndef LOW_POWER_STOP_EXIT_US
+#define LOW_POWER_STOP_EXIT_US          2000
+#endif
+
+/** @brief Interval between LSI calibrations against the run-time stats clock. */
+#ifndef LOW_POWER_CALIBRATION_PERIOD_MS
+#define LOW_POWER_CALIBRATION_PERIOD_MS 10000
+#endif
+
+/**
+ * @brief Supply current per state in microamps, used for the energy estimate.
+ * @details Defaults are STM32F407 datasheet typicals at 168 MHz; replace them
+ *          with values measured on the board for meaningful figures.
+ */
+#ifndef LOW_POWER_RUN_CURRENT_UA
+#define LOW_POWER_RUN_CURRENT_UA        46000
+#endif
+#ifndef LOW_POWER_SLEEP_CURRENT_UA
+#define LOW_POWER_SLEEP_CURRENT_UA      20000
+#endif
+#ifndef LOW_POWER_STOP_CURRENT_UA
+#define LOW_POWER_STOP_CURRENT_UA       600
+#endif
+
+/** @brief Supply voltage in millivolts, used for the energy estimate. */
+#ifndef LOW_POWER_SUPPLY_MV
+#define LOW_POWER_SUPPLY_MV             3300
+#endif
+
+/* --- Public Types --- */
+
+/**
+ * @brief Accumulated low-power statistics since boot or the last reset.
+ */
+typedef struct {
+    uint64_t run_us;             //!< Time spent executing code
+    uint64_t sleep_us;           //!< Time spent in WFI sleep
+    uint64_t stop_us;            //!< Time spent in STOP mode
+    uint32_t sleep_count;        //!< Number of WFI sleep periods
+    uint32_t stop_count;         //!< Number of STOP periods
+    uint32_t stop_timer_wakeups; //!< STOP periods ended by the RTC wakeup timer
+    uint32_t stop_dma_vetoes;    //!< Idle periods long enough for STOP that slept because DMA was active
+    uint32_t stop_lock_vetoes;   //!< Idle periods long enough for STOP that slept because of a lock
+    uint32_t lsi_hz;             //!< Calibrated RTC clock frequency, 0 until calibrated
+} low_power_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Initializes the PWR and RTC drivers used for STOP mode.
+ * @details Must be called before vTaskStartScheduler(). Until this succeeds,
+ *          and until the LSI has been calibrated once, idle periods use WFI.
+ *
+ * @param[in] restore_clocks Function that restarts HSE, the PLL and the bus
+ *                           dividers after STOP (e.g. SystemClock_Config).
+ *                           It must leave SysTick untouched and restore the
+ *                           same core clock frequency.
+ *
+ * @return true on success, false if STOP mode is unavailable.
+ */
+bool low_power_init(void (*restore_clocks)(void));
+
+/**
+ * @brief Prevents STOP mode until the matching low_power_stop_unlock().
+ * @details For peripherals that must keep their clock without an active DMA
+ *          stream (e.g. a UART waiting for input). Calls nest. ISR safe.
+ */
+void low_power_stop_lock(void);
+
+/** @brief Releases one low_power_stop_lock(). ISR safe. */
+void low_power_stop_unlock(void);
+
+/**
+ * @brief Copies the accumulated statistics.
+ * @param[out] p_stats Destination structure.
+ */
+void low_power_get_stats(low_power_stats_t* p_stats);
+
+/** @brief Clears all accumulated statistics. */
+void low_power_reset_stats(void);
+
+/**
+ * @brief Formats a human-readable time, wakeup and energy report.
+ *
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] len Size of the destination buffer in bytes.
+ *
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t low_power_format(char* p_buffer, size_t len);
+
+/* --- Kernel hooks, called only through FreeRTOSConfig.h --- */
+
+/**
+ * @brief configPRE_SLEEP_PROCESSING() hook. Runs with interrupts masked.
+ * @details Sets *p_expected_idle_ticks to 0 when the idle period was already
+ *          spent in STOP mode, so the port skips its own WFI.
+ */
+void low_power_pre_sleep(uint32_t* p_expected_idle_ticks);
+
+/** @brief configPOST_SLEEP_PROCESSING() hook. Runs with interrupts masked. */
+void low_power_post_sleep(uint32_t expected_idle_ticks);
+
+#endif // LOW_POWER_H
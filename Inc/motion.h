@@ -0,0 +1,119 @@
+/**
+ * @file      motion.h
+ * @brief     Accelerometer blocks to effect parameters: filtering, tilt and
+ *            response curves.
+ *
+ * @details   Each FIFO block from the LIS3DSH goes through:
+ *
+ *            1. A biquad low-pass per axis at the sensor rate, which removes
+ *               hand tremor and vibration and anti-aliases the decimation.
+ *            2. Decimation to one reading per block (the last filtered
+ *               sample) and roll/pitch with atan2.
+ *            3. A one-euro filter per angle at the block rate: steady while
+ *               the board is held still, responsive when it moves.
+ *            4. A response curve per parameter: +-MOTION_TILT_RANGE_DEG onto
+ *               0..1 with a dead zone around level.
+ *
+ *            Pitch drives param1 and roll drives param2. The output is a
+ *            control-rate target; the DSP ramps towards it sample by sample.
+ *
+ *            The module measures its own cost (DWT cycles per block) and the
+ *            jitter of each parameter, the RMS change from one block to the
+ *            next, which is what a listener hears as zipper noise when the
+ *            board is held still.
+ */
+
+#ifndef MOTION_H
+#define MOTION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "lis3dsh.h"
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Cutoff of the per-axis biquad at the sensor rate. */
+#ifndef MOTION_PREFILTER_HZ
+#define MOTION_PREFILTER_HZ         20.0f
+#endif
+
+/** @brief One-euro cutoff with the board still; lower is steadier. */
+#ifndef MOTION_MIN_CUTOFF_HZ
+#define MOTION_MIN_CUTOFF_HZ        0.5f
+#endif
+
+/** @brief One-euro cutoff increase in Hz per rad/s of tilt speed; higher lags less. */
+#ifndef MOTION_BETA
+#define MOTION_BETA                 2.0f
+#endif
+
+/** @brief Tilt mapped onto the full parameter range, each way from level. */
+#ifndef MOTION_TILT_RANGE_DEG
+#define MOTION_TILT_RANGE_DEG       45.0f
+#endif
+
+/** @brief Flat region around level, as a fraction of the range. */
+#ifndef MOTION_DEAD_ZONE
+#define MOTION_DEAD_ZONE            0.1f
+#endif
+
+/** @brief Curve shape; above 1 gives finer control near level. */
+#ifndef MOTION_CURVE_GAMMA
+#define MOTION_CURVE_GAMMA          1.5f
+#endif
+
+/** @brief Blocks over which the jitter is averaged (exponentially). */
+#ifndef MOTION_JITTER_BLOCKS
+#define MOTION_JITTER_BLOCKS        64
+#endif
+
+/* --- Public Types --- */
+
+/**
+ * @brief Cost and jitter measurements.
+ */
+typedef struct {
+    uint32_t blocks;
+    uint32_t samples_per_block;     // Of the last block
+    uint32_t cycles_last;           // DWT cycles of the last block
+    uint32_t cycles_max;
+    uint32_t jitter_ppm[2];         // RMS block-to-block change of param1/param2, in ppm of full scale
+} motion_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Designs the filters for a sensor rate and resets all state.
+ * @param[in] sample_rate_hz Accelerometer output data rate.
+ */
+void motion_init(float sample_rate_hz);
+
+/**
+ * @brief Conditions one block of samples into two parameter targets.
+ * @details Task context; one task only.
+ *
+ * @param[in] p_samples Raw samples, oldest first.
+ * @param[in] count Number of samples (> 0).
+ * @param[in] g_per_count Sensitivity of the samples.
+ * @param[out] p_param1 Target from pitch, 0..1.
+ * @param[out] p_param2 Target from roll, 0..1.
+ */
+void motion_process(const lis3dsh_sample_t* p_samples, size_t count, float g_per_count,
+                    float* p_param1, float* p_param2);
+
+/**
+ * @brief Copies the measurements.
+ * @param[out] p_stats Destination.
+ */
+void motion_get_stats(motion_stats_t* p_stats);
+
+/**
+ * @brief Formats the measurements as text.
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] len Size of the destination buffer in bytes.
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t motion_report(char* p_buffer, size_t len);
+
+#endif // MOTION_H
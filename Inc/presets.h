@@ -0,0 +1,103 @@
+/**
+ * @file      presets.h
+ * @brief     Effect presets kept in internal flash.
+ *
+ * @details   Each preset slot is one key of a kvstore (Middleware/KVStore)
+ *            on flash sectors 1 and 2, the FLASH_STORE region of the linker
+ *            script. Slot n is key n; slot 0 is restored at power-on, with
+ *            its parameters held until "param auto".
+ *
+ *            Saving a preset appends one 20-byte record; saving the same
+ *            values again writes nothing. A sector erase happens only when
+ *            the active sector fills, about once every 800 saves.
+ *
+ * @warning   The F407 has a single flash bank, and the CPU stalls on every
+ *            flash fetch while it is programmed or erased. A save stops all
+ *            tasks for a few hundred microseconds, which the audio buffers
+ *            absorb; an erase would stop them for several hundred
+ *            milliseconds and freeze the audio. So erases only happen while
+ *            audio is not streaming: presets_init() compacts the store at
+ *            power-on whenever less than PRESETS_COMPACT_RESERVE_BYTES are
+ *            free, and a save that would need an erase once the streams run
+ *            is refused with PRESETS_ERR_STREAMING. The reserve holds about
+ *            200 saves per power-on. Presets are only written on an
+ *            explicit console command, never from the audio path.
+ */
+
+#ifndef PRESETS_H
+#define PRESETS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Number of preset slots; slot 0 is loaded at power-on. */
+#ifndef PRESETS_SLOTS
+#define PRESETS_SLOTS               8
+#endif
+
+/** @brief Free bytes presets_init() makes sure of at power-on, compacting if needed. */
+#ifndef PRESETS_COMPACT_RESERVE_BYTES
+#define PRESETS_COMPACT_RESERVE_BYTES   (PRESETS_FLASH_SECTOR_BYTES / 4)
+#endif
+
+/** @brief Returned by presets_save() when the save needs an erase and audio is streaming. */
+#define PRESETS_ERR_STREAMING       (-16)
+
+/* --- Flash Layout (matches FLASH_STORE in STM32F407VGTX_FLASH.ld) --- */
+
+#define PRESETS_FLASH_SECTOR        1               // Sectors 1 and 2
+#define PRESETS_FLASH_ADDRESS       0x08004000UL
+#define PRESETS_FLASH_SECTOR_BYTES  (16 * 1024)
+
+/* --- Public Types --- */
+
+/** @brief What a preset restores. */
+typedef struct {
+    uint8_t effect;                 // EffectType
+    uint8_t reserved[3];
+    float param1;                   // 0..1
+    float param2;                   // 0..1
+} preset_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Mounts the preset store, formatting or repairing it if needed.
+ * @details Call once before the scheduler starts; afterwards presets are
+ *          accessed from the console task only. Compacts the store when
+ *          less than PRESETS_COMPACT_RESERVE_BYTES are free.
+ *
+ * @return true on success, false if the flash could not be written.
+ */
+bool presets_init(void);
+
+/**
+ * @brief Stores a preset in a slot.
+ * @return 0 on success, PRESETS_ERR_STREAMING if the active sector is full
+ *         and audio is streaming (nothing is written, and the store is
+ *         compacted at the next power-on), or a negative KVSTORE_ERR_* code.
+ */
+int presets_save(uint32_t slot, const preset_t* p_preset);
+
+/**
+ * @brief Reads the preset in a slot.
+ * @return 0 on success, KVSTORE_ERR_NOT_FOUND for an empty slot, or another
+ *         negative KVSTORE_ERR_* code.
+ */
+int presets_load(uint32_t slot, preset_t* p_preset);
+
+/**
+ * @brief Formats the store counters as text.
+ * @details Reports the write efficiency (flash bytes programmed per preset
+ *          byte saved, saves per sector erase), the program throughput,
+ *          the erase times, the longest the CPU went unscheduled during an
+ *          erase and the saves refused while streaming.
+ *
+ * @return Number of characters written, excluding the terminator.
+ */
+size_t presets_format(char* p_buffer, size_t len);
+
+#endif // PRESETS_H
@@ -0,0 +1,125 @@
+/**
+ * @file      runtime_stats.h
+ * @brief     FreeRTOS run-time statistics clock and per-task load reporting.
+ *
+ * @details   Provides the counter behind portGET_RUN_TIME_COUNTER_VALUE(),
+ *            backed by a free-running 32-bit timer from Driver/timer, and a
+ *            sliding-window view of per-task CPU load and stack high-water
+ *            marks. The window is built by sampling the kernel counters from
+ *            a software timer, so reports cost nothing on the audio path.
+ */
+
+#ifndef RUNTIME_STATS_H
+#define RUNTIME_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief 32-bit timer instance used as the statistics clock (TIM2 or TIM5). */
+#ifndef RUNTIME_STATS_TIMER_INSTANCE
+#define RUNTIME_STATS_TIMER_INSTANCE    5
+#endif
+
+/** @brief Statistics clock rate in Hz. Must divide the timer input clock. */
+#ifndef RUNTIME_STATS_COUNTER_HZ
+#define RUNTIME_STATS_COUNTER_HZ        1000000UL
+#endif
+
+/** @brief Maximum number of tasks tracked by the sliding window. */
+#ifndef RUNTIME_STATS_MAX_TASKS
+#define RUNTIME_STATS_MAX_TASKS         12
+#endif
+
+/** @brief Number of samples kept; the window spans (slots - 1) sample periods. */
+#ifndef RUNTIME_STATS_WINDOW_SLOTS
+#define RUNTIME_STATS_WINDOW_SLOTS      6
+#endif
+
+/** @brief Sampling period of the window in milliseconds. */
+#ifndef RUNTIME_STATS_SAMPLE_PERIOD_MS
+#define RUNTIME_STATS_SAMPLE_PERIOD_MS  500
+#endif
+
+/* --- Binary Export Format --- */
+
+/** @brief Magic word at the start of a binary export ("RTS1", little-endian). */
+#define RUNTIME_STATS_EXPORT_MAGIC      0x31535452UL
+
+/**
+ * @brief Header of a binary export, followed by `record_count` records.
+ * @note  All fields are little-endian, as stored by the Cortex-M4.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;          //!< RUNTIME_STATS_EXPORT_MAGIC
+    uint16_t record_count;   //!< Number of runtime_stats_record_t that follow
+    uint16_t record_size;    //!< sizeof(runtime_stats_record_t)
+    uint32_t counter_hz;     //!< Statistics clock rate
+    uint32_t window_total;   //!< Clock ticks spanned by the sliding window
+    uint32_t total;          //!< Clock ticks since the scheduler started
+} runtime_stats_export_header_t;
+
+/** @brief Per-task record of a binary export. */
+typedef struct __attribute__((packed)) {
+    uint8_t  task_number;      //!< FreeRTOS xTaskNumber
+    uint8_t  priority;         //!< Current priority
+    uint16_t stack_hwm_words;  //!< Minimum free stack ever seen, in words
+    uint32_t window_counter;   //!< Ticks spent running inside the window
+    uint32_t total_counter;    //!< Ticks spent running since start
+} runtime_stats_record_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Configures and starts the statistics timer.
+ * @details Called by the kernel through portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ *          from vTaskStartScheduler().
+ */
+void runtime_stats_timer_init(void);
+
+/**
+ * @brief Returns the current statistics clock value.
+ * @details Called by the kernel through portGET_RUN_TIME_COUNTER_VALUE() on
+ *          every context switch, so it is a single register read.
+ */
+uint32_t runtime_stats_get_counter(void);
+
+/**
+ * @brief Creates the software timer that samples the sliding window.
+ * @return true on success, false if the timer could not be created.
+ */
+bool runtime_stats_start(void);
+
+/**
+ * @brief Takes one sample of all task counters into the sliding window.
+ * @details Normally driven by the timer created in runtime_stats_start(),
+ *          but may be called directly (e.g. from a simulation harness).
+ */
+void runtime_stats_sample(void);
+
+/**
+ * @brief Formats a human-readable per-task CPU% and stack report.
+ * @details Works on a copy of the window taken with the scheduler
+ *          suspended. The reporting functions share that copy, so call
+ *          them from one task at a time.
+ *
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] len Size of the destination buffer in bytes.
+ *
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t runtime_stats_format(char* p_buffer, size_t len);
+
+/**
+ * @brief Serializes the current window into the compact binary format.
+ *
+ * @param[out] p_buffer Destination buffer.
+ * @param[in] len Size of the destination buffer in bytes.
+ *
+ * @return Number of bytes written, or -1 if the buffer is too small for the header.
+ */
+int runtime_stats_export(uint8_t* p_buffer, size_t len);
+
+#endif // RUNTIME_STATS_H
@@ -0,0 +1,128 @@
+/**
+ * @file      telemetry_link.h
+ * @brief     Streams audio taps, DSP cost and effect parameters over the UART.
+ *
+ * @details   Binds the telemetry framer (Middleware/Telemetry) to the DMA TX
+ *            ring of uart_bus. Every audio block dspTask sends:
+ *
+ *            - one AUDIO frame per tap (0 = input, 1 = output): channel
+ *              TELEMETRY_LINK_TAP_CHANNEL, keeping every
+ *              TELEMETRY_LINK_DECIMATION-th frame, read in place from the
+ *              block;
+ *            - one BLOCK frame with the DWT cycles the block took.
+ *
+ *            sensorTask sends a PARAMS frame per accelerometer block, and an
+ *            INFO frame describing the stream goes out every
+ *            TELEMETRY_LINK_INFO_BLOCKS blocks so a receiver can join at any
+ *            time.
+ *
+ *            Nothing here waits: if the console holds the UART or the ring is
+ *            full, the frames are dropped and counted. At the default
+ *            settings the stream needs about 70 KB/s, so the link should run
+ *            at 1 Mbaud or more.
+ *
+ *            Payloads (little-endian):
+ *              INFO    u8 version, u8 taps, u16 decimation, u32 sample rate Hz,
+ *                      u16 block frames, u16 reserved, u32 CPU Hz,
+ *                      u32 frames dropped on the device
+ *              AUDIO   u32 index of the first decimated sample, i16 samples[]
+ *              BLOCK   u32 block number, u32 cycles, u8 effect
+ *              PARAMS  f32 param1, f32 param2
+ */
+
+#ifndef TELEMETRY_LINK_H
+#define TELEMETRY_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "audio_config.h"
+
+/* --- Compile-time Configuration --- */
+
+/**
+ * @brief Set to 1 to start with the stream on.
+ * @note  Off by default, since the frames would garble the text console on
+ *        the same UART; start it with the console's "telemetry on".
+ */
+#ifndef TELEMETRY_LINK_ENABLE
+#define TELEMETRY_LINK_ENABLE       0
+#endif
+
+/** @brief Keep one audio frame in this many. */
+#ifndef TELEMETRY_LINK_DECIMATION
+#define TELEMETRY_LINK_DECIMATION   4
+#endif
+
+/** @brief Channel of the interleaved blocks sent on the audio taps. */
+#ifndef TELEMETRY_LINK_TAP_CHANNEL
+#define TELEMETRY_LINK_TAP_CHANNEL  0
+#endif
+
+/** @brief Blocks between INFO frames (375 blocks is about one second). */
+#ifndef TELEMETRY_LINK_INFO_BLOCKS
+#define TELEMETRY_LINK_INFO_BLOCKS  375
+#endif
+
+#define TELEMETRY_LINK_VERSION      1
+#define TELEMETRY_LINK_TAPS         2
+#define TELEMETRY_LINK_TAP_SAMPLES  (AUDIO_BLOCK_FRAMES / TELEMETRY_LINK_DECIMATION)
+
+/* --- Public Types --- */
+
+/** @brief Link counters. */
+typedef struct {
+    uint32_t frames;                // Frames sent
+    uint32_t bytes;                 // Bytes sent
+    uint32_t dropped;               // Frames dropped: ring full or UART busy
+    uint32_t encode_cycles_max;     // Longest time dspTask spent sending one block
+} telemetry_link_stats_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Binds the link to the UART started with uart_bus_start().
+ * @return true on success, false if the UART bus is not running.
+ */
+bool telemetry_link_init(void);
+
+/** @brief Starts or stops the stream. */
+void telemetry_link_set_enabled(bool enable);
+
+/** @brief Returns true while the stream is on. */
+bool telemetry_link_is_enabled(void);
+
+/** @brief Marks the start of a DSP block, for its cycle count. dspTask only. */
+void telemetry_link_block_begin(void);
+
+/**
+ * @brief Sends the taps and cost of the block started by telemetry_link_block_begin().
+ * @details dspTask only; never waits.
+ *
+ * @param[in] p_input The block before processing, AUDIO_BLOCK_FRAMES interleaved frames.
+ * @param[in] p_output The block after processing.
+ * @param[in] effect Effect that processed the block.
+ */
+void telemetry_link_block_end(const int16_t* p_input, const int16_t* p_output, uint8_t effect);
+
+/**
+ * @brief Sends the effect parameters. Never waits.
+ */
+void telemetry_link_params(float param1, float param2);
+
+/**
+ * @brief Copies the counters.
+ * @param[out] p_stats Destination.
+ */
+void telemetry_link_get_stats(telemetry_link_stats_t* p_stats);
+
+/**
+ * @brief Formats the counters as text.
+ * @param[out] p_buffer Destination for the NUL-terminated report.
+ * @param[in] len Size of the destination buffer in bytes.
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t telemetry_link_format(char* p_buffer, size_t len);
+
+#endif // TELEMETRY_LINK_H
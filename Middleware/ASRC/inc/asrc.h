@@ -0,0 +1,181 @@
+/**
+ * @file      asrc.h
+ * @brief     Asynchronous sample-rate converter for 16-bit interleaved audio.
+ *
+ * @details   Converts between two sample clocks whose ratio is only known
+ *            approximately: a nominal ratio (e.g. 44.1 kHz to 48 kHz, or 1:1)
+ *            corrected by a few hundred ppm at run time.
+ *
+ *            Output samples are interpolated with a polyphase windowed-sinc
+ *            filter: ASRC_TAPS taps, ASRC_PHASES sub-sample phases, and linear
+ *            interpolation between neighbouring phases. The prototype is a
+ *            Kaiser-windowed sinc whose cutoff follows the lower of the two
+ *            rates, so downsampling does not alias.
+ *
+ *            The ratio is steered by a PI controller from the fill level of
+ *            the buffer the output feeds: call asrc_steer() once per block
+ *            with the fill error, and the correction settles where the
+ *            producer and consumer rates match and the fill is on target.
+ *
+ *            Two interchangeable processing paths share the state:
+ *            asrc_process_q15() is the fixed-point fast path (Q15
+ *            coefficients, 32-bit accumulation); asrc_process() is the float
+ *            reference path, available with ASRC_FLOAT_PATH.
+ *
+ * @note      The library has no RTOS or hardware dependency. An asrc_t is
+ *            owned by the caller and is not thread-safe.
+ */
+
+#ifndef ASRC_H
+#define ASRC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Filter taps per output sample. Must be even. */
+#ifndef ASRC_TAPS
+#define ASRC_TAPS                   32
+#endif
+
+/** @brief log2 of the number of polyphase branches. */
+#ifndef ASRC_PHASES_LOG2
+#define ASRC_PHASES_LOG2            5
+#endif
+#define ASRC_PHASES                 (1U << ASRC_PHASES_LOG2)
+
+/** @brief Maximum interleaved channels per instance. */
+#ifndef ASRC_MAX_CHANNELS
+#define ASRC_MAX_CHANNELS           2
+#endif
+
+/** @brief Set to 0 to drop the float reference path and its coefficient table. */
+#ifndef ASRC_FLOAT_PATH
+#define ASRC_FLOAT_PATH             1
+#endif
+
+/** @brief Filter cutoff as a fraction of the lower Nyquist frequency. */
+#ifndef ASRC_CUTOFF
+#define ASRC_CUTOFF                 0.84f
+#endif
+
+/** @brief Kaiser window beta; 8 gives about 80 dB stopband attenuation. */
+#ifndef ASRC_KAISER_BETA
+#define ASRC_KAISER_BETA            8.0f
+#endif
+
+/* --- Public Types --- */
+
+/**
+ * @brief Converter configuration.
+ */
+typedef struct {
+    uint32_t input_rate_hz;         // Nominal input rate
+    uint32_t output_rate_hz;        // Nominal output rate
+    uint8_t channels;               // Interleaved channels, 1..ASRC_MAX_CHANNELS
+    float kp_ppm;                   // Proportional gain, ppm per frame of fill error
+    float ki_ppm;                   // Integral gain, ppm per frame of fill error per asrc_steer() call
+    float max_correction_ppm;       // Limit of the ratio correction (and of the integral term)
+} asrc_config_t;
+
+/**
+ * @brief Converter statistics.
+ */
+typedef struct {
+    uint32_t frames_in;
+    uint32_t frames_out;
+    uint32_t frames_dropped;        // Output frames lost to a full output buffer
+    float correction_ppm;           // Current ratio correction
+} asrc_stats_t;
+
+/**
+ * @brief Converter state. Owned by the caller; the members are private.
+ */
+typedef struct {
+    asrc_config_t config;
+    uint64_t nominal_step;          // Input frames per output frame, Q32.32
+    uint64_t step;                  // nominal_step with the controller correction
+    uint64_t position;              // Next output time after the newest input frame, Q32.32
+    float integral_ppm;
+    float correction_ppm;
+    uint32_t history_index;
+    int16_t history[ASRC_MAX_CHANNELS][2 * ASRC_TAPS];     // Each sample stored twice, see asrc.c
+    int16_t coef_q15[ASRC_PHASES + 1][ASRC_TAPS];
+#if (ASRC_FLOAT_PATH == 1)
+    float coef[ASRC_PHASES + 1][ASRC_TAPS];
+#endif
+    asrc_stats_t stats;
+} asrc_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Designs the filter and resets the state.
+ *
+ * @param[out] p_asrc The converter to initialize.
+ * @param[in] p_config The configuration; copied.
+ *
+ * @return true on success, false if the configuration is invalid.
+ */
+bool asrc_init(asrc_t* p_asrc, const asrc_config_t* p_config);
+
+/**
+ * @brief Largest number of output frames one call can produce for `in_frames`.
+ * @details Accounts for the nominal ratio and the largest correction.
+ */
+size_t asrc_max_output_frames(const asrc_t* p_asrc, size_t in_frames);
+
+/**
+ * @brief Converts a block with the fixed-point path.
+ *
+ * @details Consumes every input frame. The number of output frames varies
+ *          from call to call with the ratio and the carried sub-sample
+ *          position; frames beyond `out_capacity` are dropped and counted.
+ *          The group delay is ASRC_TAPS / 2 input frames.
+ *
+ * @param[in,out] p_asrc The converter.
+ * @param[in] p_in Interleaved input frames.
+ * @param[in] in_frames Number of input frames.
+ * @param[out] p_out Interleaved output frames.
+ * @param[in] out_capacity Capacity of `p_out` in frames.
+ *
+ * @return Number of output frames written.
+ */
+size_t asrc_process_q15(asrc_t* p_asrc, const int16_t* p_in, size_t in_frames,
+                        int16_t* p_out, size_t out_capacity);
+
+#if (ASRC_FLOAT_PATH == 1)
+/**
+ * @brief Converts a block with the float reference path. See asrc_process_q15().
+ */
+size_t asrc_process(asrc_t* p_asrc, const int16_t* p_in, size_t in_frames,
+                    int16_t* p_out, size_t out_capacity);
+#endif
+
+/**
+ * @brief Runs one PI controller update and applies the new ratio.
+ *
+ * @param[in,out] p_asrc The converter.
+ * @param[in] fill_error_frames Fill level of the output buffer minus its
+ *            target, in frames. Positive when the consumer falls behind,
+ *            which makes the converter produce fewer frames.
+ */
+void asrc_steer(asrc_t* p_asrc, float fill_error_frames);
+
+/**
+ * @brief Sets the ratio correction directly, bypassing the controller.
+ * @param[in,out] p_asrc The converter.
+ * @param[in] correction_ppm Positive values produce fewer output frames.
+ */
+void asrc_set_correction(asrc_t* p_asrc, float correction_ppm);
+
+/**
+ * @brief Copies the statistics.
+ * @param[in] p_asrc The converter.
+ * @param[out] p_stats Destination structure.
+ */
+void asrc_get_stats(const asrc_t* p_asrc, asrc_stats_t* p_stats);
+
+#endif // ASRC_H
@@ -0,0 +1,318 @@
+/**
+ * @file      asrc.c
+ * @brief     Asynchronous sample-rate converter for 16-bit interleaved audio.
+ *
+ * @details   Time is kept in input frames as Q32.32. After each input frame is
+ *            pushed, `position` holds the time of the next output frame
+ *            relative to that frame; every output frame whose time falls
+ *            before the next input frame (position < 1.0) is produced, and
+ *            position advances by `step`, the input/output rate ratio.
+ *
+ *            Output frame at fraction mu is centred ASRC_TAPS / 2 frames
+ *            behind the newest input, so the filter window is fully inside
+ *            the history: y = sum_j x[n - TAPS + 1 + j] * h(TAPS/2 - 1 - j + mu).
+ *            Phase row p of the table holds h for mu = p / ASRC_PHASES; the
+ *            extra row p = ASRC_PHASES lets the interpolation read p + 1.
+ */
+
+#include "asrc.h"
+
+#include <math.h>
+#include <string.h>
+
+_Static_assert(ASRC_TAPS % 2 == 0 && ASRC_TAPS >= 4, "ASRC_TAPS must be even");
+_Static_assert(ASRC_PHASES_LOG2 >= 1 && ASRC_PHASES_LOG2 <= 10, "ASRC_PHASES_LOG2 out of range");
+
+#define ASRC_ONE                (1ULL << 32)
+#define ASRC_FRAC_SHIFT         (32 - ASRC_PHASES_LOG2)
+#define ASRC_PI                 3.14159265358979f
+
+// --- Private Helper Functions ---
+
+/** @brief Modified Bessel function of the first kind, order 0, by its power series. */
+static float bessel_i0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    float half_x = 0.5f * x;
+    for (int k = 1; k < 32; ++k) {
+        term *= (half_x / (float)k) * (half_x / (float)k);
+        sum += term;
+        if (term < sum * 1e-9f) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief Kaiser-windowed sinc prototype.
+ * @param[in] t Time in input frames, within [-ASRC_TAPS/2, ASRC_TAPS/2].
+ * @param[in] fc Cutoff in cycles per input frame.
+ */
+static float prototype(float t, float fc) {
+    const float half_span = (float)(ASRC_TAPS / 2);
+    float r = t / half_span;
+    if (r <= -1.0f || r >= 1.0f) {
+        return 0.0f;
+    }
+    float window = bessel_i0(ASRC_KAISER_BETA * sqrtf(1.0f - r * r)) / bessel_i0(ASRC_KAISER_BETA);
+    float x = 2.0f * fc * t;
+    float sinc = (fabsf(x) < 1e-6f) ? 1.0f : sinf(ASRC_PI * x) / (ASRC_PI * x);
+    return 2.0f * fc * sinc * window;
+}
+
+/**
+ * @brief Designs one phase row, normalized to unity DC gain.
+ * @return false if the Q15 row could overflow the 32-bit accumulator.
+ */
+static bool design_phase(asrc_t* p_asrc, uint32_t phase, float fc) {
+    float row[ASRC_TAPS];
+    float mu = (float)phase / (float)ASRC_PHASES;
+    float sum = 0.0f;
+
+    for (int j = 0; j < ASRC_TAPS; ++j) {
+        row[j] = prototype((float)(ASRC_TAPS / 2 - 1 - j) + mu, fc);
+        sum += row[j];
+    }
+    if (sum <= 0.0f) {
+        return false;
+    }
+
+    // Quantize, then put the rounding residue on the largest tap so the Q15
+    // row also has exact unity gain and a constant input passes unchanged
+    int32_t q_sum = 0;
+    int32_t abs_sum = 0;
+    int largest = 0;
+    for (int j = 0; j < ASRC_TAPS; ++j) {
+        row[j] /= sum;
+#if (ASRC_FLOAT_PATH == 1)
+        p_asrc->coef[phase][j] = row[j];
+#endif
+        float scaled = row[j] * 32768.0f;
+        int32_t q = (int32_t)lrintf(scaled);
+        if (q > INT16_MAX) {
+            q = INT16_MAX;
+        } else if (q < INT16_MIN) {
+            q = INT16_MIN;
+        }
+        p_asrc->coef_q15[phase][j] = (int16_t)q;
+        q_sum += q;
+        if (row[j] > row[largest]) {
+            largest = j;
+        }
+    }
+    int32_t fixed = p_asrc->coef_q15[phase][largest] + (32768 - q_sum);
+    if (fixed > INT16_MAX) {
+        fixed = INT16_MAX;
+    }
+    p_asrc->coef_q15[phase][largest] = (int16_t)fixed;
+
+    for (int j = 0; j < ASRC_TAPS; ++j) {
+        int32_t c = p_asrc->coef_q15[phase][j];
+        abs_sum += (c < 0) ? -c : c;
+    }
+    // |sample| <= 32768, so the dot product stays below 2^31
+    return abs_sum < 65536;
+}
+
+static void apply_correction(asrc_t* p_asrc, float correction_ppm) {
+    float limit = p_asrc->config.max_correction_ppm;
+    if (correction_ppm > limit) {
+        correction_ppm = limit;
+    } else if (correction_ppm < -limit) {
+        correction_ppm = -limit;
+    }
+    p_asrc->correction_ppm = correction_ppm;
+
+    // Only the small delta goes through float; the nominal step stays exact
+    int64_t delta = (int64_t)((float)p_asrc->nominal_step * correction_ppm * 1e-6f);
+    p_asrc->step = (uint64_t)((int64_t)p_asrc->nominal_step + delta);
+}
+
+/** @brief Appends one input frame to the history of every channel. */
+static inline void push_frame(asrc_t* p_asrc, const int16_t* p_frame, uint8_t channels) {
+    uint32_t index = p_asrc->history_index + 1;
+    if (index == ASRC_TAPS) {
+        index = 0;
+    }
+    p_asrc->history_index = index;
+
+    // Each sample is written twice, so the last ASRC_TAPS samples are always
+    // contiguous at &history[index + 1], oldest first, with no wrap in the loop
+    for (uint8_t ch = 0; ch < channels; ++ch) {
+        p_asrc->history[ch][index] = p_frame[ch];
+        p_asrc->history[ch][index + ASRC_TAPS] = p_frame[ch];
+    }
+}
+
+static inline int16_t saturate_q15(int64_t value) {
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)value;
+}
+
+static inline int32_t dot_q15(const int16_t* p_x, const int16_t* p_c) {
+    int32_t acc = 0;
+    for (int j = 0; j < ASRC_TAPS; ++j) {
+        acc += (int32_t)p_x[j] * p_c[j];
+    }
+    return acc;
+}
+
+static void output_frame_q15(const asrc_t* p_asrc, uint32_t position, int16_t* p_out) {
+    uint32_t phase = position >> ASRC_FRAC_SHIFT;
+    int32_t frac = (int32_t)((position >> (ASRC_FRAC_SHIFT - 15)) & 0x7FFF);
+    const int16_t* c0 = p_asrc->coef_q15[phase];
+    const int16_t* c1 = p_asrc->coef_q15[phase + 1];
+
+    for (uint8_t ch = 0; ch < p_asrc->config.channels; ++ch) {
+        const int16_t* x = &p_asrc->history[ch][p_asrc->history_index + 1];
+        int32_t a = dot_q15(x, c0);
+        int32_t b = dot_q15(x, c1);
+        // Q30 result; the neighbouring phases are interpolated in 64 bits
+        int64_t y = (int64_t)a + ((((int64_t)b - a) * frac) >> 15);
+        p_out[ch] = saturate_q15((y + (1 << 14)) >> 15);
+    }
+}
+
+#if (ASRC_FLOAT_PATH == 1)
+static void output_frame_float(const asrc_t* p_asrc, uint32_t position, int16_t* p_out) {
+    uint32_t phase = position >> ASRC_FRAC_SHIFT;
+    float frac = (float)(position & ((1UL << ASRC_FRAC_SHIFT) - 1)) * (1.0f / (float)(1UL << ASRC_FRAC_SHIFT));
+    const float* c0 = p_asrc->coef[phase];
+    const float* c1 = p_asrc->coef[phase + 1];
+
+    for (uint8_t ch = 0; ch < p_asrc->config.channels; ++ch) {
+        const int16_t* x = &p_asrc->history[ch][p_asrc->history_index + 1];
+        float a = 0.0f;
+        float b = 0.0f;
+        for (int j = 0; j < ASRC_TAPS; ++j) {
+            a += (float)x[j] * c0[j];
+            b += (float)x[j] * c1[j];
+        }
+        p_out[ch] = saturate_q15((int64_t)lrintf(a + (b - a) * frac));
+    }
+}
+#endif
+
+typedef void (*output_frame_fn)(const asrc_t* p_asrc, uint32_t position, int16_t* p_out);
+
+static size_t process(asrc_t* p_asrc, output_frame_fn output_frame, const int16_t* p_in, size_t in_frames,
+                      int16_t* p_out, size_t out_capacity) {
+    uint8_t channels = p_asrc->config.channels;
+    uint64_t position = p_asrc->position;
+    uint64_t step = p_asrc->step;
+    size_t written = 0;
+    uint32_t dropped = 0;
+
+    for (size_t i = 0; i < in_frames; ++i) {
+        push_frame(p_asrc, &p_in[i * channels], channels);
+        while (position < ASRC_ONE) {
+            if (written < out_capacity) {
+                output_frame(p_asrc, (uint32_t)position, &p_out[written * channels]);
+                ++written;
+            } else {
+                ++dropped;
+            }
+            position += step;
+        }
+        position -= ASRC_ONE;
+    }
+
+    p_asrc->position = position;
+    p_asrc->stats.frames_in += (uint32_t)in_frames;
+    p_asrc->stats.frames_out += (uint32_t)written;
+    p_asrc->stats.frames_dropped += dropped;
+    return written;
+}
+
+// --- Public API Function Implementations ---
+
+bool asrc_init(asrc_t* p_asrc, const asrc_config_t* p_config) {
+    if (p_asrc == NULL || p_config == NULL || p_config->input_rate_hz == 0 || p_config->output_rate_hz == 0 ||
+        p_config->channels == 0 || p_config->channels > ASRC_MAX_CHANNELS || p_config->max_correction_ppm < 0.0f) {
+        return false;
+    }
+
+    memset(p_asrc, 0, sizeof(*p_asrc));
+    p_asrc->config = *p_config;
+
+    // Below the lower of the two Nyquist frequencies, in cycles per input frame
+    float ratio = (float)p_config->output_rate_hz / (float)p_config->input_rate_hz;
+    float fc = 0.5f * ASRC_CUTOFF * ((ratio < 1.0f) ? ratio : 1.0f);
+    for (uint32_t phase = 0; phase <= ASRC_PHASES; ++phase) {
+        if (!design_phase(p_asrc, phase, fc)) {
+            return false;
+        }
+    }
+
+    p_asrc->nominal_step = ((uint64_t)p_config->input_rate_hz << 32) / p_config->output_rate_hz;
+    p_asrc->step = p_asrc->nominal_step;
+    return true;
+}
+
+size_t asrc_max_output_frames(const asrc_t* p_asrc, size_t in_frames) {
+    if (p_asrc == NULL) {
+        return 0;
+    }
+    float ratio = (float)p_asrc->config.output_rate_hz / (float)p_asrc->config.input_rate_hz;
+    float frames = (float)in_frames * ratio * (1.0f + p_asrc->config.max_correction_ppm * 1e-6f);
+    // One more for the carried position and one for float rounding
+    return (size_t)frames + 2;
+}
+
+size_t asrc_process_q15(asrc_t* p_asrc, const int16_t* p_in, size_t in_frames,
+                        int16_t* p_out, size_t out_capacity) {
+    if (p_asrc == NULL || p_in == NULL || p_out == NULL) {
+        return 0;
+    }
+    return process(p_asrc, output_frame_q15, p_in, in_frames, p_out, out_capacity);
+}
+
+#if (ASRC_FLOAT_PATH == 1)
+size_t asrc_process(asrc_t* p_asrc, const int16_t* p_in, size_t in_frames,
+                    int16_t* p_out, size_t out_capacity) {
+    if (p_asrc == NULL || p_in == NULL || p_out == NULL) {
+        return 0;
+    }
+    return process(p_asrc, output_frame_float, p_in, in_frames, p_out, out_capacity);
+}
+#endif
+
+void asrc_steer(asrc_t* p_asrc, float fill_error_frames) {
+    if (p_asrc == NULL) {
+        return;
+    }
+    const asrc_config_t* config = &p_asrc->config;
+
+    // The integral is clamped on its own so it cannot wind up during a stall
+    float integral = p_asrc->integral_ppm + config->ki_ppm * fill_error_frames;
+    if (integral > config->max_correction_ppm) {
+        integral = config->max_correction_ppm;
+    } else if (integral < -config->max_correction_ppm) {
+        integral = -config->max_correction_ppm;
+    }
+    p_asrc->integral_ppm = integral;
+
+    apply_correction(p_asrc, config->kp_ppm * fill_error_frames + integral);
+}
+
+void asrc_set_correction(asrc_t* p_asrc, float correction_ppm) {
+    if (p_asrc == NULL) {
+        return;
+    }
+    p_asrc->integral_ppm = correction_ppm;
+    apply_correction(p_asrc, correction_ppm);
+}
+
+void asrc_get_stats(const asrc_t* p_asrc, asrc_stats_t* p_stats) {
+    if (p_asrc == NULL || p_stats == NULL) {
+        return;
+    }
+    *p_stats = p_asrc->stats;
+    p_stats->correction_ppm = p_asrc->correction_ppm;
+}
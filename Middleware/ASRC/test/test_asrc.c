@@ -0,0 +1,206 @@
+/**
+ * @file      test_asrc.c
+ * @brief     Host test of the ASRC: conversion quality, ratio and steering.
+ *
+ * @details   Converts a 1 kHz tone from 44.1 kHz to 48 kHz on both paths and
+ *            measures THD+N with a sine fit over whole periods, as
+ *            asrc_bench_run() does on target. Checks that a ratio correction
+ *            changes the output rate by as many ppm, and that the PI
+ *            controller, fed the fill of a buffer drained by a clock
+ *            off by -200 to +200 ppm, settles on that drift with the fill
+ *            on target and never strays half a block from it on the way.
+ */
+
+#include "asrc.h"
+#include "unit_test.h"
+
+#include <math.h>
+#include <string.h>
+
+#define TONE_HZ             1000
+#define TONE_AMPLITUDE      16384.0
+#define BLOCK_FRAMES        64
+#define OUT_FRAMES          80
+#define SETTLE_FRAMES       480         // Well past the group delay
+#define FIT_FRAMES          (48 * 200)  // 200 periods at 48 kHz
+#define THDN_LIMIT_DB       (-80.0)
+
+// Gains and limit of the firmware, see audio_config.h
+#define KP_PPM              10.0f
+#define KI_PPM              0.01f
+#define MAX_PPM             1000.0f
+
+static asrc_t s_asrc;
+
+typedef size_t (*process_fn)(asrc_t* p_asrc, const int16_t* p_in, size_t in_frames,
+                             int16_t* p_out, size_t out_capacity);
+
+/** @brief THD+N of a 44.1 to 48 kHz stereo conversion, in dB; amplitude of the fitted sine. */
+static double tone_thdn_db(process_fn process, double* p_amplitude) {
+    const asrc_config_t config = {44100, 48000, 2, KP_PPM, KI_PPM, MAX_PPM};
+    TEST_CHECK(asrc_init(&s_asrc, &config));
+
+    int16_t in[2 * BLOCK_FRAMES];
+    int16_t out[2 * OUT_FRAMES];
+    double sum_sin = 0.0, sum_cos = 0.0, sum = 0.0, sum_sq = 0.0;
+    long fitted = 0, out_index = 0, in_index = 0;
+
+    while (fitted < FIT_FRAMES) {
+        for (int i = 0; i < BLOCK_FRAMES; ++i, ++in_index) {
+            // Phase from an exact integer count, so the input has no drift of its own
+            double phase = (double)((in_index * TONE_HZ) % 44100) / 44100.0;
+            int16_t sample = (int16_t)lrint(TONE_AMPLITUDE * sin(2.0 * M_PI * phase));
+            in[2 * i] = sample;
+            in[2 * i + 1] = sample;
+        }
+        size_t frames = process(&s_asrc, in, BLOCK_FRAMES, out, OUT_FRAMES);
+        TEST_CHECK(frames <= asrc_max_output_frames(&s_asrc, BLOCK_FRAMES));
+        for (size_t i = 0; i < frames && fitted < FIT_FRAMES; ++i, ++out_index) {
+            TEST_CHECK(out[2 * i] == out[2 * i + 1]);
+            if (out_index < SETTLE_FRAMES) {
+                continue;
+            }
+            double y = out[2 * i];
+            double w = 2.0 * M_PI * (double)(out_index % 48) / 48.0;
+            sum_sin += y * sin(w);
+            sum_cos += y * cos(w);
+            sum += y;
+            sum_sq += y * y;
+            fitted++;
+        }
+    }
+
+    // Least squares over whole periods: the fitted sine is the signal, the rest is THD+N
+    double a = 2.0 * sum_sin / fitted;
+    double b = 2.0 * sum_cos / fitted;
+    double dc = sum / fitted;
+    double signal = fitted * (a * a + b * b) / 2.0;
+    double residual = sum_sq - signal - fitted * dc * dc;
+    *p_amplitude = sqrt(a * a + b * b);
+    return 10.0 * log10(residual / signal);
+}
+
+static void test_tone(void) {
+    double amplitude;
+    double thdn = tone_thdn_db(asrc_process_q15, &amplitude);
+    printf("Q15 path: THD+N %.1f dB, amplitude %.1f\n", thdn, amplitude);
+    TEST_CHECK(thdn < THDN_LIMIT_DB);
+    TEST_CHECK(fabs(amplitude - TONE_AMPLITUDE) < TONE_AMPLITUDE * 1e-3);
+
+#if (ASRC_FLOAT_PATH == 1)
+    thdn = tone_thdn_db(asrc_process, &amplitude);
+    printf("float path: THD+N %.1f dB, amplitude %.1f\n", thdn, amplitude);
+    TEST_CHECK(thdn < THDN_LIMIT_DB);
+    TEST_CHECK(fabs(amplitude - TONE_AMPLITUDE) < TONE_AMPLITUDE * 1e-3);
+#endif
+}
+
+static void test_correction_ratio(void) {
+    const asrc_config_t config = {48000, 48000, 1, KP_PPM, KI_PPM, MAX_PPM};
+    int16_t in[100];
+    int16_t out[120];
+    long total = 0;
+
+    TEST_CHECK(asrc_init(&s_asrc, &config));
+    asrc_set_correction(&s_asrc, 200.0f);
+    for (int i = 0; i < 100; ++i) {
+        in[i] = 10000;
+    }
+    for (int block = 0; block < 1000; ++block) {
+        size_t frames = asrc_process_q15(&s_asrc, in, 100, out, 120);
+        total += (long)frames;
+        if (block > 0) {
+            TEST_CHECK(out[frames - 1] == 10000);       // Unity gain at DC
+        }
+    }
+
+    // 200 ppm fewer frames, less the ramp-in of the filter
+    double ppm = ((double)total / 100000.0 - 1.0) * 1e6;
+    TEST_CHECK(ppm < -180.0 && ppm > -220.0);
+
+    asrc_stats_t stats;
+    asrc_get_stats(&s_asrc, &stats);
+    TEST_CHECK(stats.frames_in == 100000 && stats.frames_out == (uint32_t)total);
+    TEST_CHECK(stats.frames_dropped == 0 && stats.correction_ppm == 200.0f);
+}
+
+/**
+ * @brief Steers against a consumer off by `drift_ppm`; positive runs slow.
+ * @details The buffer is drained one block per step. After every drain, the
+ *          fill must stay within half a block of its target, so the consumer
+ *          never comes near an underrun or an overflow.
+ */
+static void test_steering(double drift_ppm) {
+    const asrc_config_t config = {48000, 48000, 1, KP_PPM, KI_PPM, MAX_PPM};
+    const double target = 1.5 * BLOCK_FRAMES;
+    int16_t in[BLOCK_FRAMES] = {0};
+    int16_t out[OUT_FRAMES];
+    double fill = target;
+    double fill_min = target;
+    double fill_max = target;
+    long out_of_bounds = 0;
+
+    TEST_CHECK(asrc_init(&s_asrc, &config));
+    for (int block = 0; block < 200000; ++block) {
+        fill += (double)asrc_process_q15(&s_asrc, in, BLOCK_FRAMES, out, OUT_FRAMES);
+        fill -= BLOCK_FRAMES * (1.0 - drift_ppm * 1e-6);
+        asrc_steer(&s_asrc, (float)(fill - target));
+        fill_min = (fill < fill_min) ? fill : fill_min;
+        fill_max = (fill > fill_max) ? fill : fill_max;
+        out_of_bounds += (fabs(fill - target) > BLOCK_FRAMES / 2);
+    }
+
+    asrc_stats_t stats;
+    asrc_get_stats(&s_asrc, &stats);
+    printf("steering at %+.0f ppm: correction %.1f ppm, fill error %.2f frames, fill %.1f..%.1f\n",
+           drift_ppm, stats.correction_ppm, fill - target, fill_min, fill_max);
+    TEST_CHECK(out_of_bounds == 0);
+    TEST_CHECK(fabs(stats.correction_ppm - drift_ppm) < 15.0);
+    TEST_CHECK(fabs(fill - target) < 2.0);
+    TEST_CHECK(stats.frames_dropped == 0);
+}
+
+static void test_steering_limit(void) {
+    const asrc_config_t config = {48000, 48000, 1, KP_PPM, KI_PPM, MAX_PPM};
+    const double target = 1.5 * BLOCK_FRAMES;
+    int16_t in[BLOCK_FRAMES] = {0};
+    int16_t out[OUT_FRAMES];
+    double fill = target;
+
+    // The limit holds against a drift the controller cannot follow
+    TEST_CHECK(asrc_init(&s_asrc, &config));
+    for (int block = 0; block < 20000; ++block) {
+        fill += (double)asrc_process_q15(&s_asrc, in, BLOCK_FRAMES, out, OUT_FRAMES);
+        fill -= BLOCK_FRAMES * (1.0 - 5000e-6);
+        asrc_steer(&s_asrc, (float)(fill - target));
+    }
+    asrc_stats_t stats;
+    asrc_get_stats(&s_asrc, &stats);
+    TEST_CHECK(stats.correction_ppm <= MAX_PPM);
+    TEST_CHECK(stats.correction_ppm > MAX_PPM * 0.99f);
+}
+
+static void test_invalid_config(void) {
+    asrc_config_t config = {48000, 48000, 0, KP_PPM, KI_PPM, MAX_PPM};
+    TEST_CHECK(!asrc_init(&s_asrc, &config));
+    config.channels = ASRC_MAX_CHANNELS + 1;
+    TEST_CHECK(!asrc_init(&s_asrc, &config));
+    config.channels = 1;
+    config.input_rate_hz = 0;
+    TEST_CHECK(!asrc_init(&s_asrc, &config));
+    config.input_rate_hz = 48000;
+    config.max_correction_ppm = -1.0f;
+    TEST_CHECK(!asrc_init(&s_asrc, &config));
+    TEST_CHECK(!asrc_init(NULL, &config));
+}
+
+int main(void) {
+    test_tone();
+    test_correction_ratio();
+    test_steering(-200.0);
+    test_steering(150.0);
+    test_steering(200.0);
+    test_steering_limit();
+    test_invalid_config();
+    return TEST_EXIT();
+}
@@ -0,0 +1,246 @@
+/**
+ * @file      ctrl.h
+ * @brief     Control-signal conditioning: smoothing, tilt, response curves,
+ *            per-sample parameter ramps and sample-timed events.
+ *
+ * @details   Building blocks between a noisy, low-rate sensor and audio
+ *            parameters that must not step:
+ *
+ *            - ctrl_biquad_t: second-order low-pass, used at the sensor rate
+ *              to remove vibration and alias before decimation.
+ *            - ctrl_one_euro_t: the one-euro filter, a first-order low-pass
+ *              whose cutoff rises with the speed of the signal, so a still
+ *              hand gives a steady value and a fast gesture little lag.
+ *            - ctrl_tilt(): roll and pitch from a gravity vector with atan2.
+ *            - ctrl_curve_t: maps a range to 0..1 with a flat dead zone
+ *              around the centre and a power-law shape.
+ *            - ctrl_ramp_t: interpolates a parameter sample by sample towards
+ *              a new target over a given number of samples, linearly (gains,
+ *              depths) or exponentially (times, rates, frequencies).
+ *            - ctrl_event_heap_t: control events ordered by the sample they
+ *              apply at, in a binary min-heap over caller-provided storage:
+ *              O(log n) insert and removal, O(1) look at the next event.
+ *
+ * @note      The library has no RTOS or hardware dependency. All state is
+ *            owned by the caller and is not thread-safe.
+ */
+
+#ifndef CTRL_H
+#define CTRL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Public Types --- */
+
+/**
+ * @brief Biquad filter, transposed direct form II.
+ */
+typedef struct {
+    float b0, b1, b2;
+    float a1, a2;
+    float z1, z2;
+} ctrl_biquad_t;
+
+/**
+ * @brief One-euro filter state.
+ */
+typedef struct {
+    float min_cutoff_hz;            // Cutoff when the signal is still
+    float beta;                     // Cutoff increase in Hz per unit/s of signal speed
+    float d_cutoff_hz;              // Cutoff of the speed estimate
+    float x;                        // Last output
+    float dx;                       // Last filtered speed
+    bool is_primed;
+} ctrl_one_euro_t;
+
+/**
+ * @brief Response curve from an input range to 0..1.
+ * @details The input is clamped to [in_min, in_max] and centred: in_min maps
+ *          to 0, the middle of the range to 0.5 and in_max to 1. Inside the
+ *          dead zone the output stays at 0.5; outside it the remaining travel
+ *          is rescaled, so the curve is continuous, and shaped by `gamma`.
+ */
+typedef struct {
+    float in_min;
+    float in_max;
+    float dead_zone;                // Width of the flat centre, as a fraction of the range (0..1)
+    float gamma;                    // 1 linear, > 1 finer control near the centre
+} ctrl_curve_t;
+
+/** @brief Interpolation law of a ramp. */
+typedef enum {
+    CTRL_RAMP_LINEAR = 0,           // Constant increment per sample
+    CTRL_RAMP_EXPONENTIAL,          // Constant ratio per sample; values must be positive
+} ctrl_ramp_mode_t;
+
+/**
+ * @brief Per-sample parameter ramp.
+ */
+typedef struct {
+    ctrl_ramp_mode_t mode;
+    float value;
+    float target;
+    float step;                     // Increment, or ratio for CTRL_RAMP_EXPONENTIAL
+    uint32_t remaining;             // Samples left until the target
+} ctrl_ramp_t;
+
+/**
+ * @brief A control event, due at an absolute sample position.
+ */
+typedef struct {
+    uint32_t sample;                // Sample position it applies at
+    uint32_t seq;                   // Insertion order, set by ctrl_event_heap_push()
+    uint16_t id;                    // Meaning defined by the application
+    float value;
+} ctrl_event_t;
+
+/**
+ * @brief Min-heap of events, earliest sample first.
+ * @details Sample positions wrap; they are compared by their signed
+ *          difference, so all pending events must lie within 2^31 samples
+ *          of each other (12 hours at 48 kHz). Events at the same sample
+ *          come out in the order they were pushed.
+ */
+typedef struct {
+    ctrl_event_t* p_events;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t next_seq;
+} ctrl_event_heap_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Designs a low-pass biquad (RBJ cookbook) and clears its state.
+ *
+ * @param[out] p_bq Filter to initialise.
+ * @param[in] sample_rate_hz Rate at which ctrl_biquad_process() is called.
+ * @param[in] cutoff_hz -3 dB frequency, below half the sample rate.
+ * @param[in] q Quality factor; 0.7071 for a Butterworth response.
+ */
+void ctrl_biquad_lowpass(ctrl_biquad_t* p_bq, float sample_rate_hz, float cutoff_hz, float q);
+
+/**
+ * @brief Sets the state to the steady state of a constant input, so the
+ *        filter starts without a transient.
+ */
+void ctrl_biquad_reset(ctrl_biquad_t* p_bq, float value);
+
+/** @brief Filters one sample. */
+static inline float ctrl_biquad_process(ctrl_biquad_t* p_bq, float x) {
+    float y = p_bq->b0 * x + p_bq->z1;
+    p_bq->z1 = p_bq->b1 * x - p_bq->a1 * y + p_bq->z2;
+    p_bq->z2 = p_bq->b2 * x - p_bq->a2 * y;
+    return y;
+}
+
+/**
+ * @brief Initialises a one-euro filter. The first update passes through.
+ *
+ * @param[out] p_filter Filter to initialise.
+ * @param[in] min_cutoff_hz Cutoff when the signal is still; lower is steadier.
+ * @param[in] beta Cutoff increase per unit/s of speed; higher lags less.
+ * @param[in] d_cutoff_hz Cutoff of the speed estimate, typically 1 Hz.
+ */
+void ctrl_one_euro_init(ctrl_one_euro_t* p_filter, float min_cutoff_hz, float beta, float d_cutoff_hz);
+
+/**
+ * @brief Filters one value.
+ * @param[in,out] p_filter The filter.
+ * @param[in] x New value.
+ * @param[in] dt_s Time since the previous value, in seconds (> 0).
+ * @return The filtered value.
+ */
+float ctrl_one_euro_update(ctrl_one_euro_t* p_filter, float x, float dt_s);
+
+/**
+ * @brief Computes tilt angles from an acceleration vector at rest.
+ * @details Roll is the rotation about X (positive with +Y up), pitch the
+ *          rotation about Y (positive with +X up); both are 0 when Z points
+ *          up. Units of the input cancel out.
+ *
+ * @param[in] x, y, z Acceleration components.
+ * @param[out] p_roll Roll in radians, -pi..pi.
+ * @param[out] p_pitch Pitch in radians, -pi/2..pi/2.
+ */
+void ctrl_tilt(float x, float y, float z, float* p_roll, float* p_pitch);
+
+/**
+ * @brief Maps a value through a response curve.
+ * @return The mapped value, 0..1.
+ */
+float ctrl_curve_map(const ctrl_curve_t* p_curve, float x);
+
+/**
+ * @brief Initialises a ramp at rest.
+ * @param[out] p_ramp Ramp to initialise.
+ * @param[in] mode Interpolation law.
+ * @param[in] value Initial value; positive for CTRL_RAMP_EXPONENTIAL.
+ */
+void ctrl_ramp_init(ctrl_ramp_t* p_ramp, ctrl_ramp_mode_t mode, float value);
+
+/**
+ * @brief Starts a ramp from the current value to a new target.
+ * @details The target is reached exactly after `samples` calls of
+ *          ctrl_ramp_next(); 0 jumps to it at once. Calling this once per
+ *          audio block with the block length makes the parameter a
+ *          piecewise ramp with no steps at block boundaries.
+ *
+ * @param[in,out] p_ramp The ramp.
+ * @param[in] target New target; positive for CTRL_RAMP_EXPONENTIAL.
+ * @param[in] samples Length of the ramp in samples.
+ */
+void ctrl_ramp_set_target(ctrl_ramp_t* p_ramp, float target, uint32_t samples);
+
+/** @brief Advances the ramp by one sample and returns the new value. */
+static inline float ctrl_ramp_next(ctrl_ramp_t* p_ramp) {
+    if (p_ramp->remaining != 0) {
+        if (--p_ramp->remaining == 0) {
+            p_ramp->value = p_ramp->target;
+        } else if (p_ramp->mode == CTRL_RAMP_LINEAR) {
+            p_ramp->value += p_ramp->step;
+        } else {
+            p_ramp->value *= p_ramp->step;
+        }
+    }
+    return p_ramp->value;
+}
+
+/**
+ * @brief Initialises an empty event heap.
+ * @param[out] p_heap Heap to initialise.
+ * @param[in] p_storage Array of `capacity` events; must stay valid.
+ * @param[in] capacity Largest number of pending events.
+ */
+void ctrl_event_heap_init(ctrl_event_heap_t* p_heap, ctrl_event_t* p_storage, uint32_t capacity);
+
+/**
+ * @brief Inserts an event.
+ * @return false if the heap is full.
+ */
+bool ctrl_event_heap_push(ctrl_event_heap_t* p_heap, const ctrl_event_t* p_event);
+
+/**
+ * @brief Removes the earliest event if it is due.
+ * @param[in,out] p_heap The heap.
+ * @param[in] sample Current sample position; events at or before it are due.
+ * @param[out] p_event The removed event.
+ * @return false if no event is due.
+ */
+bool ctrl_event_heap_pop_due(ctrl_event_heap_t* p_heap, uint32_t sample, ctrl_event_t* p_event);
+
+/**
+ * @brief Gets the sample position of the earliest event.
+ * @return false if the heap is empty.
+ */
+static inline bool ctrl_event_heap_peek(const ctrl_event_heap_t* p_heap, uint32_t* p_sample) {
+    if (p_heap->count == 0) {
+        return false;
+    }
+    *p_sample = p_heap->p_events[0].sample;
+    return true;
+}
+
+#endif // CTRL_H
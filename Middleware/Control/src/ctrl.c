@@ -0,0 +1,189 @@
+/**
+ * @file      ctrl.c
+ * @brief     Control-signal conditioning: smoothing, tilt, response curves,
+ *            per-sample parameter ramps and sample-timed events.
+ */
+
+#include "ctrl.h"
+
+#include <math.h>
+
+#define CTRL_TWO_PI             6.2831853f
+#define CTRL_RAMP_MIN_POSITIVE  1e-9f           // Floor of exponential ramp values
+
+// --- Private Helper Functions ---
+
+/** @brief Smoothing factor of a first-order low-pass sampled every dt_s. */
+static float one_euro_alpha(float cutoff_hz, float dt_s) {
+    float tau = 1.0f / (CTRL_TWO_PI * cutoff_hz);
+    return 1.0f / (1.0f + tau / dt_s);
+}
+
+/** @brief Heap order: earlier sample first, then earlier insertion. */
+static bool event_before(const ctrl_event_t* a, const ctrl_event_t* b) {
+    int32_t diff = (int32_t)(a->sample - b->sample);
+    return (diff != 0) ? (diff < 0) : ((int32_t)(a->seq - b->seq) < 0);
+}
+
+// --- Public API Function Implementations ---
+
+void ctrl_biquad_lowpass(ctrl_biquad_t* p_bq, float sample_rate_hz, float cutoff_hz, float q) {
+    float w0 = CTRL_TWO_PI * cutoff_hz / sample_rate_hz;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+
+    p_bq->b0 = (1.0f - cos_w0) * 0.5f / a0;
+    p_bq->b1 = (1.0f - cos_w0) / a0;
+    p_bq->b2 = p_bq->b0;
+    p_bq->a1 = -2.0f * cos_w0 / a0;
+    p_bq->a2 = (1.0f - alpha) / a0;
+    ctrl_biquad_reset(p_bq, 0.0f);
+}
+
+void ctrl_biquad_reset(ctrl_biquad_t* p_bq, float value) {
+    // With x = y = value in steady state (unity DC gain)
+    p_bq->z1 = value - p_bq->b0 * value;
+    p_bq->z2 = (p_bq->b2 - p_bq->a2) * value;
+}
+
+void ctrl_one_euro_init(ctrl_one_euro_t* p_filter, float min_cutoff_hz, float beta, float d_cutoff_hz) {
+    p_filter->min_cutoff_hz = min_cutoff_hz;
+    p_filter->beta = beta;
+    p_filter->d_cutoff_hz = d_cutoff_hz;
+    p_filter->x = 0.0f;
+    p_filter->dx = 0.0f;
+    p_filter->is_primed = false;
+}
+
+float ctrl_one_euro_update(ctrl_one_euro_t* p_filter, float x, float dt_s) {
+    if (!p_filter->is_primed) {
+        p_filter->x = x;
+        p_filter->dx = 0.0f;
+        p_filter->is_primed = true;
+        return x;
+    }
+
+    // Speed of the signal, smoothed, sets the cutoff for the value itself
+    float dx = (x - p_filter->x) / dt_s;
+    p_filter->dx += one_euro_alpha(p_filter->d_cutoff_hz, dt_s) * (dx - p_filter->dx);
+    float cutoff_hz = p_filter->min_cutoff_hz + p_filter->beta * fabsf(p_filter->dx);
+    p_filter->x += one_euro_alpha(cutoff_hz, dt_s) * (x - p_filter->x);
+    return p_filter->x;
+}
+
+void ctrl_tilt(float x, float y, float z, float* p_roll, float* p_pitch) {
+    *p_roll = atan2f(y, z);
+    *p_pitch = atan2f(x, sqrtf(y * y + z * z));
+}
+
+float ctrl_curve_map(const ctrl_curve_t* p_curve, float x) {
+    float span = p_curve->in_max - p_curve->in_min;
+    if (span <= 0.0f) {
+        return 0.5f;
+    }
+
+    // -1..1 around the middle of the range
+    float u = 2.0f * (x - p_curve->in_min) / span - 1.0f;
+    if (u > 1.0f) u = 1.0f;
+    if (u < -1.0f) u = -1.0f;
+
+    float magnitude = fabsf(u);
+    float dead = p_curve->dead_zone;
+    if (magnitude <= dead || dead >= 1.0f) {
+        return 0.5f;
+    }
+    magnitude = (magnitude - dead) / (1.0f - dead);
+    if (p_curve->gamma != 1.0f) {
+        magnitude = powf(magnitude, p_curve->gamma);
+    }
+    return 0.5f + 0.5f * ((u < 0.0f) ? -magnitude : magnitude);
+}
+
+void ctrl_ramp_init(ctrl_ramp_t* p_ramp, ctrl_ramp_mode_t mode, float value) {
+    if (mode == CTRL_RAMP_EXPONENTIAL && value < CTRL_RAMP_MIN_POSITIVE) {
+        value = CTRL_RAMP_MIN_POSITIVE;
+    }
+    p_ramp->mode = mode;
+    p_ramp->value = value;
+    p_ramp->target = value;
+    p_ramp->step = (mode == CTRL_RAMP_LINEAR) ? 0.0f : 1.0f;
+    p_ramp->remaining = 0;
+}
+
+void ctrl_ramp_set_target(ctrl_ramp_t* p_ramp, float target, uint32_t samples) {
+    if (p_ramp->mode == CTRL_RAMP_EXPONENTIAL && target < CTRL_RAMP_MIN_POSITIVE) {
+        target = CTRL_RAMP_MIN_POSITIVE;
+    }
+    p_ramp->target = target;
+    if (samples == 0 || target == p_ramp->value) {
+        p_ramp->value = target;
+        p_ramp->remaining = 0;
+        return;
+    }
+
+    if (p_ramp->mode == CTRL_RAMP_LINEAR) {
+        p_ramp->step = (target - p_ramp->value) / (float)samples;
+    } else {
+        p_ramp->step = powf(target / p_ramp->value, 1.0f / (float)samples);
+    }
+    p_ramp->remaining = samples;
+}
+
+void ctrl_event_heap_init(ctrl_event_heap_t* p_heap, ctrl_event_t* p_storage, uint32_t capacity) {
+    p_heap->p_events = p_storage;
+    p_heap->capacity = capacity;
+    p_heap->count = 0;
+    p_heap->next_seq = 0;
+}
+
+bool ctrl_event_heap_push(ctrl_event_heap_t* p_heap, const ctrl_event_t* p_event) {
+    if (p_heap->count >= p_heap->capacity) {
+        return false;
+    }
+    ctrl_event_t event = *p_event;
+    event.seq = p_heap->next_seq++;
+
+    // Sift up: move parents down until the new event's slot is found
+    ctrl_event_t* events = p_heap->p_events;
+    uint32_t i = p_heap->count++;
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!event_before(&event, &events[parent])) {
+            break;
+        }
+        events[i] = events[parent];
+        i = parent;
+    }
+    events[i] = event;
+    return true;
+}
+
+bool ctrl_event_heap_pop_due(ctrl_event_heap_t* p_heap, uint32_t sample, ctrl_event_t* p_event) {
+    ctrl_event_t* events = p_heap->p_events;
+    if (p_heap->count == 0 || (int32_t)(events[0].sample - sample) > 0) {
+        return false;
+    }
+    *p_event = events[0];
+
+    // Sift the last event down from the root
+    ctrl_event_t last = events[--p_heap->count];
+    uint32_t count = p_heap->count;
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && event_before(&events[child + 1], &events[child])) {
+            child++;
+        }
+        if (!event_before(&events[child], &last)) {
+            break;
+        }
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+    return true;
+}
@@ -0,0 +1,292 @@
+/**
+ * @file      test_ctrl.c
+ * @brief     Host test of the control-signal conditioning blocks.
+ *
+ * @details   Checks the sensor-rate filters for gain and settling, the tilt
+ *            and curve mappings at their landmarks, and that the ramps reach
+ *            their target exactly with no step when retargeted mid-ramp or
+ *            block by block, as dspTask drives them. The event heap must
+ *            release events in sample order, and in push order within a
+ *            sample, across the wrap of the sample position.
+ */
+
+#include "ctrl.h"
+#include "unit_test.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define SENSOR_RATE_HZ      400.0f
+#define BLOCK_SAMPLES       64
+#define HEAP_EVENTS         4096
+
+static ctrl_event_t s_heap_storage[HEAP_EVENTS];
+
+static bool near(float a, float b, float tolerance) {
+    return fabsf(a - b) <= tolerance;
+}
+
+// --- Filters ---
+
+static void test_biquad(void) {
+    ctrl_biquad_t bq;
+    ctrl_biquad_lowpass(&bq, SENSOR_RATE_HZ, 20.0f, 0.7071f);
+
+    // Unity gain at DC, and no transient from a reset to the input
+    ctrl_biquad_reset(&bq, 3.0f);
+    float y = 0.0f;
+    for (int i = 0; i < 100; ++i) {
+        y = ctrl_biquad_process(&bq, 3.0f);
+        TEST_CHECK(near(y, 3.0f, 1e-4f));
+    }
+
+    // A tone at 8x the cutoff comes out about 36 dB down (second order)
+    ctrl_biquad_reset(&bq, 0.0f);
+    float peak = 0.0f;
+    for (int i = 0; i < 2000; ++i) {
+        y = ctrl_biquad_process(&bq, sinf(6.2831853f * 160.0f * (float)i / SENSOR_RATE_HZ));
+        if (i > 1000 && fabsf(y) > peak) {
+            peak = fabsf(y);
+        }
+    }
+    TEST_CHECK(peak < 0.02f);
+}
+
+static void test_one_euro(void) {
+    ctrl_one_euro_t filter;
+    const float dt = 1.0f / SENSOR_RATE_HZ;
+    ctrl_one_euro_init(&filter, 1.0f, 0.5f, 1.0f);
+
+    TEST_CHECK(ctrl_one_euro_update(&filter, 0.25f, dt) == 0.25f);     // First value passes
+
+    // Jitter on a still hand is smoothed well below its amplitude
+    float low = 1.0f, high = -1.0f;
+    for (int i = 0; i < 2000; ++i) {
+        float x = 0.25f + ((i & 1) ? 0.01f : -0.01f);
+        float y = ctrl_one_euro_update(&filter, x, dt);
+        if (i > 1000) {
+            low = (y < low) ? y : low;
+            high = (y > high) ? y : high;
+        }
+    }
+    TEST_CHECK(high - low < 0.002f);
+    TEST_CHECK(near(0.5f * (high + low), 0.25f, 0.002f));
+
+    // A fast move is followed with less lag than the still-hand cutoff alone gives
+    ctrl_one_euro_t slow;
+    ctrl_one_euro_init(&slow, 1.0f, 0.0f, 1.0f);
+    (void)ctrl_one_euro_update(&slow, 0.25f, dt);
+    float fast_y = 0.0f, slow_y = 0.0f;
+    for (int i = 1; i <= 80; ++i) {
+        float x = 0.25f + 0.01f * (float)i;
+        fast_y = ctrl_one_euro_update(&filter, x, dt);
+        slow_y = ctrl_one_euro_update(&slow, x, dt);
+    }
+    TEST_CHECK(fast_y > slow_y);
+    TEST_CHECK(near(fast_y, 1.05f, 0.2f));
+}
+
+static void test_tilt(void) {
+    float roll, pitch;
+    const float quarter = 1.5707963f;
+
+    ctrl_tilt(0.0f, 0.0f, 1.0f, &roll, &pitch);
+    TEST_CHECK(near(roll, 0.0f, 1e-6f) && near(pitch, 0.0f, 1e-6f));
+    ctrl_tilt(0.0f, 9.81f, 0.0f, &roll, &pitch);                       // Units cancel
+    TEST_CHECK(near(roll, quarter, 1e-5f) && near(pitch, 0.0f, 1e-6f));
+    ctrl_tilt(1.0f, 0.0f, 0.0f, &roll, &pitch);
+    TEST_CHECK(near(pitch, quarter, 1e-5f));
+    ctrl_tilt(-0.5f, 0.0f, 0.8660254f, &roll, &pitch);
+    TEST_CHECK(near(roll, 0.0f, 1e-6f) && near(pitch, -quarter / 3.0f, 1e-5f));
+}
+
+static void test_curve(void) {
+    const ctrl_curve_t curve = {-1.0f, 1.0f, 0.2f, 2.0f};
+
+    TEST_CHECK(ctrl_curve_map(&curve, -1.0f) == 0.0f);
+    TEST_CHECK(ctrl_curve_map(&curve, 1.0f) == 1.0f);
+    TEST_CHECK(ctrl_curve_map(&curve, 5.0f) == 1.0f);                  // Clamped
+    TEST_CHECK(ctrl_curve_map(&curve, 0.0f) == 0.5f);
+    TEST_CHECK(ctrl_curve_map(&curve, 0.2f) == 0.5f);                  // Edge of the dead zone
+    TEST_CHECK(ctrl_curve_map(&curve, -0.19f) == 0.5f);
+    TEST_CHECK(near(ctrl_curve_map(&curve, 0.6f), 0.625f, 1e-5f));     // Halfway out, squared
+    TEST_CHECK(near(ctrl_curve_map(&curve, -0.6f), 0.375f, 1e-5f));
+
+    // Continuous and rising over the whole range
+    float previous = 0.0f;
+    for (int i = 0; i <= 1000; ++i) {
+        float y = ctrl_curve_map(&curve, -1.0f + 0.002f * (float)i);
+        TEST_CHECK(y >= previous && y - previous < 0.01f);
+        previous = y;
+    }
+
+    const ctrl_curve_t empty = {1.0f, 1.0f, 0.0f, 1.0f};
+    TEST_CHECK(ctrl_curve_map(&empty, 7.0f) == 0.5f);
+}
+
+// --- Ramps ---
+
+static void test_ramp_linear(void) {
+    ctrl_ramp_t ramp;
+    ctrl_ramp_init(&ramp, CTRL_RAMP_LINEAR, 0.2f);
+    TEST_CHECK(ctrl_ramp_next(&ramp) == 0.2f);                          // At rest
+
+    ctrl_ramp_set_target(&ramp, 0.7f, 100);
+    float previous = 0.2f;
+    for (int i = 1; i <= 100; ++i) {
+        float value = ctrl_ramp_next(&ramp);
+        TEST_CHECK(near(value - previous, 0.005f, 1e-5f));             // Constant increment
+        TEST_CHECK(near(value, 0.2f + 0.005f * (float)i, 1e-5f));
+        previous = value;
+    }
+    TEST_CHECK(previous == 0.7f);                                       // Exactly, not by accumulation
+    TEST_CHECK(ctrl_ramp_next(&ramp) == 0.7f);
+
+    ctrl_ramp_set_target(&ramp, -1.0f, 0);                              // Jumps
+    TEST_CHECK(ramp.value == -1.0f && ctrl_ramp_next(&ramp) == -1.0f);
+}
+
+static void test_ramp_exponential(void) {
+    ctrl_ramp_t ramp;
+    ctrl_ramp_init(&ramp, CTRL_RAMP_EXPONENTIAL, 100.0f);
+
+    ctrl_ramp_set_target(&ramp, 1600.0f, 400);
+    float previous = 100.0f;
+    float value = 0.0f;
+    for (int i = 1; i <= 400; ++i) {
+        value = ctrl_ramp_next(&ramp);
+        if (i < 400) {
+            TEST_CHECK(near(value / previous, ramp.step, 1e-5f));          // Constant ratio
+        }
+        if (i == 200) {
+            TEST_CHECK(near(value, 400.0f, 0.1f));                         // Geometric midpoint
+        }
+        previous = value;
+    }
+    TEST_CHECK(value == 1600.0f);
+
+    // Values are kept positive
+    ctrl_ramp_set_target(&ramp, 0.0f, 10);
+    for (int i = 0; i < 10; ++i) {
+        value = ctrl_ramp_next(&ramp);
+        TEST_CHECK(value > 0.0f);
+    }
+    ctrl_ramp_init(&ramp, CTRL_RAMP_EXPONENTIAL, -3.0f);
+    TEST_CHECK(ramp.value > 0.0f);
+}
+
+static void test_ramp_blocks(void) {
+    ctrl_ramp_t linear, exponential;
+    ctrl_ramp_init(&linear, CTRL_RAMP_LINEAR, 0.0f);
+    ctrl_ramp_init(&exponential, CTRL_RAMP_EXPONENTIAL, 1.0f);
+
+    // A new target every block, some mid-ramp: the value never steps
+    float last_linear = 0.0f, last_exponential = 1.0f;
+    float max_linear = 0.0f, max_ratio = 1.0f;
+    for (int block = 0; block < 200; ++block) {
+        float target = (float)((block * 37) % 11) / 10.0f;
+        ctrl_ramp_set_target(&linear, target, BLOCK_SAMPLES);
+        ctrl_ramp_set_target(&exponential, 1.0f + 9.0f * target, (block % 3 == 0) ? 2 * BLOCK_SAMPLES : BLOCK_SAMPLES);
+        for (int i = 0; i < BLOCK_SAMPLES; ++i) {
+            float value = ctrl_ramp_next(&linear);
+            max_linear = fmaxf(max_linear, fabsf(value - last_linear));
+            last_linear = value;
+            value = ctrl_ramp_next(&exponential);
+            float ratio = (value > last_exponential) ? value / last_exponential : last_exponential / value;
+            max_ratio = fmaxf(max_ratio, ratio);
+            last_exponential = value;
+        }
+        TEST_CHECK(last_linear == target);
+    }
+    TEST_CHECK(max_linear <= 1.0f / BLOCK_SAMPLES + 1e-5f);             // Full scale over one block
+    TEST_CHECK(max_ratio <= powf(10.0f, 1.0f / BLOCK_SAMPLES) + 1e-4f);
+}
+
+// --- Event Heap ---
+
+static void test_event_heap_order(void) {
+    ctrl_event_heap_t heap;
+    ctrl_event_t event;
+    uint32_t sample;
+
+    ctrl_event_heap_init(&heap, s_heap_storage, HEAP_EVENTS);
+    TEST_CHECK(!ctrl_event_heap_peek(&heap, &sample));
+    TEST_CHECK(!ctrl_event_heap_pop_due(&heap, 0, &event));
+
+    // Random positions straddling the 32-bit wrap, many sharing a sample
+    const uint32_t base = 0xFFFF0000UL;
+    srand(1);
+    for (int i = 0; i < HEAP_EVENTS; ++i) {
+        ctrl_event_t pushed = {.sample = base + (uint32_t)(rand() % 100000), .id = (uint16_t)i};
+        TEST_CHECK(ctrl_event_heap_push(&heap, &pushed));
+    }
+    ctrl_event_t extra = {.sample = base};
+    TEST_CHECK(!ctrl_event_heap_push(&heap, &extra));                   // Full
+    TEST_CHECK(heap.count == HEAP_EVENTS);
+
+    // Drained block by block, as dspTask does
+    uint32_t popped = 0, late = 0, misordered = 0;
+    ctrl_event_t previous = {0};
+    for (uint32_t block = base; popped < HEAP_EVENTS; block += BLOCK_SAMPLES) {
+        uint32_t last = block + BLOCK_SAMPLES - 1;
+        while (ctrl_event_heap_pop_due(&heap, last, &event)) {
+            if ((int32_t)(event.sample - last) > 0 || (int32_t)(event.sample - block) < 0) {
+                late++;
+            }
+            if (popped > 0) {
+                int32_t diff = (int32_t)(event.sample - previous.sample);
+                if (diff < 0 || (diff == 0 && event.id < previous.id)) {
+                    misordered++;
+                }
+            }
+            previous = event;
+            popped++;
+        }
+        if (ctrl_event_heap_peek(&heap, &sample)) {
+            TEST_CHECK((int32_t)(sample - last) > 0);                   // Nothing due left behind
+        }
+    }
+    TEST_CHECK(popped == HEAP_EVENTS && heap.count == 0);
+    TEST_CHECK(late == 0 && misordered == 0);
+}
+
+static void test_event_heap_interleaved(void) {
+    ctrl_event_heap_t heap;
+    ctrl_event_t event;
+    uint32_t sample;
+
+    // Pushes between removals, like producers posting while dspTask drains
+    ctrl_event_heap_init(&heap, s_heap_storage, 8);
+    const uint32_t samples[] = {50, 10, 30, 10, 20};
+    for (uint16_t i = 0; i < 5; ++i) {
+        ctrl_event_t pushed = {.sample = samples[i], .id = i, .value = (float)i};
+        TEST_CHECK(ctrl_event_heap_push(&heap, &pushed));
+    }
+    TEST_CHECK(ctrl_event_heap_peek(&heap, &sample) && sample == 10);
+    TEST_CHECK(!ctrl_event_heap_pop_due(&heap, 9, &event));
+    TEST_CHECK(ctrl_event_heap_pop_due(&heap, 10, &event) && event.id == 1 && event.value == 1.0f);
+
+    ctrl_event_t now = {.sample = 10, .id = 9};
+    TEST_CHECK(ctrl_event_heap_push(&heap, &now));
+    TEST_CHECK(ctrl_event_heap_pop_due(&heap, 25, &event) && event.id == 3);
+    TEST_CHECK(ctrl_event_heap_pop_due(&heap, 25, &event) && event.id == 9);   // Same sample, pushed later
+    TEST_CHECK(ctrl_event_heap_pop_due(&heap, 25, &event) && event.id == 4);
+    TEST_CHECK(!ctrl_event_heap_pop_due(&heap, 25, &event));
+    TEST_CHECK(event.id == 4);                                          // Untouched when nothing is due
+    TEST_CHECK(ctrl_event_heap_pop_due(&heap, 1000, &event) && event.id == 2);
+    TEST_CHECK(ctrl_event_heap_pop_due(&heap, 1000, &event) && event.id == 0);
+    TEST_CHECK(heap.count == 0);
+}
+
+int main(void) {
+    test_biquad();
+    test_one_euro();
+    test_tilt();
+    test_curve();
+    test_ramp_linear();
+    test_ramp_exponential();
+    test_ramp_blocks();
+    test_event_heap_order();
+    test_event_heap_interleaved();
+    return TEST_EXIT();
+}
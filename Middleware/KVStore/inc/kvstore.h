@@ -0,0 +1,171 @@
+/**
+ * @file      kvstore.h
+ * @brief     Log-structured key-value store over two flash sectors.
+ *
+ * @details   Values are appended as records to the active sector; writing a
+ *            key again appends a new record and the older one becomes
+ *            garbage. A RAM index maps each key to its latest record, so a
+ *            lookup is one array access and never scans flash.
+ *
+ *            Layout, little-endian, every record KVSTORE_ALIGN-aligned:
+ *
+ *              sector header   u32 generation, u32 ~generation,
+ *                              u32 KVSTORE_MAGIC
+ *              record          u16 key, u16 length, u32 CRC-32 of key,
+ *                              length and value; value padded with 0xFF
+ *
+ *            When the active sector is full, the latest record of every key
+ *            is copied to the other sector, which is erased first, and that
+ *            sector's header is written last with the next generation. The
+ *            sector with a valid header and the highest generation is the
+ *            active one, so the switch is atomic: until the header's magic
+ *            word is programmed the old sector stays in use. The inverted
+ *            copy of the generation rejects a header left half-erased by a
+ *            reset during an erase, whose generation could read higher.
+ *
+ *            Records are programmed in address order, header first, so a
+ *            write cut short by a reset leaves a record whose CRC does not match. Mounting stops
+ *            the scan at such a record, or at any programmed byte after the
+ *            last record, and compacts into the other sector straight away;
+ *            every record completed before the cut survives.
+ *
+ * @note      The library has no RTOS or hardware dependency; flash access
+ *            goes through kvstore_flash_t. A kvstore_t is owned by the caller
+ *            and is not thread-safe.
+ */
+
+#ifndef KVSTORE_H
+#define KVSTORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Keys run from 0 to KVSTORE_MAX_KEYS - 1; sizes the RAM index. */
+#ifndef KVSTORE_MAX_KEYS
+#define KVSTORE_MAX_KEYS            32
+#endif
+
+/** @brief Largest value in bytes. */
+#ifndef KVSTORE_MAX_VALUE
+#define KVSTORE_MAX_VALUE           256
+#endif
+
+/* --- Flash Format --- */
+
+#define KVSTORE_MAGIC               0x3153564BUL    // "KVS1"
+#define KVSTORE_ALIGN               4
+#define KVSTORE_SECTOR_HEADER_BYTES 12
+#define KVSTORE_RECORD_HEADER_BYTES 8
+
+/** @brief Flash bytes taken by a record holding `len` value bytes. */
+#define KVSTORE_RECORD_BYTES(len)   (KVSTORE_RECORD_HEADER_BYTES + \
+                                     (((len) + KVSTORE_ALIGN - 1) & ~(size_t)(KVSTORE_ALIGN - 1)))
+
+/* --- Error Codes --- */
+
+#define KVSTORE_ERR_ARG             (-1)    // Bad key, length or store
+#define KVSTORE_ERR_NOT_FOUND       (-2)
+#define KVSTORE_ERR_FULL            (-3)    // Live values fill a sector
+#define KVSTORE_ERR_FLASH           (-4)    // Erase or program failed
+
+/* --- Public Types --- */
+
+/**
+ * @brief Flash backend: two equal sectors of NOR flash, read memory-mapped.
+ * @details NOR semantics are assumed: erase sets a whole sector to 0xFF and
+ *          programming only clears bits. Programs are KVSTORE_ALIGN-aligned
+ *          and a multiple of KVSTORE_ALIGN bytes long.
+ */
+typedef struct {
+    /** Erases sector 0 or 1; returns 0 on success. */
+    int (*erase)(void* p_context, uint8_t sector);
+    /** Programs `len` bytes at `offset` in sector 0 or 1; returns 0 on success. */
+    int (*program)(void* p_context, uint8_t sector, uint32_t offset, const uint8_t* p_data, size_t len);
+    void* p_context;
+    const uint8_t* p_sector[2];         // Where each sector is mapped for reading
+    uint32_t sector_bytes;              // At most 64 KB
+} kvstore_flash_t;
+
+/** @brief Store counters, since mount. */
+typedef struct {
+    uint32_t writes;                    // Records appended by kvstore_write/delete
+    uint32_t unchanged;                 // Writes skipped because the value was already stored
+    uint32_t value_bytes;               // Value bytes written by the caller
+    uint32_t flash_bytes;               // Bytes programmed, with headers, padding and compaction
+    uint32_t erases;                    // Sector erases
+    uint32_t compactions;
+    uint32_t generation;                // Of the active sector; counts compactions over its lifetime
+    uint32_t live_bytes;                // Flash taken by the latest record of every key
+    uint32_t free_bytes;                // Unwritten space in the active sector
+} kvstore_stats_t;
+
+/** @brief Store state. */
+typedef struct {
+    kvstore_flash_t flash;
+    uint8_t active;                     // Sector in use
+    uint32_t generation;
+    uint32_t write_offset;              // Next record in the active sector
+    uint16_t index[KVSTORE_MAX_KEYS];   // Offset of each key's latest record, 0 if none
+    kvstore_stats_t stats;
+} kvstore_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Finds the active sector and indexes its records.
+ * @details Formats the store if neither sector holds one, and compacts if
+ *          the active sector ends in an interrupted write.
+ *
+ * @param[out] p_store Store to mount.
+ * @param[in] p_flash Backend; copied.
+ *
+ * @return 0 on success, or a negative KVSTORE_ERR_* code.
+ */
+int kvstore_mount(kvstore_t* p_store, const kvstore_flash_t* p_flash);
+
+/**
+ * @brief Copies the value of a key.
+ *
+ * @param[in] p_store The store.
+ * @param[in] key Key to read.
+ * @param[out] p_value Destination; may be NULL to query the length.
+ * @param[in] len Size of the destination; the value is truncated to it.
+ *
+ * @return Length of the stored value, or KVSTORE_ERR_NOT_FOUND / KVSTORE_ERR_ARG.
+ */
+int kvstore_read(const kvstore_t* p_store, uint16_t key, void* p_value, size_t len);
+
+/**
+ * @brief Stores a value, compacting first if the active sector is full.
+ * @details A value equal to the stored one is not written again.
+ *
+ * @param[in,out] p_store The store.
+ * @param[in] key Key to write.
+ * @param[in] p_value Value bytes.
+ * @param[in] len Length, 1 to KVSTORE_MAX_VALUE.
+ *
+ * @return 0 on success, or a negative KVSTORE_ERR_* code.
+ */
+int kvstore_write(kvstore_t* p_store, uint16_t key, const void* p_value, size_t len);
+
+/**
+ * @brief Removes a key by appending an empty record.
+ * @return 0 on success (also if the key was absent), or a negative KVSTORE_ERR_* code.
+ */
+int kvstore_delete(kvstore_t* p_store, uint16_t key);
+
+/**
+ * @brief Copies the live records into the other sector now.
+ * @return 0 on success, or a negative KVSTORE_ERR_* code.
+ */
+int kvstore_compact(kvstore_t* p_store);
+
+/**
+ * @brief Copies the counters, with the live and free space filled in.
+ */
+void kvstore_get_stats(const kvstore_t* p_store, kvstore_stats_t* p_stats);
+
+#endif // KVSTORE_H
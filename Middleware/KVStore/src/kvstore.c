@@ -0,0 +1,343 @@
+/**
+ * @file      kvstore.c
+ * @brief     Log-structured key-value store over two flash sectors.
+ */
+
+#include "kvstore.h"
+
+#include <string.h>
+
+typedef struct {
+    uint32_t generation;
+    uint32_t generation_inv;
+    uint32_t magic;
+} sector_header_t;
+
+typedef struct {
+    uint16_t key;
+    uint16_t len;       // 0 marks a deleted key
+    uint32_t crc;
+} record_header_t;
+
+_Static_assert(sizeof(sector_header_t) == KVSTORE_SECTOR_HEADER_BYTES, "sector header layout");
+_Static_assert(sizeof(record_header_t) == KVSTORE_RECORD_HEADER_BYTES, "record header layout");
+_Static_assert(KVSTORE_MAX_KEYS < 0xFFFF && KVSTORE_MAX_VALUE < 0xFFFF, "an erased header must not parse");
+
+/* CRC-32 (IEEE 802.3, reflected), four bits at a time */
+static const uint32_t s_crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+// --- Private Helper Functions ---
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* p_data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        crc = (crc >> 4) ^ s_crc_nibble[(crc ^ p_data[i]) & 0x0F];
+        crc = (crc >> 4) ^ s_crc_nibble[(crc ^ (p_data[i] >> 4)) & 0x0F];
+    }
+    return crc;
+}
+
+static uint32_t record_crc(uint16_t key, uint16_t len, const uint8_t* p_value) {
+    uint16_t fields[2] = {key, len};
+    uint32_t crc = crc32_update(0xFFFFFFFFUL, (const uint8_t*)fields, sizeof(fields));
+    return ~crc32_update(crc, p_value, len);
+}
+
+static inline const uint8_t* sector_base(const kvstore_t* p_store, uint8_t sector) {
+    return p_store->flash.p_sector[sector];
+}
+
+static bool is_blank(const uint8_t* p_data, uint32_t len) {
+    for (uint32_t i = 0; i < len; ++i) {
+        if (p_data[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Reads a sector header; returns true if it marks a formatted sector. */
+static bool read_sector_header(const kvstore_t* p_store, uint8_t sector, uint32_t* p_generation) {
+    sector_header_t header;
+    memcpy(&header, sector_base(p_store, sector), sizeof(header));
+    if (header.magic != KVSTORE_MAGIC || header.generation != ~header.generation_inv) {
+        return false;
+    }
+    *p_generation = header.generation;
+    return true;
+}
+
+/**
+ * @brief Checks the record at `offset`.
+ * @return Its flash size, 0 at the erased end of the log, or -1 if it is
+ *         damaged or runs past the sector.
+ */
+static int check_record(const kvstore_t* p_store, uint8_t sector, uint32_t offset, record_header_t* p_header) {
+    const uint8_t* p_base = sector_base(p_store, sector);
+    uint32_t sector_bytes = p_store->flash.sector_bytes;
+
+    if (offset + KVSTORE_RECORD_HEADER_BYTES > sector_bytes) {
+        return 0;
+    }
+    memcpy(p_header, &p_base[offset], sizeof(*p_header));
+    if (p_header->key == 0xFFFF && p_header->len == 0xFFFF && p_header->crc == 0xFFFFFFFFUL) {
+        return 0;
+    }
+    uint32_t size = KVSTORE_RECORD_BYTES(p_header->len);
+    if (p_header->key >= KVSTORE_MAX_KEYS || p_header->len > KVSTORE_MAX_VALUE || offset + size > sector_bytes) {
+        return -1;
+    }
+    const uint8_t* p_value = &p_base[offset + KVSTORE_RECORD_HEADER_BYTES];
+    if (record_crc(p_header->key, p_header->len, p_value) != p_header->crc) {
+        return -1;
+    }
+    return (int)size;
+}
+
+static int erase_sector(kvstore_t* p_store, uint8_t sector) {
+    if (is_blank(sector_base(p_store, sector), p_store->flash.sector_bytes)) {
+        return 0;
+    }
+    if (p_store->flash.erase(p_store->flash.p_context, sector) != 0) {
+        return KVSTORE_ERR_FLASH;
+    }
+    p_store->stats.erases++;
+    return 0;
+}
+
+static int program(kvstore_t* p_store, uint8_t sector, uint32_t offset, const void* p_data, size_t len) {
+    p_store->stats.flash_bytes += (uint32_t)len;
+    if (p_store->flash.program(p_store->flash.p_context, sector, offset, (const uint8_t*)p_data, len) != 0) {
+        return KVSTORE_ERR_FLASH;
+    }
+    return 0;
+}
+
+/** @brief Erases `sector` and makes it the active, empty sector of `generation`. */
+static int format_sector(kvstore_t* p_store, uint8_t sector, uint32_t generation) {
+    int ret = erase_sector(p_store, sector);
+    if (ret != 0) {
+        return ret;
+    }
+    sector_header_t header = {generation, ~generation, KVSTORE_MAGIC};
+    ret = program(p_store, sector, 0, &header, sizeof(header));
+    if (ret != 0) {
+        return ret;
+    }
+    p_store->active = sector;
+    p_store->generation = generation;
+    p_store->write_offset = KVSTORE_SECTOR_HEADER_BYTES;
+    memset(p_store->index, 0, sizeof(p_store->index));
+    return 0;
+}
+
+/**
+ * @brief Indexes the active sector's records.
+ * @return true if the log ends cleanly, false if it ends in a damaged record
+ *         or with programmed bytes past its end.
+ */
+static bool scan(kvstore_t* p_store) {
+    record_header_t header;
+    uint32_t offset = KVSTORE_SECTOR_HEADER_BYTES;
+    int size;
+
+    memset(p_store->index, 0, sizeof(p_store->index));
+    while ((size = check_record(p_store, p_store->active, offset, &header)) > 0) {
+        p_store->index[header.key] = (header.len != 0) ? (uint16_t)offset : 0;
+        offset += (uint32_t)size;
+    }
+    p_store->write_offset = offset;
+
+    return size == 0 &&
+           is_blank(&sector_base(p_store, p_store->active)[offset], p_store->flash.sector_bytes - offset);
+}
+
+/** @brief Appends a record to the active sector; the caller has checked the space. */
+static int append(kvstore_t* p_store, uint16_t key, const uint8_t* p_value, uint16_t len) {
+    uint8_t record[KVSTORE_RECORD_BYTES(KVSTORE_MAX_VALUE)];
+    record_header_t header = {key, len, record_crc(key, len, p_value)};
+    size_t size = KVSTORE_RECORD_BYTES(len);
+
+    // Header first: a record cut short fails its CRC
+    memcpy(record, &header, sizeof(header));
+    if (len != 0) {
+        memcpy(&record[KVSTORE_RECORD_HEADER_BYTES], p_value, len);
+    }
+    memset(&record[KVSTORE_RECORD_HEADER_BYTES + len], 0xFF, size - KVSTORE_RECORD_HEADER_BYTES - len);
+
+    uint32_t offset = p_store->write_offset;
+    p_store->write_offset += (uint32_t)size;
+    int ret = program(p_store, p_store->active, offset, record, size);
+    if (ret != 0) {
+        // Records after a damaged one are not found by mount: compact before the next write
+        p_store->write_offset = p_store->flash.sector_bytes;
+        return ret;
+    }
+    p_store->index[key] = (len != 0) ? (uint16_t)offset : 0;
+    p_store->stats.writes++;
+    return 0;
+}
+
+// --- Public API Function Implementations ---
+
+int kvstore_mount(kvstore_t* p_store, const kvstore_flash_t* p_flash) {
+    if (p_store == NULL || p_flash == NULL || p_flash->erase == NULL || p_flash->program == NULL ||
+        p_flash->p_sector[0] == NULL || p_flash->p_sector[1] == NULL ||
+        p_flash->sector_bytes < KVSTORE_SECTOR_HEADER_BYTES + KVSTORE_RECORD_BYTES(KVSTORE_MAX_VALUE) ||
+        p_flash->sector_bytes > 0x10000 || (p_flash->sector_bytes % KVSTORE_ALIGN) != 0) {
+        return KVSTORE_ERR_ARG;
+    }
+    memset(p_store, 0, sizeof(*p_store));
+    p_store->flash = *p_flash;
+
+    uint32_t generation[2];
+    bool is_valid[2];
+    for (uint8_t sector = 0; sector < 2; ++sector) {
+        is_valid[sector] = read_sector_header(p_store, sector, &generation[sector]);
+    }
+    if (!is_valid[0] && !is_valid[1]) {
+        return format_sector(p_store, 0, 1);
+    }
+    if (is_valid[0] && is_valid[1]) {
+        // Wrap-safe: the newer sector is at most a few compactions ahead
+        p_store->active = ((int32_t)(generation[1] - generation[0]) > 0) ? 1 : 0;
+    } else {
+        p_store->active = is_valid[1] ? 1 : 0;
+    }
+    p_store->generation = generation[p_store->active];
+
+    if (!scan(p_store)) {
+        // Interrupted write: keep what was complete, in a clean sector
+        return kvstore_compact(p_store);
+    }
+    return 0;
+}
+
+int kvstore_read(const kvstore_t* p_store, uint16_t key, void* p_value, size_t len) {
+    if (p_store == NULL || key >= KVSTORE_MAX_KEYS) {
+        return KVSTORE_ERR_ARG;
+    }
+    uint16_t offset = p_store->index[key];
+    if (offset == 0) {
+        return KVSTORE_ERR_NOT_FOUND;
+    }
+
+    record_header_t header;
+    const uint8_t* p_record = &sector_base(p_store, p_store->active)[offset];
+    memcpy(&header, p_record, sizeof(header));
+    if (p_value != NULL) {
+        memcpy(p_value, &p_record[KVSTORE_RECORD_HEADER_BYTES], (len < header.len) ? len : header.len);
+    }
+    return header.len;
+}
+
+int kvstore_write(kvstore_t* p_store, uint16_t key, const void* p_value, size_t len) {
+    if (p_store == NULL || key >= KVSTORE_MAX_KEYS || p_value == NULL || len == 0 || len > KVSTORE_MAX_VALUE) {
+        return KVSTORE_ERR_ARG;
+    }
+
+    uint16_t offset = p_store->index[key];
+    if (offset != 0) {
+        const uint8_t* p_record = &sector_base(p_store, p_store->active)[offset];
+        record_header_t header;
+        memcpy(&header, p_record, sizeof(header));
+        if (header.len == len && memcmp(&p_record[KVSTORE_RECORD_HEADER_BYTES], p_value, len) == 0) {
+            p_store->stats.unchanged++;
+            return 0;
+        }
+    }
+
+    if (p_store->write_offset + KVSTORE_RECORD_BYTES(len) > p_store->flash.sector_bytes) {
+        int ret = kvstore_compact(p_store);
+        if (ret != 0) {
+            return ret;
+        }
+        if (p_store->write_offset + KVSTORE_RECORD_BYTES(len) > p_store->flash.sector_bytes) {
+            return KVSTORE_ERR_FULL;
+        }
+    }
+    p_store->stats.value_bytes += (uint32_t)len;
+    return append(p_store, key, (const uint8_t*)p_value, (uint16_t)len);
+}
+
+int kvstore_delete(kvstore_t* p_store, uint16_t key) {
+    if (p_store == NULL || key >= KVSTORE_MAX_KEYS) {
+        return KVSTORE_ERR_ARG;
+    }
+    if (p_store->index[key] == 0) {
+        return 0;
+    }
+    if (p_store->write_offset + KVSTORE_RECORD_HEADER_BYTES > p_store->flash.sector_bytes) {
+        int ret = kvstore_compact(p_store);
+        if (ret != 0) {
+            return ret;
+        }
+        if (p_store->write_offset + KVSTORE_RECORD_HEADER_BYTES > p_store->flash.sector_bytes) {
+            return KVSTORE_ERR_FULL;
+        }
+    }
+    return append(p_store, key, NULL, 0);
+}
+
+int kvstore_compact(kvstore_t* p_store) {
+    if (p_store == NULL) {
+        return KVSTORE_ERR_ARG;
+    }
+    uint8_t from = p_store->active;
+    uint8_t to = (uint8_t)(from ^ 1);
+    const uint8_t* p_from = sector_base(p_store, from);
+
+    int ret = erase_sector(p_store, to);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // Copy the latest record of every key; the old sector stays valid throughout
+    uint16_t index[KVSTORE_MAX_KEYS] = {0};
+    uint32_t offset = KVSTORE_SECTOR_HEADER_BYTES;
+    for (uint16_t key = 0; key < KVSTORE_MAX_KEYS; ++key) {
+        if (p_store->index[key] == 0) {
+            continue;
+        }
+        record_header_t header;
+        memcpy(&header, &p_from[p_store->index[key]], sizeof(header));
+        uint32_t size = KVSTORE_RECORD_BYTES(header.len);
+        ret = program(p_store, to, offset, &p_from[p_store->index[key]], size);
+        if (ret != 0) {
+            return ret;
+        }
+        index[key] = (uint16_t)offset;
+        offset += size;
+    }
+
+    // Generation before magic, in one program: the switch happens on the last word
+    uint32_t generation = p_store->generation + 1;
+    sector_header_t header = {generation, ~generation, KVSTORE_MAGIC};
+    ret = program(p_store, to, 0, &header, sizeof(header));
+    if (ret != 0) {
+        return ret;
+    }
+
+    p_store->active = to;
+    p_store->generation = generation;
+    p_store->write_offset = offset;
+    memcpy(p_store->index, index, sizeof(index));
+    p_store->stats.compactions++;
+    return 0;
+}
+
+void kvstore_get_stats(const kvstore_t* p_store, kvstore_stats_t* p_stats) {
+    *p_stats = p_store->stats;
+    p_stats->generation = p_store->generation;
+    p_stats->live_bytes = 0;
+    for (uint16_t key = 0; key < KVSTORE_MAX_KEYS; ++key) {
+        if (p_store->index[key] != 0) {
+            record_header_t header;
+            memcpy(&header, &sector_base(p_store, p_store->active)[p_store->index[key]], sizeof(header));
+            p_stats->live_bytes += KVSTORE_RECORD_BYTES(header.len);
+        }
+    }
+    p_stats->free_bytes = p_store->flash.sector_bytes - p_store->write_offset;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file      nor_sim.c
+ * @brief     Two-sector NOR flash in RAM, with power loss, for the KVStore tests.
+ */
+
+#include "nor_sim.h"
+
+#include <string.h>
+
+// --- Private Helper Functions ---
+
+/** @brief Spends one operation; false once the power is gone. */
+static bool spend(nor_sim_t* p_sim) {
+    if (!p_sim->is_powered) {
+        return false;
+    }
+    if (p_sim->budget == 0) {
+        p_sim->is_powered = false;
+        return false;
+    }
+    if (p_sim->budget > 0) {
+        p_sim->budget--;
+    }
+    p_sim->operations++;
+    return true;
+}
+
+static int sim_erase(void* p_context, uint8_t sector) {
+    nor_sim_t* p_sim = (nor_sim_t*)p_context;
+    if (sector > 1) {
+        p_sim->violations++;
+        return -1;
+    }
+    bool was_powered = p_sim->is_powered;
+    if (!spend(p_sim)) {
+        if (was_powered) {
+            // Cut mid-erase: some bytes erased, the rest as they were
+            for (uint32_t i = 0; i < NOR_SIM_SECTOR_BYTES; i += 7) {
+                p_sim->sector[sector][i] = 0xFF;
+            }
+        }
+        return -1;
+    }
+    memset(p_sim->sector[sector], 0xFF, NOR_SIM_SECTOR_BYTES);
+    return 0;
+}
+
+static int sim_program(void* p_context, uint8_t sector, uint32_t offset, const uint8_t* p_data, size_t len) {
+    nor_sim_t* p_sim = (nor_sim_t*)p_context;
+    if (sector > 1 || (offset % KVSTORE_ALIGN) != 0 || (len % KVSTORE_ALIGN) != 0 ||
+        offset + len > NOR_SIM_SECTOR_BYTES) {
+        p_sim->violations++;
+        return -1;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t* p_byte = &p_sim->sector[sector][offset + i];
+        if ((*p_byte & p_data[i]) != p_data[i]) {
+            p_sim->violations++;
+            return -1;
+        }
+        bool was_powered = p_sim->is_powered;
+        if (!spend(p_sim)) {
+            if (was_powered) {
+                // Cut mid-byte: only the low bits were cleared
+                *p_byte &= (uint8_t)(p_data[i] | 0xF0);
+            }
+            return -1;
+        }
+        *p_byte = p_data[i];
+    }
+    return 0;
+}
+
+// --- Public API Function Implementations ---
+
+void nor_sim_init(nor_sim_t* p_sim) {
+    memset(p_sim->sector, 0xFF, sizeof(p_sim->sector));
+    p_sim->budget = NOR_SIM_NO_CUT;
+    p_sim->is_powered = true;
+    p_sim->operations = 0;
+    p_sim->violations = 0;
+}
+
+void nor_sim_backend(nor_sim_t* p_sim, kvstore_flash_t* p_flash) {
+    p_flash->erase = sim_erase;
+    p_flash->program = sim_program;
+    p_flash->p_context = p_sim;
+    p_flash->p_sector[0] = p_sim->sector[0];
+    p_flash->p_sector[1] = p_sim->sector[1];
+    p_flash->sector_bytes = NOR_SIM_SECTOR_BYTES;
+}
+
+void nor_sim_cut_after(nor_sim_t* p_sim, long operations) {
+    p_sim->budget = operations;
+}
+
+void nor_sim_power_on(nor_sim_t* p_sim) {
+    p_sim->budget = NOR_SIM_NO_CUT;
+    p_sim->is_powered = true;
+}
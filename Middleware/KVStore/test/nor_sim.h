@@ -0,0 +1,52 @@
+/**
+ * @file      nor_sim.h
+ * @brief     Two-sector NOR flash in RAM, with power loss, for the KVStore tests.
+ *
+ * @details   Behaves like the F407 flash behind presets.c: an erase sets the
+ *            whole sector to 0xFF, a program may only clear bits and must be
+ *            KVSTORE_ALIGN-aligned. A program that would set a bit, or is
+ *            misaligned, is counted as a violation and not applied.
+ *
+ *            Power loss is simulated by an operation budget: every erase and
+ *            every programmed byte costs one. When it runs out the operation
+ *            in progress is left half done (an erase clears scattered bytes
+ *            only, a program stops inside a byte) and every later erase or
+ *            program fails without touching the flash, until nor_sim_power_on().
+ */
+
+#ifndef NOR_SIM_H
+#define NOR_SIM_H
+
+#include "kvstore.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef NOR_SIM_SECTOR_BYTES
+#define NOR_SIM_SECTOR_BYTES        2048
+#endif
+
+/** @brief Budget that never runs out. */
+#define NOR_SIM_NO_CUT              (-1L)
+
+typedef struct {
+    uint8_t sector[2][NOR_SIM_SECTOR_BYTES];
+    long budget;                        // Operations left before power loss, or NOR_SIM_NO_CUT
+    bool is_powered;
+    uint32_t operations;                // Erases plus programmed bytes while powered
+    uint32_t violations;                // Programs that set bits or were misaligned
+} nor_sim_t;
+
+/** @brief Erases both sectors and powers the flash on with no cut pending. */
+void nor_sim_init(nor_sim_t* p_sim);
+
+/** @brief Fills in a KVStore backend over the simulator. */
+void nor_sim_backend(nor_sim_t* p_sim, kvstore_flash_t* p_flash);
+
+/** @brief Cuts the power after `operations` more operations. */
+void nor_sim_cut_after(nor_sim_t* p_sim, long operations);
+
+/** @brief Restores power, keeping the flash as the cut left it. */
+void nor_sim_power_on(nor_sim_t* p_sim);
+
+#endif // NOR_SIM_H
@@ -0,0 +1,246 @@
+/**
+ * @file      test_kvstore.c
+ * @brief     Host test of the KVStore on a simulated NOR flash.
+ *
+ * @details   Besides the API, sweeps a power cut over every erase and every
+ *            programmed byte of a workload of writes and deletes with several
+ *            compactions. After each cut the store must mount, every key must
+ *            hold its last completed value (the key being written may hold
+ *            the old or the new one), and the store must take new writes.
+ */
+
+#include "kvstore.h"
+#include "nor_sim.h"
+#include "unit_test.h"
+
+#include <string.h>
+
+#define SWEEP_KEYS          6
+#define SWEEP_STEPS         300
+#define SWEEP_VALUE_MAX     37
+
+/** @brief Expected contents of the swept keys; length 0 for an absent key. */
+typedef struct {
+    uint8_t value[SWEEP_KEYS][SWEEP_VALUE_MAX];
+    int len[SWEEP_KEYS];
+} sweep_model_t;
+
+static nor_sim_t s_sim;
+static kvstore_flash_t s_flash;
+static kvstore_t s_store;
+
+// --- Private Helper Functions ---
+
+static void reset_flash(void) {
+    nor_sim_init(&s_sim);
+    nor_sim_backend(&s_sim, &s_flash);
+}
+
+static uint16_t step_key(int step) {
+    return (uint16_t)((step * 5) % SWEEP_KEYS);
+}
+
+static bool step_is_delete(int step) {
+    return (step % 11) == 10;
+}
+
+/** @brief Value written by a step: varying length and contents. */
+static int step_value(int step, uint8_t* p_value) {
+    int len = 1 + (step * 7 + step_key(step)) % SWEEP_VALUE_MAX;
+    for (int i = 0; i < len; ++i) {
+        p_value[i] = (uint8_t)(step * 31 + step_key(step) * 3 + i);
+    }
+    return len;
+}
+
+/**
+ * @brief Runs the workload until it ends or the flash fails.
+ * @return Number of steps completed; the next one was in flight on failure.
+ */
+static int run_workload(sweep_model_t* p_model) {
+    memset(p_model, 0, sizeof(*p_model));
+    for (int step = 0; step < SWEEP_STEPS; ++step) {
+        uint16_t key = step_key(step);
+        if (step_is_delete(step)) {
+            if (kvstore_delete(&s_store, key) != 0) {
+                return step;
+            }
+            p_model->len[key] = 0;
+        } else {
+            uint8_t value[SWEEP_VALUE_MAX];
+            int len = step_value(step, value);
+            if (kvstore_write(&s_store, key, value, (size_t)len) != 0) {
+                return step;
+            }
+            memcpy(p_model->value[key], value, (size_t)len);
+            p_model->len[key] = len;
+        }
+    }
+    return SWEEP_STEPS;
+}
+
+static bool key_matches(uint16_t key, const uint8_t* p_value, int len) {
+    uint8_t stored[KVSTORE_MAX_VALUE];
+    int n = kvstore_read(&s_store, key, stored, sizeof(stored));
+    if (len == 0) {
+        return n == KVSTORE_ERR_NOT_FOUND;
+    }
+    return n == len && memcmp(stored, p_value, (size_t)len) == 0;
+}
+
+/** @brief Checks the store mounted after a cut at `cut`; returns false on the first mismatch. */
+static bool check_after_cut(long cut, const sweep_model_t* p_model, int steps_done) {
+    bool ok = true;
+
+    for (uint16_t key = 0; key < SWEEP_KEYS; ++key) {
+        bool matches = key_matches(key, p_model->value[key], p_model->len[key]);
+        if (!matches && steps_done < SWEEP_STEPS && key == step_key(steps_done)) {
+            // The step in flight may have completed before the cut
+            uint8_t value[SWEEP_VALUE_MAX];
+            int len = step_is_delete(steps_done) ? 0 : step_value(steps_done, value);
+            matches = key_matches(key, value, len);
+        }
+        if (!matches) {
+            fprintf(stderr, "cut %ld: key %u lost (step %d)\n", cut, (unsigned)key, steps_done);
+            ok = false;
+        }
+    }
+
+    // Still writable, and the write survives a remount
+    const uint8_t probe[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    if (kvstore_write(&s_store, 0, probe, sizeof(probe)) != 0 ||
+        kvstore_mount(&s_store, &s_flash) != 0 || !key_matches(0, probe, sizeof(probe))) {
+        fprintf(stderr, "cut %ld: store not writable after mount\n", cut);
+        ok = false;
+    }
+    return ok;
+}
+
+// --- Tests ---
+
+static void test_read_write_delete(void) {
+    reset_flash();
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+
+    const uint8_t value[5] = {10, 20, 30, 40, 50};
+    uint8_t out[8] = {0};
+    TEST_CHECK(kvstore_read(&s_store, 3, out, sizeof(out)) == KVSTORE_ERR_NOT_FOUND);
+    TEST_CHECK(kvstore_write(&s_store, 3, value, sizeof(value)) == 0);
+    TEST_CHECK(kvstore_read(&s_store, 3, NULL, 0) == (int)sizeof(value));
+    TEST_CHECK(kvstore_read(&s_store, 3, out, 2) == (int)sizeof(value));    // Truncated copy
+    TEST_CHECK(out[0] == 10 && out[1] == 20 && out[2] == 0);
+
+    kvstore_stats_t stats;
+    TEST_CHECK(kvstore_write(&s_store, 3, value, sizeof(value)) == 0);
+    kvstore_get_stats(&s_store, &stats);
+    TEST_CHECK(stats.writes == 1 && stats.unchanged == 1);
+
+    // Survives a remount, and a delete does too
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+    TEST_CHECK(key_matches(3, value, sizeof(value)));
+    TEST_CHECK(kvstore_delete(&s_store, 3) == 0);
+    TEST_CHECK(kvstore_delete(&s_store, 3) == 0);
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+    TEST_CHECK(kvstore_read(&s_store, 3, out, sizeof(out)) == KVSTORE_ERR_NOT_FOUND);
+
+    uint8_t big[KVSTORE_MAX_VALUE + 1] = {0};
+    TEST_CHECK(kvstore_write(&s_store, KVSTORE_MAX_KEYS, value, sizeof(value)) == KVSTORE_ERR_ARG);
+    TEST_CHECK(kvstore_write(&s_store, 0, value, 0) == KVSTORE_ERR_ARG);
+    TEST_CHECK(kvstore_write(&s_store, 0, big, sizeof(big)) == KVSTORE_ERR_ARG);
+    TEST_CHECK(s_sim.violations == 0);
+}
+
+static void test_compaction(void) {
+    reset_flash();
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+
+    sweep_model_t model;
+    TEST_CHECK(run_workload(&model) == SWEEP_STEPS);
+
+    kvstore_stats_t stats;
+    kvstore_get_stats(&s_store, &stats);
+    TEST_CHECK(stats.compactions >= 3);
+    TEST_CHECK(stats.erases == stats.compactions - 1);  // The first one copied into blank flash
+    TEST_CHECK(stats.generation == 1 + stats.compactions);
+    printf("workload: %u writes, %u value bytes, %u flash bytes, %u erases, %u compactions\n",
+           (unsigned)stats.writes, (unsigned)stats.value_bytes, (unsigned)stats.flash_bytes,
+           (unsigned)stats.erases, (unsigned)stats.compactions);
+
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+    for (uint16_t key = 0; key < SWEEP_KEYS; ++key) {
+        TEST_CHECK(key_matches(key, model.value[key], model.len[key]));
+    }
+    TEST_CHECK(s_sim.violations == 0);
+}
+
+static void test_full(void) {
+    reset_flash();
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+
+    uint8_t value[KVSTORE_MAX_VALUE];
+    uint16_t fitted = 0;
+    int ret = 0;
+    while (fitted < KVSTORE_MAX_KEYS) {
+        memset(value, (int)fitted, sizeof(value));
+        ret = kvstore_write(&s_store, fitted, value, sizeof(value));
+        if (ret != 0) {
+            break;
+        }
+        fitted++;
+    }
+    TEST_CHECK(ret == KVSTORE_ERR_FULL);
+    TEST_CHECK(fitted == (NOR_SIM_SECTOR_BYTES - KVSTORE_SECTOR_HEADER_BYTES) / KVSTORE_RECORD_BYTES(KVSTORE_MAX_VALUE));
+
+    // The values already stored are untouched
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+    for (uint16_t key = 0; key < fitted; ++key) {
+        memset(value, (int)key, sizeof(value));
+        TEST_CHECK(key_matches(key, value, sizeof(value)));
+    }
+    TEST_CHECK(s_sim.violations == 0);
+}
+
+static void test_power_loss_sweep(void) {
+    sweep_model_t model;
+
+    // Operations the workload takes when nothing fails
+    reset_flash();
+    TEST_CHECK(kvstore_mount(&s_store, &s_flash) == 0);
+    uint32_t start = s_sim.operations;
+    TEST_CHECK(run_workload(&model) == SWEEP_STEPS);
+    long total = (long)(s_sim.operations - start);
+
+    long failed = 0;
+    for (long cut = 0; cut < total; ++cut) {
+        reset_flash();
+        if (kvstore_mount(&s_store, &s_flash) != 0) {
+            failed++;
+            continue;
+        }
+        nor_sim_cut_after(&s_sim, cut);
+        int steps_done = run_workload(&model);
+        nor_sim_power_on(&s_sim);
+
+        if (kvstore_mount(&s_store, &s_flash) != 0) {
+            fprintf(stderr, "cut %ld: mount failed\n", cut);
+            failed++;
+        } else if (!check_after_cut(cut, &model, steps_done)) {
+            failed++;
+        }
+        if (s_sim.violations != 0) {
+            fprintf(stderr, "cut %ld: %u NOR violations\n", cut, (unsigned)s_sim.violations);
+            failed++;
+        }
+    }
+    printf("power loss: %ld cut points, %ld failed\n", total, failed);
+    TEST_CHECK(total > 0);
+    TEST_CHECK(failed == 0);
+}
+
+int main(void) {
+    test_read_write_delete();
+    test_compaction();
+    test_full();
+    test_power_loss_sweep();
+    return TEST_EXIT();
+}
@@ -38,7 +38,21 @@
 
 
 
-#define configCOMMAND_INT_MAX_OUTPUT_SIZE 32
+/* Size of the output buffer shared by the command consoles, see
+FreeRTOS_CLIGetOutputBuffer(). */
+#ifndef configCOMMAND_INT_MAX_OUTPUT_SIZE
+	#define configCOMMAND_INT_MAX_OUTPUT_SIZE 32
+#endif
+
+/* Capacity of the command table, "help" included. */
+#ifndef configCOMMAND_INT_MAX_COMMANDS
+	#define configCOMMAND_INT_MAX_COMMANDS 32
+#endif
+
+/* Most parameters a command line may carry after the command name. */
+#ifndef configCOMMAND_INT_MAX_PARAMETERS
+	#define configCOMMAND_INT_MAX_PARAMETERS 8
+#endif
 
 /* The prototype to which callback functions used to process command line
 commands must comply.  pcWriteBuffer is a buffer into which the output from
@@ -62,9 +76,12 @@ typedef struct xCOMMAND_LINE_INPUT
 
 /*
  * Register the command passed in using the pxCommandToRegister parameter.
- * Registering a command adds the command to the list of commands that are
+ * Registering a command adds the command to the table of commands that are
  * handled by the command interpreter.  Once a command has been registered it
- * can be executed from the command line.
+ * can be executed from the command line.  The table is kept sorted by name and
+ * holds configCOMMAND_INT_MAX_COMMANDS entries; pdFAIL is returned if it is
+ * full or the name is already registered.  Register commands before the
+ * console starts.
  */
 BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister );
 
@@ -101,5 +118,35 @@ char *FreeRTOS_CLIGetOutputBuffer( void );
  */
 const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t uxWantedParameter, BaseType_t *pxParameterStringLength );
 
+/*
+ * Typed parameter accessors.  Each parses the uxWantedParameter'th word of
+ * pcCommandString and returns pdPASS with the value, or pdFAIL if the word is
+ * missing, malformed or out of range (the destination is then unchanged).
+ * Within a command callback they index the words split when the command was
+ * looked up, so no accessor rescans the line.
+ *
+ * FreeRTOS_CLIGetInt() accepts decimal, 0x hexadecimal and 0 octal in
+ * [lMin, lMax]; FreeRTOS_CLIGetFloat() accepts [fMin, fMax];
+ * FreeRTOS_CLIGetEnum() returns the index of the word in ppcNames.
+ */
+BaseType_t FreeRTOS_CLIGetInt( const char *pcCommandString, UBaseType_t uxWantedParameter, int32_t lMin, int32_t lMax, int32_t *plValue );
+BaseType_t FreeRTOS_CLIGetFloat( const char *pcCommandString, UBaseType_t uxWantedParameter, float fMin, float fMax, float *pfValue );
+BaseType_t FreeRTOS_CLIGetEnum( const char *pcCommandString, UBaseType_t uxWantedParameter, const char * const *ppcNames, UBaseType_t uxNameCount, UBaseType_t *puxValue );
+
+/*
+ * Find the registered commands whose names start with the xPrefixLength
+ * characters at pcPrefix, for completion.  The table is kept sorted by name,
+ * so the matches are adjacent: the number of matches is returned and the
+ * index of the first is written to puxFirst.  Read them with
+ * FreeRTOS_CLIGetCommand().
+ */
+UBaseType_t FreeRTOS_CLIFindCommands( const char *pcPrefix, size_t xPrefixLength, UBaseType_t *puxFirst );
+
+/*
+ * Return the uxIndex'th registered command in name order, or NULL past the
+ * end of the table.
+ */
+const CLI_Command_Definition_t *FreeRTOS_CLIGetCommand( UBaseType_t uxIndex );
+
 
 #endif /* THIRD_PARTY_SHELL_INC_FREERTOS_CLI_H_ */
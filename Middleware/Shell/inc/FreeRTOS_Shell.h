@@ -1,33 +1,26 @@
 
 
-
 #ifndef THIRD_PARTY_SHELL_INC_FREERTOS_SHELL_H_
 #define THIRD_PARTY_SHELL_INC_FREERTOS_SHELL_H_
 
 #include "FreeRTOS.h"
 #include "FreeRTOS_CLI.h"
 #include "task.h"
-#include "queue.h"
-//#include "stm32f407xx.h"
-//#include "stm32f4xx_hal.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
-//#include "stm32f4xx_hal_gpio.h"
-
-static BaseType_t prvCommandTaskStats( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
-
-static BaseType_t prvQueueStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
-static BaseType_t prvRunTimeStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
-static BaseType_t prvHeapStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
 
 
 #define CONSOLE_VERSION_MAJOR                   1
-#define CONSOLE_VERSION_MINOR                   0
+#define CONSOLE_VERSION_MINOR                   2
 
 #define MAX_IN_STR_LEN                          300
-#define MAX_OUT_STR_LEN                         600
-#define MAX_RX_QUEUE_LEN                        300
+#define MAX_OUT_STR_LEN                         configCOMMAND_INT_MAX_OUTPUT_SIZE
+#define MAX_RX_CHUNK_LEN                        64    /* Bytes taken from the RX ring per read */
+#define MAX_TASK_STATUS                         16    /* Tasks listed by the "stats" command   */
+
+#define CONSOLE_READ_TIMEOUT_MS                 1000  /* Wait for input before polling again  */
+#define CONSOLE_WRITE_TIMEOUT_MS                1000  /* Wait for TX ring space per write     */
 
                                                       /* ASCII code definition */
 #define ASCII_TAB                               '\t'  /* Tabulate              */
@@ -39,5 +32,36 @@ static BaseType_t prvHeapStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLe
 #define ASCII_CTRL_PLUS_C                         3   /* CTRL + C              */
 #define ASCII_NACK                               21   /* Negative acknowledge  */
 
+/*
+ * Byte stream the console runs on. pxRead returns as soon as any bytes are
+ * available (0 on timeout) and pxWrite returns the number of bytes queued, so
+ * a DMA-driven UART fits directly: the console never waits on a single
+ * character and never spins while output drains.
+ */
+typedef size_t (*ConsoleRead_t)(void *pvData, size_t xLen, uint32_t ulTimeoutMs);
+typedef size_t (*ConsoleWrite_t)(const void *pvData, size_t xLen, uint32_t ulTimeoutMs);
+
+typedef struct xCONSOLE_IO
+{
+    ConsoleRead_t pxRead;
+    ConsoleWrite_t pxWrite;
+} ConsoleIO_t;
+
+/*
+ * Binds the console to its byte stream and registers the built-in commands
+ * ("stats", "heapstats"). Call once before the scheduler starts; the
+ * application registers its own commands with FreeRTOS_CLIRegisterCommand().
+ */
+BaseType_t xConsoleInit(const ConsoleIO_t *pxIO);
+
+/*
+ * Console task: assembles lines from the input stream, runs them through
+ * FreeRTOS_CLIProcessCommand() and writes every part of the output as it is
+ * produced. TAB completes the command name (listing the candidates when it is
+ * ambiguous) and recalls the previous line when the line is empty. Meant to
+ * run at tskIDLE_PRIORITY, so it only uses time no other task wants.
+ */
+void vTaskConsole(void *pvParams);
+
 
 #endif /* THIRD_PARTY_SHELL_INC_FREERTOS_SHELL_H_ */
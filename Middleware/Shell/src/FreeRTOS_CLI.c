@@ -35,6 +35,7 @@
 /* Standard includes. */
 #include <string.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -53,12 +54,6 @@ one of the application files:
 	#define configAPPLICATION_PROVIDES_cOutputBuffer 0
 #endif
 
-typedef struct xCOMMAND_INPUT_LIST
-{
-	const CLI_Command_Definition_t *pxCommandLineDefinition;
-	struct xCOMMAND_INPUT_LIST *pxNext;
-} CLI_Definition_List_Item_t;
-
 /*
  * The callback function that is executed when "help" is entered.  This is the
  * only default command that is always present.
@@ -66,12 +61,19 @@ typedef struct xCOMMAND_INPUT_LIST
 static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
 /*
- * Return the number of parameters that follow the command name.
+ * Split pcCommandString into space delimited words, once per command line.
+ * Returns the number of parameters, or -1 if there are more than
+ * configCOMMAND_INT_MAX_PARAMETERS.
+ */
+static BaseType_t prvTokenise( const char *pcCommandString );
+
+/*
+ * Compare the first xWordLength characters of pcWord, taken as a whole word,
+ * with a registered command name.  The result orders like strcmp().
  */
-static int8_t prvGetNumberOfParameters( const char *pcCommandString );
+static int prvCompareWord( const char *pcWord, size_t xWordLength, const char *pcCommand );
 
-/* The definition of the "help" command.  This command is always at the front
-of the list of registered commands. */
+/* The definition of the "help" command.  This command is always registered. */
 static const CLI_Command_Definition_t xHelpCommand =
 {
 	"help",
@@ -80,13 +82,23 @@ static const CLI_Command_Definition_t xHelpCommand =
 	0
 };
 
-/* The definition of the list of commands.  Commands that are registered are
-added to this list. */
-static CLI_Definition_List_Item_t xRegisteredCommands =
+/* The registered commands, kept sorted by name so a command is found by binary
+search and all the commands starting with a prefix are adjacent.  Commands are
+registered once at start up, so the cost of keeping the order is paid then,
+never per command line, and no heap is used. */
+static const CLI_Command_Definition_t *pxRegisteredCommands[ configCOMMAND_INT_MAX_COMMANDS ] =
 {
-	&xHelpCommand,	/* The first command in the list is always the help command, defined in this file. */
-	NULL			/* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+	&xHelpCommand
 };
+static UBaseType_t uxRegisteredCommandCount = 1;
+
+/* The words of the command line being processed.  The line is split once when
+its command is looked up, so the parameter accessors below index this table
+instead of rescanning the line. */
+static const char *pcTokenisedLine = NULL;
+static const char *pcTokens[ configCOMMAND_INT_MAX_PARAMETERS + 1 ];
+static BaseType_t xTokenLengths[ configCOMMAND_INT_MAX_PARAMETERS + 1 ];
+static UBaseType_t uxTokenCount = 0;
 
 /* A buffer into which command outputs can be written is declared here, rather
 than in the command console implementation, to allow multiple command consoles
@@ -111,40 +123,39 @@ buffer needs to be placed at a fixed address (rather than by the linker). */
 
 BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister )
 {
-static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
-CLI_Definition_List_Item_t *pxNewListItem;
+UBaseType_t uxIndex;
 BaseType_t xReturn = pdFAIL;
 
 	/* Check the parameter is not NULL. */
 	configASSERT( pxCommandToRegister );
 
-	/* Create a new list item that will reference the command being registered. */
-	pxNewListItem = ( CLI_Definition_List_Item_t * ) pvPortMalloc( sizeof( CLI_Definition_List_Item_t ) );
-	configASSERT( pxNewListItem );
-
-	if( pxNewListItem != NULL )
+	taskENTER_CRITICAL();
 	{
-		taskENTER_CRITICAL();
+		if( uxRegisteredCommandCount < configCOMMAND_INT_MAX_COMMANDS )
 		{
-			/* Reference the command being registered from the newly created
-			list item. */
-			pxNewListItem->pxCommandLineDefinition = pxCommandToRegister;
-
-			/* The new list item will get added to the end of the list, so
-			pxNext has nowhere to point. */
-			pxNewListItem->pxNext = NULL;
-
-			/* Add the newly created list item to the end of the already existing
-			list. */
-			pxLastCommandInList->pxNext = pxNewListItem;
+			/* Find the insertion point, shifting the later names up by one. */
+			for( uxIndex = uxRegisteredCommandCount; uxIndex > 0; uxIndex-- )
+			{
+				if( strcmp( pxRegisteredCommands[ uxIndex - 1 ]->pcCommand, pxCommandToRegister->pcCommand ) <= 0 )
+				{
+					break;
+				}
+			}
 
-			/* Set the end of list marker to the new list item. */
-			pxLastCommandInList = pxNewListItem;
+			/* A name that is already registered would never be reached. */
+			if( ( uxIndex == 0 ) || ( strcmp( pxRegisteredCommands[ uxIndex - 1 ]->pcCommand, pxCommandToRegister->pcCommand ) != 0 ) )
+			{
+				memmove( &pxRegisteredCommands[ uxIndex + 1 ], &pxRegisteredCommands[ uxIndex ],
+						 ( uxRegisteredCommandCount - uxIndex ) * sizeof( pxRegisteredCommands[ 0 ] ) );
+				pxRegisteredCommands[ uxIndex ] = pxCommandToRegister;
+				uxRegisteredCommandCount++;
+				xReturn = pdPASS;
+			}
 		}
-		taskEXIT_CRITICAL();
-
-		xReturn = pdPASS;
 	}
+	taskEXIT_CRITICAL();
+
+	configASSERT( xReturn == pdPASS );
 
 	return xReturn;
 }
@@ -152,44 +163,57 @@ BaseType_t xReturn = pdFAIL;
 
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  )
 {
-static const CLI_Definition_List_Item_t *pxCommand = NULL;
+static const CLI_Command_Definition_t *pxCommand = NULL;
 BaseType_t xReturn = pdTRUE;
-const char *pcRegisteredCommandString;
-size_t xCommandStringLength;
+BaseType_t xParameters;
+UBaseType_t uxLow, uxHigh, uxMiddle;
+int iOrder;
 
 	/* Note:  This function is not re-entrant.  It must not be called from more
 	thank one task. */
 
 	if( pxCommand == NULL )
 	{
-		/* Search for the command string in the list of registered commands. */
-		for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+		/* Split the line, then binary search the sorted table for its first
+		word. */
+		xParameters = prvTokenise( pcCommandInput );
+
+		if( uxTokenCount > 0 )
 		{
-			pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-			xCommandStringLength = strlen( pcRegisteredCommandString );
-
-			/* To ensure the string lengths match exactly, so as not to pick up
-			a sub-string of a longer command, check the byte after the expected
-			end of the string is either the end of the string or a space before
-			a parameter. */
-			if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
+			uxLow = 0;
+			uxHigh = uxRegisteredCommandCount;
+			while( uxLow < uxHigh )
 			{
-				if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+				uxMiddle = ( uxLow + uxHigh ) / 2;
+				iOrder = prvCompareWord( pcTokens[ 0 ], ( size_t ) xTokenLengths[ 0 ], pxRegisteredCommands[ uxMiddle ]->pcCommand );
+				if( iOrder == 0 )
 				{
-					/* The command has been found.  Check it has the expected
-					number of parameters.  If cExpectedNumberOfParameters is -1,
-					then there could be a variable number of parameters and no
-					check is made. */
-					if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-					{
-						if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-						{
-							xReturn = pdFALSE;
-						}
-					}
-
+					pxCommand = pxRegisteredCommands[ uxMiddle ];
 					break;
 				}
+				else if( iOrder < 0 )
+				{
+					uxHigh = uxMiddle;
+				}
+				else
+				{
+					uxLow = uxMiddle + 1;
+				}
+			}
+		}
+
+		/* The command has been found.  Check it has the expected number of
+		parameters.  If cExpectedNumberOfParameters is -1, then there could be
+		a variable number of parameters and only the table size is checked. */
+		if( pxCommand != NULL )
+		{
+			if( xParameters < 0 )
+			{
+				xReturn = pdFALSE;
+			}
+			else if( ( pxCommand->cExpectedNumberOfParameters >= 0 ) && ( xParameters != pxCommand->cExpectedNumberOfParameters ) )
+			{
+				xReturn = pdFALSE;
 			}
 		}
 	}
@@ -204,7 +228,7 @@ size_t xCommandStringLength;
 	else if( pxCommand != NULL )
 	{
 		/* Call the callback function that is registered to this command. */
-		xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		xReturn = pxCommand->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
 
 		/* If xReturn is pdFALSE, then no further strings will be returned
 		after this one, and	pxCommand can be reset to NULL ready to search
@@ -238,6 +262,18 @@ const char *pcReturn = NULL;
 
 	*pxParameterStringLength = 0;
 
+	/* The line being processed has already been split. */
+	if( pcCommandString == pcTokenisedLine )
+	{
+		if( ( uxWantedParameter > 0 ) && ( uxWantedParameter < uxTokenCount ) )
+		{
+			*pxParameterStringLength = xTokenLengths[ uxWantedParameter ];
+			pcReturn = pcTokens[ uxWantedParameter ];
+		}
+
+		return pcReturn;
+	}
+
 	while( uxParametersFound < uxWantedParameter )
 	{
 		/* Index the character pointer past the current word.  If this is the start
@@ -287,28 +323,146 @@ const char *pcReturn = NULL;
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+BaseType_t FreeRTOS_CLIGetInt( const char *pcCommandString, UBaseType_t uxWantedParameter, int32_t lMin, int32_t lMax, int32_t *plValue )
 {
-static const CLI_Definition_List_Item_t * pxCommand = NULL;
-BaseType_t xReturn;
+BaseType_t xLength;
+const char *pcParameter;
+char *pcEnd;
+long lValue;
 
-	( void ) pcCommandString;
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, uxWantedParameter, &xLength );
+	if( pcParameter == NULL )
+	{
+		return pdFAIL;
+	}
 
-	if( pxCommand == NULL )
+	/* The word ends at a space or the end of the line, where strtol() stops. */
+	lValue = strtol( pcParameter, &pcEnd, 0 );
+	if( ( pcEnd != pcParameter + xLength ) || ( lValue < lMin ) || ( lValue > lMax ) )
 	{
-		/* Reset the pxCommand pointer back to the start of the list. */
-		pxCommand = &xRegisteredCommands;
+		return pdFAIL;
 	}
 
-	/* Return the next command help string, before moving the pointer on to
-	the next command in the list. */
-	strncpy( pcWriteBuffer, pxCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
-	pxCommand = pxCommand->pxNext;
+	*plValue = ( int32_t ) lValue;
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
 
-	if( pxCommand == NULL )
+BaseType_t FreeRTOS_CLIGetFloat( const char *pcCommandString, UBaseType_t uxWantedParameter, float fMin, float fMax, float *pfValue )
+{
+BaseType_t xLength;
+const char *pcParameter;
+char *pcEnd;
+float fValue;
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, uxWantedParameter, &xLength );
+	if( pcParameter == NULL )
+	{
+		return pdFAIL;
+	}
+
+	fValue = strtof( pcParameter, &pcEnd );
+	if( ( pcEnd != pcParameter + xLength ) || !( ( fValue >= fMin ) && ( fValue <= fMax ) ) )
+	{
+		return pdFAIL;
+	}
+
+	*pfValue = fValue;
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIGetEnum( const char *pcCommandString, UBaseType_t uxWantedParameter, const char * const *ppcNames, UBaseType_t uxNameCount, UBaseType_t *puxValue )
+{
+BaseType_t xLength;
+const char *pcParameter;
+UBaseType_t uxIndex;
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, uxWantedParameter, &xLength );
+	if( pcParameter == NULL )
+	{
+		return pdFAIL;
+	}
+
+	for( uxIndex = 0; uxIndex < uxNameCount; uxIndex++ )
+	{
+		if( ( strncmp( pcParameter, ppcNames[ uxIndex ], ( size_t ) xLength ) == 0 ) && ( ppcNames[ uxIndex ][ xLength ] == 0x00 ) )
+		{
+			*puxValue = uxIndex;
+			return pdPASS;
+		}
+	}
+
+	return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t FreeRTOS_CLIFindCommands( const char *pcPrefix, size_t xPrefixLength, UBaseType_t *puxFirst )
+{
+UBaseType_t uxLow = 0, uxHigh = uxRegisteredCommandCount, uxMiddle, uxFirst;
+
+	/* First name not ordered before the prefix... */
+	while( uxLow < uxHigh )
+	{
+		uxMiddle = ( uxLow + uxHigh ) / 2;
+		if( strncmp( pxRegisteredCommands[ uxMiddle ]->pcCommand, pcPrefix, xPrefixLength ) < 0 )
+		{
+			uxLow = uxMiddle + 1;
+		}
+		else
+		{
+			uxHigh = uxMiddle;
+		}
+	}
+	uxFirst = uxLow;
+
+	/* ...then the names that start with it follow it directly. */
+	uxHigh = uxRegisteredCommandCount;
+	while( uxLow < uxHigh )
+	{
+		uxMiddle = ( uxLow + uxHigh ) / 2;
+		if( strncmp( pxRegisteredCommands[ uxMiddle ]->pcCommand, pcPrefix, xPrefixLength ) == 0 )
+		{
+			uxLow = uxMiddle + 1;
+		}
+		else
+		{
+			uxHigh = uxMiddle;
+		}
+	}
+
+	*puxFirst = uxFirst;
+	return uxLow - uxFirst;
+}
+/*-----------------------------------------------------------*/
+
+const CLI_Command_Definition_t *FreeRTOS_CLIGetCommand( UBaseType_t uxIndex )
+{
+	if( uxIndex >= uxRegisteredCommandCount )
+	{
+		return NULL;
+	}
+
+	return pxRegisteredCommands[ uxIndex ];
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+static UBaseType_t uxIndex = 0;
+BaseType_t xReturn;
+
+	( void ) pcCommandString;
+
+	/* Return the next command help string, in name order. */
+	strncpy( pcWriteBuffer, pxRegisteredCommands[ uxIndex ]->pcHelpString, xWriteBufferLen );
+	uxIndex++;
+
+	if( uxIndex >= uxRegisteredCommandCount )
 	{
 		/* There are no more commands in the list, so there will be no more
 		strings to return after this one and pdFALSE should be returned. */
+		uxIndex = 0;
 		xReturn = pdFALSE;
 	}
 	else
@@ -320,38 +474,56 @@ BaseType_t xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static int8_t prvGetNumberOfParameters( const char *pcCommandString )
+static BaseType_t prvTokenise( const char *pcCommandString )
 {
-int8_t cParameters = 0;
-BaseType_t xLastCharacterWasSpace = pdFALSE;
+const char *pcLine = pcCommandString;
 
-	/* Count the number of space delimited words in pcCommandString. */
-	while( *pcCommandString != 0x00 )
+	pcTokenisedLine = pcLine;
+	uxTokenCount = 0;
+
+	for( ;; )
 	{
-		if( ( *pcCommandString ) == ' ' )
+		/* Find the start of the next word. */
+		while( *pcCommandString == ' ' )
 		{
-			if( xLastCharacterWasSpace != pdTRUE )
-			{
-				cParameters++;
-				xLastCharacterWasSpace = pdTRUE;
-			}
+			pcCommandString++;
 		}
-		else
+
+		if( *pcCommandString == 0x00 )
+		{
+			break;
+		}
+
+		if( uxTokenCount > configCOMMAND_INT_MAX_PARAMETERS )
 		{
-			xLastCharacterWasSpace = pdFALSE;
+			/* Too many words to index. */
+			pcTokenisedLine = NULL;
+			return -1;
 		}
 
-		pcCommandString++;
+		pcTokens[ uxTokenCount ] = pcCommandString;
+		while( ( *pcCommandString != 0x00 ) && ( *pcCommandString != ' ' ) )
+		{
+			pcCommandString++;
+		}
+		xTokenLengths[ uxTokenCount ] = ( BaseType_t ) ( pcCommandString - pcTokens[ uxTokenCount ] );
+		uxTokenCount++;
 	}
 
-	/* If the command string ended with spaces, then there will have been too
-	many parameters counted. */
-	if( xLastCharacterWasSpace == pdTRUE )
+	/* The first word is the command itself. */
+	return ( uxTokenCount > 0 ) ? ( BaseType_t ) ( uxTokenCount - 1 ) : 0;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareWord( const char *pcWord, size_t xWordLength, const char *pcCommand )
+{
+int iOrder = strncmp( pcWord, pcCommand, xWordLength );
+
+	if( iOrder == 0 )
 	{
-		cParameters--;
+		/* The word is a prefix of the name; equal only if the name ends here. */
+		iOrder = ( pcCommand[ xWordLength ] == 0x00 ) ? 0 : -1;
 	}
 
-	/* The value returned is one less than the number of space delimited words,
-	as the first word should be the command itself. */
-	return cParameters;
+	return iOrder;
 }
@@ -0,0 +1,302 @@
+/**
+ * @file      test_cli.c
+ * @brief     Host test and benchmark of the CLI command table.
+ *
+ * @details   Registers 200 commands in scrambled order and checks that the
+ *            table stays sorted, that every command is found by name, the
+ *            prefix searches used for completion at both ends of the table,
+ *            the typed parameter accessors, and the refusals (duplicate,
+ *            table full, wrong parameter count). Then times the lookup
+ *            against a linear scan of the same table.
+ */
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_CLI.h"
+#include "unit_test.h"
+
+#include <string.h>
+#include <time.h>
+
+#define COMMAND_COUNT       200
+#define NAME_BYTES          8
+#define OUTPUT_BYTES        128
+#define BENCH_ROUNDS        500
+
+/** @brief Typed parameters seen by the last run of the "cmd042" callback. */
+typedef struct {
+    BaseType_t int_ok;
+    BaseType_t float_ok;
+    BaseType_t enum_ok;
+    int32_t int_value;
+    float float_value;
+    UBaseType_t enum_value;
+} typed_result_t;
+
+static char s_names[COMMAND_COUNT][NAME_BYTES];
+static unsigned s_assert_count = 0;
+static typed_result_t s_typed;
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    (void)p_file;
+    (void)line;
+    s_assert_count++;
+}
+
+// --- Command Callbacks ---
+
+/** @brief Writes the command word, so the test sees which command ran. */
+static BaseType_t name_command(char* p_buffer, size_t len, const char* p_command) {
+    while (*p_command == ' ') {
+        p_command++;
+    }
+    size_t n = strcspn(p_command, " ");
+    n = (n < len - 1) ? n : len - 1;
+    memcpy(p_buffer, p_command, n);
+    p_buffer[n] = '\0';
+    return pdFALSE;
+}
+
+/** @brief Parses "<int -5..100> <float 0..1> <off|on>" with the typed accessors. */
+static BaseType_t typed_command(char* p_buffer, size_t len, const char* p_command) {
+    static const char* const names[] = {"off", "on"};
+    s_typed.int_ok = FreeRTOS_CLIGetInt(p_command, 1, -5, 100, &s_typed.int_value);
+    s_typed.float_ok = FreeRTOS_CLIGetFloat(p_command, 2, 0.0f, 1.0f, &s_typed.float_value);
+    s_typed.enum_ok = FreeRTOS_CLIGetEnum(p_command, 3, names, 2, &s_typed.enum_value);
+    return name_command(p_buffer, len, p_command);
+}
+
+static CLI_Command_Definition_t s_commands[COMMAND_COUNT];
+static const CLI_Command_Definition_t s_duplicate = {"cmd005", "cmd005 again\r\n", name_command, -1};
+static const CLI_Command_Definition_t s_two_params = {"pair", "pair <a> <b>\r\n", name_command, 2};
+
+// --- Private Helper Functions ---
+
+static double elapsed_ns(const struct timespec* p_start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)(end.tv_sec - p_start->tv_sec) * 1e9 + (double)(end.tv_nsec - p_start->tv_nsec);
+}
+
+/** @brief Runs a line to completion; returns the number of output parts. */
+static int run_line(const char* p_line, char* p_output) {
+    int parts = 0;
+    BaseType_t more;
+    do {
+        more = FreeRTOS_CLIProcessCommand(p_line, p_output, OUTPUT_BYTES);
+        parts++;
+    } while (more != pdFALSE);
+    return parts;
+}
+
+static UBaseType_t find(const char* p_prefix, size_t len, UBaseType_t* p_first) {
+    *p_first = 0xFFFF;
+    return FreeRTOS_CLIFindCommands(p_prefix, len, p_first);
+}
+
+/** @brief The linear scan the sorted table replaced, for the benchmark. */
+static const CLI_Command_Definition_t* linear_lookup(const char* p_name) {
+    const CLI_Command_Definition_t* p_command;
+    for (UBaseType_t i = 0; (p_command = FreeRTOS_CLIGetCommand(i)) != NULL; ++i) {
+        if (strcmp(p_command->pcCommand, p_name) == 0) {
+            return p_command;
+        }
+    }
+    return NULL;
+}
+
+// --- Tests ---
+
+static void test_register(void) {
+    // 37 is prime to 200: every name once, far from sorted
+    for (int i = 0; i < COMMAND_COUNT; ++i) {
+        int n = (i * 37) % COMMAND_COUNT;
+        snprintf(s_names[i], NAME_BYTES, "cmd%03d", n);
+        CLI_Command_Definition_t command = {
+            s_names[i], "cmd help\r\n", (n == 42) ? typed_command : name_command, -1
+        };
+        memcpy(&s_commands[i], &command, sizeof(command));
+        TEST_CHECK(FreeRTOS_CLIRegisterCommand(&s_commands[i]) == pdPASS);
+    }
+    TEST_CHECK(FreeRTOS_CLIRegisterCommand(&s_two_params) == pdPASS);
+
+    unsigned asserts = s_assert_count;
+    TEST_CHECK(FreeRTOS_CLIRegisterCommand(&s_duplicate) == pdFAIL);
+    TEST_CHECK(s_assert_count == asserts + 1);
+
+    // "cmd000".."cmd199", "help", "pair", in order
+    UBaseType_t count = 0;
+    const CLI_Command_Definition_t* p_previous = NULL;
+    const CLI_Command_Definition_t* p_command;
+    while ((p_command = FreeRTOS_CLIGetCommand(count)) != NULL) {
+        if (p_previous != NULL) {
+            TEST_CHECK(strcmp(p_previous->pcCommand, p_command->pcCommand) < 0);
+        }
+        p_previous = p_command;
+        count++;
+    }
+    TEST_CHECK(count == COMMAND_COUNT + 2);
+    TEST_CHECK(strcmp(FreeRTOS_CLIGetCommand(0)->pcCommand, "cmd000") == 0);
+    TEST_CHECK(strcmp(FreeRTOS_CLIGetCommand(COMMAND_COUNT)->pcCommand, "help") == 0);
+}
+
+static void test_lookup(void) {
+    char output[OUTPUT_BYTES];
+    char line[32];
+
+    for (int n = 0; n < COMMAND_COUNT; ++n) {
+        snprintf(line, sizeof(line), "  cmd%03d  1 2", n);
+        output[0] = '\0';
+        TEST_CHECK(run_line(line, output) == 1);
+        TEST_CHECK(strncmp(output, line + 2, 6) == 0 && output[6] == '\0');
+    }
+
+    // Whole words only: a prefix or an extension of a name is not it
+    TEST_CHECK(run_line("cmd01", output) == 1);
+    TEST_CHECK(strncmp(output, "Command not recognised", 22) == 0);
+    TEST_CHECK(run_line("cmd0011", output) == 1);
+    TEST_CHECK(strncmp(output, "Command not recognised", 22) == 0);
+    TEST_CHECK(run_line("", output) == 1);
+    TEST_CHECK(strncmp(output, "Command not recognised", 22) == 0);
+
+    // Parameter counts
+    TEST_CHECK(run_line("pair a b", output) == 1);
+    TEST_CHECK(strcmp(output, "pair") == 0);
+    TEST_CHECK(run_line("pair a", output) == 1);
+    TEST_CHECK(strncmp(output, "Incorrect command parameter", 27) == 0);
+    TEST_CHECK(run_line("cmd001 1 2 3 4 5 6 7 8", output) == 1);
+    TEST_CHECK(strcmp(output, "cmd001") == 0);
+    TEST_CHECK(run_line("cmd001 1 2 3 4 5 6 7 8 9", output) == 1);
+    TEST_CHECK(strncmp(output, "Incorrect command parameter", 27) == 0);
+
+    // "help" returns one part per command, in name order
+    TEST_CHECK(run_line("help", output) == COMMAND_COUNT + 2);
+    TEST_CHECK(strcmp(output, "pair <a> <b>\r\n") == 0);
+}
+
+static void test_find_commands(void) {
+    UBaseType_t first;
+
+    TEST_CHECK(find("", 0, &first) == COMMAND_COUNT + 2 && first == 0);
+    TEST_CHECK(find("c", 1, &first) == COMMAND_COUNT && first == 0);              // Start of the table
+    TEST_CHECK(find("cmd1", 4, &first) == 100 && first == 100);
+    TEST_CHECK(find("cmd19", 5, &first) == 10 && first == 190);
+    TEST_CHECK(find("cmd199", 6, &first) == 1 && first == 199);                   // A whole name
+    TEST_CHECK(find("cmd05xyz", 5, &first) == 10 && first == 50);                 // Only the length counts
+    TEST_CHECK(find("h", 1, &first) == 1 && first == COMMAND_COUNT);
+    TEST_CHECK(find("pa", 2, &first) == 1 && first == COMMAND_COUNT + 1);         // End of the table
+    TEST_CHECK(find("helpx", 5, &first) == 0);                                    // Longer than the name
+    TEST_CHECK(find("a", 1, &first) == 0 && first == 0);                          // Before every name
+    TEST_CHECK(find("z", 1, &first) == 0 && first == COMMAND_COUNT + 2);          // After every name
+    TEST_CHECK(find("cmd2", 4, &first) == 0 && first == COMMAND_COUNT);           // Between two names
+}
+
+static void test_typed_parameters(void) {
+    char output[OUTPUT_BYTES];
+
+    memset(&s_typed, 0, sizeof(s_typed));
+    run_line("cmd042 7 0.5 on", output);
+    TEST_CHECK(s_typed.int_ok == pdPASS && s_typed.int_value == 7);
+    TEST_CHECK(s_typed.float_ok == pdPASS && s_typed.float_value == 0.5f);
+    TEST_CHECK(s_typed.enum_ok == pdPASS && s_typed.enum_value == 1);
+
+    run_line("cmd042   0x10 1 off", output);
+    TEST_CHECK(s_typed.int_ok == pdPASS && s_typed.int_value == 16);
+    TEST_CHECK(s_typed.float_ok == pdPASS && s_typed.float_value == 1.0f);
+    TEST_CHECK(s_typed.enum_ok == pdPASS && s_typed.enum_value == 0);
+
+    run_line("cmd042 010 -0 off", output);
+    TEST_CHECK(s_typed.int_ok == pdPASS && s_typed.int_value == 8);              // Octal
+    TEST_CHECK(s_typed.float_ok == pdPASS && s_typed.float_value == 0.0f);
+
+    // Failures leave the destination unchanged
+    run_line("cmd042 -6 1.5 o", output);
+    TEST_CHECK(s_typed.int_ok == pdFAIL && s_typed.int_value == 8);
+    TEST_CHECK(s_typed.float_ok == pdFAIL && s_typed.float_value == 0.0f);
+    TEST_CHECK(s_typed.enum_ok == pdFAIL && s_typed.enum_value == 0);            // Prefix of a name
+    run_line("cmd042 7x nan onn", output);
+    TEST_CHECK(s_typed.int_ok == pdFAIL && s_typed.float_ok == pdFAIL && s_typed.enum_ok == pdFAIL);
+    run_line("cmd042 101", output);
+    TEST_CHECK(s_typed.int_ok == pdFAIL && s_typed.float_ok == pdFAIL && s_typed.enum_ok == pdFAIL);
+
+    // Outside a callback the line is scanned instead
+    int32_t value = 0;
+    TEST_CHECK(FreeRTOS_CLIGetInt("x  -5 y", 1, -5, 100, &value) == pdPASS && value == -5);
+    TEST_CHECK(FreeRTOS_CLIGetInt("x  -5 y", 2, -5, 100, &value) == pdFAIL);
+    TEST_CHECK(FreeRTOS_CLIGetInt("x  -5 y", 3, -5, 100, &value) == pdFAIL);
+}
+
+static void test_table_full(void) {
+    static CLI_Command_Definition_t extra[configCOMMAND_INT_MAX_COMMANDS];
+    static char names[configCOMMAND_INT_MAX_COMMANDS][NAME_BYTES];
+
+    UBaseType_t count = 0;
+    while (FreeRTOS_CLIGetCommand(count) != NULL) {
+        count++;
+    }
+    unsigned asserts = s_assert_count;
+    UBaseType_t added = 0;
+    while (count + added < configCOMMAND_INT_MAX_COMMANDS) {
+        snprintf(names[added], NAME_BYTES, "x%03lu", (unsigned long)added);
+        CLI_Command_Definition_t command = {names[added], "x\r\n", name_command, 0};
+        memcpy(&extra[added], &command, sizeof(command));
+        TEST_CHECK(FreeRTOS_CLIRegisterCommand(&extra[added]) == pdPASS);
+        added++;
+    }
+    TEST_CHECK(s_assert_count == asserts);
+    snprintf(names[added], NAME_BYTES, "a");
+    CLI_Command_Definition_t command = {names[added], "a\r\n", name_command, 0};
+    memcpy(&extra[added], &command, sizeof(command));
+    TEST_CHECK(FreeRTOS_CLIRegisterCommand(&extra[added]) == pdFAIL);
+    TEST_CHECK(s_assert_count == asserts + 1);
+    TEST_CHECK(FreeRTOS_CLIGetCommand(0) != &extra[added]);
+}
+
+static void bench_lookup(void) {
+    char output[OUTPUT_BYTES];
+    char lines[COMMAND_COUNT][16];
+    struct timespec start;
+    UBaseType_t first;
+    unsigned found = 0;
+
+    for (int n = 0; n < COMMAND_COUNT; ++n) {
+        snprintf(lines[n], sizeof(lines[n]), "cmd%03d 1 2", n);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        for (int n = 0; n < COMMAND_COUNT; ++n) {
+            (void)FreeRTOS_CLIProcessCommand(lines[n], output, OUTPUT_BYTES);
+        }
+    }
+    double sorted_ns = elapsed_ns(&start) / (BENCH_ROUNDS * COMMAND_COUNT);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        for (int n = 0; n < COMMAND_COUNT; ++n) {
+            found += (linear_lookup(s_names[n]) != NULL);
+        }
+    }
+    double linear_ns = elapsed_ns(&start) / (BENCH_ROUNDS * COMMAND_COUNT);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        for (int n = 0; n < COMMAND_COUNT; ++n) {
+            found += (FreeRTOS_CLIFindCommands(lines[n], 5, &first) != 0);
+        }
+    }
+    double complete_ns = elapsed_ns(&start) / (BENCH_ROUNDS * COMMAND_COUNT);
+
+    TEST_CHECK(found == 2 * BENCH_ROUNDS * COMMAND_COUNT);
+    printf("%d commands: line with lookup %.0f ns, linear scan alone %.0f ns, completion %.0f ns\n",
+           COMMAND_COUNT, sorted_ns, linear_ns, complete_ns);
+}
+
+int main(void) {
+    test_register();
+    test_lookup();
+    test_find_commands();
+    test_typed_parameters();
+    bench_lookup();
+    test_table_full();
+    return TEST_EXIT();
+}
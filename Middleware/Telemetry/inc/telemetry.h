@@ -0,0 +1,146 @@
+/**
+ * @file      telemetry.h
+ * @brief     Framed binary telemetry: COBS framing, CRC-16 and sequence numbers.
+ *
+ * @details   Each frame is an 8-byte header, a payload of up to
+ *            TELEMETRY_MAX_PAYLOAD bytes and a CRC-16/CCITT-FALSE over both,
+ *            COBS-encoded and terminated by a zero byte. A receiver can
+ *            therefore join the stream at any point, resynchronise on the
+ *            next zero and reject corrupted frames by their CRC. The sequence
+ *            number advances for every frame the sender attempts, including
+ *            those it drops, so gaps seen by the receiver count every lost
+ *            frame wherever it was lost.
+ *
+ *            The payload is gathered from a list of parts, each a run of
+ *            fixed-size elements at a fixed stride, and encoded straight into
+ *            space reserved in the output (typically a UART DMA ring): a
+ *            channel of an interleaved audio buffer, decimated, is one part,
+ *            and nothing is staged in between.
+ *
+ *            A frame is never split: when the reserved space ends at the wrap
+ *            of a ring and is too short, it is filled with zero bytes, which
+ *            the receiver sees as empty frames, and the frame starts at the
+ *            beginning of the ring. When there is not enough space the frame
+ *            is dropped rather than waited for.
+ *
+ *            Tools/telemetry/telemetry_rx.py is the matching receiver.
+ *
+ * @note      The library has no RTOS or hardware dependency. A telemetry_t
+ *            is owned by the caller and is not thread-safe.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Frame Format --- */
+
+#define TELEMETRY_HEADER_BYTES      8
+#define TELEMETRY_CRC_BYTES         2
+
+/** @brief Largest frame before encoding; up to 254 bytes costs one COBS byte. */
+#define TELEMETRY_MAX_RAW           254
+#define TELEMETRY_MAX_PAYLOAD       (TELEMETRY_MAX_RAW - TELEMETRY_HEADER_BYTES - TELEMETRY_CRC_BYTES)
+
+/** @brief Largest encoded frame, including the COBS overhead and the delimiter. */
+#define TELEMETRY_MAX_ENCODED       (TELEMETRY_MAX_RAW + 3)
+
+/** @brief Frame types. Values are part of the wire format; append only. */
+typedef enum {
+    TELEMETRY_FRAME_INFO = 1,       // Stream description, sent periodically
+    TELEMETRY_FRAME_AUDIO,          // Decimated samples of one tap (header channel = tap)
+    TELEMETRY_FRAME_BLOCK,          // Per-block DSP cost
+    TELEMETRY_FRAME_PARAMS,         // Effect parameter values
+} telemetry_frame_type_t;
+
+/**
+ * @brief Frame header, little-endian.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  type;                  //!< telemetry_frame_type_t
+    uint8_t  channel;               //!< Type-specific sub-stream, e.g. the audio tap
+    uint16_t seq;                   //!< Advances by one per attempted frame
+    uint32_t timestamp;             //!< Sender's clock, e.g. DWT cycles
+} telemetry_header_t;
+
+_Static_assert(sizeof(telemetry_header_t) == TELEMETRY_HEADER_BYTES, "Header size is part of the wire format");
+
+/* --- Public Types --- */
+
+/**
+ * @brief A run of `count` elements of `size` bytes, `stride` bytes apart.
+ * @details A contiguous array has stride == size. Elements are copied as
+ *          stored, so multi-byte values go out in the sender's byte order
+ *          (little-endian on Cortex-M).
+ */
+typedef struct {
+    const void* p_data;
+    uint16_t count;
+    uint8_t size;
+    uint16_t stride;
+} telemetry_part_t;
+
+/**
+ * @brief Output the frames are encoded into.
+ */
+typedef struct {
+    /** Returns the contiguous free bytes at *pp_space, which stay reserved until commit. */
+    size_t (*reserve)(void* p_context, uint8_t** pp_space);
+    /** Hands over `len` bytes written at the reserved space. */
+    void (*commit)(void* p_context, size_t len);
+    /** Returns the total free bytes, contiguous or not. */
+    size_t (*free_space)(void* p_context);
+    void* p_context;
+} telemetry_sink_t;
+
+/** @brief Sender counters. */
+typedef struct {
+    uint32_t frames;                // Frames sent
+    uint32_t bytes;                 // Encoded bytes sent, including padding
+    uint32_t dropped;               // Frames dropped for lack of space or oversize
+} telemetry_stats_t;
+
+/** @brief Sender state. */
+typedef struct {
+    telemetry_sink_t sink;
+    uint16_t seq;
+    telemetry_stats_t stats;
+} telemetry_t;
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Initialises a sender.
+ * @param[out] p_tel Sender to initialise.
+ * @param[in] p_sink Output; copied.
+ */
+void telemetry_init(telemetry_t* p_tel, const telemetry_sink_t* p_sink);
+
+/**
+ * @brief Encodes one frame into the sink.
+ *
+ * @param[in,out] p_tel The sender.
+ * @param[in] type telemetry_frame_type_t.
+ * @param[in] channel Type-specific sub-stream.
+ * @param[in] timestamp Sender's clock.
+ * @param[in] p_parts Payload parts, in order.
+ * @param[in] part_count Number of parts (may be 0).
+ *
+ * @return true if the frame was committed, false if it was dropped.
+ */
+bool telemetry_send(telemetry_t* p_tel, uint8_t type, uint8_t channel, uint32_t timestamp,
+                    const telemetry_part_t* p_parts, size_t part_count);
+
+/**
+ * @brief Updates a CRC-16/CCITT-FALSE (poly 0x1021, initial value 0xFFFF).
+ * @param[in] crc CRC so far, 0xFFFF to start.
+ * @param[in] p_data Bytes to add.
+ * @param[in] len Number of bytes.
+ * @return The updated CRC.
+ */
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t* p_data, size_t len);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,148 @@
+/**
+ * @file      telemetry.c
+ * @brief     Framed binary telemetry: COBS framing, CRC-16 and sequence numbers.
+ */
+
+#include "telemetry.h"
+
+#include <string.h>
+
+/**
+ * @brief COBS encoder writing into reserved space, with the CRC alongside.
+ * @details The code byte of the current block is patched when the block
+ *          ends, so the whole frame stays uncommitted until it is complete.
+ */
+typedef struct {
+    uint8_t* p_out;
+    uint8_t* p_code;
+    uint8_t code;
+    uint16_t crc;
+} cobs_encoder_t;
+
+/* CRC-16/CCITT-FALSE, four bits at a time */
+static const uint16_t s_crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+// --- Private Helper Functions ---
+
+static inline uint16_t crc16_byte(uint16_t crc, uint8_t byte) {
+    crc = (uint16_t)((crc << 4) ^ s_crc_nibble[(crc >> 12) ^ (byte >> 4)]);
+    crc = (uint16_t)((crc << 4) ^ s_crc_nibble[(crc >> 12) ^ (byte & 0x0F)]);
+    return crc;
+}
+
+static void cobs_begin(cobs_encoder_t* p_enc, uint8_t* p_dest) {
+    p_enc->p_code = p_dest;
+    p_enc->p_out = p_dest + 1;
+    p_enc->code = 1;
+    p_enc->crc = 0xFFFF;
+}
+
+static inline void cobs_put(cobs_encoder_t* p_enc, uint8_t byte) {
+    if (byte == 0) {
+        *p_enc->p_code = p_enc->code;
+        p_enc->p_code = p_enc->p_out++;
+        p_enc->code = 1;
+        return;
+    }
+    *p_enc->p_out++ = byte;
+    if (++p_enc->code == 0xFF) {
+        // A full block of 254 non-zero bytes carries no implied zero
+        *p_enc->p_code = p_enc->code;
+        p_enc->p_code = p_enc->p_out++;
+        p_enc->code = 1;
+    }
+}
+
+static inline void cobs_put_crc(cobs_encoder_t* p_enc, uint8_t byte) {
+    p_enc->crc = crc16_byte(p_enc->crc, byte);
+    cobs_put(p_enc, byte);
+}
+
+/** @brief Closes the frame and returns its encoded length, delimiter included. */
+static size_t cobs_end(cobs_encoder_t* p_enc, uint8_t* p_dest) {
+    *p_enc->p_code = p_enc->code;
+    *p_enc->p_out++ = 0;
+    return (size_t)(p_enc->p_out - p_dest);
+}
+
+// --- Public API Function Implementations ---
+
+void telemetry_init(telemetry_t* p_tel, const telemetry_sink_t* p_sink) {
+    p_tel->sink = *p_sink;
+    p_tel->seq = 0;
+    p_tel->stats = (telemetry_stats_t){0};
+}
+
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t* p_data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        crc = crc16_byte(crc, p_data[i]);
+    }
+    return crc;
+}
+
+bool telemetry_send(telemetry_t* p_tel, uint8_t type, uint8_t channel, uint32_t timestamp,
+                    const telemetry_part_t* p_parts, size_t part_count) {
+    const telemetry_header_t header = {
+        .type = type,
+        .channel = channel,
+        .seq = p_tel->seq++,
+        .timestamp = timestamp,
+    };
+
+    size_t raw = TELEMETRY_HEADER_BYTES + TELEMETRY_CRC_BYTES;
+    for (size_t i = 0; i < part_count; ++i) {
+        raw += (size_t)p_parts[i].count * p_parts[i].size;
+    }
+    if (raw > TELEMETRY_MAX_RAW) {
+        p_tel->stats.dropped++;
+        return false;
+    }
+    const size_t worst = raw + 3;           // Code bytes (two for a 254-byte run) and delimiter
+
+    // Reserve contiguous space, skipping the tail of a ring if it is too short
+    const telemetry_sink_t* p_sink = &p_tel->sink;
+    uint8_t* p_dest;
+    size_t space = p_sink->reserve(p_sink->p_context, &p_dest);
+    if (space < worst) {
+        if (p_sink->free_space(p_sink->p_context) < space + worst) {
+            p_tel->stats.dropped++;
+            return false;
+        }
+        memset(p_dest, 0, space);
+        p_sink->commit(p_sink->p_context, space);
+        p_tel->stats.bytes += (uint32_t)space;
+        space = p_sink->reserve(p_sink->p_context, &p_dest);
+        if (space < worst) {
+            p_tel->stats.dropped++;
+            return false;
+        }
+    }
+
+    cobs_encoder_t enc;
+    cobs_begin(&enc, p_dest);
+    const uint8_t* p_bytes = (const uint8_t*)&header;
+    for (size_t i = 0; i < sizeof(header); ++i) {
+        cobs_put_crc(&enc, p_bytes[i]);
+    }
+    for (size_t i = 0; i < part_count; ++i) {
+        const telemetry_part_t* p_part = &p_parts[i];
+        const uint8_t* p_element = (const uint8_t*)p_part->p_data;
+        for (uint16_t n = 0; n < p_part->count; ++n, p_element += p_part->stride) {
+            for (uint8_t b = 0; b < p_part->size; ++b) {
+                cobs_put_crc(&enc, p_element[b]);
+            }
+        }
+    }
+    uint16_t crc = enc.crc;
+    cobs_put(&enc, (uint8_t)(crc & 0xFF));
+    cobs_put(&enc, (uint8_t)(crc >> 8));
+    size_t encoded = cobs_end(&enc, p_dest);
+
+    p_sink->commit(p_sink->p_context, encoded);
+    p_tel->stats.frames++;
+    p_tel->stats.bytes += (uint32_t)encoded;
+    return true;
+}
@@ -0,0 +1,267 @@
+/**
+ * @file      test_telemetry.c
+ * @brief     Host test of the telemetry framing through a ring sink.
+ *
+ * @details   Frames go into a ring like the UART DMA ring and are read back
+ *            by a receiver written from the wire format alone, the same
+ *            steps as Tools/telemetry/telemetry_rx.py: split at zero bytes,
+ *            COBS-decode, check the CRC and the sequence numbers.
+ */
+
+#include "telemetry.h"
+#include "unit_test.h"
+
+#include <string.h>
+
+#define RING_BYTES          1024
+
+/** @brief A ring sink; the receiver drains it. */
+typedef struct {
+    uint8_t data[RING_BYTES];
+    uint32_t head;                  // Written by the sender
+    uint32_t tail;                  // Read by the receiver
+} ring_t;
+
+/** @brief Receiver state: the frame being collected and what it has seen. */
+typedef struct {
+    uint8_t encoded[TELEMETRY_MAX_ENCODED];
+    size_t length;
+    uint8_t raw[TELEMETRY_MAX_RAW];
+    size_t raw_length;              // Of the last good frame
+    uint32_t frames;
+    uint32_t empty;                 // Zero-length frames, from padding
+    uint32_t bad;                   // Failed COBS or CRC
+    uint32_t lost;                  // Gaps in the sequence numbers
+    bool has_seq;
+    uint16_t next_seq;
+} receiver_t;
+
+static ring_t s_ring;
+static receiver_t s_rx;
+static telemetry_t s_tel;
+
+// --- Ring Sink ---
+
+static size_t ring_reserve(void* p_context, uint8_t** pp_space) {
+    ring_t* p_ring = (ring_t*)p_context;
+    uint32_t index = p_ring->head % RING_BYTES;
+    uint32_t free_bytes = RING_BYTES - (p_ring->head - p_ring->tail);
+    uint32_t to_end = RING_BYTES - index;
+    *pp_space = &p_ring->data[index];
+    return (to_end < free_bytes) ? to_end : free_bytes;
+}
+
+static void ring_commit(void* p_context, size_t len) {
+    ((ring_t*)p_context)->head += (uint32_t)len;
+}
+
+static size_t ring_free_space(void* p_context) {
+    ring_t* p_ring = (ring_t*)p_context;
+    return RING_BYTES - (p_ring->head - p_ring->tail);
+}
+
+// --- Receiver ---
+
+/** @brief Decodes one COBS frame without its delimiter; returns its length, or -1. */
+static int cobs_decode(const uint8_t* p_in, size_t len, uint8_t* p_out, size_t capacity) {
+    size_t in = 0, out = 0;
+    while (in < len) {
+        uint8_t code = p_in[in++];
+        if (code == 0 || in + code - 1 > len) {
+            return -1;
+        }
+        for (uint8_t i = 1; i < code; ++i) {
+            if (out == capacity) {
+                return -1;
+            }
+            p_out[out++] = p_in[in++];
+        }
+        if (code != 0xFF && in < len) {
+            if (out == capacity) {
+                return -1;
+            }
+            p_out[out++] = 0;
+        }
+    }
+    return (int)out;
+}
+
+static void receive_frame(receiver_t* p_rx) {
+    if (p_rx->length == 0) {
+        p_rx->empty++;
+        return;
+    }
+    int n = cobs_decode(p_rx->encoded, p_rx->length, p_rx->raw, sizeof(p_rx->raw));
+    if (n < TELEMETRY_HEADER_BYTES + TELEMETRY_CRC_BYTES) {
+        p_rx->bad++;
+        return;
+    }
+    uint16_t crc = (uint16_t)(p_rx->raw[n - 2] | (p_rx->raw[n - 1] << 8));
+    if (telemetry_crc16(0xFFFF, p_rx->raw, (size_t)n - TELEMETRY_CRC_BYTES) != crc) {
+        p_rx->bad++;
+        return;
+    }
+
+    telemetry_header_t header;
+    memcpy(&header, p_rx->raw, sizeof(header));
+    if (p_rx->has_seq) {
+        p_rx->lost += (uint16_t)(header.seq - p_rx->next_seq);
+    }
+    p_rx->has_seq = true;
+    p_rx->next_seq = (uint16_t)(header.seq + 1);
+    p_rx->raw_length = (size_t)n;
+    p_rx->frames++;
+}
+
+/** @brief Drains the ring, handing complete frames to receive_frame(). */
+static void receive(ring_t* p_ring, receiver_t* p_rx) {
+    while (p_ring->tail != p_ring->head) {
+        uint8_t byte = p_ring->data[p_ring->tail++ % RING_BYTES];
+        if (byte == 0) {
+            receive_frame(p_rx);
+            p_rx->length = 0;
+        } else if (p_rx->length < sizeof(p_rx->encoded)) {
+            p_rx->encoded[p_rx->length++] = byte;
+        } else {
+            p_rx->bad++;
+        }
+    }
+}
+
+static void reset(void) {
+    const telemetry_sink_t sink = {ring_reserve, ring_commit, ring_free_space, &s_ring};
+    memset(&s_ring, 0, sizeof(s_ring));
+    memset(&s_rx, 0, sizeof(s_rx));
+    telemetry_init(&s_tel, &sink);
+}
+
+// --- Tests ---
+
+static void test_crc(void) {
+    // The CRC-16/CCITT-FALSE check value
+    TEST_CHECK(telemetry_crc16(0xFFFF, (const uint8_t*)"123456789", 9) == 0x29B1);
+    TEST_CHECK(telemetry_crc16(0xFFFF, NULL, 0) == 0xFFFF);
+}
+
+static void test_frame_layout(void) {
+    reset();
+
+    // Channel 1 of an interleaved stereo buffer, every other frame: stride 8
+    int16_t audio[32];
+    for (int i = 0; i < 32; ++i) {
+        audio[i] = (int16_t)((i & 1) ? 1000 * i : -i);
+    }
+    uint32_t index = 0x00000100UL;       // Zero bytes inside the payload
+    const telemetry_part_t parts[2] = {
+        {&index, 1, sizeof(index), sizeof(index)},
+        {&audio[1], 8, sizeof(int16_t), 4 * sizeof(int16_t)},
+    };
+    TEST_CHECK(telemetry_send(&s_tel, TELEMETRY_FRAME_AUDIO, 1, 0xA0B0C0D0UL, parts, 2));
+    receive(&s_ring, &s_rx);
+
+    TEST_CHECK(s_rx.frames == 1 && s_rx.bad == 0);
+    TEST_CHECK(s_rx.raw_length == TELEMETRY_HEADER_BYTES + 4 + 16 + TELEMETRY_CRC_BYTES);
+    telemetry_header_t header;
+    memcpy(&header, s_rx.raw, sizeof(header));
+    TEST_CHECK(header.type == TELEMETRY_FRAME_AUDIO && header.channel == 1);
+    TEST_CHECK(header.seq == 0 && header.timestamp == 0xA0B0C0D0UL);
+
+    uint32_t index_rx;
+    memcpy(&index_rx, &s_rx.raw[TELEMETRY_HEADER_BYTES], sizeof(index_rx));
+    TEST_CHECK(index_rx == index);
+    for (int i = 0; i < 8; ++i) {
+        int16_t sample;
+        memcpy(&sample, &s_rx.raw[TELEMETRY_HEADER_BYTES + 4 + 2 * i], sizeof(sample));
+        TEST_CHECK(sample == audio[1 + 4 * i]);
+    }
+    TEST_CHECK(s_tel.stats.frames == 1 && s_tel.stats.bytes == s_ring.head);
+}
+
+static void test_cobs_runs(void) {
+    reset();
+
+    // Largest payload: all zeros, then no zeros (one 254-byte COBS run)
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD + 1];
+    const telemetry_part_t part = {payload, TELEMETRY_MAX_PAYLOAD, 1, 1};
+    memset(payload, 0, sizeof(payload));
+    TEST_CHECK(telemetry_send(&s_tel, TELEMETRY_FRAME_PARAMS, 0, 1, &part, 1));
+    receive(&s_ring, &s_rx);
+    TEST_CHECK(s_rx.frames == 1 && s_rx.raw_length == TELEMETRY_MAX_RAW);
+    TEST_CHECK(s_rx.raw[TELEMETRY_HEADER_BYTES + 17] == 0);
+
+    memset(payload, 0x55, sizeof(payload));
+    uint32_t before = s_ring.head;
+    TEST_CHECK(telemetry_send(&s_tel, TELEMETRY_FRAME_PARAMS, 0, 0x01010101UL, &part, 1));
+    TEST_CHECK(s_ring.head - before <= TELEMETRY_MAX_ENCODED);
+    receive(&s_ring, &s_rx);
+    TEST_CHECK(s_rx.frames == 2 && s_rx.bad == 0 && s_rx.raw_length == TELEMETRY_MAX_RAW);
+    TEST_CHECK(s_rx.raw[TELEMETRY_HEADER_BYTES + TELEMETRY_MAX_PAYLOAD - 1] == 0x55);
+
+    // One byte more does not fit a frame
+    const telemetry_part_t oversize = {payload, TELEMETRY_MAX_PAYLOAD + 1, 1, 1};
+    before = s_ring.head;
+    TEST_CHECK(!telemetry_send(&s_tel, TELEMETRY_FRAME_PARAMS, 0, 2, &oversize, 1));
+    TEST_CHECK(s_ring.head == before && s_tel.stats.dropped == 1);
+}
+
+static void test_ring_wrap_and_drops(void) {
+    reset();
+
+    uint8_t payload[100];
+    memset(payload, 0xA5, sizeof(payload));
+    const telemetry_part_t part = {payload, sizeof(payload), 1, 1};
+    uint32_t sent = 0;
+
+    // Many times round the ring, sending faster than the receiver drains
+    for (uint32_t i = 0; i < 1000; ++i) {
+        if (telemetry_send(&s_tel, TELEMETRY_FRAME_BLOCK, 0, i, &part, 1)) {
+            sent++;
+        }
+        if ((i % 10) == 9) {
+            receive(&s_ring, &s_rx);
+        }
+    }
+    // A last frame after the drain, so trailing drops show as a gap too
+    receive(&s_ring, &s_rx);
+    TEST_CHECK(telemetry_send(&s_tel, TELEMETRY_FRAME_BLOCK, 0, 1000, &part, 1));
+    sent++;
+    receive(&s_ring, &s_rx);
+
+    // Every frame arrives whole, padding shows as empty frames, drops as gaps
+    TEST_CHECK(sent == s_tel.stats.frames);
+    TEST_CHECK(s_rx.frames == sent && s_rx.bad == 0);
+    TEST_CHECK(s_tel.stats.dropped > 0 && s_rx.empty > 0);
+    TEST_CHECK(s_rx.lost == s_tel.stats.dropped);
+    TEST_CHECK(s_tel.stats.bytes == s_ring.head);
+    printf("ring: %u frames, %u dropped, %u padding frames\n",
+           (unsigned)s_rx.frames, (unsigned)s_tel.stats.dropped, (unsigned)s_rx.empty);
+}
+
+static void test_join_mid_stream(void) {
+    reset();
+
+    uint8_t payload[40];
+    memset(payload, 0x11, sizeof(payload));
+    const telemetry_part_t part = {payload, sizeof(payload), 1, 1};
+    TEST_CHECK(telemetry_send(&s_tel, TELEMETRY_FRAME_BLOCK, 0, 0, &part, 1));
+    TEST_CHECK(telemetry_send(&s_tel, TELEMETRY_FRAME_BLOCK, 0, 1, &part, 1));
+
+    // Start reading in the middle of the first frame, then flip a byte of the second
+    s_ring.tail = 5;
+    s_ring.data[(s_ring.head - 10) % RING_BYTES] ^= 0x40;
+    receive(&s_ring, &s_rx);
+    TEST_CHECK(s_rx.frames == 0 && s_rx.bad == 2);
+
+    TEST_CHECK(telemetry_send(&s_tel, TELEMETRY_FRAME_BLOCK, 0, 2, &part, 1));
+    receive(&s_ring, &s_rx);
+    TEST_CHECK(s_rx.frames == 1 && s_rx.raw[2] == 2);    // Resynchronised on seq 2
+}
+
+int main(void) {
+    test_crc();
+    test_frame_layout();
+    test_cobs_runs();
+    test_ring_wrap_and_drops();
+    test_join_mid_stream();
+    return TEST_EXIT();
+}
@@ -0,0 +1,248 @@
+/**
+ * @file      trace_recorder.h
+ * @brief     Binary event trace recorder for scheduler, ISR and audio events.
+ *
+ * @details   Events are stored as compact 8-byte records in a RAM ring buffer,
+ *            timestamped with the Cortex-M4 DWT cycle counter. The kernel is
+ *            instrumented through the FreeRTOS trace macros defined at the end
+ *            of this file (pulled in by FreeRTOSConfig.h); application code adds
+ *            ISR and audio-pipeline events with the trace_* functions.
+ *
+ *            The buffer is dumped through a caller-supplied write function
+ *            (typically a UART) and decoded on the host by
+ *            Tools/trace/trace_decode.py.
+ *
+ *            The cycle counter follows the CPU clock. Whoever changes the
+ *            clock at runtime calls trace_clock_change(), and the decoder
+ *            rescales the timeline at each of those records.
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* --- Compile-time Configuration --- */
+
+/** @brief Set to 0 to compile every trace hook out of the kernel and application. */
+#ifndef TRACE_RECORDER_ENABLE
+#define TRACE_RECORDER_ENABLE       1
+#endif
+
+/** @brief Ring buffer capacity in records (8 bytes each). Must be a power of two. */
+#ifndef TRACE_BUFFER_RECORDS
+#define TRACE_BUFFER_RECORDS        2048
+#endif
+
+/** @brief Number of task/object names kept for the dump header. */
+#ifndef TRACE_MAX_NAMES
+#define TRACE_MAX_NAMES             24
+#endif
+
+/** @brief Fixed length of a name entry, including the terminator. */
+#define TRACE_NAME_LEN              12
+
+/* --- Record Format --- */
+
+/** @brief Event identifiers. Values are part of the dump format; append only. */
+typedef enum {
+    TRACE_EVENT_NONE = 0,
+    // Scheduler (arg = task number unless noted)
+    TRACE_EVENT_TASK_SWITCHED_IN,
+    TRACE_EVENT_TASK_READY,
+    TRACE_EVENT_TASK_CREATE,          // arg = new task number
+    TRACE_EVENT_TASK_DELETE,
+    TRACE_EVENT_TASK_DELAY,           // arg = 0
+    TRACE_EVENT_TASK_NOTIFY,          // arg = notified task number
+    TRACE_EVENT_TASK_NOTIFY_FROM_ISR, // arg = notified task number
+    TRACE_EVENT_TASK_NOTIFY_WAIT,     // arg = 0, task blocks on its notification
+    // Queues, semaphores and mutexes (arg = object id)
+    TRACE_EVENT_QUEUE_SEND,
+    TRACE_EVENT_QUEUE_SEND_FROM_ISR,
+    TRACE_EVENT_QUEUE_RECEIVE,
+    TRACE_EVENT_QUEUE_BLOCK_SEND,
+    TRACE_EVENT_QUEUE_BLOCK_RECEIVE,
+    // Stream buffers (arg = object id)
+    TRACE_EVENT_STREAM_SEND,
+    TRACE_EVENT_STREAM_SEND_FROM_ISR,
+    TRACE_EVENT_STREAM_RECEIVE,
+    TRACE_EVENT_STREAM_BLOCK_SEND,
+    TRACE_EVENT_STREAM_BLOCK_RECEIVE,
+    // Interrupts (arg = IRQ number)
+    TRACE_EVENT_ISR_ENTER,
+    TRACE_EVENT_ISR_EXIT,
+    // Audio pipeline (arg = half-buffer index or block sequence)
+    TRACE_EVENT_AUDIO_RX_READY,
+    TRACE_EVENT_AUDIO_TX_FREE,
+    TRACE_EVENT_AUDIO_DSP_START,
+    TRACE_EVENT_AUDIO_DSP_END,
+    TRACE_EVENT_AUDIO_XRUN,
+    // Free for application use (arg = user value)
+    TRACE_EVENT_USER,
+    // CPU clock change (arg = old MHz << 8 | new MHz)
+    TRACE_EVENT_CLOCK_CHANGE,
+} trace_event_t;
+
+/**
+ * @brief One 8-byte trace record.
+ */
+typedef struct {
+    uint32_t timestamp;   //!< DWT cycle counter at the time of the event
+    uint8_t  event;       //!< trace_event_t
+    uint8_t  task;        //!< Task number running when the event was recorded
+    uint16_t arg;         //!< Event-specific argument
+} trace_record_t;
+
+/** @brief Magic word at the start of a dump ("TRC1", little-endian). */
+#define TRACE_DUMP_MAGIC            0x31435254UL
+#define TRACE_DUMP_VERSION          2
+
+/** @brief Name table entry kinds. */
+#define TRACE_NAME_KIND_TASK        0
+#define TRACE_NAME_KIND_OBJECT      1
+
+/**
+ * @brief Set in the id of an object in CCMRAM. The other bits are the word
+ *        offset of the object into its region, CCMRAM or SRAM1/SRAM2.
+ */
+#define TRACE_OBJECT_ID_CCMRAM      0x8000U
+
+/**
+ * @brief Header of a dump. Followed by `name_count` trace_name_entry_t and
+ *        `record_count` trace_record_t, oldest record first.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;           //!< TRACE_DUMP_MAGIC
+    uint16_t version;         //!< TRACE_DUMP_VERSION
+    uint16_t record_size;     //!< sizeof(trace_record_t)
+    uint32_t timestamp_hz;    //!< CPU clock when the dump was taken, not over the whole trace;
+                              //!< records before a TRACE_EVENT_CLOCK_CHANGE ran at its old clock
+    uint32_t record_count;    //!< Records in this dump
+    uint32_t dropped;         //!< Records overwritten before the dump
+    uint16_t name_count;      //!< Entries in the name table
+    uint16_t name_size;       //!< sizeof(trace_name_entry_t)
+} trace_dump_header_t;
+
+/** @brief Name table entry mapping a task number or object id to a name. */
+typedef struct __attribute__((packed)) {
+    uint8_t  kind;                  //!< TRACE_NAME_KIND_*
+    uint8_t  reserved;
+    uint16_t id;                    //!< Task number or object id
+    char     name[TRACE_NAME_LEN];  //!< NUL-padded name
+} trace_name_entry_t;
+
+/**
+ * @brief Write function used by trace_dump().
+ * @param p_data Bytes to emit.
+ * @param len Number of bytes.
+ * @param user_data Context pointer passed to trace_dump().
+ * @return 0 on success, negative to abort the dump.
+ */
+typedef int (*trace_write_fn_t)(const uint8_t* p_data, size_t len, void* user_data);
+
+/* --- Public API Functions --- */
+
+/**
+ * @brief Enables the cycle counter and starts recording.
+ * @details Call before creating any kernel object so task names are captured.
+ */
+void trace_init(void);
+
+/** @brief Resumes recording after trace_stop(). */
+void trace_start(void);
+
+/** @brief Stops recording, freezing the buffer contents (e.g. on a detected glitch). */
+void trace_stop(void);
+
+/** @brief Returns true while events are being recorded. */
+bool trace_is_running(void);
+
+/** @brief Discards all recorded events. */
+void trace_clear(void);
+
+/**
+ * @brief Appends one record. Safe to call from tasks and ISRs.
+ * @param[in] event The event identifier.
+ * @param[in] arg Event-specific argument.
+ */
+void trace_record(trace_event_t event, uint16_t arg);
+
+/** @brief Marks entry into an interrupt handler. */
+void trace_isr_enter(uint16_t irq_num);
+
+/** @brief Marks exit from an interrupt handler. */
+void trace_isr_exit(uint16_t irq_num);
+
+/** @brief Records an audio-pipeline event. */
+void trace_audio_event(trace_event_t event, uint16_t arg);
+
+/**
+ * @brief Records a CPU clock change; call right after the switch.
+ * @details Records before it are timed at `from_hz`, those after at `to_hz`.
+ *          Both must be whole MHz below 256 MHz.
+ */
+void trace_clock_change(uint32_t from_hz, uint32_t to_hz);
+
+/**
+ * @brief Associates a name with a queue, mutex or stream buffer for the decoder.
+ * @param[in] p_object The kernel object handle.
+ * @param[in] p_name The name to show in the timeline.
+ */
+void trace_name_object(const void* p_object, const char* p_name);
+
+/**
+ * @brief Returns the compact 16-bit id recorded for a kernel object.
+ * @details Unique per object in SRAM1/SRAM2 or CCMRAM; see TRACE_OBJECT_ID_CCMRAM.
+ */
+uint16_t trace_object_id(const void* p_object);
+
+/**
+ * @brief Writes the header, name table and all buffered records.
+ * @details Recording is paused for the duration of the dump and resumed
+ *          afterwards if it was running.
+ *
+ * @param[in] write The function used to emit bytes.
+ * @param[in] user_data Context passed to `write`.
+ *
+ * @return 0 on success, or the negative value returned by `write`.
+ */
+int trace_dump(trace_write_fn_t write, void* user_data);
+
+/* --- Kernel hooks, called only from the trace macros below --- */
+
+void trace_hook_task_switched_in(uint8_t task_num);
+void trace_hook_task_create(uint8_t task_num, const char* p_name);
+
+/* --- FreeRTOS Trace Macro Bindings --- */
+
+#if (TRACE_RECORDER_ENABLE == 1)
+
+#define traceTASK_SWITCHED_IN()                     trace_hook_task_switched_in((uint8_t)pxCurrentTCB->uxTCBNumber)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)       trace_record(TRACE_EVENT_TASK_READY, (uint16_t)(pxTCB)->uxTCBNumber)
+#define traceTASK_CREATE(pxNewTCB)                  trace_hook_task_create((uint8_t)(pxNewTCB)->uxTCBNumber, (pxNewTCB)->pcTaskName)
+#define traceTASK_DELETE(pxTCB)                     trace_record(TRACE_EVENT_TASK_DELETE, (uint16_t)(pxTCB)->uxTCBNumber)
+#define traceTASK_DELAY()                           trace_record(TRACE_EVENT_TASK_DELAY, 0)
+#define traceTASK_DELAY_UNTIL(x)                    trace_record(TRACE_EVENT_TASK_DELAY, 0)
+#define traceTASK_NOTIFY(uxIndexToNotify)           trace_record(TRACE_EVENT_TASK_NOTIFY, (uint16_t)pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_FROM_ISR(uxIndexToNotify)  trace_record(TRACE_EVENT_TASK_NOTIFY_FROM_ISR, (uint16_t)pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR(uxIndexToNotify) trace_record(TRACE_EVENT_TASK_NOTIFY_FROM_ISR, (uint16_t)pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_WAIT_BLOCK(uxIndexToWait)  trace_record(TRACE_EVENT_TASK_NOTIFY_WAIT, 0)
+#define traceTASK_NOTIFY_TAKE_BLOCK(uxIndexToWait)  trace_record(TRACE_EVENT_TASK_NOTIFY_WAIT, 0)
+
+#define traceQUEUE_SEND(pxQueue)                    trace_record(TRACE_EVENT_QUEUE_SEND, trace_object_id(pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)           trace_record(TRACE_EVENT_QUEUE_SEND_FROM_ISR, trace_object_id(pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue)                 trace_record(TRACE_EVENT_QUEUE_RECEIVE, trace_object_id(pxQueue))
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)        trace_record(TRACE_EVENT_QUEUE_BLOCK_SEND, trace_object_id(pxQueue))
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)     trace_record(TRACE_EVENT_QUEUE_BLOCK_RECEIVE, trace_object_id(pxQueue))
+
+#define traceSTREAM_BUFFER_SEND(xStreamBuffer, xBytesSent)                 trace_record(TRACE_EVENT_STREAM_SEND, trace_object_id(xStreamBuffer))
+#define traceSTREAM_BUFFER_SEND_FROM_ISR(xStreamBuffer, xBytesSent)        trace_record(TRACE_EVENT_STREAM_SEND_FROM_ISR, trace_object_id(xStreamBuffer))
+#define traceSTREAM_BUFFER_RECEIVE(xStreamBuffer, xReceivedLength)         trace_record(TRACE_EVENT_STREAM_RECEIVE, trace_object_id(xStreamBuffer))
+#define traceBLOCKING_ON_STREAM_BUFFER_SEND(xStreamBuffer)                 trace_record(TRACE_EVENT_STREAM_BLOCK_SEND, trace_object_id(xStreamBuffer))
+#define traceBLOCKING_ON_STREAM_BUFFER_RECEIVE(xStreamBuffer)              trace_record(TRACE_EVENT_STREAM_BLOCK_RECEIVE, trace_object_id(xStreamBuffer))
+
+#endif // TRACE_RECORDER_ENABLE
+
+#endif // TRACE_RECORDER_H
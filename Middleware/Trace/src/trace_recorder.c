@@ -0,0 +1,200 @@
+/**
+ * @file      trace_recorder.c
+ * @brief     Binary event trace recorder for scheduler, ISR and audio events.
+ */
+
+#include "trace_recorder.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <string.h>
+
+/* --- DWT cycle counter (Cortex-M4) --- */
+#define DWT_CTRL                MMIO32(DWT_BASE + 0x000)
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+#define DWT_CTRL_CYCCNTENA      BIT0
+#define SCB_DEMCR               MMIO32(SCS_BASE + 0xDFC)
+#define SCB_DEMCR_TRCENA        BIT24
+#define DWT_LAR                 MMIO32(DWT_BASE + CORESIGHT_LAR_OFFSET)
+
+#define TRACE_BUFFER_MASK       (TRACE_BUFFER_RECORDS - 1U)
+
+// Memory region of a kernel object, from the top address bits
+#define TRACE_REGION_MASK       0xF0000000UL
+#define TRACE_CCMRAM_BASE       0x10000000UL
+
+#if (TRACE_BUFFER_RECORDS & (TRACE_BUFFER_RECORDS - 1)) != 0
+#error "TRACE_BUFFER_RECORDS must be a power of two"
+#endif
+
+// --- Static Data ---
+static trace_record_t s_buffer[TRACE_BUFFER_RECORDS];
+static uint32_t s_write_count = 0;     // Total records written, never wraps in practice
+static volatile bool s_is_running = false;
+static volatile uint8_t s_current_task = 0;
+
+static trace_name_entry_t s_names[TRACE_MAX_NAMES];
+static uint16_t s_name_count = 0;
+
+// --- Private Helper Functions ---
+
+static void add_name(uint8_t kind, uint16_t id, const char* p_name) {
+    UBaseType_t saved = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    trace_name_entry_t* entry = NULL;
+    for (uint16_t i = 0; i < s_name_count; ++i) {
+        if (s_names[i].kind == kind && s_names[i].id == id) {
+            entry = &s_names[i]; // Task numbers are never reused, objects may be
+            break;
+        }
+    }
+    if (entry == NULL && s_name_count < TRACE_MAX_NAMES) {
+        entry = &s_names[s_name_count++];
+    }
+    if (entry != NULL) {
+        entry->kind = kind;
+        entry->reserved = 0;
+        entry->id = id;
+        memset(entry->name, 0, TRACE_NAME_LEN);
+        strncpy(entry->name, p_name, TRACE_NAME_LEN - 1);
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+// --- Public API Function Implementations ---
+
+void trace_init(void) {
+    SCB_DEMCR |= SCB_DEMCR_TRCENA;
+    DWT_LAR = CORESIGHT_LAR_KEY;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA; // Left running; the boot-time report shares it
+
+    trace_clear();
+    s_is_running = true;
+}
+
+void trace_start(void) {
+    s_is_running = true;
+}
+
+void trace_stop(void) {
+    s_is_running = false;
+}
+
+bool trace_is_running(void) {
+    return s_is_running;
+}
+
+void trace_clear(void) {
+    UBaseType_t saved = portSET_INTERRUPT_MASK_FROM_ISR();
+    s_write_count = 0;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+void trace_record(trace_event_t event, uint16_t arg) {
+    if (!s_is_running) {
+        return;
+    }
+
+    // Masking up to configMAX_SYSCALL_INTERRUPT_PRIORITY keeps this safe from
+    // every ISR that can itself call into the kernel (and thus the recorder).
+    UBaseType_t saved = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace_record_t* record = &s_buffer[s_write_count & TRACE_BUFFER_MASK];
+    record->timestamp = DWT_CYCCNT;
+    record->event = (uint8_t)event;
+    record->task = s_current_task;
+    record->arg = arg;
+    s_write_count++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+void trace_isr_enter(uint16_t irq_num) {
+    trace_record(TRACE_EVENT_ISR_ENTER, irq_num);
+}
+
+void trace_isr_exit(uint16_t irq_num) {
+    trace_record(TRACE_EVENT_ISR_EXIT, irq_num);
+}
+
+void trace_audio_event(trace_event_t event, uint16_t arg) {
+    trace_record(event, arg);
+}
+
+void trace_clock_change(uint32_t from_hz, uint32_t to_hz) {
+    uint16_t from_mhz = (uint16_t)((from_hz / 1000000UL) & 0xFFU);
+    uint16_t to_mhz = (uint16_t)((to_hz / 1000000UL) & 0xFFU);
+    trace_record(TRACE_EVENT_CLOCK_CHANGE, (uint16_t)((from_mhz << 8) | to_mhz));
+}
+
+uint16_t trace_object_id(const void* p_object) {
+    // Kernel objects are word aligned. The word offset into SRAM1/SRAM2
+    // (128 KB) fits in 15 bits, and into CCMRAM (64 KB) in 14, so the top bit
+    // tells the two regions apart and the id is unique per object.
+    uintptr_t address = (uintptr_t)p_object;
+    if ((address & TRACE_REGION_MASK) == TRACE_CCMRAM_BASE) {
+        return (uint16_t)(TRACE_OBJECT_ID_CCMRAM | ((address & 0xFFFFUL) >> 2));
+    }
+    return (uint16_t)((address & 0x1FFFFUL) >> 2);
+}
+
+void trace_name_object(const void* p_object, const char* p_name) {
+    if (p_object != NULL && p_name != NULL) {
+        add_name(TRACE_NAME_KIND_OBJECT, trace_object_id(p_object), p_name);
+    }
+}
+
+void trace_hook_task_switched_in(uint8_t task_num) {
+    s_current_task = task_num;
+    trace_record(TRACE_EVENT_TASK_SWITCHED_IN, task_num);
+}
+
+void trace_hook_task_create(uint8_t task_num, const char* p_name) {
+    add_name(TRACE_NAME_KIND_TASK, task_num, p_name);
+    trace_record(TRACE_EVENT_TASK_CREATE, task_num);
+}
+
+int trace_dump(trace_write_fn_t write, void* user_data) {
+    if (write == NULL) {
+        return -1;
+    }
+
+    bool was_running = s_is_running;
+    s_is_running = false;
+
+    uint32_t count = (s_write_count < TRACE_BUFFER_RECORDS) ? s_write_count : TRACE_BUFFER_RECORDS;
+    uint32_t first = s_write_count - count;
+
+    trace_dump_header_t header = {
+        .magic = TRACE_DUMP_MAGIC,
+        .version = TRACE_DUMP_VERSION,
+        .record_size = sizeof(trace_record_t),
+        .timestamp_hz = configCPU_CLOCK_HZ,     // SystemCoreClock: the clock at dump time only
+        .record_count = count,
+        .dropped = first,
+        .name_count = s_name_count,
+        .name_size = sizeof(trace_name_entry_t),
+    };
+
+    int ret = write((const uint8_t*)&header, sizeof(header), user_data);
+    if (ret == 0 && s_name_count > 0) {
+        ret = write((const uint8_t*)s_names, s_name_count * sizeof(trace_name_entry_t), user_data);
+    }
+
+    // Emit the ring in at most two contiguous chunks, oldest record first
+    if (ret == 0 && count > 0) {
+        uint32_t start = first & TRACE_BUFFER_MASK;
+        uint32_t first_chunk = TRACE_BUFFER_RECORDS - start;
+        if (first_chunk > count) {
+            first_chunk = count;
+        }
+        ret = write((const uint8_t*)&s_buffer[start], first_chunk * sizeof(trace_record_t), user_data);
+        if (ret == 0 && first_chunk < count) {
+            ret = write((const uint8_t*)&s_buffer[0], (count - first_chunk) * sizeof(trace_record_t), user_data);
+        }
+    }
+
+    s_is_running = was_running;
+    return ret;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file      app_objects.c
+ * @brief     Static storage, validation and creation of the application's kernel objects.
+ */
+
+#include "app_objects.h"
+#include "common.h"
+#include "trace_recorder.h"
+#include "timers.h"
+
+#include <stdio.h>
+
+/* --- DWT cycle counter (Cortex-M4), used for the boot-time measurement --- */
+#define DWT_CTRL                MMIO32(DWT_BASE + 0x000)
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+#define DWT_CTRL_CYCCNTENA      BIT0
+#define SCB_DEMCR               MMIO32(SCS_BASE + 0xDFC)
+#define SCB_DEMCR_TRCENA        BIT24
+#define DWT_LAR                 MMIO32(DWT_BASE + CORESIGHT_LAR_OFFSET)
+
+/* --- Compile-time Validation --- */
+
+#define APP_CHECK_TASK(name, fn, label, depth, prio)                                                   \
+    _Static_assert((depth) >= configMINIMAL_STACK_SIZE, "task " #name ": stack below minimum");     \
+    _Static_assert((prio) < configMAX_PRIORITIES, "task " #name ": priority out of range");          \
+    _Static_assert(sizeof(label) <= configMAX_TASK_NAME_LEN, "task " #name ": name too long");
+#define APP_CHECK_STREAM(name, label, size, trigger)                                                   \
+    _Static_assert((trigger) >= 1 && (trigger) < (size), "stream " #name ": bad trigger level");
+#define APP_CHECK_QUEUE(name, label, length, item_size)                                                \
+    _Static_assert((length) > 0 && (item_size) > 0, "queue " #name ": empty queue");
+
+APP_TASK_TABLE(APP_CHECK_TASK)
+APP_STREAM_TABLE(APP_CHECK_STREAM)
+APP_QUEUE_TABLE(APP_CHECK_QUEUE)
+
+_Static_assert(configSUPPORT_STATIC_ALLOCATION == 1, "app_objects requires configSUPPORT_STATIC_ALLOCATION");
+
+/* --- RAM Accounting --- */
+
+#define APP_TASK_RAM(depth)             (sizeof(StackType_t) * (depth) + sizeof(StaticTask_t))
+#define APP_STREAM_RAM(size)            ((size) + 1 + sizeof(StaticStreamBuffer_t))
+#define APP_QUEUE_RAM(length, item)     ((length) * (item) + sizeof(StaticQueue_t))
+#define APP_MUTEX_RAM                   (sizeof(StaticSemaphore_t))
+
+#define APP_SUM_TASK(name, fn, label, depth, prio)        + APP_TASK_RAM(depth)
+#define APP_SUM_STREAM(name, label, size, trigger)        + APP_STREAM_RAM(size)
+#define APP_SUM_QUEUE(name, label, length, item_size)     + APP_QUEUE_RAM(length, item_size)
+#define APP_SUM_MUTEX(name, label)                        + APP_MUTEX_RAM
+
+/** @brief RAM reserved for all table objects plus the idle and timer service tasks. */
+#define APP_OBJECTS_RAM_BYTES  (0 APP_TASK_TABLE(APP_SUM_TASK) APP_STREAM_TABLE(APP_SUM_STREAM) \
+                                  APP_QUEUE_TABLE(APP_SUM_QUEUE) APP_MUTEX_TABLE(APP_SUM_MUTEX)  \
+                                + APP_TASK_RAM(configMINIMAL_STACK_SIZE)                          \
+                                + APP_TASK_RAM(configTIMER_TASK_STACK_DEPTH))
+
+_Static_assert(APP_OBJECTS_RAM_BYTES <= APP_OBJECTS_RAM_BUDGET, "kernel objects exceed APP_OBJECTS_RAM_BUDGET");
+
+/* --- Static Storage and Handles --- */
+
+#define APP_DEFINE_TASK(name, fn, label, depth, prio) \
+    TaskHandle_t name##TaskHandle = NULL;              \
+    static StackType_t s_##name##_stack[depth];        \
+    static StaticTask_t s_##name##_tcb;
+#define APP_DEFINE_STREAM(name, label, size, trigger)  \
+    StreamBufferHandle_t name##StreamHandle = NULL;     \
+    static uint8_t s_##name##_storage[(size) + 1];      \
+    static StaticStreamBuffer_t s_##name##_scb;
+#define APP_DEFINE_QUEUE(name, label, length, item_size) \
+    QueueHandle_t name##QueueHandle = NULL;               \
+    static uint8_t s_##name##_storage[(length) * (item_size)]; \
+    static StaticQueue_t s_##name##_qcb;
+#define APP_DEFINE_MUTEX(name, label)                  \
+    SemaphoreHandle_t name##MutexHandle = NULL;         \
+    static StaticSemaphore_t s_##name##_mcb;
+
+APP_TASK_TABLE(APP_DEFINE_TASK)
+APP_STREAM_TABLE(APP_DEFINE_STREAM)
+APP_QUEUE_TABLE(APP_DEFINE_QUEUE)
+APP_MUTEX_TABLE(APP_DEFINE_MUTEX)
+
+static StackType_t s_idle_stack[configMINIMAL_STACK_SIZE];
+static StaticTask_t s_idle_tcb;
+static StackType_t s_timer_stack[configTIMER_TASK_STACK_DEPTH];
+static StaticTask_t s_timer_tcb;
+
+/* --- Report Table --- */
+
+typedef struct {
+    const char* kind;
+    const char* name;
+    uint32_t bytes;
+} app_object_info_t;
+
+#define APP_INFO_TASK(name, fn, label, depth, prio)      { "task",   label, APP_TASK_RAM(depth) },
+#define APP_INFO_STREAM(name, label, size, trigger)      { "stream", label, APP_STREAM_RAM(size) },
+#define APP_INFO_QUEUE(name, label, length, item_size)   { "queue",  label, APP_QUEUE_RAM(length, item_size) },
+#define APP_INFO_MUTEX(name, label)                      { "mutex",  label, APP_MUTEX_RAM },
+
+static const app_object_info_t s_object_info[] = {
+    APP_TASK_TABLE(APP_INFO_TASK)
+    APP_STREAM_TABLE(APP_INFO_STREAM)
+    APP_QUEUE_TABLE(APP_INFO_QUEUE)
+    APP_MUTEX_TABLE(APP_INFO_MUTEX)
+    { "task", "IDLE", APP_TASK_RAM(configMINIMAL_STACK_SIZE) },
+    { "task", "Tmr Svc", APP_TASK_RAM(configTIMER_TASK_STACK_DEPTH) },
+};
+
+// --- Static Data ---
+static uint32_t s_boot_start_cycles = 0;
+static uint32_t s_boot_cycles = 0;
+static bool s_boot_done = false;
+static size_t s_heap_free_at_boot = 0;
+
+// --- Kernel Static Memory Callbacks ---
+
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer,
+                                   StackType_t** ppxIdleTaskStackBuffer,
+                                   uint32_t* pulIdleTaskStackSize) {
+    *ppxIdleTaskTCBBuffer = &s_idle_tcb;
+    *ppxIdleTaskStackBuffer = s_idle_stack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer,
+                                    StackType_t** ppxTimerTaskStackBuffer,
+                                    uint32_t* pulTimerTaskStackSize) {
+    *ppxTimerTaskTCBBuffer = &s_timer_tcb;
+    *ppxTimerTaskStackBuffer = s_timer_stack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+// --- Public API Function Implementations ---
+
+void app_objects_boot_begin(void) {
+    SCB_DEMCR |= SCB_DEMCR_TRCENA;
+    DWT_LAR = CORESIGHT_LAR_KEY;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+    s_boot_start_cycles = DWT_CYCCNT;
+}
+
+bool app_objects_create(void) {
+#define APP_CREATE_MUTEX(name, label)                                              \
+    name##MutexHandle = xSemaphoreCreateMutexStatic(&s_##name##_mcb);              \
+    if (name##MutexHandle == NULL) { return false; }                               \
+    trace_name_object(name##MutexHandle, label);
+#define APP_CREATE_QUEUE(name, label, length, item_size)                           \
+    name##QueueHandle = xQueueCreateStatic((length), (item_size),                  \
+                                           s_##name##_storage, &s_##name##_qcb);   \
+    if (name##QueueHandle == NULL) { return false; }                               \
+    trace_name_object(name##QueueHandle, label);
+#define APP_CREATE_STREAM(name, label, size, trigger)                              \
+    name##StreamHandle = xStreamBufferCreateStatic((size), (trigger),              \
+                                                   s_##name##_storage, &s_##name##_scb); \
+    if (name##StreamHandle == NULL) { return false; }                              \
+    trace_name_object(name##StreamHandle, label);
+#define APP_CREATE_TASK(name, fn, label, depth, prio)                              \
+    name##TaskHandle = xTaskCreateStatic(fn, label, (depth), NULL, (prio),         \
+                                         s_##name##_stack, &s_##name##_tcb);       \
+    if (name##TaskHandle == NULL) { return false; }
+
+    APP_MUTEX_TABLE(APP_CREATE_MUTEX)
+    APP_QUEUE_TABLE(APP_CREATE_QUEUE)
+    APP_STREAM_TABLE(APP_CREATE_STREAM)
+    APP_TASK_TABLE(APP_CREATE_TASK)
+
+#undef APP_CREATE_MUTEX
+#undef APP_CREATE_QUEUE
+#undef APP_CREATE_STREAM
+#undef APP_CREATE_TASK
+
+    return true;
+}
+
+void app_objects_boot_end(void) {
+    s_boot_cycles = DWT_CYCCNT - s_boot_start_cycles;
+    s_heap_free_at_boot = xPortGetFreeHeapSize();
+    s_boot_done = true;
+}
+
+uint32_t app_objects_get_boot_time_us(void) {
+    uint32_t cycles_per_us = configCPU_CLOCK_HZ / 1000000UL;
+    if (!s_boot_done || cycles_per_us == 0) {
+        return 0;
+    }
+    // Cycles before SystemClock_Config() ran at the HSI rate, so this slightly
+    // overstates the time spent in that part of the boot
+    return s_boot_cycles / cycles_per_us;
+}
+
+size_t app_objects_get_static_ram(void) {
+    return APP_OBJECTS_RAM_BYTES;
+}
+
+size_t app_objects_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    size_t offset = 0;
+    int n = snprintf(p_buffer, len, "Kind    Name        Bytes\r\n");
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    offset = ((size_t)n < len) ? (size_t)n : len - 1;
+
+    for (size_t i = 0; i < sizeof(s_object_info) / sizeof(s_object_info[0]) && offset < len - 1; ++i) {
+        n = snprintf(&p_buffer[offset], len - offset, "%-6s  %-10s  %5lu\r\n",
+                     s_object_info[i].kind, s_object_info[i].name, (unsigned long)s_object_info[i].bytes);
+        if (n < 0) {
+            break;
+        }
+        offset += ((size_t)n < len - offset) ? (size_t)n : (len - offset - 1);
+    }
+
+    if (offset < len - 1) {
+        n = snprintf(&p_buffer[offset], len - offset,
+                     "Static: %lu of %lu bytes  Heap: %lu free at boot, %lu now, %lu min of %lu\r\n"
+                     "Boot: %lu us\r\n",
+                     (unsigned long)APP_OBJECTS_RAM_BYTES, (unsigned long)APP_OBJECTS_RAM_BUDGET,
+                     (unsigned long)s_heap_free_at_boot, (unsigned long)xPortGetFreeHeapSize(),
+                     (unsigned long)xPortGetMinimumEverFreeHeapSize(), (unsigned long)configTOTAL_HEAP_SIZE,
+                     (unsigned long)app_objects_get_boot_time_us());
+        if (n > 0) {
+            offset += ((size_t)n < len - offset) ? (size_t)n : (len - offset - 1);
+        }
+    }
+
+    return offset;
+}
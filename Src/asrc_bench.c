@@ -0,0 +1,217 @@
+/**
+ * @file      asrc_bench.c
+ * @brief     Sample-rate converter benchmark: cost and distortion on target.
+ */
+
+#include "asrc_bench.h"
+#include "asrc.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+#define BENCH_CHANNELS          2
+#define BENCH_PERIOD            (ASRC_BENCH_OUTPUT_HZ / ASRC_BENCH_TONE_HZ)   // Output frames per tone period
+#define BENCH_SETTLE_FRAMES     (4 * ASRC_TAPS)
+#define BENCH_AMPLITUDE         16384.0f                                     // -6 dBFS
+
+_Static_assert(ASRC_BENCH_OUTPUT_HZ % ASRC_BENCH_TONE_HZ == 0, "The tone must have a whole output period");
+_Static_assert(2 * ASRC_BENCH_TONE_HZ < ASRC_BENCH_INPUT_HZ && 2 * ASRC_BENCH_TONE_HZ < ASRC_BENCH_OUTPUT_HZ,
+               "The tone must be below both Nyquist frequencies");
+
+/**
+ * @brief Running sums of the sine fit. The basis is orthogonal over whole
+ *        periods, so the fit and the residual follow from these sums alone.
+ */
+typedef struct {
+    uint32_t frames;
+    double sum_sin;
+    double sum_cos;
+    double sum;
+    double sum_sq;
+} sine_fit_t;
+
+typedef struct {
+    uint32_t cycles;
+    uint32_t frames_out;
+    sine_fit_t fit;
+} bench_result_t;
+
+// --- Static Data ---
+static asrc_t s_asrc;
+static int16_t s_in[ASRC_BENCH_CHUNK_FRAMES * BENCH_CHANNELS];
+static int16_t s_out[(ASRC_BENCH_CHUNK_FRAMES * 2 + 4) * BENCH_CHANNELS];  // Room for any ratio up to 2x
+static float s_sin[BENCH_PERIOD];
+static float s_cos[BENCH_PERIOD];
+
+// --- Private Helper Functions ---
+
+static void fill_tables(void) {
+    for (uint32_t i = 0; i < BENCH_PERIOD; ++i) {
+        float w = 6.2831853f * (float)i / (float)BENCH_PERIOD;
+        s_sin[i] = sinf(w);
+        s_cos[i] = cosf(w);
+    }
+}
+
+/** @brief Generates input frames; the phase is exact integer arithmetic. */
+static void fill_input(uint32_t first_frame) {
+    for (uint32_t i = 0; i < ASRC_BENCH_CHUNK_FRAMES; ++i) {
+        uint32_t phase = (uint32_t)(((uint64_t)(first_frame + i) * ASRC_BENCH_TONE_HZ) % ASRC_BENCH_INPUT_HZ);
+        int16_t v = (int16_t)lrintf(BENCH_AMPLITUDE * sinf(6.2831853f * (float)phase / (float)ASRC_BENCH_INPUT_HZ));
+        s_in[i * BENCH_CHANNELS] = v;
+        s_in[i * BENCH_CHANNELS + 1] = v;
+    }
+}
+
+static void fit_frames(sine_fit_t* p_fit, uint32_t first_output, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t n = first_output + (uint32_t)i;
+        if (n < BENCH_SETTLE_FRAMES) {
+            continue;
+        }
+        double y = (double)s_out[i * BENCH_CHANNELS];
+        uint32_t k = (n - BENCH_SETTLE_FRAMES) % BENCH_PERIOD;
+        p_fit->sum_sin += y * s_sin[k];
+        p_fit->sum_cos += y * s_cos[k];
+        p_fit->sum += y;
+        p_fit->sum_sq += y * y;
+        p_fit->frames++;
+    }
+}
+
+/** @brief THD+N in hundredths of a dB, or 0 if nothing was fitted. */
+static int32_t thd_n_centi_db(const sine_fit_t* p_fit) {
+    double n = (double)p_fit->frames;
+    if (n == 0.0) {
+        return 0;
+    }
+    double a = 2.0 * p_fit->sum_sin / n;
+    double b = 2.0 * p_fit->sum_cos / n;
+    double dc = p_fit->sum / n;
+    double signal = n * (a * a + b * b) / 2.0;
+    double residual = p_fit->sum_sq - signal - n * dc * dc;
+    if (signal <= 0.0 || residual <= 0.0) {
+        return 0;
+    }
+    return (int32_t)lrint(1000.0 * log10(residual / signal));
+}
+
+static bool run(bool q15, float correction_ppm, bench_result_t* p_result) {
+    const asrc_config_t config = {
+        .input_rate_hz = ASRC_BENCH_INPUT_HZ,
+        .output_rate_hz = ASRC_BENCH_OUTPUT_HZ,
+        .channels = BENCH_CHANNELS,
+        .max_correction_ppm = 1000.0f,
+    };
+    if (!asrc_init(&s_asrc, &config)) {
+        return false;
+    }
+    asrc_set_correction(&s_asrc, correction_ppm);
+
+    *p_result = (bench_result_t){0};
+    size_t capacity = sizeof(s_out) / sizeof(s_out[0]) / BENCH_CHANNELS;
+
+    // The fit needs whole periods of an exact tone, so none for the drift run
+    uint32_t fit_end = 0;
+    if (correction_ppm == 0.0f) {
+        uint32_t expected = (uint32_t)((uint64_t)ASRC_BENCH_FRAMES * ASRC_BENCH_OUTPUT_HZ / ASRC_BENCH_INPUT_HZ);
+        fit_end = BENCH_SETTLE_FRAMES + ((expected - 2 * BENCH_SETTLE_FRAMES) / BENCH_PERIOD) * BENCH_PERIOD;
+    }
+
+    for (uint32_t frame = 0; frame + ASRC_BENCH_CHUNK_FRAMES <= ASRC_BENCH_FRAMES; frame += ASRC_BENCH_CHUNK_FRAMES) {
+        fill_input(frame);
+
+        vTaskSuspendAll();
+        uint32_t start = DWT_CYCCNT;
+#if (ASRC_FLOAT_PATH == 1)
+        size_t produced = q15 ? asrc_process_q15(&s_asrc, s_in, ASRC_BENCH_CHUNK_FRAMES, s_out, capacity)
+                              : asrc_process(&s_asrc, s_in, ASRC_BENCH_CHUNK_FRAMES, s_out, capacity);
+#else
+        (void)q15;
+        size_t produced = asrc_process_q15(&s_asrc, s_in, ASRC_BENCH_CHUNK_FRAMES, s_out, capacity);
+#endif
+        p_result->cycles += DWT_CYCCNT - start;
+        (void)xTaskResumeAll();
+
+        if (p_result->frames_out < fit_end) {
+            size_t count = (p_result->frames_out + produced > fit_end) ? fit_end - p_result->frames_out : produced;
+            fit_frames(&p_result->fit, p_result->frames_out, count);
+        }
+        p_result->frames_out += (uint32_t)produced;
+    }
+    return true;
+}
+
+/** @brief Appends one result row; returns the new offset. */
+static size_t append_row(char* p_buffer, size_t len, size_t offset, const char* label, const bench_result_t* p_result) {
+    if (offset >= len - 1) {
+        return offset;
+    }
+
+    // Hundredths of a cycle per output frame, and the load at the output rate in tenths of a percent
+    uint32_t centi_cycles = 0;
+    uint32_t load_permille = 0;
+    if (p_result->frames_out != 0) {
+        centi_cycles = (uint32_t)(((uint64_t)p_result->cycles * 100ULL) / p_result->frames_out);
+        load_permille = (uint32_t)(((uint64_t)centi_cycles * ASRC_BENCH_OUTPUT_HZ * 10ULL) /
+                                   ((uint64_t)configCPU_CLOCK_HZ));
+    }
+
+    char thd[16];
+    int32_t centi_db = thd_n_centi_db(&p_result->fit);
+    if (centi_db == 0) {
+        snprintf(thd, sizeof(thd), "-");
+    } else {
+        snprintf(thd, sizeof(thd), "-%ld.%02ld", (long)(-centi_db / 100), (long)(-centi_db % 100));
+    }
+
+    int n = snprintf(&p_buffer[offset], len - offset, "%-16s %5lu.%02lu %4lu.%lu%% %9s\r\n",
+                     label, (unsigned long)(centi_cycles / 100), (unsigned long)(centi_cycles % 100),
+                     (unsigned long)(load_permille / 10), (unsigned long)(load_permille % 10), thd);
+    if (n < 0) {
+        return offset;
+    }
+    return offset + (((size_t)n < len - offset) ? (size_t)n : (len - offset - 1));
+}
+
+// --- Public API Function Implementations ---
+
+size_t asrc_bench_run(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    int n = snprintf(p_buffer, len, "ASRC %u -> %u Hz, stereo %u Hz tone, %u taps x %u phases\r\n"
+                     "%-16s %8s %6s %9s\r\n",
+                     (unsigned)ASRC_BENCH_INPUT_HZ, (unsigned)ASRC_BENCH_OUTPUT_HZ, (unsigned)ASRC_BENCH_TONE_HZ,
+                     (unsigned)ASRC_TAPS, (unsigned)ASRC_PHASES, "Path", "cyc/frm", "load", "THD+N dB");
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    size_t offset = ((size_t)n < len) ? (size_t)n : len - 1;
+
+    fill_tables();
+    bench_result_t result;
+
+#if (ASRC_FLOAT_PATH == 1)
+    if (run(false, 0.0f, &result)) {
+        offset = append_row(p_buffer, len, offset, "float", &result);
+    }
+#endif
+    if (run(true, 0.0f, &result)) {
+        offset = append_row(p_buffer, len, offset, "q15", &result);
+    }
+    if (run(true, ASRC_BENCH_DRIFT_PPM, &result)) {
+        offset = append_row(p_buffer, len, offset, "q15 drifting", &result);
+    }
+    return offset;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file      audio_io.c
+ * @brief     I2S capture and playback streams of the audio pipeline.
+ */
+
+#include "audio_io.h"
+#include "i2s.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdio.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+_Static_assert(AUDIO_BLOCK_SAMPLES % 2 == 0 && AUDIO_BLOCK_SAMPLES <= 0xFFFF,
+               "AUDIO_BLOCK_SAMPLES must be an even DMA item count");
+
+/**
+ * @brief Block count and timing of one direction.
+ */
+typedef struct {
+    volatile uint32_t blocks;
+    uint32_t last_cycles;
+    uint64_t cycles;            // From the first block to the latest one
+} block_clock_t;
+
+// --- Static Data ---
+static int16_t* s_rx_buffer = NULL;
+static int16_t* s_tx_buffer = NULL;
+static audio_io_half_fn s_on_rx_ready = NULL;
+static audio_io_half_fn s_on_tx_free = NULL;
+
+static i2s_handle_t s_i2s_out = NULL;       // I2S3, also capturing in full duplex
+static i2s_handle_t s_i2s_in = NULL;        // I2S2, split topology only
+static volatile bool s_is_streaming = false;
+
+static block_clock_t s_rx_clock;
+static block_clock_t s_tx_clock;
+static uint32_t s_offset_ref = 0;           // Zeroes block_offset at the first TX block
+
+// Philips I2S, 16-bit stereo. I2S3 drives the CS43L22 and provides its MCLK.
+static const I2S_Init_t s_out_config = {
+    .Mode = I2S_MODE_MASTER_TX,
+    .Standard = I2S_STANDARD_PHILIPS,
+    .DataLength = I2S_DATA_LENGTH_16B,
+    .ChannelLength = I2S_CHANNEL_LENGTH_16B,
+    .ClockPolarity = I2S_CPOL_LOW,
+    .AudioFrequency = AUDIO_SAMPLING_RATE,
+    .MCLKOutput = I2S_MCLK_OUTPUT_ENABLE,
+};
+
+#if (AUDIO_IO_FULL_DUPLEX == 0)
+static const I2S_Init_t s_in_config = {
+    .Mode = I2S_MODE_MASTER_RX,
+    .Standard = I2S_STANDARD_PHILIPS,
+    .DataLength = I2S_DATA_LENGTH_16B,
+    .ChannelLength = I2S_CHANNEL_LENGTH_16B,
+    .ClockPolarity = I2S_CPOL_LOW,
+    .AudioFrequency = AUDIO_SAMPLING_RATE,
+    .MCLKOutput = I2S_MCLK_OUTPUT_DISABLE,
+};
+#endif
+
+// --- Private Helper Functions ---
+
+static void note_block(block_clock_t* p_clock) {
+    uint32_t now = DWT_CYCCNT;
+    if (p_clock->blocks > 0) {
+        p_clock->cycles += (uint32_t)(now - p_clock->last_cycles);
+    }
+    p_clock->last_cycles = now;
+    p_clock->blocks++;
+}
+
+static uint32_t half_of(const int16_t* p_block, const int16_t* p_buffer) {
+    return (p_block == p_buffer) ? 0 : 1;
+}
+
+#if (AUDIO_IO_FULL_DUPLEX == 1)
+/** @brief Both directions switch halves on the same frame: one event for both. */
+static void on_duplex_block(void* p_context, const int16_t* p_rx_block, int16_t* p_tx_block) {
+    (void)p_context;
+    note_block(&s_tx_clock);
+    note_block(&s_rx_clock);
+    // TX first, so the pipeline sees the freed half when it is woken for RX
+    s_on_tx_free(half_of(p_tx_block, s_tx_buffer));
+    s_on_rx_ready(half_of(p_rx_block, s_rx_buffer));
+}
+#else
+static void on_rx_block(void* p_context, const int16_t* p_rx_block, int16_t* p_tx_block) {
+    (void)p_context;
+    (void)p_tx_block;
+    note_block(&s_rx_clock);
+    s_on_rx_ready(half_of(p_rx_block, s_rx_buffer));
+}
+
+static void on_tx_block(void* p_context, const int16_t* p_rx_block, int16_t* p_tx_block) {
+    (void)p_context;
+    (void)p_rx_block;
+    if (s_tx_clock.blocks == 0) {
+        s_offset_ref = s_rx_clock.blocks - 1;
+    }
+    note_block(&s_tx_clock);
+    s_on_tx_free(half_of(p_tx_block, s_tx_buffer));
+}
+#endif
+
+static uint32_t abs_ppm(const i2s_clock_info_t* p_info) {
+    return (uint32_t)((p_info->error_ppm < 0) ? -p_info->error_ppm : p_info->error_ppm);
+}
+
+// --- Public API Function Implementations ---
+
+bool audio_io_start(int16_t* p_rx_buffer, int16_t* p_tx_buffer,
+                    audio_io_half_fn on_rx_ready, audio_io_half_fn on_tx_free) {
+    if (p_rx_buffer == NULL || p_tx_buffer == NULL || on_rx_ready == NULL || on_tx_free == NULL ||
+        s_i2s_out != NULL) {
+        return false;
+    }
+    s_rx_buffer = p_rx_buffer;
+    s_tx_buffer = p_tx_buffer;
+    s_on_rx_ready = on_rx_ready;
+    s_on_tx_free = on_tx_free;
+
+    s_i2s_out = i2s_init(3, &s_out_config);
+    if (s_i2s_out == NULL) {
+        return false;
+    }
+
+#if (AUDIO_IO_FULL_DUPLEX == 1)
+    const i2s_stream_config_t stream = {
+        .p_rx_buffer = p_rx_buffer,
+        .p_tx_buffer = p_tx_buffer,
+        .block_samples = AUDIO_BLOCK_SAMPLES,
+        .callback = on_duplex_block,
+    };
+    if (i2s_start_stream(s_i2s_out, &stream) != 0) {
+        i2s_deinit(&s_i2s_out);
+        return false;
+    }
+    s_is_streaming = true;
+    return true;
+#else
+    s_i2s_in = i2s_init(2, &s_in_config);
+    if (s_i2s_in == NULL) {
+        i2s_deinit(&s_i2s_out);
+        return false;
+    }
+
+    const i2s_stream_config_t out_stream = {
+        .p_tx_buffer = p_tx_buffer,
+        .block_samples = AUDIO_BLOCK_SAMPLES,
+        .callback = on_tx_block,
+    };
+    const i2s_stream_config_t in_stream = {
+        .p_rx_buffer = p_rx_buffer,
+        .block_samples = AUDIO_BLOCK_SAMPLES,
+        .callback = on_rx_block,
+    };
+    if (i2s_start_stream(s_i2s_out, &out_stream) != 0 || i2s_start_stream(s_i2s_in, &in_stream) != 0) {
+        i2s_deinit(&s_i2s_in);
+        i2s_deinit(&s_i2s_out);
+        return false;
+    }
+    s_is_streaming = true;
+    return true;
+#endif
+}
+
+bool audio_io_is_streaming(void) {
+    return s_is_streaming;
+}
+
+void audio_io_get_stats(audio_io_stats_t* p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    block_clock_t rx = s_rx_clock;
+    block_clock_t tx = s_tx_clock;
+    uint32_t offset_ref = s_offset_ref;
+    taskEXIT_CRITICAL();
+
+    i2s_stats_t out = {0};
+    i2s_stats_t in = {0};
+    i2s_get_stats(s_i2s_out, &out);
+    i2s_get_stats(s_i2s_in, &in);
+
+    p_stats->full_duplex = (AUDIO_IO_FULL_DUPLEX == 1);
+    p_stats->rx_blocks = rx.blocks;
+    p_stats->tx_blocks = tx.blocks;
+    p_stats->block_offset = (tx.blocks == 0) ? 0 : (int32_t)(rx.blocks - tx.blocks - offset_ref);
+    p_stats->dma_errors = out.dma_errors + in.dma_errors;
+
+    i2s_clock_info_t out_clock = {0};
+    i2s_clock_info_t in_clock = {0};
+    i2s_get_clock_info(s_i2s_out, &out_clock);
+    i2s_get_clock_info(s_i2s_in, &in_clock);
+    uint32_t out_ppm = abs_ppm(&out_clock);
+    uint32_t in_ppm = abs_ppm(&in_clock);
+    p_stats->rate_error_ppm = (out_ppm > in_ppm) ? out_ppm : in_ppm;
+    p_stats->out_rate_mhz = out_clock.actual_mhz;
+    // In full duplex the I2S3ext runs from the I2S3 clock
+    p_stats->in_rate_mhz = (s_i2s_in != NULL) ? in_clock.actual_mhz : out_clock.actual_mhz;
+
+    // What the two prescalers alone make of the shared PLLI2S output
+    p_stats->expected_drift_ppm = 0;
+    if (!p_stats->full_duplex && in_clock.actual_mhz != 0 && out_clock.actual_mhz != 0) {
+        p_stats->expected_drift_ppm = (int32_t)(((double)in_clock.actual_mhz / out_clock.actual_mhz - 1.0) * 1e6);
+    }
+
+    // Rates in blocks per cycle; both are measured against the same CPU clock
+    p_stats->drift_ppm = 0;
+    if (!p_stats->full_duplex && rx.blocks > 1 && tx.blocks > 1 && rx.cycles != 0 && tx.cycles != 0) {
+        double rx_rate = (double)(rx.blocks - 1) / (double)rx.cycles;
+        double tx_rate = (double)(tx.blocks - 1) / (double)tx.cycles;
+        p_stats->drift_ppm = (int32_t)((rx_rate / tx_rate - 1.0) * 1e6);
+    }
+}
+
+size_t audio_io_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    audio_io_stats_t stats;
+    audio_io_get_stats(&stats);
+
+    int n = snprintf(p_buffer, len,
+                     "Audio I/O: %s\r\n"
+                     "rx blocks %lu  tx blocks %lu  offset %ld\r\n"
+                     "rate out %lu.%03lu Hz  in %lu.%03lu Hz  (error %lu ppm)\r\n"
+                     "drift %ld ppm (%ld expected from the shared PLLI2S)  dma errors %lu\r\n",
+                     stats.full_duplex ? "full duplex, I2S3 + I2S3ext" : "split, I2S2 in / I2S3 out",
+                     (unsigned long)stats.rx_blocks, (unsigned long)stats.tx_blocks, (long)stats.block_offset,
+                     (unsigned long)(stats.out_rate_mhz / 1000), (unsigned long)(stats.out_rate_mhz % 1000),
+                     (unsigned long)(stats.in_rate_mhz / 1000), (unsigned long)(stats.in_rate_mhz % 1000),
+                     (unsigned long)stats.rate_error_ppm,
+                     (long)stats.drift_ppm, (long)stats.expected_drift_ppm, (unsigned long)stats.dma_errors);
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file      clock_governor.c
+ * @brief     CPU clock scaling driven by the measured DSP load.
+ */
+
+#include "clock_governor.h"
+#include "dsp_profile.h"
+#include "flash.h"
+#include "rcc.h"
+#include "trace_recorder.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include <stdio.h>
+
+#define LEVEL_COUNT             (sizeof(s_levels) / sizeof(s_levels[0]))
+
+/* FreeRTOS port: recomputes the SysTick reload and the tickless constants */
+extern void vPortSetupTimerInterrupt(void);
+
+// --- Static Data ---
+static const rcc_sysclk_freq_t s_levels[] = {
+    RCC_SYSCLK_FREQ_84_MHZ, RCC_SYSCLK_FREQ_120_MHZ, RCC_SYSCLK_FREQ_168_MHZ,
+};
+static const char* const s_mode_names[] = {"auto", "fixed", "fixed", "fixed"};
+
+static TimerHandle_t s_timer = NULL;
+static StaticTimer_t s_timer_buffer;
+
+// Set by the console, read by the timer callback
+static volatile clock_governor_mode_t s_mode = CLOCK_GOVERNOR_AUTO;
+
+// Owned by the timer callback
+static uint32_t s_level;
+static uint32_t s_load_permille;
+static uint32_t s_switches;
+static uint32_t s_switch_failures;
+static TickType_t s_level_since;
+static uint64_t s_level_ticks[LEVEL_COUNT];
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Keeps the kernel's view of the CPU clock in step with the hardware.
+ * @details configCPU_CLOCK_HZ is SystemCoreClock, so the tick rate and every
+ *          cycle count converted to time follow the new clock. Reloading
+ *          SysTick drops the fraction of the current tick.
+ */
+static void governor_clock_listener(rcc_clock_phase_t phase, const rcc_clock_change_t* p_change, void* p_context) {
+    (void)p_context;
+    if (phase != RCC_CLOCK_POST_CHANGE) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    SystemCoreClock = p_change->to.ahb_hz;
+    vPortSetupTimerInterrupt();
+    taskEXIT_CRITICAL();
+
+    // The trace timestamps count core cycles: mark where their rate changes
+    if (p_change->to.ahb_hz != p_change->from.ahb_hz) {
+        trace_clock_change(p_change->from.ahb_hz, p_change->to.ahb_hz);
+    }
+
+    // Cycles per block are only comparable at one clock
+    dsp_profile_reset();
+}
+
+static uint32_t level_hz(uint32_t level) {
+    return rcc_sysclk_freq_to_hz(s_levels[level]);
+}
+
+static void account_time(void) {
+    TickType_t now = xTaskGetTickCount();
+    s_level_ticks[s_level] += (TickType_t)(now - s_level_since);
+    s_level_since = now;
+}
+
+static uint32_t choose_level(uint32_t load) {
+    clock_governor_mode_t mode = s_mode;
+    if (mode != CLOCK_GOVERNOR_AUTO) {
+        return (uint32_t)mode - 1;
+    }
+    if (load > CLOCK_GOVERNOR_UP_PERMILLE) {
+        return LEVEL_COUNT - 1;
+    }
+    // Assume the block takes as many cycles at the lower clock
+    if (s_level > 0 &&
+        ((uint64_t)load * level_hz(s_level)) / level_hz(s_level - 1) < CLOCK_GOVERNOR_DOWN_PERMILLE) {
+        return s_level - 1;
+    }
+    return s_level;
+}
+
+static void governor_timer_callback(TimerHandle_t timer) {
+    (void)timer;
+    s_load_permille = dsp_profile_take_peak_load();
+    account_time();
+
+    uint32_t level = choose_level(s_load_permille);
+    if (level == s_level) {
+        return;
+    }
+    if (rcc_set_sysclk(s_levels[level])) {
+        s_level = level;
+        s_switches++;
+    } else {
+        s_switch_failures++;
+    }
+}
+
+// --- Public API Function Implementations ---
+
+bool clock_governor_init(void) {
+    // The FLASH driver's listener keeps the wait states valid
+    if (flash_init() == NULL || rcc_register_clock_listener(governor_clock_listener, NULL) != 0) {
+        return false;
+    }
+
+    // Start from the level the startup code selected, or the fastest
+    uint32_t sysclk_hz = rcc_get_sysclk_frequency();
+    s_level = LEVEL_COUNT - 1;
+    for (uint32_t i = 0; i < LEVEL_COUNT; ++i) {
+        if (level_hz(i) == sysclk_hz) {
+            s_level = i;
+        }
+    }
+    s_level_since = xTaskGetTickCount();
+
+    if (s_timer == NULL) {
+        s_timer = xTimerCreateStatic("clkgov", pdMS_TO_TICKS(CLOCK_GOVERNOR_PERIOD_MS), pdTRUE, NULL,
+                                     governor_timer_callback, &s_timer_buffer);
+    }
+    if (s_timer == NULL) {
+        return false;
+    }
+    return xTimerStart(s_timer, 0) == pdPASS;
+}
+
+void clock_governor_set_mode(clock_governor_mode_t mode) {
+    if (mode <= CLOCK_GOVERNOR_FIXED_168_MHZ) {
+        s_mode = mode;
+    }
+}
+
+clock_governor_mode_t clock_governor_get_mode(void) {
+    return s_mode;
+}
+
+size_t clock_governor_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    rcc_clocks_t clocks;
+    rcc_get_clocks(&clocks);
+
+    // Include the time at the current level up to now
+    uint64_t ticks[LEVEL_COUNT];
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < LEVEL_COUNT; ++i) {
+        ticks[i] = s_level_ticks[i];
+        if (i == s_level) {
+            ticks[i] += (TickType_t)(xTaskGetTickCount() - s_level_since);
+        }
+        total += ticks[i];
+    }
+    uint32_t share[LEVEL_COUNT];
+    for (uint32_t i = 0; i < LEVEL_COUNT; ++i) {
+        share[i] = (total > 0) ? (uint32_t)((ticks[i] * 1000ULL) / total) : 0;
+    }
+
+    int n = snprintf(p_buffer, len,
+                     "CPU clock: %lu MHz (%s)  AHB %lu  APB1 %lu  APB2 %lu MHz\r\n"
+                     "DSP peak load: %lu.%lu%%  down below %u.%u%%, up above %u.%u%%\r\n"
+                     "Switches: %lu (failed %lu)  time at 84/120/168 MHz: %lu.%lu%% %lu.%lu%% %lu.%lu%%\r\n",
+                     (unsigned long)(clocks.sysclk_hz / 1000000), s_mode_names[s_mode],
+                     (unsigned long)(clocks.ahb_hz / 1000000), (unsigned long)(clocks.apb1_hz / 1000000),
+                     (unsigned long)(clocks.apb2_hz / 1000000),
+                     (unsigned long)(s_load_permille / 10), (unsigned long)(s_load_permille % 10),
+                     (unsigned)(CLOCK_GOVERNOR_DOWN_PERMILLE / 10), (unsigned)(CLOCK_GOVERNOR_DOWN_PERMILLE % 10),
+                     (unsigned)(CLOCK_GOVERNOR_UP_PERMILLE / 10), (unsigned)(CLOCK_GOVERNOR_UP_PERMILLE % 10),
+                     (unsigned long)s_switches, (unsigned long)s_switch_failures,
+                     (unsigned long)(share[0] / 10), (unsigned long)(share[0] % 10),
+                     (unsigned long)(share[1] / 10), (unsigned long)(share[1] % 10),
+                     (unsigned long)(share[2] / 10), (unsigned long)(share[2] % 10));
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
@@ -0,0 +1,371 @@
+/**
+ * @file      console.c
+ * @brief     Command shell on the UART bus, with audio and profiling commands.
+ */
+
+#include "console.h"
+#include "uart_bus.h"
+#include "audio_config.h"
+#include "audio_io.h"
+#include "runtime_stats.h"
+#include "app_objects.h"
+#include "low_power.h"
+#include "motion.h"
+#include "telemetry_link.h"
+#include "presets.h"
+#include "kvstore.h"
+#include "dsp_profile.h"
+#include "clock_governor.h"
+#include "event_sched.h"
+#include "flash.h"
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_CLI.h"
+#include "FreeRTOS_Shell.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/** @brief Report formatter, as exported by the application modules. */
+typedef size_t (*console_report_fn)(char* p_buffer, size_t len);
+
+static BaseType_t cmd_effect(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_param(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_blocksize(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_xruns(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_show(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_telemetry(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_preset(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_art(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_clock(char* p_buffer, size_t len, const char* p_command);
+static BaseType_t cmd_event(char* p_buffer, size_t len, const char* p_command);
+
+// --- Static Data ---
+static const console_audio_t* s_audio;
+
+static const ConsoleIO_t s_io = {
+    .pxRead = uart_bus_read_timeout,
+    .pxWrite = uart_bus_write,
+};
+
+static const char* const s_report_names[] = {
+    "tasks", "objects", "audio", "power", "motion", "telemetry", "presets", "dsp", "clock", "events",
+};
+static const console_report_fn s_report_formats[] = {
+    runtime_stats_format, app_objects_format, audio_io_format, low_power_format, motion_report, telemetry_link_format,
+    presets_format, dsp_profile_format, clock_governor_format, event_sched_format,
+};
+_Static_assert(sizeof(s_report_names) / sizeof(s_report_names[0]) ==
+               sizeof(s_report_formats) / sizeof(s_report_formats[0]), "one name per report");
+
+static const char* const s_switch_names[] = {"off", "on"};
+static const char* const s_preset_actions[] = {"save", "load"};
+static const char* const s_art_features[] = {"prefetch", "icache", "dcache", "all"};
+static const uint32_t s_art_flags[] = {FLASH_ACCEL_PREFETCH, FLASH_ACCEL_ICACHE, FLASH_ACCEL_DCACHE, FLASH_ACCEL_ALL};
+static const char* const s_clock_modes[] = {"auto", "84", "120", "168"}; // Indexed by clock_governor_mode_t
+
+static const CLI_Command_Definition_t s_commands[] = {
+    {"effect", "\r\neffect [name|number]:\r\n Lists the effects, or selects one\r\n", cmd_effect, -1},
+    {"param", "\r\nparam [p1 p2 | auto]:\r\n Shows the effect parameters, holds them at p1 p2 (0..1),"
+              " or returns them to the motion control\r\n", cmd_param, -1},
+    {"blocksize", "\r\nblocksize:\r\n Shows the audio block size and its latency\r\n", cmd_blocksize, 0},
+    {"xruns", "\r\nxruns:\r\n Shows the audio overrun/underrun count\r\n", cmd_xruns, 0},
+    {"show", "\r\nshow <tasks|objects|audio|power|motion|telemetry|presets|dsp|clock|events>:\r\n"
+             " Prints a profiling report\r\n", cmd_show, 1},
+    {"telemetry", "\r\ntelemetry <on|off>:\r\n Starts or stops the binary telemetry stream on this UART\r\n",
+     cmd_telemetry, 1},
+    {"preset", "\r\npreset [save|load <slot>]:\r\n Lists the presets, saves the effect and parameters to a slot,"
+               " or loads a slot and holds its parameters; slot 0 is loaded at power-on\r\n", cmd_preset, -1},
+    {"art", "\r\nart [prefetch|icache|dcache|all <on|off>]:\r\n Shows or switches the flash accelerator;"
+            " restarts the 'show dsp' counts\r\n", cmd_art, -1},
+    {"clock", "\r\nclock [auto|84|120|168]:\r\n Shows the CPU clock, or lets the governor scale it with the"
+              " DSP load, or fixes it in MHz\r\n", cmd_clock, -1},
+    {"event", "\r\nevent <lfo|param1|param2> <ms> [value]:\r\n Schedules a control event ms from now;"
+              " the DSP applies it on that exact sample\r\n", cmd_event, -1},
+};
+
+// Report being streamed by "show", formatted once on the first call
+static char s_report[CONSOLE_REPORT_BYTES];
+static size_t s_report_len;
+static size_t s_report_pos;
+static bool s_is_streaming = false;
+
+// --- Private Helper Functions ---
+
+/** @brief Thousandths of a parameter in [0, 1], so reports need no float printf. */
+static unsigned long to_milli(float value) {
+    return (unsigned long)(value * 1000.0f + 0.5f);
+}
+
+/** @brief Copies the next piece of the report; pdTRUE while more follows. */
+static BaseType_t stream_report(char* p_buffer, size_t len) {
+    size_t n = s_report_len - s_report_pos;
+    if (n > len - 1) {
+        n = len - 1;
+    }
+    memcpy(p_buffer, &s_report[s_report_pos], n);
+    p_buffer[n] = '\0';
+    s_report_pos += n;
+    if (s_report_pos < s_report_len) {
+        return pdTRUE;
+    }
+    s_is_streaming = false;
+    return pdFALSE;
+}
+
+static BaseType_t cmd_effect(char* p_buffer, size_t len, const char* p_command) {
+    BaseType_t word_len;
+
+    if (FreeRTOS_CLIGetParameter(p_command, 1, &word_len) == NULL) {
+        // List, marking the current effect
+        uint32_t current = s_audio->get_effect();
+        size_t pos = 0;
+        for (uint32_t i = 0; i < s_audio->effect_count && pos < len; ++i) {
+            int n = snprintf(&p_buffer[pos], len - pos, "%c %lu %s\r\n", (i == current) ? '*' : ' ',
+                             (unsigned long)i, s_audio->p_effect_names[i]);
+            if (n < 0) {
+                break;
+            }
+            pos += (size_t)n;
+        }
+        return pdFALSE;
+    }
+
+    // By name or by number
+    UBaseType_t effect;
+    int32_t number;
+    if (FreeRTOS_CLIGetEnum(p_command, 1, s_audio->p_effect_names, s_audio->effect_count, &effect) != pdPASS) {
+        if (FreeRTOS_CLIGetInt(p_command, 1, 0, (int32_t)s_audio->effect_count - 1, &number) != pdPASS) {
+            snprintf(p_buffer, len, "Unknown effect; enter 'effect' for the list\r\n");
+            return pdFALSE;
+        }
+        effect = (UBaseType_t)number;
+    }
+    s_audio->set_effect((uint32_t)effect);
+    snprintf(p_buffer, len, "Effect: %s\r\n", s_audio->p_effect_names[effect]);
+    return pdFALSE;
+}
+
+static BaseType_t cmd_param(char* p_buffer, size_t len, const char* p_command) {
+    static const char* const auto_name[] = {"auto"};
+    BaseType_t word_len;
+    UBaseType_t choice;
+    float param1, param2;
+
+    if (FreeRTOS_CLIGetParameter(p_command, 1, &word_len) == NULL) {
+        bool is_held = s_audio->get_params(&param1, &param2);
+        unsigned long milli1 = to_milli(param1);
+        unsigned long milli2 = to_milli(param2);
+        snprintf(p_buffer, len, "param1 %lu.%03lu  param2 %lu.%03lu  (%s)\r\n", milli1 / 1000, milli1 % 1000,
+                 milli2 / 1000, milli2 % 1000, is_held ? "held" : "motion");
+        return pdFALSE;
+    }
+    if (FreeRTOS_CLIGetEnum(p_command, 1, auto_name, 1, &choice) == pdPASS) {
+        s_audio->release_params();
+        snprintf(p_buffer, len, "Parameters follow the motion control\r\n");
+        return pdFALSE;
+    }
+    if (FreeRTOS_CLIGetFloat(p_command, 1, 0.0f, 1.0f, &param1) != pdPASS ||
+        FreeRTOS_CLIGetFloat(p_command, 2, 0.0f, 1.0f, &param2) != pdPASS) {
+        snprintf(p_buffer, len, "Usage: param <p1> <p2> with values 0..1, or param auto\r\n");
+        return pdFALSE;
+    }
+    s_audio->hold_params(param1, param2);
+    snprintf(p_buffer, len, "Parameters held\r\n");
+    return pdFALSE;
+}
+
+static BaseType_t cmd_blocksize(char* p_buffer, size_t len, const char* p_command) {
+    (void)p_command;
+    // Fixed at build time: the DMA buffers, stream buffers and stacks are sized from it
+    uint32_t block_us = (uint32_t)((uint64_t)AUDIO_BLOCK_FRAMES * 1000000u / AUDIO_SAMPLING_RATE);
+    snprintf(p_buffer, len,
+             "Block: %u frames x %u channels at %lu Hz = %lu.%02lu ms\r\n"
+             "Set at build time with AUDIO_BLOCK_SAMPLES (audio_config.h)\r\n",
+             (unsigned)AUDIO_BLOCK_FRAMES, (unsigned)AUDIO_CHANNELS, (unsigned long)AUDIO_SAMPLING_RATE,
+             (unsigned long)(block_us / 1000), (unsigned long)((block_us % 1000) / 10));
+    return pdFALSE;
+}
+
+static BaseType_t cmd_xruns(char* p_buffer, size_t len, const char* p_command) {
+    (void)p_command;
+    audio_io_stats_t stats;
+    audio_io_get_stats(&stats);
+    snprintf(p_buffer, len, "XRUNs: %lu in %lu blocks\r\n", (unsigned long)s_audio->get_xruns(),
+             (unsigned long)stats.rx_blocks);
+    return pdFALSE;
+}
+
+static BaseType_t cmd_show(char* p_buffer, size_t len, const char* p_command) {
+    if (s_is_streaming) {
+        return stream_report(p_buffer, len);
+    }
+
+    UBaseType_t report;
+    if (FreeRTOS_CLIGetEnum(p_command, 1, s_report_names, sizeof(s_report_names) / sizeof(s_report_names[0]),
+                            &report) != pdPASS) {
+        snprintf(p_buffer, len, "Usage: show <tasks|objects|audio|power|motion|telemetry|presets|dsp|clock|events>\r\n");
+        return pdFALSE;
+    }
+
+    s_report_len = s_report_formats[report](s_report, sizeof(s_report));
+    s_report_pos = 0;
+    s_is_streaming = true;
+    return stream_report(p_buffer, len);
+}
+
+static BaseType_t cmd_telemetry(char* p_buffer, size_t len, const char* p_command) {
+    UBaseType_t enable;
+    if (FreeRTOS_CLIGetEnum(p_command, 1, s_switch_names, 2, &enable) != pdPASS) {
+        snprintf(p_buffer, len, "Usage: telemetry <on|off>\r\n");
+        return pdFALSE;
+    }
+    telemetry_link_set_enabled(enable != 0);
+    snprintf(p_buffer, len, "Telemetry %s\r\n", telemetry_link_is_enabled() ? "on" : "off");
+    return pdFALSE;
+}
+
+static BaseType_t cmd_preset(char* p_buffer, size_t len, const char* p_command) {
+    BaseType_t word_len;
+    preset_t preset;
+
+    if (FreeRTOS_CLIGetParameter(p_command, 1, &word_len) == NULL) {
+        // List the slots, empty ones included
+        size_t pos = 0;
+        for (uint32_t slot = 0; slot < PRESETS_SLOTS && pos < len; ++slot) {
+            int n;
+            if (presets_load(slot, &preset) == 0 && preset.effect < s_audio->effect_count) {
+                unsigned long milli1 = to_milli(preset.param1);
+                unsigned long milli2 = to_milli(preset.param2);
+                n = snprintf(&p_buffer[pos], len - pos, "%lu %-8s %lu.%03lu %lu.%03lu\r\n", (unsigned long)slot,
+                             s_audio->p_effect_names[preset.effect], milli1 / 1000, milli1 % 1000, milli2 / 1000,
+                             milli2 % 1000);
+            } else {
+                n = snprintf(&p_buffer[pos], len - pos, "%lu -\r\n", (unsigned long)slot);
+            }
+            if (n < 0) {
+                break;
+            }
+            pos += (size_t)n;
+        }
+        return pdFALSE;
+    }
+
+    UBaseType_t action;
+    int32_t slot;
+    if (FreeRTOS_CLIGetEnum(p_command, 1, s_preset_actions, 2, &action) != pdPASS ||
+        FreeRTOS_CLIGetInt(p_command, 2, 0, PRESETS_SLOTS - 1, &slot) != pdPASS) {
+        snprintf(p_buffer, len, "Usage: preset [save|load <0..%u>]\r\n", (unsigned)(PRESETS_SLOTS - 1));
+        return pdFALSE;
+    }
+
+    if (action == 0) {
+        memset(&preset, 0, sizeof(preset));
+        preset.effect = (uint8_t)s_audio->get_effect();
+        s_audio->get_params(&preset.param1, &preset.param2);
+        int ret = presets_save((uint32_t)slot, &preset);
+        if (ret == PRESETS_ERR_STREAMING) {
+            snprintf(p_buffer, len, "Could not save to slot %ld: the store is full and is only "
+                     "compacted at power-on, as erasing flash would stop the audio\r\n", (long)slot);
+        } else {
+            snprintf(p_buffer, len, "%s slot %ld\r\n", (ret == 0) ? "Saved to" : "Could not save to", (long)slot);
+        }
+        return pdFALSE;
+    }
+
+    int ret = presets_load((uint32_t)slot, &preset);
+    if (ret == KVSTORE_ERR_NOT_FOUND) {
+        snprintf(p_buffer, len, "Slot %ld is empty\r\n", (long)slot);
+    } else if (ret != 0 || preset.effect >= s_audio->effect_count) {
+        snprintf(p_buffer, len, "Slot %ld could not be read\r\n", (long)slot);
+    } else {
+        s_audio->set_effect(preset.effect);
+        s_audio->hold_params(preset.param1, preset.param2);
+        snprintf(p_buffer, len, "Loaded slot %ld: %s, parameters held\r\n", (long)slot,
+                 s_audio->p_effect_names[preset.effect]);
+    }
+    return pdFALSE;
+}
+
+static BaseType_t cmd_art(char* p_buffer, size_t len, const char* p_command) {
+    BaseType_t word_len;
+    UBaseType_t feature;
+    UBaseType_t enable;
+    uint32_t features = dsp_profile_get_accelerator();
+
+    if (FreeRTOS_CLIGetParameter(p_command, 1, &word_len) != NULL) {
+        if (FreeRTOS_CLIGetEnum(p_command, 1, s_art_features, 4, &feature) != pdPASS ||
+            FreeRTOS_CLIGetEnum(p_command, 2, s_switch_names, 2, &enable) != pdPASS) {
+            snprintf(p_buffer, len, "Usage: art [prefetch|icache|dcache|all <on|off>]\r\n");
+            return pdFALSE;
+        }
+        features = enable ? (features | s_art_flags[feature]) : (features & ~s_art_flags[feature]);
+        if (!dsp_profile_set_accelerator(features)) {
+            snprintf(p_buffer, len, "Could not configure the accelerator\r\n");
+            return pdFALSE;
+        }
+    }
+    snprintf(p_buffer, len, "ART: prefetch %s  icache %s  dcache %s\r\n",
+             s_switch_names[(features & FLASH_ACCEL_PREFETCH) != 0], s_switch_names[(features & FLASH_ACCEL_ICACHE) != 0],
+             s_switch_names[(features & FLASH_ACCEL_DCACHE) != 0]);
+    return pdFALSE;
+}
+
+static BaseType_t cmd_clock(char* p_buffer, size_t len, const char* p_command) {
+    BaseType_t word_len;
+    UBaseType_t mode;
+
+    if (FreeRTOS_CLIGetParameter(p_command, 1, &word_len) != NULL) {
+        if (FreeRTOS_CLIGetEnum(p_command, 1, s_clock_modes, 4, &mode) != pdPASS) {
+            snprintf(p_buffer, len, "Usage: clock [auto|84|120|168]\r\n");
+            return pdFALSE;
+        }
+        clock_governor_set_mode((clock_governor_mode_t)mode);
+        snprintf(p_buffer, len, "Clock %s%s from the next evaluation\r\n",
+                 (mode == CLOCK_GOVERNOR_AUTO) ? "scaled automatically" : "fixed at ",
+                 (mode == CLOCK_GOVERNOR_AUTO) ? "" : s_clock_modes[mode]);
+        return pdFALSE;
+    }
+    clock_governor_format(p_buffer, len);
+    return pdFALSE;
+}
+
+static BaseType_t cmd_event(char* p_buffer, size_t len, const char* p_command) {
+    UBaseType_t event;
+    int32_t delay_ms;
+    float value = 0.0f;
+    BaseType_t word_len;
+
+    if (FreeRTOS_CLIGetEnum(p_command, 1, s_audio->p_event_names, s_audio->event_count, &event) != pdPASS ||
+        FreeRTOS_CLIGetInt(p_command, 2, 0, 60000, &delay_ms) != pdPASS ||
+        (FreeRTOS_CLIGetParameter(p_command, 3, &word_len) != NULL &&
+         FreeRTOS_CLIGetFloat(p_command, 3, 0.0f, 1.0f, &value) != pdPASS)) {
+        snprintf(p_buffer, len, "Usage: event <lfo|param1|param2> <0..60000 ms> [value 0..1]\r\n");
+        return pdFALSE;
+    }
+    if (!s_audio->schedule_event((uint32_t)event, value, (uint32_t)delay_ms)) {
+        snprintf(p_buffer, len, "Event queue full; see 'show events'\r\n");
+        return pdFALSE;
+    }
+    snprintf(p_buffer, len, "Scheduled %s in %ld ms\r\n", s_audio->p_event_names[event], (long)delay_ms);
+    return pdFALSE;
+}
+
+// --- Public API Function Implementations ---
+
+bool console_init(const console_audio_t* p_audio) {
+    if (p_audio == NULL || uart_bus_get_handle() == NULL) {
+        return false;
+    }
+    s_audio = p_audio;
+
+    if (xConsoleInit(&s_io) != pdPASS) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(s_commands) / sizeof(s_commands[0]); ++i) {
+        if (FreeRTOS_CLIRegisterCommand(&s_commands[i]) != pdPASS) {
+            return false;
+        }
+    }
+    return true;
+}
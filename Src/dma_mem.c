@@ -0,0 +1,302 @@
+/**
+ * @file      dma_mem.c
+ * @brief     Asynchronous memcpy/memset service on a DMA2 memory-to-memory stream.
+ */
+
+#include "dma_mem.h"
+#include "dma.h"
+#include "nvic.h"
+#include "trace_recorder.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <string.h>
+
+/* --- CCM RAM, which is not connected to the DMA controllers --- */
+#define CCMRAM_START            0x10000000UL
+#define CCMRAM_END              0x10010000UL
+
+#define DMA_MAX_ITEMS           0xFFFFUL    // NDTR is 16 bits wide
+#define DMA_BURST_BEATS         4           // INCR4 fits a full FIFO at every data size
+
+_Static_assert(DMA_MEM_IRQ_PRIORITY >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY,
+               "DMA_MEM_IRQ_PRIORITY must allow FreeRTOS FromISR calls");
+_Static_assert(DMA_MEM_NOTIFY_INDEX < configTASK_NOTIFICATION_ARRAY_ENTRIES,
+               "DMA_MEM_NOTIFY_INDEX needs a task notification array entry");
+
+/**
+ * @brief One queued operation. The last operation of a chain carries its callback.
+ */
+typedef struct {
+    dma_mem_op_t op;
+    dma_mem_callback_t callback;
+    void* p_context;
+    uint32_t ticket;
+    bool chain_last;
+} dma_mem_slot_t;
+
+// --- Static Data ---
+static dma_handle_t s_dma = NULL;
+static dma_config_t s_config;                   // Configuration currently programmed
+
+static dma_mem_slot_t s_queue[DMA_MEM_QUEUE_LENGTH];
+static uint32_t s_head = 0;                     // Operation in progress or next to run
+static uint32_t s_count = 0;
+
+// Progress of the operation at s_head
+static bool s_busy = false;
+static bool s_op_started = false;
+static uintptr_t s_src = 0;
+static uintptr_t s_dst = 0;
+static size_t s_remaining = 0;
+static size_t s_segment_bytes = 0;
+static uint32_t s_pattern = 0;                  // Fill source, read with a fixed address
+
+static uint32_t s_next_ticket = 0;
+static volatile uint32_t s_done_ticket = 0;
+static dma_mem_stats_t s_stats;
+
+// --- Private Helper Functions ---
+
+static bool is_dma_reachable(const void* p, size_t bytes) {
+    uintptr_t start = (uintptr_t)p;
+    uintptr_t end = start + bytes;
+    return end > start && (end <= CCMRAM_START || start >= CCMRAM_END);
+}
+
+static bool is_op_valid(const dma_mem_op_t* p_op) {
+    if (p_op->bytes == 0 || !is_dma_reachable(p_op->dst, p_op->bytes)) {
+        return false;
+    }
+    if (p_op->kind == DMA_MEM_OP_SET) {
+        return true;
+    }
+    return p_op->kind == DMA_MEM_OP_COPY && is_dma_reachable(p_op->src, p_op->bytes);
+}
+
+/**
+ * @brief Chooses the data size, burst and length of the next segment.
+ * @details Uses the widest data size both addresses are aligned to, and INCR4
+ *          bursts only when the addresses are burst-aligned, which also keeps
+ *          every burst inside a 1 KB boundary.
+ */
+static size_t plan_segment(bool is_set, dma_config_t* p_config) {
+    uintptr_t alignment = is_set ? s_dst : (s_dst | s_src);
+    dma_data_size_t size = DMA_DATA_SIZE_8_BIT;
+    if ((alignment & 3) == 0 && s_remaining >= 4) {
+        size = DMA_DATA_SIZE_32_BIT;
+    } else if ((alignment & 1) == 0 && s_remaining >= 2) {
+        size = DMA_DATA_SIZE_16_BIT;
+    }
+
+    size_t width = (size_t)1 << size;
+    size_t burst_bytes = width * DMA_BURST_BEATS;
+    bool burst = (alignment & (burst_bytes - 1)) == 0 && s_remaining >= burst_bytes;
+
+    size_t bytes = (s_remaining < DMA_MAX_ITEMS * width) ? s_remaining : DMA_MAX_ITEMS * width;
+    bytes &= ~((burst ? burst_bytes : width) - 1);
+
+    p_config->peripheral_data_size = size;
+    p_config->memory_data_size = size;
+    p_config->peripheral_increment = !is_set;
+    p_config->memory_burst = burst ? DMA_BURST_INCR4 : DMA_BURST_SINGLE;
+    p_config->peripheral_burst = (burst && !is_set) ? DMA_BURST_INCR4 : DMA_BURST_SINGLE;
+    return bytes;
+}
+
+/**
+ * @brief Starts the next segment of the current operation, or the next operation.
+ * @note  Runs in the DMA interrupt or inside a critical section.
+ */
+static void start_next(void) {
+    if (s_count == 0) {
+        s_busy = false;
+        return;
+    }
+
+    const dma_mem_slot_t* p_slot = &s_queue[s_head];
+    bool is_set = (p_slot->op.kind == DMA_MEM_OP_SET);
+    if (!s_op_started) {
+        s_op_started = true;
+        s_dst = (uintptr_t)p_slot->op.dst;
+        s_src = is_set ? (uintptr_t)&s_pattern : (uintptr_t)p_slot->op.src;
+        s_remaining = p_slot->op.bytes;
+        s_pattern = 0x01010101UL * p_slot->op.value;
+    }
+
+    dma_config_t config = s_config;
+    s_segment_bytes = plan_segment(is_set, &config);
+    if (memcmp(&config, &s_config, sizeof(config)) != 0) {
+        s_config = config;
+        dma_reconfigure(s_dma, &s_config);
+        dma_enable_interrupt(s_dma, DMA_INTERRUPT_TRANSFER_COMPLETE);
+        dma_enable_interrupt(s_dma, DMA_INTERRUPT_TRANSFER_ERROR);
+    }
+
+    // Memory-to-memory counts items of the source (peripheral port) size
+    s_busy = true;
+    dma_start_transfer(s_dma, (const void*)s_src, (void*)s_dst,
+                       (uint16_t)(s_segment_bytes >> s_config.peripheral_data_size));
+}
+
+/** @brief Removes the operation at the head; runs the callback if it ends a chain. */
+static void finish_op(bool success) {
+    dma_mem_slot_t slot = s_queue[s_head];
+    s_head = (s_head + 1) % DMA_MEM_QUEUE_LENGTH;
+    s_count--;
+    s_op_started = false;
+
+    if (slot.chain_last) {
+        s_done_ticket = slot.ticket;
+        if (success) {
+            s_stats.completed++;
+        }
+        if (slot.callback) {
+            slot.callback(slot.p_context, success);
+        }
+    }
+}
+
+/** @brief Drops the rest of the chain at the head after a transfer error. */
+static void abort_chain(void) {
+    s_stats.errors++;
+    while (s_count > 0) {
+        bool last = s_queue[s_head].chain_last;
+        finish_op(false);
+        if (last) {
+            break;
+        }
+    }
+}
+
+// --- Interrupt Handler ---
+
+void DMA_MEM_IRQ_HANDLER(void) {
+    trace_isr_enter(DMA_MEM_IRQN);
+
+    bool error = dma_is_interrupt_flag_set(s_dma, DMA_INTERRUPT_TRANSFER_ERROR);
+    bool complete = dma_is_interrupt_flag_set(s_dma, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    dma_clear_interrupt_flag(s_dma, DMA_INTERRUPT_TRANSFER_ERROR);
+    dma_clear_interrupt_flag(s_dma, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    dma_clear_interrupt_flag(s_dma, DMA_INTERRUPT_FIFO_ERROR);
+
+    if (s_busy && (error || complete)) {
+        if (error) {
+            dma_stop_transfer(s_dma);
+            abort_chain();
+        } else {
+            s_stats.bytes += s_segment_bytes;
+            s_remaining -= s_segment_bytes;
+            s_dst += s_segment_bytes;
+            if (s_src != (uintptr_t)&s_pattern) {
+                s_src += s_segment_bytes;
+            }
+            if (s_remaining == 0) {
+                finish_op(true);
+            }
+        }
+        start_next();
+    }
+
+    trace_isr_exit(DMA_MEM_IRQN);
+}
+
+// --- Public API Function Implementations ---
+
+bool dma_mem_init(void) {
+    const dma_config_t config = {
+        .channel = 0,
+        .direction = DMA_DIRECTION_MEMORY_TO_MEMORY,
+        .priority = DMA_PRIORITY_LOW,       // Yield the bus matrix to the audio streams
+        .peripheral_data_size = DMA_DATA_SIZE_8_BIT,
+        .memory_data_size = DMA_DATA_SIZE_8_BIT,
+        .peripheral_increment = true,
+        .memory_increment = true,
+        .fifo_mode = true,
+        .fifo_threshold = DMA_FIFO_THRESHOLD_FULL,
+    };
+
+    s_dma = dma_init(2, DMA_MEM_STREAM, &config);
+    if (s_dma == NULL) {
+        return false;
+    }
+    s_config = config;
+    dma_enable_interrupt(s_dma, DMA_INTERRUPT_TRANSFER_COMPLETE);
+    dma_enable_interrupt(s_dma, DMA_INTERRUPT_TRANSFER_ERROR);
+
+    NVIC_IPR(DMA_MEM_IRQN) = (uint8_t)(DMA_MEM_IRQ_PRIORITY << (8 - configPRIO_BITS));
+    NVIC_ISER(DMA_MEM_IRQN / 32) = (1UL << (DMA_MEM_IRQN % 32));
+    return true;
+}
+
+uint32_t dma_mem_submit(const dma_mem_op_t* p_ops, size_t count, dma_mem_callback_t callback, void* p_context) {
+    if (s_dma == NULL || p_ops == NULL || count == 0) {
+        return 0;
+    }
+    bool valid = true;
+    for (size_t i = 0; i < count && valid; ++i) {
+        valid = is_op_valid(&p_ops[i]);
+    }
+
+    uint32_t ticket = 0;
+    taskENTER_CRITICAL();
+    if (valid && s_count + count <= DMA_MEM_QUEUE_LENGTH) {
+        ticket = ++s_next_ticket;
+        if (ticket == 0) {
+            ticket = ++s_next_ticket;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            dma_mem_slot_t* p_slot = &s_queue[(s_head + s_count) % DMA_MEM_QUEUE_LENGTH];
+            p_slot->op = p_ops[i];
+            p_slot->chain_last = (i == count - 1);
+            p_slot->callback = p_slot->chain_last ? callback : NULL;
+            p_slot->p_context = p_context;
+            p_slot->ticket = ticket;
+            s_count++;
+        }
+        if (s_count > s_stats.queue_peak) {
+            s_stats.queue_peak = s_count;
+        }
+        if (!s_busy) {
+            start_next();
+        }
+    } else {
+        s_stats.rejected++;
+    }
+    taskEXIT_CRITICAL();
+
+    return ticket;
+}
+
+uint32_t dma_mem_copy(void* dst, const void* src, size_t bytes, dma_mem_callback_t callback, void* p_context) {
+    const dma_mem_op_t op = {.kind = DMA_MEM_OP_COPY, .dst = dst, .src = src, .bytes = bytes};
+    return dma_mem_submit(&op, 1, callback, p_context);
+}
+
+uint32_t dma_mem_set(void* dst, uint8_t value, size_t bytes, dma_mem_callback_t callback, void* p_context) {
+    const dma_mem_op_t op = {.kind = DMA_MEM_OP_SET, .dst = dst, .value = value, .bytes = bytes};
+    return dma_mem_submit(&op, 1, callback, p_context);
+}
+
+bool dma_mem_is_done(uint32_t ticket) {
+    return ticket != 0 && (int32_t)(s_done_ticket - ticket) >= 0;
+}
+
+void dma_mem_notify_task(void* p_context, bool success) {
+    (void)success;
+    BaseType_t woken = pdFALSE;
+    if (p_context != NULL) {
+        vTaskNotifyGiveIndexedFromISR((TaskHandle_t)p_context, DMA_MEM_NOTIFY_INDEX, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+void dma_mem_get_stats(dma_mem_stats_t* p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    *p_stats = s_stats;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,139 @@
+/**
+ * @file      dsp_profile.c
+ * @brief     DSP cycles per block under each flash accelerator setting.
+ */
+
+#include "dsp_profile.h"
+#include "audio_config.h"
+#include "common.h"
+#include "flash.h"
+
+#include "FreeRTOS.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+/* CPU cycles in one block period, the budget a block must fit in */
+#define BLOCK_PERIOD_CYCLES     ((uint64_t)configCPU_CLOCK_HZ * AUDIO_BLOCK_FRAMES / AUDIO_SAMPLING_RATE)
+
+typedef struct {
+    uint64_t cycles;
+    uint32_t blocks;
+    uint32_t cycles_max;
+} dsp_profile_effect_t;
+
+/* Code copied to SRAM at startup, from the linker script */
+extern uint8_t _sramfunc[];
+extern uint8_t _eramfunc[];
+
+// --- Static Data ---
+static flash_handle_t s_flash = NULL;
+static const char* const* s_effect_names;
+static uint32_t s_effect_count;
+
+static uint32_t s_block_start;
+static dsp_profile_effect_t s_effects[DSP_PROFILE_MAX_EFFECTS];
+static volatile uint32_t s_window_peak;     // Longest block since dsp_profile_take_peak_load()
+
+// Set by the console, cleared by dspTask, which owns the counts
+static volatile bool s_is_reset_pending = false;
+
+// --- Public API Function Implementations ---
+
+bool dsp_profile_init(const char* const* p_effect_names, uint32_t effect_count) {
+    s_flash = flash_init();
+    if (s_flash == NULL) {
+        return false;
+    }
+    s_effect_names = p_effect_names;
+    s_effect_count = (effect_count < DSP_PROFILE_MAX_EFFECTS) ? effect_count : DSP_PROFILE_MAX_EFFECTS;
+    memset(s_effects, 0, sizeof(s_effects));
+    return flash_set_accelerator(s_flash, FLASH_ACCEL_ALL) == 0;
+}
+
+void dsp_profile_block_begin(void) {
+    s_block_start = DWT_CYCCNT;
+}
+
+void dsp_profile_block_end(uint32_t effect) {
+    uint32_t cycles = DWT_CYCCNT - s_block_start;
+
+    if (s_is_reset_pending) {
+        memset(s_effects, 0, sizeof(s_effects));
+        s_window_peak = 0;
+        s_is_reset_pending = false;
+        return;     // The block straddled the switch
+    }
+    if (cycles > s_window_peak) {
+        s_window_peak = cycles;
+    }
+    if (effect >= DSP_PROFILE_MAX_EFFECTS) {
+        return;
+    }
+    dsp_profile_effect_t* p_effect = &s_effects[effect];
+    p_effect->cycles += cycles;
+    p_effect->blocks++;
+    if (cycles > p_effect->cycles_max) {
+        p_effect->cycles_max = cycles;
+    }
+}
+
+bool dsp_profile_set_accelerator(uint32_t features) {
+    if (flash_set_accelerator(s_flash, features) != 0) {
+        return false;
+    }
+    s_is_reset_pending = true;
+    return true;
+}
+
+uint32_t dsp_profile_get_accelerator(void) {
+    return flash_get_accelerator(s_flash);
+}
+
+void dsp_profile_reset(void) {
+    s_is_reset_pending = true;
+}
+
+uint32_t dsp_profile_take_peak_load(void) {
+    // A block ending between the two accesses is lost; the next window has it
+    uint32_t peak = s_window_peak;
+    s_window_peak = 0;
+    return (uint32_t)(((uint64_t)peak * 1000ULL) / BLOCK_PERIOD_CYCLES);
+}
+
+size_t dsp_profile_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    uint32_t features = dsp_profile_get_accelerator();
+    int n = snprintf(p_buffer, len,
+                     "Kernels in %s (%lu bytes in SRAM)  ART: prefetch %s  icache %s  dcache %s\r\n"
+                     "Effect     Blocks  Cycles/block      Max  Load%%\r\n",
+                     (AUDIO_DSP_IN_RAM == 1) ? "SRAM" : "flash", (unsigned long)(_eramfunc - _sramfunc),
+                     (features & FLASH_ACCEL_PREFETCH) ? "on" : "off",
+                     (features & FLASH_ACCEL_ICACHE) ? "on" : "off",
+                     (features & FLASH_ACCEL_DCACHE) ? "on" : "off");
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    size_t pos = ((size_t)n < len) ? (size_t)n : len - 1;
+
+    for (uint32_t i = 0; i < s_effect_count && pos < len - 1; ++i) {
+        dsp_profile_effect_t effect = s_effects[i];
+        uint32_t average = (effect.blocks > 0) ? (uint32_t)(effect.cycles / effect.blocks) : 0;
+        uint32_t load_permille = (uint32_t)(((uint64_t)average * 1000ULL) / BLOCK_PERIOD_CYCLES);
+        n = snprintf(&p_buffer[pos], len - pos, "%-9s %7lu  %12lu  %7lu  %3lu.%lu\r\n", s_effect_names[i],
+                     (unsigned long)effect.blocks, (unsigned long)average, (unsigned long)effect.cycles_max,
+                     (unsigned long)(load_permille / 10), (unsigned long)(load_permille % 10));
+        if (n < 0) {
+            break;
+        }
+        pos += ((size_t)n < len - pos) ? (size_t)n : len - pos - 1;
+    }
+    return pos;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file      event_bench.c
+ * @brief     Control event scheduler benchmark: timing accuracy and cost on target.
+ */
+
+#include "event_bench.h"
+#include "audio_config.h"
+#include "common.h"
+#include "ctrl.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+#define BENCH_HORIZON_FRAMES    (EVENT_BENCH_HORIZON_BLOCKS * AUDIO_BLOCK_FRAMES)
+#define BENCH_START_SAMPLE      (0U - 64U * AUDIO_BLOCK_FRAMES)       // Wraps after 64 blocks
+
+typedef struct {
+    uint32_t count;
+    uint64_t cycles;
+    uint32_t cycles_max;
+} bench_timing_t;
+
+/** @brief An event as removed, kept for checking after the timed section. */
+typedef struct {
+    uint32_t sample;
+    uint32_t seq;
+    uint32_t frame;                 // Frame of the block it was applied before
+} bench_applied_t;
+
+typedef struct {
+    bench_timing_t insert;
+    bench_timing_t block;
+    uint32_t applied;
+    uint32_t misplaced;             // Applied on another frame than their own
+    uint32_t misordered;            // Out of frame or posting order
+    uint32_t events_per_block_max;
+} bench_result_t;
+
+// --- Static Data ---
+static ctrl_event_t s_storage[EVENT_BENCH_CAPACITY];
+static ctrl_event_heap_t s_heap;
+static uint32_t s_rng;
+static bench_applied_t s_applied[EVENT_BENCH_CAPACITY];   // At most the whole heap is due in one block
+
+// --- Private Helper Functions ---
+
+/** @brief xorshift32: reproducible event positions. */
+static uint32_t next_random(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static void add_timing(bench_timing_t* p_timing, uint32_t cycles) {
+    p_timing->count++;
+    p_timing->cycles += cycles;
+    if (cycles > p_timing->cycles_max) {
+        p_timing->cycles_max = cycles;
+    }
+}
+
+static uint32_t average(const bench_timing_t* p_timing) {
+    return (p_timing->count > 0) ? (uint32_t)(p_timing->cycles / p_timing->count) : 0;
+}
+
+/** @brief Tops the heap up with events in the horizon, as producers would. */
+static void post_events(uint32_t block_sample, uint32_t* p_posted, bench_result_t* p_result) {
+    while (*p_posted < EVENT_BENCH_EVENTS && s_heap.count < EVENT_BENCH_CAPACITY) {
+        // Coarse positions, so that many events share a frame
+        ctrl_event_t event = {
+            .sample = block_sample + (next_random() % (BENCH_HORIZON_FRAMES / 4)) * 4,
+            .id = (uint16_t)*p_posted,
+        };
+
+        vTaskSuspendAll();
+        uint32_t start = DWT_CYCCNT;
+        taskENTER_CRITICAL();
+        (void)ctrl_event_heap_push(&s_heap, &event);
+        taskEXIT_CRITICAL();
+        add_timing(&p_result->insert, DWT_CYCCNT - start);
+        (void)xTaskResumeAll();
+
+        (*p_posted)++;
+    }
+}
+
+/** @brief Splits one block at its events like dsp_process_block(), checking each. */
+static void run_block(uint32_t block_sample, bench_applied_t* p_last, bench_result_t* p_result) {
+    uint32_t count = 0;
+    uint32_t frame = 0;
+
+    vTaskSuspendAll();
+    uint32_t start = DWT_CYCCNT;
+    while (frame < AUDIO_BLOCK_FRAMES) {
+        for (;;) {
+            ctrl_event_t event;
+            taskENTER_CRITICAL();
+            bool found = ctrl_event_heap_pop_due(&s_heap, block_sample + frame, &event);
+            taskEXIT_CRITICAL();
+            if (!found) {
+                break;
+            }
+            s_applied[count].sample = event.sample;
+            s_applied[count].seq = event.seq;
+            s_applied[count].frame = frame;
+            count++;
+        }
+
+        uint32_t sample;
+        taskENTER_CRITICAL();
+        bool any = ctrl_event_heap_peek(&s_heap, &sample);
+        taskEXIT_CRITICAL();
+        int32_t offset = any ? (int32_t)(sample - block_sample) : AUDIO_BLOCK_FRAMES;
+        frame = (offset > (int32_t)frame && offset < AUDIO_BLOCK_FRAMES) ? (uint32_t)offset : AUDIO_BLOCK_FRAMES;
+    }
+    add_timing(&p_result->block, DWT_CYCCNT - start);
+    (void)xTaskResumeAll();
+
+    // Outside the timed section: each event on its own frame, in order
+    for (uint32_t i = 0; i < count; ++i) {
+        const bench_applied_t* event = &s_applied[i];
+        if (event->sample != block_sample + event->frame) {
+            p_result->misplaced++;
+        }
+        if (p_result->applied + i > 0) {
+            int32_t diff = (int32_t)(event->sample - p_last->sample);
+            if (diff < 0 || (diff == 0 && (int32_t)(event->seq - p_last->seq) < 0)) {
+                p_result->misordered++;
+            }
+        }
+        *p_last = *event;
+    }
+    p_result->applied += count;
+    if (count > p_result->events_per_block_max) {
+        p_result->events_per_block_max = count;
+    }
+}
+
+// --- Public API Function Implementations ---
+
+size_t event_bench_run(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    bench_result_t result = {0};
+    bench_applied_t last = {0};
+    uint32_t posted = 0;
+    uint32_t block_sample = BENCH_START_SAMPLE;
+
+    ctrl_event_heap_init(&s_heap, s_storage, EVENT_BENCH_CAPACITY);
+    s_rng = 0x2545F491UL;
+
+    while (result.applied < posted || posted < EVENT_BENCH_EVENTS) {
+        post_events(block_sample, &posted, &result);
+        run_block(block_sample, &last, &result);
+        block_sample += AUDIO_BLOCK_FRAMES;
+    }
+
+    // Cycles per event removed, in hundredths, and the block overhead against the block period
+    uint32_t centi_per_event = (result.applied > 0) ?
+                               (uint32_t)((result.block.cycles * 100ULL) / result.applied) : 0;
+    uint32_t period_cycles = (uint32_t)((uint64_t)configCPU_CLOCK_HZ * AUDIO_BLOCK_FRAMES / AUDIO_SAMPLING_RATE);
+    uint32_t max_permille = (uint32_t)(((uint64_t)result.block.cycles_max * 1000ULL) / period_cycles);
+
+    int n = snprintf(p_buffer, len,
+                     "%lu events through a heap of %u, spread over %u blocks of %u frames ahead\r\n"
+                     "Accuracy: %lu applied, %lu off their frame, %lu out of order\r\n"
+                     "Insert: avg %lu  max %lu cycles\r\n"
+                     "Per block: avg %lu  max %lu cycles (%lu.%lu%% of the block), up to %lu events\r\n"
+                     "Per event removed: %lu.%02lu cycles\r\n",
+                     (unsigned long)posted, (unsigned)EVENT_BENCH_CAPACITY, (unsigned)EVENT_BENCH_HORIZON_BLOCKS,
+                     (unsigned)AUDIO_BLOCK_FRAMES,
+                     (unsigned long)result.applied, (unsigned long)result.misplaced,
+                     (unsigned long)result.misordered,
+                     (unsigned long)average(&result.insert), (unsigned long)result.insert.cycles_max,
+                     (unsigned long)average(&result.block), (unsigned long)result.block.cycles_max,
+                     (unsigned long)(max_permille / 10), (unsigned long)(max_permille % 10),
+                     (unsigned long)result.events_per_block_max,
+                     (unsigned long)(centi_per_event / 100), (unsigned long)(centi_per_event % 100));
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
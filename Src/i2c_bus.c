@@ -0,0 +1,252 @@
+/**
+ * @file      i2c_bus.c
+ * @brief     FreeRTOS blocking wrapper and benchmark for asynchronous I2C transactions.
+ */
+
+#include "i2c_bus.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+#define SPIN_CALIBRATION_LOOPS  10000UL
+#define BENCH_MAX_BYTES         32
+
+_Static_assert(I2C_BUS_NOTIFY_INDEX < configTASK_NOTIFICATION_ARRAY_ENTRIES,
+               "I2C_BUS_NOTIFY_INDEX needs a task notification array entry");
+
+/**
+ * @brief Completion state shared with the callback, on the waiting task's stack.
+ */
+typedef struct {
+    TaskHandle_t task;
+    volatile int status;
+    volatile bool done;
+} i2c_bus_waiter_t;
+
+/**
+ * @brief Totals of one benchmark method.
+ */
+typedef struct {
+    uint64_t wall_cycles;
+    uint64_t cpu_cycles;
+    uint32_t failures;
+} bench_totals_t;
+
+// --- Static Data ---
+static uint8_t s_bench_rx[BENCH_MAX_BYTES];
+// Static, so a transaction that outlives the benchmark's spin limit stays valid
+static i2c_bus_waiter_t s_bench_waiter;
+static i2c_transaction_t s_bench_txn;
+static uint8_t s_bench_reg;
+
+// --- Private Helper Functions ---
+
+static void notify_waiter(void* p_context, int status) {
+    i2c_bus_waiter_t* p_waiter = (i2c_bus_waiter_t*)p_context;
+
+    p_waiter->status = status;
+    p_waiter->done = true;
+    if (p_waiter->task == NULL) {
+        return;
+    }
+
+    // i2c_abort() completes from the task that called it
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(p_waiter->task, I2C_BUS_NOTIFY_INDEX, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        (void)xTaskNotifyGiveIndexed(p_waiter->task, I2C_BUS_NOTIFY_INDEX);
+    }
+}
+
+/** @brief Spins until *p_done, returning the number of iterations. */
+static uint32_t spin_until(volatile bool* p_done, uint32_t limit) {
+    uint32_t loops = 0;
+    while (!*p_done && loops < limit) {
+        loops++;
+    }
+    return loops;
+}
+
+/** @brief Appends one result row; returns the new offset. */
+static size_t append_row(char* p_buffer, size_t len, size_t offset, const char* label,
+                         const bench_totals_t* p_totals, bool has_cpu) {
+    if (offset >= len - 1) {
+        return offset;
+    }
+
+    uint32_t wall = (uint32_t)(p_totals->wall_cycles / I2C_BUS_BENCH_RUNS);
+    uint32_t wall_us = (uint32_t)(((uint64_t)wall * 1000000ULL) / configCPU_CLOCK_HZ);
+    char cpu[16];
+    if (has_cpu) {
+        uint32_t cycles = (uint32_t)(p_totals->cpu_cycles / I2C_BUS_BENCH_RUNS);
+        uint32_t permille = (wall != 0) ? (uint32_t)(((uint64_t)cycles * 1000ULL) / wall) : 0;
+        snprintf(cpu, sizeof(cpu), "%lu %3lu.%lu%%", (unsigned long)cycles,
+                 (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+    } else {
+        snprintf(cpu, sizeof(cpu), "-");
+    }
+
+    int n = snprintf(&p_buffer[offset], len - offset, "%-10s %10lu %7lu %18s %5lu\r\n",
+                     label, (unsigned long)wall, (unsigned long)wall_us, cpu, (unsigned long)p_totals->failures);
+    if (n < 0) {
+        return offset;
+    }
+    return offset + (((size_t)n < len - offset) ? (size_t)n : (len - offset - 1));
+}
+
+// --- Public API Function Implementations ---
+
+int i2c_bus_transfer(i2c_handle_t handle, uint8_t slave_addr, const uint8_t* p_write, size_t write_len,
+                     uint8_t* p_read, size_t read_len) {
+    i2c_bus_waiter_t waiter = {
+        .task = xTaskGetCurrentTaskHandle(),
+        .status = I2C_ERROR_TIMEOUT,
+        .done = false,
+    };
+    i2c_transaction_t txn = {
+        .slave_addr = slave_addr,
+        .p_write = p_write,
+        .write_len = write_len,
+        .p_read = p_read,
+        .read_len = read_len,
+        .callback = notify_waiter,
+        .p_context = &waiter,
+    };
+
+    // Discard a notification left over from an earlier, unrelated give
+    (void)ulTaskNotifyTakeIndexed(I2C_BUS_NOTIFY_INDEX, pdTRUE, 0);
+
+    int status = i2c_transfer_async(handle, &txn);
+    if (status != I2C_OK) {
+        return status;
+    }
+
+    const TickType_t timeout = pdMS_TO_TICKS(I2C_BUS_TIMEOUT_MS) + 1;
+    TickType_t start = xTaskGetTickCount();
+    while (!waiter.done) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            // Completes the transaction before returning unless it just finished;
+            // either way the descriptor is released by the driver afterwards
+            (void)i2c_abort(handle, &txn);
+            break;
+        }
+        (void)ulTaskNotifyTakeIndexed(I2C_BUS_NOTIFY_INDEX, pdTRUE, timeout - elapsed);
+    }
+    return waiter.status;
+}
+
+int i2c_bus_read_reg(i2c_handle_t handle, uint8_t slave_addr, uint8_t reg, uint8_t* p_data, size_t len) {
+    return i2c_bus_transfer(handle, slave_addr, &reg, 1, p_data, len);
+}
+
+int i2c_bus_write_reg(i2c_handle_t handle, uint8_t slave_addr, uint8_t reg, const uint8_t* p_data, size_t len) {
+    uint8_t frame[1 + I2C_BUS_MAX_WRITE];
+    if (len > I2C_BUS_MAX_WRITE || (len != 0 && p_data == NULL)) {
+        return I2C_ERROR_ARGUMENT;
+    }
+    frame[0] = reg;
+    if (len != 0) {
+        memcpy(&frame[1], p_data, len);
+    }
+    return i2c_bus_transfer(handle, slave_addr, frame, 1 + len, NULL, 0);
+}
+
+size_t i2c_bus_benchmark(i2c_handle_t handle, uint8_t slave_addr, uint8_t reg, size_t len,
+                         char* p_buffer, size_t buffer_len) {
+    if (p_buffer == NULL || buffer_len == 0) {
+        return 0;
+    }
+    if (len == 0 || len > BENCH_MAX_BYTES || i2c_is_busy(handle)) {
+        int n = snprintf(p_buffer, buffer_len, "I2C bus busy or invalid length\r\n");
+        return (n < 0) ? 0 : (((size_t)n < buffer_len) ? (size_t)n : buffer_len - 1);
+    }
+
+    bench_totals_t blocking = {0};
+    bench_totals_t async = {0};
+    bench_totals_t notify = {0};
+    s_bench_reg = reg;
+
+    // Calibrate the spin loop while nothing else is running
+    volatile bool never = false;
+    vTaskSuspendAll();
+    uint32_t start = DWT_CYCCNT;
+    (void)spin_until(&never, SPIN_CALIBRATION_LOOPS);
+    uint32_t spin_cycles = DWT_CYCCNT - start;
+    (void)xTaskResumeAll();
+
+    for (int run = 0; run < I2C_BUS_BENCH_RUNS; ++run) {
+        // Blocking: two transfers, the CPU busy for both
+        vTaskSuspendAll();
+        start = DWT_CYCCNT;
+        int status = i2c_master_write_blocking(handle, slave_addr, &s_bench_reg, 1);
+        if (status == 0) {
+            status = i2c_master_read_blocking(handle, slave_addr, s_bench_rx, len);
+        }
+        uint32_t blocking_cycles = DWT_CYCCNT - start;
+        (void)xTaskResumeAll();
+        blocking.wall_cycles += blocking_cycles;
+        blocking.cpu_cycles += blocking_cycles;
+        blocking.failures += (status != 0);
+
+        // Asynchronous: spin until completion; the iterations lost are the CPU
+        // cost. Give up after ten times the blocking duration.
+        s_bench_waiter = (i2c_bus_waiter_t){.task = NULL, .status = I2C_ERROR_TIMEOUT, .done = false};
+        s_bench_txn = (i2c_transaction_t){
+            .slave_addr = slave_addr,
+            .p_write = &s_bench_reg,
+            .write_len = 1,
+            .p_read = s_bench_rx,
+            .read_len = len,
+            .callback = notify_waiter,
+            .p_context = &s_bench_waiter,
+        };
+        uint64_t limit = ((uint64_t)blocking_cycles * 10 * SPIN_CALIBRATION_LOOPS) / (spin_cycles ? spin_cycles : 1);
+        vTaskSuspendAll();
+        start = DWT_CYCCNT;
+        status = i2c_transfer_async(handle, &s_bench_txn);
+        uint32_t loops = 0;
+        if (status == I2C_OK) {
+            loops = spin_until(&s_bench_waiter.done, (limit < UINT32_MAX) ? (uint32_t)limit : UINT32_MAX);
+        }
+        uint32_t async_cycles = DWT_CYCCNT - start;
+        (void)xTaskResumeAll();
+        if (status == I2C_OK && !s_bench_waiter.done) {
+            (void)i2c_abort(handle, &s_bench_txn);
+        }
+        uint64_t spun = ((uint64_t)loops * spin_cycles) / SPIN_CALIBRATION_LOOPS;
+        async.wall_cycles += async_cycles;
+        async.cpu_cycles += (spun < async_cycles) ? (async_cycles - spun) : 0;
+        async.failures += (status != I2C_OK || s_bench_waiter.status != I2C_OK);
+
+        // Task sleeping on the notification: latency including the wake-up
+        start = DWT_CYCCNT;
+        status = i2c_bus_read_reg(handle, slave_addr, reg, s_bench_rx, len);
+        notify.wall_cycles += DWT_CYCCNT - start;
+        notify.failures += (status != I2C_OK);
+    }
+
+    int n = snprintf(p_buffer, buffer_len,
+                     "I2C read of %u bytes from 0x%02X reg 0x%02X, mean of %u\r\n"
+                     "%-10s %10s %7s %18s %5s\r\n",
+                     (unsigned)len, (unsigned)slave_addr, (unsigned)reg, (unsigned)I2C_BUS_BENCH_RUNS,
+                     "Method", "cycles", "us", "CPU cycles", "fail");
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    size_t offset = ((size_t)n < buffer_len) ? (size_t)n : buffer_len - 1;
+    offset = append_row(p_buffer, buffer_len, offset, "blocking", &blocking, true);
+    offset = append_row(p_buffer, buffer_len, offset, "async", &async, true);
+    offset = append_row(p_buffer, buffer_len, offset, "notify", &notify, false);
+    return offset;
+}
@@ -0,0 +1,329 @@
+/**
+ * @file      low_power.c
+ * @brief     Audio-aware low-power policy for the FreeRTOS tickless idle.
+ */
+
+#include "low_power.h"
+#include "runtime_stats.h"
+#include "common.h"
+#include "dma.h"
+#include "pwr.h"
+#include "rtc.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* --- SysTick current value, read to see how far the port's own count got --- */
+#define SYST_CVR                MMIO32(SYS_TICK_BASE + 0x08)
+
+/* RTC prescalers for the 32 kHz LSI: 4 kHz sub-second counter, 1 Hz calendar */
+#define LOW_POWER_RTC_ASYNC_PRESCALER   7
+#define LOW_POWER_RTC_SYNC_PRESCALER    3999
+
+#define SECONDS_PER_DAY         86400UL
+
+typedef enum {
+    LOW_POWER_STATE_RUN = 0,
+    LOW_POWER_STATE_SLEEP,
+    LOW_POWER_STATE_STOP,
+} low_power_state_t;
+
+// --- Static Data ---
+static pwr_handle_t s_pwr = NULL;
+static rtc_handle_t s_rtc = NULL;
+static void (*s_restore_clocks)(void) = NULL;
+static volatile uint32_t s_stop_locks = 0;
+
+static low_power_state_t s_state = LOW_POWER_STATE_RUN;
+static uint32_t s_sleep_start = 0;      // Stats clock when WFI was entered
+static uint32_t s_last_counter = 0;     // Stats clock at the last accounting update
+static uint32_t s_stop_ticks = 0;       // Kernel ticks spent in the last STOP period
+static uint32_t s_stop_residue = 0;     // STOP time short of a kernel tick, in RTC ticks times configTICK_RATE_HZ * 1000
+
+// Accounting in stats clock ticks; the stats clock does not run in STOP
+static uint64_t s_awake_counts = 0;
+static uint64_t s_sleep_counts = 0;
+static low_power_stats_t s_stats;
+
+// RTC sub-second clock calibration against the stats clock
+static uint32_t s_rtc_mhz = 0;          // Measured sub-second rate in mHz, 0 until calibrated
+static uint32_t s_rtc_nominal_hz = 0;
+static uint32_t s_cal_rtc_ref = 0;
+static uint32_t s_cal_counter_ref = 0;
+static bool s_cal_ref_valid = false;
+
+// --- Private Helper Functions ---
+
+static uint64_t counts_to_us(uint64_t counts) {
+    return (counts * 1000000ULL) / RUNTIME_STATS_COUNTER_HZ;
+}
+
+static uint32_t rtc_elapsed(uint32_t from, uint32_t to) {
+    if (to >= from) {
+        return to - from;
+    }
+    return to + (s_rtc_nominal_hz * SECONDS_PER_DAY) - from; // Midnight wrap
+}
+
+static void update_awake_time(void) {
+    uint32_t now = runtime_stats_get_counter();
+    s_awake_counts += now - s_last_counter;
+    s_last_counter = now;
+}
+
+/**
+ * @brief Measures the LSI-driven RTC against the stats clock while awake.
+ * @details The LSI is only accurate to a few percent, which would make every
+ *          STOP period lose or gain kernel time. Runs at most once per
+ *          calibration period and costs two RTC shadow-register syncs.
+ */
+static void calibrate_rtc(void) {
+    uint32_t now = runtime_stats_get_counter();
+
+    if (!s_cal_ref_valid) {
+        s_cal_rtc_ref = rtc_get_subsecond_ticks(s_rtc);
+        s_cal_counter_ref = runtime_stats_get_counter();
+        s_cal_ref_valid = true;
+        return;
+    }
+
+    uint32_t counts = now - s_cal_counter_ref;
+    if (counts < (RUNTIME_STATS_COUNTER_HZ / 1000UL) * LOW_POWER_CALIBRATION_PERIOD_MS) {
+        return;
+    }
+
+    uint32_t rtc_now = rtc_get_subsecond_ticks(s_rtc);
+    now = runtime_stats_get_counter();
+    counts = now - s_cal_counter_ref;
+    // In mHz: whole Hz of a 4 kHz clock would be 250 ppm steps of kernel time in STOP
+    uint32_t mhz = (uint32_t)(((uint64_t)rtc_elapsed(s_cal_rtc_ref, rtc_now) * RUNTIME_STATS_COUNTER_HZ * 1000ULL) / counts);
+
+    // Reject readings outside the LSI datasheet range (17-47 kHz for 32 kHz nominal)
+    if (mhz > (s_rtc_nominal_hz * 1000UL / 2) && mhz < (s_rtc_nominal_hz * 1000UL * 3 / 2)) {
+        s_rtc_mhz = mhz;
+    }
+    s_cal_rtc_ref = rtc_now;
+    s_cal_counter_ref = now;
+}
+
+/**
+ * @brief Spends the idle period in STOP mode.
+ * @return true if STOP was entered, false if the caller should fall back to WFI.
+ */
+static bool enter_stop(uint32_t expected_idle_ticks) {
+    // Wake early enough to restart the clocks before the next kernel deadline
+    uint32_t wakeup_hz = (uint32_t)(((uint64_t)rtc_get_wakeup_clock_hz(s_rtc) * s_rtc_mhz) / (s_rtc_nominal_hz * 1000ULL));
+    uint64_t idle_us = ((uint64_t)(expected_idle_ticks - 1) * 1000000ULL) / configTICK_RATE_HZ;
+    if (idle_us <= LOW_POWER_STOP_EXIT_US) {
+        return false;
+    }
+    uint64_t wakeup_ticks = ((idle_us - LOW_POWER_STOP_EXIT_US) * wakeup_hz) / 1000000ULL;
+    if (wakeup_ticks == 0) {
+        return false;
+    }
+    if (wakeup_ticks > 0x10000ULL) {
+        wakeup_ticks = 0x10000ULL;
+    }
+
+    (void)rtc_clear_wakeup_flag(s_rtc);
+    if (rtc_start_wakeup_timer(s_rtc, (uint32_t)wakeup_ticks) != 0) {
+        return false;
+    }
+
+    update_awake_time();
+    uint32_t rtc_start = rtc_get_subsecond_ticks(s_rtc);
+
+    pwr_enter_stop_mode(s_pwr);
+
+    // The core resumes on HSI; the PLL must be back before anything else runs
+    if (s_restore_clocks != NULL) {
+        s_restore_clocks();
+    }
+
+    uint32_t stopped = rtc_elapsed(rtc_start, rtc_get_subsecond_ticks(s_rtc));
+    rtc_stop_wakeup_timer(s_rtc);
+    if (rtc_clear_wakeup_flag(s_rtc)) {
+        s_stats.stop_timer_wakeups++;
+    }
+
+    // Whole ticks only: the remainder is carried to the next STOP, or every
+    // period would leave the kernel half a tick behind on average
+    uint64_t unstepped = (uint64_t)stopped * configTICK_RATE_HZ * 1000ULL + s_stop_residue;
+    s_stop_ticks = (uint32_t)(unstepped / s_rtc_mhz);
+    s_stop_residue = (uint32_t)(unstepped % s_rtc_mhz);
+    s_stats.stop_us += ((uint64_t)stopped * 1000000000ULL) / s_rtc_mhz;
+    s_stats.stop_count++;
+
+    // The stats clock was frozen as well, so restart the awake accounting
+    // and the calibration window from here
+    s_last_counter = runtime_stats_get_counter();
+    s_cal_ref_valid = false;
+    return true;
+}
+
+/**
+ * @brief Moves the kernel tick count forward by the time spent in STOP.
+ * @details SysTick was frozen during STOP, so the port only accounts for the
+ *          time it actually counted. The step is bounded so the port's own
+ *          step still leaves the tick count at or before the next unblock time.
+ */
+static void step_tick_after_stop(uint32_t expected_idle_ticks) {
+    uint32_t counts_per_tick = configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+    uint32_t counted = (expected_idle_ticks * counts_per_tick) - SYST_CVR;
+    uint32_t port_ticks = counted / counts_per_tick;
+
+    // One tick of margin for SysTick crossing a boundary before the port reads it
+    if (expected_idle_ticks <= port_ticks + 1) {
+        return;
+    }
+    uint32_t max_step = expected_idle_ticks - port_ticks - 1;
+    uint32_t step = (s_stop_ticks < max_step) ? s_stop_ticks : max_step;
+    if (step > 0) {
+        vTaskStepTick(step);
+    }
+}
+
+// --- Public API Function Implementations ---
+
+bool low_power_init(void (*restore_clocks)(void)) {
+    rtc_config_t rtc_config = {
+        .sync_prescaler = LOW_POWER_RTC_SYNC_PRESCALER,
+        .async_prescaler = LOW_POWER_RTC_ASYNC_PRESCALER,
+    };
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_restore_clocks = restore_clocks;
+    s_pwr = pwr_init();
+    s_rtc = rtc_init(&rtc_config);
+    if (s_pwr == NULL || s_rtc == NULL) {
+        s_rtc = NULL;
+        return false;
+    }
+
+    s_rtc_nominal_hz = rtc_get_subsecond_hz(s_rtc);
+    return s_rtc_nominal_hz != 0;
+}
+
+void low_power_stop_lock(void) {
+    UBaseType_t saved = portSET_INTERRUPT_MASK_FROM_ISR();
+    s_stop_locks++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+void low_power_stop_unlock(void) {
+    UBaseType_t saved = portSET_INTERRUPT_MASK_FROM_ISR();
+    if (s_stop_locks > 0) {
+        s_stop_locks--;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+void low_power_pre_sleep(uint32_t* p_expected_idle_ticks) {
+    uint32_t expected = *p_expected_idle_ticks;
+
+    if (LOW_POWER_STOP_ENABLE && s_rtc != NULL) {
+        calibrate_rtc();
+
+        if (expected >= LOW_POWER_STOP_MIN_IDLE_TICKS) {
+            // An enabled DMA stream means audio (or another transfer) is in
+            // flight; its clocks must keep running, so only WFI is allowed
+            if (dma_is_any_stream_active()) {
+                s_stats.stop_dma_vetoes++;
+            } else if (s_stop_locks > 0) {
+                s_stats.stop_lock_vetoes++;
+            } else if (s_rtc_mhz != 0 && enter_stop(expected)) {
+                s_state = LOW_POWER_STATE_STOP;
+                *p_expected_idle_ticks = 0; // Already slept, skip the port's WFI
+                return;
+            }
+        }
+    }
+
+    s_state = LOW_POWER_STATE_SLEEP;
+    s_sleep_start = runtime_stats_get_counter();
+    s_stats.sleep_count++;
+}
+
+void low_power_post_sleep(uint32_t expected_idle_ticks) {
+    if (s_state == LOW_POWER_STATE_STOP) {
+        step_tick_after_stop(expected_idle_ticks);
+    } else if (s_state == LOW_POWER_STATE_SLEEP) {
+        s_sleep_counts += runtime_stats_get_counter() - s_sleep_start;
+    }
+    s_state = LOW_POWER_STATE_RUN;
+    update_awake_time();
+}
+
+void low_power_get_stats(low_power_stats_t* p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+
+    UBaseType_t saved = portSET_INTERRUPT_MASK_FROM_ISR();
+    update_awake_time();
+    *p_stats = s_stats;
+    uint64_t awake_us = counts_to_us(s_awake_counts);
+    p_stats->sleep_us = counts_to_us(s_sleep_counts);
+    p_stats->run_us = (awake_us > p_stats->sleep_us) ? (awake_us - p_stats->sleep_us) : 0;
+    p_stats->lsi_hz = (uint32_t)(((uint64_t)s_rtc_mhz * (LOW_POWER_RTC_ASYNC_PRESCALER + 1)) / 1000ULL);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+void low_power_reset_stats(void) {
+    UBaseType_t saved = portSET_INTERRUPT_MASK_FROM_ISR();
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_awake_counts = 0;
+    s_sleep_counts = 0;
+    s_last_counter = runtime_stats_get_counter();
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+size_t low_power_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    low_power_stats_t stats;
+    low_power_get_stats(&stats);
+
+    uint64_t total_us = stats.run_us + stats.sleep_us + stats.stop_us;
+    uint64_t total_ms = total_us / 1000ULL;
+    uint32_t wakeups = stats.sleep_count + stats.stop_count;
+    uint32_t wakeups_per_s = (total_ms > 0) ? (uint32_t)(((uint64_t)wakeups * 1000ULL) / total_ms) : 0;
+
+    // Charge in microamp-milliseconds, then average current and energy
+    uint64_t charge = (stats.run_us / 1000ULL) * LOW_POWER_RUN_CURRENT_UA +
+                      (stats.sleep_us / 1000ULL) * LOW_POWER_SLEEP_CURRENT_UA +
+                      (stats.stop_us / 1000ULL) * LOW_POWER_STOP_CURRENT_UA;
+    uint32_t avg_ua = (total_ms > 0) ? (uint32_t)(charge / total_ms) : 0;
+    uint64_t energy_uj = (charge * LOW_POWER_SUPPLY_MV) / 1000000ULL;
+
+    uint32_t pm_run = (total_us > 0) ? (uint32_t)((stats.run_us * 1000ULL) / total_us) : 0;
+    uint32_t pm_sleep = (total_us > 0) ? (uint32_t)((stats.sleep_us * 1000ULL) / total_us) : 0;
+    uint32_t pm_stop = (total_us > 0) ? (uint32_t)((stats.stop_us * 1000ULL) / total_us) : 0;
+
+    int n = snprintf(p_buffer, len,
+                     "State   Time(ms)    Share%%  Entries\r\n"
+                     "run    %9lu  %5lu.%lu\r\n"
+                     "sleep  %9lu  %5lu.%lu  %7lu\r\n"
+                     "stop   %9lu  %5lu.%lu  %7lu\r\n"
+                     "Wakeups/s: %lu  STOP on timer: %lu  vetoed dma: %lu lock: %lu\r\n"
+                     "Est. current: %lu uA  energy: %lu.%03lu mJ  LSI: %lu Hz\r\n",
+                     (unsigned long)(stats.run_us / 1000ULL), (unsigned long)(pm_run / 10), (unsigned long)(pm_run % 10),
+                     (unsigned long)(stats.sleep_us / 1000ULL), (unsigned long)(pm_sleep / 10), (unsigned long)(pm_sleep % 10),
+                     (unsigned long)stats.sleep_count,
+                     (unsigned long)(stats.stop_us / 1000ULL), (unsigned long)(pm_stop / 10), (unsigned long)(pm_stop % 10),
+                     (unsigned long)stats.stop_count,
+                     (unsigned long)wakeups_per_s, (unsigned long)stats.stop_timer_wakeups,
+                     (unsigned long)stats.stop_dma_vetoes, (unsigned long)stats.stop_lock_vetoes,
+                     (unsigned long)avg_ua, (unsigned long)(energy_uj / 1000ULL), (unsigned long)(energy_uj % 1000ULL),
+                     (unsigned long)stats.lsi_hz);
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
@@ -24,10 +24,33 @@
 #include <stdint.h>
 #include <math.h>
 
+#include "runtime_stats.h"
+#include "trace_recorder.h"
+#include "low_power.h"
+#include "audio_config.h"
+#include "app_objects.h"
+#include "dma_mem.h"
+#include "audio_io.h"
+#include "spi.h"
+#include "lis3dsh.h"
+#include "motion.h"
+#include "ctrl.h"
+#include "uart.h"
+#include "uart_bus.h"
+#include "telemetry_link.h"
+#include "console.h"
+#include "presets.h"
+#include "dsp_profile.h"
+#include "clock_governor.h"
+#include "event_sched.h"
+#include "rcc.h"
+#if (AUDIO_ASRC_ENABLE == 1)
+#include "asrc.h"
+#endif
+
 // NOTE: You will need to add the driver files for your specific
-// audio codec and accelerometer to your project and include them here.
+// audio codec to your project and include them here.
 // #include "cs43l22.h"
-// #include "lis3dsh.h"
 
 /* USER CODE END Includes */
 
@@ -49,19 +72,46 @@ typedef struct {
     float param2; // e.g., Echo Feedback, Flanger LFO Depth
 } DspParams;
 
+// Control events applied by dspTask at their exact sample (event_sched.h)
+typedef enum {
+    DSP_EVENT_LFO_RESET = 0,    // Restart the LFO at phase 0, e.g. on a tap
+    DSP_EVENT_PARAM1,           // Hold param1 at the event's value
+    DSP_EVENT_PARAM2,           // Hold param2 at the event's value
+    DSP_EVENT_COUNT
+} DspEvent;
+
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 
-// --- Audio Buffer Configuration ---
-#define AUDIO_SAMPLING_RATE   48000
-#define AUDIO_BLOCK_SAMPLES   256  // Number of int16_t samples in one processing block
-#define AUDIO_BLOCK_BYTES     (AUDIO_BLOCK_SAMPLES * sizeof(int16_t))
-#define DMA_BUFFER_SIZE       (AUDIO_BLOCK_SAMPLES * 2) // Double buffer size
-
-// --- DSP State Variables ---
-#define DELAY_BUFFER_SIZE   (AUDIO_SAMPLING_RATE * 2) // 2 seconds max delay for echo
+// Audio buffer sizing lives in audio_config.h, shared with the object table
+
+// Effect parameter mappings, 0..1 in; each is ramped per sample over a block
+#define ECHO_DELAY_SEC(p)       (0.02f + (p) * 0.14f)     // 20ms to 160ms, within the delay line
+#define ECHO_FEEDBACK(p)        ((p) * 0.85f)             // 0 to 85% feedback
+#define FLANGER_RATE_HZ(p)      (0.1f + (p) * 4.9f)
+#define FLANGER_DEPTH_SEC(p)    (0.001f + (p) * 0.005f)   // 1ms to 6ms sweep
+#define TREMOLO_RATE_HZ(p)      (1.0f + (p) * 9.0f)
+#define TREMOLO_DEPTH(p)        (p)
+
+// A parameter event ramps to its value from its own sample over this many frames
+#define DSP_EVENT_RAMP_FRAMES   32                        // ~0.7ms, short of a click
+#define DSP_EVENT_RAMP_SAMPLES  (DSP_EVENT_RAMP_FRAMES * AUDIO_CHANNELS)
+
+// LIS3DSH on the Discovery board: SPI1, chip select on PE3, INT1 on PE0 (EXTI line 0)
+#define ACCEL_SPI_INSTANCE    1
+#define ACCEL_CS_PORT         4
+#define ACCEL_CS_PIN          3
+#define ACCEL_INT1_PORT       4
+#define ACCEL_INT1_PIN        0
+#define ACCEL_ODR             LIS3DSH_ODR_1600_HZ
+#define ACCEL_WATERMARK       16      // Samples per FIFO drain: 100 drains/s at 1600 Hz
+#define ACCEL_TIMEOUT_MS      100     // Longest wait for a block before checking again
+
+// Console and telemetry link: USART1 (PA9 TX, PA10 RX), DMA-driven
+#define CONSOLE_UART_INSTANCE 1
+#define CONSOLE_BAUD_RATE     2000000
 
 /* USER CODE END PD */
 
@@ -74,23 +124,71 @@ typedef struct {
 /* USER CODE BEGIN PV */
 // --- Hardware Handles (Generated by CubeMX) ---
 I2C_HandleTypeDef hi2c1;
-I2S_HandleTypeDef hi2s2;
-I2S_HandleTypeDef hi2s3;
-SPI_HandleTypeDef hspi1;
 
-// --- DMA Buffers (managed by HAL/DMA driver) ---
-int16_t dma_input_buffer;
-int16_t dma_output_buffer;
+// --- DMA Buffers (streamed by the I2S driver, see audio_io.h) ---
+int16_t dma_input_buffer[DMA_BUFFER_SIZE];
+int16_t dma_output_buffer[DMA_BUFFER_SIZE];
+
+/* TX half most recently freed by the output DMA, written by audio_tx_free() */
+static volatile uint32_t s_tx_free_half = 1;
+
+#if (AUDIO_ASRC_ENABLE == 1)
+/* Resampler between the capture and playback clocks, used by dspTask only */
+static asrc_t s_asrc;
+#endif
 
 // --- DSP State Variables (internal to dspTask) ---
-int16_t delay_buffer = {0};
+int16_t delay_buffer[DELAY_BUFFER_SIZE] = {0};
+_Static_assert(sizeof(delay_buffer) <= DELAY_BUFFER_RAM_BUDGET, "delay line exceeds DELAY_BUFFER_RAM_BUDGET");
 uint32_t delay_write_index = 0;
 float lfo_phase = 0.0f;
 
+// --- Parameter ramps (internal to dspTask): times and rates exponential, amounts linear ---
+// Retargeted once per block from g_dspParams, and at its exact sample by a parameter event
+static ctrl_ramp_t s_echo_delay_ramp;
+static ctrl_ramp_t s_echo_feedback_ramp;
+static ctrl_ramp_t s_flanger_rate_ramp;
+static ctrl_ramp_t s_flanger_depth_ramp;
+static ctrl_ramp_t s_tremolo_rate_ramp;
+static ctrl_ramp_t s_tremolo_depth_ramp;
+
+// Parameters set by events in this block, published to g_dspParams at the next one
+static DspParams s_event_params;
+static uint32_t s_event_params_pending = 0;     // Bit n: param n + 1
+
+// --- Accelerometer block handed from the drain interrupt to sensorTask ---
+static const lis3dsh_sample_t* volatile s_accel_samples;
+static volatile size_t s_accel_count;
+
 // --- Global Application State ---
 DspParams g_dspParams;
 volatile EffectType g_currentEffect = EFFECT_BYPASS;
 
+/* Effect chosen by uiTask or the console; dspTask switches to it between blocks */
+static volatile EffectType s_selected_effect = EFFECT_BYPASS;
+
+/* Delay line clear in flight, owned by dspTask; 0 when none */
+static uint32_t s_clear_ticket = 0;
+
+/* Set while the console holds the parameters; sensorTask leaves them alone */
+static volatile bool s_params_held = false;
+
+/* Blocks the audio path dropped or repeated, counted alongside the XRUN trace events */
+static volatile uint32_t s_xrun_count = 0;
+
+static const char* const s_effect_names[EFFECT_COUNT] = {
+  [EFFECT_BYPASS] = "bypass",
+  [EFFECT_ECHO] = "echo",
+  [EFFECT_FLANGER] = "flanger",
+  [EFFECT_TREMOLO] = "tremolo",
+};
+
+static const char* const s_event_names[DSP_EVENT_COUNT] = {
+  [DSP_EVENT_LFO_RESET] = "lfo",
+  [DSP_EVENT_PARAM1] = "param1",
+  [DSP_EVENT_PARAM2] = "param2",
+};
+
 /* ---------- CHANGED: FreeRTOS handle types ---------- */
 /* USER CODE END PV */
 
@@ -98,9 +196,6 @@ volatile EffectType g_currentEffect = EFFECT_BYPASS;
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
 static void MX_I2C1_Init(void);
-static void MX_I2S2_Init(void);
-static void MX_I2S3_Init(void);
-static void MX_SPI1_Init(void);
 /* USER CODE BEGIN PFP */
 void audioInputTask(void *argument);
 void audioOutputTask(void *argument);
@@ -111,21 +206,45 @@ void uiTask(void *argument);
 void process_echo(int16_t* input, int16_t* output, uint32_t block_size);
 void process_flanger(int16_t* input, int16_t* output, uint32_t block_size);
 void process_tremolo(int16_t* input, int16_t* output, uint32_t block_size);
+static void dsp_process_block(int16_t* input, int16_t* output);
+static void dsp_process_segment(int16_t* input, int16_t* output, uint32_t samples);
+static void dsp_apply_event(const ctrl_event_t* p_event);
+static void dsp_ramps_init(void);
+static void dsp_ramp_to(ctrl_ramp_t* p_ramp, float target, uint32_t samples);
+static void dsp_update_params(void);
+static void dsp_update_effect(void);
+static void audio_xrun(uint32_t half);
+static void effect_select(EffectType effect);
+static void effect_show(EffectType effect);
+static void presets_restore(void);
+static uint32_t console_get_effect(void);
+static void console_set_effect(uint32_t effect);
+static bool console_get_params(float* p_param1, float* p_param2);
+static void console_hold_params(float param1, float param2);
+static void console_release_params(void);
+static uint32_t console_get_xruns(void);
+static bool console_schedule_event(uint32_t event, float value, uint32_t delay_ms);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
-/* ---------- CHANGED: FreeRTOS-specific handles ---------- */
-TaskHandle_t audioInputTaskHandle;
-TaskHandle_t audioOutputTaskHandle;
-TaskHandle_t dspTaskHandle;
-TaskHandle_t sensorTaskHandle;
-TaskHandle_t uiTaskHandle;
-
-StreamBufferHandle_t rawAudioStreamHandle;
-StreamBufferHandle_t processedAudioStreamHandle;
-SemaphoreHandle_t dspParamsMutexHandle;
+/* FreeRTOS handles are defined by the object table in app_objects.c */
+
+/* Application state reached from the shell, see console.h */
+static const console_audio_t s_console_audio = {
+  .p_effect_names = s_effect_names,
+  .effect_count = EFFECT_COUNT,
+  .get_effect = console_get_effect,
+  .set_effect = console_set_effect,
+  .get_params = console_get_params,
+  .hold_params = console_hold_params,
+  .release_params = console_release_params,
+  .get_xruns = console_get_xruns,
+  .p_event_names = s_event_names,
+  .event_count = DSP_EVENT_COUNT,
+  .schedule_event = console_schedule_event,
+};
 /* USER CODE END 0 */
 
 /**
@@ -135,7 +254,9 @@ SemaphoreHandle_t dspParamsMutexHandle;
 int main(void)
 {
   /* USER CODE BEGIN 1 */
-
+  app_objects_boot_begin();
+  /* Start the event trace first so every kernel object creation is captured */
+  trace_init();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -157,65 +278,77 @@ int main(void)
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
   MX_I2C1_Init();
-  MX_I2S2_Init();
-  MX_I2S3_Init();
-  MX_SPI1_Init();
   /* USER CODE BEGIN 2 */
 
   // Placeholder for board-specific hardware initialization
-  // e.g., CS43L22_Init(...) and LIS3DSH_Init(...)
-
-  /* USER CODE END 2 */
-
-  /* ---------- CHANGED: Create FreeRTOS objects instead of CMSIS-RTOS wrapper ---------- */
-
-  /* Create the mutex(es) */
-  dspParamsMutexHandle = xSemaphoreCreateMutex();
+  // e.g., CS43L22_Init(...); SPI1 and the LIS3DSH are started by sensorTask
+
+  /* Tickless idle: STOP mode when no DMA stream is running, WFI otherwise.
+     After STOP the PLL restarts at whatever clock the governor selected. */
+  low_power_init(rcc_restore_clocks);
+
+  /* Bulk buffer copies and fills are offloaded to a DMA2 stream */
+  dma_mem_init();
+
+  /* UART in DMA mode: output drains in the background, input arrives on idle line */
+  const uart_config_t console_config = {
+    .baud_rate = CONSOLE_BAUD_RATE,
+    .word_length = 8,
+    .parity = UART_PARITY_NONE,
+    .stop_bits = UART_STOP_BITS_1,
+    .flow_control = UART_FLOW_CONTROL_NONE,
+  };
+  if (uart_bus_start(uart_init(CONSOLE_UART_INSTANCE, &console_config)) != 0)
+  {
+    Error_Handler();
+  }
 
-  /* Create the stream/message buffers */
-  // Stream buffer needs space for at least 2 audio blocks + a little extra
-  rawAudioStreamHandle = xStreamBufferCreate(AUDIO_BLOCK_BYTES * 2 + 1, AUDIO_BLOCK_BYTES);
-  processedAudioStreamHandle = xStreamBufferCreate(AUDIO_BLOCK_BYTES * 2 + 1, AUDIO_BLOCK_BYTES);
+  /* Binary telemetry of the audio taps, DSP cost and parameters on the same UART */
+  telemetry_link_init();
 
-  /* Create the tasks */
-  /* Note: original stack_size values in your CMSIS attrs were treated as bytes.
-     FreeRTOS expects stack depth in words (portSTACK_TYPE). Convert roughly by /4. */
+  /* Command shell on the same UART; its task runs at idle priority */
+  if (!console_init(&s_console_audio))
+  {
+    Error_Handler();
+  }
 
+  /* ART accelerator on, and DSP cycles per block profiled for each setting */
+  if (!dsp_profile_init(s_effect_names, EFFECT_COUNT))
   {
-    BaseType_t ret;
-    /* audioInputTask: original stack_size 1024 -> 1024/4 = 256 words */
-    ret = xTaskCreate(audioInputTask, "audioInputTask", 256, NULL, configMAX_PRIORITIES-1, &audioInputTaskHandle);
-    (void)ret;
+    Error_Handler();
   }
 
+  /* CPU clock between 84 and 168 MHz, following the DSP load */
+  if (!clock_governor_init())
   {
-    BaseType_t ret;
-    /* audioOutputTask: original stack_size 1024 -> 256 words */
-    ret = xTaskCreate(audioOutputTask, "audioOutputTask", 256, NULL, configMAX_PRIORITIES-1, &audioOutputTaskHandle);
-    (void)ret;
+    Error_Handler();
   }
 
+  /* Control events timed on TIM2 and applied by dspTask at their sample */
+  if (!event_sched_init())
   {
-    BaseType_t ret;
-    /* dspTask: original stack_size 4096 -> 4096/4 = 1024 words */
-    ret = xTaskCreate(dspTask, "dspTask", 1024, NULL, configMAX_PRIORITIES-2, &dspTaskHandle);
-    (void)ret;
+    Error_Handler();
   }
 
+  /* Effect presets in flash sectors 1-2; slot 0 is the power-on effect */
+  if (presets_init())
   {
-    BaseType_t ret;
-    /* sensorTask: original stack_size 1024 -> 256 words */
-    ret = xTaskCreate(sensorTask, "sensorTask", 256, NULL, tskIDLE_PRIORITY+1, &sensorTaskHandle);
-    (void)ret;
+    presets_restore();
   }
 
+  /* USER CODE END 2 */
+
+  /* Create every task, stream buffer and mutex from static storage (app_objects.h) */
+  if (!app_objects_create())
   {
-    BaseType_t ret;
-    /* uiTask: original stack_size 512 -> 512/4 = 128 words */
-    ret = xTaskCreate(uiTask, "uiTask", 128, NULL, tskIDLE_PRIORITY, &uiTaskHandle);
-    (void)ret;
+    Error_Handler();
   }
 
+  /* Sample per-task CPU load into the run-time stats window */
+  runtime_stats_start();
+
+  app_objects_boot_end();
+
   /* Start scheduler */
   vTaskStartScheduler();
 
@@ -237,51 +370,77 @@ int main(void)
 /* USER CODE BEGIN 4 */
 
 /**
-  * @brief  This is the callback for the I2S DMA Receive operation.
-  *         It is called from an interrupt context when the first half of the buffer is full.
+  * @brief  Records an audio overrun or underrun on the given half-buffer.
+  */
+static void audio_xrun(uint32_t half)
+{
+  s_xrun_count++;
+  trace_audio_event(TRACE_EVENT_AUDIO_XRUN, half);
+}
+
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 1)
+/**
+  * @brief  Hands a filled RX half-buffer straight to dspTask.
+  * @note   The notification value is the half index + 1. If dspTask has not
+  *         taken the previous block yet, that block is already being
+  *         overwritten by the DMA, so it is replaced and an XRUN is recorded.
   */
-void HAL_I2S_RxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
+static void audio_notify_rx_ready(uint32_t half)
 {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-  /* Signal the audioInputTask that the first half of the DMA buffer is ready */
-  xTaskNotifyFromISR(audioInputTaskHandle, 0x01, eSetBits, &xHigherPriorityTaskWoken);
+  if (xTaskNotifyFromISR(dspTaskHandle, half + 1, eSetValueWithoutOverwrite, &xHigherPriorityTaskWoken) != pdPASS)
+  {
+    audio_xrun(half);
+    xTaskNotifyFromISR(dspTaskHandle, half + 1, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
+  }
   portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
+#endif
 
 /**
-  * @brief  This is the callback for the I2S DMA Receive operation.
-  *         It is called from an interrupt context when the entire buffer is full.
+  * @brief  Called by audio_io from the I2S DMA interrupt when an RX half-buffer is full.
   */
-void HAL_I2S_RxCpltCallback(I2S_HandleTypeDef *hi2s)
+static void audio_rx_ready(uint32_t half)
 {
+  trace_audio_event(TRACE_EVENT_AUDIO_RX_READY, half);
+  event_sched_mark_block_from_isr();
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 1)
+  audio_notify_rx_ready(half);
+#else
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-  /* Signal the audioInputTask that the second half of the DMA buffer is ready */
-  xTaskNotifyFromISR(audioInputTaskHandle, 0x02, eSetBits, &xHigherPriorityTaskWoken);
+  /* Signal the audioInputTask which half of the DMA buffer is ready (bit 0: first, bit 1: second) */
+  xTaskNotifyFromISR(audioInputTaskHandle, 1UL << half, eSetBits, &xHigherPriorityTaskWoken);
   portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+#endif
 }
 
 /**
-  * @brief  This is the callback for the I2S DMA Transmit operation.
-  *         It is called when the first half of the output buffer has been sent.
+  * @brief  Called by audio_io from the I2S DMA interrupt when a TX half-buffer has been sent.
+  * @note   In full duplex this runs just before audio_rx_ready() for the same frame.
   */
-void HAL_I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
+static void audio_tx_free(uint32_t half)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    /* Signal the audioOutputTask that the first half of the DMA buffer is free */
-    xTaskNotifyFromISR(audioOutputTaskHandle, 0x01, eSetBits, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  trace_audio_event(TRACE_EVENT_AUDIO_TX_FREE, half);
+  s_tx_free_half = half;
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 0)
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  /* Signal the audioOutputTask which half of the DMA buffer is free */
+  xTaskNotifyFromISR(audioOutputTaskHandle, 1UL << half, eSetBits, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+#endif
 }
 
 /**
-  * @brief  This is the callback for the I2S DMA Transmit operation.
-  *         It is called when the entire output buffer has been sent.
+  * @brief  Called by the LIS3DSH driver from the SPI DMA interrupt with each FIFO drain.
+  * @note   The block stays valid for one more drain, so sensorTask reads it in place.
   */
-void HAL_I2S_TxCpltCallback(I2S_HandleTypeDef *hi2s)
+static void accel_block_ready(void* p_context, const lis3dsh_sample_t* p_samples, size_t count)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    /* Signal the audioOutputTask that the second half of the DMA buffer is free */
-    xTaskNotifyFromISR(audioOutputTaskHandle, 0x02, eSetBits, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  s_accel_samples = p_samples;
+  s_accel_count = count;
+  vTaskNotifyGiveFromISR((TaskHandle_t)p_context, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 /**
@@ -301,15 +460,13 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 
 // --- TASK IMPLEMENTATIONS ---
 
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 0)
 /**
   * @brief  Audio Input Task: Manages DMA reception and sends raw audio to the DSP task.
   */
 void audioInputTask(void *argument)
 {
-  /* Start the I2S receiver with DMA in circular mode.
-     This function call starts the hardware process. */
-  HAL_I2S_Receive_DMA(&hi2s2, (uint16_t*)dma_input_buffer, DMA_BUFFER_SIZE);
-
+  /* The streams are started by dspTask through audio_io_start() */
   for(;;)
   {
     uint32_t notifyValue = 0;
@@ -319,12 +476,12 @@ void audioInputTask(void *argument)
     if (notifyValue & 0x01) // Half-complete interrupt
     {
       /* Send the first half of the DMA buffer to the DSP task via stream buffer */
-      xStreamBufferSend(rawAudioStreamHandle, &dma_input_buffer, AUDIO_BLOCK_BYTES, 0);
+      xStreamBufferSend(rawAudioStreamHandle, dma_input_buffer, AUDIO_BLOCK_BYTES, 0);
     }
     if (notifyValue & 0x02) // Full-complete interrupt
     {
       /* Send the second half of the DMA buffer to the DSP task */
-      xStreamBufferSend(rawAudioStreamHandle, &dma_input_buffer, AUDIO_BLOCK_BYTES, 0);
+      xStreamBufferSend(rawAudioStreamHandle, &dma_input_buffer[AUDIO_BLOCK_SAMPLES], AUDIO_BLOCK_BYTES, 0);
     }
   }
 }
@@ -334,12 +491,7 @@ void audioInputTask(void *argument)
   */
 void audioOutputTask(void *argument)
 {
-  /* Fill the output buffer with silence initially */
-  memset(dma_output_buffer, 0, DMA_BUFFER_SIZE * sizeof(int16_t));
-
-  /* Start the I2S transmitter with DMA in circular mode */
-  HAL_I2S_Transmit_DMA(&hi2s3, (uint16_t*)dma_output_buffer, DMA_BUFFER_SIZE);
-
+  /* The I2S driver starts playback with the buffer cleared to silence */
   for(;;)
   {
     uint32_t notifyValue = 0;
@@ -348,85 +500,403 @@ void audioOutputTask(void *argument)
 
     if (notifyValue & 0x01) // First half is free
     {
+      if (xStreamBufferBytesAvailable(processedAudioStreamHandle) < AUDIO_BLOCK_BYTES)
+      {
+        audio_xrun(0);
+      }
       /* Block and wait for processed data from the DSP task */
-      xStreamBufferReceive(processedAudioStreamHandle, &dma_output_buffer, AUDIO_BLOCK_BYTES, portMAX_DELAY);
+      xStreamBufferReceive(processedAudioStreamHandle, dma_output_buffer, AUDIO_BLOCK_BYTES, portMAX_DELAY);
     }
     if (notifyValue & 0x02) // Second half is free
     {
+      if (xStreamBufferBytesAvailable(processedAudioStreamHandle) < AUDIO_BLOCK_BYTES)
+      {
+        audio_xrun(1);
+      }
       /* Block and wait for processed data from the DSP task */
-      xStreamBufferReceive(processedAudioStreamHandle, &dma_output_buffer, AUDIO_BLOCK_BYTES, portMAX_DELAY);
+      xStreamBufferReceive(processedAudioStreamHandle, &dma_output_buffer[AUDIO_BLOCK_SAMPLES], AUDIO_BLOCK_BYTES, portMAX_DELAY);
     }
   }
 }
 
+#endif // AUDIO_PIPELINE_DIRECT_NOTIFY
+
+/**
+  * @brief  Starts the parameter ramps at the current parameters.
+  */
+static void dsp_ramps_init(void)
+{
+  DspParams local_params;
+  xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
+  local_params = g_dspParams;
+  xSemaphoreGive(dspParamsMutexHandle);
+
+  ctrl_ramp_init(&s_echo_delay_ramp, CTRL_RAMP_EXPONENTIAL, ECHO_DELAY_SEC(local_params.param1));
+  ctrl_ramp_init(&s_echo_feedback_ramp, CTRL_RAMP_LINEAR, ECHO_FEEDBACK(local_params.param2));
+  ctrl_ramp_init(&s_flanger_rate_ramp, CTRL_RAMP_EXPONENTIAL, FLANGER_RATE_HZ(local_params.param1));
+  ctrl_ramp_init(&s_flanger_depth_ramp, CTRL_RAMP_LINEAR, FLANGER_DEPTH_SEC(local_params.param2));
+  ctrl_ramp_init(&s_tremolo_rate_ramp, CTRL_RAMP_EXPONENTIAL, TREMOLO_RATE_HZ(local_params.param1));
+  ctrl_ramp_init(&s_tremolo_depth_ramp, CTRL_RAMP_LINEAR, TREMOLO_DEPTH(local_params.param2));
+}
+
+/**
+  * @brief  Retargets a ramp unless it already heads for that value.
+  */
+static void dsp_ramp_to(ctrl_ramp_t* p_ramp, float target, uint32_t samples)
+{
+  if (target != p_ramp->target)
+  {
+    ctrl_ramp_set_target(p_ramp, target, samples);
+  }
+}
+
+/**
+  * @brief  Retargets the parameter ramps from g_dspParams over the block.
+  * @note   The only parameter lock dspTask takes, once per block. Values set
+  *         by events in the last block are published first, so the motion
+  *         control and the console see them; a ramp already heading for its
+  *         target (e.g. from an event) is left to finish.
+  */
+static void dsp_update_params(void)
+{
+  DspParams local_params;
+  xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
+  if (s_event_params_pending & 1u)
+  {
+    g_dspParams.param1 = s_event_params.param1;
+  }
+  if (s_event_params_pending & 2u)
+  {
+    g_dspParams.param2 = s_event_params.param2;
+  }
+  local_params = g_dspParams;
+  xSemaphoreGive(dspParamsMutexHandle);
+  s_event_params_pending = 0;
+
+  dsp_ramp_to(&s_echo_delay_ramp, ECHO_DELAY_SEC(local_params.param1), AUDIO_BLOCK_SAMPLES);
+  dsp_ramp_to(&s_echo_feedback_ramp, ECHO_FEEDBACK(local_params.param2), AUDIO_BLOCK_SAMPLES);
+  dsp_ramp_to(&s_flanger_rate_ramp, FLANGER_RATE_HZ(local_params.param1), AUDIO_BLOCK_SAMPLES);
+  dsp_ramp_to(&s_flanger_depth_ramp, FLANGER_DEPTH_SEC(local_params.param2), AUDIO_BLOCK_SAMPLES);
+  dsp_ramp_to(&s_tremolo_rate_ramp, TREMOLO_RATE_HZ(local_params.param1), AUDIO_BLOCK_SAMPLES);
+  dsp_ramp_to(&s_tremolo_depth_ramp, TREMOLO_DEPTH(local_params.param2), AUDIO_BLOCK_SAMPLES);
+}
+
+/**
+  * @brief  Runs the currently selected effect over one block.
+  * @note   The block is split at every due control event, which is applied
+  *         before the frame it is scheduled for.
+  */
+AUDIO_DSP_FUNC static void dsp_process_block(int16_t* input, int16_t* output)
+{
+  uint32_t frame = 0;
+
+  dsp_update_effect();
+  dsp_update_params();
+  event_sched_block_begin();
+  while (frame < AUDIO_BLOCK_FRAMES)
+  {
+    ctrl_event_t event;
+    while (event_sched_take(frame, &event))
+    {
+      dsp_apply_event(&event);
+    }
+
+    uint32_t next = event_sched_next_frame(frame);
+    if (next > frame)
+    {
+      dsp_process_segment(&input[frame * AUDIO_CHANNELS], &output[frame * AUDIO_CHANNELS],
+                          (next - frame) * AUDIO_CHANNELS);
+      frame = next;
+    }
+  }
+  event_sched_block_end();
+}
+
+/**
+  * @brief  Switches dspTask to the selected effect, between two blocks.
+  * @note   Effects that use the delay line start from silence instead of the
+  *         previous effect's history. DMA clears the line in the background
+  *         while dspTask runs bypass, so nothing writes it during the clear,
+  *         and the new effect starts once the clear has completed.
+  */
+static void dsp_update_effect(void)
+{
+  EffectType selected = s_selected_effect;
+
+  if (s_clear_ticket != 0)
+  {
+    if (!dma_mem_is_done(s_clear_ticket))
+    {
+      return;
+    }
+    s_clear_ticket = 0;
+    g_currentEffect = selected;
+    return;
+  }
+  if (selected == g_currentEffect)
+  {
+    return;
+  }
+
+  if (selected == EFFECT_ECHO || selected == EFFECT_FLANGER)
+  {
+    g_currentEffect = EFFECT_BYPASS;
+    s_clear_ticket = dma_mem_set(delay_buffer, 0, sizeof(delay_buffer), NULL, NULL);
+    if (s_clear_ticket != 0)
+    {
+      return;
+    }
+    /* Service queue full: clear it here instead */
+    memset(delay_buffer, 0, sizeof(delay_buffer));
+  }
+  g_currentEffect = selected;
+}
+
+/**
+  * @brief  Runs the currently selected effect over part of a block.
+  */
+AUDIO_DSP_FUNC static void dsp_process_segment(int16_t* input, int16_t* output, uint32_t samples)
+{
+  switch (g_currentEffect)
+  {
+    case EFFECT_ECHO:
+      process_echo(input, output, samples);
+      break;
+    case EFFECT_FLANGER:
+      process_flanger(input, output, samples);
+      break;
+    case EFFECT_TREMOLO:
+      process_tremolo(input, output, samples);
+      break;
+    case EFFECT_BYPASS:
+    default:
+      /* In bypass mode, just copy input to output */
+      memcpy(output, input, samples * sizeof(int16_t));
+      break;
+  }
+}
+
+/**
+  * @brief  Applies a control event in dspTask, between two frames.
+  */
+static void dsp_apply_event(const ctrl_event_t* p_event)
+{
+  switch (p_event->id)
+  {
+    case DSP_EVENT_LFO_RESET:
+      lfo_phase = 0.0f;
+      break;
+    case DSP_EVENT_PARAM1:
+      /* Like the console, an automated parameter overrides the motion control */
+      s_params_held = true;
+      s_event_params.param1 = p_event->value;
+      s_event_params_pending |= 1u;
+      ctrl_ramp_set_target(&s_echo_delay_ramp, ECHO_DELAY_SEC(p_event->value), DSP_EVENT_RAMP_SAMPLES);
+      ctrl_ramp_set_target(&s_flanger_rate_ramp, FLANGER_RATE_HZ(p_event->value), DSP_EVENT_RAMP_SAMPLES);
+      ctrl_ramp_set_target(&s_tremolo_rate_ramp, TREMOLO_RATE_HZ(p_event->value), DSP_EVENT_RAMP_SAMPLES);
+      break;
+    case DSP_EVENT_PARAM2:
+      s_params_held = true;
+      s_event_params.param2 = p_event->value;
+      s_event_params_pending |= 2u;
+      ctrl_ramp_set_target(&s_echo_feedback_ramp, ECHO_FEEDBACK(p_event->value), DSP_EVENT_RAMP_SAMPLES);
+      ctrl_ramp_set_target(&s_flanger_depth_ramp, FLANGER_DEPTH_SEC(p_event->value), DSP_EVENT_RAMP_SAMPLES);
+      ctrl_ramp_set_target(&s_tremolo_depth_ramp, TREMOLO_DEPTH(p_event->value), DSP_EVENT_RAMP_SAMPLES);
+      break;
+    default:
+      break;
+  }
+}
+
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 1)
 /**
   * @brief  DSP Task: The computational core of the application.
+  * @note   Owns both I2S streams. Each RX half-buffer is processed in place,
+  *         straight into the TX half that the output DMA is not reading.
+  *         In full duplex both streams switch halves on the same frame, so
+  *         the free TX half always equals the RX half just filled.
   */
 void dspTask(void *argument)
 {
-  int16_t raw_block;
-  int16_t processed_block;
+  uint32_t last_tx_half = UINT32_MAX; // None written yet
+
+  dsp_ramps_init();
+
+  /* Playback starts with silence; the driver clears the TX buffer */
+  if (!audio_io_start(dma_input_buffer, dma_output_buffer, audio_rx_ready, audio_tx_free))
+  {
+    Error_Handler();
+  }
 
   for(;;)
   {
-    /* 1. BLOCK and wait for a full block of raw audio from the input task. */
-    xStreamBufferReceive(rawAudioStreamHandle, &raw_block, AUDIO_BLOCK_BYTES, portMAX_DELAY);
+    uint32_t notifyValue = 0;
+    /* 1. BLOCK until an RX callback hands over a half-buffer (index + 1) */
+    xTaskNotifyWait(0x00, 0xFFFFFFFF, &notifyValue, portMAX_DELAY);
+    if (notifyValue == 0)
+    {
+      continue;
+    }
+    uint32_t rx_half = notifyValue - 1;
+    trace_audio_event(TRACE_EVENT_AUDIO_DSP_START, g_currentEffect);
 
-    /* 2. Process the audio block based on the currently selected effect. */
-    switch (g_currentEffect)
+    /* 2. Write the TX half the output DMA freed last; it plays one block later */
+    uint32_t tx_half = s_tx_free_half;
+    if (tx_half == last_tx_half)
     {
-      case EFFECT_ECHO:
-        process_echo(&raw_block, &processed_block, AUDIO_BLOCK_SAMPLES);
-        break;
-      case EFFECT_FLANGER:
-        process_flanger(&raw_block, &processed_block, AUDIO_BLOCK_SAMPLES);
-        break;
-      case EFFECT_TREMOLO:
-        process_tremolo(&raw_block, &processed_block, AUDIO_BLOCK_SAMPLES);
-        break;
-      case EFFECT_BYPASS:
-      default:
-        /* In bypass mode, just copy input to output */
-        memcpy(&processed_block, &raw_block, AUDIO_BLOCK_BYTES);
-        break;
+      /* Writing the same half twice means RX and TX drifted by a block,
+         which cannot happen in full duplex */
+      audio_xrun(tx_half);
     }
+    last_tx_half = tx_half;
+
+    /* 3. Process the block directly between the DMA buffers */
+    int16_t* input = &dma_input_buffer[rx_half * AUDIO_BLOCK_SAMPLES];
+    int16_t* output = &dma_output_buffer[tx_half * AUDIO_BLOCK_SAMPLES];
+    telemetry_link_block_begin();
+    dsp_profile_block_begin();
+    dsp_process_block(input, output);
+    dsp_profile_block_end(g_currentEffect);
+
+    trace_audio_event(TRACE_EVENT_AUDIO_DSP_END, g_currentEffect);
+
+    /* 4. Stream the block's taps and cost without waiting on the UART */
+    telemetry_link_block_end(input, output, (uint8_t)g_currentEffect);
+  }
+}
+#else
+/**
+  * @brief  DSP Task: The computational core of the application.
+  */
+void dspTask(void *argument)
+{
+  int16_t raw_block[AUDIO_BLOCK_SAMPLES];
+  int16_t processed_block[AUDIO_BLOCK_SAMPLES];
+#if (AUDIO_ASRC_ENABLE == 1)
+  /* A block resampled with the largest correction, in interleaved frames */
+  int16_t resampled_block[(AUDIO_BLOCK_FRAMES + AUDIO_BLOCK_FRAMES / 64 + 2) * AUDIO_CHANNELS];
+  const asrc_config_t asrc_config = {
+    .input_rate_hz = AUDIO_SAMPLING_RATE,
+    .output_rate_hz = AUDIO_SAMPLING_RATE,
+    .channels = AUDIO_CHANNELS,
+    .kp_ppm = AUDIO_ASRC_KP_PPM,
+    .ki_ppm = AUDIO_ASRC_KI_PPM,
+    .max_correction_ppm = AUDIO_ASRC_MAX_PPM,
+  };
+
+  if (!asrc_init(&s_asrc, &asrc_config) ||
+      asrc_max_output_frames(&s_asrc, AUDIO_BLOCK_FRAMES) * AUDIO_CHANNELS > sizeof(resampled_block) / sizeof(int16_t))
+  {
+    Error_Handler();
+  }
+
+  /* Prime the output with a block of silence; the controller trims the rest */
+  memset(resampled_block, 0, AUDIO_BLOCK_BYTES);
+  xStreamBufferSend(processedAudioStreamHandle, resampled_block, AUDIO_BLOCK_BYTES, 0);
+#endif
+
+  dsp_ramps_init();
+  if (!audio_io_start(dma_input_buffer, dma_output_buffer, audio_rx_ready, audio_tx_free))
+  {
+    Error_Handler();
+  }
+
+  for(;;)
+  {
+    /* 1. BLOCK and wait for a full block of raw audio from the input task. */
+    xStreamBufferReceive(rawAudioStreamHandle, raw_block, AUDIO_BLOCK_BYTES, portMAX_DELAY);
+    trace_audio_event(TRACE_EVENT_AUDIO_DSP_START, g_currentEffect);
+
+    /* 2. Process the audio block based on the currently selected effect. */
+    telemetry_link_block_begin();
+    dsp_profile_block_begin();
+    dsp_process_block(raw_block, processed_block);
+    dsp_profile_block_end(g_currentEffect);
+    telemetry_link_block_end(raw_block, processed_block, (uint8_t)g_currentEffect);
+
+#if (AUDIO_ASRC_ENABLE == 1)
+    /* 3. Resample into the playback clock, steered by the output fill level. */
+    float fill_frames = (float)(xStreamBufferBytesAvailable(processedAudioStreamHandle) / AUDIO_FRAME_BYTES);
+    asrc_steer(&s_asrc, fill_frames - (float)AUDIO_ASRC_TARGET_FRAMES);
+    size_t frames = asrc_process_q15(&s_asrc, processed_block, AUDIO_BLOCK_FRAMES,
+                                     resampled_block, sizeof(resampled_block) / AUDIO_FRAME_BYTES);
+
+    trace_audio_event(TRACE_EVENT_AUDIO_DSP_END, g_currentEffect);
+
+    /* 4. Send the resampled frames to the output task; the count varies by a frame. */
+    xStreamBufferSend(processedAudioStreamHandle, resampled_block, frames * AUDIO_FRAME_BYTES, portMAX_DELAY);
+#else
+    trace_audio_event(TRACE_EVENT_AUDIO_DSP_END, g_currentEffect);
 
     /* 3. Send the processed block to the output task. */
-    xStreamBufferSend(processedAudioStreamHandle, &processed_block, AUDIO_BLOCK_BYTES, portMAX_DELAY);
+    xStreamBufferSend(processedAudioStreamHandle, processed_block, AUDIO_BLOCK_BYTES, portMAX_DELAY);
+#endif
   }
 }
+#endif // AUDIO_PIPELINE_DIRECT_NOTIFY
 
 /**
-  * @brief  Sensor Task: Periodically reads accelerometer data.
+  * @brief  Sensor Task: Maps tilt from the accelerometer to the effect parameters.
+  * @note   Woken once per FIFO drain (every ACCEL_WATERMARK samples) rather
+  *         than polling; each block is conditioned into one pair of targets.
   */
 void sensorTask(void *argument)
 {
-  float axes[1]; // To hold X, Y, Z values
+  /* LIS3DSH: SPI mode 3, at most 10 MHz; APB2 / 16 = 5.25 MHz */
+  const spi_config_t spi_config = {
+    .baud_rate_prescaler = SPI_BAUD_RATE_DIV_16,
+    .clock_polarity = SPI_CLOCK_POLARITY_HIGH,
+    .clock_phase = SPI_CLOCK_PHASE_2_EDGE,
+    .bit_order = SPI_BIT_ORDER_MSB_FIRST,
+    .data_size = SPI_DATA_SIZE_8_BIT,
+  };
+  const lis3dsh_config_t accel_config = {
+    .spi = spi_init(ACCEL_SPI_INSTANCE, &spi_config),
+    .cs_port = ACCEL_CS_PORT,
+    .cs_pin = ACCEL_CS_PIN,
+    .int1_port = ACCEL_INT1_PORT,
+    .int1_pin = ACCEL_INT1_PIN,
+    .odr = ACCEL_ODR,
+    .scale = LIS3DSH_SCALE_2G,
+    .watermark = ACCEL_WATERMARK,
+    .callback = accel_block_ready,
+    .p_context = xTaskGetCurrentTaskHandle(),
+  };
+  lis3dsh_handle_t accel = lis3dsh_init(&accel_config);
+  if (accel == NULL)
+  {
+    Error_Handler();
+  }
+  const float g_per_count = lis3dsh_get_g_per_count(accel);
+  motion_init(lis3dsh_get_rate_hz(accel));
 
   for(;;)
   {
-    /* This is a placeholder for your accelerometer driver call */
-    // LIS3DSH_ReadAxes(axes);
+    /* Wait for the next FIFO drain; a late wake-up uses the newest block */
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ACCEL_TIMEOUT_MS)) == 0)
+    {
+      continue;
+    }
+    const lis3dsh_sample_t* samples = s_accel_samples;
+    size_t count = s_accel_count;
 
-    /* Normalize accelerometer data (example, depends on sensor range)
-       Assuming a range of -2g to +2g, and we want a 0.0 to 1.0 mapping */
-    float x_norm = (axes / 2000.0f) + 0.5f; // Example scaling
-    float y_norm = (axes[2] / 2000.0f) + 0.5f; // Example scaling
+    /* Filter, tilt and curves; the results are targets the DSP ramps towards */
+    float param1, param2;
+    motion_process(samples, count, g_per_count, &param1, &param2);
 
-    /* Clamp values to be between 0.0 and 1.0 */
-    if(x_norm < 0.0f) x_norm = 0.0f;
-    if(x_norm > 1.0f) x_norm = 1.0f;
-    if(y_norm < 0.0f) y_norm = 0.0f;
-    if(y_norm > 1.0f) y_norm = 1.0f;
+    /* Parameters held from the console keep their values */
+    if (s_params_held)
+    {
+      continue;
+    }
 
     /* Acquire mutex to safely update shared parameters */
     xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
-    g_dspParams.param1 = x_norm;
-    g_dspParams.param2 = y_norm;
+    g_dspParams.param1 = param1;
+    g_dspParams.param2 = param2;
     xSemaphoreGive(dspParamsMutexHandle);
 
-    /* Wait for the next sample period */
-    vTaskDelay(pdMS_TO_TICKS(50)); // Read sensor 20 times per second
+    telemetry_link_params(param1, param2);
   }
 }
 
@@ -449,40 +919,122 @@ void uiTask(void *argument)
       last_press_time = xTaskGetTickCount();
 
       /* Cycle to the next effect */
-      g_currentEffect = (EffectType)((g_currentEffect + 1) % EFFECT_COUNT);
-
-      /* Update LEDs to indicate current effect */
-      HAL_GPIO_WritePin(GPIOD, LD4_Pin|LD3_Pin|LD5_Pin|LD6_Pin, GPIO_PIN_RESET);
-      switch(g_currentEffect)
-      {
-        case EFFECT_BYPASS: break; // No LED
-        case EFFECT_ECHO: HAL_GPIO_WritePin(GPIOD, LD4_Pin, GPIO_PIN_SET); break; // Green
-        case EFFECT_FLANGER: HAL_GPIO_WritePin(GPIOD, LD3_Pin, GPIO_PIN_SET); break; // Orange
-        case EFFECT_TREMOLO: HAL_GPIO_WritePin(GPIOD, LD5_Pin, GPIO_PIN_SET); break; // Red
-        default: break;
-      }
+      effect_select((EffectType)((s_selected_effect + 1) % EFFECT_COUNT));
     }
   }
 }
 
+/**
+  * @brief  Selects an effect and shows it on the LEDs.
+  * @note   Called from uiTask and from the console task. dspTask switches
+  *         at its next block, see dsp_update_effect().
+  */
+static void effect_select(EffectType effect)
+{
+  s_selected_effect = effect;
+  effect_show(effect);
+}
+
+/**
+  * @brief  Shows an effect on the LEDs.
+  */
+static void effect_show(EffectType effect)
+{
+  HAL_GPIO_WritePin(GPIOD, LD4_Pin|LD3_Pin|LD5_Pin|LD6_Pin, GPIO_PIN_RESET);
+  switch(effect)
+  {
+    case EFFECT_BYPASS: break; // No LED
+    case EFFECT_ECHO: HAL_GPIO_WritePin(GPIOD, LD4_Pin, GPIO_PIN_SET); break; // Green
+    case EFFECT_FLANGER: HAL_GPIO_WritePin(GPIOD, LD3_Pin, GPIO_PIN_SET); break; // Orange
+    case EFFECT_TREMOLO: HAL_GPIO_WritePin(GPIOD, LD5_Pin, GPIO_PIN_SET); break; // Red
+    default: break;
+  }
+}
+
+/**
+  * @brief  Applies preset slot 0, if saved, before the scheduler starts.
+  * @note   Sets the state directly: no task runs yet, and the delay line is
+  *         still zero from startup, so nothing needs clearing.
+  */
+static void presets_restore(void)
+{
+  preset_t preset;
+  if (presets_load(0, &preset) != 0 || preset.effect >= EFFECT_COUNT)
+  {
+    return;
+  }
+
+  g_currentEffect = (EffectType)preset.effect;
+  s_selected_effect = g_currentEffect;
+  g_dspParams.param1 = preset.param1;
+  g_dspParams.param2 = preset.param2;
+  s_params_held = true;
+  effect_show(g_currentEffect);
+}
+
 
-// --- DSP ALGORITHM IMPLEMENTATIONS ---
+// --- CONSOLE ACCESSORS (console task) ---
 
-void process_echo(int16_t* input, int16_t* output, uint32_t block_size)
+static uint32_t console_get_effect(void)
 {
-    DspParams local_params;
-    xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
-    local_params = g_dspParams;
-    xSemaphoreGive(dspParamsMutexHandle);
+  return (uint32_t)s_selected_effect;
+}
+
+static void console_set_effect(uint32_t effect)
+{
+  if (effect < EFFECT_COUNT)
+  {
+    effect_select((EffectType)effect);
+  }
+}
+
+static bool console_get_params(float* p_param1, float* p_param2)
+{
+  xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
+  *p_param1 = g_dspParams.param1;
+  *p_param2 = g_dspParams.param2;
+  xSemaphoreGive(dspParamsMutexHandle);
+  return s_params_held;
+}
+
+static void console_hold_params(float param1, float param2)
+{
+  s_params_held = true;
+  xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
+  g_dspParams.param1 = param1;
+  g_dspParams.param2 = param2;
+  xSemaphoreGive(dspParamsMutexHandle);
+  telemetry_link_params(param1, param2);
+}
+
+static void console_release_params(void)
+{
+  s_params_held = false;
+}
+
+static uint32_t console_get_xruns(void)
+{
+  return s_xrun_count;
+}
+
+static bool console_schedule_event(uint32_t event, float value, uint32_t delay_ms)
+{
+  uint32_t delay_frames = (uint32_t)(((uint64_t)delay_ms * AUDIO_SAMPLING_RATE) / 1000u);
+  return event < DSP_EVENT_COUNT && event_sched_post((uint16_t)event, value, delay_frames);
+}
 
-    float delay_time_sec = 0.05f + local_params.param1 * 0.95f; // 50ms to 1s delay
-    uint32_t delay_samples = (uint32_t)(delay_time_sec * AUDIO_SAMPLING_RATE);
-    if (delay_samples >= DELAY_BUFFER_SIZE) delay_samples = DELAY_BUFFER_SIZE - 1;
 
-    float feedback = local_params.param2 * 0.85f; // 0 to 85% feedback
+// --- DSP ALGORITHM IMPLEMENTATIONS ---
 
+AUDIO_DSP_FUNC void process_echo(int16_t* input, int16_t* output, uint32_t block_size)
+{
     for (uint32_t i = 0; i < block_size; i++)
     {
+        uint32_t delay_frames = (uint32_t)(ctrl_ramp_next(&s_echo_delay_ramp) * AUDIO_SAMPLING_RATE);
+        if (delay_frames >= DELAY_BUFFER_FRAMES) delay_frames = DELAY_BUFFER_FRAMES - 1;
+        uint32_t delay_samples = delay_frames * AUDIO_CHANNELS;   // Whole frames keep each channel apart
+        float feedback = ctrl_ramp_next(&s_echo_feedback_ramp);
+
         uint32_t read_index = (delay_write_index - delay_samples + DELAY_BUFFER_SIZE) % DELAY_BUFFER_SIZE;
         int16_t delayed_sample = delay_buffer[read_index];
         int32_t current_input = input[i];
@@ -503,7 +1055,7 @@ void process_echo(int16_t* input, int16_t* output, uint32_t block_size)
     }
 }
 
-float get_lfo_value(float rate_hz, float depth)
+AUDIO_DSP_FUNC float get_lfo_value(float rate_hz, float depth)
 {
     lfo_phase += (2.0f * M_PI * rate_hz) / AUDIO_SAMPLING_RATE;
     if (lfo_phase >= 2.0f * M_PI) {
@@ -512,21 +1064,16 @@ float get_lfo_value(float rate_hz, float depth)
     return sinf(lfo_phase) * depth;
 }
 
-void process_flanger(int16_t* input, int16_t* output, uint32_t block_size)
+AUDIO_DSP_FUNC void process_flanger(int16_t* input, int16_t* output, uint32_t block_size)
 {
-    DspParams local_params;
-    xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
-    local_params = g_dspParams;
-    xSemaphoreGive(dspParamsMutexHandle);
-
-    float lfo_rate_hz = 0.1f + local_params.param1 * 4.9f;
-    float lfo_depth_sec = 0.001f + local_params.param2 * 0.005f; // 1ms to 6ms sweep
-
     for (uint32_t i = 0; i < block_size; i++)
     {
+        float lfo_rate_hz = ctrl_ramp_next(&s_flanger_rate_ramp);
+        float lfo_depth_sec = ctrl_ramp_next(&s_flanger_depth_ramp);
         float lfo_val = 0.5f + 0.5f * get_lfo_value(lfo_rate_hz, 1.0f);
-        uint32_t delay_samples = (uint32_t)(lfo_val * lfo_depth_sec * AUDIO_SAMPLING_RATE);
-        if (delay_samples >= DELAY_BUFFER_SIZE) delay_samples = DELAY_BUFFER_SIZE - 1;
+        uint32_t delay_frames = (uint32_t)(lfo_val * lfo_depth_sec * AUDIO_SAMPLING_RATE);
+        if (delay_frames >= DELAY_BUFFER_FRAMES) delay_frames = DELAY_BUFFER_FRAMES - 1;
+        uint32_t delay_samples = delay_frames * AUDIO_CHANNELS;
 
         uint32_t read_index = (delay_write_index - delay_samples + DELAY_BUFFER_SIZE) % DELAY_BUFFER_SIZE;
         int16_t delayed_sample = delay_buffer[read_index];
@@ -539,18 +1086,12 @@ void process_flanger(int16_t* input, int16_t* output, uint32_t block_size)
     }
 }
 
-void process_tremolo(int16_t* input, int16_t* output, uint32_t block_size)
+AUDIO_DSP_FUNC void process_tremolo(int16_t* input, int16_t* output, uint32_t block_size)
 {
-    DspParams local_params;
-    xSemaphoreTake(dspParamsMutexHandle, portMAX_DELAY);
-    local_params = g_dspParams;
-    xSemaphoreGive(dspParamsMutexHandle);
-
-    float lfo_rate_hz = 1.0f + local_params.param1 * 9.0f;
-    float lfo_depth = local_params.param2;
-
     for (uint32_t i = 0; i < block_size; i++)
     {
+        float lfo_rate_hz = ctrl_ramp_next(&s_tremolo_rate_ramp);
+        float lfo_depth = ctrl_ramp_next(&s_tremolo_depth_ramp);
         float lfo_val = get_lfo_value(lfo_rate_hz, 1.0f);
         float modulator = (1.0f - lfo_depth) + (lfo_depth * (lfo_val + 1.0f) * 0.5f);
 
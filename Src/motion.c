@@ -0,0 +1,141 @@
+/**
+ * @file      motion.c
+ * @brief     Accelerometer blocks to effect parameters: filtering, tilt and
+ *            response curves.
+ */
+
+#include "motion.h"
+#include "ctrl.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+#define MOTION_PI               3.14159265f
+#define MOTION_D_CUTOFF_HZ      1.0f        // Cutoff of the one-euro speed estimate
+#define MOTION_BUTTERWORTH_Q    0.70710678f
+
+// --- Static Data ---
+static ctrl_biquad_t s_axis_filter[3];
+static ctrl_one_euro_t s_roll_filter;
+static ctrl_one_euro_t s_pitch_filter;
+static ctrl_curve_t s_curve;
+static float s_sample_period_s;
+static bool s_is_primed;
+
+static float s_last_param[2];
+static float s_jitter_ms[2];                // Mean square of the block-to-block change
+static motion_stats_t s_stats;
+
+// --- Private Helper Functions ---
+
+static void update_jitter(int index, float param) {
+    float delta = param - s_last_param[index];
+    s_last_param[index] = param;
+    s_jitter_ms[index] += (delta * delta - s_jitter_ms[index]) / (float)MOTION_JITTER_BLOCKS;
+}
+
+// --- Public API Function Implementations ---
+
+void motion_init(float sample_rate_hz) {
+    for (int i = 0; i < 3; ++i) {
+        ctrl_biquad_lowpass(&s_axis_filter[i], sample_rate_hz, MOTION_PREFILTER_HZ, MOTION_BUTTERWORTH_Q);
+    }
+    ctrl_one_euro_init(&s_roll_filter, MOTION_MIN_CUTOFF_HZ, MOTION_BETA, MOTION_D_CUTOFF_HZ);
+    ctrl_one_euro_init(&s_pitch_filter, MOTION_MIN_CUTOFF_HZ, MOTION_BETA, MOTION_D_CUTOFF_HZ);
+
+    float range = MOTION_TILT_RANGE_DEG * MOTION_PI / 180.0f;
+    s_curve = (ctrl_curve_t){
+        .in_min = -range,
+        .in_max = range,
+        .dead_zone = MOTION_DEAD_ZONE,
+        .gamma = MOTION_CURVE_GAMMA,
+    };
+    s_sample_period_s = 1.0f / sample_rate_hz;
+    s_is_primed = false;
+    s_stats = (motion_stats_t){0};
+    s_jitter_ms[0] = s_jitter_ms[1] = 0.0f;
+}
+
+void motion_process(const lis3dsh_sample_t* p_samples, size_t count, float g_per_count,
+                    float* p_param1, float* p_param2) {
+    uint32_t start = DWT_CYCCNT;
+
+    // Start the biquads at the first reading instead of ringing up from zero
+    if (!s_is_primed) {
+        ctrl_biquad_reset(&s_axis_filter[0], (float)p_samples[0].x * g_per_count);
+        ctrl_biquad_reset(&s_axis_filter[1], (float)p_samples[0].y * g_per_count);
+        ctrl_biquad_reset(&s_axis_filter[2], (float)p_samples[0].z * g_per_count);
+    }
+
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        x = ctrl_biquad_process(&s_axis_filter[0], (float)p_samples[i].x * g_per_count);
+        y = ctrl_biquad_process(&s_axis_filter[1], (float)p_samples[i].y * g_per_count);
+        z = ctrl_biquad_process(&s_axis_filter[2], (float)p_samples[i].z * g_per_count);
+    }
+
+    float roll, pitch;
+    ctrl_tilt(x, y, z, &roll, &pitch);
+    float dt_s = s_sample_period_s * (float)count;
+    roll = ctrl_one_euro_update(&s_roll_filter, roll, dt_s);
+    pitch = ctrl_one_euro_update(&s_pitch_filter, pitch, dt_s);
+
+    *p_param1 = ctrl_curve_map(&s_curve, pitch);
+    *p_param2 = ctrl_curve_map(&s_curve, roll);
+
+    uint32_t cycles = DWT_CYCCNT - start;
+
+    if (!s_is_primed) {
+        s_last_param[0] = *p_param1;
+        s_last_param[1] = *p_param2;
+        s_is_primed = true;
+    }
+    update_jitter(0, *p_param1);
+    update_jitter(1, *p_param2);
+
+    s_stats.blocks++;
+    s_stats.samples_per_block = (uint32_t)count;
+    s_stats.cycles_last = cycles;
+    if (cycles > s_stats.cycles_max) {
+        s_stats.cycles_max = cycles;
+    }
+}
+
+void motion_get_stats(motion_stats_t* p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+    *p_stats = s_stats;
+    p_stats->jitter_ppm[0] = (uint32_t)(sqrtf(s_jitter_ms[0]) * 1e6f);
+    p_stats->jitter_ppm[1] = (uint32_t)(sqrtf(s_jitter_ms[1]) * 1e6f);
+}
+
+size_t motion_report(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    motion_stats_t stats;
+    motion_get_stats(&stats);
+    uint32_t us_max = (uint32_t)(((uint64_t)stats.cycles_max * 1000000ULL) / configCPU_CLOCK_HZ);
+
+    int n = snprintf(p_buffer, len,
+                     "Motion: %lu blocks of %lu samples\r\n"
+                     "cycles/block %lu (max %lu, %lu us)\r\n"
+                     "jitter ppm   param1 %lu  param2 %lu\r\n",
+                     (unsigned long)stats.blocks, (unsigned long)stats.samples_per_block,
+                     (unsigned long)stats.cycles_last, (unsigned long)stats.cycles_max, (unsigned long)us_max,
+                     (unsigned long)stats.jitter_ppm[0], (unsigned long)stats.jitter_ppm[1]);
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
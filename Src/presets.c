@@ -0,0 +1,182 @@
+/**
+ * @file      presets.c
+ * @brief     Effect presets kept in internal flash.
+ */
+
+#include "presets.h"
+#include "audio_io.h"
+#include "flash.h"
+#include "kvstore.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+#define CYCLES_TO_US(c)         ((uint32_t)(((uint64_t)(c) * 1000000ULL) / configCPU_CLOCK_HZ))
+
+_Static_assert(PRESETS_SLOTS <= KVSTORE_MAX_KEYS, "one store key per preset slot");
+_Static_assert(sizeof(preset_t) <= KVSTORE_MAX_VALUE, "a preset fits one record");
+
+// --- Static Data ---
+static flash_handle_t s_flash = NULL;
+static kvstore_t s_store;
+static bool s_is_mounted = false;
+
+// Flash timing, for the report
+static uint64_t s_program_bytes;
+static uint64_t s_program_cycles;
+static uint32_t s_erase_us_last;
+static uint32_t s_erase_us_max;
+static uint32_t s_erase_poll_gap_us_max;     // Longest the erasing task went without running
+
+// Saves refused because they needed an erase while audio streamed
+static bool s_erase_refused;
+static uint32_t s_saves_refused;
+
+// --- Private Helper Functions ---
+
+static int store_erase(void* p_context, uint8_t sector) {
+    (void)p_context;
+    // The erase would stall every flash fetch, the audio path's included
+    if (audio_io_is_streaming()) {
+        s_erase_refused = true;
+        return -1;
+    }
+
+    uint32_t start = DWT_CYCCNT;
+    int ret = flash_erase_sector_start(s_flash, (uint8_t)(PRESETS_FLASH_SECTOR + sector));
+    if (ret != 0) {
+        return ret;
+    }
+
+    // Polled from FLASH, so on this single bank the first poll only runs once
+    // the erase is over, and no other task runs before it either: the gap
+    // from the start is the scheduling latency the erase causes
+    uint32_t last_poll = start;
+    do {
+        ret = flash_poll(s_flash);
+        uint32_t now = DWT_CYCCNT;
+        uint32_t gap_us = CYCLES_TO_US(now - last_poll);
+        if (gap_us > s_erase_poll_gap_us_max) {
+            s_erase_poll_gap_us_max = gap_us;
+        }
+        last_poll = now;
+    } while (ret == FLASH_BUSY);
+
+    s_erase_us_last = CYCLES_TO_US(DWT_CYCCNT - start);
+    if (s_erase_us_last > s_erase_us_max) {
+        s_erase_us_max = s_erase_us_last;
+    }
+    return ret;
+}
+
+static int store_program(void* p_context, uint8_t sector, uint32_t offset, const uint8_t* p_data, size_t len) {
+    (void)p_context;
+    uint32_t address = PRESETS_FLASH_ADDRESS + (uint32_t)sector * PRESETS_FLASH_SECTOR_BYTES + offset;
+    uint32_t start = DWT_CYCCNT;
+    int ret = flash_program(s_flash, address, p_data, len);
+    s_program_cycles += DWT_CYCCNT - start;
+    s_program_bytes += len;
+    return ret;
+}
+
+// --- Public API Function Implementations ---
+
+bool presets_init(void) {
+    s_flash = flash_init();
+    if (s_flash == NULL) {
+        return false;
+    }
+
+    const kvstore_flash_t backend = {
+        .erase = store_erase,
+        .program = store_program,
+        .p_context = NULL,
+        .p_sector = {(const uint8_t*)PRESETS_FLASH_ADDRESS,
+                     (const uint8_t*)(PRESETS_FLASH_ADDRESS + PRESETS_FLASH_SECTOR_BYTES)},
+        .sector_bytes = PRESETS_FLASH_SECTOR_BYTES,
+    };
+    s_is_mounted = (kvstore_mount(&s_store, &backend) == 0);
+    if (!s_is_mounted) {
+        return false;
+    }
+
+    // Audio is not running yet, so this is the time to make room for the
+    // saves of this session; a failed compaction leaves the store as it was
+    kvstore_stats_t stats;
+    kvstore_get_stats(&s_store, &stats);
+    if (stats.free_bytes < PRESETS_COMPACT_RESERVE_BYTES) {
+        (void)kvstore_compact(&s_store);
+    }
+    return true;
+}
+
+int presets_save(uint32_t slot, const preset_t* p_preset) {
+    if (!s_is_mounted || slot >= PRESETS_SLOTS || p_preset == NULL) {
+        return KVSTORE_ERR_ARG;
+    }
+    s_erase_refused = false;
+    int ret = kvstore_write(&s_store, (uint16_t)slot, p_preset, sizeof(*p_preset));
+    if (ret != 0 && s_erase_refused) {
+        s_saves_refused++;
+        return PRESETS_ERR_STREAMING;
+    }
+    return ret;
+}
+
+int presets_load(uint32_t slot, preset_t* p_preset) {
+    if (!s_is_mounted || slot >= PRESETS_SLOTS || p_preset == NULL) {
+        return KVSTORE_ERR_ARG;
+    }
+    memset(p_preset, 0, sizeof(*p_preset));
+    int ret = kvstore_read(&s_store, (uint16_t)slot, p_preset, sizeof(*p_preset));
+    return (ret < 0) ? ret : 0;
+}
+
+size_t presets_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    int n;
+    if (s_is_mounted) {
+        kvstore_stats_t stats;
+        kvstore_get_stats(&s_store, &stats);
+
+        // Write amplification in hundredths: flash bytes per preset byte saved
+        uint32_t amp = (stats.value_bytes > 0) ?
+                       (uint32_t)(((uint64_t)stats.flash_bytes * 100ULL) / stats.value_bytes) : 0;
+        uint32_t saves_per_erase = (stats.erases > 0) ? stats.writes / stats.erases : 0;
+        uint32_t program_kbps = (s_program_cycles > 0) ?
+                                (uint32_t)((s_program_bytes * configCPU_CLOCK_HZ) / (s_program_cycles * 1024ULL)) : 0;
+
+        n = snprintf(p_buffer, len,
+                     "Saves: %lu  unchanged: %lu  compactions: %lu  erases: %lu\r\n"
+                     "Flash: %lu bytes for %lu preset bytes = %lu.%02lux  saves/erase: %lu\r\n"
+                     "Sector %u gen %lu: live %lu  free %lu of %u bytes\r\n"
+                     "Program: %lu KB/s  erase: %lu ms (max %lu)  longest unscheduled: %lu ms\r\n"
+                     "Saves refused while streaming: %lu\r\n",
+                     (unsigned long)stats.writes, (unsigned long)stats.unchanged,
+                     (unsigned long)stats.compactions, (unsigned long)stats.erases,
+                     (unsigned long)stats.flash_bytes, (unsigned long)stats.value_bytes,
+                     (unsigned long)(amp / 100), (unsigned long)(amp % 100), (unsigned long)saves_per_erase,
+                     (unsigned)(PRESETS_FLASH_SECTOR + s_store.active), (unsigned long)stats.generation,
+                     (unsigned long)stats.live_bytes, (unsigned long)stats.free_bytes,
+                     (unsigned)PRESETS_FLASH_SECTOR_BYTES,
+                     (unsigned long)program_kbps, (unsigned long)(s_erase_us_last / 1000),
+                     (unsigned long)(s_erase_us_max / 1000), (unsigned long)(s_erase_poll_gap_us_max / 1000),
+                     (unsigned long)s_saves_refused);
+    } else {
+        n = snprintf(p_buffer, len, "Preset store not mounted\r\n");
+    }
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
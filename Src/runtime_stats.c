@@ -0,0 +1,265 @@
+/**
+ * @file      runtime_stats.c
+ * @brief     FreeRTOS run-time statistics clock and per-task load reporting.
+ */
+
+#include "runtime_stats.h"
+#include "timer.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Sliding-window history of one task.
+ */
+typedef struct {
+    bool in_use;
+    bool seen;                                        // Present in the latest sample
+    UBaseType_t task_number;
+    UBaseType_t priority;
+    uint16_t stack_hwm_words;
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t counter[RUNTIME_STATS_WINDOW_SLOTS];     // Run-time counter per sample
+} runtime_stats_entry_t;
+
+/**
+ * @brief Consistent copy of the window, taken before reporting it.
+ */
+typedef struct {
+    runtime_stats_entry_t entries[RUNTIME_STATS_MAX_TASKS];
+    uint32_t total[RUNTIME_STATS_WINDOW_SLOTS];
+    uint32_t newest;
+    uint32_t oldest;
+} runtime_stats_snapshot_t;
+
+// --- Static Data ---
+static timer_handle_t s_timer = NULL;
+static TimerHandle_t s_sample_timer = NULL;
+static StaticTimer_t s_sample_timer_buffer;
+
+static runtime_stats_entry_t s_entries[RUNTIME_STATS_MAX_TASKS];
+static uint32_t s_total[RUNTIME_STATS_WINDOW_SLOTS];
+static TaskStatus_t s_status[RUNTIME_STATS_MAX_TASKS];
+static uint32_t s_newest = 0;   // Slot written by the most recent sample
+static uint32_t s_samples = 0;  // Number of samples taken, saturates at WINDOW_SLOTS
+static runtime_stats_snapshot_t s_snapshot;     // Filled by take_snapshot()
+
+// --- Private Helper Functions ---
+
+static uint32_t oldest_slot(void) {
+    if (s_samples < RUNTIME_STATS_WINDOW_SLOTS) {
+        return 0;
+    }
+    return (s_newest + 1) % RUNTIME_STATS_WINDOW_SLOTS;
+}
+
+static runtime_stats_entry_t* find_or_add_entry(const TaskStatus_t* status) {
+    runtime_stats_entry_t* free_entry = NULL;
+
+    for (int i = 0; i < RUNTIME_STATS_MAX_TASKS; ++i) {
+        if (s_entries[i].in_use && s_entries[i].task_number == status->xTaskNumber) {
+            return &s_entries[i];
+        }
+        if (!s_entries[i].in_use && free_entry == NULL) {
+            free_entry = &s_entries[i];
+        }
+    }
+
+    if (free_entry != NULL) {
+        // A new task starts with a flat history so its window delta is exact
+        free_entry->in_use = true;
+        free_entry->task_number = status->xTaskNumber;
+        strncpy(free_entry->name, status->pcTaskName, configMAX_TASK_NAME_LEN - 1);
+        free_entry->name[configMAX_TASK_NAME_LEN - 1] = '\0';
+        for (int s = 0; s < RUNTIME_STATS_WINDOW_SLOTS; ++s) {
+            free_entry->counter[s] = status->ulRunTimeCounter;
+        }
+    }
+    return free_entry;
+}
+
+/**
+ * @brief Copies the window with the scheduler suspended.
+ * @details The sampler writes the window from the timer task; without the
+ *          copy a report could mix two samples.
+ */
+static const runtime_stats_snapshot_t* take_snapshot(void) {
+    vTaskSuspendAll();
+    memcpy(s_snapshot.entries, s_entries, sizeof(s_entries));
+    memcpy(s_snapshot.total, s_total, sizeof(s_total));
+    s_snapshot.newest = s_newest;
+    s_snapshot.oldest = oldest_slot();
+    (void)xTaskResumeAll();
+    return &s_snapshot;
+}
+
+static void sample_timer_callback(TimerHandle_t timer) {
+    (void)timer;
+    runtime_stats_sample();
+}
+
+/** @brief Returns (part / whole) in tenths of a percent. */
+static uint32_t permille(uint32_t part, uint32_t whole) {
+    if (whole == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)part * 1000U) / whole);
+}
+
+// --- Public API Function Implementations ---
+
+void runtime_stats_timer_init(void) {
+    uint32_t input_hz = timer_get_input_clock_hz(RUNTIME_STATS_TIMER_INSTANCE);
+    timer_config_t config = {
+        .prescaler = (input_hz / RUNTIME_STATS_COUNTER_HZ) - 1,
+        .period = 0xFFFFFFFFUL,
+    };
+
+    s_timer = timer_init(RUNTIME_STATS_TIMER_INSTANCE, &config);
+    timer_start(s_timer);
+}
+
+uint32_t runtime_stats_get_counter(void) {
+    return timer_get_counter(s_timer);
+}
+
+bool runtime_stats_start(void) {
+    if (s_sample_timer == NULL) {
+        s_sample_timer = xTimerCreateStatic("rtstats", pdMS_TO_TICKS(RUNTIME_STATS_SAMPLE_PERIOD_MS),
+                                            pdTRUE, NULL, sample_timer_callback, &s_sample_timer_buffer);
+    }
+    if (s_sample_timer == NULL) {
+        return false;
+    }
+    return xTimerStart(s_sample_timer, 0) == pdPASS;
+}
+
+void runtime_stats_sample(void) {
+    uint32_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(s_status, RUNTIME_STATS_MAX_TASKS, &total);
+    uint32_t slot = (s_samples == 0) ? 0 : (s_newest + 1) % RUNTIME_STATS_WINDOW_SLOTS;
+
+    // The window changes as a whole, see take_snapshot()
+    vTaskSuspendAll();
+    for (int i = 0; i < RUNTIME_STATS_MAX_TASKS; ++i) {
+        s_entries[i].seen = false;
+    }
+
+    for (UBaseType_t t = 0; t < count; ++t) {
+        runtime_stats_entry_t* entry = find_or_add_entry(&s_status[t]);
+        if (entry == NULL) {
+            continue; // Table full; task is reported only in the kernel totals
+        }
+        entry->seen = true;
+        entry->priority = s_status[t].uxCurrentPriority;
+        entry->stack_hwm_words = (uint16_t)s_status[t].usStackHighWaterMark;
+        entry->counter[slot] = s_status[t].ulRunTimeCounter;
+    }
+
+    // Tasks that were deleted since the last sample release their entry
+    for (int i = 0; i < RUNTIME_STATS_MAX_TASKS; ++i) {
+        if (s_entries[i].in_use && !s_entries[i].seen) {
+            s_entries[i].in_use = false;
+        }
+    }
+
+    if (s_samples == 0) {
+        for (int s = 0; s < RUNTIME_STATS_WINDOW_SLOTS; ++s) {
+            s_total[s] = total;
+        }
+    }
+    s_total[slot] = total;
+    s_newest = slot;
+    if (s_samples < RUNTIME_STATS_WINDOW_SLOTS) {
+        s_samples++;
+    }
+    (void)xTaskResumeAll();
+}
+
+size_t runtime_stats_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    const runtime_stats_snapshot_t* snap = take_snapshot();
+    uint32_t newest = snap->newest;
+    uint32_t oldest = snap->oldest;
+    uint32_t window_total = snap->total[newest] - snap->total[oldest];
+    uint32_t total = snap->total[newest];
+    size_t offset = 0;
+    int n;
+
+    n = snprintf(p_buffer, len, "Task        Prio  Stack(w)  CPU%%(%lums)  CPU%%(all)\r\n",
+                 (unsigned long)((RUNTIME_STATS_WINDOW_SLOTS - 1) * RUNTIME_STATS_SAMPLE_PERIOD_MS));
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    offset = ((size_t)n < len) ? (size_t)n : len - 1;
+
+    for (int i = 0; i < RUNTIME_STATS_MAX_TASKS && offset < len - 1; ++i) {
+        const runtime_stats_entry_t* entry = &snap->entries[i];
+        if (!entry->in_use) {
+            continue;
+        }
+        uint32_t window_pm = permille(entry->counter[newest] - entry->counter[oldest], window_total);
+        uint32_t total_pm = permille(entry->counter[newest], total);
+
+        n = snprintf(&p_buffer[offset], len - offset, "%-10s  %4lu  %8u  %7lu.%lu  %8lu.%lu\r\n",
+                     entry->name, (unsigned long)entry->priority, entry->stack_hwm_words,
+                     (unsigned long)(window_pm / 10), (unsigned long)(window_pm % 10),
+                     (unsigned long)(total_pm / 10), (unsigned long)(total_pm % 10));
+        if (n < 0) {
+            break;
+        }
+        offset += ((size_t)n < len - offset) ? (size_t)n : (len - offset - 1);
+    }
+
+    return offset;
+}
+
+int runtime_stats_export(uint8_t* p_buffer, size_t len) {
+    if (p_buffer == NULL || len < sizeof(runtime_stats_export_header_t)) {
+        return -1;
+    }
+
+    const runtime_stats_snapshot_t* snap = take_snapshot();
+    uint32_t newest = snap->newest;
+    uint32_t oldest = snap->oldest;
+    runtime_stats_export_header_t header = {
+        .magic = RUNTIME_STATS_EXPORT_MAGIC,
+        .record_count = 0,
+        .record_size = sizeof(runtime_stats_record_t),
+        .counter_hz = RUNTIME_STATS_COUNTER_HZ,
+        .window_total = snap->total[newest] - snap->total[oldest],
+        .total = snap->total[newest],
+    };
+    size_t offset = sizeof(header);
+
+    for (int i = 0; i < RUNTIME_STATS_MAX_TASKS; ++i) {
+        const runtime_stats_entry_t* entry = &snap->entries[i];
+        if (!entry->in_use) {
+            continue;
+        }
+        if (offset + sizeof(runtime_stats_record_t) > len) {
+            break;
+        }
+        runtime_stats_record_t record = {
+            .task_number = (uint8_t)entry->task_number,
+            .priority = (uint8_t)entry->priority,
+            .stack_hwm_words = entry->stack_hwm_words,
+            .window_counter = entry->counter[newest] - entry->counter[oldest],
+            .total_counter = entry->counter[newest],
+        };
+        memcpy(&p_buffer[offset], &record, sizeof(record));
+        offset += sizeof(record);
+        header.record_count++;
+    }
+
+    memcpy(p_buffer, &header, sizeof(header));
+    return (int)offset;
+}
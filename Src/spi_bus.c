@@ -0,0 +1,168 @@
+/**
+ * @file      spi_bus.c
+ * @brief     FreeRTOS blocking wrapper and benchmark for asynchronous SPI transfers.
+ */
+
+#include "spi_bus.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdio.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+#define SPIN_CALIBRATION_CYCLES 100000UL
+
+_Static_assert(SPI_BUS_NOTIFY_INDEX < configTASK_NOTIFICATION_ARRAY_ENTRIES,
+               "SPI_BUS_NOTIFY_INDEX needs a task notification array entry");
+
+/**
+ * @brief Completion state shared with the callback, on the waiting task's stack.
+ */
+typedef struct {
+    TaskHandle_t task;
+    volatile int status;
+    volatile bool done;
+} spi_bus_waiter_t;
+
+// --- Static Data ---
+static uint8_t s_bench_tx[SPI_BUS_BENCH_BYTES];
+static uint8_t s_bench_rx[SPI_BUS_BENCH_BYTES];
+// Static, so a transfer that outlives the benchmark's timeout stays valid
+static spi_bus_waiter_t s_bench_waiter;
+static spi_transaction_t s_bench_txn;
+
+// --- Private Helper Functions ---
+
+static void notify_waiter(void* p_context, int status) {
+    spi_bus_waiter_t* p_waiter = (spi_bus_waiter_t*)p_context;
+    BaseType_t woken = pdFALSE;
+
+    p_waiter->status = status;
+    p_waiter->done = true;
+    if (p_waiter->task != NULL) {
+        vTaskNotifyGiveIndexedFromISR(p_waiter->task, SPI_BUS_NOTIFY_INDEX, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static uint32_t bytes_per_second(uint32_t bytes, uint32_t cycles) {
+    if (cycles == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)bytes * configCPU_CLOCK_HZ) / cycles);
+}
+
+/**
+ * @brief Spins until *p_done or for `cycles`, returning the number of
+ *        iterations. Each one reads the cycle counter, so the calibration
+ *        and the measured spin run the same loop.
+ */
+static uint32_t spin_until(volatile bool* p_done, uint32_t cycles) {
+    uint32_t loops = 0;
+    uint32_t start = DWT_CYCCNT;
+    while (!*p_done && (DWT_CYCCNT - start) < cycles) {
+        loops++;
+    }
+    return loops;
+}
+
+// --- Public API Function Implementations ---
+
+int spi_bus_transfer(spi_handle_t handle, const void* p_tx_data, void* p_rx_data, size_t len,
+                     void (*select)(bool active)) {
+    spi_bus_waiter_t waiter = {
+        .task = xTaskGetCurrentTaskHandle(),
+        .status = -1,
+        .done = false,
+    };
+    spi_transaction_t txn = {
+        .p_tx_data = p_tx_data,
+        .p_rx_data = p_rx_data,
+        .len = len,
+        .select = select,
+        .callback = notify_waiter,
+        .p_context = &waiter,
+    };
+
+    // Discard a notification left over from an earlier, unrelated give
+    (void)ulTaskNotifyTakeIndexed(SPI_BUS_NOTIFY_INDEX, pdTRUE, 0);
+
+    if (spi_transfer_async(handle, &txn) != 0) {
+        return -1;
+    }
+    while (!waiter.done) {
+        (void)ulTaskNotifyTakeIndexed(SPI_BUS_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+    }
+    return waiter.status;
+}
+
+size_t spi_bus_benchmark(spi_handle_t handle, char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+    if (spi_is_busy(handle)) {
+        int n = snprintf(p_buffer, len, "SPI bus busy\r\n");
+        return (n < 0) ? 0 : (((size_t)n < len) ? (size_t)n : len - 1);
+    }
+
+    for (uint32_t i = 0; i < SPI_BUS_BENCH_BYTES; ++i) {
+        s_bench_tx[i] = (uint8_t)i;
+    }
+
+    // Calibrate the spin loop while nothing else is running
+    volatile bool never = false;
+    vTaskSuspendAll();
+    uint32_t spin_loops = spin_until(&never, SPIN_CALIBRATION_CYCLES);
+
+    // Blocking: the CPU is busy for the whole transfer
+    uint32_t start = DWT_CYCCNT;
+    int blocking_status = spi_transfer_blocking(handle, s_bench_tx, s_bench_rx, SPI_BUS_BENCH_BYTES);
+    uint32_t blocking_cycles = DWT_CYCCNT - start;
+
+    // DMA: spin until completion; the iterations lost are the CPU cost. Give
+    // up after ten times the blocking duration.
+    s_bench_waiter = (spi_bus_waiter_t){.task = NULL, .status = -1, .done = false};
+    s_bench_txn = (spi_transaction_t){
+        .p_tx_data = s_bench_tx,
+        .p_rx_data = s_bench_rx,
+        .len = SPI_BUS_BENCH_BYTES,
+        .callback = notify_waiter,
+        .p_context = &s_bench_waiter,
+    };
+    uint64_t limit = (uint64_t)blocking_cycles * 10;
+    start = DWT_CYCCNT;
+    int async_status = spi_transfer_async(handle, &s_bench_txn);
+    uint32_t loops = 0;
+    if (async_status == 0) {
+        loops = spin_until(&s_bench_waiter.done, (limit < UINT32_MAX) ? (uint32_t)limit : UINT32_MAX);
+    }
+    uint32_t async_cycles = DWT_CYCCNT - start;
+    (void)xTaskResumeAll();
+
+    uint64_t spun = ((uint64_t)loops * SPIN_CALIBRATION_CYCLES) / (spin_loops ? spin_loops : 1);
+    uint32_t async_cpu = (spun < async_cycles) ? (uint32_t)(async_cycles - spun) : 0;
+    if (async_status == 0) {
+        async_status = s_bench_waiter.done ? s_bench_waiter.status : -1;
+    }
+
+    int n = snprintf(p_buffer, len,
+                     "SPI %u bytes   wall cycles   bytes/s   CPU cycles\r\n"
+                     "blocking      %11lu %9lu %12lu%s\r\n"
+                     "dma           %11lu %9lu %12lu%s\r\n",
+                     (unsigned)SPI_BUS_BENCH_BYTES,
+                     (unsigned long)blocking_cycles,
+                     (unsigned long)bytes_per_second(SPI_BUS_BENCH_BYTES, blocking_cycles),
+                     (unsigned long)blocking_cycles, (blocking_status == 0) ? "" : "  (failed)",
+                     (unsigned long)async_cycles,
+                     (unsigned long)bytes_per_second(SPI_BUS_BENCH_BYTES, async_cycles),
+                     (unsigned long)async_cpu, (async_status == 0) ? "" : "  (failed)");
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file      telemetry_link.c
+ * @brief     Streams audio taps, DSP cost and effect parameters over the UART.
+ */
+
+#include "telemetry_link.h"
+#include "telemetry.h"
+#include "uart_bus.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+
+#include <stdio.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+_Static_assert(AUDIO_BLOCK_FRAMES % TELEMETRY_LINK_DECIMATION == 0,
+               "TELEMETRY_LINK_DECIMATION must divide the block");
+_Static_assert(sizeof(uint32_t) + TELEMETRY_LINK_TAP_SAMPLES * sizeof(int16_t) <= TELEMETRY_MAX_PAYLOAD,
+               "An audio tap frame must fit in one telemetry frame; raise TELEMETRY_LINK_DECIMATION");
+_Static_assert(TELEMETRY_LINK_TAP_CHANNEL < AUDIO_CHANNELS, "TELEMETRY_LINK_TAP_CHANNEL out of range");
+
+/**
+ * @brief INFO payload.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t taps;
+    uint16_t decimation;
+    uint32_t sample_rate_hz;
+    uint16_t block_frames;
+    uint16_t reserved;
+    uint32_t cpu_hz;
+    uint32_t dropped;
+} telemetry_link_info_t;
+
+// --- Static Data ---
+static telemetry_t s_telemetry;             // Used with the UART bus lock held
+static volatile bool s_is_enabled = false;
+static uint32_t s_block_start;
+static uint32_t s_block;
+static volatile uint32_t s_busy_drops;      // Frames skipped because another writer held the UART
+static volatile uint32_t s_encode_cycles_max;
+
+// --- Private Helper Functions ---
+
+static size_t sink_reserve(void* p_context, uint8_t** pp_space) {
+    return uart_tx_reserve((uart_handle_t)p_context, pp_space);
+}
+
+static void sink_commit(void* p_context, size_t len) {
+    uart_tx_commit((uart_handle_t)p_context, len);
+}
+
+static size_t sink_free_space(void* p_context) {
+    return UART_BUS_TX_BYTES - uart_tx_pending((uart_handle_t)p_context);
+}
+
+static void send_info(uint32_t timestamp) {
+    const telemetry_link_info_t info = {
+        .version = TELEMETRY_LINK_VERSION,
+        .taps = TELEMETRY_LINK_TAPS,
+        .decimation = TELEMETRY_LINK_DECIMATION,
+        .sample_rate_hz = AUDIO_SAMPLING_RATE,
+        .block_frames = AUDIO_BLOCK_FRAMES,
+        .cpu_hz = configCPU_CLOCK_HZ,
+        .dropped = s_telemetry.stats.dropped + s_busy_drops,
+    };
+    const telemetry_part_t part = {&info, 1, sizeof(info), sizeof(info)};
+    (void)telemetry_send(&s_telemetry, TELEMETRY_FRAME_INFO, 0, timestamp, &part, 1);
+}
+
+static void send_tap(uint8_t tap, const int16_t* p_block, uint32_t first_index, uint32_t timestamp) {
+    const telemetry_part_t parts[2] = {
+        {&first_index, 1, sizeof(first_index), sizeof(first_index)},
+        // In place: one channel, every TELEMETRY_LINK_DECIMATION-th frame
+        {&p_block[TELEMETRY_LINK_TAP_CHANNEL], TELEMETRY_LINK_TAP_SAMPLES, sizeof(int16_t),
+         AUDIO_FRAME_BYTES * TELEMETRY_LINK_DECIMATION},
+    };
+    (void)telemetry_send(&s_telemetry, TELEMETRY_FRAME_AUDIO, tap, timestamp, parts, 2);
+}
+
+// --- Public API Function Implementations ---
+
+bool telemetry_link_init(void) {
+    uart_handle_t uart = uart_bus_get_handle();
+    if (uart == NULL) {
+        return false;
+    }
+    const telemetry_sink_t sink = {
+        .reserve = sink_reserve,
+        .commit = sink_commit,
+        .free_space = sink_free_space,
+        .p_context = uart,
+    };
+    telemetry_init(&s_telemetry, &sink);
+    s_block = 0;
+    s_busy_drops = 0;
+    s_encode_cycles_max = 0;
+    s_is_enabled = (TELEMETRY_LINK_ENABLE != 0);
+    return true;
+}
+
+void telemetry_link_set_enabled(bool enable) {
+    s_is_enabled = enable && (uart_bus_get_handle() != NULL);
+}
+
+bool telemetry_link_is_enabled(void) {
+    return s_is_enabled;
+}
+
+void telemetry_link_block_begin(void) {
+    s_block_start = DWT_CYCCNT;
+}
+
+void telemetry_link_block_end(const int16_t* p_input, const int16_t* p_output, uint8_t effect) {
+    uint32_t now = DWT_CYCCNT;
+    uint32_t cycles = now - s_block_start;
+    uint32_t block = s_block++;
+
+    if (!s_is_enabled) {
+        return;
+    }
+    if (!uart_bus_lock(0)) {
+        s_busy_drops += TELEMETRY_LINK_TAPS + 1;
+        return;
+    }
+
+    if (block % TELEMETRY_LINK_INFO_BLOCKS == 0) {
+        send_info(now);
+    }
+    uint32_t first_index = block * TELEMETRY_LINK_TAP_SAMPLES;
+    send_tap(0, p_input, first_index, s_block_start);
+    send_tap(1, p_output, first_index, s_block_start);
+
+    const telemetry_part_t parts[3] = {
+        {&block, 1, sizeof(block), sizeof(block)},
+        {&cycles, 1, sizeof(cycles), sizeof(cycles)},
+        {&effect, 1, sizeof(effect), sizeof(effect)},
+    };
+    (void)telemetry_send(&s_telemetry, TELEMETRY_FRAME_BLOCK, 0, s_block_start, parts, 3);
+    uart_bus_unlock();
+
+    uint32_t encode_cycles = DWT_CYCCNT - now;
+    if (encode_cycles > s_encode_cycles_max) {
+        s_encode_cycles_max = encode_cycles;
+    }
+}
+
+void telemetry_link_params(float param1, float param2) {
+    if (!s_is_enabled) {
+        return;
+    }
+    if (!uart_bus_lock(0)) {
+        s_busy_drops++;
+        return;
+    }
+    const float params[2] = {param1, param2};
+    const telemetry_part_t part = {params, 2, sizeof(float), sizeof(float)};
+    (void)telemetry_send(&s_telemetry, TELEMETRY_FRAME_PARAMS, 0, DWT_CYCCNT, &part, 1);
+    uart_bus_unlock();
+}
+
+void telemetry_link_get_stats(telemetry_link_stats_t* p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+    p_stats->frames = s_telemetry.stats.frames;
+    p_stats->bytes = s_telemetry.stats.bytes;
+    p_stats->dropped = s_telemetry.stats.dropped + s_busy_drops;
+    p_stats->encode_cycles_max = s_encode_cycles_max;
+}
+
+size_t telemetry_link_format(char* p_buffer, size_t len) {
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+
+    telemetry_link_stats_t stats;
+    telemetry_link_get_stats(&stats);
+    int n = snprintf(p_buffer, len,
+                     "Telemetry %s: %lu frames, %lu bytes, %lu dropped\r\n"
+                     "send cycles/block max %lu\r\n",
+                     s_is_enabled ? "on" : "off",
+                     (unsigned long)stats.frames, (unsigned long)stats.bytes, (unsigned long)stats.dropped,
+                     (unsigned long)stats.encode_cycles_max);
+    if (n < 0) {
+        p_buffer[0] = '\0';
+        return 0;
+    }
+    return ((size_t)n < len) ? (size_t)n : len - 1;
+}
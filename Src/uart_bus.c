@@ -0,0 +1,278 @@
+/**
+ * @file      uart_bus.c
+ * @brief     FreeRTOS wrapper and benchmark for the DMA-driven UART.
+ */
+
+#include "uart_bus.h"
+#include "app_objects.h"
+#include "common.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include <stdio.h>
+
+/* --- DWT cycle counter (Cortex-M4), enabled at boot by app_objects_boot_begin() --- */
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+
+#define SPIN_CALIBRATION_CYCLES 100000UL
+#define UART_BITS_PER_BYTE      10UL        // Start, 8 data, stop
+
+_Static_assert(UART_BUS_NOTIFY_INDEX < configTASK_NOTIFICATION_ARRAY_ENTRIES,
+               "UART_BUS_NOTIFY_INDEX needs a task notification array entry");
+_Static_assert((UART_BUS_RX_BYTES & (UART_BUS_RX_BYTES - 1)) == 0, "UART_BUS_RX_BYTES must be a power of two");
+_Static_assert((UART_BUS_TX_BYTES & (UART_BUS_TX_BYTES - 1)) == 0, "UART_BUS_TX_BYTES must be a power of two");
+_Static_assert(UART_BUS_BENCH_BYTES <= UART_BUS_TX_BYTES, "The benchmark must fit in the TX ring");
+
+// --- Static Data ---
+static uint8_t s_rx_ring[UART_BUS_RX_BYTES];
+static uint8_t s_tx_ring[UART_BUS_TX_BYTES];
+static uart_handle_t s_handle = NULL;
+static TaskHandle_t volatile s_rx_waiter = NULL;
+static TaskHandle_t volatile s_tx_waiter = NULL;
+static volatile bool s_is_tx_idle = true;
+static uint8_t s_bench_data[UART_BUS_BENCH_WRITE];
+
+// --- Private Helper Functions ---
+
+/** @brief Driver callback, in the USART or DMA interrupt. */
+static void on_uart_event(void* p_context, uint32_t events) {
+    BaseType_t woken = pdFALSE;
+    TaskHandle_t task;
+    (void)p_context;
+
+    if (events & UART_EVENT_TX_DONE) {
+        if (uart_tx_pending(s_handle) == 0) {
+            s_is_tx_idle = true;
+        }
+        task = s_tx_waiter;
+        if (task != NULL) {
+            vTaskNotifyGiveIndexedFromISR(task, UART_BUS_NOTIFY_INDEX, &woken);
+        }
+    }
+    if (events & UART_EVENT_RX_DATA) {
+        task = s_rx_waiter;
+        if (task != NULL) {
+            vTaskNotifyGiveIndexedFromISR(task, UART_BUS_NOTIFY_INDEX, &woken);
+        }
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Spins until *p_done or for `cycles`, returning the number of
+ *        iterations. Each one reads the cycle counter once, so the
+ *        calibration and the measured spin run the same loop, and the last
+ *        (exiting) pass is counted like the others.
+ */
+static uint32_t spin_until(volatile bool* p_done, uint32_t cycles) {
+    uint32_t loops = 0;
+    uint32_t start = DWT_CYCCNT;
+    do {
+        loops++;
+    } while (!*p_done && (DWT_CYCCNT - start) < cycles);
+    return loops;
+}
+
+static void wait_tx_drained(uint32_t timeout_ms) {
+    for (uint32_t waited_ms = 0; uart_tx_pending(s_handle) != 0 && waited_ms < timeout_ms; ++waited_ms) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+}
+
+static uint32_t per_kb(uint64_t cycles) {
+    return (uint32_t)((cycles * 1024ULL) / UART_BUS_BENCH_BYTES);
+}
+
+/**
+ * @brief Sends UART_BUS_BENCH_BYTES by DMA and measures the CPU it took.
+ * @return Number of characters appended to the report.
+ */
+static size_t bench_rate(uint32_t baud_rate, uint32_t spin_loops, char* p_buffer, size_t len) {
+    if (uart_set_baud_rate(s_handle, baud_rate) != 0) {
+        int n = snprintf(p_buffer, len, "%8lu  baud rate refused\r\n", (unsigned long)baud_rate);
+        return (n < 0) ? 0 : (((size_t)n < len) ? (size_t)n : len - 1);
+    }
+
+    uint64_t wire_cycles = ((uint64_t)UART_BUS_BENCH_BYTES * UART_BITS_PER_BYTE * configCPU_CLOCK_HZ) / baud_rate;
+    uart_stats_t before, after;
+    uart_get_stats(s_handle, &before);
+
+    // Queue everything, then spin until the ring drains; give up after twice
+    // the wire time
+    vTaskSuspendAll();
+    s_is_tx_idle = false;
+    uint32_t start = DWT_CYCCNT;
+    for (uint32_t sent = 0; sent < UART_BUS_BENCH_BYTES; sent += UART_BUS_BENCH_WRITE) {
+        (void)uart_write_async(s_handle, s_bench_data, UART_BUS_BENCH_WRITE);
+    }
+    uint32_t queue_cycles = DWT_CYCCNT - start;
+    uint64_t limit = wire_cycles * 2;
+    uint32_t loops = spin_until(&s_is_tx_idle, (limit < UINT32_MAX) ? (uint32_t)limit : UINT32_MAX);
+    uint32_t wall_cycles = DWT_CYCCNT - start;
+    (void)xTaskResumeAll();
+
+    uart_get_stats(s_handle, &after);
+    uint32_t interrupts = after.tx_chunks - before.tx_chunks;
+    uint64_t spun = ((uint64_t)loops * SPIN_CALIBRATION_CYCLES) / (spin_loops ? spin_loops : 1);
+    uint32_t cpu_cycles = (spun < wall_cycles) ? (uint32_t)(wall_cycles - spun) : 0;
+    uint32_t isr_cycles = (cpu_cycles > queue_cycles) ? cpu_cycles - queue_cycles : 0;
+
+    int n = snprintf(p_buffer, len, "%8lu %12lu %10lu %8lu %9lu%s\r\n",
+                     (unsigned long)baud_rate, (unsigned long)per_kb(wire_cycles),
+                     (unsigned long)per_kb(cpu_cycles),
+                     (unsigned long)((interrupts * 1024UL) / UART_BUS_BENCH_BYTES),
+                     (unsigned long)(interrupts ? isr_cycles / interrupts : 0),
+                     s_is_tx_idle ? "" : "  (timeout)");
+    return (n < 0) ? 0 : (((size_t)n < len) ? (size_t)n : len - 1);
+}
+
+// --- Public API Function Implementations ---
+
+int uart_bus_start(uart_handle_t handle) {
+    if (handle == NULL || s_handle != NULL) {
+        return -1;
+    }
+    const uart_async_config_t config = {
+        .p_rx_buffer = s_rx_ring,
+        .rx_size = sizeof(s_rx_ring),
+        .p_tx_buffer = s_tx_ring,
+        .tx_size = sizeof(s_tx_ring),
+        .callback = on_uart_event,
+        .p_context = NULL,
+    };
+    // Publish the handle first: the callback may run as soon as RX starts
+    s_handle = handle;
+    if (uart_start_async(handle, &config) != 0) {
+        s_handle = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+uart_handle_t uart_bus_get_handle(void) {
+    return s_handle;
+}
+
+size_t uart_bus_write(const void* p_data, size_t len, uint32_t timeout_ms) {
+    const uint8_t* p_bytes = (const uint8_t*)p_data;
+    size_t queued = 0;
+
+    if (s_handle == NULL || p_data == NULL || len == 0) {
+        return 0;
+    }
+
+    const TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    TickType_t start = xTaskGetTickCount();
+    if (xSemaphoreTake(uartTxMutexHandle, timeout) != pdTRUE) {
+        return 0;
+    }
+
+    s_tx_waiter = xTaskGetCurrentTaskHandle();
+    for (;;) {
+        // Discard a give from an earlier wait before checking for space, so
+        // a give after the check is the one waited for
+        (void)ulTaskNotifyTakeIndexed(UART_BUS_NOTIFY_INDEX, pdTRUE, 0);
+        queued += uart_write_async(s_handle, &p_bytes[queued], len - queued);
+        if (queued == len) {
+            break;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            break;
+        }
+        (void)ulTaskNotifyTakeIndexed(UART_BUS_NOTIFY_INDEX, pdTRUE, timeout - elapsed);
+    }
+    s_tx_waiter = NULL;
+
+    (void)xSemaphoreGive(uartTxMutexHandle);
+    return queued;
+}
+
+bool uart_bus_lock(uint32_t timeout_ms) {
+    if (s_handle == NULL) {
+        return false;
+    }
+    return xSemaphoreTake(uartTxMutexHandle, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+void uart_bus_unlock(void) {
+    (void)xSemaphoreGive(uartTxMutexHandle);
+}
+
+size_t uart_bus_read_timeout(void* p_data, size_t len, uint32_t timeout_ms) {
+    if (s_handle == NULL || p_data == NULL || len == 0) {
+        return 0;
+    }
+
+    const TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    TickType_t start = xTaskGetTickCount();
+    size_t count;
+
+    s_rx_waiter = xTaskGetCurrentTaskHandle();
+    for (;;) {
+        (void)ulTaskNotifyTakeIndexed(UART_BUS_NOTIFY_INDEX, pdTRUE, 0);
+        count = uart_read_async(s_handle, p_data, len);
+        if (count != 0) {
+            break;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            break;
+        }
+        (void)ulTaskNotifyTakeIndexed(UART_BUS_NOTIFY_INDEX, pdTRUE, timeout - elapsed);
+    }
+    s_rx_waiter = NULL;
+    return count;
+}
+
+size_t uart_bus_benchmark(char* p_buffer, size_t len) {
+    static const uint32_t rates[] = {115200, 2000000};
+
+    if (p_buffer == NULL || len == 0) {
+        return 0;
+    }
+    int n;
+    if (s_handle == NULL) {
+        n = snprintf(p_buffer, len, "UART bus not started\r\n");
+        return (n < 0) ? 0 : (((size_t)n < len) ? (size_t)n : len - 1);
+    }
+
+    for (uint32_t i = 0; i < UART_BUS_BENCH_WRITE; ++i) {
+        s_bench_data[i] = (uint8_t)('A' + (i % 26));
+    }
+    s_bench_data[UART_BUS_BENCH_WRITE - 2] = '\r';
+    s_bench_data[UART_BUS_BENCH_WRITE - 1] = '\n';
+
+    // Hold off other writers, and let their output drain at the current rate
+    if (xSemaphoreTake(uartTxMutexHandle, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        n = snprintf(p_buffer, len, "UART bus busy\r\n");
+        return (n < 0) ? 0 : (((size_t)n < len) ? (size_t)n : len - 1);
+    }
+    wait_tx_drained(1000);
+    uint32_t original_rate = uart_get_baud_rate(s_handle);
+
+    // Calibrate the spin loop while nothing else is running
+    volatile bool never = false;
+    vTaskSuspendAll();
+    uint32_t spin_loops = spin_until(&never, SPIN_CALIBRATION_CYCLES);
+    (void)xTaskResumeAll();
+
+    size_t offset = 0;
+    n = snprintf(p_buffer, len,
+                 "UART per KB, written %u bytes at a time\r\n"
+                 "    baud  blocking cyc   dma cyc    irqs  cyc/irq\r\n",
+                 (unsigned)UART_BUS_BENCH_WRITE);
+    if (n > 0) {
+        offset = ((size_t)n < len) ? (size_t)n : len - 1;
+    }
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]) && offset < len - 1; ++i) {
+        offset += bench_rate(rates[i], spin_loops, &p_buffer[offset], len - offset);
+    }
+
+    wait_tx_drained(1000);
+    (void)uart_set_baud_rate(s_handle, original_rate);
+    (void)xSemaphoreGive(uartTxMutexHandle);
+    return offset;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file      test_app_objects.c
+ * @brief     Host test of the static kernel object table and its boot report.
+ *
+ * @details   app_objects.c runs unchanged, built once per audio pipeline. The
+ *            host FreeRTOS has no heap and no dynamic create calls, so the
+ *            build only links if every object comes from static storage. The
+ *            *CreateStatic() calls below record what they are given, and the
+ *            DWT cycle counter is a register fake that wraps during boot.
+ *            The test checks:
+ *            - objects are created in dependency order, from distinct
+ *              storage, with the table's depths, priorities and names;
+ *            - a failed create stops app_objects_create() at once;
+ *            - the boot time is measured across the wrap;
+ *            - the RAM report lists every object, and its rows add up to
+ *              the static total within the budget;
+ *            - the report truncates cleanly in any buffer.
+ */
+
+#include "app_objects.h"
+#include "common.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DWT_CTRL                MMIO32(DWT_BASE + 0x000)
+#define DWT_CYCCNT              MMIO32(DWT_BASE + 0x004)
+#define DWT_LAR                 MMIO32(DWT_BASE + CORESIGHT_LAR_OFFSET)
+#define SCB_DEMCR               MMIO32(SCS_BASE + 0xDFC)
+
+#define BOOT_START_CYCLES       0xFFFF0000UL    // Wraps during the boot
+#define BOOT_US                 2500UL
+#define HEAP_FREE               (configTOTAL_HEAP_SIZE - 512)
+#define MAX_OBJECTS             16
+#define REPORT_BYTES_COLUMN     20              // "%-6s  %-10s  " in app_objects_format()
+
+// --- Test Data ---
+
+typedef struct {
+    char kind;                      // 't'ask, 'q'ueue, 's'tream, 'm'utex
+    const char* name;
+    const void* storage;
+    const void* control;
+    uint32_t size;                  // Stack depth, or storage bytes
+    UBaseType_t priority;
+} created_t;
+
+static created_t s_created[MAX_OBJECTS];
+static size_t s_created_count = 0;
+static size_t s_fail_at = 0;        // Fail the create call with this 1-based index, 0 for none
+static const char* s_trace_names[MAX_OBJECTS];
+static size_t s_trace_count = 0;
+
+/** @brief The task table, expanded the same way as in app_objects.c. */
+typedef struct {
+    const char* name;
+    uint32_t depth;
+    UBaseType_t priority;
+} table_task_t;
+
+#define TABLE_TASK(name, fn, label, depth, prio)    { label, depth, prio },
+static const table_task_t s_table_tasks[] = { APP_TASK_TABLE(TABLE_TASK) };
+#define TABLE_TASK_COUNT        (sizeof(s_table_tasks) / sizeof(s_table_tasks[0]))
+
+#define COUNT_ONE(...)          + 1
+#define TABLE_OBJECT_COUNT      (0 APP_TASK_TABLE(COUNT_ONE) APP_STREAM_TABLE(COUNT_ONE) \
+                                   APP_QUEUE_TABLE(COUNT_ONE) APP_MUTEX_TABLE(COUNT_ONE))
+
+// --- Stubs for the kernel and the task entries ---
+
+static void* record(char kind, const char* name, const void* storage, const void* control,
+                    uint32_t size, UBaseType_t priority) {
+    if (s_created_count >= MAX_OBJECTS) {
+        return NULL;
+    }
+    created_t* p_entry = &s_created[s_created_count++];
+    *p_entry = (created_t){kind, name, storage, control, size, priority};
+    return (s_created_count == s_fail_at) ? NULL : (void*)p_entry;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* pcName, uint32_t ulStackDepth,
+                               void* pvParameters, UBaseType_t uxPriority, StackType_t* puxStackBuffer,
+                               StaticTask_t* pxTaskBuffer) {
+    TEST_CHECK(pxTaskCode != NULL && pvParameters == NULL);
+    return (TaskHandle_t)record('t', pcName, puxStackBuffer, pxTaskBuffer, ulStackDepth, uxPriority);
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t uxQueueLength, UBaseType_t uxItemSize,
+                                 uint8_t* pucQueueStorage, StaticQueue_t* pxQueueBuffer) {
+    return (QueueHandle_t)record('q', NULL, pucQueueStorage, pxQueueBuffer,
+                                 (uint32_t)(uxQueueLength * uxItemSize), 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxMutexBuffer) {
+    return (SemaphoreHandle_t)record('m', NULL, NULL, pxMutexBuffer, 0, 0);
+}
+
+StreamBufferHandle_t xStreamBufferCreateStatic(size_t xBufferSizeBytes, size_t xTriggerLevelBytes,
+                                               uint8_t* pucStreamBufferStorageArea,
+                                               StaticStreamBuffer_t* pxStaticStreamBuffer) {
+    TEST_CHECK(xTriggerLevelBytes >= 1 && xTriggerLevelBytes < xBufferSizeBytes);
+    return (StreamBufferHandle_t)record('s', NULL, pucStreamBufferStorageArea, pxStaticStreamBuffer,
+                                        (uint32_t)xBufferSizeBytes, 0);
+}
+
+size_t xPortGetFreeHeapSize(void) {
+    return HEAP_FREE;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    return HEAP_FREE;
+}
+
+void trace_name_object(const void* p_object, const char* p_name) {
+    TEST_CHECK(p_object != NULL);
+    if (s_trace_count < MAX_OBJECTS) {
+        s_trace_names[s_trace_count++] = p_name;
+    }
+}
+
+#define DEFINE_TASK_ENTRY(name, fn, label, depth, prio) \
+    void fn(void* argument) { (void)argument; }
+APP_TASK_TABLE(DEFINE_TASK_ENTRY)
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+static void reset_created(size_t fail_at) {
+    s_created_count = 0;
+    s_trace_count = 0;
+    s_fail_at = fail_at;
+}
+
+static int kind_rank(char kind) {
+    return (kind == 'm') ? 0 : (kind == 'q') ? 1 : (kind == 's') ? 2 : 3;
+}
+
+// --- Tests ---
+
+static void test_create(void) {
+    reset_created(0);
+    TEST_CHECK(app_objects_create());
+    TEST_CHECK(s_created_count == TABLE_OBJECT_COUNT);
+
+    // Mutexes, then queues, then stream buffers, then the tasks that use them
+    for (size_t i = 1; i < s_created_count; ++i) {
+        TEST_CHECK(kind_rank(s_created[i - 1].kind) <= kind_rank(s_created[i].kind));
+    }
+
+    // Every object has its own control block and storage
+    for (size_t i = 0; i < s_created_count; ++i) {
+        TEST_CHECK(s_created[i].control != NULL);
+        TEST_CHECK(s_created[i].kind == 'm' || s_created[i].storage != NULL);
+        for (size_t j = 0; j < i; ++j) {
+            TEST_CHECK(s_created[i].control != s_created[j].control);
+            TEST_CHECK(s_created[i].storage == NULL || s_created[i].storage != s_created[j].storage);
+        }
+    }
+
+    // The tasks, in table order, with the table's parameters
+    size_t first_task = s_created_count - TABLE_TASK_COUNT;
+    for (size_t i = 0; i < TABLE_TASK_COUNT; ++i) {
+        const created_t* p_task = &s_created[first_task + i];
+        TEST_CHECK(p_task->kind == 't');
+        TEST_CHECK(strcmp(p_task->name, s_table_tasks[i].name) == 0);
+        TEST_CHECK(p_task->size == s_table_tasks[i].depth && p_task->size >= configMINIMAL_STACK_SIZE);
+        TEST_CHECK(p_task->priority == s_table_tasks[i].priority && p_task->priority < configMAX_PRIORITIES);
+    }
+
+    // Every non-task object is named for the trace
+    TEST_CHECK(s_trace_count == first_task);
+    for (size_t i = 0; i < s_trace_count; ++i) {
+        TEST_CHECK(s_trace_names[i] != NULL && s_trace_names[i][0] != '\0');
+    }
+
+    uint32_t stack_words = 0;
+    StaticTask_t* p_tcb = NULL;
+    StackType_t* p_stack = NULL;
+    vApplicationGetIdleTaskMemory(&p_tcb, &p_stack, &stack_words);
+    TEST_CHECK(p_tcb != NULL && p_stack != NULL && stack_words == configMINIMAL_STACK_SIZE);
+    vApplicationGetTimerTaskMemory(&p_tcb, &p_stack, &stack_words);
+    TEST_CHECK(p_tcb != NULL && p_stack != NULL && stack_words == configTIMER_TASK_STACK_DEPTH);
+}
+
+static void test_create_failure(void) {
+    for (size_t fail_at = 1; fail_at <= TABLE_OBJECT_COUNT; ++fail_at) {
+        reset_created(fail_at);
+        TEST_CHECK(!app_objects_create());
+        TEST_CHECK(s_created_count == fail_at);
+    }
+    reset_created(0);
+    TEST_CHECK(app_objects_create());
+}
+
+static void test_boot_time(void) {
+    TEST_CHECK(app_objects_get_boot_time_us() == 0);
+    DWT_CYCCNT = BOOT_START_CYCLES;
+    app_objects_boot_begin();
+    TEST_CHECK(SCB_DEMCR & BIT24);
+    TEST_CHECK(DWT_LAR == CORESIGHT_LAR_KEY && (DWT_CTRL & BIT0));
+    DWT_CYCCNT = (uint32_t)(BOOT_START_CYCLES + BOOT_US * (configCPU_CLOCK_HZ / 1000000UL));
+    app_objects_boot_end();
+    TEST_CHECK(app_objects_get_boot_time_us() == BOOT_US);
+}
+
+static void test_report(void) {
+    char report[1024];
+    size_t len = app_objects_format(report, sizeof(report));
+    printf("%s", report);
+    TEST_CHECK(len > 0 && len < sizeof(report) - 1 && report[len] == '\0');
+
+    // A header, a row per object plus the idle and timer tasks, and two summary lines
+    size_t rows = 0;
+    unsigned long row_bytes = 0;
+    char* p_save = NULL;
+    char copy[sizeof(report)];
+    memcpy(copy, report, len + 1);
+    for (char* p_line = strtok_r(copy, "\r\n", &p_save); p_line != NULL; p_line = strtok_r(NULL, "\r\n", &p_save)) {
+        if (strncmp(p_line, "task ", 5) == 0 || strncmp(p_line, "stream ", 7) == 0 ||
+            strncmp(p_line, "queue ", 6) == 0 || strncmp(p_line, "mutex ", 6) == 0) {
+            TEST_CHECK(strlen(p_line) > REPORT_BYTES_COLUMN);
+            rows++;
+            row_bytes += strtoul(p_line + REPORT_BYTES_COLUMN, NULL, 10);
+        }
+    }
+    TEST_CHECK(rows == TABLE_OBJECT_COUNT + 2);
+    TEST_CHECK(row_bytes == app_objects_get_static_ram());
+    TEST_CHECK(app_objects_get_static_ram() <= APP_OBJECTS_RAM_BUDGET);
+    for (size_t i = 0; i < TABLE_TASK_COUNT; ++i) {
+        TEST_CHECK(strstr(report, s_table_tasks[i].name) != NULL);
+    }
+
+    char expected[128];
+    snprintf(expected, sizeof(expected), "Static: %lu of %lu bytes  Heap: %lu free at boot",
+             (unsigned long)app_objects_get_static_ram(), (unsigned long)APP_OBJECTS_RAM_BUDGET,
+             (unsigned long)HEAP_FREE);
+    TEST_CHECK(strstr(report, expected) != NULL);
+    snprintf(expected, sizeof(expected), "Boot: %lu us\r\n", BOOT_US);
+    TEST_CHECK(strstr(report, expected) != NULL);
+
+    // Any buffer gets the longest prefix that fits, terminated
+    for (size_t size = 1; size <= len + 1; ++size) {
+        char small[sizeof(report)];
+        memset(small, 'x', sizeof(small));
+        size_t n = app_objects_format(small, size);
+        TEST_CHECK(n == ((size - 1 < len) ? size - 1 : len));
+        TEST_CHECK(small[n] == '\0' && memcmp(small, report, n) == 0 && small[size] == 'x');
+    }
+    TEST_CHECK(app_objects_format(NULL, sizeof(report)) == 0);
+    TEST_CHECK(app_objects_format(report, 0) == 0);
+}
+
+int main(void) {
+    TEST_CHECK(reg_fake_map(DWT_BASE, 0x1000));
+    TEST_CHECK(reg_fake_map(SCS_BASE, 0x1000));
+
+    test_boot_time();
+    test_create();
+    test_create_failure();
+    test_report();
+    return TEST_EXIT();
+}
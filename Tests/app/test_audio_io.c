@@ -0,0 +1,203 @@
+/**
+ * @file      test_audio_io.c
+ * @brief     Host test of the audio I/O streams with off-nominal codec clocks.
+ *
+ * @details   audio_io.c runs unchanged on the POSIX I2S and DMA ports, built
+ *            once per topology. The simulated codec clocks are set off by
+ *            the ppm given on the command line, and the DWT cycle counter
+ *            follows the simulator's timeline at 168 MHz: an independent
+ *            reference, unlike the board, where everything comes from one
+ *            crystal.
+ *
+ *            - Full duplex, `test_audio_io <ppm>`: capture and playback run
+ *              from the one clock, so at any rate the number of filled RX
+ *              halves less the freed TX halves must stay within [-1, 0]
+ *              at every callback (TX is reported first), and the offset
+ *              and drift stay 0.
+ *            - Split, `test_audio_io <rx ppm> <tx ppm>`: after a fixed time
+ *              the block offset must be the one the two rates predict, and
+ *              the drift measured from the block timestamps their ratio.
+ *              With both at 0 the drift is the one expected from the shared
+ *              PLLI2S, which is 0 at 48 kHz.
+ */
+
+#include "audio_io.h"
+#include "i2s_port_posix.h"
+#include "rcc.h"
+#include "common.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CPU_HZ              168000000ULL
+#define RUN_SECONDS         20
+#define RUN_FRAMES          ((RUN_SECONDS + 1) * AUDIO_SAMPLING_RATE)
+#define DWT_CYCCNT_ADDR     (DWT_BASE + 0x004)
+
+// --- Test Data ---
+static int16_t s_rx_buffer[2 * AUDIO_BLOCK_SAMPLES];
+static int16_t s_tx_buffer[2 * AUDIO_BLOCK_SAMPLES];
+
+static uint32_t s_rx_ready = 0;
+static uint32_t s_tx_free = 0;
+static int32_t s_fill_min = 0;
+static int32_t s_fill_max = 0;
+static uint32_t s_wrong_half = 0;
+static bool s_sampled = false;
+static audio_io_stats_t s_at_end;
+
+// --- Stubs for the RCC driver: a 1 MHz PLL input, as on the board ---
+
+static uint32_t s_plli2s_hz = 0;
+
+void rcc_enable_peripheral_clock(peripheral_id_t id) {
+    (void)id;
+}
+
+bool rcc_is_plli2s_valid(uint32_t plli2sn, uint32_t plli2sr) {
+    uint64_t vco_hz = 1000000ULL * plli2sn;
+    return plli2sn >= 50 && plli2sn <= 432 && plli2sr >= 2 && plli2sr <= 7 &&
+           vco_hz >= 100000000ULL && vco_hz <= 432000000ULL && vco_hz / plli2sr <= 192000000ULL;
+}
+
+bool rcc_configure_plli2s(uint32_t plli2sn, uint32_t plli2sr) {
+    if (!rcc_is_plli2s_valid(plli2sn, plli2sr)) {
+        return false;
+    }
+    s_plli2s_hz = 1000000UL * plli2sn / plli2sr;
+    return true;
+}
+
+uint32_t rcc_get_pll_input_frequency(void) {
+    return 1000000UL;
+}
+
+uint32_t rcc_get_plli2s_frequency(void) {
+    return s_plli2s_hz;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+/** @brief Sets DWT_CYCCNT from the simulated time before audio_io.c reads it. */
+static void dwt_hook(uintptr_t address, bool is_write) {
+    if (address == DWT_CYCCNT_ADDR && !is_write) {
+        MMIO32(DWT_CYCCNT_ADDR) = (uint32_t)(i2s_port_posix_time_ns() * CPU_HZ / 1000000000ULL);
+    }
+}
+
+static void note_fill(void) {
+    int32_t fill = (int32_t)(s_rx_ready - s_tx_free);
+    s_fill_min = (fill < s_fill_min) ? fill : s_fill_min;
+    s_fill_max = (fill > s_fill_max) ? fill : s_fill_max;
+}
+
+/** @brief Runs in the simulated DMA interrupt, like the pipeline's handlers. */
+static void on_rx_ready(uint32_t half) {
+    if (half != s_rx_ready % 2) {
+        s_wrong_half++;
+    }
+    s_rx_ready++;
+    note_fill();
+}
+
+static void on_tx_free(uint32_t half) {
+    if (half != s_tx_free % 2) {
+        s_wrong_half++;
+    }
+    s_tx_free++;
+    note_fill();
+    if (!s_sampled && i2s_port_posix_time_ns() >= RUN_SECONDS * 1000000000ULL) {
+        audio_io_get_stats(&s_at_end);
+        s_sampled = true;
+    }
+}
+
+// --- Tests ---
+
+#if (AUDIO_IO_FULL_DUPLEX == 1)
+static void test_streams(int32_t ppm) {
+    TEST_CHECK(i2s_port_posix_set_clock_ppm(3, ppm));
+    TEST_CHECK(i2s_port_posix_attach_wav(3, NULL, NULL, RUN_FRAMES));
+    TEST_CHECK(audio_io_start(s_rx_buffer, s_tx_buffer, on_rx_ready, on_tx_free));
+    TEST_CHECK(i2s_port_posix_wait(3) == RUN_FRAMES);
+
+    audio_io_stats_t stats;
+    audio_io_get_stats(&stats);
+    uint32_t blocks = RUN_FRAMES / AUDIO_BLOCK_FRAMES;
+    TEST_CHECK(stats.full_duplex);
+    TEST_CHECK(stats.rx_blocks == blocks && stats.tx_blocks == blocks);
+    TEST_CHECK(stats.block_offset == 0 && stats.drift_ppm == 0 && stats.expected_drift_ppm == 0);
+    TEST_CHECK(stats.dma_errors == 0);
+    TEST_CHECK(s_rx_ready == blocks && s_tx_free == blocks);
+    TEST_CHECK(s_fill_min >= -1 && s_fill_max <= 0);
+    TEST_CHECK(s_wrong_half == 0);
+
+    // The clock really ran off: the run took longer or shorter by `ppm`
+    double nominal_ns = RUN_FRAMES * 1e12 / stats.out_rate_mhz;
+    double run_ppm = (nominal_ns / (double)i2s_port_posix_time_ns() - 1.0) * 1e6;
+    TEST_CHECK(fabs(run_ppm - ppm) < 1.0);
+
+    printf("full duplex at %+ld ppm: %u blocks, fill %ld..%ld, clock %+.1f ppm\n", (long)ppm,
+           (unsigned)stats.rx_blocks, (long)s_fill_min, (long)s_fill_max, run_ppm);
+}
+#else
+static void test_streams(int32_t rx_ppm, int32_t tx_ppm) {
+    TEST_CHECK(i2s_port_posix_set_clock_ppm(2, rx_ppm));
+    TEST_CHECK(i2s_port_posix_set_clock_ppm(3, tx_ppm));
+    TEST_CHECK(i2s_port_posix_attach_wav(2, NULL, NULL, RUN_FRAMES));
+    TEST_CHECK(i2s_port_posix_attach_wav(3, NULL, NULL, RUN_FRAMES));
+    TEST_CHECK(audio_io_start(s_rx_buffer, s_tx_buffer, on_rx_ready, on_tx_free));
+    TEST_CHECK(i2s_port_posix_wait(2) == RUN_FRAMES);
+    TEST_CHECK(i2s_port_posix_wait(3) == RUN_FRAMES);
+    TEST_CHECK(s_sampled);
+
+    const audio_io_stats_t* p_stats = &s_at_end;
+    TEST_CHECK(!p_stats->full_duplex);
+    TEST_CHECK(p_stats->dma_errors == 0);
+    TEST_CHECK(s_wrong_half == 0);
+    TEST_CHECK(p_stats->expected_drift_ppm == 0);       // Both prescalers hit 47991.07 Hz
+
+    // RX gains on TX by the rate ratio, in blocks over the run
+    double ratio = (1.0 + rx_ppm * 1e-6) / (1.0 + tx_ppm * 1e-6);
+    double expected_ppm = (ratio - 1.0) * 1e6 + p_stats->expected_drift_ppm;
+    double expected_offset = (double)p_stats->tx_blocks * (ratio - 1.0);
+    TEST_CHECK(fabs(p_stats->block_offset - expected_offset) <= 1.0);
+    TEST_CHECK(fabs(p_stats->drift_ppm - expected_ppm) <= 2.0);
+
+    printf("split at RX %+ld / TX %+ld ppm after %d s: offset %ld (%.1f), drift %ld ppm (%.1f), "
+           "expected from PLLI2S %ld ppm\n", (long)rx_ppm, (long)tx_ppm, RUN_SECONDS,
+           (long)p_stats->block_offset, expected_offset, (long)p_stats->drift_ppm, expected_ppm,
+           (long)p_stats->expected_drift_ppm);
+}
+#endif
+
+int main(int argc, char** argv) {
+    TEST_CHECK(reg_fake_map(DWT_BASE, 0x1000));
+    TEST_CHECK(reg_fake_trap(DWT_BASE, 0x1000, dwt_hook));
+
+#if (AUDIO_IO_FULL_DUPLEX == 1)
+    TEST_CHECK(argc == 2);
+    if (argc == 2) {
+        test_streams((int32_t)strtol(argv[1], NULL, 10));
+    }
+#else
+    TEST_CHECK(argc == 3);
+    if (argc == 3) {
+        test_streams((int32_t)strtol(argv[1], NULL, 10), (int32_t)strtol(argv[2], NULL, 10));
+    }
+#endif
+
+    char report[256];
+    TEST_CHECK(audio_io_format(report, sizeof(report)) > 0);
+    printf("%s", report);
+    reg_fake_untrap();
+    return TEST_EXIT();
+}
@@ -0,0 +1,590 @@
+/**
+ * @file      test_console.c
+ * @brief     Host test of the console sharing a simulated CPU with the audio path.
+ *
+ * @details   console.c, the shell and the CLI run unchanged. uart_bus and the
+ *            audio application are stand-ins on a cycle timeline at 168 MHz,
+ *            where a priority scheduler shares the CPU between two tasks:
+ *
+ *            - dspTask, above the console: a block arrives every
+ *              AUDIO_BLOCK_FRAMES and takes DSP_LOAD_PERCENT of a block
+ *              period to process. A block that arrives while the previous one
+ *              is still unprocessed replaces it and counts an xrun, as in
+ *              main.c.
+ *            - The console at tskIDLE_PRIORITY, preempted whenever a block is
+ *              pending. Its work is charged at the UART, CYCLES_PER_BYTE for
+ *              each byte it reads or writes, and the TX ring drains at the
+ *              line rate, blocking the writer while it is full. Only what
+ *              keeps the DSP out is charged without preemption: the
+ *              scheduler suspended for the task list of "stats" and the
+ *              runtime stats snapshot, and the parameter mutex held for a
+ *              copy.
+ *
+ *            - Without input the DSP finishes every block DSP_CYCLES after it
+ *              arrives.
+ *            - Every command, completion, recall and long reports, typed at
+ *              115200 baud with the DSP at 90 % load: the output is complete,
+ *              the xrun count stays 0 and the worst block latency grows by no
+ *              more than the longest section the console kept the DSP out.
+ *            - A command that suspends the scheduler for two block periods
+ *              does cause xruns, so the simulation sees interference.
+ */
+
+#include "console.h"
+#include "uart_bus.h"
+#include "audio_io.h"
+#include "runtime_stats.h"
+#include "app_objects.h"
+#include "low_power.h"
+#include "motion.h"
+#include "telemetry_link.h"
+#include "presets.h"
+#include "kvstore.h"
+#include "dsp_profile.h"
+#include "clock_governor.h"
+#include "event_sched.h"
+#include "flash.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_CLI.h"
+#include "FreeRTOS_Shell.h"
+
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CPU_HZ              168000000ULL
+#define BLOCK_CYCLES        ((uint64_t)AUDIO_BLOCK_FRAMES * CPU_HZ / AUDIO_SAMPLING_RATE)
+#define DSP_LOAD_PERCENT    90
+#define DSP_CYCLES          (BLOCK_CYCLES * DSP_LOAD_PERCENT / 100)
+#define BYTE_CYCLES         (10 * CPU_HZ / 115200)          // One 10-bit frame at 115200 baud
+#define CYCLES_PER_BYTE     400                             // Console work per byte read or written
+#define TASK_WALK_CYCLES    300                             // Scheduler suspended, per task listed
+#define SNAPSHOT_CYCLES     2000                            // Runtime stats window copy
+#define MUTEX_COPY_CYCLES   100                             // Parameter mutex held for a copy
+#define THINK_CYCLES        (CPU_HZ / 20)                   // Between the prompt and the next line
+#define REPORT_BYTES        1500
+#define OUTPUT_BYTES        65536
+
+// --- Test Data ---
+// Scheduler and DSP
+static uint64_t s_now = 0;
+static uint64_t s_next_block = BLOCK_CYCLES;
+static uint64_t s_block_arrived;
+static uint64_t s_dsp_left = 0;                 // Work left on the pending block
+static uint32_t s_blocks = 0;
+static uint32_t s_xruns = 0;
+static uint64_t s_worst_latency = 0;
+static uint32_t s_suspended = 0;                // vTaskSuspendAll() depth
+static uint64_t s_locked_since;
+static uint64_t s_worst_lockout = 0;
+
+// UART: lines typed one after the other, output captured
+static const char* const* s_script;
+static size_t s_script_lines;
+static size_t s_line = 0;
+static size_t s_line_pos = 0;
+static uint64_t s_line_at;                      // When the current line is in the RX ring
+static bool s_line_started = false;
+static uint32_t s_tx_level = 0;
+static uint64_t s_tx_drained_at = 0;
+static char s_output[OUTPUT_BYTES];
+static size_t s_output_len = 0;
+static jmp_buf s_script_done;
+static char s_dummy_uart;
+
+// Application state behind console_audio_t
+static const char* const s_effect_names[] = {"bypass", "echo", "flanger", "tremolo"};
+static const char* const s_event_names[] = {"lfo", "param1", "param2"};
+static uint32_t s_effect = 0;
+static float s_param1 = 0.5f, s_param2 = 0.5f;
+static bool s_held = false;
+static uint32_t s_events = 0;
+static bool s_telemetry = false;
+static uint32_t s_accelerator = FLASH_ACCEL_ALL;
+static clock_governor_mode_t s_clock_mode = CLOCK_GOVERNOR_AUTO;
+
+static const struct {
+    const char* p_name;
+    UBaseType_t priority;
+} s_tasks[] = {
+    {"audioIn", 4}, {"audioOut", 4}, {"dsp", 3}, {"sensor", 1}, {"ui", 0}, {"console", 0}, {"IDLE", 0}, {"Tmr Svc", 4},
+};
+
+// --- Helpers: the scheduler ---
+
+static void block_arrives(void) {
+    s_blocks++;
+    if (s_dsp_left != 0) {
+        s_xruns++;                          // The stale block is replaced
+    }
+    s_dsp_left = DSP_CYCLES;
+    s_block_arrived = s_next_block;
+    s_next_block += BLOCK_CYCLES;
+}
+
+/**
+ * @brief Lets the console run for `console_cycles`, or wait until `until`,
+ *        with the DSP taking the CPU whenever it has a block.
+ */
+static void run_cpu(uint64_t console_cycles, uint64_t until) {
+    for (;;) {
+        while (s_next_block <= s_now) {
+            block_arrives();
+        }
+        uint64_t slice = s_next_block - s_now;
+        if (s_dsp_left != 0) {
+            uint64_t run = (s_dsp_left < slice) ? s_dsp_left : slice;
+            s_now += run;
+            s_dsp_left -= run;
+            if (s_dsp_left == 0 && s_now - s_block_arrived > s_worst_latency) {
+                s_worst_latency = s_now - s_block_arrived;
+            }
+        } else if (console_cycles != 0) {
+            uint64_t run = (console_cycles < slice) ? console_cycles : slice;
+            s_now += run;
+            console_cycles -= run;
+        } else if (s_now < until) {
+            s_now = (until < s_next_block) ? until : s_next_block;
+        } else {
+            return;
+        }
+    }
+}
+
+/** @brief Charges console work: preemptible unless the scheduler is suspended. */
+static void charge(uint64_t cycles) {
+    if (s_suspended == 0) {
+        run_cpu(cycles, 0);
+        return;
+    }
+    uint64_t end = s_now + cycles;
+    while (s_next_block <= end) {
+        s_now = s_next_block;
+        block_arrives();
+    }
+    s_now = end;
+}
+
+/** @brief Holds the DSP out for a copy under the parameter mutex. */
+static void param_copy(void) {
+    vTaskSuspendAll();
+    charge(MUTEX_COPY_CYCLES);
+    (void)xTaskResumeAll();
+}
+
+// --- Helpers: the UART ---
+
+static void tx_update(void) {
+    uint64_t drained = (s_now - s_tx_drained_at) / BYTE_CYCLES;
+    if (drained >= s_tx_level) {
+        s_tx_level = 0;
+        s_tx_drained_at = s_now;
+    } else {
+        s_tx_level -= (uint32_t)drained;
+        s_tx_drained_at += drained * BYTE_CYCLES;
+    }
+}
+
+/** @brief Schedules the next line once the output has drained and the user has read it. */
+static void start_line(void) {
+    tx_update();
+    uint64_t idle_at = s_tx_drained_at + (uint64_t)s_tx_level * BYTE_CYCLES;
+    uint64_t start = ((idle_at > s_now) ? idle_at : s_now) + THINK_CYCLES;
+    // Published on the idle line, one frame after the last byte
+    s_line_at = start + (strlen(s_script[s_line]) + 1) * BYTE_CYCLES;
+    s_line_pos = 0;
+    s_line_started = true;
+}
+
+static void run_script(const char* const* p_lines, size_t count) {
+    s_script = p_lines;
+    s_script_lines = count;
+    s_line = 0;
+    s_line_started = false;
+    if (setjmp(s_script_done) == 0) {
+        vTaskConsole(NULL);
+    }
+}
+
+// --- Stubs for uart_bus ---
+
+uart_handle_t uart_bus_get_handle(void) {
+    return (uart_handle_t)(void*)&s_dummy_uart;
+}
+
+size_t uart_bus_read_timeout(void* p_data, size_t len, uint32_t timeout_ms) {
+    if (s_line >= s_script_lines) {
+        tx_update();
+        run_cpu(0, s_now + (uint64_t)s_tx_level * BYTE_CYCLES);
+        longjmp(s_script_done, 1);
+    }
+    if (!s_line_started) {
+        start_line();
+    }
+
+    uint64_t deadline = s_now + (uint64_t)timeout_ms * (CPU_HZ / 1000);
+    run_cpu(0, (s_line_at < deadline) ? s_line_at : deadline);
+    if (s_now < s_line_at) {
+        return 0;
+    }
+
+    const char* p_line = s_script[s_line];
+    size_t n = strlen(p_line) - s_line_pos;
+    n = (n < len) ? n : len;
+    memcpy(p_data, &p_line[s_line_pos], n);
+    s_line_pos += n;
+    if (p_line[s_line_pos] == '\0') {
+        s_line++;
+        s_line_started = false;
+    }
+    charge(n * CYCLES_PER_BYTE);
+    return n;
+}
+
+size_t uart_bus_write(const void* p_data, size_t len, uint32_t timeout_ms) {
+    (void)timeout_ms;
+    charge(len * CYCLES_PER_BYTE);
+    size_t copy = (len < OUTPUT_BYTES - 1 - s_output_len) ? len : OUTPUT_BYTES - 1 - s_output_len;
+    memcpy(&s_output[s_output_len], p_data, copy);
+    s_output_len += copy;
+
+    // Into the TX ring, waiting for space while it is full
+    size_t queued = 0;
+    while (queued < len) {
+        tx_update();
+        uint32_t space = UART_BUS_TX_BYTES - s_tx_level;
+        if (space == 0) {
+            run_cpu(0, s_tx_drained_at + BYTE_CYCLES);
+            continue;
+        }
+        uint32_t n = (len - queued < space) ? (uint32_t)(len - queued) : space;
+        if (s_tx_level == 0) {
+            s_tx_drained_at = s_now;
+        }
+        s_tx_level += n;
+        queued += n;
+    }
+    return queued;
+}
+
+// --- Stubs for the kernel ---
+
+void vTaskSuspendAll(void) {
+    if (s_suspended++ == 0) {
+        s_locked_since = s_now;
+    }
+}
+
+BaseType_t xTaskResumeAll(void) {
+    if (--s_suspended == 0 && s_now - s_locked_since > s_worst_lockout) {
+        s_worst_lockout = s_now - s_locked_since;
+    }
+    return pdFALSE;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* pxTaskStatusArray, UBaseType_t uxArraySize,
+                                 uint32_t* pulTotalRunTime) {
+    UBaseType_t count = sizeof(s_tasks) / sizeof(s_tasks[0]);
+    if (count > uxArraySize) {
+        return 0;
+    }
+    vTaskSuspendAll();
+    charge(TASK_WALK_CYCLES * count);
+    for (UBaseType_t i = 0; i < count; ++i) {
+        memset(&pxTaskStatusArray[i], 0, sizeof(pxTaskStatusArray[i]));
+        pxTaskStatusArray[i].pcTaskName = s_tasks[i].p_name;
+        pxTaskStatusArray[i].xTaskNumber = i + 1;
+        pxTaskStatusArray[i].eCurrentState = (strcmp(s_tasks[i].p_name, "console") == 0) ? eRunning : eBlocked;
+        pxTaskStatusArray[i].uxCurrentPriority = s_tasks[i].priority;
+        pxTaskStatusArray[i].uxBasePriority = s_tasks[i].priority;
+        pxTaskStatusArray[i].ulRunTimeCounter = (uint32_t)(s_now / (CPU_HZ / 1000000) / count);
+        pxTaskStatusArray[i].usStackHighWaterMark = 64;
+    }
+    *pulTotalRunTime = (uint32_t)(s_now / (CPU_HZ / 1000000));
+    (void)xTaskResumeAll();
+    return count;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+    (void)xTaskToDelete;
+    abort();
+}
+
+size_t xPortGetFreeHeapSize(void) {
+    return 4096;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    return 3072;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Stubs for the application: reports and accessors ---
+
+/** @brief A report of `total` bytes, each line naming the report and its offset. */
+static size_t fill_report(char* p_buffer, size_t len, const char* p_name, size_t total) {
+    size_t pos = 0;
+    while (pos + 40 < total && pos + 40 < len) {
+        int n = snprintf(&p_buffer[pos], len - pos, "%-10s %06lu ........................\r\n", p_name,
+                         (unsigned long)pos);
+        pos += (size_t)n;
+    }
+    p_buffer[pos] = '\0';
+    return pos;
+}
+
+size_t runtime_stats_format(char* p_buffer, size_t len) {
+    // The window is copied with the scheduler suspended, then formatted
+    vTaskSuspendAll();
+    charge(SNAPSHOT_CYCLES);
+    (void)xTaskResumeAll();
+    return fill_report(p_buffer, len, "tasks", REPORT_BYTES);
+}
+
+size_t app_objects_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "objects", 600);
+}
+
+size_t audio_io_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "audio", 300);
+}
+
+size_t low_power_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "power", 300);
+}
+
+size_t motion_report(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "motion", 300);
+}
+
+size_t telemetry_link_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "telemetry", 300);
+}
+
+size_t presets_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "presets", 300);
+}
+
+size_t dsp_profile_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "dsp", CONSOLE_REPORT_BYTES);
+}
+
+size_t clock_governor_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "clock", 200);
+}
+
+size_t event_sched_format(char* p_buffer, size_t len) {
+    return fill_report(p_buffer, len, "events", 300);
+}
+
+void audio_io_get_stats(audio_io_stats_t* p_stats) {
+    memset(p_stats, 0, sizeof(*p_stats));
+    p_stats->rx_blocks = s_blocks;
+    p_stats->tx_blocks = s_blocks;
+}
+
+void telemetry_link_set_enabled(bool enable) {
+    s_telemetry = enable;
+}
+
+bool telemetry_link_is_enabled(void) {
+    return s_telemetry;
+}
+
+int presets_save(uint32_t slot, const preset_t* p_preset) {
+    (void)slot;
+    (void)p_preset;
+    return PRESETS_ERR_STREAMING;
+}
+
+int presets_load(uint32_t slot, preset_t* p_preset) {
+    (void)slot;
+    (void)p_preset;
+    return KVSTORE_ERR_NOT_FOUND;
+}
+
+uint32_t dsp_profile_get_accelerator(void) {
+    return s_accelerator;
+}
+
+bool dsp_profile_set_accelerator(uint32_t features) {
+    s_accelerator = features;
+    return true;
+}
+
+void clock_governor_set_mode(clock_governor_mode_t mode) {
+    s_clock_mode = mode;
+}
+
+static uint32_t app_get_effect(void) {
+    return s_effect;
+}
+
+static void app_set_effect(uint32_t effect) {
+    s_effect = effect;
+}
+
+static bool app_get_params(float* p_param1, float* p_param2) {
+    param_copy();
+    *p_param1 = s_param1;
+    *p_param2 = s_param2;
+    return s_held;
+}
+
+static void app_hold_params(float param1, float param2) {
+    param_copy();
+    s_param1 = param1;
+    s_param2 = param2;
+    s_held = true;
+}
+
+static void app_release_params(void) {
+    s_held = false;
+}
+
+static uint32_t app_get_xruns(void) {
+    return s_xruns;
+}
+
+static bool app_schedule_event(uint32_t event, float value, uint32_t delay_ms) {
+    (void)event;
+    (void)value;
+    (void)delay_ms;
+    s_events++;
+    return true;
+}
+
+static const console_audio_t s_audio = {
+    .p_effect_names = s_effect_names,
+    .effect_count = 4,
+    .get_effect = app_get_effect,
+    .set_effect = app_set_effect,
+    .get_params = app_get_params,
+    .hold_params = app_hold_params,
+    .release_params = app_release_params,
+    .get_xruns = app_get_xruns,
+    .p_event_names = s_event_names,
+    .event_count = 3,
+    .schedule_event = app_schedule_event,
+};
+
+/** @brief Keeps the scheduler suspended for two block periods. */
+static BaseType_t cmd_hog(char* p_buffer, size_t len, const char* p_command) {
+    (void)p_command;
+    vTaskSuspendAll();
+    charge(2 * BLOCK_CYCLES);
+    (void)xTaskResumeAll();
+    snprintf(p_buffer, len, "done\r\n");
+    return pdFALSE;
+}
+
+static const CLI_Command_Definition_t s_hog_command = {
+    "hog", "\r\nhog:\r\n Suspends the scheduler for two audio blocks\r\n", cmd_hog, 0,
+};
+
+static bool output_has(const char* p_text) {
+    return strstr(s_output, p_text) != NULL;
+}
+
+// --- Tests ---
+
+static void test_quiet(void) {
+    run_cpu(0, CPU_HZ);
+    TEST_CHECK(s_blocks == CPU_HZ / BLOCK_CYCLES);
+    TEST_CHECK(s_xruns == 0 && s_worst_latency == DSP_CYCLES);
+}
+
+static void test_session(void) {
+    static const char* const lines[] = {
+        "help\r",
+        "effect\r",
+        "effect echo\r",
+        "eff\t2\r",                                 // Completes to "effect 2"
+        "param 0.25 0.5\r",
+        "param\r",
+        "param auto\r",
+        "blocksize\r",
+        "show tasks\r",
+        "show dsp\r",
+        "stats\r",
+        "heapstats\r",
+        "\t\r",                                     // Recalls "heapstats"
+        "clock 120\r",
+        "art icache off\r",
+        "telemetry on\r",
+        "preset save 1\r",
+        "event lfo 100 0.5\r",
+        "bogus\r",
+        "show objex\b\bects\r",                      // Backspaces
+        "xruns\r",
+    };
+    static char report[CONSOLE_REPORT_BYTES];
+
+    uint32_t blocks_before = s_blocks;
+    uint64_t start = s_now;
+    s_output_len = 0;
+    run_script(lines, sizeof(lines) / sizeof(lines[0]));
+    s_output[s_output_len] = '\0';
+    double seconds = (double)(s_now - start) / CPU_HZ;
+
+    // Everything ran, and at most the longest lockout was added to a block
+    TEST_CHECK(s_xruns == 0);
+    TEST_CHECK(s_worst_latency <= DSP_CYCLES + s_worst_lockout);
+    TEST_CHECK(s_worst_lockout >= TASK_WALK_CYCLES * (sizeof(s_tasks) / sizeof(s_tasks[0])));
+    TEST_CHECK(s_worst_lockout < BLOCK_CYCLES - DSP_CYCLES);
+    TEST_CHECK(output_has("Welcome to the console"));
+    TEST_CHECK(output_has("blocksize:") && output_has("event <lfo|param1|param2>"));
+    TEST_CHECK(output_has("* 0 bypass") && output_has("Effect: echo") && output_has("Effect: flanger"));
+    TEST_CHECK(s_effect == 2);
+    TEST_CHECK(output_has("param1 0.250  param2 0.500  (held)") && !s_held);
+    TEST_CHECK(output_has("Block: 128 frames x 2 channels at 48000 Hz = 2.66 ms"));
+    TEST_CHECK(output_has("Task name") && output_has("dsp               ") && output_has("Tmr Svc"));
+    TEST_CHECK(output_has("Free Heap: 4096 bytes"));
+    TEST_CHECK(strstr(strstr(s_output, "Free Heap") + 1, "Free Heap") != NULL);
+    TEST_CHECK(s_clock_mode == CLOCK_GOVERNOR_FIXED_120_MHZ && s_accelerator == (FLASH_ACCEL_ALL & ~FLASH_ACCEL_ICACHE));
+    TEST_CHECK(s_telemetry && s_events == 1);
+    TEST_CHECK(output_has("only compacted at power-on"));
+    TEST_CHECK(output_has("Command not recognised"));
+    TEST_CHECK(output_has("objects    000000"));
+    TEST_CHECK(output_has("XRUNs: 0 in "));
+
+    // Long reports arrive whole, streamed through the continuation
+    size_t n = runtime_stats_format(report, sizeof(report));
+    TEST_CHECK(n > configCOMMAND_INT_MAX_OUTPUT_SIZE && strstr(s_output, report) != NULL);
+    n = dsp_profile_format(report, sizeof(report));
+    TEST_CHECK(n > 3 * configCOMMAND_INT_MAX_OUTPUT_SIZE && strstr(s_output, report) != NULL);
+
+    printf("session: %zu bytes out in %.2f s, %u blocks at %d %% DSP load, %u xruns, "
+           "worst block latency %llu cycles (%llu without input), longest lockout %llu cycles\n",
+           s_output_len, seconds, (unsigned)(s_blocks - blocks_before), DSP_LOAD_PERCENT, (unsigned)s_xruns,
+           (unsigned long long)s_worst_latency, (unsigned long long)DSP_CYCLES,
+           (unsigned long long)s_worst_lockout);
+}
+
+static void test_hog(void) {
+    static const char* const lines[] = {"hog\r"};
+
+    TEST_CHECK(FreeRTOS_CLIRegisterCommand(&s_hog_command) == pdPASS);
+    uint32_t xruns_before = s_xruns;
+    s_output_len = 0;
+    run_script(lines, 1);
+    s_output[s_output_len] = '\0';
+    TEST_CHECK(output_has("done"));
+    TEST_CHECK(s_xruns - xruns_before >= 2);
+    printf("hog: %u xruns\n", (unsigned)(s_xruns - xruns_before));
+}
+
+int main(void) {
+    TEST_CHECK(console_init(&s_audio));
+    test_quiet();
+    test_session();
+    test_hog();
+    return TEST_EXIT();
+}
@@ -0,0 +1,375 @@
+/**
+ * @file      test_dma_bench.c
+ * @brief     Host test of the DMA copy benchmark on the STM32F407 DMA port.
+ *
+ * @details   dma_bench.c runs unchanged on dma.c and the STM32F407 port,
+ *            against the register fake with the DMA page trapped. The hook
+ *            plays DMA2 Stream0 and the bus. Each register access costs
+ *            ACCESS_CYCLES on DWT_CYCCNT. Once the port enables the stream,
+ *            the copy completes after the cycles the AHB model gives for its
+ *            settings (model_cycles()). The hook then copies the block with
+ *            the programmed sizes and increments, sets TCIF and clears EN.
+ *            memcpy() touches no register, so it takes no simulated time and
+ *            its row is checked for presence only.
+ *
+ *            - Report: one row per legal size/burst/threshold combination,
+ *              in order, per the RM0090 FIFO rules restated here. Each row
+ *              is "ok", its cycles are the model's plus the register
+ *              accesses around it, and its MB/s matches its cycles.
+ *            - Registers: every run programs the stream for its row (m2m,
+ *              sizes, bursts, FTH with DMDIS, item count), with the
+ *              scheduler suspended.
+ *            - Failures: a stream that never completes is reported as a
+ *              timeout, a bad copy as a mismatch, and the rows after them
+ *              are still measured.
+ *            - Truncation: a short buffer gets a prefix of the full report.
+ *
+ *            Built with -no-pie so that the benchmark's static blocks sit
+ *            below 4 GB, where the 32-bit address registers can hold them.
+ */
+
+#include "dma_bench.h"
+#include "dma.h"
+#include "common.h"
+#include "internal/dma_reg.h"
+#include "rcc.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DMA_PAGE_BASE       0x40026000UL        // DMA1 and DMA2
+#define DMA2_BASE           0x40026400UL
+#define DWT_CYCCNT_ADDR     (DWT_BASE + 0x004)
+#define DMA_FLAG_TCIF       (1UL << 5)          // Stream0 position in LISR
+
+// Bus model, in CPU cycles (HCLK)
+#define ACCESS_CYCLES       4                   // One register access by the CPU
+#define START_CYCLES        12                  // Enable to first request
+#define ADDRESS_CYCLES      2                   // Arbitration and address phase per transaction
+#define TURNAROUND_CYCLES   4                   // Switching ports at each FIFO threshold
+
+// Register accesses the port makes from the first CYCCNT read to the enable,
+// and at most two poll rounds of two flag reads after completion
+#define SETUP_SLACK         (24 * ACCESS_CYCLES)
+
+#define LABEL_WIDTH         24
+#define MAX_ROWS            32
+#define MAX_TRANSFERS       (MAX_ROWS * DMA_BENCH_RUNS)
+
+typedef struct {
+    uint32_t cr;
+    uint32_t fcr;
+    uint32_t ndtr;
+    bool suspended;
+} transfer_t;
+
+typedef struct {
+    char label[LABEL_WIDTH + 1];
+    unsigned long cycles;
+    unsigned long mbps;
+    unsigned long mbps_tenths;
+    char status[16];
+} row_t;
+
+// --- Test Data ---
+static volatile dma_stream_reg_map_t* const s_stream = &((volatile dma_controller_reg_map_t*)DMA2_BASE)->S[0];
+
+static bool s_running = false;
+static uint32_t s_done_at = 0;
+static transfer_t s_transfers[MAX_TRANSFERS];
+static int s_transfer_count = 0;
+static int s_stall_at = -1;                 // Transfer that never completes
+static int s_corrupt_at = -1;               // Transfer that copies one wrong byte
+
+static int s_suspended = 0;
+static int s_suspend_calls = 0;
+
+static const char* const s_size_names[] = {"8", "16", "32"};
+static const char* const s_burst_names[] = {"single", "incr4", "incr8", "incr16"};
+static const char* const s_threshold_names[] = {"1/4", "1/2", "3/4", "full"};
+
+// --- Stubs for the RCC driver and the kernel ---
+
+void rcc_enable_peripheral_clock(peripheral_id_t id) {
+    (void)id;
+}
+
+void vTaskSuspendAll(void) {
+    s_suspended++;
+    s_suspend_calls++;
+}
+
+BaseType_t xTaskResumeAll(void) {
+    s_suspended--;
+    return pdFALSE;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+static uint32_t burst_beats(uint32_t burst) {
+    return (burst == 0) ? 1 : (2UL << burst);
+}
+
+/** @brief RM0090 FIFO rules for m2m with equal sizes and bursts: a burst must divide the threshold. */
+static bool expected_legal(uint32_t size, uint32_t burst, uint32_t threshold) {
+    uint32_t burst_bytes = burst_beats(burst) << size;
+    uint32_t threshold_bytes = 4 * (threshold + 1);
+    return threshold_bytes % burst_bytes == 0;
+}
+
+/**
+ * @brief Cycles for one copy: each burst is a read transaction on the
+ *        peripheral port and a write transaction on the memory port, and
+ *        the stream turns around each time the FIFO reaches the threshold.
+ */
+static uint32_t model_cycles(uint32_t size, uint32_t burst, uint32_t threshold) {
+    uint32_t beats = burst_beats(burst);
+    uint32_t transactions = DMA_BENCH_BYTES / (beats << size);
+    uint32_t fills = DMA_BENCH_BYTES / (4 * (threshold + 1));
+    return START_CYCLES + 2 * transactions * (ADDRESS_CYCLES + beats) + fills * TURNAROUND_CYCLES;
+}
+
+static void complete_transfer(void) {
+    uint32_t cr = s_stream->CR;
+    uint32_t psize = 1UL << ((cr & DMA_SxCR_PSIZE_Msk) >> DMA_SxCR_PSIZE_Pos);
+    uint32_t msize = 1UL << ((cr & DMA_SxCR_MSIZE_Msk) >> DMA_SxCR_MSIZE_Pos);
+    const uint8_t* p_src = (const uint8_t*)(uintptr_t)s_stream->PAR;
+    uint8_t* p_dst = (uint8_t*)(uintptr_t)s_stream->M0AR;
+
+    // Equal sizes only: the benchmark never packs or unpacks in the FIFO
+    if (psize == msize) {
+        uint32_t items = s_stream->NDTR;
+        for (uint32_t i = 0; i < items; ++i) {
+            uint32_t src_offset = (cr & DMA_SxCR_PINC_Msk) ? i * psize : 0;
+            uint32_t dst_offset = (cr & DMA_SxCR_MINC_Msk) ? i * msize : 0;
+            memcpy(&p_dst[dst_offset], &p_src[src_offset], psize);
+        }
+        if (s_transfer_count - 1 == s_corrupt_at) {
+            p_dst[items * msize / 2] ^= 0x01;
+        }
+    }
+
+    s_stream->NDTR = 0;
+    s_stream->CR = cr & ~DMA_SxCR_EN_Msk;
+    MMIO32(DMA2_BASE + 0x00) |= DMA_FLAG_TCIF;
+}
+
+/** @brief Runs before each access to the DMA page. */
+static void on_access(uintptr_t address, bool is_write) {
+    (void)address;
+    (void)is_write;
+
+    // A flag clear written by the previous access takes effect now
+    uint32_t clear = MMIO32(DMA2_BASE + 0x08);
+    if (clear != 0) {
+        MMIO32(DMA2_BASE + 0x00) &= ~clear;
+        MMIO32(DMA2_BASE + 0x08) = 0;
+    }
+
+    MMIO32(DWT_CYCCNT_ADDR) += ACCESS_CYCLES;
+    uint32_t now = MMIO32(DWT_CYCCNT_ADDR);
+
+    bool enabled = (s_stream->CR & DMA_SxCR_EN_Msk) != 0;
+    if (!s_running && enabled) {
+        uint32_t cr = s_stream->CR;
+        if (s_transfer_count < MAX_TRANSFERS) {
+            s_transfers[s_transfer_count] = (transfer_t){
+                .cr = cr,
+                .fcr = s_stream->FCR,
+                .ndtr = s_stream->NDTR,
+                .suspended = s_suspended > 0,
+            };
+        }
+        s_transfer_count++;
+        s_running = true;
+        s_done_at = now + model_cycles((cr & DMA_SxCR_PSIZE_Msk) >> DMA_SxCR_PSIZE_Pos,
+                                       (cr & DMA_SxCR_MBURST_Msk) >> DMA_SxCR_MBURST_Pos,
+                                       (s_stream->FCR & DMA_SxFCR_FTH_Msk) >> DMA_SxFCR_FTH_Pos);
+    } else if (s_running && !enabled) {
+        s_running = false;                  // Disabled by the port before completing
+    }
+
+    if (s_running && s_transfer_count - 1 != s_stall_at && (int32_t)(now - s_done_at) >= 0) {
+        complete_transfer();
+        s_running = false;
+    }
+}
+
+static size_t run_trapped(char* p_buffer, size_t len) {
+    s_transfer_count = 0;
+    s_running = false;
+    TEST_CHECK(reg_fake_trap(DMA_PAGE_BASE, 0x800, on_access));
+    size_t n = dma_bench_run(p_buffer, len);
+    reg_fake_untrap();
+    TEST_CHECK(s_suspended == 0);
+    return n;
+}
+
+/** @brief Splits the report into rows after the two header lines. */
+static int parse_rows(const char* p_report, row_t* p_rows, int max_rows) {
+    const char* p_line = strstr(p_report, "\r\n");
+    p_line = (p_line != NULL) ? strstr(p_line + 2, "\r\n") : NULL;
+    int count = 0;
+    while (p_line != NULL && count < max_rows) {
+        p_line += 2;
+        const char* p_end = strstr(p_line, "\r\n");
+        if (p_end == NULL) {
+            break;
+        }
+        row_t* p_row = &p_rows[count];
+        memset(p_row, 0, sizeof(*p_row));
+        TEST_CHECK(p_end - p_line > LABEL_WIDTH);
+        memcpy(p_row->label, p_line, LABEL_WIDTH);
+        for (int i = LABEL_WIDTH - 1; i >= 0 && p_row->label[i] == ' '; --i) {
+            p_row->label[i] = '\0';
+        }
+        TEST_CHECK(sscanf(p_line + LABEL_WIDTH, "%lu %lu.%lu %15s", &p_row->cycles, &p_row->mbps,
+                          &p_row->mbps_tenths, p_row->status) == 4);
+        count++;
+        p_line = p_end;
+    }
+    return count;
+}
+
+static bool row_is(const row_t* p_row, uint32_t size, uint32_t burst, uint32_t threshold) {
+    char label[LABEL_WIDTH + 8];
+    snprintf(label, sizeof(label), "dma %sb %s fifo %s",
+             s_size_names[size], s_burst_names[burst], s_threshold_names[threshold]);
+    return strcmp(p_row->label, label) == 0;
+}
+
+static void check_transfer(const transfer_t* p_transfer, uint32_t size, uint32_t burst, uint32_t threshold) {
+    uint32_t cr = p_transfer->cr;
+    TEST_CHECK(((cr & DMA_SxCR_DIR_Msk) >> DMA_SxCR_DIR_Pos) == (uint32_t)DMA_DIRECTION_MEMORY_TO_MEMORY);
+    TEST_CHECK(((cr & DMA_SxCR_PSIZE_Msk) >> DMA_SxCR_PSIZE_Pos) == size);
+    TEST_CHECK(((cr & DMA_SxCR_MSIZE_Msk) >> DMA_SxCR_MSIZE_Pos) == size);
+    TEST_CHECK(((cr & DMA_SxCR_PBURST_Msk) >> DMA_SxCR_PBURST_Pos) == burst);
+    TEST_CHECK(((cr & DMA_SxCR_MBURST_Msk) >> DMA_SxCR_MBURST_Pos) == burst);
+    TEST_CHECK((cr & DMA_SxCR_PINC_Msk) && (cr & DMA_SxCR_MINC_Msk));
+    TEST_CHECK(!(cr & (DMA_SxCR_CIRC_Msk | DMA_SxCR_DBM_Msk)));
+    TEST_CHECK(p_transfer->fcr == (DMA_SxFCR_DMDIS_Msk | (threshold << DMA_SxFCR_FTH_Pos)));
+    TEST_CHECK(p_transfer->ndtr == ((uint32_t)DMA_BENCH_BYTES >> size));
+    TEST_CHECK(p_transfer->suspended);
+}
+
+// --- Tests ---
+
+/**
+ * @brief Runs the benchmark with transfer `stall_at` hanging and
+ *        `corrupt_at` miscopied (-1 for none) and checks every row.
+ * @return Length of the report.
+ */
+static size_t test_report(char* p_report, size_t len, int stall_at, int corrupt_at) {
+    s_stall_at = stall_at;
+    s_corrupt_at = corrupt_at;
+    int calls_before = s_suspend_calls;
+    size_t n = run_trapped(p_report, len);
+    TEST_CHECK(n == strlen(p_report));
+    TEST_CHECK(s_suspend_calls == calls_before + 1);
+
+    row_t rows[MAX_ROWS];
+    int row_count = parse_rows(p_report, rows, MAX_ROWS);
+    TEST_CHECK(row_count >= 1 && strcmp(rows[0].label, "cpu memcpy") == 0 && strcmp(rows[0].status, "ok") == 0);
+
+    int row = 1;
+    int transfer = 0;
+    int stalled_rows = 0;
+    int corrupt_rows = 0;
+    for (uint32_t size = 0; size <= DMA_DATA_SIZE_32_BIT; ++size) {
+        for (uint32_t burst = 0; burst <= DMA_BURST_INCR16; ++burst) {
+            for (uint32_t threshold = 0; threshold <= DMA_FIFO_THRESHOLD_FULL; ++threshold) {
+                if (!expected_legal(size, burst, threshold)) {
+                    continue;
+                }
+                TEST_CHECK(row < row_count && row_is(&rows[row], size, burst, threshold));
+                if (row >= row_count) {
+                    return n;
+                }
+                const row_t* p_row = &rows[row++];
+
+                // The first run of a setting that times out is its last
+                int first = transfer;
+                bool stalled = (stall_at >= first && stall_at < first + DMA_BENCH_RUNS);
+                int runs = stalled ? (stall_at - first + 1) : DMA_BENCH_RUNS;
+                for (int i = 0; i < runs && transfer < MAX_TRANSFERS; ++i) {
+                    check_transfer(&s_transfers[transfer++], size, burst, threshold);
+                }
+
+                if (stalled) {
+                    TEST_CHECK(strcmp(p_row->status, "timeout") == 0);
+                    TEST_CHECK(p_row->cycles == 0 && p_row->mbps == 0 && p_row->mbps_tenths == 0);
+                    stalled_rows++;
+                    continue;
+                }
+                bool corrupt = (corrupt_at >= first && corrupt_at < first + DMA_BENCH_RUNS);
+                TEST_CHECK(strcmp(p_row->status, corrupt ? "MISMATCH" : "ok") == 0);
+                corrupt_rows += corrupt ? 1 : 0;
+
+                uint32_t model = model_cycles(size, burst, threshold);
+                TEST_CHECK(p_row->cycles > model && p_row->cycles <= model + SETUP_SLACK);
+                uint64_t mbps10 = ((uint64_t)DMA_BENCH_BYTES * configCPU_CLOCK_HZ) / ((uint64_t)p_row->cycles * 100000ULL);
+                TEST_CHECK(p_row->mbps * 10 + p_row->mbps_tenths == mbps10);
+            }
+        }
+    }
+    TEST_CHECK(row == row_count);
+    TEST_CHECK(transfer == s_transfer_count);
+    TEST_CHECK(stalled_rows == (stall_at >= 0 ? 1 : 0));
+    TEST_CHECK(corrupt_rows == (corrupt_at >= 0 ? 1 : 0));
+    return n;
+}
+
+static void test_truncation(const char* p_full, size_t full_len) {
+    const char* p_first_row = strstr(strstr(p_full, "\r\n") + 2, "\r\n") + 2;
+    size_t header_len = (size_t)(p_first_row - p_full);
+    const size_t lens[] = {1, 2, 10, header_len, header_len + 1, header_len + 30,
+                           full_len / 2, full_len, full_len + 1};
+
+    TEST_CHECK(dma_bench_run(NULL, 64) == 0);
+    char empty = 'x';
+    TEST_CHECK(dma_bench_run(&empty, 0) == 0 && empty == 'x');
+
+    s_stall_at = -1;
+    s_corrupt_at = -1;
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+        size_t len = lens[i];
+        char* p_buffer = malloc(len);
+        TEST_CHECK(p_buffer != NULL);
+        if (p_buffer == NULL) {
+            return;
+        }
+        size_t n = run_trapped(p_buffer, len);
+        size_t expected = (full_len < len - 1) ? full_len : len - 1;
+        TEST_CHECK(n == expected && strlen(p_buffer) == n);
+        TEST_CHECK(strncmp(p_buffer, p_full, n) == 0);
+        free(p_buffer);
+    }
+}
+
+int main(void) {
+    if (!reg_fake_map(DMA_PAGE_BASE, 0x800) || !reg_fake_map(DWT_BASE, 0x1000)) {
+        fprintf(stderr, "cannot map the DMA or DWT registers on this host\n");
+        return 1;
+    }
+
+    static char report[4096];
+    size_t n = test_report(report, sizeof(report), -1, -1);
+    printf("%s", report);
+
+    // A timed-out setting makes one transfer, so the later numbers count from there
+    static char failed[4096];
+    test_report(failed, sizeof(failed), 3 * DMA_BENCH_RUNS, 7 * DMA_BENCH_RUNS + 1);
+
+    test_truncation(report, n);
+    return TEST_EXIT();
+}
@@ -0,0 +1,264 @@
+/**
+ * @file      test_dma_mem.c
+ * @brief     Host test of the DMA memcpy/memset service on the POSIX DMA port.
+ *
+ * @details   dma_mem.c runs unchanged. The POSIX port moves the data on a
+ *            worker thread and raises the stream interrupt there, so the
+ *            service is exercised asynchronously, with the test thread
+ *            submitting while earlier operations are still in flight.
+ *
+ *            - Ordering: thousands of random chains of fills and copies
+ *              between two buffers, at every alignment, must leave the
+ *              buffers exactly as running them one after the other on the
+ *              CPU does. Callbacks must arrive in submission order.
+ *            - Rejections: empty and CCM operations, oversized chains.
+ *            - Throughput: bulk copies through the service against memcpy
+ *              on the same buffers. Printed; the check only catches
+ *              per-segment overhead gone wrong.
+ */
+
+#include "dma_mem.h"
+#include "nvic.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REGION_BYTES        4096
+#define CHAINS              3000
+#define MAX_CHAIN_OPS       3
+#define BULK_BYTES          (8UL * 1024 * 1024)
+#define BULK_OP_BYTES       (1024UL * 1024)
+#define BULK_ROUNDS         8
+
+// --- Test Data ---
+static _Alignas(16) uint8_t s_region[2][REGION_BYTES];
+static _Alignas(16) uint8_t s_model[2][REGION_BYTES];
+
+static volatile uint32_t s_callbacks = 0;
+static volatile uint32_t s_out_of_order = 0;
+static volatile uint32_t s_failed = 0;
+static uint32_t s_tickets[CHAINS];
+
+static uint32_t s_rng = 12345;
+
+void DMA_MEM_IRQ_HANDLER(void);     // Defined by dma_mem.c, not declared in its header
+
+// --- Stubs for the firmware modules dma_mem.c calls ---
+
+void trace_isr_enter(uint16_t irq_num) {
+    (void)irq_num;
+}
+
+void trace_isr_exit(uint16_t irq_num) {
+    (void)irq_num;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+static uint32_t next_random(void) {
+    s_rng = s_rng * 1664525UL + 1013904223UL;
+    return s_rng >> 8;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/** @brief Records the order chains complete in; runs in the simulated ISR. */
+static void on_chain_done(void* p_context, bool success) {
+    uint32_t index = (uint32_t)(uintptr_t)p_context;
+    if (index != s_callbacks) {
+        s_out_of_order++;
+    }
+    if (!success) {
+        s_failed++;
+    }
+    s_callbacks++;
+}
+
+/** @brief Submits, waiting for room in the queue. */
+static uint32_t submit_waiting(const dma_mem_op_t* p_ops, size_t count,
+                               dma_mem_callback_t callback, void* p_context) {
+    uint32_t ticket;
+    while ((ticket = dma_mem_submit(p_ops, count, callback, p_context)) == 0) {
+        sched_yield();
+    }
+    return ticket;
+}
+
+static void wait_done(uint32_t ticket) {
+    while (!dma_mem_is_done(ticket)) {
+        sched_yield();
+    }
+}
+
+/** @brief A random fill or copy; applies it to the model too. */
+static dma_mem_op_t random_op(void) {
+    dma_mem_op_t op = {0};
+    size_t bytes = 1 + next_random() % 600;
+    size_t dst_offset = next_random() % (REGION_BYTES - bytes + 1);
+    uint32_t dst = next_random() % 2;
+
+    op.dst = &s_region[dst][dst_offset];
+    op.bytes = bytes;
+    if (next_random() % 2) {
+        op.kind = DMA_MEM_OP_SET;
+        op.value = (uint8_t)next_random();
+        memset(&s_model[dst][dst_offset], op.value, bytes);
+    } else {
+        size_t src_offset = next_random() % (REGION_BYTES - bytes + 1);
+        op.kind = DMA_MEM_OP_COPY;
+        op.src = &s_region[!dst][src_offset];
+        memcpy(&s_model[dst][dst_offset], &s_model[!dst][src_offset], bytes);
+    }
+    return op;
+}
+
+// --- Tests ---
+
+static void test_ordering(void) {
+    for (uint32_t i = 0; i < REGION_BYTES; ++i) {
+        s_region[0][i] = s_model[0][i] = (uint8_t)i;
+        s_region[1][i] = s_model[1][i] = (uint8_t)(i * 7);
+    }
+    dma_mem_stats_t before;
+    dma_mem_get_stats(&before);
+
+    uint32_t bytes = 0;
+    for (uint32_t chain = 0; chain < CHAINS; ++chain) {
+        dma_mem_op_t ops[MAX_CHAIN_OPS];
+        size_t count = 1 + next_random() % MAX_CHAIN_OPS;
+        for (size_t i = 0; i < count; ++i) {
+            ops[i] = random_op();
+            bytes += (uint32_t)ops[i].bytes;
+        }
+        s_tickets[chain] = submit_waiting(ops, count, on_chain_done, (void*)(uintptr_t)chain);
+
+        // With the interrupt masked: a chain is done exactly when its callback has run
+        taskENTER_CRITICAL();
+        uint32_t oldest = chain - ((chain < 20) ? chain : 20);
+        for (uint32_t i = oldest; i <= chain; ++i) {
+            if (dma_mem_is_done(s_tickets[i]) != (i < s_callbacks)) {
+                s_out_of_order++;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+    wait_done(s_tickets[CHAINS - 1]);
+
+    dma_mem_stats_t after;
+    dma_mem_get_stats(&after);
+    TEST_CHECK(s_callbacks == CHAINS);
+    TEST_CHECK(s_out_of_order == 0);
+    bool consecutive = true;
+    for (uint32_t i = 1; i < CHAINS; ++i) {
+        consecutive = consecutive && (s_tickets[i] == s_tickets[i - 1] + 1);
+    }
+    TEST_CHECK(consecutive);
+    TEST_CHECK(s_failed == 0);
+    TEST_CHECK(memcmp(s_region, s_model, sizeof(s_region)) == 0);
+    TEST_CHECK(after.completed - before.completed == CHAINS);
+    TEST_CHECK(after.bytes - before.bytes == bytes);
+    TEST_CHECK(after.errors == 0);
+    TEST_CHECK(after.queue_peak <= DMA_MEM_QUEUE_LENGTH);
+    printf("ordering: %u chains, %u bytes, queue peak %u\n",
+           (unsigned)CHAINS, (unsigned)bytes, (unsigned)after.queue_peak);
+}
+
+static void test_rejections(void) {
+    dma_mem_stats_t before;
+    dma_mem_get_stats(&before);
+
+    TEST_CHECK(dma_mem_set(s_region[0], 0, 0, NULL, NULL) == 0);
+    TEST_CHECK(dma_mem_set((void*)0x10000000UL, 0, 16, NULL, NULL) == 0);
+    TEST_CHECK(dma_mem_copy(s_region[0], (const void*)0x1000FFF0UL, 32, NULL, NULL) == 0);
+
+    dma_mem_op_t ops[DMA_MEM_QUEUE_LENGTH + 1];
+    for (size_t i = 0; i < DMA_MEM_QUEUE_LENGTH + 1; ++i) {
+        ops[i] = (dma_mem_op_t){.kind = DMA_MEM_OP_SET, .dst = s_region[0], .bytes = 4};
+    }
+    TEST_CHECK(dma_mem_submit(ops, DMA_MEM_QUEUE_LENGTH + 1, NULL, NULL) == 0);
+
+    dma_mem_stats_t after;
+    dma_mem_get_stats(&after);
+    TEST_CHECK(after.rejected - before.rejected == 4);
+}
+
+static void test_notify_task(void) {
+    memset(s_region[1], 0, REGION_BYTES);
+    uint32_t ticket = dma_mem_set(s_region[1], 0x5A, REGION_BYTES, dma_mem_notify_task, xTaskGetCurrentTaskHandle());
+    TEST_CHECK(ticket != 0);
+    TEST_CHECK(ulTaskNotifyTakeIndexed(DMA_MEM_NOTIFY_INDEX, pdTRUE, portMAX_DELAY) == 1);
+    TEST_CHECK(dma_mem_is_done(ticket));
+    TEST_CHECK(s_region[1][0] == 0x5A && s_region[1][REGION_BYTES - 1] == 0x5A);
+}
+
+static void test_throughput(void) {
+    uint8_t* src = malloc(BULK_BYTES);
+    uint8_t* dst = malloc(BULK_BYTES);
+    TEST_CHECK(src != NULL && dst != NULL);
+    if (src == NULL || dst == NULL) {
+        free(src);
+        free(dst);
+        return;
+    }
+    for (size_t i = 0; i < BULK_BYTES; ++i) {
+        src[i] = (uint8_t)(i * 13 + 1);
+    }
+    memcpy(dst, src, BULK_BYTES);   // Fault the pages in before timing
+
+    uint64_t start = now_ns();
+    for (int round = 0; round < BULK_ROUNDS; ++round) {
+        memcpy(dst, src, BULK_BYTES);
+    }
+    uint64_t cpu_ns = now_ns() - start;
+    memset(dst, 0, BULK_BYTES);
+
+    uint32_t ticket = 0;
+    start = now_ns();
+    for (int round = 0; round < BULK_ROUNDS; ++round) {
+        for (size_t offset = 0; offset < BULK_BYTES; offset += BULK_OP_BYTES) {
+            ticket = submit_waiting(&(dma_mem_op_t){.kind = DMA_MEM_OP_COPY, .dst = dst + offset,
+                                                    .src = src + offset, .bytes = BULK_OP_BYTES},
+                                    1, NULL, NULL);
+        }
+    }
+    wait_done(ticket);
+    uint64_t dma_ns = now_ns() - start;
+
+    double mb = (double)BULK_BYTES * BULK_ROUNDS / 1e6;
+    printf("throughput: memcpy %.0f MB/s, service %.0f MB/s\n",
+           mb / ((double)cpu_ns / 1e9), mb / ((double)dma_ns / 1e9));
+
+    TEST_CHECK(memcmp(dst, src, BULK_BYTES) == 0);
+    TEST_CHECK(dma_ns < cpu_ns * 10);
+    free(src);
+    free(dst);
+}
+
+int main(void) {
+    TEST_CHECK(reg_fake_map(NVIC_BASE, 0x400));     // dma_mem_init() enables its interrupt
+    vPortSetInterruptHandler(DMA_MEM_IRQN, DMA_MEM_IRQ_HANDLER);
+    TEST_CHECK(dma_mem_init());
+    TEST_CHECK(NVIC_ISER(DMA_MEM_IRQN / 32) & (1UL << (DMA_MEM_IRQN % 32)));
+
+    test_rejections();
+    test_ordering();
+    test_notify_task();
+    test_throughput();
+    return TEST_EXIT();
+}
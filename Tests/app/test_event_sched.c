@@ -0,0 +1,295 @@
+/**
+ * @file      test_event_sched.c
+ * @brief     Host test of the sample-accurate control event scheduler.
+ *
+ * @details   event_sched.c runs unchanged on the STM32F407 timer port, with
+ *            TIM2 a register fake. The test plays the RX block interrupt and
+ *            dspTask: it sets the TIM2 counter to the time each block ends,
+ *            marks the block, posts events from the block being captured,
+ *            and runs dspTask's split loop (main.c) over the block due. The
+ *            counter starts 40 blocks before its 32-bit wrap.
+ *
+ *            - Every timestamp converts to the sample captured at that tick.
+ *            - Thousands of events, posted with a delay or at a position,
+ *              apply exactly on their frame; those posted for a frame
+ *              already processed apply at the start of the next block
+ *              processed and are counted late, and no event is left behind.
+ *            - Built with AUDIO_PIPELINE_DIRECT_NOTIFY = 1, dspTask misses
+ *              a block now and then; with 0 it runs two blocks behind the
+ *              capture, as the stream buffers queue them.
+ *
+ *            The host time dspTask spends in the scheduler per block, this
+ *            test's checks included, is printed; DWT_CYCCNT reads 0 here, so
+ *            the cycle counters are only meaningful on target.
+ */
+
+#include "event_sched.h"
+#include "audio_config.h"
+#include "common.h"
+#include "internal/timer_reg.h"
+#include "rcc.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TIM2_ADDR               0x40000000UL
+#define APB1_TIMER_HZ           84000000UL
+#define TICKS_PER_FRAME         (EVENT_SCHED_TIMER_HZ / AUDIO_SAMPLING_RATE)
+#define TICKS_PER_BLOCK         (TICKS_PER_FRAME * AUDIO_BLOCK_FRAMES)
+#define START_TICKS             (0xFFFFFFFFUL - 40 * TICKS_PER_BLOCK)
+#define BLOCKS                  4000
+#define MAX_EVENTS              (BLOCKS * 4)
+#define MAX_DELAY_FRAMES        800
+#define MISSED_BLOCK_EVERY      97      // Direct notify: dspTask misses a block
+#define QUEUED_BLOCKS           2       // Stream buffers: dspTask this far behind
+
+/**
+ * @brief What the test expects of an event.
+ */
+typedef struct {
+    uint32_t sample;
+    uint32_t processed_at_post;     // Blocks dspTask had processed when it was posted
+    bool applied;
+} model_event_t;
+
+// --- Test Data ---
+static timer_reg_map_t* const s_tim2 = (timer_reg_map_t*)TIM2_ADDR;
+static model_event_t s_model[MAX_EVENTS];
+static uint32_t s_posted = 0;
+static uint32_t s_processed = 0;            // Blocks run by the simulated dspTask
+static uint32_t s_prev_end = 0;             // Position after the last block it ran
+static uint32_t s_applied = 0;
+static uint32_t s_late = 0;
+static uint32_t s_wrong = 0;
+static uint32_t s_rng = 7;
+
+// --- Stubs for the RCC driver ---
+
+void rcc_enable_peripheral_clock(peripheral_id_t id) {
+    (void)id;
+}
+
+uint32_t rcc_get_apb1_timer_frequency(void) {
+    return APB1_TIMER_HZ;
+}
+
+uint32_t rcc_get_apb2_timer_frequency(void) {
+    return 2 * APB1_TIMER_HZ;
+}
+
+int rcc_register_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    (void)listener;
+    (void)p_context;
+    return 0;
+}
+
+void rcc_unregister_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    (void)listener;
+    (void)p_context;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+static uint32_t next_random(void) {
+    s_rng = s_rng * 1664525UL + 1013904223UL;
+    return s_rng >> 8;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/** @brief Frames the scheduler makes of a tick offset from the anchor. */
+static int32_t frames_of(int32_t ticks) {
+    return (int32_t)(((int64_t)ticks * AUDIO_SAMPLING_RATE) / (int64_t)EVENT_SCHED_TIMER_HZ);
+}
+
+static void add_model(uint32_t sample) {
+    s_model[s_posted].sample = sample;
+    s_model[s_posted].processed_at_post = s_processed;
+    s_posted++;
+}
+
+/**
+ * @brief Posts from the block being captured; block `block` has just ended.
+ * @details The value carries the index of the event in the model.
+ */
+static void post_events(uint32_t block) {
+    uint32_t block_ticks = START_TICKS + (block + 1) * TICKS_PER_BLOCK;
+    uint32_t anchor_sample = (block + 1) * AUDIO_BLOCK_FRAMES;
+
+    // Timestamps up to two blocks back and one ahead, across the counter wrap
+    for (int i = 0; i < 4; ++i) {
+        int32_t offset = (int32_t)(next_random() % (3 * TICKS_PER_BLOCK)) - 2 * (int32_t)TICKS_PER_BLOCK;
+        uint32_t expected = anchor_sample + (uint32_t)frames_of(offset);
+        if (event_sched_ticks_to_sample(block_ticks + (uint32_t)offset) != expected) {
+            s_wrong++;
+        }
+    }
+
+    event_sched_stats_t stats;
+    event_sched_get_stats(&stats);
+    uint32_t count = next_random() % 7;
+    for (uint32_t i = 0; i < count && stats.pending + i < EVENT_SCHED_MAX_EVENTS && s_posted < MAX_EVENTS; ++i) {
+        uint32_t ticks = next_random() % TICKS_PER_BLOCK;
+        s_tim2->CNT = block_ticks + ticks;
+        uint32_t now = anchor_sample + ticks / TICKS_PER_FRAME;
+        uint32_t kind = next_random() % 8;
+        bool ok;
+        if (kind == 0) {
+            // For a position that may have been processed already
+            uint32_t sample = now - next_random() % (4 * AUDIO_BLOCK_FRAMES);
+            add_model(sample);
+            ok = event_sched_post_at_from_isr((uint16_t)kind, (float)(s_posted - 1), sample);
+        } else if (kind == 1) {
+            uint32_t sample = now + next_random() % MAX_DELAY_FRAMES;
+            add_model(sample);
+            ok = event_sched_post_at((uint16_t)kind, (float)(s_posted - 1), sample);
+        } else {
+            uint32_t delay = next_random() % MAX_DELAY_FRAMES;
+            add_model(now + delay);
+            ok = event_sched_post((uint16_t)kind, (float)(s_posted - 1), delay);
+        }
+        if (!ok) {
+            s_wrong++;
+        }
+    }
+}
+
+/** @brief Checks an event applied at `position`, in block `block_start`. */
+static void check_applied(const ctrl_event_t* p_event, uint32_t block_start, uint32_t position) {
+    uint32_t index = (uint32_t)p_event->value;
+    if (index >= s_posted || s_model[index].applied || p_event->sample != s_model[index].sample) {
+        s_wrong++;
+        return;
+    }
+    model_event_t* p_model = &s_model[index];
+    p_model->applied = true;
+    s_applied++;
+
+    int32_t early = (int32_t)(p_model->sample - block_start);
+    if (early >= 0) {
+        // Due in this block: exactly on its frame
+        s_wrong += (position != p_model->sample);
+    } else {
+        // Already behind: at the start of the first block run since it was posted
+        s_wrong += (position != block_start);
+        bool ran_since = p_model->processed_at_post < s_processed;
+        s_wrong += (ran_since && (int32_t)(p_model->sample - s_prev_end) < 0);
+        s_late++;
+    }
+}
+
+/** @brief dspTask's loop over one block (dsp_process_block() in main.c). */
+static uint64_t run_block(uint32_t block_start) {
+    uint64_t start = now_ns();
+    event_sched_block_begin();
+    uint32_t frame = 0;
+    while (frame < AUDIO_BLOCK_FRAMES) {
+        ctrl_event_t event;
+        while (event_sched_take(frame, &event)) {
+            check_applied(&event, block_start, block_start + frame);
+        }
+        uint32_t next = event_sched_next_frame(frame);
+        if (next < frame || next > AUDIO_BLOCK_FRAMES) {
+            s_wrong++;
+            break;
+        }
+        frame = next;
+    }
+    event_sched_block_end();
+    uint64_t elapsed = now_ns() - start;
+
+    s_processed++;
+    s_prev_end = block_start + AUDIO_BLOCK_FRAMES;
+    return elapsed;
+}
+
+// --- Tests ---
+
+static void test_init(void) {
+    s_tim2->CNT = START_TICKS;
+    TEST_CHECK(event_sched_init());
+    TEST_CHECK(s_tim2->PSC == APB1_TIMER_HZ / EVENT_SCHED_TIMER_HZ - 1);
+    TEST_CHECK(s_tim2->ARR == 0xFFFFFFFFUL);
+    TEST_CHECK(s_tim2->CR1 & TIM_CR1_CEN);
+    TEST_CHECK(event_sched_now() == START_TICKS);
+    TEST_CHECK(event_sched_ticks_to_sample(START_TICKS + 10 * TICKS_PER_FRAME) == 10);
+}
+
+static void test_events(void) {
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+
+    for (uint32_t block = 0; block < BLOCKS; ++block) {
+        // The RX block interrupt at the end of block `block`
+        s_tim2->CNT = START_TICKS + (block + 1) * TICKS_PER_BLOCK;
+        event_sched_mark_block_from_isr();
+        post_events(block);
+
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 1)
+        if (block % MISSED_BLOCK_EVERY == MISSED_BLOCK_EVERY - 1) {
+            continue;
+        }
+        uint64_t ns = run_block(block * AUDIO_BLOCK_FRAMES);
+#else
+        if (block < QUEUED_BLOCKS) {
+            continue;
+        }
+        uint64_t ns = run_block((block - QUEUED_BLOCKS) * AUDIO_BLOCK_FRAMES);
+#endif
+        total_ns += ns;
+        max_ns = (ns > max_ns) ? ns : max_ns;
+    }
+
+    // Run out the events still pending, with the capture stopped
+    uint32_t end_sample = (BLOCKS + 2 * MAX_DELAY_FRAMES / AUDIO_BLOCK_FRAMES + QUEUED_BLOCKS) * AUDIO_BLOCK_FRAMES;
+    for (uint32_t block = BLOCKS; s_prev_end < end_sample; ++block) {
+        s_tim2->CNT = START_TICKS + (block + 1) * TICKS_PER_BLOCK;
+        event_sched_mark_block_from_isr();
+#if (AUDIO_PIPELINE_DIRECT_NOTIFY == 1)
+        run_block(block * AUDIO_BLOCK_FRAMES);
+#else
+        run_block((block - QUEUED_BLOCKS) * AUDIO_BLOCK_FRAMES);
+#endif
+    }
+
+    event_sched_stats_t stats;
+    event_sched_get_stats(&stats);
+    TEST_CHECK(s_wrong == 0);
+    TEST_CHECK(s_posted > MAX_EVENTS / 2);
+    TEST_CHECK(s_applied == s_posted);
+    TEST_CHECK(stats.posted == s_posted && stats.applied == s_posted);
+    TEST_CHECK(stats.pending == 0 && stats.dropped == 0);
+    TEST_CHECK(stats.late == s_late);
+    TEST_CHECK(stats.blocks == s_processed);
+    TEST_CHECK((uint32_t)(START_TICKS + BLOCKS * TICKS_PER_BLOCK) < START_TICKS);    // The counter wrapped
+
+    printf("%s: %u events over %u blocks, %u late, pending peak %u\n",
+           (AUDIO_PIPELINE_DIRECT_NOTIFY == 1) ? "direct notify" : "stream buffers",
+           (unsigned)s_posted, (unsigned)BLOCKS, (unsigned)s_late, (unsigned)stats.pending_peak);
+    printf("scheduler per block on the host: avg %.0f ns  max %.0f ns  (%.0f ns per event)\n",
+           (double)total_ns / s_processed, (double)max_ns, (double)total_ns / s_applied);
+
+    char report[320];
+    TEST_CHECK(event_sched_format(report, sizeof(report)) > 0);
+    printf("%s", report);
+}
+
+int main(void) {
+    TEST_CHECK(reg_fake_map(TIM2_ADDR, 0x1000));
+    TEST_CHECK(reg_fake_map(DWT_BASE, 0x1000));
+    test_init();
+    test_events();
+    return TEST_EXIT();
+}
@@ -0,0 +1,436 @@
+/**
+ * @file      test_low_power.c
+ * @brief     Host test of the tickless idle policy: timers on schedule.
+ *
+ * @details   low_power.c runs unchanged, called the way the Cortex-M4F port
+ *            calls its hooks from vPortSuppressTicksAndSleep(). The test
+ *            simulates the rest of the system on a nanosecond timeline:
+ *            - a 24-bit SysTick, stopped in STOP mode, whose current value
+ *              is a register fake;
+ *            - the kernel tick count and two periodic software timers;
+ *            - an LSI 5% slow, driving the RTC wakeup timer and the RTC
+ *              sub-second counter;
+ *            - the stats clock, which runs except in STOP;
+ *            - the audio DMA interrupt.
+ *
+ *            The test runs in three phases and checks the time accounting
+ *            and the report at the end:
+ *            - Audio streaming: DMA vetoes STOP, idle is WFI between DMA
+ *              interrupts, timers fire on the exact tick, and the LSI is
+ *              calibrated.
+ *            - Silence: idle goes to STOP on the RTC wakeup timer, across
+ *              a midnight wrap of the RTC. Each expiry must still be
+ *              within a tick of its period, and the timers must not drift.
+ *            - A STOP lock: WFI again, with the vetoes counted.
+ */
+
+#include "low_power.h"
+#include "runtime_stats.h"
+#include "common.h"
+#include "dma.h"
+#include "pwr.h"
+#include "rtc.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NS_PER_S                1000000000ULL
+#define NS_PER_TICK             (NS_PER_S / configTICK_RATE_HZ)
+#define COUNTS_PER_TICK         (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+#define MAX_SUPPRESSED_TICKS    (0xFFFFFFUL / COUNTS_PER_TICK)      // 24-bit SysTick
+#define SYST_CVR                MMIO32(SYS_TICK_BASE + 0x08)
+
+#define LSI_NOMINAL_HZ          32000ULL
+#define LSI_HZ                  30400ULL                            // 5% slow
+#define SUBSECOND_DIV           8ULL                                // PREDIV_A + 1 in low_power.c
+#define WAKEUP_DIV              2ULL                                // WUCKSEL = RTCCLK/2
+#define RTC_DAY_TICKS           (LSI_NOMINAL_HZ / SUBSECOND_DIV * 86400ULL)
+#define RTC_START_TICKS         (RTC_DAY_TICKS - 30ULL * LSI_NOMINAL_HZ / SUBSECOND_DIV)
+
+#define AUDIO_IRQ_NS            1333333ULL      // 64 frames at 48 kHz
+#define AUDIO_WORK_NS           150000ULL
+#define RESTORE_CLOCKS_NS       500000ULL       // HSE and PLL restart after STOP
+#define SYSTICK_ROUNDING_NS     10000ULL        // Nanoseconds to SysTick counts and back
+#define RTC_TICK_NS             (NS_PER_S * SUBSECOND_DIV / LSI_HZ)
+
+#define AUDIO_SECONDS           12
+#define SILENCE_SECONDS         60
+#define LOCKED_SECONDS          5
+
+// --- Test Data ---
+
+typedef struct {
+    TickType_t period;
+    TickType_t next;                // Tick of the next expiry
+    uint32_t fired;
+    uint64_t first_ns;              // Real time of the first expiry in the phase, 0 before it
+    uint64_t last_ns;               // Real time of the last expiry
+    uint32_t phase_fired;
+    int64_t interval_min_ns;        // Interval between expiries less the period
+    int64_t interval_max_ns;
+} sim_timer_t;
+
+static sim_timer_t s_timers[] = {
+    {.period = 250},
+    {.period = 1000},
+};
+#define TIMER_COUNT             (sizeof(s_timers) / sizeof(s_timers[0]))
+
+static uint64_t s_now_ns = 0;       // Real time
+static uint64_t s_awake_ns = 0;     // Real time outside STOP, what the stats clock counts
+static uint64_t s_next_tick_ns = NS_PER_TICK;
+static TickType_t s_tick = 0;
+static uint64_t s_work_ns = 0;      // Task work pending from interrupts
+
+static bool s_dma_active = false;
+static uint64_t s_next_dma_ns = 0;
+static uint32_t s_dma_irqs = 0;
+
+static uint32_t s_wakeup_ticks = 0;
+static bool s_wakeup_armed = false;
+static bool s_wakeup_flag = false;
+static uint32_t s_stops = 0;
+static uint32_t s_restores = 0;
+static uint32_t s_step_errors = 0;
+
+// --- Stubs for the drivers and the kernel ---
+
+uint32_t runtime_stats_get_counter(void) {
+    return (uint32_t)(s_awake_ns / 1000ULL);        // RUNTIME_STATS_COUNTER_HZ
+}
+
+bool dma_is_any_stream_active(void) {
+    return s_dma_active;
+}
+
+static int s_pwr_instance;
+static int s_rtc_instance;
+
+pwr_handle_t pwr_init(void) {
+    return (pwr_handle_t)&s_pwr_instance;
+}
+
+/** @brief STOP until the RTC wakeup timer: SysTick and the stats clock freeze. */
+void pwr_enter_stop_mode(pwr_handle_t handle) {
+    TEST_CHECK(handle == (pwr_handle_t)&s_pwr_instance);
+    TEST_CHECK(s_wakeup_armed && !s_dma_active);
+    s_now_ns += (uint64_t)s_wakeup_ticks * NS_PER_S * WAKEUP_DIV / LSI_HZ;
+    s_next_tick_ns += (uint64_t)s_wakeup_ticks * NS_PER_S * WAKEUP_DIV / LSI_HZ;
+    s_wakeup_flag = true;
+    s_stops++;
+}
+
+rtc_handle_t rtc_init(const rtc_config_t* config) {
+    TEST_CHECK(config->async_prescaler + 1 == SUBSECOND_DIV);
+    return (rtc_handle_t)&s_rtc_instance;
+}
+
+int rtc_start_wakeup_timer(rtc_handle_t handle, uint32_t ticks) {
+    (void)handle;
+    TEST_CHECK(ticks >= 1 && ticks <= 0x10000);
+    s_wakeup_ticks = ticks;
+    s_wakeup_armed = true;
+    return 0;
+}
+
+void rtc_stop_wakeup_timer(rtc_handle_t handle) {
+    (void)handle;
+    s_wakeup_armed = false;
+}
+
+bool rtc_clear_wakeup_flag(rtc_handle_t handle) {
+    (void)handle;
+    bool was_set = s_wakeup_flag;
+    s_wakeup_flag = false;
+    return was_set;
+}
+
+uint32_t rtc_get_subsecond_ticks(rtc_handle_t handle) {
+    (void)handle;
+    return (uint32_t)((RTC_START_TICKS + s_now_ns * LSI_HZ / SUBSECOND_DIV / NS_PER_S) % RTC_DAY_TICKS);
+}
+
+uint32_t rtc_get_subsecond_hz(rtc_handle_t handle) {
+    (void)handle;
+    return (uint32_t)(LSI_NOMINAL_HZ / SUBSECOND_DIV);
+}
+
+uint32_t rtc_get_wakeup_clock_hz(rtc_handle_t handle) {
+    (void)handle;
+    return (uint32_t)(LSI_NOMINAL_HZ / WAKEUP_DIV);
+}
+
+static TickType_t next_deadline(void) {
+    TickType_t deadline = s_timers[0].next;
+    for (size_t i = 1; i < TIMER_COUNT; ++i) {
+        deadline = (s_timers[i].next < deadline) ? s_timers[i].next : deadline;
+    }
+    return deadline;
+}
+
+/** @brief As the kernel asserts: a step never reaches the next unblock time. */
+void vTaskStepTick(TickType_t xTicksToJump) {
+    if (s_tick + xTicksToJump >= next_deadline()) {
+        s_step_errors++;
+    }
+    s_tick += xTicksToJump;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+static void restore_clocks(void) {
+    s_now_ns += RESTORE_CLOCKS_NS;
+    s_awake_ns += RESTORE_CLOCKS_NS;
+    s_next_tick_ns += RESTORE_CLOCKS_NS;
+    s_restores++;
+}
+
+static void tick_interrupt(void) {
+    s_tick++;
+    s_next_tick_ns += NS_PER_TICK;
+    for (size_t i = 0; i < TIMER_COUNT; ++i) {
+        sim_timer_t* p_timer = &s_timers[i];
+        if (p_timer->next != s_tick) {
+            continue;
+        }
+        if (p_timer->first_ns == 0) {
+            p_timer->first_ns = s_now_ns;
+        } else {
+            int64_t error = (int64_t)(s_now_ns - p_timer->last_ns) - (int64_t)(p_timer->period * NS_PER_TICK);
+            p_timer->interval_min_ns = (error < p_timer->interval_min_ns) ? error : p_timer->interval_min_ns;
+            p_timer->interval_max_ns = (error > p_timer->interval_max_ns) ? error : p_timer->interval_max_ns;
+        }
+        p_timer->fired++;
+        p_timer->phase_fired++;
+        p_timer->last_ns = s_now_ns;
+        p_timer->next += p_timer->period;
+    }
+}
+
+/** @brief Lets awake time pass up to `to_ns`, taking the interrupts on the way. */
+static void advance(uint64_t to_ns) {
+    for (;;) {
+        uint64_t next = s_next_tick_ns;
+        if (s_dma_active && s_next_dma_ns < next) {
+            next = s_next_dma_ns;
+        }
+        if (next > to_ns) {
+            break;
+        }
+        s_awake_ns += next - s_now_ns;
+        s_now_ns = next;
+        if (next == s_next_tick_ns) {
+            tick_interrupt();
+        } else {
+            s_dma_irqs++;
+            s_work_ns += AUDIO_WORK_NS;
+            s_next_dma_ns += AUDIO_IRQ_NS;
+        }
+    }
+    s_awake_ns += to_ns - s_now_ns;
+    s_now_ns = to_ns;
+}
+
+static uint32_t ns_to_counts(uint64_t ns) {
+    return (uint32_t)((ns * configCPU_CLOCK_HZ + NS_PER_S / 2) / NS_PER_S);
+}
+
+static uint64_t counts_to_ns(uint32_t counts) {
+    return ((uint64_t)counts * NS_PER_S + configCPU_CLOCK_HZ / 2) / configCPU_CLOCK_HZ;
+}
+
+/** @brief vPortSuppressTicksAndSleep() of the Cortex-M4F port, with its hooks. */
+static void suppress_ticks_and_sleep(TickType_t expected) {
+    // SysTick reloaded to interrupt on the expected tick
+    uint64_t sleep_end_ns = s_next_tick_ns + (uint64_t)(expected - 1) * NS_PER_TICK;
+    SYST_CVR = ns_to_counts(sleep_end_ns - s_now_ns);
+
+    TickType_t idle = expected;
+    low_power_pre_sleep(&idle);                 // configPRE_SLEEP_PROCESSING()
+    if (idle > 0) {
+        // WFI until the next interrupt; SysTick and the stats clock keep running
+        uint64_t wake_ns = sleep_end_ns;
+        if (s_dma_active && s_next_dma_ns < wake_ns) {
+            wake_ns = s_next_dma_ns;
+        }
+        s_awake_ns += wake_ns - s_now_ns;
+        s_now_ns = wake_ns;
+        SYST_CVR = ns_to_counts(sleep_end_ns - s_now_ns);
+    }
+    low_power_post_sleep(expected);             // configPOST_SLEEP_PROCESSING()
+
+    uint32_t cvr = SYST_CVR;
+    if (cvr == 0) {
+        // Counted to zero: the tick interrupt is pending and adds the last tick
+        vTaskStepTick(expected - 1);
+        s_next_tick_ns = s_now_ns;
+    } else {
+        uint32_t counted = (uint32_t)(expected * COUNTS_PER_TICK) - cvr;
+        vTaskStepTick(counted / COUNTS_PER_TICK);
+        uint32_t remainder = cvr % COUNTS_PER_TICK;
+        s_next_tick_ns = s_now_ns + counts_to_ns(remainder ? remainder : COUNTS_PER_TICK);
+    }
+    advance(s_now_ns);
+}
+
+/** @brief The scheduler: runs pending work, otherwise the idle task. */
+static void run_for(uint32_t seconds) {
+    uint64_t end_ns = s_now_ns + seconds * NS_PER_S;
+    while (s_now_ns < end_ns) {
+        if (s_work_ns > 0) {
+            uint64_t work_ns = s_work_ns;
+            s_work_ns = 0;
+            advance(s_now_ns + work_ns);
+            continue;
+        }
+        TickType_t expected = next_deadline() - s_tick;
+        if (expected < 2) {
+            // Below configEXPECTED_IDLE_TIME_BEFORE_SLEEP: wait for the tick
+            advance(s_next_tick_ns);
+            continue;
+        }
+        suppress_ticks_and_sleep((expected < MAX_SUPPRESSED_TICKS) ? expected : MAX_SUPPRESSED_TICKS);
+    }
+}
+
+static void start_phase(void) {
+    for (size_t i = 0; i < TIMER_COUNT; ++i) {
+        s_timers[i].first_ns = 0;
+        s_timers[i].phase_fired = 0;
+        s_timers[i].interval_min_ns = 0;
+        s_timers[i].interval_max_ns = 0;
+    }
+}
+
+/** @brief How far the last expiry is from the first plus whole periods. */
+static int64_t timer_drift_ns(const sim_timer_t* p_timer) {
+    uint64_t ideal_ns = (uint64_t)(p_timer->phase_fired - 1) * p_timer->period * NS_PER_TICK;
+    return (int64_t)(p_timer->last_ns - p_timer->first_ns) - (int64_t)ideal_ns;
+}
+
+/** @brief Every interval within `limit_ns` of the period, the whole phase within `drift_ns`. */
+static void check_schedule(uint32_t seconds, int64_t limit_ns, int64_t drift_ns) {
+    for (size_t i = 0; i < TIMER_COUNT; ++i) {
+        const sim_timer_t* p_timer = &s_timers[i];
+        uint32_t expected = seconds * configTICK_RATE_HZ / p_timer->period;
+        TEST_CHECK(p_timer->phase_fired + 1 >= expected && p_timer->phase_fired <= expected);
+        TEST_CHECK(p_timer->interval_min_ns >= -limit_ns && p_timer->interval_max_ns <= limit_ns);
+        TEST_CHECK(llabs(timer_drift_ns(p_timer)) <= drift_ns);
+    }
+}
+
+static void print_timers(const char* p_phase) {
+    for (size_t i = 0; i < TIMER_COUNT; ++i) {
+        printf("%s: %4u ms timer fired %4u times, interval error %+.3f..%+.3f ms, drift %+.3f ms\n",
+               p_phase, (unsigned)s_timers[i].period, (unsigned)s_timers[i].phase_fired,
+               s_timers[i].interval_min_ns / 1e6, s_timers[i].interval_max_ns / 1e6,
+               timer_drift_ns(&s_timers[i]) / 1e6);
+    }
+}
+
+// --- Tests ---
+
+static void test_audio(void) {
+    start_phase();
+    s_dma_active = true;
+    s_next_dma_ns = s_now_ns + AUDIO_IRQ_NS;
+    run_for(AUDIO_SECONDS);
+    s_dma_active = false;
+
+    low_power_stats_t stats;
+    low_power_get_stats(&stats);
+    print_timers("audio");
+    TEST_CHECK(s_stops == 0 && stats.stop_count == 0);
+    TEST_CHECK(stats.stop_dma_vetoes > 0 && stats.stop_lock_vetoes == 0);
+    TEST_CHECK(stats.sleep_count >= s_dma_irqs);
+    check_schedule(AUDIO_SECONDS, SYSTICK_ROUNDING_NS, SYSTICK_ROUNDING_NS);
+
+    // Calibrated against the stats clock after 10 s awake
+    printf("LSI calibrated to %u Hz (%u Hz)\n", (unsigned)stats.lsi_hz, (unsigned)LSI_HZ);
+    TEST_CHECK(stats.lsi_hz > LSI_HZ * 995 / 1000 && stats.lsi_hz < LSI_HZ * 1005 / 1000);
+}
+
+static void test_silence(void) {
+    start_phase();
+    uint32_t rtc_before = rtc_get_subsecond_ticks(NULL);
+    run_for(SILENCE_SECONDS);
+    TEST_CHECK(rtc_get_subsecond_ticks(NULL) < rtc_before);  // Went through midnight
+
+    low_power_stats_t stats;
+    low_power_get_stats(&stats);
+    print_timers("silence");
+    TEST_CHECK(stats.stop_count == s_stops && s_stops > 0);
+    TEST_CHECK(stats.stop_timer_wakeups == s_stops && s_restores == s_stops);
+    // A STOP period is stepped in whole ticks measured on the RTC, the rest
+    // carried over: a tick and an RTC count off at most. Over the phase the
+    // timers drift only by the calibration error, two RTC counts in its window
+    int64_t limit_ns = (int64_t)(NS_PER_TICK + RTC_TICK_NS);
+    int64_t calibration_ns = (int64_t)(SILENCE_SECONDS * 2ULL * RTC_TICK_NS * 1000ULL / LOW_POWER_CALIBRATION_PERIOD_MS);
+    check_schedule(SILENCE_SECONDS, limit_ns, limit_ns + calibration_ns);
+}
+
+static void test_locked(void) {
+    low_power_stats_t before;
+    low_power_get_stats(&before);
+    low_power_stop_lock();
+    low_power_stop_lock();
+    low_power_stop_unlock();
+    start_phase();
+    run_for(LOCKED_SECONDS);
+    low_power_stop_unlock();
+
+    low_power_stats_t stats;
+    low_power_get_stats(&stats);
+    print_timers("locked");
+    TEST_CHECK(stats.stop_count == before.stop_count);
+    TEST_CHECK(stats.stop_lock_vetoes > before.stop_lock_vetoes);
+    TEST_CHECK(stats.stop_dma_vetoes == before.stop_dma_vetoes);
+    check_schedule(LOCKED_SECONDS, SYSTICK_ROUNDING_NS, SYSTICK_ROUNDING_NS);
+}
+
+static void test_accounting(void) {
+    low_power_stats_t stats;
+    low_power_get_stats(&stats);
+    uint64_t total_us = stats.run_us + stats.sleep_us + stats.stop_us;
+    uint64_t real_us = s_now_ns / 1000ULL;
+    printf("accounted %llu us of %llu us: run %llu, sleep %llu, stop %llu\n", (unsigned long long)total_us,
+           (unsigned long long)real_us, (unsigned long long)stats.run_us, (unsigned long long)stats.sleep_us,
+           (unsigned long long)stats.stop_us);
+    TEST_CHECK(total_us > real_us * 995 / 1000 && total_us < real_us * 1005 / 1000);
+    TEST_CHECK(stats.stop_us > stats.sleep_us && stats.sleep_us > stats.run_us);
+
+    char report[512];
+    size_t len = low_power_format(report, sizeof(report));
+    printf("%s", report);
+    TEST_CHECK(len > 0 && len < sizeof(report) - 1);
+    TEST_CHECK(strstr(report, "Wakeups/s:") != NULL && strstr(report, "LSI:") != NULL);
+
+    low_power_reset_stats();
+    low_power_get_stats(&stats);
+    TEST_CHECK(stats.run_us == 0 && stats.sleep_us == 0 && stats.stop_us == 0 && stats.stop_count == 0);
+}
+
+int main(void) {
+    TEST_CHECK(reg_fake_map(SCS_BASE, 0x1000));
+    TEST_CHECK(low_power_init(restore_clocks));
+    for (size_t i = 0; i < TIMER_COUNT; ++i) {
+        s_timers[i].next = s_timers[i].period;
+    }
+
+    test_audio();
+    test_silence();
+    test_locked();
+    test_accounting();
+    TEST_CHECK(s_step_errors == 0);
+    return TEST_EXIT();
+}
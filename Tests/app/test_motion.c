@@ -0,0 +1,265 @@
+/**
+ * @file      test_motion.c
+ * @brief     Host test of motion.c on recorded accelerometer data.
+ *
+ * @details   A recording of a hand-held board at the sensor's 1600 Hz,
+ *            quantised at the 2 g sensitivity, is fed through motion.c and
+ *            ctrl.c in ACCEL_WATERMARK-sample blocks, as sensorTask drives
+ *            them. The recording holds the board tilted with hand tremor and
+ *            sensor noise, sweeps it to another tilt, holds it again, and
+ *            taps it:
+ *
+ *            - Jitter: held still, the RMS block-to-block change of each
+ *              parameter is far below that of the linear, unfiltered
+ *              mapping sensorTask used before, and motion_get_stats()
+ *              reports what the test measures on the outputs.
+ *            - Accuracy: held still, each parameter sits on the response
+ *              curve of the held tilt; level within the dead zone gives
+ *              exactly 0.5.
+ *            - Lag: after the sweep, param1 settles within SETTLE_MS.
+ *            - Taps move the parameters by less than TAP_DEVIATION.
+ *            - CPU cost: the host time per block is printed; the cycles
+ *              motion_process() reads from the DWT on either side of its
+ *              work are those it reports.
+ */
+
+#include "motion.h"
+#include "common.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RATE_HZ             1600.0f
+#define BLOCK_SAMPLES       16                  // ACCEL_WATERMARK in main.c
+#define COUNTS_PER_G        16384.0f
+#define DEG                 ((float)M_PI / 180.0f)
+
+// The recording, in blocks of BLOCK_SAMPLES (100 per second)
+#define HOLD1_BLOCKS        800                 // Pitch 20, roll 3 degrees
+#define SWEEP_BLOCKS        150                 // To pitch -30, roll 25 degrees
+#define HOLD2_BLOCKS        400
+#define TAP_BLOCKS          400                 // Held, tapped every 0.7 s
+#define RECORDING_BLOCKS    (HOLD1_BLOCKS + SWEEP_BLOCKS + HOLD2_BLOCKS + TAP_BLOCKS)
+#define SETTLE_BLOCKS       300                 // Start-up and after the sweep, before measuring
+
+#define TREMOR_HZ           9.0f
+#define TREMOR_G            0.02f
+#define NOISE_G             0.004f              // RMS, 150 ug/sqrt(Hz) over 800 Hz
+#define TAP_G               0.8f
+#define TAP_SAMPLES         8                   // 5 ms
+
+#define SETTLE_MS           300
+#define TAP_DEVIATION       0.05f
+#define DWT_CYCCNT_ADDR     (DWT_BASE + 0x004)
+#define DWT_STEP            1234                // Cycles the DWT advances per read when trapped
+
+// --- Test Data ---
+static lis3dsh_sample_t s_recording[RECORDING_BLOCKS * BLOCK_SAMPLES];
+static float s_param[RECORDING_BLOCKS][2];
+
+// --- Stubs ---
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+static void on_dwt_access(uintptr_t address, bool is_write) {
+    (void)address;
+    (void)is_write;
+    MMIO32(DWT_CYCCNT_ADDR) += DWT_STEP;
+}
+
+// --- Helpers ---
+
+/** @brief Uniform in [-1, 1) from a linear congruential generator. */
+static float noise(uint32_t* p_seed) {
+    *p_seed = *p_seed * 1664525u + 1013904223u;
+    return (float)(*p_seed >> 8) / 8388608.0f - 1.0f;
+}
+
+static int16_t to_counts(float g) {
+    float counts = roundf(g * COUNTS_PER_G);
+    return (int16_t)fmaxf(-32768.0f, fminf(32767.0f, counts));
+}
+
+/** @brief Smooth 0..1 step over [0, 1]. */
+static float smoothstep(float x) {
+    x = fmaxf(0.0f, fminf(1.0f, x));
+    return x * x * (3.0f - 2.0f * x);
+}
+
+static void record_motion(void) {
+    uint32_t seed = 2024;
+    for (int i = 0; i < RECORDING_BLOCKS * BLOCK_SAMPLES; ++i) {
+        int block = i / BLOCK_SAMPLES;
+        float t = (float)i / RATE_HZ;
+        float sweep = smoothstep((float)(block - HOLD1_BLOCKS) / SWEEP_BLOCKS);
+        float pitch = (20.0f + sweep * (-30.0f - 20.0f)) * DEG;
+        float roll = (3.0f + sweep * (25.0f - 3.0f)) * DEG;
+
+        // Gravity in the board frame, inverting ctrl_tilt()
+        float x = sinf(pitch);
+        float y = cosf(pitch) * sinf(roll);
+        float z = cosf(pitch) * cosf(roll);
+
+        // Tremor on all axes, a little out of phase, and white sensor noise
+        float tremor = TREMOR_G * sinf(2.0f * (float)M_PI * TREMOR_HZ * t);
+        x += tremor + NOISE_G * 1.732f * noise(&seed);
+        y += 0.7f * tremor + NOISE_G * 1.732f * noise(&seed);
+        z += 0.3f * tremor + NOISE_G * 1.732f * noise(&seed);
+
+        int tap_start = (HOLD1_BLOCKS + SWEEP_BLOCKS + HOLD2_BLOCKS) * BLOCK_SAMPLES;
+        if (i >= tap_start && (i - tap_start) % 1120 < TAP_SAMPLES) {
+            z -= TAP_G;
+        }
+        s_recording[i] = (lis3dsh_sample_t){.x = to_counts(x), .y = to_counts(y), .z = to_counts(z)};
+    }
+}
+
+/** @brief The response curve of motion.h, restated. */
+static float curve(float angle) {
+    float u = angle / (MOTION_TILT_RANGE_DEG * DEG);
+    u = fmaxf(-1.0f, fminf(1.0f, u));
+    float magnitude = fabsf(u);
+    if (magnitude <= MOTION_DEAD_ZONE) {
+        return 0.5f;
+    }
+    magnitude = powf((magnitude - MOTION_DEAD_ZONE) / (1.0f - MOTION_DEAD_ZONE), MOTION_CURVE_GAMMA);
+    return 0.5f + 0.5f * ((u < 0.0f) ? -magnitude : magnitude);
+}
+
+/** @brief The mapping sensorTask used before: the last raw sample, linear over +-2 g. */
+static void linear_map(const lis3dsh_sample_t* p_block, float* p_param1, float* p_param2) {
+    const lis3dsh_sample_t* p_last = &p_block[BLOCK_SAMPLES - 1];
+    *p_param1 = fmaxf(0.0f, fminf(1.0f, (float)p_last->x / COUNTS_PER_G / 4.0f + 0.5f));
+    *p_param2 = fmaxf(0.0f, fminf(1.0f, (float)p_last->y / COUNTS_PER_G / 4.0f + 0.5f));
+}
+
+/** @brief Jitter as motion.c measures it: exponential mean square of the change, in ppm RMS. */
+static uint32_t jitter_ppm(const float (*p_values)[2], int index, int first, int last) {
+    float ms = 0.0f;
+    for (int block = first + 1; block <= last; ++block) {
+        float delta = p_values[block][index] - p_values[block - 1][index];
+        ms += (delta * delta - ms) / (float)MOTION_JITTER_BLOCKS;
+    }
+    return (uint32_t)(sqrtf(ms) * 1e6f);
+}
+
+static float max_deviation(int index, int first, int last, float from) {
+    float worst = 0.0f;
+    for (int block = first; block <= last; ++block) {
+        worst = fmaxf(worst, fabsf(s_param[block][index] - from));
+    }
+    return worst;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// --- Tests ---
+
+static void test_recording(void) {
+    static float linear[RECORDING_BLOCKS][2];
+    const float g_per_count = 1.0f / COUNTS_PER_G;
+
+    motion_init(RATE_HZ);
+    double start = now_ns();
+    for (int block = 0; block < RECORDING_BLOCKS; ++block) {
+        motion_process(&s_recording[block * BLOCK_SAMPLES], BLOCK_SAMPLES, g_per_count, &s_param[block][0],
+                       &s_param[block][1]);
+    }
+    double ns_per_block = (now_ns() - start) / RECORDING_BLOCKS;
+    for (int block = 0; block < RECORDING_BLOCKS; ++block) {
+        linear_map(&s_recording[block * BLOCK_SAMPLES], &linear[block][0], &linear[block][1]);
+    }
+
+    // Held still: far below the old mapping, on the curve, and exactly level in the dead zone
+    motion_stats_t stats;
+    int hold1_end = HOLD1_BLOCKS - 1;
+    uint32_t jitter1 = jitter_ppm(s_param, 0, SETTLE_BLOCKS, hold1_end);
+    uint32_t old_jitter1 = jitter_ppm(linear, 0, SETTLE_BLOCKS, hold1_end);
+    TEST_CHECK(old_jitter1 > 5 * jitter1);
+    TEST_CHECK(jitter_ppm(s_param, 1, SETTLE_BLOCKS, hold1_end) == 0);
+    TEST_CHECK(fabsf(s_param[hold1_end][0] - curve(20.0f * DEG)) < 0.005f);
+    TEST_CHECK(max_deviation(1, SETTLE_BLOCKS, hold1_end, 0.5f) == 0.0f);
+
+    // The sweep: settled on the new tilt within SETTLE_MS of its end
+    int sweep_end = HOLD1_BLOCKS + SWEEP_BLOCKS;
+    int settled = sweep_end + SETTLE_MS / 10;
+    float target1 = curve(-30.0f * DEG);
+    float target2 = curve(25.0f * DEG);
+    float start1 = s_param[HOLD1_BLOCKS - 1][0];
+    TEST_CHECK(fabsf(s_param[settled][0] - target1) < 0.05f * fabsf(target1 - start1));
+    TEST_CHECK(fabsf(s_param[settled + SETTLE_BLOCKS][0] - target1) < 0.005f);
+    TEST_CHECK(fabsf(s_param[settled + SETTLE_BLOCKS][1] - target2) < 0.005f);
+    int lag_blocks = 0;
+    while (sweep_end + lag_blocks < RECORDING_BLOCKS &&
+           fabsf(s_param[sweep_end + lag_blocks][0] - target1) > 0.05f * fabsf(target1 - start1)) {
+        lag_blocks++;
+    }
+
+    // Taps: the parameters hardly move
+    int tap_start = sweep_end + HOLD2_BLOCKS;
+    float steady1 = s_param[tap_start - 1][0];
+    float steady2 = s_param[tap_start - 1][1];
+    float tap1 = max_deviation(0, tap_start, RECORDING_BLOCKS - 1, steady1);
+    float tap2 = max_deviation(1, tap_start, RECORDING_BLOCKS - 1, steady2);
+    TEST_CHECK(tap1 < TAP_DEVIATION && tap2 < TAP_DEVIATION);
+
+    // The stats average over the last MOTION_JITTER_BLOCKS, here all while tapped
+    motion_get_stats(&stats);
+    TEST_CHECK(stats.blocks == RECORDING_BLOCKS && stats.samples_per_block == BLOCK_SAMPLES);
+    for (int i = 0; i < 2; ++i) {
+        uint32_t measured = jitter_ppm(s_param, i, 0, RECORDING_BLOCKS - 1);
+        TEST_CHECK(stats.jitter_ppm[i] >= measured * 99 / 100 && stats.jitter_ppm[i] <= measured * 101 / 100 + 1);
+    }
+
+    printf("held still: param1 jitter %lu ppm (linear mapping %lu ppm), param2 %lu ppm in the dead zone\n",
+           (unsigned long)jitter1, (unsigned long)old_jitter1,
+           (unsigned long)jitter_ppm(s_param, 1, SETTLE_BLOCKS, hold1_end));
+    printf("sweep: within 5 %% after %d ms; taps: moved %.4f / %.4f\n", lag_blocks * 10, tap1, tap2);
+    printf("cost: %.0f ns per block of %d samples on this host\n", ns_per_block, BLOCK_SAMPLES);
+}
+
+static void test_cycles(void) {
+    char report[256];
+    float param1, param2;
+
+    motion_init(RATE_HZ);
+    TEST_CHECK(reg_fake_trap(DWT_BASE, 0x1000, on_dwt_access));
+    for (int block = 0; block < 4; ++block) {
+        motion_process(&s_recording[block * BLOCK_SAMPLES], BLOCK_SAMPLES, 1.0f / COUNTS_PER_G, &param1, &param2);
+    }
+    reg_fake_untrap();
+
+    // One step from the read at the start to the read at the end
+    motion_stats_t stats;
+    motion_get_stats(&stats);
+    TEST_CHECK(stats.cycles_last == DWT_STEP && stats.cycles_max == DWT_STEP);
+
+    size_t n = motion_report(report, sizeof(report));
+    TEST_CHECK(n == strlen(report));
+    TEST_CHECK(strstr(report, "Motion: 4 blocks of 16 samples\r\n") != NULL);
+    TEST_CHECK(strstr(report, "cycles/block 1234 (max 1234, 7 us)\r\n") != NULL);
+}
+
+int main(void) {
+    if (!reg_fake_map(DWT_BASE, 0x1000)) {
+        fprintf(stderr, "cannot map the DWT on this host\n");
+        return 1;
+    }
+    record_motion();
+    test_recording();
+    test_cycles();
+    return TEST_EXIT();
+}
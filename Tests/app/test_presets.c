@@ -0,0 +1,347 @@
+/**
+ * @file      test_presets.c
+ * @brief     Host test of the preset store on the STM32F407 flash port.
+ *
+ * @details   presets.c, kvstore.c, flash.c and the STM32F407 port run
+ *            unchanged against the register fake. Sectors 1 and 2 are
+ *            mapped at their real address and the FLASH registers are
+ *            trapped. The hook plays the controller on a cycle timeline on
+ *            DWT_CYCCNT:
+ *
+ *            - Each register access costs ACCESS_CYCLES.
+ *            - KEYR unlocks CR on the two keys in order; SR flags are
+ *              cleared by writing ones.
+ *            - A program unit starts on the first SR read after the data
+ *              write and keeps BSY for PROGRAM_US, at any PSIZE (RM0090,
+ *              datasheet tPROG). A bit set by a program, rather than cleared,
+ *              is counted as a violation.
+ *            - A sector erase takes erase_ms() for its PSIZE and sets the
+ *              sector to 0xFF. The caller returns from the port through
+ *              FLASH code, which stalls on this single bank, so its next
+ *              register access only comes once the erase is over.
+ *
+ *            - Saves program at x32: the reported KB/s is that of one word
+ *              per PROGRAM_US, a quarter of that at x8.
+ *            - An erase while audio is stopped is reported with its time,
+ *              and the longest the CPU went unscheduled covers all of it:
+ *              that is the scheduling latency an erase costs every task.
+ *            - Once audio streams, a save that needs an erase is refused and
+ *              counted, nothing is erased and the saved presets stay.
+ *            - presets_init() compacts a nearly full store at power-on.
+ */
+
+#include "presets.h"
+#include "kvstore.h"
+#include "flash.h"
+#include "rcc.h"
+#include "common.h"
+#include "internal/flash_reg.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define FLASH_REGS_BASE     0x40023C00UL
+#define FLASH_REGS_PAGE     0x40023000UL
+#define DWT_CYCCNT_ADDR     (DWT_BASE + 0x004)
+#define STORE_BYTES         (2 * PRESETS_FLASH_SECTOR_BYTES)
+
+// Flash timing, in CPU cycles (HCLK) at configCPU_CLOCK_HZ
+#define ACCESS_CYCLES       4                   // One register access by the CPU
+#define US_TO_CYCLES(us)    ((uint32_t)((uint64_t)(us) * configCPU_CLOCK_HZ / 1000000ULL))
+#define PROGRAM_US          16                  // One unit, x8 to x64
+
+#define MAX_SAVES           2000
+#define REPORT_BYTES        512
+
+typedef enum {
+    OP_NONE,
+    OP_PROGRAM,
+    OP_ERASE,
+} flash_op_t;
+
+// --- Test Data ---
+static flash_reg_map_t* const s_regs = (flash_reg_map_t*)FLASH_REGS_BASE;
+static uint8_t* const s_store = (uint8_t*)PRESETS_FLASH_ADDRESS;
+static uint8_t s_shadow[STORE_BYTES];           // The store as last checked
+
+// Controller state
+static uint32_t s_sr;                           // SR as the hardware holds it
+static uintptr_t s_last_address;                // Access of the previous hook call
+static bool s_last_is_write;
+static bool s_key1_seen;
+static flash_op_t s_op = OP_NONE;
+static uint32_t s_busy_until;
+static bool s_unit_pending = false;             // Data written, program starts on the next SR read
+static bool s_error_read_next = false;          // The wait's error read follows a completed unit
+
+// What the port did
+static uint32_t s_units[4];                     // Program units by PSIZE
+static uint32_t s_violations = 0;               // Programs that set bits
+static uint32_t s_erases = 0;
+static uint32_t s_bad_erases = 0;               // Outside sectors 1 and 2, or while locked
+
+static bool s_is_streaming = false;
+
+// --- Stubs for the application and the RCC driver ---
+
+bool audio_io_is_streaming(void) {
+    return s_is_streaming;
+}
+
+int rcc_register_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    (void)listener;
+    (void)p_context;
+    return 0;
+}
+
+void rcc_unregister_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    (void)listener;
+    (void)p_context;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers ---
+
+/** @brief Sector erase time for a parallelism, datasheet typical values. */
+static uint32_t erase_ms(uint32_t psize) {
+    static const uint32_t ms[] = {400, 300, 250, 250};
+    return ms[psize];
+}
+
+/** @brief Counts bits the programs since the last check set, and takes the store as the new reference. */
+static void check_programs(void) {
+    for (size_t i = 0; i < STORE_BYTES; ++i) {
+        if ((s_store[i] & ~s_shadow[i]) != 0) {
+            s_violations++;
+        }
+    }
+    memcpy(s_shadow, s_store, STORE_BYTES);
+}
+
+static void start_erase(uint32_t cr, uint32_t now) {
+    uint32_t sector = (cr & FLASH_CR_SNB_Msk) >> FLASH_CR_SNB_Pos;
+    if ((cr & FLASH_CR_LOCK_Msk) || sector < PRESETS_FLASH_SECTOR || sector > PRESETS_FLASH_SECTOR + 1) {
+        s_bad_erases++;
+        s_regs->CR &= ~FLASH_CR_STRT_Msk;
+        return;
+    }
+    s_erases++;
+    s_op = OP_ERASE;
+    s_sr |= FLASH_SR_BSY_Msk;
+    s_busy_until = now + US_TO_CYCLES(erase_ms((cr & FLASH_CR_PSIZE_Msk) >> FLASH_CR_PSIZE_Pos) * 1000);
+}
+
+static void finish_op(void) {
+    if (s_op == OP_ERASE) {
+        uint32_t sector = (s_regs->CR & FLASH_CR_SNB_Msk) >> FLASH_CR_SNB_Pos;
+        size_t offset = (size_t)(sector - PRESETS_FLASH_SECTOR) * PRESETS_FLASH_SECTOR_BYTES;
+        memset(&s_store[offset], 0xFF, PRESETS_FLASH_SECTOR_BYTES);
+        memset(&s_shadow[offset], 0xFF, PRESETS_FLASH_SECTOR_BYTES);
+        s_regs->CR &= ~FLASH_CR_STRT_Msk;
+    } else {
+        s_error_read_next = true;
+    }
+    MMIO32(DWT_CYCCNT_ADDR) = s_busy_until;
+    s_sr = (s_sr & ~FLASH_SR_BSY_Msk) | FLASH_SR_EOP_Msk;
+    s_op = OP_NONE;
+}
+
+/** @brief Plays the FLASH controller; called before each register access. */
+static void on_access(uintptr_t address, bool is_write) {
+    // What the previous access wrote takes effect now
+    if (s_last_is_write) {
+        if (s_last_address == (uintptr_t)&s_regs->SR) {
+            s_sr &= ~(s_regs->SR & (FLASH_SR_ERR_Msk | FLASH_SR_EOP_Msk));
+        } else if (s_last_address == (uintptr_t)&s_regs->KEYR) {
+            if (s_regs->KEYR == FLASH_KEYR_KEY1) {
+                s_key1_seen = true;
+            } else {
+                if (s_regs->KEYR == FLASH_KEYR_KEY2 && s_key1_seen) {
+                    s_regs->CR &= ~FLASH_CR_LOCK_Msk;
+                }
+                s_key1_seen = false;
+            }
+        } else if (s_last_address == (uintptr_t)&s_regs->CR) {
+            if (s_regs->CR & FLASH_CR_PG_Msk) {
+                s_unit_pending = true;          // Programming enabled or PSIZE changed
+            } else {
+                check_programs();
+            }
+        }
+    }
+    s_last_address = address;
+    s_last_is_write = is_write;
+
+    MMIO32(DWT_CYCCNT_ADDR) += ACCESS_CYCLES;
+    uint32_t now = MMIO32(DWT_CYCCNT_ADDR);
+    uint32_t cr = s_regs->CR;
+
+    if (s_op == OP_NONE && (cr & FLASH_CR_STRT_Msk) && (cr & FLASH_CR_SER_Msk)) {
+        // The caller got here through FLASH code, stalled until the erase ended
+        start_erase(cr, now);
+        if (s_op == OP_ERASE) {
+            finish_op();
+        }
+    } else if (address == (uintptr_t)&s_regs->SR && !is_write && (cr & FLASH_CR_PG_Msk)) {
+        if (s_op == OP_PROGRAM) {
+            finish_op();                        // Spun on BSY until now
+        } else if (s_error_read_next) {
+            s_error_read_next = false;
+            s_unit_pending = true;
+        } else if (s_unit_pending) {
+            s_unit_pending = false;
+            s_units[(cr & FLASH_CR_PSIZE_Msk) >> FLASH_CR_PSIZE_Pos]++;
+            s_op = OP_PROGRAM;
+            s_sr |= FLASH_SR_BSY_Msk;
+            s_busy_until = now + US_TO_CYCLES(PROGRAM_US);
+        }
+    }
+    s_regs->SR = s_sr;
+}
+
+/** @brief A preset that differs from the one saved before it. */
+static preset_t make_preset(uint32_t n) {
+    preset_t preset = {
+        .effect = (uint8_t)(n % 4),
+        .param1 = (float)(n % 1000) / 1000.0f,
+        .param2 = (float)((n * 7) % 1000) / 1000.0f,
+    };
+    return preset;
+}
+
+static bool preset_equal(const preset_t* p_a, const preset_t* p_b) {
+    return p_a->effect == p_b->effect && p_a->param1 == p_b->param1 && p_a->param2 == p_b->param2;
+}
+
+/** @brief Reads a labelled number from the report, -1 if absent. */
+static long report_value(const char* p_label) {
+    char report[REPORT_BYTES];
+    presets_format(report, sizeof(report));
+    const char* p = strstr(report, p_label);
+    return (p != NULL) ? strtol(p + strlen(p_label), NULL, 10) : -1;
+}
+
+// --- Tests ---
+
+static uint32_t s_saved = 0;                    // Presets saved so far, preset n in slot n % PRESETS_SLOTS
+
+/** @brief The preset saved last to a slot. */
+static preset_t latest_in_slot(uint32_t slot) {
+    return make_preset(s_saved - 1 - ((s_saved - 1 - slot) % PRESETS_SLOTS));
+}
+
+static void test_program(void) {
+    TEST_CHECK(presets_init());
+    for (uint32_t i = 0; i < 200; ++i, ++s_saved) {
+        preset_t preset = make_preset(s_saved);
+        TEST_CHECK(presets_save(s_saved % PRESETS_SLOTS, &preset) == 0);
+    }
+
+    // Word units only: the records are 4-byte aligned
+    TEST_CHECK(s_units[2] > 200 * 4 && s_units[0] == 0 && s_units[1] == 0 && s_units[3] == 0);
+    TEST_CHECK(s_violations == 0 && s_erases == 0);
+
+    // One word per PROGRAM_US, less the register accesses around it
+    long kbps = report_value("Program: ");
+    long word_kbps = (long)(4 * 1000000ULL / PROGRAM_US / 1024);
+    TEST_CHECK(kbps <= word_kbps && kbps >= word_kbps * 95 / 100);
+    printf("program: %lu words at x32, %ld KB/s (x8 would be %ld KB/s)\n", (unsigned long)s_units[2], kbps,
+           word_kbps / 4);
+}
+
+static void test_erase_latency(void) {
+    uint32_t saves = 0;
+    while (s_erases == 0 && saves < MAX_SAVES) {
+        preset_t preset = make_preset(s_saved);
+        TEST_CHECK(presets_save(s_saved % PRESETS_SLOTS, &preset) == 0);
+        s_saved++;
+        saves++;
+    }
+    TEST_CHECK(s_erases > 0 && s_bad_erases == 0 && s_violations == 0);
+
+    long erase = report_value("KB/s  erase: ");
+    long unscheduled = report_value("longest unscheduled: ");
+    TEST_CHECK(erase == (long)erase_ms(2) && report_value("(max ") == erase);
+    TEST_CHECK(unscheduled >= erase && unscheduled <= erase + 1);
+    TEST_CHECK(report_value("compactions: ") >= 1);
+
+    for (uint32_t slot = 0; slot < PRESETS_SLOTS; ++slot) {
+        preset_t preset;
+        preset_t expected = latest_in_slot(slot);
+        TEST_CHECK(presets_load(slot, &preset) == 0 && preset_equal(&preset, &expected));
+    }
+    printf("erase after %lu saves: %ld ms, scheduling latency %ld ms\n", (unsigned long)saves, erase, unscheduled);
+}
+
+static void test_refused_while_streaming(void) {
+    s_is_streaming = true;
+    uint32_t erases = s_erases;
+    int ret = 0;
+    uint32_t saves = 0;
+    while (ret == 0 && saves < MAX_SAVES) {
+        preset_t preset = make_preset(s_saved);
+        ret = presets_save(s_saved % PRESETS_SLOTS, &preset);
+        if (ret == 0) {
+            s_saved++;
+        }
+        saves++;
+    }
+    TEST_CHECK(ret == PRESETS_ERR_STREAMING);
+    preset_t preset = make_preset(s_saved);
+    TEST_CHECK(presets_save(s_saved % PRESETS_SLOTS, &preset) == PRESETS_ERR_STREAMING);
+    TEST_CHECK(s_erases == erases && s_violations == 0);
+    TEST_CHECK(report_value("Saves refused while streaming: ") == 2);
+
+    // The last presets that were saved are still there
+    for (uint32_t slot = 0; slot < PRESETS_SLOTS; ++slot) {
+        preset_t expected = latest_in_slot(slot);
+        TEST_CHECK(presets_load(slot, &preset) == 0 && preset_equal(&preset, &expected));
+    }
+    printf("streaming: refused after %lu saves, nothing erased\n", (unsigned long)(saves - 1));
+}
+
+static void test_boot_compaction(void) {
+    s_is_streaming = false;
+    uint32_t erases = s_erases;
+    TEST_CHECK(presets_init());
+    TEST_CHECK(s_erases > erases && s_violations == 0);
+    TEST_CHECK(report_value("free ") >= PRESETS_COMPACT_RESERVE_BYTES);
+
+    for (uint32_t slot = 0; slot < PRESETS_SLOTS; ++slot) {
+        preset_t preset;
+        preset_t expected = latest_in_slot(slot);
+        TEST_CHECK(presets_load(slot, &preset) == 0 && preset_equal(&preset, &expected));
+    }
+    preset_t preset = make_preset(s_saved);
+    TEST_CHECK(presets_save(s_saved % PRESETS_SLOTS, &preset) == 0);
+}
+
+int main(void) {
+    if (!reg_fake_map(FLASH_REGS_PAGE, 0x1000) || !reg_fake_map(DWT_BASE, 0x1000) ||
+        !reg_fake_map(PRESETS_FLASH_ADDRESS, STORE_BYTES)) {
+        fprintf(stderr, "cannot map the FLASH registers, the DWT or the store on this host\n");
+        return 1;
+    }
+    memset(s_store, 0xFF, STORE_BYTES);
+    memset(s_shadow, 0xFF, STORE_BYTES);
+    s_regs->CR = FLASH_CR_LOCK_Msk;
+
+    if (!reg_fake_trap(FLASH_REGS_BASE, sizeof(flash_reg_map_t), on_access)) {
+        fprintf(stderr, "cannot trap the FLASH registers on this host\n");
+        return 1;
+    }
+    test_program();
+    test_erase_latency();
+    test_refused_while_streaming();
+    test_boot_compaction();
+    reg_fake_untrap();
+    return TEST_EXIT();
+}
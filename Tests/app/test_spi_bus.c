@@ -0,0 +1,458 @@
+/**
+ * @file      test_spi_bus.c
+ * @brief     Host test of the SPI DMA transfers and benchmark on the STM32F407 ports.
+ *
+ * @details   spi_bus.c, spi.c and dma.c run unchanged on their STM32F407
+ *            ports, against the register fake with SPI1, DMA2 and the DWT
+ *            trapped. One hook plays all three on a cycle timeline:
+ *
+ *            - The CPU: each peripheral register access costs ACCESS_CYCLES
+ *              and each cycle counter read READ_CYCLES, the cost of one pass
+ *              of a polling loop.
+ *            - SPI1 with MOSI wired to MISO, one frame per FRAME_CYCLES at
+ *              the configured prescaler, with TXE, RXNE and BSY and a TX
+ *              buffer ahead of the shift register.
+ *            - DMA2 Stream2 (RX) and Stream3 (TX) serving the SPI requests,
+ *              with the transfer-complete flags. The Stream2 interrupt is
+ *              taken at the next cycle counter read, as the code under test
+ *              never reads it with interrupts masked, and its handler's
+ *              register accesses are charged to the CPU too.
+ *
+ *            - Queue: transactions with and without TX/RX data run back to
+ *              back, in order, each inside its chip select, and receive what
+ *              they sent. Blocking transfers are refused while one runs.
+ *            - Benchmark: the blocking transfer runs at about the bus rate
+ *              with the CPU busy throughout. The DMA transfer runs at the
+ *              bus rate, and its reported CPU cycles are the ones the model
+ *              charged outside the spin loop, within two loop passes.
+ *
+ *            Built with -no-pie so that static buffers sit below 4 GB, where
+ *            the 32-bit DMA address registers can hold them.
+ */
+
+#include "spi_bus.h"
+#include "spi.h"
+#include "spi_config.h"
+#include "common.h"
+#include "internal/dma_reg.h"
+#include "internal/spi_reg.h"
+#include "rcc.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SPI1_BASE           0x40013000UL
+#define DMA_PAGE_BASE       0x40026000UL        // DMA1 and DMA2
+#define DMA2_BASE           0x40026400UL
+#define DWT_CYCCNT_ADDR     (DWT_BASE + 0x004)
+
+#define SPI_CR1             (SPI1_BASE + 0x00)
+#define SPI_CR2             (SPI1_BASE + 0x04)
+#define SPI_SR              (SPI1_BASE + 0x08)
+#define SPI_DR              (SPI1_BASE + 0x0C)
+#define DMA_LISR            (DMA2_BASE + 0x00)
+#define DMA_LIFCR           (DMA2_BASE + 0x08)
+#define STREAM_REG(s, off)  (DMA2_BASE + 0x10 + 0x18 * (s) + (off))
+#define RX_STREAM           2
+#define TX_STREAM           3
+#define RX_IRQN             58
+#define TX_IRQN             59
+#define TCIF(s)             ((s) == 2 ? (1UL << 21) : (1UL << 27))
+
+// CPU and bus model, in CPU cycles (HCLK = 168 MHz, PCLK2 = 84 MHz)
+#define ACCESS_CYCLES       4                   // One peripheral register access
+#define READ_CYCLES         6                   // One cycle counter read and loop pass
+#define IRQ_CYCLES          24                  // Exception entry and return
+#define PRESCALER           SPI_BAUD_RATE_DIV_8
+#define FRAME_CYCLES        (8UL * (2UL << PRESCALER) * 2)
+#define BUS_BYTES_PER_S     (configCPU_CLOCK_HZ / FRAME_CYCLES)
+
+#define QUEUED              3
+#define QUEUED_BYTES        48
+
+// --- Test Data ---
+static bool s_in_model = false;                 // Model's own register accesses are free
+static bool s_in_isr = false;
+static bool s_irq_pending = false;
+static uint32_t s_now = 0;                      // CPU cycles
+static uint32_t s_charged_other = 0;            // Cycles not spent reading the counter
+static uint32_t s_counter_reads = 0;
+static uint32_t s_irqs = 0;
+
+// SPI1
+static bool s_dr_written = false;
+static bool s_tx_full = false;
+static uint16_t s_tx_buf;
+static uint32_t s_tx_at;
+static uint32_t s_txe_at = 0;                   // TX buffer empty since
+static bool s_shifting = false;
+static uint16_t s_shift_val;
+static uint32_t s_shift_end = 0;
+static bool s_rxne = false;
+static uint16_t s_rx_val;
+static uint32_t s_rx_at;
+static uint32_t s_overruns = 0;
+static uint32_t s_frames = 0;
+
+// DMA2 streams, by number
+static bool s_active[8];
+static uint16_t s_index[8];
+
+// Queue test
+static uint8_t* s_tx[QUEUED];
+static uint8_t* s_rx[QUEUED];
+static spi_transaction_t s_txns[QUEUED];
+static int s_select_log[4 * QUEUED];
+static int s_select_count = 0;
+static int s_selected = -1;
+static int s_done_order[QUEUED];
+static int s_done_count = 0;
+static int s_done_status[QUEUED];
+
+void DMA2_Stream2_IRQHandler(void);             // Defined by the SPI port
+
+// --- Stubs for the RCC driver and the kernel ---
+
+void rcc_enable_peripheral_clock(peripheral_id_t id) {
+    (void)id;
+}
+
+void vTaskSuspendAll(void) {
+}
+
+BaseType_t xTaskResumeAll(void) {
+    return pdFALSE;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers: the model ---
+
+static uint32_t later(uint32_t a, uint32_t b) {
+    return ((int32_t)(a - b) > 0) ? a : b;
+}
+
+static bool reached(uint32_t at, uint32_t now) {
+    return (int32_t)(now - at) >= 0;
+}
+
+static uint32_t frame_bytes(void) {
+    return (MMIO32(SPI_CR1) & SPI_CR1_DFF) ? 2 : 1;
+}
+
+/** @brief True if `stream` is enabled and SPI1 requests it through `dmaen`. */
+static bool dma_ready(int stream, uint32_t dmaen) {
+    return s_active[stream] && (MMIO32(SPI_CR2) & dmaen) && (MMIO32(SPI_CR1) & SPI_CR1_SPE_Msk) &&
+           MMIO32(STREAM_REG(stream, 0x04)) != 0;
+}
+
+static uint8_t* dma_item(int stream) {
+    uint32_t cr = MMIO32(STREAM_REG(stream, 0x00));
+    uint32_t offset = (cr & DMA_SxCR_MINC_Msk) ? s_index[stream] * frame_bytes() : 0;
+    return (uint8_t*)(uintptr_t)MMIO32(STREAM_REG(stream, 0x0C)) + offset;
+}
+
+/** @brief One item moved: counts NDTR down and completes the stream at 0. */
+static void dma_step(int stream) {
+    s_index[stream]++;
+    uint32_t ndtr = --MMIO32(STREAM_REG(stream, 0x04));
+    if (ndtr == 0) {
+        uint32_t cr = MMIO32(STREAM_REG(stream, 0x00));
+        MMIO32(STREAM_REG(stream, 0x00)) = cr & ~DMA_SxCR_EN_Msk;
+        s_active[stream] = false;
+        MMIO32(DMA_LISR) |= TCIF(stream);
+        if (cr & DMA_SxCR_TCIE_Msk) {
+            s_irq_pending = true;
+        }
+    }
+}
+
+/** @brief Picks up what the CPU wrote since the previous access. */
+static void sync_registers(void) {
+    uint32_t clear = MMIO32(DMA_LIFCR);
+    if (clear != 0) {
+        MMIO32(DMA_LISR) &= ~clear;
+        MMIO32(DMA_LIFCR) = 0;
+    }
+
+    if (s_dr_written) {
+        s_dr_written = false;
+        s_tx_buf = (uint16_t)MMIO32(SPI_DR);
+        s_tx_full = true;
+        s_tx_at = s_now;
+    }
+
+    for (int stream = RX_STREAM; stream <= TX_STREAM; ++stream) {
+        bool enabled = (MMIO32(STREAM_REG(stream, 0x00)) & DMA_SxCR_EN_Msk) != 0;
+        if (enabled && !s_active[stream]) {
+            s_active[stream] = true;
+            s_index[stream] = 0;
+            if (stream == TX_STREAM) {
+                s_txe_at = later(s_txe_at, s_now);
+            }
+        } else if (!enabled) {
+            s_active[stream] = false;
+        }
+    }
+}
+
+/** @brief Runs SPI1 and the two streams up to `now`. */
+static void advance(uint32_t now) {
+    for (;;) {
+        if (!s_shifting && s_tx_full) {
+            s_shifting = true;
+            s_shift_val = s_tx_buf;
+            s_shift_end = later(s_tx_at, s_shift_end) + FRAME_CYCLES;
+            s_tx_full = false;
+            s_txe_at = later(s_tx_at, s_txe_at);
+            continue;
+        }
+        if (!s_tx_full && reached(s_txe_at, now) && dma_ready(TX_STREAM, SPI_CR2_TXDMAEN)) {
+            uint16_t item = 0;
+            memcpy(&item, dma_item(TX_STREAM), frame_bytes());
+            s_tx_buf = item;
+            s_tx_full = true;
+            s_tx_at = s_txe_at;
+            dma_step(TX_STREAM);
+            continue;
+        }
+        if (s_shifting && reached(s_shift_end, now)) {
+            s_shifting = false;
+            s_overruns += s_rxne ? 1 : 0;
+            s_rxne = true;
+            s_rx_val = s_shift_val;         // MOSI wired to MISO
+            s_rx_at = s_shift_end;
+            s_frames++;
+            continue;
+        }
+        if (s_rxne && reached(s_rx_at, now) && dma_ready(RX_STREAM, SPI_CR2_RXDMAEN)) {
+            memcpy(dma_item(RX_STREAM), &s_rx_val, frame_bytes());
+            s_rxne = false;
+            dma_step(RX_STREAM);
+            continue;
+        }
+        break;
+    }
+}
+
+/** @brief Runs before each access to SPI1, the DMA page or the DWT. */
+static void on_access(uintptr_t address, bool is_write) {
+    if (s_in_model) {
+        return;
+    }
+    s_in_model = true;
+
+    bool counter_read = (address == DWT_CYCCNT_ADDR && !is_write);
+    uint32_t cost = counter_read ? READ_CYCLES : ACCESS_CYCLES;
+    s_now += cost;
+    if (counter_read) {
+        s_counter_reads++;
+    } else {
+        s_charged_other += cost;
+    }
+
+    sync_registers();
+    advance(s_now);
+
+    if (address == SPI_SR && !is_write) {
+        MMIO32(SPI_SR) = (s_tx_full ? 0 : SPI_SR_TXE) | (s_rxne ? SPI_SR_RXNE : 0) |
+                         ((s_tx_full || s_shifting) ? SPI_SR_BSY : 0);
+    } else if (address == SPI_DR && !is_write) {
+        MMIO32(SPI_DR) = s_rx_val;
+        s_rxne = false;
+    } else if (address == SPI_DR && is_write) {
+        s_dr_written = true;
+    }
+
+    bool take_irq = counter_read && s_irq_pending && !s_in_isr;
+    s_in_model = false;
+
+    if (take_irq) {
+        s_irq_pending = false;
+        s_in_isr = true;
+        s_now += IRQ_CYCLES;
+        s_charged_other += IRQ_CYCLES;
+        s_irqs++;
+        DMA2_Stream2_IRQHandler();
+        s_in_isr = false;
+    }
+    if (counter_read) {
+        MMIO32(DWT_CYCCNT_ADDR) = s_now;
+    }
+}
+
+static void wait_cycles(uint32_t cycles) {
+    uint32_t start = MMIO32(DWT_CYCCNT_ADDR);
+    while ((MMIO32(DWT_CYCCNT_ADDR) - start) < cycles) {
+    }
+}
+
+// --- Helpers: the queue test's clients ---
+
+static void select_client(int client, bool active) {
+    // A client is selected only while no other is
+    TEST_CHECK(active ? (s_selected == -1) : (s_selected == client));
+    s_selected = active ? client : -1;
+    if (s_select_count < 4 * QUEUED) {
+        s_select_log[s_select_count++] = active ? client : -1 - client;
+    }
+}
+
+static void select_0(bool active) { select_client(0, active); }
+static void select_1(bool active) { select_client(1, active); }
+static void select_2(bool active) { select_client(2, active); }
+
+static void on_done(void* p_context, int status) {
+    int client = (int)(intptr_t)p_context;
+    TEST_CHECK(s_selected == -1 || s_selected == (client + 1));     // Next one may be running
+    if (s_done_count < QUEUED) {
+        s_done_order[s_done_count] = client;
+        s_done_status[s_done_count] = status;
+        s_done_count++;
+    }
+}
+
+// --- Tests ---
+
+static void test_setup(spi_handle_t spi) {
+    TEST_CHECK(spi != NULL);
+    TEST_CHECK((MMIO32(SPI_CR1) & SPI_CR1_SPE_Msk) && ((MMIO32(SPI_CR1) >> SPI_CR1_BR_Pos) & 7) == PRESCALER);
+    // ISER is write-one-to-set; the fake keeps only the last write, TX's
+    TEST_CHECK(MMIO32(NVIC_BASE + 4 * (TX_IRQN / 32)) == (1UL << (TX_IRQN % 32)));
+    TEST_CHECK(MMIO8(SCS_BASE + 0x400 + RX_IRQN) == (SPI_DMA_IRQ_PRIORITY << 4));
+    TEST_CHECK(MMIO8(SCS_BASE + 0x400 + TX_IRQN) == (SPI_DMA_IRQ_PRIORITY << 4));
+}
+
+static void test_queue(spi_handle_t spi) {
+    void (*const selects[QUEUED])(bool) = {select_0, select_1, select_2};
+    for (int i = 0; i < QUEUED; ++i) {
+        s_tx[i] = reg_fake_sram(QUEUED_BYTES);
+        s_rx[i] = reg_fake_sram(QUEUED_BYTES);
+        TEST_CHECK(s_tx[i] != NULL && s_rx[i] != NULL);
+        for (int j = 0; j < QUEUED_BYTES; ++j) {
+            s_tx[i][j] = (uint8_t)(0x40 * i + 7 * j);
+        }
+        s_txns[i] = (spi_transaction_t){
+            .p_tx_data = s_tx[i],
+            .p_rx_data = s_rx[i],
+            .len = QUEUED_BYTES,
+            .select = selects[i],
+            .callback = on_done,
+            .p_context = (void*)(intptr_t)i,
+        };
+    }
+    s_txns[1].p_tx_data = NULL;         // Dummy frames out, all ones back
+    s_txns[2].p_rx_data = NULL;         // Input discarded
+
+    uint32_t frames_before = s_frames;
+    uint32_t start = MMIO32(DWT_CYCCNT_ADDR);
+    for (int i = 0; i < QUEUED; ++i) {
+        TEST_CHECK(spi_transfer_async(spi, &s_txns[i]) == 0);
+    }
+    TEST_CHECK(spi_is_busy(spi));
+    uint8_t byte = 0;
+    TEST_CHECK(spi_transfer_blocking(spi, &byte, &byte, 1) == -1);
+
+    while (spi_is_busy(spi) && (MMIO32(DWT_CYCCNT_ADDR) - start) < 10 * QUEUED * QUEUED_BYTES * FRAME_CYCLES) {
+    }
+    uint32_t elapsed = MMIO32(DWT_CYCCNT_ADDR) - start;
+
+    TEST_CHECK(!spi_is_busy(spi));
+    TEST_CHECK(s_done_count == QUEUED && s_irqs == QUEUED);
+    for (int i = 0; i < QUEUED; ++i) {
+        TEST_CHECK(s_done_order[i] == i && s_done_status[i] == 0);
+    }
+    TEST_CHECK(s_select_count == 2 * QUEUED);
+    for (int i = 0; i < QUEUED; ++i) {
+        TEST_CHECK(s_select_log[2 * i] == i && s_select_log[2 * i + 1] == -1 - i);
+    }
+    TEST_CHECK(memcmp(s_rx[0], s_tx[0], QUEUED_BYTES) == 0);
+    for (int j = 0; j < QUEUED_BYTES; ++j) {
+        TEST_CHECK(s_rx[1][j] == 0xFF);
+        TEST_CHECK(s_rx[2][j] == 0);
+    }
+    TEST_CHECK(s_frames - frames_before == QUEUED * QUEUED_BYTES && s_overruns == 0);
+
+    // Back to back: each transaction starts from the previous one's
+    // interrupt, so a gap is the interrupt and the stream setup only
+    uint32_t bus = QUEUED * QUEUED_BYTES * FRAME_CYCLES;
+    TEST_CHECK(elapsed >= bus && elapsed < bus + QUEUED * (IRQ_CYCLES + 64 * ACCESS_CYCLES));
+    printf("queue: %d x %d bytes in %lu cycles, bus %lu\n", QUEUED, QUEUED_BYTES,
+           (unsigned long)elapsed, (unsigned long)bus);
+}
+
+static void test_benchmark(spi_handle_t spi) {
+    char report[256];
+    uint32_t other_before = s_charged_other;
+    uint32_t irqs_before = s_irqs;
+    size_t n = spi_bus_benchmark(spi, report, sizeof(report));
+    uint32_t other = s_charged_other - other_before;
+    printf("%s", report);
+    TEST_CHECK(n == strlen(report));
+    TEST_CHECK(s_irqs == irqs_before + 1 && s_overruns == 0);
+
+    unsigned long blocking_cycles = 0, blocking_rate = 0, blocking_cpu = 0;
+    unsigned long dma_cycles = 0, dma_rate = 0, dma_cpu = 0;
+    const char* p_blocking = strstr(report, "blocking");
+    const char* p_dma = strstr(report, "dma");
+    TEST_CHECK(p_blocking != NULL && p_dma != NULL);
+    if (p_blocking == NULL || p_dma == NULL) {
+        return;
+    }
+    TEST_CHECK(sscanf(p_blocking, "blocking %lu %lu %lu", &blocking_cycles, &blocking_rate, &blocking_cpu) == 3);
+    TEST_CHECK(sscanf(p_dma, "dma %lu %lu %lu", &dma_cycles, &dma_rate, &dma_cpu) == 3);
+    TEST_CHECK(strstr(report, "failed") == NULL);
+
+    // Blocking: a frame and the polling around it per byte, the CPU busy throughout
+    uint32_t bus = SPI_BUS_BENCH_BYTES * FRAME_CYCLES;
+    TEST_CHECK(blocking_cycles > bus && blocking_cycles < bus + SPI_BUS_BENCH_BYTES * 8 * ACCESS_CYCLES);
+    TEST_CHECK(blocking_cpu == blocking_cycles);
+    TEST_CHECK(blocking_rate == (unsigned long)((uint64_t)SPI_BUS_BENCH_BYTES * configCPU_CLOCK_HZ / blocking_cycles));
+
+    // DMA: the bus rate, and the CPU only for the setup and the interrupt
+    TEST_CHECK(dma_cycles >= bus && dma_cycles < bus + 2 * FRAME_CYCLES);
+    TEST_CHECK(dma_rate <= BUS_BYTES_PER_S && dma_rate > BUS_BYTES_PER_S * 99 / 100);
+    TEST_CHECK(dma_rate > blocking_rate);
+
+    // Charged outside the spin loop: everything but counter reads, less the
+    // blocking transfer, which the report counts as CPU cycles of its own
+    uint32_t expected_cpu = other - (uint32_t)blocking_cycles;
+    TEST_CHECK(labs((long)dma_cpu - (long)expected_cpu) <= 2 * READ_CYCLES + 2 * ACCESS_CYCLES);
+    TEST_CHECK(dma_cpu < blocking_cpu / 20);
+    printf("dma CPU %lu cycles, model %lu\n", dma_cpu, (unsigned long)expected_cpu);
+}
+
+int main(void) {
+    if (!reg_fake_map(SPI1_BASE, 0x400) || !reg_fake_map(DMA_PAGE_BASE, 0x800) ||
+        !reg_fake_map(SCS_BASE, 0x1000) || !reg_fake_map(DWT_BASE, 0x1000)) {
+        fprintf(stderr, "cannot map the SPI, DMA or core registers on this host\n");
+        return 1;
+    }
+    TEST_CHECK(reg_fake_trap(SPI1_BASE, 0x400, on_access));
+    TEST_CHECK(reg_fake_trap(DMA_PAGE_BASE, 0x800, on_access));
+    TEST_CHECK(reg_fake_trap(DWT_BASE, 0x1000, on_access));
+
+    const spi_config_t config = {
+        .baud_rate_prescaler = PRESCALER,
+        .data_size = SPI_DATA_SIZE_8_BIT,
+    };
+    spi_handle_t spi = spi_init(1, &config);
+    test_setup(spi);
+    if (spi != NULL) {
+        test_queue(spi);
+        wait_cycles(FRAME_CYCLES);
+        test_benchmark(spi);
+        spi_deinit(&spi);
+    }
+
+    reg_fake_untrap();
+    return TEST_EXIT();
+}
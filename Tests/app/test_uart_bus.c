@@ -0,0 +1,696 @@
+/**
+ * @file      test_uart_bus.c
+ * @brief     Host test of the asynchronous UART mode and its benchmark on the STM32F407 ports.
+ *
+ * @details   uart_bus.c, uart.c and dma.c run unchanged on their STM32F407
+ *            ports, against the register fake with USART1, DMA2 and the DWT
+ *            trapped. One hook plays all three on a cycle timeline:
+ *
+ *            - The CPU: each peripheral register access costs ACCESS_CYCLES
+ *              and each cycle counter read READ_CYCLES, one pass of a
+ *              polling loop. Interrupts cost IRQ_CYCLES on top of their
+ *              handler's accesses, and are taken at a counter read or while
+ *              the task sleeps.
+ *            - USART1 at the rate BRR gives (10 bit frames), with a TX data
+ *              register ahead of the shift register, TXE, TC and the IDLE
+ *              flag one frame after the last byte received.
+ *            - DMA2 Stream5 (RX, circular, half and full ring flags) and
+ *              Stream7 (TX) serving the USART requests.
+ *
+ *            - Setup: the stream, USART and NVIC configuration.
+ *            - RX: a short message arrives on the idle line and not before;
+ *              a long one crosses the ring in order; a reader that falls a
+ *              ring behind resumes half a ring back and counts the rest as
+ *              dropped.
+ *            - TX: writes reach the wire in order at the line rate, one DMA
+ *              chunk per contiguous run of the ring, and zero-copy writes
+ *              too.
+ *            - Benchmark: the wire time, two interrupts per run, and the
+ *              CPU cycles reported per rate are the ones the model charged
+ *              outside the spin loop.
+ *
+ *            Built with -no-pie so that static buffers sit below 4 GB, where
+ *            the 32-bit DMA address registers can hold them.
+ */
+
+#include "uart_bus.h"
+#include "uart.h"
+#include "uart_config.h"
+#include "common.h"
+#include "internal/dma_reg.h"
+#include "internal/uart_reg.h"
+#include "rcc.h"
+#include "reg_fake.h"
+#include "unit_test.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define USART1_BASE         0x40011000UL
+#define DMA_PAGE_BASE       0x40026000UL        // DMA1 and DMA2
+#define DMA2_BASE           0x40026400UL
+#define DWT_CYCCNT_ADDR     (DWT_BASE + 0x004)
+
+#define USART_SR            (USART1_BASE + 0x00)
+#define USART_DR            (USART1_BASE + 0x04)
+#define USART_BRR           (USART1_BASE + 0x08)
+#define USART_CR1           (USART1_BASE + 0x0C)
+#define USART_CR3           (USART1_BASE + 0x14)
+#define DMA_HISR            (DMA2_BASE + 0x04)
+#define DMA_HIFCR           (DMA2_BASE + 0x0C)
+#define STREAM_REG(s, off)  (DMA2_BASE + 0x10 + 0x18 * (s) + (off))
+#define RX_STREAM           5
+#define TX_STREAM           7
+#define USART_IRQN          37
+#define RX_IRQN             68
+#define TX_IRQN             70
+#define HTIF5               (1UL << 10)
+#define TCIF5               (1UL << 11)
+#define TCIF7               (1UL << 27)
+
+// CPU and bus model, in CPU cycles (HCLK = 168 MHz, PCLK2 = 84 MHz)
+#define ACCESS_CYCLES       4                   // One peripheral register access
+#define READ_CYCLES         32                  // One cycle counter read and loop pass
+#define IRQ_CYCLES          24                  // Exception entry and return
+#define PCLK2_HZ            84000000UL
+#define CYCLES_PER_TICK     (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+#define FAST_BAUD           2000000UL           // Functional tests: 840 cycles per frame
+
+#define WIRE_BYTES          4096
+#define WINDOWS             4
+
+// --- Test Data ---
+static bool s_in_model = false;                 // Model's own register accesses are free
+static bool s_in_isr = false;
+static bool s_dirty = true;                     // The CPU wrote a register since the last sync
+static uint32_t s_now = 0;                      // CPU cycles
+static uint32_t s_charged_other = 0;            // Cycles not spent reading the counter
+static uint64_t s_pending = 0;                  // Interrupts raised, bit n for IRQ 37 + n
+static uint32_t s_irqs = 0;
+
+// Registers the CPU writes, as of the last sync
+static uint32_t s_cr1, s_cr3, s_brr;
+
+// USART1
+static bool s_tdr_full = false;
+static uint8_t s_tdr;
+static uint32_t s_tdr_at;
+static uint32_t s_txe_at = 0;                   // TX data register empty since
+static bool s_shifting = false;
+static uint8_t s_shift_val;
+static uint32_t s_shift_end = 0;
+static bool s_idle = false;
+static bool s_idle_armed = false;               // A frame arrived; IDLE follows one frame later
+static uint32_t s_idle_at;
+static bool s_idle_seen = false;                // SR read with IDLE set; the DR read clears it
+static uint8_t s_rx_last;
+static uint32_t s_rx_overruns = 0;
+
+// DMA2 Stream5 and Stream7
+static struct {
+    bool active;
+    uint32_t cr;
+    uint32_t total;
+    uint32_t ndtr;
+    uint32_t index;
+    uintptr_t memory;
+} s_stream[8];
+static uint32_t s_hisr = 0;
+
+// The wire: bytes sent to RX, bytes seen from TX
+static uint8_t s_wire_in[WIRE_BYTES];
+static uint32_t s_in_len = 0;
+static uint32_t s_in_next = 0;
+static uint32_t s_in_start;
+static uint8_t s_wire_out[WIRE_BYTES];
+static uint32_t s_out_len = 0;
+
+// Kernel stand-ins
+static StaticSemaphore_t s_mutex_storage;
+SemaphoreHandle_t uartTxMutexHandle = (SemaphoreHandle_t)&s_mutex_storage;
+static bool s_mutex_held = false;
+static uint32_t s_window_start;
+static uint32_t s_windows[WINDOWS];             // CPU cycles charged outside counter reads, per suspension
+static int s_window_count = 0;
+
+void USART1_IRQHandler(void);                   // Defined by the UART port
+void DMA2_Stream5_IRQHandler(void);
+void DMA2_Stream7_IRQHandler(void);
+
+static void run_until(uint32_t end);
+
+// --- Stubs for the RCC driver and the kernel ---
+
+void rcc_enable_peripheral_clock(peripheral_id_t id) {
+    (void)id;
+}
+
+uint32_t rcc_get_apb1_frequency(void) {
+    return PCLK2_HZ / 2;
+}
+
+uint32_t rcc_get_apb2_frequency(void) {
+    return PCLK2_HZ;
+}
+
+int rcc_register_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    (void)listener;
+    (void)p_context;
+    return 0;
+}
+
+void rcc_unregister_clock_listener(rcc_clock_listener_t listener, void* p_context) {
+    (void)listener;
+    (void)p_context;
+}
+
+void vTaskSuspendAll(void) {
+    s_window_start = s_charged_other;
+}
+
+BaseType_t xTaskResumeAll(void) {
+    if (s_window_count < WINDOWS) {
+        s_windows[s_window_count++] = s_charged_other - s_window_start;
+    }
+    return pdFALSE;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return s_now / CYCLES_PER_TICK;
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    run_until(s_now + xTicksToDelay * CYCLES_PER_TICK);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime) {
+    (void)xBlockTime;
+    if (xSemaphore != uartTxMutexHandle || s_mutex_held) {
+        return pdFALSE;
+    }
+    s_mutex_held = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    if (xSemaphore != uartTxMutexHandle || !s_mutex_held) {
+        return pdFALSE;
+    }
+    s_mutex_held = false;
+    return pdTRUE;
+}
+
+void vAssertCalled(const char* p_file, unsigned long line) {
+    fprintf(stderr, "%s:%lu: assert\n", p_file, line);
+    abort();
+}
+
+// --- Helpers: the model ---
+
+static uint32_t later(uint32_t a, uint32_t b) {
+    return ((int32_t)(a - b) > 0) ? a : b;
+}
+
+static bool reached(uint32_t at, uint32_t now) {
+    return (int32_t)(now - at) >= 0;
+}
+
+/** @brief One 10-bit frame: BRR PCLK2 cycles per bit, two CPU cycles each. */
+static uint32_t frame_cycles(void) {
+    return 10 * 2 * s_brr;
+}
+
+static bool usart_on(void) {
+    return (s_cr1 & USART_CR1_UE_Msk) != 0;
+}
+
+/** @brief Picks up what the CPU wrote since the previous access. */
+static void sync_registers(void) {
+    if (!s_dirty) {
+        return;
+    }
+    s_dirty = false;
+
+    uint32_t clear = MMIO32(DMA_HIFCR);
+    if (clear != 0) {
+        s_hisr &= ~clear;
+        MMIO32(DMA_HIFCR) = 0;
+    }
+    for (int stream = RX_STREAM; stream <= TX_STREAM; stream += TX_STREAM - RX_STREAM) {
+        uint32_t cr = MMIO32(STREAM_REG(stream, 0x00));
+        bool enabled = (cr & DMA_SxCR_EN_Msk) != 0;
+        s_stream[stream].cr = cr;
+        if (enabled && !s_stream[stream].active) {
+            s_stream[stream].active = true;
+            s_stream[stream].total = MMIO32(STREAM_REG(stream, 0x04));
+            s_stream[stream].ndtr = s_stream[stream].total;
+            s_stream[stream].index = 0;
+            s_stream[stream].memory = (uintptr_t)MMIO32(STREAM_REG(stream, 0x0C));
+            if (stream == TX_STREAM) {
+                s_txe_at = later(s_txe_at, s_now);
+            }
+        } else if (!enabled) {
+            s_stream[stream].active = false;
+        }
+    }
+
+    s_cr1 = MMIO32(USART_CR1);
+    s_cr3 = MMIO32(USART_CR3);
+    s_brr = MMIO32(USART_BRR);
+}
+
+static void raise(uint32_t irqn) {
+    s_pending |= 1ULL << (irqn - USART_IRQN);
+}
+
+static void rx_frame(uint8_t value) {
+    s_rx_last = value;
+    s_idle_armed = true;
+    s_idle_at = s_now + frame_cycles();
+    if (!(s_cr3 & USART_CR3_DMAR_Msk) || !s_stream[RX_STREAM].active) {
+        s_rx_overruns++;
+        return;
+    }
+    uint8_t* p_ring = (uint8_t*)s_stream[RX_STREAM].memory;
+    p_ring[s_stream[RX_STREAM].index++] = value;
+    uint32_t ndtr = --s_stream[RX_STREAM].ndtr;
+    uint32_t cr = s_stream[RX_STREAM].cr;
+    if (ndtr == s_stream[RX_STREAM].total / 2) {
+        s_hisr |= HTIF5;
+        if (cr & DMA_SxCR_HTIE_Msk) {
+            raise(RX_IRQN);
+        }
+    }
+    if (ndtr == 0) {
+        // Circular: reload and carry on
+        s_stream[RX_STREAM].ndtr = s_stream[RX_STREAM].total;
+        s_stream[RX_STREAM].index = 0;
+        s_hisr |= TCIF5;
+        if (cr & DMA_SxCR_TCIE_Msk) {
+            raise(RX_IRQN);
+        }
+    }
+}
+
+/** @brief Runs USART1 and the two streams up to `now`. */
+static void advance(uint32_t now) {
+    for (;;) {
+        if (!usart_on()) {
+            return;
+        }
+        // TX: the DMA fills the data register, which feeds the shift register
+        if (!s_tdr_full && s_stream[TX_STREAM].active && (s_cr3 & USART_CR3_DMAT_Msk) &&
+            s_stream[TX_STREAM].ndtr != 0 && reached(s_txe_at, now)) {
+            s_tdr = ((const uint8_t*)s_stream[TX_STREAM].memory)[s_stream[TX_STREAM].index++];
+            s_tdr_full = true;
+            s_tdr_at = s_txe_at;
+            if (--s_stream[TX_STREAM].ndtr == 0) {
+                s_stream[TX_STREAM].active = false;
+                MMIO32(STREAM_REG(TX_STREAM, 0x00)) &= ~DMA_SxCR_EN_Msk;
+                s_hisr |= TCIF7;
+                if (s_stream[TX_STREAM].cr & DMA_SxCR_TCIE_Msk) {
+                    raise(TX_IRQN);
+                }
+            }
+            continue;
+        }
+        if (!s_shifting && s_tdr_full) {
+            s_shifting = true;
+            s_shift_val = s_tdr;
+            s_shift_end = later(s_tdr_at, s_shift_end) + frame_cycles();
+            s_tdr_full = false;
+            s_txe_at = later(s_tdr_at, s_txe_at);
+            continue;
+        }
+        if (s_shifting && reached(s_shift_end, now)) {
+            s_shifting = false;
+            if (s_out_len < WIRE_BYTES) {
+                s_wire_out[s_out_len++] = s_shift_val;
+            }
+            continue;
+        }
+        // RX: frames back to back from s_in_start, then the idle line
+        if (s_in_next < s_in_len && reached(s_in_start + (s_in_next + 1) * frame_cycles(), now)) {
+            rx_frame(s_wire_in[s_in_next++]);
+            continue;
+        }
+        if (s_idle_armed && reached(s_idle_at, now) &&
+            !(s_in_next < s_in_len && reached(s_in_start + (s_in_next + 1) * frame_cycles(), s_idle_at))) {
+            s_idle_armed = false;
+            s_idle = true;
+            if (s_cr1 & USART_CR1_IDLEIE_Msk) {
+                raise(USART_IRQN);
+            }
+            continue;
+        }
+        break;
+    }
+}
+
+/** @brief Shows the CPU what it is about to read. */
+static void publish(uintptr_t address) {
+    if (address == USART_SR) {
+        bool tc = !s_tdr_full && !s_shifting;
+        MMIO32(USART_SR) = (s_tdr_full ? 0 : USART_SR_TXE_Msk) | (tc ? USART_SR_TC_Msk : 0) |
+                           (s_idle ? USART_SR_IDLE_Msk : 0);
+        s_idle_seen = s_idle;
+    } else if (address == USART_DR) {
+        MMIO32(USART_DR) = s_rx_last;
+        if (s_idle_seen) {
+            s_idle = false;
+            s_idle_seen = false;
+        }
+    } else if (address == DMA_HISR) {
+        MMIO32(DMA_HISR) = s_hisr;
+    } else if (address == STREAM_REG(RX_STREAM, 0x04)) {
+        MMIO32(address) = s_stream[RX_STREAM].ndtr;
+    } else if (address == STREAM_REG(TX_STREAM, 0x04)) {
+        MMIO32(address) = s_stream[TX_STREAM].ndtr;
+    }
+}
+
+/** @brief Takes the raised interrupts, lowest number first (they share a priority). */
+static void take_irqs(void) {
+    static void (*const handlers[])(void) = {
+        [0] = USART1_IRQHandler,
+        [RX_IRQN - USART_IRQN] = DMA2_Stream5_IRQHandler,
+        [TX_IRQN - USART_IRQN] = DMA2_Stream7_IRQHandler,
+    };
+    while (s_pending != 0 && !s_in_isr) {
+        int bit = __builtin_ctzll(s_pending);
+        s_pending &= ~(1ULL << bit);
+        s_in_isr = true;
+        s_now += IRQ_CYCLES;
+        s_charged_other += IRQ_CYCLES;
+        s_irqs++;
+        handlers[bit]();
+        s_in_isr = false;
+    }
+}
+
+/** @brief Runs before each access to USART1, the DMA page or the DWT. */
+static void on_access(uintptr_t address, bool is_write) {
+    if (s_in_model) {
+        return;
+    }
+    s_in_model = true;
+
+    bool counter_read = (address == DWT_CYCCNT_ADDR && !is_write);
+    uint32_t cost = counter_read ? READ_CYCLES : ACCESS_CYCLES;
+    s_now += cost;
+    if (!counter_read) {
+        s_charged_other += cost;
+    }
+
+    sync_registers();
+    advance(s_now);
+    if (is_write) {
+        s_dirty = true;             // Lands after the hook; seen at the next one
+    } else {
+        publish(address);
+    }
+    s_in_model = false;
+
+    if (counter_read) {
+        take_irqs();
+        MMIO32(DWT_CYCCNT_ADDR) = s_now;
+    }
+}
+
+/** @brief Lets time pass with the task asleep, taking interrupts as they come. */
+static void run_until(uint32_t end) {
+    s_in_model = true;
+    sync_registers();
+    s_in_model = false;
+    uint32_t step = frame_cycles() / 8;
+    while (!reached(end, s_now)) {
+        uint32_t next = s_now + step;
+        s_now = reached(end, next) ? end : next;
+        s_in_model = true;
+        advance(s_now);
+        s_in_model = false;
+        take_irqs();
+    }
+}
+
+static void send_to_rx(const uint8_t* p_data, uint32_t len) {
+    memcpy(s_wire_in, p_data, len);
+    s_in_len = len;
+    s_in_next = 0;
+    s_in_start = s_now;
+}
+
+static uint32_t rx_end(void) {
+    return s_in_start + s_in_len * frame_cycles();
+}
+
+// --- Tests ---
+
+static void test_setup(uart_handle_t uart) {
+    TEST_CHECK(MMIO32(USART_BRR) == (PCLK2_HZ + 115200 / 2) / 115200);
+    uint32_t cr1 = USART_CR1_UE_Msk | USART_CR1_TE_Msk | USART_CR1_RE_Msk | USART_CR1_IDLEIE_Msk;
+    TEST_CHECK((MMIO32(USART_CR1) & cr1) == cr1);
+    uint32_t cr3 = USART_CR3_DMAR_Msk | USART_CR3_DMAT_Msk | USART_CR3_EIE_Msk;
+    TEST_CHECK((MMIO32(USART_CR3) & cr3) == cr3);
+
+    uint32_t rx_cr = MMIO32(STREAM_REG(RX_STREAM, 0x00));
+    TEST_CHECK(((rx_cr & DMA_SxCR_CHSEL_Msk) >> DMA_SxCR_CHSEL_Pos) == 4);
+    TEST_CHECK((rx_cr & DMA_SxCR_DIR_Msk) == 0);
+    uint32_t rx_bits = DMA_SxCR_EN_Msk | DMA_SxCR_CIRC_Msk | DMA_SxCR_MINC_Msk | DMA_SxCR_HTIE_Msk |
+                       DMA_SxCR_TCIE_Msk | DMA_SxCR_TEIE_Msk;
+    TEST_CHECK((rx_cr & rx_bits) == rx_bits);
+    TEST_CHECK(MMIO32(STREAM_REG(RX_STREAM, 0x08)) == USART_DR);
+    TEST_CHECK(s_stream[RX_STREAM].active && s_stream[RX_STREAM].total == UART_BUS_RX_BYTES);
+
+    uint32_t tx_cr = MMIO32(STREAM_REG(TX_STREAM, 0x00));
+    TEST_CHECK(((tx_cr & DMA_SxCR_CHSEL_Msk) >> DMA_SxCR_CHSEL_Pos) == 4);
+    TEST_CHECK((tx_cr & DMA_SxCR_DIR_Msk) == (1UL << DMA_SxCR_DIR_Pos));
+    TEST_CHECK((tx_cr & (DMA_SxCR_MINC_Msk | DMA_SxCR_TCIE_Msk)) == (DMA_SxCR_MINC_Msk | DMA_SxCR_TCIE_Msk));
+    TEST_CHECK(!(tx_cr & (DMA_SxCR_EN_Msk | DMA_SxCR_CIRC_Msk)));
+
+    TEST_CHECK(MMIO8(SCS_BASE + 0x400 + USART_IRQN) == (UART_IRQ_PRIORITY << 4));
+    TEST_CHECK(MMIO8(SCS_BASE + 0x400 + RX_IRQN) == (UART_IRQ_PRIORITY << 4));
+    TEST_CHECK(MMIO8(SCS_BASE + 0x400 + TX_IRQN) == (UART_IRQ_PRIORITY << 4));
+
+    // The DMA owns the data register
+    uint8_t byte = 0;
+    TEST_CHECK(uart_write_blocking(uart, &byte, 1) == -1);
+    TEST_CHECK(uart_read_blocking(uart, &byte, 1) == -1);
+}
+
+static void test_rx(uart_handle_t uart) {
+    static uint8_t s_data[3000];
+    static uint8_t s_read[UART_BUS_RX_BYTES];
+    uart_stats_t before, after;
+
+    // Short message: nothing until the line has been idle for a frame
+    const char* p_message = "status\r\n";
+    size_t message_len = strlen(p_message);
+    uart_get_stats(uart, &before);
+    send_to_rx((const uint8_t*)p_message, (uint32_t)message_len);
+    run_until(rx_end() + frame_cycles() / 2);
+    TEST_CHECK(uart_rx_available(uart) == 0);
+    run_until(rx_end() + 2 * frame_cycles());
+    uart_get_stats(uart, &after);
+    TEST_CHECK(after.rx_events - before.rx_events == 1);
+    TEST_CHECK(uart_bus_read_timeout(s_read, sizeof(s_read), 0) == message_len);
+    TEST_CHECK(memcmp(s_read, p_message, message_len) == 0);
+
+    // Long stream across the ring end, read as it comes
+    for (size_t i = 0; i < sizeof(s_data); ++i) {
+        s_data[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    uint32_t len = 1500;
+    uint32_t got = 0;
+    uart_get_stats(uart, &before);
+    send_to_rx(s_data, len);
+    while (got < len && !reached(rx_end() + 4 * frame_cycles(), s_now)) {
+        run_until(s_now + 100 * frame_cycles());
+        got += (uint32_t)uart_bus_read_timeout(s_read, sizeof(s_read), 0);
+    }
+    uart_get_stats(uart, &after);
+    TEST_CHECK(got == len);
+    TEST_CHECK(after.rx_bytes - before.rx_bytes == len && after.rx_dropped == before.rx_dropped);
+    // From 8 bytes in: the half ring, the full ring, then the idle line
+    TEST_CHECK(after.rx_events - before.rx_events == 3);
+
+    // The same, checking the data: drained in 100-byte pieces
+    got = 0;
+    send_to_rx(s_data, len);
+    while (got < len && !reached(rx_end() + 4 * frame_cycles(), s_now)) {
+        run_until(s_now + 100 * frame_cycles());
+        size_t n;
+        while (got < len && (n = uart_bus_read_timeout(s_read, 100, 0)) != 0) {
+            TEST_CHECK(memcmp(s_read, &s_data[got], n) == 0);
+            got += (uint32_t)n;
+        }
+    }
+    TEST_CHECK(got == len);
+
+    // Lapped: the reader skips to half a ring behind the DMA
+    len = sizeof(s_data);
+    uart_get_stats(uart, &before);
+    send_to_rx(s_data, len);
+    run_until(rx_end() + 2 * frame_cycles());
+    TEST_CHECK(uart_rx_available(uart) == UART_BUS_RX_BYTES);
+    size_t n = uart_bus_read_timeout(s_read, sizeof(s_read), 0);
+    uart_get_stats(uart, &after);
+    TEST_CHECK(n == UART_BUS_RX_BYTES / 2);
+    TEST_CHECK(after.rx_dropped - before.rx_dropped == len - UART_BUS_RX_BYTES / 2);
+    TEST_CHECK(memcmp(s_read, &s_data[len - UART_BUS_RX_BYTES / 2], n) == 0);
+    TEST_CHECK(uart_rx_available(uart) == 0);
+    TEST_CHECK(s_rx_overruns == 0 && after.errors == 0);
+}
+
+static void test_tx(uart_handle_t uart) {
+    static uint8_t s_data[UART_BUS_TX_BYTES];
+    uart_stats_t before, after;
+    for (size_t i = 0; i < sizeof(s_data); ++i) {
+        s_data[i] = (uint8_t)(i * 13 + 5);
+    }
+
+    // One run of the ring: one chunk, at the line rate
+    uint32_t len = 300;
+    uart_get_stats(uart, &before);
+    s_out_len = 0;
+    uint32_t start = s_now;
+    TEST_CHECK(uart_bus_write(s_data, len, 10) == len);
+    TEST_CHECK(!s_mutex_held);
+    while (s_out_len < len && !reached(start + 2 * len * frame_cycles(), s_now)) {
+        run_until(s_now + frame_cycles());
+    }
+    uint32_t elapsed = s_now - start;
+    uart_get_stats(uart, &after);
+    TEST_CHECK(s_out_len == len && memcmp(s_wire_out, s_data, len) == 0);
+    TEST_CHECK(after.tx_bytes - before.tx_bytes == len && after.tx_chunks - before.tx_chunks == 1);
+    TEST_CHECK(elapsed >= len * frame_cycles() && elapsed <= (len + 2) * frame_cycles());
+    TEST_CHECK(uart_tx_pending(uart) == 0);
+
+    // Across the ring end: the run to the end, then the run from the start
+    len = UART_BUS_TX_BYTES - 148;
+    uart_get_stats(uart, &before);
+    s_out_len = 0;
+    start = s_now;
+    TEST_CHECK(uart_bus_write(s_data, len, 10) == len);
+    while (s_out_len < len && !reached(start + 2 * len * frame_cycles(), s_now)) {
+        run_until(s_now + frame_cycles());
+    }
+    uart_get_stats(uart, &after);
+    TEST_CHECK(s_out_len == len && memcmp(s_wire_out, s_data, len) == 0);
+    TEST_CHECK(after.tx_chunks - before.tx_chunks == 2);
+    // Back to back: the second chunk starts from the first one's interrupt
+    TEST_CHECK(s_now - start <= (len + 3) * frame_cycles());
+
+    // Zero copy: encode straight into the ring
+    uint8_t* p_space = NULL;
+    s_out_len = 0;
+    size_t space = uart_tx_reserve(uart, &p_space);
+    TEST_CHECK(space > 0 && p_space != NULL);
+    memcpy(p_space, "ok\r\n", 4);
+    uart_tx_commit(uart, 4);
+    run_until(s_now + 6 * frame_cycles());
+    TEST_CHECK(s_out_len == 4 && memcmp(s_wire_out, "ok\r\n", 4) == 0);
+    TEST_CHECK(after.errors == 0);
+}
+
+static void test_benchmark(uart_handle_t uart) {
+    static const unsigned long rates[] = {115200, 2000000};
+    char report[256];
+    uart_stats_t before, after;
+
+    uart_get_stats(uart, &before);
+    uint32_t original_rate = uart_get_baud_rate(uart);
+    s_out_len = 0;
+    s_window_count = 0;
+    size_t n = uart_bus_benchmark(report, sizeof(report));
+    uart_get_stats(uart, &after);
+    printf("%s", report);
+    TEST_CHECK(n == strlen(report));
+    TEST_CHECK(strstr(report, "timeout") == NULL && strstr(report, "refused") == NULL);
+    TEST_CHECK(uart_get_baud_rate(uart) == original_rate && MMIO32(USART_BRR) == (PCLK2_HZ + original_rate / 2) / original_rate);
+    TEST_CHECK(!s_mutex_held);
+
+    // Everything reached the wire
+    TEST_CHECK(after.tx_bytes - before.tx_bytes == 2 * UART_BUS_BENCH_BYTES);
+    TEST_CHECK(s_out_len == 2 * UART_BUS_BENCH_BYTES);
+    TEST_CHECK(s_wire_out[0] == 'A' && s_wire_out[UART_BUS_BENCH_WRITE - 1] == '\n');
+
+    // Suspensions: the spin calibration, then one per rate
+    TEST_CHECK(s_window_count == 3 && s_windows[0] == 0);
+    const char* p_line = strstr(report, "cyc/irq\r\n");
+    TEST_CHECK(p_line != NULL);
+    if (p_line == NULL) {
+        return;
+    }
+    p_line += strlen("cyc/irq\r\n");
+    for (int i = 0; i < 2; ++i) {
+        unsigned long baud = 0, wire = 0, cpu = 0, irqs = 0, per_irq = 0;
+        TEST_CHECK(sscanf(p_line, "%lu %lu %lu %lu %lu", &baud, &wire, &cpu, &irqs, &per_irq) == 5);
+        TEST_CHECK(baud == rates[i]);
+
+        // Wire time: 10 bits per byte
+        uint64_t wire_cycles = (uint64_t)UART_BUS_BENCH_BYTES * 10 * configCPU_CLOCK_HZ / rates[i];
+        TEST_CHECK(wire == (unsigned long)(wire_cycles * 1024 / UART_BUS_BENCH_BYTES));
+
+        // The first write goes out alone; the others queue behind it and
+        // go as one chunk from its interrupt
+        TEST_CHECK(irqs == 2 * 1024UL / UART_BUS_BENCH_BYTES);
+
+        // CPU: what the model charged outside counter reads, within the
+        // spin loop's rounding
+        unsigned long model = (unsigned long)((uint64_t)s_windows[1 + i] * 1024 / UART_BUS_BENCH_BYTES);
+        unsigned long slack = (unsigned long)((3 * READ_CYCLES + 16) * 1024 / UART_BUS_BENCH_BYTES);
+        TEST_CHECK(labs((long)cpu - (long)model) <= (long)slack);
+        TEST_CHECK(cpu < wire / 20);
+        TEST_CHECK(per_irq >= IRQ_CYCLES && per_irq < IRQ_CYCLES + 64 * ACCESS_CYCLES);
+        printf("%lu baud: dma CPU %lu cycles/KB, model %lu\n", baud, cpu, model);
+
+        p_line = strstr(p_line, "\r\n");
+        TEST_CHECK(p_line != NULL);
+        if (p_line == NULL) {
+            return;
+        }
+        p_line += 2;
+    }
+}
+
+int main(void) {
+    if (!reg_fake_map(USART1_BASE, 0x400) || !reg_fake_map(DMA_PAGE_BASE, 0x800) ||
+        !reg_fake_map(SCS_BASE, 0x1000) || !reg_fake_map(DWT_BASE, 0x1000)) {
+        fprintf(stderr, "cannot map the USART, DMA or core registers on this host\n");
+        return 1;
+    }
+    TEST_CHECK(reg_fake_trap(USART1_BASE, 0x400, on_access));
+    TEST_CHECK(reg_fake_trap(DMA_PAGE_BASE, 0x800, on_access));
+    TEST_CHECK(reg_fake_trap(DWT_BASE, 0x1000, on_access));
+
+    const uart_config_t config = {
+        .baud_rate = 115200,
+        .word_length = 8,
+        .parity = UART_PARITY_NONE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_control = UART_FLOW_CONTROL_NONE,
+    };
+    uart_handle_t uart = uart_init(1, &config);
+    TEST_CHECK(uart != NULL);
+    if (uart != NULL) {
+        TEST_CHECK(uart_bus_start(uart) == 0);
+        s_in_model = true;
+        sync_registers();
+        s_in_model = false;
+        test_setup(uart);
+
+        TEST_CHECK(uart_set_baud_rate(uart, FAST_BAUD) == 0);
+        test_rx(uart);
+        test_tx(uart);
+        test_benchmark(uart);
+        uart_deinit(&uart);
+    }
+
+    reg_fake_untrap();
+    return TEST_EXIT();
+}
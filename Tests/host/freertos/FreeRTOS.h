@@ -0,0 +1,99 @@
+/**
+ * @file      FreeRTOS.h
+ * @brief     Host stand-in for the FreeRTOS types the portable modules use.
+ *
+ * @details   Only for the host tests. There is one task, the thread that
+ *            runs main(). Simulated interrupts (port.c) run on the threads
+ *            of the POSIX driver ports and are masked by the critical
+ *            sections, as on the target. configASSERT() calls
+ *            vAssertCalled(), which each test defines, so a test can also
+ *            check that an assert fires.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  (pdFALSE)
+#define pdPASS                  (pdTRUE)
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((uint64_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000U))
+
+/* The target values from Inc/FreeRTOSConfig.h */
+#ifndef configPRIO_BITS
+#define configPRIO_BITS                                 4
+#endif
+#ifndef configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY    5
+#endif
+#ifndef configMAX_PRIORITIES
+#define configMAX_PRIORITIES                            5
+#endif
+#ifndef configMINIMAL_STACK_SIZE
+#define configMINIMAL_STACK_SIZE                        ((unsigned short)130)
+#endif
+#ifndef configMAX_TASK_NAME_LEN
+#define configMAX_TASK_NAME_LEN                         10
+#endif
+#ifndef configTIMER_TASK_STACK_DEPTH
+#define configTIMER_TASK_STACK_DEPTH                    (configMINIMAL_STACK_SIZE * 2)
+#endif
+#ifndef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                           ((size_t)(16 * 1024))
+#endif
+#ifndef configSUPPORT_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION                 1
+#endif
+#ifndef configTICK_RATE_HZ
+#define configTICK_RATE_HZ                              ((TickType_t)1000)
+#endif
+#ifndef configCPU_CLOCK_HZ
+#define configCPU_CLOCK_HZ                              168000000UL
+#endif
+#ifndef configTASK_NOTIFICATION_ARRAY_ENTRIES
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES           5
+#endif
+
+/* Opaque static storage, as in the kernel; the sizes are not the target's */
+typedef uint32_t StackType_t;
+typedef struct { void* pvDummy[24]; } StaticTask_t;
+typedef struct { void* pvDummy[20]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+typedef struct { void* pvDummy[10]; } StaticStreamBuffer_t;
+
+void vAssertCalled(const char* p_file, unsigned long line);
+#define configASSERT(x)         if ((x) == 0) { vAssertCalled(__FILE__, __LINE__); }
+
+/* --- Heap: no host heap, a test that reports it defines these --- */
+
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+
+/* --- Port layer (port.c), after the FreeRTOS Windows simulator --- */
+
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+
+/** @brief Installs the handler of a simulated interrupt. */
+void vPortSetInterruptHandler(uint32_t ulInterruptNumber, void (*pvHandler)(void));
+
+/** @brief Runs the handler of interrupt ulInterruptNumber, masked like an ISR. */
+void vPortGenerateSimulatedInterrupt(uint32_t ulInterruptNumber);
+
+#define taskENTER_CRITICAL()    vPortEnterCritical()
+#define taskEXIT_CRITICAL()     vPortExitCritical()
+#define taskENTER_CRITICAL_FROM_ISR()   (vPortEnterCritical(), (UBaseType_t)0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)   ((void)(x), vPortExitCritical())
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+#define portSET_INTERRUPT_MASK_FROM_ISR()       taskENTER_CRITICAL_FROM_ISR()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)    taskEXIT_CRITICAL_FROM_ISR(x)
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,103 @@
+/**
+ * @file      port.c
+ * @brief     Host stand-in for the FreeRTOS port layer; see FreeRTOS.h.
+ *
+ * @details   A critical section holds the interrupt mask, a recursive mutex.
+ *            A simulated interrupt takes the same mask while its handler
+ *            runs, so handlers exclude each other and the task's critical
+ *            sections, the way BASEPRI does on the target.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <pthread.h>
+
+#define HOST_MAX_INTERRUPTS     128
+
+struct tskTaskControlBlock {
+    uint32_t notify_count[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+};
+
+// --- Static Data ---
+static pthread_mutex_t s_mask;
+static pthread_once_t s_mask_once = PTHREAD_ONCE_INIT;
+static void (*s_handlers[HOST_MAX_INTERRUPTS])(void);
+
+static struct tskTaskControlBlock s_task;
+static pthread_mutex_t s_notify_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_notify_cond = PTHREAD_COND_INITIALIZER;
+
+// --- Private Helper Functions ---
+
+static void init_mask(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_mask, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+// --- Port Layer ---
+
+void vPortEnterCritical(void) {
+    pthread_once(&s_mask_once, init_mask);
+    pthread_mutex_lock(&s_mask);
+}
+
+void vPortExitCritical(void) {
+    pthread_mutex_unlock(&s_mask);
+}
+
+void vPortSetInterruptHandler(uint32_t ulInterruptNumber, void (*pvHandler)(void)) {
+    if (ulInterruptNumber < HOST_MAX_INTERRUPTS) {
+        vPortEnterCritical();
+        s_handlers[ulInterruptNumber] = pvHandler;
+        vPortExitCritical();
+    }
+}
+
+void vPortGenerateSimulatedInterrupt(uint32_t ulInterruptNumber) {
+    if (ulInterruptNumber >= HOST_MAX_INTERRUPTS) {
+        return;
+    }
+    vPortEnterCritical();
+    if (s_handlers[ulInterruptNumber] != NULL) {
+        s_handlers[ulInterruptNumber]();
+    }
+    vPortExitCritical();
+}
+
+// --- Task Notifications ---
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return &s_task;
+}
+
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify,
+                                   BaseType_t* pxHigherPriorityTaskWoken) {
+    configASSERT(xTaskToNotify == &s_task && uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES);
+    pthread_mutex_lock(&s_notify_lock);
+    xTaskToNotify->notify_count[uxIndexToNotify]++;
+    pthread_cond_broadcast(&s_notify_cond);
+    pthread_mutex_unlock(&s_notify_lock);
+    if (pxHigherPriorityTaskWoken != NULL) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit,
+                                 TickType_t xTicksToWait) {
+    configASSERT(uxIndexToWaitOn < configTASK_NOTIFICATION_ARRAY_ENTRIES);
+    pthread_mutex_lock(&s_notify_lock);
+    uint32_t* p_count = &s_task.notify_count[uxIndexToWaitOn];
+    while (*p_count == 0 && xTicksToWait != 0) {
+        pthread_cond_wait(&s_notify_cond, &s_notify_lock);
+    }
+    uint32_t count = *p_count;
+    if (count != 0) {
+        *p_count = xClearCountOnExit ? 0 : count - 1;
+    }
+    pthread_mutex_unlock(&s_notify_lock);
+    return count;
+}
@@ -0,0 +1,17 @@
+/**
+ * @file      queue.h
+ * @brief     Host stand-in for the FreeRTOS queue API; see FreeRTOS.h.
+ */
+
+#ifndef HOST_QUEUE_H
+#define HOST_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef struct QueueDefinition* QueueHandle_t;
+
+/** @brief Not in port.c: a test that creates queues defines it. */
+QueueHandle_t xQueueCreateStatic(UBaseType_t uxQueueLength, UBaseType_t uxItemSize,
+                                 uint8_t* pucQueueStorage, StaticQueue_t* pxQueueBuffer);
+
+#endif // HOST_QUEUE_H
@@ -0,0 +1,21 @@
+/**
+ * @file      semphr.h
+ * @brief     Host stand-in for the FreeRTOS semaphore API; see FreeRTOS.h.
+ */
+
+#ifndef HOST_SEMPHR_H
+#define HOST_SEMPHR_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+/** @brief A function here, a macro in the kernel; a test that creates mutexes defines it. */
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxMutexBuffer);
+
+/** @brief Functions here, macros in the kernel; a test that takes mutexes defines them. */
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+
+#endif // HOST_SEMPHR_H
@@ -0,0 +1,18 @@
+/**
+ * @file      stream_buffer.h
+ * @brief     Host stand-in for the FreeRTOS stream buffer API; see FreeRTOS.h.
+ */
+
+#ifndef HOST_STREAM_BUFFER_H
+#define HOST_STREAM_BUFFER_H
+
+#include "FreeRTOS.h"
+
+typedef struct StreamBufferDef_t* StreamBufferHandle_t;
+
+/** @brief A function here, a macro in the kernel; a test that creates stream buffers defines it. */
+StreamBufferHandle_t xStreamBufferCreateStatic(size_t xBufferSizeBytes, size_t xTriggerLevelBytes,
+                                               uint8_t* pucStreamBufferStorageArea,
+                                               StaticStreamBuffer_t* pxStaticStreamBuffer);
+
+#endif // HOST_STREAM_BUFFER_H
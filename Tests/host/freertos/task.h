@@ -0,0 +1,73 @@
+/**
+ * @file      task.h
+ * @brief     Host stand-in for the FreeRTOS task API; see FreeRTOS.h.
+ */
+
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* pvParameters);
+
+#define tskIDLE_PRIORITY        ((UBaseType_t)0U)
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify,
+                                   BaseType_t* pxHigherPriorityTaskWoken);
+
+/** @brief xTicksToWait is portMAX_DELAY or 0: the host has no tick. */
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit,
+                                 TickType_t xTicksToWait);
+
+/** @brief Not in port.c: a test that models the kernel tick defines them. */
+void vTaskStepTick(TickType_t xTicksToJump);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t xTicksToDelay);
+
+/** @brief Not in port.c: a test that runs code suspending the scheduler defines them. */
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+
+/** @brief Task states, as reported by uxTaskGetSystemState(). */
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+/** @brief One row of uxTaskGetSystemState(), with the kernel's fields. */
+typedef struct xTASK_STATUS {
+    TaskHandle_t xHandle;
+    const char* pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    uint32_t ulRunTimeCounter;
+    StackType_t* pxStackBase;
+    uint16_t usStackHighWaterMark;
+} TaskStatus_t;
+
+/** @brief Not in port.c: a test that lists or deletes tasks defines them. */
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* pxTaskStatusArray, UBaseType_t uxArraySize,
+                                 uint32_t* pulTotalRunTime);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+
+/** @brief Not in port.c: the host runs no scheduler, a test that creates tasks defines it. */
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* pcName, uint32_t ulStackDepth,
+                               void* pvParameters, UBaseType_t uxPriority, StackType_t* puxStackBuffer,
+                               StaticTask_t* pxTaskBuffer);
+
+/* With configSUPPORT_STATIC_ALLOCATION the application provides these */
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer, StackType_t** ppxIdleTaskStackBuffer,
+                                   uint32_t* pulIdleTaskStackSize);
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer, StackType_t** ppxTimerTaskStackBuffer,
+                                    uint32_t* pulTimerTaskStackSize);
+
+#endif // HOST_TASK_H
@@ -0,0 +1,13 @@
+/**
+ * @file      timers.h
+ * @brief     Host stand-in for the FreeRTOS software timer API; see FreeRTOS.h.
+ */
+
+#ifndef HOST_TIMERS_H
+#define HOST_TIMERS_H
+
+#include "FreeRTOS.h"
+
+typedef struct tmrTimerControl* TimerHandle_t;
+
+#endif // HOST_TIMERS_H
@@ -0,0 +1,210 @@
+/**
+ * @file      reg_fake.c
+ * @brief     Register fake for running the STM32F407 ports on the host.
+ *
+ * @details   Trapping protects the pages of the range. An access faults, and
+ *            the SIGSEGV handler opens the pages and calls the hook. It then
+ *            sets the trap flag so that only the faulting instruction runs.
+ *            The SIGTRAP that follows closes the pages again.
+ *
+ *            A hook may touch another trapped range, e.g. run an interrupt
+ *            handler that accesses other peripherals. That fault nests in
+ *            the first one, so each thread keeps the ranges it opened on a
+ *            stack and closes them in reverse order.
+ */
+
+#define _GNU_SOURCE
+
+#include "reg_fake.h"
+
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+#define MAX_WINDOWS             16
+#define MAX_TRAPS               4
+#define SRAM_BASE               0x20000000UL
+#define SRAM_SIZE               (16UL * 1024 * 1024)
+#define X86_TRAP_FLAG           0x100UL
+#define X86_PF_WRITE            0x2UL
+
+typedef struct {
+    uintptr_t base;
+    size_t size;
+} window_t;
+
+typedef struct {
+    reg_fake_hook_t hook;           // NULL when the slot is free
+    uintptr_t trap_base;            // Page aligned
+    size_t trap_size;
+    uintptr_t hook_base;            // As asked for
+    uintptr_t hook_end;
+} trap_t;
+
+// --- Static Data ---
+static window_t s_windows[MAX_WINDOWS];
+static int s_window_count = 0;
+static uintptr_t s_sram_next = 0;
+
+static trap_t s_traps[MAX_TRAPS];
+static volatile int s_trap_count = 0;
+
+// Ranges this thread opened and has not yet stepped past, innermost last
+static __thread int s_open[2 * MAX_TRAPS];
+static __thread int s_open_depth = 0;
+
+// --- Private Helper Functions ---
+
+static uintptr_t page_down(uintptr_t address) {
+    return address & ~((uintptr_t)sysconf(_SC_PAGESIZE) - 1);
+}
+
+static size_t page_up(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) & ~(page - 1);
+}
+
+static bool map_fixed(uintptr_t base, size_t size) {
+    void* p = mmap((void*)base, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    if ((uintptr_t)p != base) {     // Kernels before 4.17 take the flag as a hint
+        munmap(p, size);
+        return false;
+    }
+    return true;
+}
+
+#if defined(__x86_64__) && defined(__linux__)
+static void on_fault(int sig, siginfo_t* p_info, void* p_ucontext) {
+    ucontext_t* p_uc = (ucontext_t*)p_ucontext;
+    uintptr_t address = (uintptr_t)p_info->si_addr;
+
+    int index = -1;
+    for (int i = 0; i < s_trap_count; ++i) {
+        const trap_t* p_trap = &s_traps[i];
+        if (p_trap->hook != NULL && address >= p_trap->trap_base &&
+            address < p_trap->trap_base + p_trap->trap_size) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0 || s_open_depth == 2 * MAX_TRAPS) {
+        // A real fault: let it happen again with the default action
+        signal(sig, SIG_DFL);
+        return;
+    }
+
+    const trap_t* p_trap = &s_traps[index];
+    mprotect((void*)p_trap->trap_base, p_trap->trap_size, PROT_READ | PROT_WRITE);
+    s_open[s_open_depth++] = index;
+    if (address >= p_trap->hook_base && address < p_trap->hook_end) {
+        bool is_write = (p_uc->uc_mcontext.gregs[REG_ERR] & X86_PF_WRITE) != 0;
+        p_trap->hook(address, is_write);
+    }
+    p_uc->uc_mcontext.gregs[REG_EFL] |= X86_TRAP_FLAG;
+}
+
+static void on_step(int sig, siginfo_t* p_info, void* p_ucontext) {
+    (void)sig;
+    (void)p_info;
+    ucontext_t* p_uc = (ucontext_t*)p_ucontext;
+    p_uc->uc_mcontext.gregs[REG_EFL] &= ~X86_TRAP_FLAG;
+    if (s_open_depth > 0) {
+        const trap_t* p_trap = &s_traps[s_open[--s_open_depth]];
+        if (p_trap->hook != NULL) {
+            mprotect((void*)p_trap->trap_base, p_trap->trap_size, PROT_NONE);
+        }
+    }
+}
+#endif
+
+// --- Public API Function Implementations ---
+
+bool reg_fake_map(uintptr_t base, size_t size) {
+    uintptr_t start = page_down(base);
+    size_t length = page_up(base + size - start);
+
+    for (int i = 0; i < s_window_count; ++i) {
+        if (start >= s_windows[i].base && start + length <= s_windows[i].base + s_windows[i].size) {
+            memset((void*)base, 0, size);
+            return true;
+        }
+    }
+    if (s_window_count == MAX_WINDOWS || !map_fixed(start, length)) {
+        return false;
+    }
+    s_windows[s_window_count++] = (window_t){.base = start, .size = length};
+    return true;
+}
+
+void* reg_fake_sram(size_t size) {
+    if (s_sram_next == 0) {
+        if (!map_fixed(SRAM_BASE, SRAM_SIZE)) {
+            return NULL;
+        }
+        s_sram_next = SRAM_BASE;
+    }
+    size = (size + 15) & ~(size_t)15;
+    if (s_sram_next + size > SRAM_BASE + SRAM_SIZE) {
+        return NULL;
+    }
+    void* p = (void*)s_sram_next;
+    s_sram_next += size;
+    return p;
+}
+
+bool reg_fake_trap(uintptr_t base, size_t size, reg_fake_hook_t hook) {
+#if defined(__x86_64__) && defined(__linux__)
+    if (s_trap_count == MAX_TRAPS || hook == NULL) {
+        return false;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+
+    action.sa_sigaction = on_fault;
+    sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = on_step;
+    sigaction(SIGTRAP, &action, NULL);
+
+    trap_t* p_trap = &s_traps[s_trap_count];
+    p_trap->trap_base = page_down(base);
+    p_trap->trap_size = page_up(base + size - p_trap->trap_base);
+    p_trap->hook_base = base;
+    p_trap->hook_end = base + size;
+    for (int i = 0; i < s_trap_count; ++i) {
+        if (p_trap->trap_base < s_traps[i].trap_base + s_traps[i].trap_size &&
+            s_traps[i].trap_base < p_trap->trap_base + p_trap->trap_size) {
+            return false;           // Pages are trapped whole, so ranges must not share one
+        }
+    }
+    p_trap->hook = hook;
+    s_trap_count++;
+    return mprotect((void*)p_trap->trap_base, p_trap->trap_size, PROT_NONE) == 0;
+#else
+    (void)base;
+    (void)size;
+    (void)hook;
+    return false;
+#endif
+}
+
+void reg_fake_untrap(void) {
+    for (int i = 0; i < s_trap_count; ++i) {
+        trap_t* p_trap = &s_traps[i];
+        p_trap->hook = NULL;
+        mprotect((void*)p_trap->trap_base, p_trap->trap_size, PROT_READ | PROT_WRITE);
+    }
+    s_trap_count = 0;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file      reg_fake.h
+ * @brief     Register fake for running the STM32F407 ports on the host.
+ *
+ * @details   The ports address their peripherals at fixed addresses below
+ *            4 GB and store buffer addresses in 32-bit registers. Here the
+ *            peripheral windows are mapped, zeroed, at those same addresses,
+ *            so a port runs unchanged. The test plays the hardware. It sets
+ *            status bits before a call and reads the configuration back
+ *            afterwards. Buffers whose address a port writes to a register
+ *            come from reg_fake_sram(), which is also below 4 GB.
+ *
+ *            A trapped range goes further. Every CPU access to it calls a
+ *            hook before the access executes. The hook can then move the
+ *            simulated hardware on between two register reads of the port
+ *            (x86-64 Linux only; elsewhere reg_fake_trap() returns false).
+ *            Up to four ranges can be trapped at once, each with its hook.
+ */
+
+#ifndef REG_FAKE_H
+#define REG_FAKE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Called on each access to a trapped range, before it executes. */
+typedef void (*reg_fake_hook_t)(uintptr_t address, bool is_write);
+
+/**
+ * @brief Maps a peripheral window at its real address, zero-filled.
+ * @return false if the host has something else at that address.
+ */
+bool reg_fake_map(uintptr_t base, size_t size);
+
+/** @brief Allocates zeroed memory below 4 GB, never freed. */
+void* reg_fake_sram(size_t size);
+
+/**
+ * @brief Calls `hook` on every access to [base, base + size) until
+ *        reg_fake_untrap(). The range must have been mapped. Whole pages
+ *        are trapped, so the hook filters on the address, and two trapped
+ *        ranges must not share a page.
+ * @return false if trapping is not supported on this host, the range
+ *         shares a page with another trapped range, or four are trapped.
+ */
+bool reg_fake_trap(uintptr_t base, size_t size, reg_fake_hook_t hook);
+
+/** @brief Ends trapping of all ranges; they stay mapped. */
+void reg_fake_untrap(void);
+
+#endif // REG_FAKE_H
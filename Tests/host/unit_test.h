@@ -0,0 +1,31 @@
+/**
+ * @file      unit_test.h
+ * @brief     Minimal checks for the host unit tests.
+ *
+ * @details   Each test is one executable: TEST_CHECK() reports a failed
+ *            condition and carries on, TEST_EXIT() prints the summary and
+ *            gives the exit status ctest looks at.
+ */
+
+#ifndef UNIT_TEST_H
+#define UNIT_TEST_H
+
+#include <stdio.h>
+
+static int s_test_checks = 0;
+static int s_test_failures = 0;
+
+#define TEST_CHECK(cond)                                                           \
+    do {                                                                           \
+        s_test_checks++;                                                           \
+        if (!(cond)) {                                                             \
+            s_test_failures++;                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                          \
+    } while (0)
+
+#define TEST_EXIT()                                                                \
+    (printf("%d checks, %d failed\n", s_test_checks, s_test_failures),            \
+     (s_test_failures == 0) ? 0 : 1)
+
+#endif // UNIT_TEST_H
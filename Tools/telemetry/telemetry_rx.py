@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""
+telemetry_rx.py - Receive the telemetry stream (Middleware/Telemetry) on Linux.
+
+Reads COBS frames from a serial port (or a file captured from one), checks
+their CRC and sequence numbers, and writes:
+
+    <prefix>_tap0.wav     input tap, 16-bit mono at the decimated rate
+    <prefix>_tap1.wav     output tap
+    <prefix>_blocks.csv   block, timestamp, cycles, load %, effect
+    <prefix>_params.csv   timestamp, param1, param2
+
+Missing audio is written as silence so the WAV files stay aligned in time.
+A status line is printed every second with frames lost on the way (sequence
+gaps), frames the device dropped itself (from INFO frames) and CRC errors.
+
+Usage:
+    telemetry_rx.py /dev/ttyUSB0 -b 2000000 -o capture
+    telemetry_rx.py capture.bin -o capture
+"""
+
+import argparse
+import os
+import stat
+import struct
+import sys
+import time
+import wave
+
+HEADER_FMT = "<BBHI"
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+INFO_FMT = "<BBHIHHII"
+
+# Must match telemetry_frame_type_t in telemetry.h
+FRAME_INFO, FRAME_AUDIO, FRAME_BLOCK, FRAME_PARAMS = 1, 2, 3, 4
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def open_source(path, baud):
+    """Opens a serial port in raw mode at `baud`, or a plain file."""
+    if not stat.S_ISCHR(os.stat(path).st_mode):
+        return open(path, "rb", buffering=0), False
+    import termios
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % baud, None)
+    if speed is None:
+        raise ValueError("baud rate %d not supported by termios" % baud)
+    attrs[0] = 0                                    # iflag: no translation
+    attrs[1] = 0                                    # oflag
+    attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attrs[3] = 0                                    # lflag: raw
+    attrs[4] = attrs[5] = speed
+    attrs[6][termios.VMIN] = 1
+    attrs[6][termios.VTIME] = 1
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return os.fdopen(fd, "rb", buffering=0), True
+
+
+class Receiver:
+    def __init__(self, prefix):
+        self.prefix = prefix
+        self.info = None
+        self.wavs = {}
+        self.next_index = {}
+        self.last_seq = None
+        self.frames = self.crc_errors = self.lost = self.empty = 0
+        self.audio_gaps = self.device_dropped = 0
+        self.blocks = open(prefix + "_blocks.csv", "w")
+        self.blocks.write("block,timestamp,cycles,load_pct,effect\n")
+        self.params = open(prefix + "_params.csv", "w")
+        self.params.write("timestamp,param1,param2\n")
+
+    def close(self):
+        for wav in self.wavs.values():
+            wav.close()
+        self.blocks.close()
+        self.params.close()
+
+    def frame(self, encoded):
+        if not encoded:
+            self.empty += 1                         # Padding at the wrap of the device ring
+            return
+        try:
+            raw = cobs_decode(encoded)
+        except ValueError:
+            self.crc_errors += 1
+            return
+        if len(raw) < HEADER_SIZE + 2 or crc16_ccitt(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+            self.crc_errors += 1
+            return
+        ftype, channel, seq, timestamp = struct.unpack_from(HEADER_FMT, raw)
+        payload = raw[HEADER_SIZE:-2]
+
+        if self.last_seq is not None:
+            self.lost += (seq - self.last_seq - 1) & 0xFFFF
+        self.last_seq = seq
+        self.frames += 1
+
+        if ftype == FRAME_INFO:
+            self.on_info(payload)
+        elif ftype == FRAME_AUDIO:
+            self.on_audio(channel, payload)
+        elif ftype == FRAME_BLOCK:
+            self.on_block(timestamp, payload)
+        elif ftype == FRAME_PARAMS:
+            p1, p2 = struct.unpack_from("<ff", payload)
+            self.params.write("%u,%.5f,%.5f\n" % (timestamp, p1, p2))
+
+    def on_info(self, payload):
+        (version, taps, decimation, rate, block_frames, _reserved, cpu_hz,
+         dropped) = struct.unpack_from(INFO_FMT, payload)
+        self.device_dropped = dropped
+        if self.info is None:
+            self.info = {"taps": taps, "decimation": decimation, "rate": rate,
+                         "block_frames": block_frames, "cpu_hz": cpu_hz}
+            print("stream v%d: %d taps at %d Hz (%d / %d), %d frames per block, CPU %.0f MHz" % (
+                version, taps, rate // decimation, rate, decimation, block_frames, cpu_hz / 1e6))
+
+    def on_audio(self, tap, payload):
+        if self.info is None:
+            return                                  # Rate unknown until the first INFO
+        (first,) = struct.unpack_from("<I", payload)
+        samples = payload[4:]
+        wav = self.wavs.get(tap)
+        if wav is None:
+            wav = wave.open("%s_tap%d.wav" % (self.prefix, tap), "wb")
+            wav.setnchannels(1)
+            wav.setsampwidth(2)
+            wav.setframerate(self.info["rate"] // self.info["decimation"])
+            self.wavs[tap] = wav
+            self.next_index[tap] = first
+        missing = (first - self.next_index[tap]) & 0xFFFFFFFF
+        if 0 < missing < 0x80000000:
+            self.audio_gaps += 1
+            wav.writeframes(b"\0\0" * min(missing, 1 << 20))
+        wav.writeframes(samples)
+        self.next_index[tap] = (first + len(samples) // 2) & 0xFFFFFFFF
+
+    def on_block(self, timestamp, payload):
+        block, cycles, effect = struct.unpack_from("<IIB", payload)
+        load = ""
+        if self.info is not None:
+            budget = self.info["cpu_hz"] * self.info["block_frames"] / float(self.info["rate"])
+            load = "%.1f" % (100.0 * cycles / budget)
+        self.blocks.write("%u,%u,%u,%s,%u\n" % (block, timestamp, cycles, load, effect))
+
+    def status(self):
+        return "frames %d  lost %d  device-dropped %d  crc-errors %d  audio-gaps %d" % (
+            self.frames, self.lost, self.device_dropped, self.crc_errors, self.audio_gaps)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="serial device or captured file")
+    parser.add_argument("-b", "--baud", type=int, default=2000000, help="serial baud rate")
+    parser.add_argument("-o", "--output", default="telemetry", help="output file prefix")
+    parser.add_argument("-t", "--seconds", type=float, default=0, help="stop after this long (0 = until EOF or Ctrl-C)")
+    args = parser.parse_args()
+
+    source, is_tty = open_source(args.source, args.baud)
+    rx = Receiver(args.output)
+    pending = bytearray()
+    synced = False
+    start = last_status = time.time()
+    try:
+        while True:
+            chunk = source.read(4096)
+            if not chunk:
+                if is_tty:
+                    continue
+                break
+            pending += chunk
+            frames = pending.split(b"\0")
+            pending = bytearray(frames.pop())
+            for encoded in frames:
+                if synced:
+                    rx.frame(bytes(encoded))
+                synced = True                       # The first piece may be a partial frame
+            now = time.time()
+            if is_tty and now - last_status >= 1.0:
+                last_status = now
+                print(rx.status(), file=sys.stderr)
+            if args.seconds and now - start >= args.seconds:
+                break
+    except KeyboardInterrupt:
+        pass
+    finally:
+        rx.close()
+        source.close()
+
+    print(rx.status())
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+trace_decode.py - Decode a trace_recorder dump into a Chrome trace timeline.
+
+Reads the binary produced by trace_dump() (Middleware/Trace), writes a JSON
+file loadable in chrome://tracing or https://ui.perfetto.dev, and prints
+per-task scheduling latency, audio-pipeline latency distributions and the
+context switches spent per audio block. Timestamps are rescaled at every CPU
+clock change recorded by the target.
+
+Usage:
+    trace_decode.py capture.bin -o timeline.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+DUMP_MAGIC = 0x31435254
+HEADER_FMT = "<IHHIIIHH"
+NAME_FMT = "<BBH12s"
+RECORD_FMT = "<IBBH"
+
+# Must match trace_event_t in trace_recorder.h
+EVENTS = [
+    "NONE",
+    "TASK_SWITCHED_IN", "TASK_READY", "TASK_CREATE", "TASK_DELETE", "TASK_DELAY",
+    "TASK_NOTIFY", "TASK_NOTIFY_FROM_ISR", "TASK_NOTIFY_WAIT",
+    "QUEUE_SEND", "QUEUE_SEND_FROM_ISR", "QUEUE_RECEIVE", "QUEUE_BLOCK_SEND", "QUEUE_BLOCK_RECEIVE",
+    "STREAM_SEND", "STREAM_SEND_FROM_ISR", "STREAM_RECEIVE", "STREAM_BLOCK_SEND", "STREAM_BLOCK_RECEIVE",
+    "ISR_ENTER", "ISR_EXIT",
+    "AUDIO_RX_READY", "AUDIO_TX_FREE", "AUDIO_DSP_START", "AUDIO_DSP_END", "AUDIO_XRUN",
+    "USER",
+    "CLOCK_CHANGE",
+]
+EV = {name: idx for idx, name in enumerate(EVENTS)}
+OBJECT_EVENTS = {EV[n] for n in EVENTS if n.startswith(("QUEUE_", "STREAM_"))}
+TASK_ARG_EVENTS = {EV["TASK_READY"], EV["TASK_CREATE"], EV["TASK_DELETE"],
+                   EV["TASK_NOTIFY"], EV["TASK_NOTIFY_FROM_ISR"]}
+
+PID_TASKS, PID_ISR, PID_AUDIO = 1, 2, 3
+
+
+def parse_dump(data):
+    start = data.find(struct.pack("<I", DUMP_MAGIC))
+    if start < 0:
+        raise ValueError("trace dump magic not found")
+    offset = start
+    (magic, version, record_size, ts_hz, record_count, dropped,
+     name_count, name_size) = struct.unpack_from(HEADER_FMT, data, offset)
+    offset += struct.calcsize(HEADER_FMT)
+    if record_size != struct.calcsize(RECORD_FMT) or name_size != struct.calcsize(NAME_FMT):
+        raise ValueError("unsupported record or name size (version %d)" % version)
+
+    task_names, object_names = {}, {}
+    for _ in range(name_count):
+        kind, _reserved, ident, raw = struct.unpack_from(NAME_FMT, data, offset)
+        offset += name_size
+        name = raw.split(b"\0", 1)[0].decode("ascii", "replace")
+        (task_names if kind == 0 else object_names)[ident] = name
+
+    available = (len(data) - offset) // record_size
+    if available < record_count:
+        print("warning: dump truncated, %d of %d records" % (available, record_count), file=sys.stderr)
+        record_count = available
+
+    raw = []
+    wrap, last = 0, None
+    for _ in range(record_count):
+        ts, event, task, arg = struct.unpack_from(RECORD_FMT, data, offset)
+        offset += record_size
+        # The 32-bit cycle counter wraps every 2^32 cycles (~25 s at 168 MHz)
+        if last is not None and ts < last:
+            wrap += 1 << 32
+        last = ts
+        raw.append((ts + wrap, event, task, arg))
+
+    return {
+        "hz": ts_hz, "dropped": dropped, "records": to_microseconds(raw, ts_hz),
+        "task_names": task_names, "object_names": object_names,
+    }
+
+
+def to_microseconds(raw, dump_hz):
+    """Converts cycle stamps to microseconds, rescaling at every CLOCK_CHANGE record.
+
+    The header holds the clock at dump time. The records before the first
+    change in the dump ran at that change's old clock.
+    """
+    hz = dump_hz
+    for _ts, event, _task, arg in raw:
+        if event == EV["CLOCK_CHANGE"]:
+            hz = (arg >> 8) * 1e6 or dump_hz
+            break
+
+    records = []
+    base_cycles = raw[0][0] if raw else 0
+    base_us = 0.0
+    for ts, event, task, arg in raw:
+        t = base_us + (ts - base_cycles) * 1e6 / hz
+        records.append((t, event, task, arg))
+        if event == EV["CLOCK_CHANGE"] and (arg & 0xFF) != 0:
+            hz = (arg & 0xFF) * 1e6
+            base_cycles, base_us = ts, t
+    return records
+
+
+def build_timeline(trace):
+    records = trace["records"]
+    task_names, object_names = trace["task_names"], trace["object_names"]
+    out = [
+        {"name": "process_name", "ph": "M", "pid": PID_TASKS, "args": {"name": "Tasks"}},
+        {"name": "process_name", "ph": "M", "pid": PID_ISR, "args": {"name": "Interrupts"}},
+        {"name": "process_name", "ph": "M", "pid": PID_AUDIO, "args": {"name": "Audio pipeline"}},
+    ]
+    for num, name in sorted(task_names.items()):
+        out.append({"name": "thread_name", "ph": "M", "pid": PID_TASKS, "tid": num, "args": {"name": name}})
+
+    running, running_since = None, None
+    for t, event, task, arg in records:
+        name = EVENTS[event] if event < len(EVENTS) else "EVENT_%d" % event
+
+        if event == EV["TASK_SWITCHED_IN"]:
+            if running is not None:
+                out.append({"name": task_names.get(running, "task%d" % running), "ph": "X",
+                            "pid": PID_TASKS, "tid": running, "ts": running_since, "dur": t - running_since})
+            running, running_since = arg, t
+        elif event in (EV["ISR_ENTER"], EV["ISR_EXIT"]):
+            out.append({"name": "IRQ%d" % arg, "ph": "B" if event == EV["ISR_ENTER"] else "E",
+                        "pid": PID_ISR, "tid": arg, "ts": t})
+        elif event in (EV["AUDIO_DSP_START"], EV["AUDIO_DSP_END"]):
+            out.append({"name": "dsp", "ph": "B" if event == EV["AUDIO_DSP_START"] else "E",
+                        "pid": PID_AUDIO, "tid": 0, "ts": t, "args": {"effect": arg}})
+        elif event == EV["CLOCK_CHANGE"]:
+            out.append({"name": "clock %d->%d MHz" % (arg >> 8, arg & 0xFF), "ph": "i", "s": "g",
+                        "pid": PID_TASKS, "tid": task, "ts": t})
+        elif name.startswith("AUDIO_"):
+            out.append({"name": name, "ph": "i", "s": "p", "pid": PID_AUDIO, "tid": 0, "ts": t,
+                        "args": {"arg": arg}})
+        else:
+            args = {"arg": arg}
+            if event in OBJECT_EVENTS:
+                args["object"] = object_names.get(arg, "obj%04x" % arg)
+            elif event in TASK_ARG_EVENTS:
+                args["task"] = task_names.get(arg, "task%d" % arg)
+            out.append({"name": name, "ph": "i", "s": "t", "pid": PID_TASKS, "tid": task, "ts": t,
+                        "args": args})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def percentile(sorted_values, pct):
+    if not sorted_values:
+        return 0.0
+    idx = min(len(sorted_values) - 1, int(round(pct / 100.0 * (len(sorted_values) - 1))))
+    return sorted_values[idx]
+
+
+def latency_report(trace):
+    records, task_names = trace["records"], trace["task_names"]
+    ready_since, sched = {}, {}
+    rx_pending, rx_to_dsp, dsp_run = None, [], []
+    dsp_start = None
+    switches, switches_per_block, blocks = 0, [], 0
+
+    for ts, event, _task, arg in records:
+        if event == EV["TASK_READY"]:
+            ready_since.setdefault(arg, ts)
+        elif event == EV["TASK_SWITCHED_IN"]:
+            switches += 1
+            since = ready_since.pop(arg, None)
+            if since is not None:
+                sched.setdefault(arg, []).append(ts - since)
+        elif event == EV["AUDIO_RX_READY"]:
+            # Context switches between consecutive blocks compare pipeline topologies
+            if blocks > 0:
+                switches_per_block.append(switches)
+            blocks += 1
+            switches = 0
+            if rx_pending is None:
+                rx_pending = ts
+        elif event == EV["AUDIO_DSP_START"]:
+            dsp_start = ts
+            if rx_pending is not None:
+                rx_to_dsp.append(ts - rx_pending)
+                rx_pending = None
+        elif event == EV["AUDIO_DSP_END"] and dsp_start is not None:
+            dsp_run.append(ts - dsp_start)
+            dsp_start = None
+
+    rows = [(task_names.get(num, "task%d" % num), vals) for num, vals in sorted(sched.items())]
+    rows.append(("RX->DSP start", rx_to_dsp))
+    rows.append(("DSP block time", dsp_run))
+
+    lines = ["%-16s %7s %9s %9s %9s %9s %9s" % ("latency (us)", "count", "min", "p50", "p90", "p99", "max")]
+    for label, vals in rows:
+        vals = sorted(vals)
+        if not vals:
+            continue
+        lines.append("%-16s %7d %9.1f %9.1f %9.1f %9.1f %9.1f" % (
+            label, len(vals), vals[0], percentile(vals, 50), percentile(vals, 90),
+            percentile(vals, 99), vals[-1]))
+    if switches_per_block:
+        lines.append("context switches per block: mean %.2f, max %d over %d blocks" % (
+            sum(switches_per_block) / float(len(switches_per_block)), max(switches_per_block),
+            len(switches_per_block)))
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="binary file captured from trace_dump()")
+    parser.add_argument("-o", "--output", default="trace.json", help="Chrome trace JSON output")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        trace = parse_dump(f.read())
+
+    with open(args.output, "w") as f:
+        json.dump(build_timeline(trace), f)
+
+    print("%d records (%d dropped before dump), clock %.1f MHz at dump -> %s" % (
+        len(trace["records"]), trace["dropped"], trace["hz"] / 1e6, args.output))
+    print(latency_report(trace))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())